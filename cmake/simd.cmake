@@ -16,6 +16,8 @@ if(CMAKE_COMPILER_IS_GNUCC OR CMAKE_COMPILER_IS_GNUCXX OR CMAKE_CXX_COMPILER_ID
     set(AVX_FLAG "-mavx")
     set(AVX2_FLAG "-mavx2")
     set(AVX512F_FLAG "-mavx512f")
+    set(AVX512_FLAG "-mavx512f -mavx512bw -mavx512vl")
+    set(AVX512BF16_FLAG "${AVX512_FLAG} -mavx512bf16")
 elseif(MSVC)
     set(MMX_FLAG "/arch:MMX")
     set(SSE2_FLAG "/arch:SSE2")
@@ -114,9 +116,40 @@ int main()
     return 0;
 }" AVX512F_FOUND)
 
+# Check AVX512 (F, BW and VL), only the compiler support is required here,
+# the kernels are picked at runtime by MayIUse.
+set(CMAKE_REQUIRED_FLAGS ${AVX512_FLAG})
+CHECK_CXX_SOURCE_COMPILES("
+#include <immintrin.h>
+int main()
+{
+    __m512i a = _mm512_cvtepi8_epi16(_mm256_set1_epi8(1));
+    __m512i result = _mm512_madd_epi16(a, a);
+    return 0;
+}" AVX512_FOUND)
+
+# Check AVX512_BF16, only the compiler support is required here, the
+# instructions are dispatched at runtime according to the cpuid.
+set(CMAKE_REQUIRED_FLAGS ${AVX512BF16_FLAG})
+CHECK_CXX_SOURCE_COMPILES("
+#include <immintrin.h>
+int main()
+{
+    __m512 a = _mm512_set1_ps(1.f);
+    __m512bh b = _mm512_cvtne2ps_pbh(a, a);
+    __m512 result = _mm512_dpbf16_ps(a, b, b);
+    return 0;
+}" AVX512BF16_FOUND)
+
 set(CMAKE_REQUIRED_FLAGS ${CMAKE_REQUIRED_FLAGS_RETAINED})
-mark_as_advanced(MMX_FOUND SSE2_FOUND SSE3_FOUND AVX_FOUND AVX2_FOUND AVX512F_FOUND)
+mark_as_advanced(MMX_FOUND SSE2_FOUND SSE3_FOUND AVX_FOUND AVX2_FOUND AVX512F_FOUND AVX512_FOUND AVX512BF16_FOUND)
 
 if(WITH_AVX AND AVX_FOUND)
     add_definitions(-DLITE_WITH_AVX)
+    if(AVX512_FOUND AND NOT WIN32)
+        add_definitions(-DLITE_WITH_AVX512)
+    endif()
+    if(AVX512BF16_FOUND AND NOT WIN32)
+        add_definitions(-DLITE_WITH_AVX512_BF16)
+    endif()
 endif()
\ No newline at end of file
@@ -15,6 +15,8 @@
 #include "lite/api/cxx_api.h"
 
 #include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
 #include <memory>
 #include <set>
 #include <string>
@@ -22,6 +24,9 @@
 #include <vector>
 
 #include "lite/api/paddle_use_passes.h"
+#include "lite/core/version.h"
+#include "lite/core/weight_store.h"
+#include "lite/utils/env.h"
 #include "lite/utils/io.h"
 #ifdef ENABLE_ARM_FP16
 #include "lite/backends/arm/math/fp16/type_trans_fp16.h"
@@ -80,6 +85,171 @@ bool IsQuantizedMode(const std::shared_ptr<cpp::ProgramDesc> &program_desc) {
   return is_quantized_model;
 }
 
+namespace {
+// The quant ops of a quantized model are removed by the optimizer, which
+// marks the quantized ops by the `enable_int8` attr instead.
+bool HasInt8Ops(const std::shared_ptr<cpp::ProgramDesc> &program_desc) {
+  for (size_t i = 0; i < program_desc->BlocksSize(); ++i) {
+    auto *block_desc = program_desc->GetBlock<cpp::BlockDesc>(i);
+    for (size_t j = 0; j < block_desc->OpsSize(); ++j) {
+      auto *op_desc = block_desc->GetOp<cpp::OpDesc>(j);
+      if (op_desc->HasAttr("enable_int8") &&
+          op_desc->GetAttr<bool>("enable_int8")) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// The places the passes pick the kernels from: the valid places, the host
+// places of them and the int8 places of a quantized model.
+std::vector<Place> InnerPlaces(const std::vector<Place> &valid_places,
+                               bool quantized) {
+  std::vector<Place> inner_places = valid_places;
+  for (auto &valid_place : valid_places) {
+    if (valid_place.target == TARGET(kOpenCL)) continue;
+    inner_places.emplace_back(
+        Place(TARGET(kHost), valid_place.precision, valid_place.layout));
+  }
+
+  if (quantized) {
+    for (auto &valid_place : valid_places) {
+      if (valid_place.target == TARGET(kARM)) {
+        inner_places.insert(inner_places.begin(),
+                            Place{TARGET(kARM), PRECISION(kInt8)});
+      }
+      if (valid_place.target == TARGET(kX86)) {
+        inner_places.insert(inner_places.begin(),
+                            Place{TARGET(kX86), PRECISION(kInt8)});
+      }
+    }
+    // XPU target must make sure to insert in front of others.
+    for (auto &valid_place : valid_places) {
+      if (valid_place.target == TARGET(kXPU)) {
+        inner_places.insert(inner_places.begin(),
+                            Place{TARGET(kXPU), PRECISION(kInt8)});
+      }
+    }
+  }
+  return inner_places;
+}
+
+// 64-bit FNV-1a, the key must be stable across processes, which is not
+// guaranteed by std::hash.
+void HashBytes(const char *data, size_t size, uint64_t *hash) {
+  for (size_t i = 0; i < size; i++) {
+    *hash ^= static_cast<uint8_t>(data[i]);
+    *hash *= 0x100000001b3ULL;
+  }
+}
+
+void HashString(const std::string &str, uint64_t *hash) {
+  // Include the size to separate the adjacent strings
+  const uint64_t size = str.size();
+  HashBytes(reinterpret_cast<const char *>(&size), sizeof(size), hash);
+  HashBytes(str.data(), str.size(), hash);
+}
+
+void HashFile(const std::string &path, uint64_t *hash) {
+  std::vector<char> contents;
+  CHECK(ReadFile(path, &contents)) << "Failed to read " << path;
+  HashString(path.substr(path.rfind('/') + 1), hash);
+  const uint64_t size = contents.size();
+  HashBytes(reinterpret_cast<const char *>(&size), sizeof(size), hash);
+  if (size > 0) HashBytes(contents.data(), contents.size(), hash);
+}
+
+// The configs read by the passes, e.g. the subgraph partition configs, are
+// taken from the buffer, the file or the environment variables.
+void HashConfigs(const std::string &buffer,
+                 const std::string &path,
+                 const std::string &env_file,
+                 const std::string &env_buffer,
+                 uint64_t *hash) {
+  HashString(buffer, hash);
+  if (!path.empty() && IsFileExists(path)) {
+    HashFile(path, hash);
+  } else {
+    HashString(path, hash);
+  }
+  HashString(GetConfigsFromEnv(env_file, env_buffer), hash);
+}
+
+// The name of the cached optimized model, it covers everything the
+// optimizer depends on: the model, the places, the passes, the options and
+// configs of the passes and the version of the library.
+std::string OptimizedModelCacheKey(const lite_api::CxxConfig &config,
+                                   const std::vector<Place> &valid_places,
+                                   const std::vector<std::string> &passes,
+                                   lite_api::LiteModelType model_type) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  if (config.is_model_from_memory()) {
+    HashString(config.get_model_buffer().get_program(), &hash);
+    HashString(config.get_model_buffer().get_params(), &hash);
+  } else if (!config.model_file().empty()) {
+    HashFile(config.model_file(), &hash);
+    if (!config.param_file().empty()) HashFile(config.param_file(), &hash);
+  } else {
+    // The params are saved separately, skip the cached models in case the
+    // cache dir is the model dir.
+    auto files = ListFile(config.model_dir());
+    std::sort(files.begin(), files.end());
+    for (auto &file : files) {
+      if (file.size() > 3 && file.substr(file.size() - 3) == ".nb") continue;
+      HashFile(config.model_dir() + "/" + file, &hash);
+    }
+  }
+  HashString(std::to_string(static_cast<int>(model_type)), &hash);
+  for (auto &place : valid_places) {
+    HashString(place.DebugString(), &hash);
+  }
+  for (auto &pass : passes) {
+    HashString(pass, &hash);
+  }
+  HashString("discarded", &hash);
+  for (auto &pass : config.get_discarded_passes()) {
+    HashString(pass, &hash);
+  }
+  for (auto &device : config.nnadapter_device_names()) {
+    HashString(device, &hash);
+  }
+  HashString(config.nnadapter_context_properties(), &hash);
+  HashConfigs(config.nnadapter_subgraph_partition_config_buffer(),
+              config.nnadapter_subgraph_partition_config_path(),
+              SUBGRAPH_PARTITION_CONFIG_FILE,
+              SUBGRAPH_PARTITION_CONFIG_BUFFER,
+              &hash);
+  HashConfigs(config.nnadapter_mixed_precision_quantization_config_buffer(),
+              config.nnadapter_mixed_precision_quantization_config_path(),
+              MIXED_PRECISION_QUANTIZATION_CONFIG_FILE,
+              MIXED_PRECISION_QUANTIZATION_CONFIG_BUFFER,
+              &hash);
+  HashConfigs("",
+              "",
+              QUANT_AUTO_COMPLETE_SCALE_CONFIG_FILE,
+              QUANT_AUTO_COMPLETE_SCALE_CONFIG_BUFFER,
+              &hash);
+  for (auto &name : OptimizerEnvNames()) {
+    HashString(name + "=" + GetStringFromEnv(name), &hash);
+  }
+  auto opencl_memory_config = GetStringFromEnv(OPENCL_MEMORY_CONFIG_FILE);
+  if (IsFileExists(opencl_memory_config)) {
+    HashFile(opencl_memory_config, &hash);
+  }
+  STL::stringstream options;
+  options << config.quant_model() << ","
+          << static_cast<int>(config.quant_type()) << ","
+          << config.sparse_model() << "," << config.sparse_threshold() << ","
+          << config.pack_weights();
+  HashString(options.str(), &hash);
+  HashString(version(), &hash);
+  char key[17];
+  snprintf(key, sizeof(key), "%016llx", static_cast<unsigned long long>(hash));
+  return key;
+}
+}  // namespace
+
 void Predictor::SaveModel(const std::string &dir,
                           lite_api::LiteModelType model_type,
                           bool record_info) {
@@ -305,6 +475,13 @@ const cpp::ProgramDesc &Predictor::program_desc() const {
 }
 const RuntimeProgram &Predictor::runtime_program() const { return *program_; }
 
+void Predictor::ShareWeights() {
+  CHECK(program_desc_);
+  CHECK(program_);
+  WeightStore::Global().Share(
+      scope_, *program_desc_, program_->WeightsRewrittenInPlace());
+}
+
 #ifdef ENABLE_ARM_FP16
 typedef __fp16 float16_t;
 void Predictor::WeightFP32ToFP16() {
@@ -357,6 +534,17 @@ void Predictor::Build(const lite_api::CxxConfig &config,
                       const std::vector<Place> &valid_places,
                       const std::vector<std::string> &passes,
                       lite_api::LiteModelType model_type) {
+  std::string cache_path;
+  if (!config.optimized_model_cache_dir().empty()) {
+    cache_path = config.optimized_model_cache_dir() + "/" +
+                 OptimizedModelCacheKey(
+                     config, valid_places, passes, model_type);
+    if (IsFileExists(cache_path + ".nb")) {
+      LOG(INFO) << "Load the optimized model from " << cache_path << ".nb";
+      BuildFromOptimizedModel(cache_path + ".nb", valid_places);
+      return;
+    }
+  }
   if (config.is_model_from_memory()) {
     LOG(INFO) << "Load model from memory.";
     Build(config.model_dir(),
@@ -377,6 +565,42 @@ void Predictor::Build(const lite_api::CxxConfig &config,
           model_type,
           config);
   }
+  if (!cache_path.empty()) {
+    // Save to a temporary file first, so the concurrent processes never
+    // load a partially written model.
+    MkDirRecur(config.optimized_model_cache_dir());
+    const auto stamp = std::chrono::steady_clock::now().time_since_epoch();
+    const std::string tmp_path =
+        cache_path + ".tmp" + std::to_string(stamp.count());
+    SaveModel(tmp_path, lite_api::LiteModelType::kNaiveBuffer);
+    if (std::rename((tmp_path + ".nb").c_str(), (cache_path + ".nb").c_str())) {
+      LOG(WARNING) << "Failed to cache the optimized model to " << cache_path
+                   << ".nb";
+      std::remove((tmp_path + ".nb").c_str());
+    }
+  }
+}
+
+void Predictor::BuildFromOptimizedModel(
+    const std::string &model_file, const std::vector<Place> &valid_places) {
+  LoadModelNaiveFromFile(model_file, scope_.get(), program_desc_.get());
+  // The kernels are picked by the kernel type attrs of the ops, the same as
+  // the cloned predictor. The places are the ones the model is optimized
+  // with, so that the clones pick the same kernels as the ones of a model
+  // optimized in this process.
+  std::vector<Place> inner_places = InnerPlaces(
+      valid_places,
+      IsQuantizedMode(program_desc_) || HasInt8Ops(program_desc_));
+  Program program(program_desc_, scope_, inner_places);
+  exec_scope_ = program.exec_scope();
+  valid_places_ = inner_places;
+  program_.reset(
+      new RuntimeProgram(program_desc_, exec_scope_, kRootBlockIdx));
+  if (program_desc_->HasVersion()) {
+    program_->set_version(program_desc_->Version());
+  }
+  program_generated_ = true;
+  PrepareFeedFetch();
 }
 void Predictor::Build(const std::string &model_path,
                       const std::string &model_file,
@@ -418,34 +642,8 @@ void Predictor::Build(const std::shared_ptr<cpp::ProgramDesc> &program_desc,
                       const lite_api::CxxConfig &config) {
   program_desc_ = program_desc;
   // `inner_places` is used to optimize passes
-  std::vector<Place> inner_places = valid_places;
-  for (auto &valid_place : valid_places) {
-    if (valid_place.target == TARGET(kOpenCL)) continue;
-    inner_places.emplace_back(
-        Place(TARGET(kHost), valid_place.precision, valid_place.layout));
-  }
-
-  if (IsQuantizedMode(program_desc_)) {
-    for (auto &valid_place : valid_places) {
-      if (valid_place.target == TARGET(kARM)) {
-        inner_places.insert(inner_places.begin(),
-                            Place{TARGET(kARM), PRECISION(kInt8)});
-      }
-      if (valid_place.target == TARGET(kX86)) {
-        inner_places.insert(inner_places.begin(),
-                            Place{TARGET(kX86), PRECISION(kInt8)});
-      }
-    }
-  }
-  // XPU target must make sure to insert in front of others.
-  if (IsQuantizedMode(program_desc_)) {
-    for (auto &valid_place : valid_places) {
-      if (valid_place.target == TARGET(kXPU)) {
-        inner_places.insert(inner_places.begin(),
-                            Place{TARGET(kXPU), PRECISION(kInt8)});
-      }
-    }
-  }
+  std::vector<Place> inner_places =
+      InnerPlaces(valid_places, IsQuantizedMode(program_desc_));
   Program program(program_desc_, scope_, inner_places);
   valid_places_ = inner_places;
 
@@ -467,6 +665,9 @@ void Predictor::Build(const std::shared_ptr<cpp::ProgramDesc> &program_desc,
   // the same with that in models.
   CheckPaddleOpVersions(program_desc);
 
+  if (config.pack_weights()) {
+    program_->PackWeights();
+  }
   // Update the runtime program to program_desc only once
   program_->SaveRuntimProgramIntoProgramDesc(program_desc_);
 
@@ -500,13 +701,57 @@ void Predictor::Run() {
   lite::TargetWrapperXPU::MallocL3Cache(query_shape);
 #endif
 
+  if (!output_binding_.empty()) {
+    output_binding_.Attach(exec_scope_, output_names_);
+  }
   program_->Run();
+  if (!output_binding_.empty()) {
+    output_binding_.Sync(exec_scope_, output_names_);
+  }
 
 #ifdef LITE_WITH_XPU
   lite::TargetWrapperXPU::FreeL3Cache();
 #endif
 }
 
+void Predictor::BindOutput(size_t offset,
+                           void *data,
+                           size_t memory_size,
+                           TargetType target) {
+  CHECK_LT(offset, output_names_.size())
+      << "The network has " << output_names_.size() << " outputs"
+      << ", the offset should be less than this.";
+  output_binding_.Bind(offset, data, memory_size, target);
+}
+
+void Predictor::UnbindOutput(size_t offset) {
+  CHECK_LT(offset, output_names_.size())
+      << "The network has " << output_names_.size() << " outputs"
+      << ", the offset should be less than this.";
+  auto *var = exec_scope_->FindVar(output_names_[offset]);
+  CHECK(var) << "no fetch variable " << output_names_[offset]
+             << " in exec_scope";
+  output_binding_.Unbind(offset, var->GetMutable<lite::Tensor>());
+}
+
+void Predictor::BindState(const std::string &input_name,
+                          const std::string &output_name) {
+  CHECK(std::find(input_names_.begin(), input_names_.end(), input_name) !=
+        input_names_.end())
+      << "The state input " << input_name << " is not an input of the model.";
+  CHECK(std::find(output_names_.begin(), output_names_.end(), output_name) !=
+        output_names_.end())
+      << "The state output " << output_name
+      << " is not an output of the model.";
+  stream_states_.Bind(input_name, output_name);
+}
+
+void Predictor::RunStream(int id) {
+  stream_states_.Attach(exec_scope_, id);
+  Run();
+  stream_states_.Sync(exec_scope_, id);
+}
+
 const lite::Tensor *Predictor::GetTensor(const std::string &name) const {
   auto *var = exec_scope_->FindVar(name);
   CHECK(var) << "no variable named with " << name << " in exec_scope";
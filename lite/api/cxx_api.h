@@ -22,7 +22,9 @@
 #include "lite/api/paddle_api.h"
 #include "lite/core/op_lite.h"
 #include "lite/core/optimizer/optimizer.h"
+#include "lite/core/output_binding.h"
 #include "lite/core/program.h"
+#include "lite/core/stream_states.h"
 #include "lite/core/types.h"
 #include "lite/model_parser/model_parser.h"
 
@@ -156,6 +158,10 @@ class LITE_API Predictor {
 
   void GenRuntimeProgram();
 
+  // Build from an optimized naive buffer model, the optimizer is skipped.
+  void BuildFromOptimizedModel(const std::string& model_file,
+                               const std::vector<Place>& valid_places);
+
   // Run the predictor for a single batch of data.
   void Run();
 
@@ -194,8 +200,24 @@ class LITE_API Predictor {
   // Get offset-th col of fetch results.
   const lite::Tensor* GetOutput(size_t offset) const;
   std::vector<const lite::Tensor*> GetOutputs() const;
+  // Write offset-th col of fetch results into the memory of the caller.
+  void BindOutput(size_t offset,
+                  void* data,
+                  size_t memory_size,
+                  TargetType target);
+  void UnbindOutput(size_t offset);
+  // Carry a fetch result over to a feed input between the runs of a stream.
+  void BindState(const std::string& input_name, const std::string& output_name);
+  int CreateStream() { return stream_states_.CreateStream(); }
+  int CloneStream(int id) { return stream_states_.CloneStream(id); }
+  void ResetStream(int id) { stream_states_.ResetStream(id); }
+  void ReleaseStream(int id) { stream_states_.ReleaseStream(id); }
+  void RunStream(int id);
 
   const cpp::ProgramDesc& program_desc() const;
+  // Share the weights identical to the ones of the other predictors through
+  // the process-wide WeightStore, only valid once the weights are final.
+  void ShareWeights();
   // get a mutable tensor according to its name
   lite::Tensor* GetMutableTensor(const std::string& name);
   // get a const tensor according to its name
@@ -252,6 +274,8 @@ class LITE_API Predictor {
   std::vector<std::string> output_names_;
   std::vector<Place> valid_places_;
   std::vector<PrecisionType> input_precisions_;
+  OutputBinding output_binding_;
+  StreamStates stream_states_;
 };
 
 class CxxPaddleApiImpl : public lite_api::PaddlePredictor {
@@ -285,6 +309,22 @@ class CxxPaddleApiImpl : public lite_api::PaddlePredictor {
   /// \return a boolean variable.
   bool TryShrinkMemory() override;
 
+  lite_api::MemoryStats GetMemoryStats(int top_k = 10) const override;
+
+  void BindOutput(int i,
+                  void* data,
+                  size_t memory_size,
+                  TargetType target = TargetType::kHost) override;
+  void UnbindOutput(int i) override;
+
+  void BindState(const std::string& input_name,
+                 const std::string& output_name) override;
+  int CreateStream() override;
+  int CloneStream(int id) override;
+  void ResetStream(int id) override;
+  void ReleaseStream(int id) override;
+  void RunStream(int id) override;
+
   std::shared_ptr<lite_api::PaddlePredictor> Clone() override;
 
   std::shared_ptr<lite_api::PaddlePredictor> Clone(
@@ -322,6 +362,11 @@ class CxxPaddleApiImpl : public lite_api::PaddlePredictor {
   lite_api::CxxConfig config_;
   std::mutex mutex_;
   bool status_is_cloned_;
+  // Counts the buffers allocated by Init and Run.
+  std::shared_ptr<MemoryTracker> memory_tracker_{
+      std::make_shared<MemoryTracker>()};
+  // The x86 cpus the threads of Run are bound to, empty if they are not bound.
+  std::vector<int> x86_bind_cpus_;
 };
 
 /*
@@ -37,10 +37,14 @@
 #endif
 #include "lite/backends/x86/mklml.h"
 #endif
+#if (defined LITE_WITH_X86) && !(defined LITE_ON_MODEL_OPTIMIZE_TOOL)
+#include "lite/backends/x86/cpu_info.h"
+#endif
 namespace paddle {
 namespace lite {
 
 void CxxPaddleApiImpl::Init(const lite_api::CxxConfig &config) {
+  MemoryTrackerGuard memory_tracker_guard(memory_tracker_);
   config_ = config;
   mode_ = config.power_mode();
   threads_ = config.threads();
@@ -123,6 +127,9 @@ void CxxPaddleApiImpl::Init(const lite_api::CxxConfig &config) {
     }
 
     raw_predictor_->Build(config, places, passes);
+    if (config.share_weights()) {
+      raw_predictor_->ShareWeights();
+    }
   } else {
     raw_predictor_->PrepareFeedFetch();
     CHECK(raw_predictor_) << "The Predictor can not be nullptr in Clone mode.";
@@ -149,6 +156,16 @@ void CxxPaddleApiImpl::Init(const lite_api::CxxConfig &config) {
           << real_num_threads;
 #endif
 
+#if (defined LITE_WITH_X86) && !(defined LITE_ON_MODEL_OPTIMIZE_TOOL)
+  x86_bind_cpus_ =
+      x86::PredictorCpus(config.x86_cpu_bind_cores(), config.x86_numa_node());
+  if (!x86_bind_cpus_.empty() &&
+      !x86::ScopedThreadBinding(x86_bind_cpus_).bound()) {
+    LOG(WARNING) << "Failed to bind the x86 threads of the predictor.";
+    x86_bind_cpus_.clear();
+  }
+#endif
+
 #ifdef LITE_WITH_XPU
   auto preferred_inputs = config.preferred_inputs_for_warmup();
   for (auto &preferred_input : preferred_inputs) {
@@ -239,8 +256,12 @@ std::vector<std::string> CxxPaddleApiImpl::GetOutputNames() {
 }
 
 void CxxPaddleApiImpl::Run() {
+  MemoryTrackerGuard memory_tracker_guard(memory_tracker_);
 #ifdef LITE_WITH_ARM
   lite::DeviceInfo::Global().SetRunMode(mode_, threads_);
+#endif
+#if (defined LITE_WITH_X86) && !(defined LITE_ON_MODEL_OPTIMIZE_TOOL)
+  x86::ScopedThreadBinding thread_binding(x86_bind_cpus_);
 #endif
   raw_predictor_->Run();
 }
@@ -286,6 +307,42 @@ bool CxxPaddleApiImpl::TryShrinkMemory() {
   return raw_predictor_->TryShrinkMemory();
 }
 
+lite_api::MemoryStats CxxPaddleApiImpl::GetMemoryStats(int top_k) const {
+  lite_api::MemoryStats stats;
+  raw_predictor_->runtime_program().GetMemoryStats(&stats, top_k);
+  stats.allocated_bytes = memory_tracker_->current();
+  stats.peak_allocated_bytes = memory_tracker_->peak();
+  return stats;
+}
+
+void CxxPaddleApiImpl::BindOutput(int i,
+                                  void *data,
+                                  size_t memory_size,
+                                  TargetType target) {
+  raw_predictor_->BindOutput(i, data, memory_size, target);
+}
+
+void CxxPaddleApiImpl::UnbindOutput(int i) { raw_predictor_->UnbindOutput(i); }
+
+void CxxPaddleApiImpl::BindState(const std::string &input_name,
+                                 const std::string &output_name) {
+  raw_predictor_->BindState(input_name, output_name);
+}
+
+int CxxPaddleApiImpl::CreateStream() { return raw_predictor_->CreateStream(); }
+
+int CxxPaddleApiImpl::CloneStream(int id) {
+  return raw_predictor_->CloneStream(id);
+}
+
+void CxxPaddleApiImpl::ResetStream(int id) { raw_predictor_->ResetStream(id); }
+
+void CxxPaddleApiImpl::ReleaseStream(int id) {
+  raw_predictor_->ReleaseStream(id);
+}
+
+void CxxPaddleApiImpl::RunStream(int id) { raw_predictor_->RunStream(id); }
+
 void CxxPaddleApiImpl::SetStream(TargetType target, void *stream) {
   raw_predictor_->SetStream(target, stream);
 }
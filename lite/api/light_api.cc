@@ -15,9 +15,13 @@
 #include "lite/api/light_api.h"
 #include <algorithm>
 #include <map>
+#include "lite/core/weight_store.h"
 #ifdef ENABLE_ARM_FP16
 #include "lite/backends/arm/math/fp16/funcs_fp16.h"
 #endif
+#ifdef LITE_WITH_X86
+#include "lite/backends/x86/math/gemm_bf16.h"
+#endif
 
 namespace paddle {
 namespace lite {
@@ -38,7 +42,13 @@ void LightPredictor::Run() {
   lite::TargetWrapperXPU::MallocL3Cache(query_shape);
 #endif
 
+  if (!output_binding_.empty()) {
+    output_binding_.Attach(program_->exec_scope(), output_names_);
+  }
   program_->Run();
+  if (!output_binding_.empty()) {
+    output_binding_.Sync(program_->exec_scope(), output_names_);
+  }
   if (bool_clear_tensor_) ClearTensorArray(program_desc_);
 
 #ifdef LITE_WITH_XPU
@@ -54,6 +64,10 @@ void LightPredictor::Build(const std::string& lite_model_file) {
 #ifdef ENABLE_ARM_FP16
   // fp16 Weight convert
   WeightFP32ToFP16();
+#endif
+#ifdef LITE_WITH_X86
+  // bf16 Weight convert
+  WeightFP32ToBF16();
 #endif
   BuildRuntimeProgram(program_desc_, use_low_precision_);
   PrepareFeedFetch();
@@ -71,6 +85,10 @@ void LightPredictor::Build(const char* lite_model_buffer_ptr,
 #ifdef ENABLE_ARM_FP16
   // fp16 Weight convert
   WeightFP32ToFP16();
+#endif
+#ifdef LITE_WITH_X86
+  // bf16 Weight convert
+  WeightFP32ToBF16();
 #endif
   BuildRuntimeProgram(program_desc_, use_low_precision_);
   PrepareFeedFetch();
@@ -105,6 +123,10 @@ void LightPredictor::Build(const std::string& model_dir,
 #ifdef ENABLE_ARM_FP16
   // fp16 Weight convert
   WeightFP32ToFP16();
+#endif
+#ifdef LITE_WITH_X86
+  // bf16 Weight convert
+  WeightFP32ToBF16();
 #endif
   BuildRuntimeProgram(program_desc_, use_low_precision_);
   PrepareFeedFetch();
@@ -190,6 +212,51 @@ const lite::Tensor* LightPredictor::GetOutput(size_t offset) {
 }
 #endif
 
+void LightPredictor::BindOutput(size_t offset,
+                                void* data,
+                                size_t memory_size,
+                                TargetType target) {
+  CHECK(output_names_.size() > offset)
+      << "The network has " << output_names_.size() << " outputs"
+      << ", the offset should be less than this.";
+  output_binding_.Bind(offset, data, memory_size, target);
+}
+
+void LightPredictor::UnbindOutput(size_t offset) {
+  CHECK(output_names_.size() > offset)
+      << "The network has " << output_names_.size() << " outputs"
+      << ", the offset should be less than this.";
+  auto* out_var = program_->exec_scope()->FindVar(output_names_.at(offset));
+  CHECK(out_var) << "no fatch variable " << output_names_.at(offset)
+                 << " in exec_scope";
+  output_binding_.Unbind(offset, out_var->GetMutable<lite::Tensor>());
+}
+
+void LightPredictor::ShareWeights() {
+  CHECK(program_desc_);
+  CHECK(program_);
+  WeightStore::Global().Share(
+      scope_, *program_desc_, program_->WeightsRewrittenInPlace());
+}
+
+void LightPredictor::BindState(const std::string& input_name,
+                               const std::string& output_name) {
+  CHECK(std::find(input_names_.begin(), input_names_.end(), input_name) !=
+        input_names_.end())
+      << "The state input " << input_name << " is not an input of the model.";
+  CHECK(std::find(output_names_.begin(), output_names_.end(), output_name) !=
+        output_names_.end())
+      << "The state output " << output_name
+      << " is not an output of the model.";
+  stream_states_.Bind(input_name, output_name);
+}
+
+void LightPredictor::RunStream(int id) {
+  stream_states_.Attach(program_->exec_scope(), id);
+  Run();
+  stream_states_.Sync(program_->exec_scope(), id);
+}
+
 // get inputs names
 std::vector<std::string> LightPredictor::GetInputNames() {
   return input_names_;
@@ -328,6 +395,9 @@ void LightPredictor::BuildRuntimeProgram(
   // block desc
   program_.reset(new RuntimeProgram(
       program_desc, exe_scope, kRootBlockIdx, use_low_precision_));
+  // The light predictor never saves the model nor shares its scope, so the
+  // raw weights replaced by the packed ones are not needed anymore.
+  program_->ReleasePackedRawWeights(*program_desc);
 }
 
 void LightPredictor::DequantizeWeight() {
@@ -496,6 +566,35 @@ void LightPredictor::WeightFP32ToFP16() {
 }
 #endif
 
+#ifdef LITE_WITH_X86
+void LightPredictor::WeightFP32ToBF16() {
+  std::shared_ptr<const cpp::ProgramDesc> program_desc = program_desc_;
+  for (size_t i = 0; i < program_desc->BlocksSize(); i++) {
+    auto* block = program_desc->GetBlock<cpp::BlockDesc>(i);
+    for (size_t k = 0; k < block->OpsSize(); ++k) {
+      auto* op_desc = block->GetOp<cpp::OpDesc>(k);
+      for (auto& input_name : op_desc->input_vars()) {
+        // the input is a bf16 weight, see bf16_attribute_pass
+        if (!op_desc->HasAttr(input_name + "_bf16")) continue;
+        auto input_tensor =
+            scope_->FindVar(input_name)->GetMutable<lite::Tensor>();
+        if (input_tensor->precision() != PRECISION(kFloat)) continue;
+
+        Tensor tmp_tensor;
+        tmp_tensor.CopyDataFrom(*input_tensor);
+        input_tensor->clear();
+        input_tensor->set_precision(PRECISION(kBF16));
+
+        uint16_t* bf_data =
+            input_tensor->mutable_data<lite_api::bfloat16, uint16_t>();
+        lite::x86::math::fp32_to_bf16(
+            tmp_tensor.data<float>(), bf_data, input_tensor->numel());
+      }
+    }
+  }
+}
+#endif
+
 void LightPredictor::CheckInputValid() {
   for (size_t idx = 0; idx < input_precisions_.size(); ++idx) {
     if (GetInput(idx)->precision() != input_precisions_[idx]) {
@@ -26,7 +26,9 @@
 #include <vector>
 #include "lite/api/paddle_api.h"
 #include "lite/core/context.h"
+#include "lite/core/output_binding.h"
 #include "lite/core/program.h"
+#include "lite/core/stream_states.h"
 #include "lite/core/tensor.h"
 #include "lite/core/types.h"
 #include "lite/model_parser/model_parser.h"
@@ -92,6 +94,22 @@ class LITE_API LightPredictor {
   const Tensor* GetOutputByName(const std::string& name);
   // Get offset-th col of fetch outputs.
   const Tensor* GetOutput(size_t offset);
+  // Write offset-th col of fetch outputs into the memory of the caller.
+  void BindOutput(size_t offset,
+                  void* data,
+                  size_t memory_size,
+                  TargetType target);
+  void UnbindOutput(size_t offset);
+  // Carry a fetch output over to a feed input between the runs of a stream.
+  void BindState(const std::string& input_name, const std::string& output_name);
+  int CreateStream() { return stream_states_.CreateStream(); }
+  int CloneStream(int id) { return stream_states_.CloneStream(id); }
+  void ResetStream(int id) { stream_states_.ResetStream(id); }
+  void ReleaseStream(int id) { stream_states_.ReleaseStream(id); }
+  void RunStream(int id);
+  // Share the weights identical to the ones of the other predictors through
+  // the process-wide WeightStore, only valid once the weights are final.
+  void ShareWeights();
 
   const lite::Tensor* GetTensor(const std::string& name) const {
     auto* var = program_->exec_scope()->FindVar(name);
@@ -106,6 +124,7 @@ class LITE_API LightPredictor {
   const std::vector<PrecisionType>& GetInputPrecisions() const;
   void PrepareFeedFetch();
   Scope* scope() { return scope_.get(); }
+  const RuntimeProgram& runtime_program() const { return *program_; }
 
 #ifdef LITE_WITH_METAL
   void ConfigMetalContext(const lite_api::MobileConfig& config) {
@@ -147,6 +166,10 @@ class LITE_API LightPredictor {
   void WeightFP32ToFP16();
 #endif
 
+#ifdef LITE_WITH_X86
+  void WeightFP32ToBF16();
+#endif
+
   void ClearTensorArray(
       const std::shared_ptr<const cpp::ProgramDesc>& program_desc);
 
@@ -159,6 +182,8 @@ class LITE_API LightPredictor {
   std::vector<std::string> output_names_;
   std::vector<PrecisionType> input_precisions_;
   bool bool_clear_tensor_ = false;
+  OutputBinding output_binding_;
+  StreamStates stream_states_;
 };
 
 class LightPredictorImpl : public lite_api::PaddlePredictor {
@@ -192,6 +217,22 @@ class LightPredictorImpl : public lite_api::PaddlePredictor {
   /// \return a boolean variable.
   bool TryShrinkMemory() override;
 
+  lite_api::MemoryStats GetMemoryStats(int top_k = 10) const override;
+
+  void BindOutput(int i,
+                  void* data,
+                  size_t memory_size,
+                  TargetType target = TargetType::kHost) override;
+  void UnbindOutput(int i) override;
+
+  void BindState(const std::string& input_name,
+                 const std::string& output_name) override;
+  int CreateStream() override;
+  int CloneStream(int id) override;
+  void ResetStream(int id) override;
+  void ReleaseStream(int id) override;
+  void RunStream(int id) override;
+
   void SetStream(TargetType target, void* stream) override;
   void Synchronize() {
 #ifdef LITE_WITH_XPU
@@ -203,6 +244,11 @@ class LightPredictorImpl : public lite_api::PaddlePredictor {
 
  private:
   std::unique_ptr<lite::LightPredictor> raw_predictor_;
+  // Counts the buffers allocated by Init and Run.
+  std::shared_ptr<MemoryTracker> memory_tracker_{
+      std::make_shared<MemoryTracker>()};
+  // The x86 cpus the threads of Run are bound to, empty if they are not bound.
+  std::vector<int> x86_bind_cpus_;
 };
 
 }  // namespace lite
@@ -28,11 +28,15 @@
     !(defined LITE_ON_MODEL_OPTIMIZE_TOOL)
 #include "lite/backends/x86/mklml.h"
 #endif
+#if (defined LITE_WITH_X86) && !(defined LITE_ON_MODEL_OPTIMIZE_TOOL)
+#include "lite/backends/x86/cpu_info.h"
+#endif
 
 namespace paddle {
 namespace lite {
 
 void LightPredictorImpl::Init(const lite_api::MobileConfig& config) {
+  MemoryTrackerGuard memory_tracker_guard(memory_tracker_);
   // LightPredictor Only support NaiveBuffer backend in publish lib
   auto use_low_precision =
       config.precision_mode() == lite_api::LITE_PRECISION_LOW ? true : false;
@@ -59,6 +63,10 @@ void LightPredictorImpl::Init(const lite_api::MobileConfig& config) {
                                             use_low_precision));
   }
 
+  if (config.share_weights()) {
+    raw_predictor_->ShareWeights();
+  }
+
   mode_ = config.power_mode();
   threads_ = config.threads();
   raw_predictor_->SetTargetConfigs(config.target_configs());
@@ -110,6 +118,16 @@ void LightPredictorImpl::Init(const lite_api::MobileConfig& config) {
              "number of threads is:"
           << real_num_threads;
 #endif
+
+#if (defined LITE_WITH_X86) && !(defined LITE_ON_MODEL_OPTIMIZE_TOOL)
+  x86_bind_cpus_ =
+      x86::PredictorCpus(config.x86_cpu_bind_cores(), config.x86_numa_node());
+  if (!x86_bind_cpus_.empty() &&
+      !x86::ScopedThreadBinding(x86_bind_cpus_).bound()) {
+    LOG(WARNING) << "Failed to bind the x86 threads of the predictor.";
+    x86_bind_cpus_.clear();
+  }
+#endif
 }
 
 LightPredictorImpl::~LightPredictorImpl() {
@@ -142,8 +160,12 @@ std::unique_ptr<const lite_api::Tensor> LightPredictorImpl::GetOutput(
 }
 
 void LightPredictorImpl::Run() {
+  MemoryTrackerGuard memory_tracker_guard(memory_tracker_);
 #ifdef LITE_WITH_ARM
   lite::DeviceInfo::Global().SetRunMode(mode_, threads_);
+#endif
+#if (defined LITE_WITH_X86) && !(defined LITE_ON_MODEL_OPTIMIZE_TOOL)
+  x86::ScopedThreadBinding thread_binding(x86_bind_cpus_);
 #endif
   raw_predictor_->Run();
 }
@@ -179,6 +201,48 @@ bool LightPredictorImpl::TryShrinkMemory() {
   return raw_predictor_->TryShrinkMemory();
 }
 
+lite_api::MemoryStats LightPredictorImpl::GetMemoryStats(int top_k) const {
+  lite_api::MemoryStats stats;
+  raw_predictor_->runtime_program().GetMemoryStats(&stats, top_k);
+  stats.allocated_bytes = memory_tracker_->current();
+  stats.peak_allocated_bytes = memory_tracker_->peak();
+  return stats;
+}
+
+void LightPredictorImpl::BindOutput(int i,
+                                    void* data,
+                                    size_t memory_size,
+                                    TargetType target) {
+  raw_predictor_->BindOutput(i, data, memory_size, target);
+}
+
+void LightPredictorImpl::UnbindOutput(int i) {
+  raw_predictor_->UnbindOutput(i);
+}
+
+void LightPredictorImpl::BindState(const std::string& input_name,
+                                   const std::string& output_name) {
+  raw_predictor_->BindState(input_name, output_name);
+}
+
+int LightPredictorImpl::CreateStream() {
+  return raw_predictor_->CreateStream();
+}
+
+int LightPredictorImpl::CloneStream(int id) {
+  return raw_predictor_->CloneStream(id);
+}
+
+void LightPredictorImpl::ResetStream(int id) {
+  raw_predictor_->ResetStream(id);
+}
+
+void LightPredictorImpl::ReleaseStream(int id) {
+  raw_predictor_->ReleaseStream(id);
+}
+
+void LightPredictorImpl::RunStream(int id) { raw_predictor_->RunStream(id); }
+
 void LightPredictorImpl::SetStream(TargetType target, void* stream) {
   raw_predictor_->SetStream(target, stream);
 }
@@ -20,6 +20,7 @@
 #include "lite/core/device_info.h"
 #include "lite/core/target_wrapper.h"
 #include "lite/core/tensor.h"
+#include "lite/core/weight_store.h"
 
 #ifdef LITE_WITH_XPU
 #include <functional>
@@ -76,6 +77,15 @@ int GetOpenCLDeviceType() {
   return -1;
 }
 
+WeightSharingStats GetWeightSharingStats() {
+  auto stats = paddle::lite::WeightStore::Global().GetStats();
+  WeightSharingStats res;
+  res.shared_tensors = stats.shared_tensors;
+  res.saved_bytes = stats.saved_bytes;
+  res.resident_bytes = stats.resident_bytes;
+  return res;
+}
+
 Tensor::Tensor(void *raw) : raw_tensor_(raw) {}
 
 // TODO(Superjomn) refine this by using another `const void* const_raw`;
@@ -248,6 +258,49 @@ std::vector<std::string> PaddlePredictor::GetParamNames() {
   return null_result;
 }
 
+MemoryStats PaddlePredictor::GetMemoryStats(int top_k) const {
+  LOG(FATAL) << "The GetMemoryStats API is not supported by this predictor.";
+  return MemoryStats();
+}
+
+void PaddlePredictor::BindOutput(int i,
+                                 void *data,
+                                 size_t memory_size,
+                                 TargetType target) {
+  LOG(FATAL) << "The BindOutput API is not supported by this predictor.";
+}
+
+void PaddlePredictor::UnbindOutput(int i) {
+  LOG(FATAL) << "The UnbindOutput API is not supported by this predictor.";
+}
+
+void PaddlePredictor::BindState(const std::string &input_name,
+                                const std::string &output_name) {
+  LOG(FATAL) << "The BindState API is not supported by this predictor.";
+}
+
+int PaddlePredictor::CreateStream() {
+  LOG(FATAL) << "The CreateStream API is not supported by this predictor.";
+  return -1;
+}
+
+int PaddlePredictor::CloneStream(int id) {
+  LOG(FATAL) << "The CloneStream API is not supported by this predictor.";
+  return -1;
+}
+
+void PaddlePredictor::ResetStream(int id) {
+  LOG(FATAL) << "The ResetStream API is not supported by this predictor.";
+}
+
+void PaddlePredictor::ReleaseStream(int id) {
+  LOG(FATAL) << "The ReleaseStream API is not supported by this predictor.";
+}
+
+void PaddlePredictor::RunStream(int id) {
+  LOG(FATAL) << "The RunStream API is not supported by this predictor.";
+}
+
 void PaddlePredictor::SaveOptimizedModel(const std::string &model_dir,
                                          LiteModelType model_type,
                                          bool record_info) {
@@ -391,6 +444,16 @@ void ConfigBase::set_x86_math_num_threads(int threads) {
   x86_math_num_threads_ = threads;
 }
 int ConfigBase::x86_math_num_threads() const { return x86_math_num_threads_; }
+void ConfigBase::set_x86_cpu_bind_cores(const std::vector<int> &cores) {
+  x86_cpu_bind_cores_ = cores;
+}
+const std::vector<int> &ConfigBase::x86_cpu_bind_cores() const {
+  return x86_cpu_bind_cores_;
+}
+void ConfigBase::set_x86_numa_node(int numa_node) {
+  x86_numa_node_ = numa_node;
+}
+int ConfigBase::x86_numa_node() const { return x86_numa_node_; }
 #endif
 
 void ConfigBase::set_subgraph_model_cache_buffers(
@@ -93,6 +93,40 @@ struct LITE_API Tensor {
   void* raw_tensor_;
 };
 
+/// Memory used by a predictor in bytes, see PaddlePredictor::GetMemoryStats.
+/// Tensors sharing a buffer are counted once.
+struct LITE_API MemoryStats {
+  // Persistable tensors, i.e. the weights.
+  int64_t weight_bytes{0};
+  // Activations needed by the current input shapes, after the reuse planned
+  // by memory_optimize_pass.
+  int64_t planned_activation_bytes{0};
+  // Buffers actually held by the activations, they only grow with the input
+  // shapes until TryShrinkMemory is called.
+  int64_t live_activation_bytes{0};
+  // High-water mark of the scratch buffers of the calling thread, i.e. the
+  // host workspace and the L3 cache workspace on ARM.
+  int64_t workspace_bytes{0};
+  // Buffers allocated by Init/Run of this predictor and not freed yet, and
+  // the peak of it.
+  int64_t allocated_bytes{0};
+  int64_t peak_allocated_bytes{0};
+  // The largest buffers in descending order as {tensor name, bytes}.
+  std::vector<std::pair<std::string, int64_t>> top_tensors;
+};
+
+/// Weights shared between the predictors created with share_weights on.
+struct LITE_API WeightSharingStats {
+  // Tensors pointing to a buffer of another predictor.
+  int64_t shared_tensors{0};
+  // Bytes not allocated thanks to the sharing.
+  int64_t saved_bytes{0};
+  // Bytes of the distinct buffers still held by the predictors.
+  int64_t resident_bytes{0};
+};
+
+LITE_API WeightSharingStats GetWeightSharingStats();
+
 /// The PaddlePredictor defines the basic interfaces for different kinds of
 /// predictors.
 class LITE_API PaddlePredictor {
@@ -122,6 +156,42 @@ class LITE_API PaddlePredictor {
   /// Release all tmp tensor to compress the size of the memory pool.
   virtual bool TryShrinkMemory() = 0;
 
+  /// Get the memory used by this predictor, with the `top_k` largest tensors.
+  /// The activations are only allocated by the first Run.
+  virtual MemoryStats GetMemoryStats(int top_k = 10) const;
+
+  /// Bind i-th output to the host memory `data` of `memory_size` bytes, the
+  /// following runs write the output into it, and GetOutput(i) shares it.
+  /// The kernel producing the output writes into `data` directly from the
+  /// second run. An output larger than `memory_size` is not written into
+  /// `data`, and is only returned by GetOutput(i).
+  /// The inputs can be bound by Tensor::ShareExternalMemory.
+  virtual void BindOutput(int i,
+                          void* data,
+                          size_t memory_size,
+                          TargetType target = TargetType::kHost);
+  /// Stop writing i-th output into the memory bound by BindOutput.
+  virtual void UnbindOutput(int i);
+
+  /// Carry the output `output_name` of a RunStream over to the input
+  /// `input_name` of the next RunStream of the same stream, e.g. the last
+  /// hidden state of a streaming RNN to its init hidden state. The states
+  /// stay in the predictor and are swapped instead of copied between runs.
+  virtual void BindState(const std::string& input_name,
+                         const std::string& output_name);
+  /// Create a stream and return its id. Its states start from zeros with the
+  /// dims of the state inputs, which should be set before its first run.
+  virtual int CreateStream();
+  /// Create a stream starting from a snapshot of the states of stream `id`.
+  virtual int CloneStream(int id);
+  /// Restart stream `id` from zeros.
+  virtual void ResetStream(int id);
+  virtual void ReleaseStream(int id);
+  /// Run the next chunk of stream `id` with the other inputs set as for Run.
+  /// Many streams can be interleaved on one predictor, their states are
+  /// updated in place.
+  virtual void RunStream(int id);
+
   // Get Input by name
   virtual std::unique_ptr<Tensor> GetInputByName(const std::string& name) = 0;
 
@@ -232,7 +302,10 @@ class LITE_API ConfigBase {
   // The buffers for loading the compiled NNAdapter models from memory.
   std::map<std::string, std::vector<char>> nnadapter_model_cache_buffers_{};
   int device_id_{0};
+  bool share_weights_{false};
   int x86_math_num_threads_ = 1;
+  std::vector<int> x86_cpu_bind_cores_{};
+  int x86_numa_node_{-1};
 
   std::string metal_path_;
   bool metal_use_mps_{false};
@@ -412,9 +485,20 @@ class LITE_API ConfigBase {
   // set Device ID
   void set_device_id(int device_id) { device_id_ = device_id; }
   int get_device_id() const { return device_id_; }
+  // share the weights identical to the ones of the other predictors in this
+  // process, see GetWeightSharingStats
+  void set_share_weights(bool share_weights) { share_weights_ = share_weights; }
+  bool share_weights() const { return share_weights_; }
   // set x86_math_num_threads
   void set_x86_math_num_threads(int threads);
   int x86_math_num_threads() const;
+  // pin the x86 math threads one to one onto the given logical cpus
+  void set_x86_cpu_bind_cores(const std::vector<int>& cores);
+  const std::vector<int>& x86_cpu_bind_cores() const;
+  // pin the x86 math threads to the physical cores of a NUMA node and
+  // allocate the tensors on it, ignored if x86_cpu_bind_cores is set
+  void set_x86_numa_node(int numa_node);
+  int x86_numa_node() const;
 
   void set_metal_lib_path(const std::string& path);
   void set_metal_use_mps(bool flag);
@@ -472,6 +556,8 @@ class LITE_API CxxConfig : public ConfigBase {
   QuantType quant_type_{QuantType::QUANT_INT16};
   bool sparse_model_{false};  // Enable sparse_conv_detect_pass in opt
   float sparse_threshold_{0.6f};
+  bool pack_weights_{false};  // Save the weights packed by kernels in opt
+  std::string optimized_model_cache_dir_;
   std::map<int, std::vector<std::shared_ptr<void>>>
       preferred_inputs_for_warmup_;
   // The custom configuration file or buffer for the NNAdapter subgraph
@@ -546,6 +632,22 @@ class LITE_API CxxConfig : public ConfigBase {
   }
   float sparse_threshold() const { return sparse_threshold_; }
 
+  // Run the weight transforms of the kernels, e.g. the prepacking of the
+  // int8 gemm, ahead of time and save the packed weights into the model.
+  void set_pack_weights(bool pack_weights) { pack_weights_ = pack_weights; }
+  bool pack_weights() const { return pack_weights_; }
+
+  // Cache the optimized model into the given dir, keyed by the model, the
+  // places, the passes, the environment variables read by the passes and the
+  // library version, so the next Build with the same inputs loads it instead
+  // of running the optimizer again.
+  void set_optimized_model_cache_dir(const std::string& dir) {
+    optimized_model_cache_dir_ = dir;
+  }
+  const std::string& optimized_model_cache_dir() const {
+    return optimized_model_cache_dir_;
+  }
+
   // Enable the custom subgraph partition for NNAdapter by providing the
   // configuration file or buffer
   void set_nnadapter_subgraph_partition_config_path(
@@ -76,7 +76,8 @@ enum class PrecisionType : int {
   kInt16 = 8,
   kUInt8 = 9,
   kFP64 = 10,
-  NUM = 11,  // number of fields.
+  kBF16 = 11,
+  NUM = 12,  // number of fields.
 };
 
 typedef enum {
@@ -164,6 +165,8 @@ static size_t PrecisionTypeLength(PrecisionType type) {
       return 8;
     case PrecisionType::kFP16:
       return 2;
+    case PrecisionType::kBF16:
+      return 2;
     case PrecisionType::kInt16:
       return 2;
     case PrecisionType::kBool:
@@ -214,6 +217,13 @@ typedef __fp16 float16_t;
 _ForEachPrecisionTypeHelper(DefinePrecisionTypeTrait, float16_t, kFP16);
 #endif
 
+// Storage type of bfloat16 data, which keeps the upper 16 bits of an IEEE-754
+// float32 value. Arithmetic is done in float32 by the kernels.
+struct bfloat16 {
+  uint16_t x;
+};
+_ForEachPrecisionTypeHelper(DefinePrecisionTypeTrait, bfloat16, kBF16);
+
 #undef _ForEachPrecisionTypeHelper
 #undef _ForEachPrecisionType
 #undef DefinePrecisionTypeTrait
@@ -32,6 +32,7 @@ USE_MIR_PASS(graph_visualize_pass);
 
 USE_MIR_PASS(sparse_conv_detect_pass);
 USE_MIR_PASS(adaptive_1x1_pool2d_convert_global_pass);
+USE_MIR_PASS(kv_cache_append_fuse_pass);
 USE_MIR_PASS(remove_scale1_pass);
 USE_MIR_PASS(remove_tf_redundant_ops_pass);
 USE_MIR_PASS(lite_conv_bn_fuse_pass);
@@ -67,6 +68,7 @@ USE_MIR_PASS(nnadapter_subgraph_pass);
 USE_MIR_PASS(weight_quantization_preprocess_pass);
 USE_MIR_PASS(post_quant_dynamic_pass);
 USE_MIR_PASS(fp16_attribute_pass);
+USE_MIR_PASS(bf16_attribute_pass);
 USE_MIR_PASS(quantization_parameters_propagation_pass);
 USE_MIR_PASS(quantization_parameters_removal_pass);
 USE_MIR_PASS(control_flow_op_shared_inputs_and_outputs_place_sync_pass);
@@ -77,8 +79,10 @@ USE_MIR_PASS(fix_mismatched_precision_pass);
 USE_MIR_PASS(lite_flatten_fc_fuse_pass);
 USE_MIR_PASS(lite_fc_prelu_fuse_pass);
 USE_MIR_PASS(lite_greater_than_cast_fuse_pass);
+USE_MIR_PASS(lite_embedding_seq_pool_fuse_pass);
 USE_MIR_PASS(assign_value_calc_offline_pass);
 USE_MIR_PASS(__xpu__graph_dedup_pass);
+USE_MIR_PASS(graph_dedup_pass);
 USE_MIR_PASS(__xpu__resnet_fuse_pass);
 USE_MIR_PASS(__xpu__spatial_transformer_fuse_pass);
 USE_MIR_PASS(__xpu__gn_silu_fuse_pass);
@@ -86,6 +90,7 @@ USE_MIR_PASS(__xpu__multihead_cross_attn_fuse_pass);
 USE_MIR_PASS(__xpu__multihead_self_attn_fuse_pass);
 USE_MIR_PASS(__xpu__geglu_fuse_pass);
 USE_MIR_PASS(__xpu__multi_encoder_fuse_pass);
+USE_MIR_PASS(x86_multi_encoder_fuse_pass);
 USE_MIR_PASS(__xpu__embedding_with_eltwise_add_fuse_pass);
 USE_MIR_PASS(__xpu__fc_fuse_pass);
 USE_MIR_PASS(__xpu__quick_gelu_fuse_pass);
@@ -108,6 +113,7 @@ USE_MIR_PASS(__xpu__generate_sequence_fuse_pass);
 USE_MIR_PASS(__xpu__logit_fuse_pass);
 USE_MIR_PASS(__xpu__link_previous_out_max_pass);
 USE_MIR_PASS(__xpu__squeeze_excitation_fuse_pass);
+USE_MIR_PASS(x86_squeeze_excitation_fuse_pass);
 USE_MIR_PASS(__xpu__bigru_fuse_pass);
 USE_MIR_PASS(__xpu__dynamic_lstm_fuse_pass);
 USE_MIR_PASS(__xpu__multi_softmax_fuse_pass);
@@ -122,6 +128,7 @@ USE_MIR_PASS(p_norm_fill_constant_max_div_fuse_pass);
 USE_MIR_PASS(fill_constant_calc_offline_pass);
 USE_MIR_PASS(unsqueeze_calc_offline_pass);
 USE_MIR_PASS(scale_calc_offline_pass);
+USE_MIR_PASS(constant_folding_pass);
 USE_MIR_PASS(reshape_calc_offline_pass);
 USE_MIR_PASS(keepdims_convert_pass);
 USE_MIR_PASS(op_fusion_minimal_set_pass);
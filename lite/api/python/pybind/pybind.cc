@@ -69,12 +69,14 @@ void BindLiteOpt(py::module *m) {
       .def("set_param_file", &OptBase::SetParamFile)
       .def("set_valid_places", &OptBase::SetValidPlaces)
       .def("enable_fp16", &OptBase::EnableFloat16)
+      .def("enable_bf16", &OptBase::EnableBFloat16)
       .def("set_optimize_out", &OptBase::SetOptimizeOut)
       .def("set_model_type", &OptBase::SetModelType)
       .def("set_quant_model", &OptBase::SetQuantModel)
       .def("set_quant_type", &OptBase::SetQuantType)
       .def("set_sparse_model", &OptBase::SetSparseModel)
       .def("set_sparse_threshold", &OptBase::SetSparseThreshold)
+      .def("set_pack_weights", &OptBase::SetPackWeights)
       .def("record_model_info", &OptBase::RecordModelInfo)
       .def("set_passes_internal", &OptBase::SetPassesInternal)
       .def("run", &OptBase::Run)
@@ -149,7 +151,9 @@ void BindLiteCxxConfig(py::module *m) {
                CxxConfig::set_model_buffer)
       .def("set_passes_internal", &CxxConfig::set_passes_internal)
       .def("is_model_from_memory", &CxxConfig::is_model_from_memory)
-      .def("add_discarded_pass", &CxxConfig::add_discarded_pass);
+      .def("add_discarded_pass", &CxxConfig::add_discarded_pass)
+      .def("set_optimized_model_cache_dir",
+           &CxxConfig::set_optimized_model_cache_dir);
   cxx_config.def("set_threads", &CxxConfig::set_threads)
       .def("threads", &CxxConfig::threads)
       .def("set_power_mode", &CxxConfig::set_power_mode)
@@ -290,7 +294,8 @@ void BindLitePlace(py::module *m) {
       .value("INT64", PrecisionType::kInt64)
       .value("INT16", PrecisionType::kInt16)
       .value("UINT8", PrecisionType::kUInt8)
-      .value("FP64", PrecisionType::kFP64);
+      .value("FP64", PrecisionType::kFP64)
+      .value("BF16", PrecisionType::kBF16);
 
   // DataLayoutType
   py::enum_<DataLayoutType>(*m, "DataLayoutType")
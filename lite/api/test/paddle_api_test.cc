@@ -15,6 +15,11 @@
 #include "lite/api/paddle_api.h"
 #include <gflags/gflags.h>
 #include <gtest/gtest.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
 #include "lite/utils/io.h"
 #include "lite/utils/log/cp_logging.h"
 
@@ -110,6 +115,116 @@ TEST(CxxApi, share_external_data) {
   EXPECT_NEAR(out[1], -28.8729, 1e-3);
 }
 
+// The optimized model is cached by a key of the model and the configs which
+// the optimizer depends on, any change of them misses the cache.
+TEST(CxxApi, optimized_model_cache) {
+  const std::string model_dir = FLAGS_model_dir + ".cache_model";
+  const std::string cache_dir = FLAGS_model_dir + ".cache";
+  auto clear_dir = [](const std::string& dir) {
+    lite::MkDirRecur(dir);
+    for (auto& file : lite::ListFile(dir)) {
+      std::remove((dir + "/" + file).c_str());
+    }
+  };
+  clear_dir(model_dir);
+  clear_dir(cache_dir);
+  // A copy of the model, which is modified to invalidate the cache
+  std::string params_file;
+  for (auto& file : lite::ListFile(FLAGS_model_dir)) {
+    std::vector<char> contents;
+    ASSERT_TRUE(lite::ReadFile(FLAGS_model_dir + "/" + file, &contents));
+    ASSERT_TRUE(lite::WriteFile(model_dir + "/" + file, contents));
+    if (file != "__model__") params_file = model_dir + "/" + file;
+  }
+  ASSERT_FALSE(params_file.empty());
+
+  auto count_cached_models = [&]() {
+    int count = 0;
+    for (auto& file : lite::ListFile(cache_dir)) {
+      if (file.size() > 3 && file.substr(file.size() - 3) == ".nb") count++;
+    }
+    return count;
+  };
+  auto run = [&](const CxxConfig& config) {
+    auto predictor = CreatePaddlePredictor(config);
+    auto input_tensor = predictor->GetInput(0);
+    input_tensor->Resize(std::vector<int64_t>({100, 100}));
+    auto* data = input_tensor->mutable_data<float>();
+    for (int i = 0; i < 100 * 100; i++) {
+      data[i] = i;
+    }
+    predictor->Run();
+    auto output = predictor->GetOutput(0);
+    int64_t numel = 1;
+    for (auto dim : output->shape()) {
+      numel *= dim;
+    }
+    return std::vector<float>(output->data<float>(),
+                              output->data<float>() + numel);
+  };
+
+  CxxConfig config;
+  config.set_model_dir(model_dir);
+  config.set_valid_places({
+      Place{TARGET(kX86), PRECISION(kFloat)},
+      Place{TARGET(kARM), PRECISION(kFloat)},
+  });
+  config.set_optimized_model_cache_dir(cache_dir);
+  auto ref = run(config);
+  EXPECT_NEAR(ref[0], 50.2132, 1e-3);
+  EXPECT_EQ(count_cached_models(), 1);
+
+  // hit
+  EXPECT_EQ(run(config), ref);
+  EXPECT_EQ(count_cached_models(), 1);
+
+  // miss by the configs of the passes
+  config.set_nnadapter_context_properties("DEVICE_ID=0");
+  EXPECT_EQ(run(config), ref);
+  EXPECT_EQ(count_cached_models(), 2);
+  config.set_nnadapter_subgraph_partition_config_buffer("fc:a:fc_0.tmp_0");
+  run(config);
+  EXPECT_EQ(count_cached_models(), 3);
+  config.set_nnadapter_mixed_precision_quantization_config_buffer("scale");
+  run(config);
+  EXPECT_EQ(count_cached_models(), 4);
+  EXPECT_EQ(run(config), ref);
+  EXPECT_EQ(count_cached_models(), 4);
+
+  // miss by the environment variables read by the passes
+  setenv("GRAPH_DEDUP_ENABLE", "true", 1);
+  EXPECT_EQ(run(config), ref);
+  EXPECT_EQ(count_cached_models(), 5);
+  unsetenv("GRAPH_DEDUP_ENABLE");
+  EXPECT_EQ(run(config), ref);
+  EXPECT_EQ(count_cached_models(), 5);
+
+  // a clone of a predictor loaded from the cache runs the same
+  auto predictor = CreatePaddlePredictor(config);
+  auto clone = predictor->Clone();
+  auto clone_input = clone->GetInput(0);
+  clone_input->Resize(std::vector<int64_t>({100, 100}));
+  auto* clone_data = clone_input->mutable_data<float>();
+  for (int i = 0; i < 100 * 100; i++) {
+    clone_data[i] = i;
+  }
+  clone->Run();
+  EXPECT_NEAR(clone->GetOutput(0)->data<float>()[0], ref[0], 1e-5);
+
+  // invalidated by the model, an empty file is hashed as well
+  ASSERT_TRUE(lite::WriteFile(model_dir + "/empty", std::vector<char>()));
+  EXPECT_EQ(run(config), ref);
+  EXPECT_EQ(count_cached_models(), 6);
+  std::vector<char> params;
+  ASSERT_TRUE(lite::ReadFile(params_file, &params));
+  ASSERT_GE(params.size(), sizeof(float));
+  const float value = 1000.f;
+  memcpy(params.data() + params.size() - sizeof(float), &value, sizeof(float));
+  ASSERT_TRUE(lite::WriteFile(params_file, params));
+  EXPECT_NE(run(config), ref);
+  EXPECT_EQ(count_cached_models(), 7);
+}
+
 // Demo1 for Mobile Devices :Load model from file and run
 #ifdef LITE_WITH_ARM
 TEST(LightApi, run) {
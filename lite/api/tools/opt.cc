@@ -48,6 +48,7 @@ DEFINE_string(quant_type,
               "Set the quant_type for post_quant_dynamic, "
               "and it should be QUANT_INT8 or QUANT_INT16 for now.");
 DEFINE_bool(enable_fp16, false, "Set kernel_type run in FP16.");
+DEFINE_bool(enable_bf16, false, "Set x86 kernel_type run in BF16.");
 DEFINE_bool(record_tailoring_info,
             false,
             "Record kernels and operators information of the optimized model "
@@ -74,6 +75,10 @@ DEFINE_bool(sparse_model,
 DEFINE_double(sparse_threshold,
               0.6,
               "Set 0.6 as the lower bound for the sparse conv pass.");
+DEFINE_bool(pack_weights,
+            false,
+            "Save the weights packed by the kernels, e.g. the x86 int8 conv, "
+            "into the model, so the loader needs not to pack them.");
 DEFINE_string(optimized_nb_model_path,
               "",
               "path of the optimized nb model, this argument is use for the "
@@ -116,6 +121,7 @@ int main(int argc, char** argv) {
   }
   if (FLAGS_valid_targets != "") {
     if (FLAGS_enable_fp16) opt.EnableFloat16();
+    if (FLAGS_enable_bf16) opt.EnableBFloat16();
     opt.SetValidPlaces(FLAGS_valid_targets);
   }
   if (FLAGS_nnadapter_mixed_precision_quantization_config_path != "") {
@@ -134,6 +140,9 @@ int main(int argc, char** argv) {
     opt.SetSparseModel(true);
     opt.SetSparseThreshold(FLAGS_sparse_threshold);
   }
+  if (FLAGS_pack_weights) {
+    opt.SetPackWeights(true);
+  }
   if (FLAGS_print_all_ops) {
     opt.PrintAllOps();
     return 0;
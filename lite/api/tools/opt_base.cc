@@ -82,6 +82,10 @@ void OptBase::SetSparseThreshold(float sparse_threshold) {
   }
 }
 
+void OptBase::SetPackWeights(bool pack_weights) {
+  opt_config_.set_pack_weights(pack_weights);
+}
+
 void OptBase::SetNNAdapterMixedPrecisionQuantizationConfigPath(
     const std::string& nnadapter_mixed_precision_quantization_config_path) {
   opt_config_.set_nnadapter_mixed_precision_quantization_config_path(
@@ -173,6 +177,9 @@ void OptBase::SetValidPlaces(const std::string& valid_places) {
       valid_places_.emplace_back(TARGET(kX86));
       valid_places_.emplace_back(TARGET(kHost));
     } else if (target_repr == "x86") {
+      if (enable_bf16_) {
+        valid_places_.emplace_back(Place{TARGET(kX86), PRECISION(kBF16)});
+      }
       valid_places_.emplace_back(Place{TARGET(kX86), PRECISION(kFloat)});
       valid_places_.emplace_back(Place{TARGET(kX86), PRECISION(kInt64)});
       valid_places_.emplace_back(Place{TARGET(kX86), PRECISION(kAny)});
@@ -458,8 +465,12 @@ void OptBase::PrintExecutableBinHelpInfo() {
       "  Arguements of sparse convolution in opt: \n"
       "        `--sparse_model=(true|false)`\n"
       "        `--sparse_threshold=(float)`\n"
+      "  Arguments of ahead-of-time weight packing in opt: \n"
+      "        `--pack_weights=(true|false)`\n"
       "  Arguments of enable_fp16 in opt: \n"
       "        `--enable_fp16=(true|false)`\n"
+      "  Arguments of enable_bf16 in opt (x86 only): \n"
+      "        `--enable_bf16=(true|false)`\n"
       "  Arguments of model checking and ops information:\n"
       "        `--print_all_ops=true`   Display all the valid operators of "
       "Paddle-Lite\n"
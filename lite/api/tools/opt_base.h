@@ -49,6 +49,7 @@ class LITE_API OptBase {
   void SetModelFile(const std::string &model_path);
   void SetParamFile(const std::string &param_path);
   void EnableFloat16() { enable_fp16_ = true; }
+  void EnableBFloat16() { enable_bf16_ = true; }
   void SetValidPlaces(const std::string &valid_places);
   void SetOptimizeOut(const std::string &lite_out_name);
   void RecordModelInfo(bool record_strip_info = true);
@@ -56,6 +57,7 @@ class LITE_API OptBase {
   void SetQuantType(const std::string &quant_type);
   void SetSparseModel(bool sparse_model);
   void SetSparseThreshold(const float sparse_threshold = 0.6f);
+  void SetPackWeights(bool pack_weights);
   void SetNNAdapterMixedPrecisionQuantizationConfigPath(
       const std::string &nnadapter_mixed_precision_quantization_config_path);
   // set optimized_model type
@@ -110,6 +112,7 @@ class LITE_API OptBase {
 
  private:
   bool enable_fp16_{false};
+  bool enable_bf16_{false};
   CxxConfig opt_config_;
   // valid places for the optimized_model
   std::vector<Place> valid_places_;
@@ -14,153 +14,61 @@
 
 #include "lite/backends/host/math/beam_search.h"
 #include <cmath>
-#include <string>
 #include <vector>
 
 namespace paddle {
 namespace lite {
 namespace host {
 namespace math {
-/*
-* The basic items help to sort.
-*/
-struct Item {
-  Item() {}
-  Item(size_t offset, size_t id, float score)
-      : offset(offset), id(id), score(score) {}
-  // offset in the higher lod level.
-  size_t offset;
-  // prefix id in the lower lod level.
-  // size_t prefix;
-  // the candidate id
-  size_t id;
-  // the corresponding score
-  float score;
-
-  inline bool operator<(const Item &in) const {
-    return (score < in.score) || ((score == in.score) && (offset < in.offset));
-  }
 
-  inline void operator=(const Item &in) {
-    offset = in.offset;
-    id = in.id;
-    score = in.score;
-  }
-
-  std::string ToString() {
-    std::ostringstream os;
-    os << "{";
-    os << "offset: " << offset << ", ";
-    os << "id: " << id << ", ";
-    os << "score: " << score << "";
-    os << "}";
-    return os.str();
-  }
-};
-LoD ToAbsOffset(const LoD &in) {
-  if (in.empty() || in.size() == 1) return in;
-  LoD result = in;
+void ToAbsOffset(const LoD &in, LoD *out) {
+  *out = in;
+  if (in.empty() || in.size() == 1) return;
+  LoD &result = *out;
   for (auto level = static_cast<int>(in.size() - 2); level >= 0; level--) {
     for (size_t i = 0; i < in[level].size(); ++i) {
       size_t index = in[level][i];
       result[level][i] = result[level + 1][index];
     }
   }
-  return result;
 }
 
 /*
- * Prune the source sentences all branchs finished, and it is optional.
- * Pruning must one step later than finishing (thus pre_ids is needed here),
- * since the end tokens must be writed out.
+ * Insert the item into top, which holds num items sorted by score, and
+ * return the new number of items.
  */
-void PruneEndBeams(const Tensor *pre_ids,
-                   const LoD &abs_lod,
-                   std::vector<std::vector<Item>> *items,
-                   size_t lod_level,
-                   int end_id) {
-  auto *pre_ids_data = pre_ids->data<int64_t>();
-  auto &high_level = abs_lod[lod_level];
-  for (size_t src_idx = 0; src_idx < high_level.size() - 1; ++src_idx) {
-    size_t src_prefix_start = high_level[src_idx];
-    size_t src_prefix_end = high_level[src_idx + 1];
-    bool finish_flag = true;
-    for (size_t offset = src_prefix_start; offset < src_prefix_end; offset++) {
-      for (auto &item : items->at(offset)) {
-        if (item.id != static_cast<size_t>(end_id) ||
-            pre_ids_data[offset] != end_id) {
-          finish_flag = false;
-          break;
-        }
-      }
-      if (!finish_flag) break;
-    }
-    if (finish_flag) {  // all branchs of the beam (source sentence) end and
-                        // prune this beam
-      for (size_t offset = src_prefix_start; offset < src_prefix_end; offset++)
-        items->at(offset).clear();
-    }
-  }
-}
-
-/*
- * Transform the items into a map whose key is offset, value is the items.
- * NOTE low performance.
- */
-std::vector<std::vector<Item>> ToMap(
-    const std::vector<std::vector<Item>> &items, size_t element_num) {
-  std::vector<std::vector<Item>> result;
-  result.resize(element_num);
-  for (auto &entries : items) {
-    for (const auto &item : entries) {
-      result[item.offset].push_back(item);
-    }
-  }
-  return result;
-}
-
-void Insert(std::vector<Item> *top_beam_ptr,
-            const Item &item,
-            size_t beam_size) {
-  std::vector<Item> &top_beam = *top_beam_ptr;
-
-  size_t num_beams = top_beam.size();
-  if (num_beams < beam_size) {
-    top_beam.resize(num_beams + 1);
-    num_beams++;
-  } else {
-    if (item < top_beam[beam_size - 1]) {
-      return;
-    }
+inline size_t Insert(BeamItem *top,
+                     size_t num,
+                     const BeamItem &item,
+                     size_t beam_size) {
+  if (num < beam_size) {
+    num++;
+  } else if (item < top[beam_size - 1]) {
+    return num;
   }
-
-  for (int k = static_cast<int>(num_beams) - 2; k >= 0; --k) {
-    if (top_beam[k] < item) {
-      top_beam[k + 1] = top_beam[k];
-    } else {
-      top_beam[k + 1] = item;
-      return;
-    }
+  int k = static_cast<int>(num) - 2;
+  for (; k >= 0 && top[k] < item; --k) {
+    top[k + 1] = top[k];
   }
-  top_beam[0] = item;
+  top[k + 1] = item;
+  return num;
 }
 
 /*
- * For each source, select top beam_size records.
+ * For each source, select top beam_size records in a single pass over the
+ * candidates. The log of the probabilities is fused into the selection and
+ * only taken for the candidates which may enter the beam.
  */
-std::vector<std::vector<Item>> SelectTopBeamSizeItems(const Tensor *pre_ids,
-                                                      const Tensor *pre_scores,
-                                                      const Tensor *ids,
-                                                      const Tensor *scores,
-                                                      size_t lod_level,
-                                                      size_t beam_size,
-                                                      int end_id,
-                                                      bool is_accumulated) {
-  std::vector<std::vector<Item>> result;
-
-  // find the current candidates
-  // auto abs_lod = framework::ToAbsOffset(scores->lod());
-  auto abs_lod = ToAbsOffset(scores->lod());
+void SelectTopBeamSizeItems(const Tensor *pre_ids,
+                            const Tensor *pre_scores,
+                            const Tensor *ids,
+                            const Tensor *scores,
+                            size_t lod_level,
+                            size_t beam_size,
+                            int end_id,
+                            bool is_accumulated,
+                            BeamSearchState *state) {
+  const auto &abs_lod = state->abs_lod;
   auto *pre_ids_data = pre_ids->data<int64_t>();
   auto *pre_scores_data = pre_scores->data<float>();
 
@@ -173,12 +81,13 @@ std::vector<std::vector<Item>> SelectTopBeamSizeItems(const Tensor *pre_ids,
     seq_width *= scores->dims()[i];
   }
 
+  state->top_items.resize(num_seqs * beam_size);
+  state->top_nums.assign(num_seqs, 0);
   for (size_t seq_id = 0; seq_id < num_seqs; ++seq_id) {
     size_t seq_offset_start = abs_lod[lod_level][seq_id];
     size_t seq_offset_end = abs_lod[lod_level][seq_id + 1];
-
-    std::vector<Item> top_beam;
-    top_beam.reserve(beam_size);
+    BeamItem *top = state->top_items.data() + seq_id * beam_size;
+    size_t num = 0;
 
     for (size_t offset = seq_offset_start; offset < seq_offset_end; ++offset) {
       auto pre_id = pre_ids_data[offset];
@@ -186,24 +95,65 @@ std::vector<std::vector<Item>> SelectTopBeamSizeItems(const Tensor *pre_ids,
       if (pre_id == end_id) {
         // Allocate all probability mass to end_id for finished branchs and
         // the other candidate ids can be ignored.
-        Item item(offset, end_id, pre_score);
-        Insert(&top_beam, item, beam_size);
-      } else {
-        size_t index = offset * seq_width;
-        for (size_t d = 0; d < seq_width; d++, index++) {
-          int64_t id = ids_data ? ids_data[index] : static_cast<int64_t>(d);
-          float score = is_accumulated
-                            ? scores_data[index]
-                            : pre_score + std::log(scores_data[index]);
-          Item item(offset, id, score);
-          Insert(&top_beam, item, beam_size);
+        num = Insert(top, num, {offset, end_id, pre_score}, beam_size);
+        continue;
+      }
+      size_t index = offset * seq_width;
+      // The candidates scored below the lowest in the full beam are
+      // rejected without computing their scores, the threshold is loosened
+      // a little so the rounding never rejects a candidate entering the beam.
+      float min_prob = 0.f;
+      auto update_min_prob = [&]() {
+        if (num == beam_size && !is_accumulated) {
+          double min_score = top[beam_size - 1].score;
+          min_prob = static_cast<float>(std::exp(
+              min_score - pre_score - 1e-4 * (1. + std::fabs(min_score))));
         }
+      };
+      update_min_prob();
+      for (size_t d = 0; d < seq_width; d++, index++) {
+        float prob = scores_data[index];
+        if (num == beam_size) {
+          if (is_accumulated ? prob < top[beam_size - 1].score
+                             : prob < min_prob) {
+            continue;
+          }
+        }
+        int64_t id = ids_data ? ids_data[index] : static_cast<int64_t>(d);
+        float score = is_accumulated ? prob : pre_score + std::log(prob);
+        num = Insert(top, num, {offset, id, score}, beam_size);
+        update_min_prob();
       }
     }
+    state->top_nums[seq_id] = num;
+  }
+}
 
-    result.emplace_back(top_beam);
+/*
+ * Prune the source sentences all branchs finished, and it is optional.
+ * Pruning must one step later than finishing (thus pre_ids is needed here),
+ * since the end tokens must be writed out.
+ */
+void PruneEndBeams(const Tensor *pre_ids,
+                   size_t beam_size,
+                   int end_id,
+                   BeamSearchState *state) {
+  auto *pre_ids_data = pre_ids->data<int64_t>();
+  for (size_t seq_id = 0; seq_id < state->top_nums.size(); ++seq_id) {
+    const BeamItem *top = state->top_items.data() + seq_id * beam_size;
+    size_t num = state->top_nums[seq_id];
+    bool finish_flag = true;
+    for (size_t i = 0; i < num; i++) {
+      if (top[i].id != end_id || pre_ids_data[top[i].offset] != end_id) {
+        finish_flag = false;
+        break;
+      }
+    }
+    if (finish_flag) {  // all branchs of the beam (source sentence) end and
+                        // prune this beam
+      state->top_nums[seq_id] = 0;
+    }
   }
-  return result;
 }
 
 void beam_search(const Tensor *pre_ids,
@@ -216,60 +166,76 @@ void beam_search(const Tensor *pre_ids,
                  int level,
                  int beam_size,
                  int end_id,
-                 bool is_accumulated) {
-  auto abs_lod = ToAbsOffset(scores->lod());
-  auto &high_level = abs_lod[level];
-  auto items = SelectTopBeamSizeItems(pre_ids,
-                                      pre_scores,
-                                      ids,
-                                      scores,
-                                      level,
-                                      beam_size,
-                                      end_id,
-                                      is_accumulated);
-  auto selected_items = ToMap(items, high_level.back());
+                 bool is_accumulated,
+                 BeamSearchState *state) {
+  BeamSearchState local_state;
+  if (!state) state = &local_state;
+  ToAbsOffset(scores->lod(), &state->abs_lod);
+  const auto &high_level = state->abs_lod[level];
+  SelectTopBeamSizeItems(pre_ids,
+                         pre_scores,
+                         ids,
+                         scores,
+                         level,
+                         beam_size,
+                         end_id,
+                         is_accumulated,
+                         state);
+  PruneEndBeams(pre_ids, beam_size, end_id, state);
+
+  // Order the candidates of every source by the prefix they extend, the
+  // sources are ordered already.
+  auto &selected_items = state->selected_items;
+  selected_items.clear();
+  for (size_t seq_id = 0; seq_id < state->top_nums.size(); ++seq_id) {
+    BeamItem *top = state->top_items.data() + seq_id * beam_size;
+    size_t num = state->top_nums[seq_id];
+    // A stable insertion sort, which allocates nothing for the few items.
+    for (size_t i = 1; i < num; i++) {
+      BeamItem item = top[i];
+      size_t j = i;
+      for (; j > 0 && top[j - 1].offset > item.offset; j--) {
+        top[j] = top[j - 1];
+      }
+      top[j] = item;
+    }
+    selected_items.insert(selected_items.end(), top, top + num);
+  }
 
-  PruneEndBeams(pre_ids, abs_lod, &selected_items, level, end_id);
-  // calculate the output tensor's height
-  size_t num_instances = std::accumulate(
-      std::begin(selected_items),
-      std::end(selected_items),
-      0,
-      [](size_t a, std::vector<Item> &b) { return a + b.size(); });
   // the output tensor shape should be [num_instances, 1]
-  auto dims = std::vector<int64_t>({static_cast<int>(num_instances), 1});
-  selected_ids->Resize(dims);
-  selected_scores->Resize(dims);
+  int64_t num_instances = static_cast<int64_t>(selected_items.size());
+  selected_ids->Resize({num_instances, 1});
+  selected_scores->Resize({num_instances, 1});
   if (parent_idx) {
-    parent_idx->Resize({static_cast<int64_t>(num_instances)});
+    parent_idx->Resize({num_instances});
   }
   auto *selected_ids_data = selected_ids->mutable_data<int64_t>();
   auto *selected_scores_data = selected_scores->mutable_data<float>();
   auto *parent_idx_data =
       parent_idx ? parent_idx->mutable_data<int>() : nullptr;
 
-  // fill in data
-  std::vector<size_t> low_level;
+  // fill in data and lod
+  LoD *lod = selected_ids->mutable_lod();
+  lod->resize(2);
+  (*lod)[0].assign(high_level.begin(), high_level.end());
+  auto &low_level = (*lod)[1];
+  low_level.clear();
   size_t low_offset = 0;
-  for (auto &items : selected_items) {
+  for (size_t offset = 0; offset < high_level.back(); ++offset) {
     low_level.push_back(low_offset);
-    for (auto &item : items) {
+    for (; low_offset < selected_items.size() &&
+           selected_items[low_offset].offset == offset;
+         low_offset++) {
+      const auto &item = selected_items[low_offset];
       if (parent_idx) {
-        parent_idx_data[low_offset] = static_cast<int>(low_level.size() - 1);
+        parent_idx_data[low_offset] = static_cast<int>(offset);
       }
       selected_ids_data[low_offset] = item.id;
       selected_scores_data[low_offset] = item.score;
-      low_offset++;
     }
   }
   low_level.push_back(low_offset);
-
-  // fill lod
-  LoD lod(2);
-  lod[0].assign(high_level.begin(), high_level.end());
-  lod[1].assign(low_level.begin(), low_level.end());
-  *(selected_ids->mutable_lod()) = lod;
-  *(selected_scores->mutable_lod()) = lod;
+  *(selected_scores->mutable_lod()) = *lod;
 }
 
 }  // namespace math
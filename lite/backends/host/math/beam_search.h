@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #pragma once
+#include <vector>
 #include "lite/core/context.h"
 
 namespace paddle {
@@ -20,6 +21,35 @@ namespace lite {
 namespace host {
 namespace math {
 
+/*
+ * A candidate of beam search.
+ */
+struct BeamItem {
+  // offset in the higher lod level, i.e. the prefix it extends.
+  size_t offset;
+  // the candidate id
+  int64_t id;
+  // the corresponding score
+  float score;
+
+  inline bool operator<(const BeamItem &in) const {
+    return (score < in.score) || ((score == in.score) && (offset < in.offset));
+  }
+};
+
+/*
+ * The buffers of beam search kept by the kernel across the decoding steps,
+ * they only grow so a step allocates nothing once the beams are full.
+ */
+struct BeamSearchState {
+  LoD abs_lod;
+  // The top beam_size candidates of every source sorted by score.
+  std::vector<BeamItem> top_items;
+  std::vector<size_t> top_nums;
+  // The candidates left after pruning, sorted by offset.
+  std::vector<BeamItem> selected_items;
+};
+
 void beam_search(const Tensor* pre_ids,
                  const Tensor* pre_scores,
                  const Tensor* ids,
@@ -30,7 +60,8 @@ void beam_search(const Tensor* pre_ids,
                  int level,
                  int beam_size,
                  int end_id,
-                 bool is_accumulated);
+                 bool is_accumulated,
+                 BeamSearchState *state = nullptr);
 
 }  // namespace math
 }  // namespace host
@@ -0,0 +1,178 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/backends/host/math/gather.h"
+#include <algorithm>
+#include <cstring>
+#include "lite/core/parallel_defines.h"
+
+namespace paddle {
+namespace lite {
+namespace host {
+namespace math {
+
+namespace {
+
+// The bytes copied by a thread at a time, large enough to hide the task
+// overhead for the small rows.
+const int64_t kGatherChunkBytes = 64 * 1024;
+// The columns accumulated by a thread at a time.
+const int64_t kScatterColBlock = 256;
+
+inline void prefetch(const void *ptr) {
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(ptr);
+#endif
+}
+
+// Copy a row, the rows of a single element are common when gathering the
+// innermost axis, skip the call of memcpy for them.
+inline void copy_row(char *dst, const char *src, size_t bytes) {
+  switch (bytes) {
+    case 1:
+      *dst = *src;
+      break;
+    case 2:
+      *reinterpret_cast<uint16_t *>(dst) =
+          *reinterpret_cast<const uint16_t *>(src);
+      break;
+    case 4:
+      *reinterpret_cast<uint32_t *>(dst) =
+          *reinterpret_cast<const uint32_t *>(src);
+      break;
+    case 8:
+      *reinterpret_cast<uint64_t *>(dst) =
+          *reinterpret_cast<const uint64_t *>(src);
+      break;
+    default:
+      std::memcpy(dst, src, bytes);
+  }
+}
+
+template <typename IndexT>
+void check_index(const IndexT *index, int64_t index_size, int64_t bound) {
+  for (int64_t i = 0; i < index_size; i++) {
+    CHECK(index[i] >= 0 && index[i] < bound)
+        << "The index " << static_cast<int64_t>(index[i])
+        << " is out of range [0, " << bound << ")";
+  }
+}
+
+}  // namespace
+
+template <typename IndexT>
+void gather_axis(const void *src,
+                 const IndexT *index,
+                 void *out,
+                 int64_t outer,
+                 int64_t axis_size,
+                 int64_t index_size,
+                 int64_t inner,
+                 size_t elem_size) {
+  check_index(index, index_size, axis_size);
+  const int64_t rows = outer * index_size;
+  const size_t row_bytes = inner * elem_size;
+  if (rows == 0 || row_bytes == 0) return;
+  const int64_t rows_per_chunk =
+      std::max<int64_t>(1, kGatherChunkBytes / row_bytes);
+  const int num_chunks =
+      static_cast<int>((rows + rows_per_chunk - 1) / rows_per_chunk);
+  const char *src_data = static_cast<const char *>(src);
+  char *out_data = static_cast<char *>(out);
+
+  LITE_PARALLEL_BEGIN(c, tid, num_chunks) {
+    const int64_t begin = c * rows_per_chunk;
+    const int64_t end = std::min(rows, begin + rows_per_chunk);
+    int64_t o = begin / index_size;
+    int64_t i = begin - o * index_size;
+    const char *src_outer = src_data + o * axis_size * row_bytes;
+    for (int64_t r = begin; r < end; r++) {
+      // The rows are picked randomly, fetch the next one ahead of the copy.
+      if (i + 1 < index_size) {
+        prefetch(src_outer + index[i + 1] * row_bytes);
+      }
+      copy_row(out_data + r * row_bytes,
+               src_outer + index[i] * row_bytes,
+               row_bytes);
+      if (++i == index_size) {
+        i = 0;
+        src_outer += axis_size * row_bytes;
+      }
+    }
+  }
+  LITE_PARALLEL_END()
+}
+
+template <typename T, typename IndexT>
+void scatter_add_rows(const IndexT *index,
+                      int64_t index_size,
+                      const T *updates,
+                      T *dst,
+                      int64_t num_rows,
+                      int64_t inner) {
+  check_index(index, index_size, num_rows);
+  if (index_size == 0 || inner == 0) return;
+  const int num_blocks =
+      static_cast<int>((inner + kScatterColBlock - 1) / kScatterColBlock);
+
+  LITE_PARALLEL_BEGIN(b, tid, num_blocks) {
+    const int64_t col_begin = b * kScatterColBlock;
+    const int64_t cols = std::min(kScatterColBlock, inner - col_begin);
+    for (int64_t i = 0; i < index_size; i++) {
+      T *dst_row = dst + index[i] * inner + col_begin;
+      const T *update_row = updates + i * inner + col_begin;
+      for (int64_t j = 0; j < cols; j++) {
+        dst_row[j] += update_row[j];
+      }
+    }
+  }
+  LITE_PARALLEL_END()
+}
+
+template void gather_axis<int32_t>(const void *src,
+                                   const int32_t *index,
+                                   void *out,
+                                   int64_t outer,
+                                   int64_t axis_size,
+                                   int64_t index_size,
+                                   int64_t inner,
+                                   size_t elem_size);
+template void gather_axis<int64_t>(const void *src,
+                                   const int64_t *index,
+                                   void *out,
+                                   int64_t outer,
+                                   int64_t axis_size,
+                                   int64_t index_size,
+                                   int64_t inner,
+                                   size_t elem_size);
+
+#define INSTANTIATE_SCATTER_ADD_ROWS(T, IndexT)                       \
+  template void scatter_add_rows<T, IndexT>(const IndexT *index,     \
+                                            int64_t index_size,      \
+                                            const T *updates,        \
+                                            T *dst,                  \
+                                            int64_t num_rows,        \
+                                            int64_t inner);
+INSTANTIATE_SCATTER_ADD_ROWS(float, int32_t)
+INSTANTIATE_SCATTER_ADD_ROWS(float, int64_t)
+INSTANTIATE_SCATTER_ADD_ROWS(int32_t, int32_t)
+INSTANTIATE_SCATTER_ADD_ROWS(int32_t, int64_t)
+INSTANTIATE_SCATTER_ADD_ROWS(int64_t, int32_t)
+INSTANTIATE_SCATTER_ADD_ROWS(int64_t, int64_t)
+#undef INSTANTIATE_SCATTER_ADD_ROWS
+
+}  // namespace math
+}  // namespace host
+}  // namespace lite
+}  // namespace paddle
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #pragma once
+#include <stdint.h>
 #include "lite/core/tensor.h"
 
 namespace paddle {
@@ -20,22 +21,42 @@ namespace lite {
 namespace host {
 namespace math {
 
+// Gather along the axis of src viewed as [outer, axis_size, inner], i.e.
+// out[o, i, :] = src[o, index[i], :] and out is [outer, index_size, inner].
+// The rows of inner * elem_size bytes are copied as blocks and split over
+// the threads, the indices are checked to be in [0, axis_size).
+template <typename IndexT>
+void gather_axis(const void *src,
+                 const IndexT *index,
+                 void *out,
+                 int64_t outer,
+                 int64_t axis_size,
+                 int64_t index_size,
+                 int64_t inner,
+                 size_t elem_size);
+
+// dst[index[i], :] += updates[i, :] for dst of [num_rows, inner]. The same
+// row may be indexed many times, so the threads split the columns and each
+// element is accumulated in the order of the indices.
+template <typename T, typename IndexT>
+void scatter_add_rows(const IndexT *index,
+                      int64_t index_size,
+                      const T *updates,
+                      T *dst,
+                      int64_t num_rows,
+                      int64_t inner);
+
 template <typename T, typename IndexT = int>
 void Gather(const Tensor &src, const Tensor &index, Tensor *output) {
-  auto *p_src = src.data<T>();
-  auto *p_index = index.data<IndexT>();
-  auto *p_output = output->mutable_data<T>();
-
   auto src_dims = src.dims();
-  int64_t slice_size = 1;
-  for (size_t i = 1; i < src_dims.size(); i++) slice_size *= src_dims[i];
-  size_t slice_bytes = slice_size * sizeof(T);
-
-  int64_t index_size = index.numel();
-  for (int64_t i = 0; i < index_size; i++) {
-    IndexT index_ = p_index[i];
-    memcpy(p_output + i * slice_size, p_src + index_ * slice_size, slice_bytes);
-  }
+  gather_axis<IndexT>(src.data<T>(),
+                      index.data<IndexT>(),
+                      output->mutable_data<T>(),
+                      1,
+                      src_dims[0],
+                      index.numel(),
+                      src_dims.count(1, src_dims.size()),
+                      sizeof(T));
 }
 
 }  // namespace math
@@ -20,12 +20,25 @@
 #elif defined(_WIN32)
 #define NOMINMAX  // msvc max/min macro conflict with std::min/max
 #define GLOG_NO_ABBREVIATED_SEVERITIES
+#include <intrin.h>
 #include <windows.h>
 #else
 #include <unistd.h>
 #endif  // _WIN32
 
+#if defined(__linux__)
+#include <dirent.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#endif
+
 #include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
 #include "lite/utils/log/cp_logging.h"
 
 #include "lite/utils/env.h"
@@ -35,6 +48,10 @@
 #include "xbyak/xbyak_util.h"
 #endif
 
+#ifdef PADDLE_WITH_MKLML
+#include <omp.h>
+#endif
+
 // DEFINE_double(fraction_of_cpu_memory_to_use,
 //               1,
 //               "Default use 100% of CPU memory for PaddlePaddle,"
@@ -121,6 +138,8 @@ bool MayIUse(const cpu_isa_t cpu_isa) {
       return true && cpu.has(Cpu::tAVX512F) && cpu.has(Cpu::tAVX512BW) &&
              cpu.has(Cpu::tAVX512VL) && cpu.has(Cpu::tAVX512DQ) &&
              cpu.has(Cpu::tAVX512_VNNI);
+    case avx512_core_bf16:
+      return true && MayIUse(avx512_core) && cpu.has(Cpu::tAVX512_BF16);
     case avx512_mic:
       return true && cpu.has(Cpu::tAVX512F) && cpu.has(Cpu::tAVX512CD) &&
              cpu.has(Cpu::tAVX512ER) && cpu.has(Cpu::tAVX512PF);
@@ -142,6 +161,354 @@ bool MayIUse(const cpu_isa_t cpu_isa) {
 }
 #endif
 
+static void cpuid(uint32_t leaf, uint32_t subleaf, uint32_t regs[4]) {
+#if defined(_WIN32)
+  int info[4];
+  __cpuidex(info, static_cast<int>(leaf), static_cast<int>(subleaf));
+  for (int i = 0; i < 4; ++i) {
+    regs[i] = static_cast<uint32_t>(info[i]);
+  }
+#else
+  asm volatile("cpuid\n"
+               : "=a"(regs[0]), "=b"(regs[1]), "=c"(regs[2]), "=d"(regs[3])
+               : "a"(leaf), "c"(subleaf)
+               : "cc");
+#endif
+}
+
+// Deterministic cache parameters of CPUID leaf 4, see the Intel SDM vol. 2A.
+static void ReadCacheByCpuid(CpuTopology* topo) {
+  uint32_t regs[4];
+  cpuid(0, 0, regs);
+  if (regs[0] < 4) {
+    return;
+  }
+  for (uint32_t i = 0; i < 16; ++i) {
+    cpuid(4, i, regs);
+    const uint32_t type = regs[0] & 0x1f;  // 1 data, 2 instruction, 3 unified
+    if (type == 0) {
+      break;
+    }
+    if (type == 2) {
+      continue;
+    }
+    const uint32_t level = (regs[0] >> 5) & 0x7;
+    const size_t ways = ((regs[1] >> 22) & 0x3ff) + 1;
+    const size_t partitions = ((regs[1] >> 12) & 0x3ff) + 1;
+    const size_t line_size = (regs[1] & 0xfff) + 1;
+    const size_t sets = static_cast<size_t>(regs[2]) + 1;
+    const size_t size = ways * partitions * line_size * sets;
+    if (level == 1) {
+      topo->l1d_cache_size = size;
+    } else if (level == 2) {
+      topo->l2_cache_size = size;
+    } else if (level == 3) {
+      topo->l3_cache_size = size;
+    }
+  }
+}
+
+std::vector<int> ParseCpuList(const std::string& list) {
+  std::vector<int> cpus;
+  size_t pos = 0;
+  while (pos < list.size()) {
+    size_t end = list.find(',', pos);
+    if (end == std::string::npos) {
+      end = list.size();
+    }
+    const std::string range = list.substr(pos, end - pos);
+    const size_t dash = range.find('-');
+    if (!range.empty()) {
+      const int first = std::atoi(range.c_str());
+      const int last = dash == std::string::npos
+                           ? first
+                           : std::atoi(range.c_str() + dash + 1);
+      for (int cpu = first; cpu <= last; ++cpu) {
+        cpus.push_back(cpu);
+      }
+    }
+    pos = end + 1;
+  }
+  return cpus;
+}
+
+size_t ParseCacheSize(const std::string& size) {
+  size_t bytes = std::strtoul(size.c_str(), nullptr, 10);
+  if (size.find('K') != std::string::npos) {
+    bytes <<= 10;
+  } else if (size.find('M') != std::string::npos) {
+    bytes <<= 20;
+  }
+  return bytes;
+}
+
+#if defined(__linux__)
+static bool ReadFile(const std::string& path, std::string* content) {
+  std::ifstream fin(path);
+  if (!fin.good()) {
+    return false;
+  }
+  std::getline(fin, *content);
+  return true;
+}
+
+static int ReadInt(const std::string& path, int default_value) {
+  std::string content;
+  if (!ReadFile(path, &content) || content.empty()) {
+    return default_value;
+  }
+  return std::atoi(content.c_str());
+}
+
+static void ReadTopologyBySysfs(CpuTopology* topo) {
+  const std::string cpu_root = "/sys/devices/system/cpu/cpu";
+  const int num_cpus = static_cast<int>(topo->core_ids.size());
+  for (int cpu = 0; cpu < num_cpus; ++cpu) {
+    const std::string dir = cpu_root + std::to_string(cpu) + "/topology/";
+    topo->core_ids[cpu] = ReadInt(dir + "core_id", cpu);
+    topo->package_ids[cpu] = ReadInt(dir + "physical_package_id", 0);
+  }
+
+  for (int index = 0;; ++index) {
+    const std::string dir =
+        cpu_root + "0/cache/index" + std::to_string(index) + "/";
+    std::string type, size;
+    if (!ReadFile(dir + "type", &type) || !ReadFile(dir + "size", &size)) {
+      break;
+    }
+    if (type == "Instruction") {
+      continue;
+    }
+    const int level = ReadInt(dir + "level", 0);
+    if (level == 1) {
+      topo->l1d_cache_size = ParseCacheSize(size);
+    } else if (level == 2) {
+      topo->l2_cache_size = ParseCacheSize(size);
+    } else if (level == 3) {
+      topo->l3_cache_size = ParseCacheSize(size);
+    }
+  }
+
+  DIR* node_dir = opendir("/sys/devices/system/node");
+  if (node_dir == nullptr) {
+    return;
+  }
+  int max_node = 0;
+  while (struct dirent* entry = readdir(node_dir)) {
+    const std::string name = entry->d_name;
+    if (name.compare(0, 4, "node") != 0 || name.size() == 4 ||
+        !std::isdigit(name[4])) {
+      continue;
+    }
+    const int node = std::atoi(name.c_str() + 4);
+    std::string list;
+    if (!ReadFile("/sys/devices/system/node/" + name + "/cpulist", &list)) {
+      continue;
+    }
+    for (int cpu : ParseCpuList(list)) {
+      if (cpu < num_cpus) {
+        topo->numa_nodes[cpu] = node;
+      }
+    }
+    max_node = std::max(max_node, node);
+  }
+  closedir(node_dir);
+  topo->num_numa_nodes = max_node + 1;
+}
+#endif  // __linux__
+
+const CpuTopology& GetCpuTopology() {
+  static const CpuTopology topo = [] {
+    CpuTopology topo;
+    int num_cpus = static_cast<int>(std::thread::hardware_concurrency());
+#if defined(__linux__)
+    num_cpus = std::max(num_cpus,
+                        static_cast<int>(sysconf(_SC_NPROCESSORS_CONF)));
+#endif
+    num_cpus = std::max(num_cpus, 1);
+    topo.core_ids.resize(num_cpus);
+    topo.package_ids.assign(num_cpus, 0);
+    topo.numa_nodes.assign(num_cpus, 0);
+    for (int cpu = 0; cpu < num_cpus; ++cpu) {
+      topo.core_ids[cpu] = cpu;
+    }
+#if defined(__linux__)
+    ReadTopologyBySysfs(&topo);
+#endif
+    if (topo.l1d_cache_size == 0 && topo.l2_cache_size == 0) {
+      ReadCacheByCpuid(&topo);
+    }
+    VLOG(3) << "x86 cpus: " << num_cpus
+            << ", numa nodes: " << topo.num_numa_nodes
+            << ", L1d: " << topo.l1d_cache_size
+            << ", L2: " << topo.l2_cache_size
+            << ", L3: " << topo.l3_cache_size;
+    return topo;
+  }();
+  return topo;
+}
+
+size_t L1CacheSize() {
+  size_t size = GetCpuTopology().l1d_cache_size;
+  return size > 0 ? size : 32 * 1024;
+}
+
+size_t L2CacheSize() {
+  size_t size = GetCpuTopology().l2_cache_size;
+  return size > 0 ? size : 256 * 1024;
+}
+
+size_t L3CacheSize() {
+  size_t size = GetCpuTopology().l3_cache_size;
+  return size > 0 ? size : L2CacheSize();
+}
+
+std::vector<int> CpuList(int numa_node, bool physical_only) {
+  const auto& topo = GetCpuTopology();
+  std::vector<int> cpus;
+  std::vector<std::pair<int, int>> cores;  // (package, core) already taken
+  for (int cpu = 0; cpu < static_cast<int>(topo.core_ids.size()); ++cpu) {
+    if (numa_node >= 0 && topo.numa_nodes[cpu] != numa_node) {
+      continue;
+    }
+    if (physical_only) {
+      std::pair<int, int> core(topo.package_ids[cpu], topo.core_ids[cpu]);
+      if (std::find(cores.begin(), cores.end(), core) != cores.end()) {
+        continue;
+      }
+      cores.push_back(core);
+    }
+    cpus.push_back(cpu);
+  }
+  return cpus;
+}
+
+#if defined(__linux__)
+static bool SetAffinity(const int* cpus, int num_cpus) {
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  for (int i = 0; i < num_cpus; ++i) {
+    CPU_SET(cpus[i], &mask);
+  }
+  // pid 0 is the calling thread
+  return sched_setaffinity(0, sizeof(mask), &mask) == 0;
+}
+
+// Replace the affinity of the calling thread by cpus, and save the previous
+// one into `saved`.
+static bool SwapAffinity(const int* cpus,
+                         int num_cpus,
+                         std::vector<char>* saved) {
+  saved->resize(sizeof(cpu_set_t));
+  if (sched_getaffinity(
+          0, sizeof(cpu_set_t), reinterpret_cast<cpu_set_t*>(saved->data()))) {
+    saved->clear();
+    return false;
+  }
+  return SetAffinity(cpus, num_cpus);
+}
+
+static void RestoreAffinity(const std::vector<char>& saved) {
+  if (!saved.empty()) {
+    sched_setaffinity(
+        0, sizeof(cpu_set_t), reinterpret_cast<const cpu_set_t*>(saved.data()));
+  }
+}
+#endif
+
+std::vector<int> PredictorCpus(const std::vector<int>& cpus, int numa_node) {
+  std::vector<int> bind_cpus = cpus;
+  if (bind_cpus.empty() && numa_node >= 0) {
+    bind_cpus = CpuList(numa_node, true);
+    if (bind_cpus.empty()) {
+      LOG(WARNING) << "No cpu is found on the numa node " << numa_node;
+    }
+  }
+  const auto& topo = GetCpuTopology();
+  for (int cpu : bind_cpus) {
+    if (cpu < 0 || cpu >= static_cast<int>(topo.numa_nodes.size())) {
+      LOG(WARNING) << "Invalid cpu " << cpu << " to bind";
+      return {};
+    }
+  }
+  return bind_cpus;
+}
+
+ScopedThreadBinding::ScopedThreadBinding(const std::vector<int>& cpus) {
+#if defined(__linux__)
+  if (cpus.empty()) {
+    return;
+  }
+#ifdef PADDLE_WITH_MKLML
+  const int num_threads = omp_get_max_threads();
+  affinities_.resize(num_threads);
+  std::vector<int> rets(num_threads, 0);
+#pragma omp parallel num_threads(num_threads)
+  {
+    const int tid = omp_get_thread_num();
+    rets[tid] = SwapAffinity(&cpus[tid % cpus.size()], 1, &affinities_[tid]);
+  }
+  bound_ = std::find(rets.begin(), rets.end(), 0) == rets.end();
+#else
+  affinities_.resize(1);
+  bound_ = SwapAffinity(
+      cpus.data(), static_cast<int>(cpus.size()), &affinities_[0]);
+#endif  // PADDLE_WITH_MKLML
+
+#if defined(SYS_get_mempolicy) && defined(SYS_set_mempolicy)
+  const auto& topo = GetCpuTopology();
+  if (bound_ && topo.num_numa_nodes > 1) {
+    constexpr int kMpolPreferred = 1;
+    constexpr int kMaxNodes = 1024;
+    constexpr int kBitsPerLong = 8 * sizeof(unsigned long);  // NOLINT
+    const int numa_node = topo.numa_nodes[cpus[0]];
+    mempolicy_nodes_.assign(kMaxNodes / kBitsPerLong, 0);
+    if (syscall(SYS_get_mempolicy,
+                &mempolicy_mode_,
+                mempolicy_nodes_.data(),
+                kMaxNodes,
+                nullptr,
+                0) != 0) {
+      mempolicy_nodes_.clear();
+      bound_ = false;
+    } else {
+      std::vector<unsigned long> node_mask(kMaxNodes / kBitsPerLong,  // NOLINT
+                                           0);
+      node_mask[numa_node / kBitsPerLong] |= 1UL << (numa_node % kBitsPerLong);
+      bound_ = syscall(SYS_set_mempolicy,
+                       kMpolPreferred,
+                       node_mask.data(),
+                       kMaxNodes) == 0;
+    }
+  }
+#endif
+#endif  // __linux__
+}
+
+ScopedThreadBinding::~ScopedThreadBinding() {
+#if defined(__linux__)
+#if defined(SYS_set_mempolicy)
+  if (!mempolicy_nodes_.empty()) {
+    syscall(SYS_set_mempolicy,
+            mempolicy_mode_,
+            mempolicy_nodes_.data(),
+            mempolicy_nodes_.size() * 8 * sizeof(unsigned long));  // NOLINT
+  }
+#endif
+  if (affinities_.empty()) {
+    return;
+  }
+#ifdef PADDLE_WITH_MKLML
+  // The omp threads of the same team size are reused in the same order.
+  const int num_threads = static_cast<int>(affinities_.size());
+#pragma omp parallel num_threads(num_threads)
+  { RestoreAffinity(affinities_[omp_get_thread_num()]); }
+#else
+  RestoreAffinity(affinities_[0]);
+#endif  // PADDLE_WITH_MKLML
+#endif  // __linux__
+}
+
 }  // namespace x86
 }  // namespace lite
 }  // namespace paddle
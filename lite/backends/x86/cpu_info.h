@@ -15,6 +15,8 @@
 #pragma once
 
 #include <stddef.h>
+#include <string>
+#include <vector>
 
 #ifdef _WIN32
 #if defined(__AVX2__)
@@ -59,6 +61,7 @@ typedef enum {
   avx512f,
   avx512_core,
   avx512_core_vnni,
+  avx512_core_bf16,
   avx512_mic,
   avx512_mic_4ops,
 } cpu_isa_t;  // Instruction set architecture
@@ -66,6 +69,69 @@ typedef enum {
 // May I use some instruction
 bool MayIUse(const cpu_isa_t cpu_isa);
 
+// Layout of the logical cpus, read from sysfs on Linux. The cache sizes fall
+// back to CPUID leaf 4 elsewhere, and are 0 if they are unknown.
+struct CpuTopology {
+  // physical core, package and NUMA node of every logical cpu
+  std::vector<int> core_ids;
+  std::vector<int> package_ids;
+  std::vector<int> numa_nodes;
+  int num_numa_nodes{1};
+  // L1 data and L2 cache of a core, L3 cache of a package, in bytes
+  size_t l1d_cache_size{0};
+  size_t l2_cache_size{0};
+  size_t l3_cache_size{0};
+};
+
+const CpuTopology& GetCpuTopology();
+
+//! Cache sizes for the blocking of the kernels, with common defaults if the
+//! topology doesn't know them.
+size_t L1CacheSize();
+size_t L2CacheSize();
+size_t L3CacheSize();
+
+// Logical cpus of numa_node, or of the machine if numa_node < 0. Only the
+// first cpu of every physical core is kept if physical_only, which skips the
+// SMT siblings.
+std::vector<int> CpuList(int numa_node = -1, bool physical_only = false);
+
+// The cpus of a predictor: cpus if given, otherwise the physical cores of
+// numa_node if numa_node >= 0. Empty if there is no binding or the cpus are
+// invalid.
+std::vector<int> PredictorCpus(const std::vector<int>& cpus, int numa_node);
+
+// Pin the calling thread and the omp threads it launches one to one onto
+// cpus, or the calling thread onto all of cpus without omp, and let the
+// calling thread allocate the memory on the numa node of cpus, during the
+// lifetime of the binding. The previous cpu affinity and memory policy of
+// these threads are restored afterwards, so a predictor binds only the
+// threads of its runs, and the other predictors sharing them are not
+// affected. It does nothing if cpus is empty or the os doesn't support it.
+class ScopedThreadBinding {
+ public:
+  explicit ScopedThreadBinding(const std::vector<int>& cpus);
+  ~ScopedThreadBinding();
+
+  bool bound() const { return bound_; }
+
+ private:
+  bool bound_{false};
+  // the cpu_set_t of the calling thread and of every omp thread
+  std::vector<std::vector<char>> affinities_;
+  int mempolicy_mode_{0};
+  std::vector<unsigned long> mempolicy_nodes_;  // NOLINT
+
+  ScopedThreadBinding(const ScopedThreadBinding&) = delete;
+  ScopedThreadBinding& operator=(const ScopedThreadBinding&) = delete;
+};
+
+// "0-3,8,10-11" -> {0, 1, 2, 3, 8, 10, 11}, the cpu lists in sysfs
+std::vector<int> ParseCpuList(const std::string& list);
+
+// "48K" or "32M" in sysfs -> bytes
+size_t ParseCacheSize(const std::string& size);
+
 }  // namespace x86
 }  // namespace lite
 }  // namespace paddle
@@ -0,0 +1,196 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/backends/x86/math/attention.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <vector>
+#include "lite/backends/x86/math/blas.h"
+#include "lite/backends/x86/math/softmax.h"
+#include "lite/backends/x86/parallel.h"
+
+namespace paddle {
+namespace lite {
+namespace x86 {
+namespace math {
+
+// Runs the attention of every (sequence, head, query block). Sequence b owns
+// the tokens [seq_offsets[b], seq_offsets[b + 1]) of q, k and v. Its output
+// and mask rows start at seq_offsets[b] too when `packed`, otherwise they
+// restart from 0 at the batch strides.
+static void flash_attention_impl(const lite::X86Context& ctx,
+                                 const float* q,
+                                 const float* k,
+                                 const float* v,
+                                 int64_t ld,
+                                 float* out,
+                                 const std::vector<uint64_t>& seq_offsets,
+                                 bool packed,
+                                 int heads,
+                                 int head_dim,
+                                 float alpha,
+                                 const AttentionMask& mask) {
+  auto blas = GetBlas<lite::TargetType::kX86, float>(ctx);
+  const int batch = static_cast<int>(seq_offsets.size()) - 1;
+  const int64_t total_tokens = seq_offsets.back();
+  // query blocks before each sequence, to map a task to its sequence
+  std::vector<int64_t> block_offsets(batch + 1, 0);
+  for (int b = 0; b < batch; ++b) {
+    const int64_t len = seq_offsets[b + 1] - seq_offsets[b];
+    block_offsets[b + 1] =
+        block_offsets[b] + (len + kAttentionBlockQ - 1) / kAttentionBlockQ;
+  }
+  const int64_t tasks = block_offsets.back() * heads;
+
+  auto task_func = [&](int64_t begin, int64_t end) {
+    std::vector<float> scores(kAttentionBlockQ * kAttentionBlockK);
+    std::vector<float> mask_row(kAttentionBlockK);
+    float row_max[kAttentionBlockQ];
+    float row_sum[kAttentionBlockQ];
+    for (int64_t t = begin; t < end; ++t) {
+      const int64_t block = t / heads;
+      const int h = t % heads;
+      const int b = std::upper_bound(block_offsets.begin(),
+                                     block_offsets.end(),
+                                     block) -
+                    block_offsets.begin() - 1;
+      const int64_t token0 = seq_offsets[b];
+      const int seq_len = seq_offsets[b + 1] - token0;
+      const int i0 = (block - block_offsets[b]) * kAttentionBlockQ;
+      const int rows = (std::min)(kAttentionBlockQ, seq_len - i0);
+      // first row of this sequence in the output and in the mask
+      const int64_t row0 = packed ? token0 : 0;
+      const int64_t out_seq_len = packed ? total_tokens : seq_len;
+      const int64_t out_batch = packed ? 0 : b;
+      const float* q_ptr = q + (token0 + i0) * ld + h * head_dim;
+      const float* k_ptr = k + token0 * ld + h * head_dim;
+      const float* v_ptr = v + token0 * ld + h * head_dim;
+      float* o_ptr =
+          out + ((out_batch * heads + h) * out_seq_len + row0 + i0) * head_dim;
+      const float* mask_ptr = nullptr;
+      if (mask.data) {
+        mask_ptr = mask.data + out_batch * mask.stride[0] +
+                   h * mask.stride[1] +
+                   row0 * (mask.stride[2] + mask.stride[3]);
+      }
+      for (int r = 0; r < rows; ++r) {
+        row_max[r] = std::numeric_limits<float>::lowest();
+        row_sum[r] = 0.f;
+      }
+
+      for (int j0 = 0; j0 < seq_len; j0 += kAttentionBlockK) {
+        const int cols = (std::min)(kAttentionBlockK, seq_len - j0);
+        // scores = alpha * Q_i * K_j^T
+        blas.GEMM(false,
+                  true,
+                  rows,
+                  cols,
+                  head_dim,
+                  alpha,
+                  q_ptr,
+                  ld,
+                  k_ptr + j0 * ld,
+                  ld,
+                  0.f,
+                  scores.data(),
+                  kAttentionBlockK);
+        for (int r = 0; r < rows; ++r) {
+          float* s = scores.data() + r * kAttentionBlockK;
+          const float* m = nullptr;
+          if (mask_ptr) {
+            m = mask_ptr + (i0 + r) * mask.stride[2] + j0 * mask.stride[3];
+            if (mask.stride[3] != 1) {
+              for (int c = 0; c < cols; ++c) {
+                mask_row[c] = m[c * mask.stride[3]];
+              }
+              m = mask_row.data();
+            }
+          }
+          float correction =
+              softmax_online_step(s, m, cols, &row_max[r], &row_sum[r]);
+          // rescale the output accumulated from the previous key blocks
+          if (j0 > 0 && correction != 1.f) {
+            float* o = o_ptr + r * head_dim;
+            for (int d = 0; d < head_dim; ++d) {
+              o[d] *= correction;
+            }
+          }
+        }
+        // O_i += P_ij * V_j
+        blas.GEMM(false,
+                  false,
+                  rows,
+                  head_dim,
+                  cols,
+                  1.f,
+                  scores.data(),
+                  kAttentionBlockK,
+                  v_ptr + j0 * ld,
+                  ld,
+                  j0 > 0 ? 1.f : 0.f,
+                  o_ptr,
+                  head_dim);
+      }
+      for (int r = 0; r < rows; ++r) {
+        const float inv_sum = 1.f / row_sum[r];
+        float* o = o_ptr + r * head_dim;
+        for (int d = 0; d < head_dim; ++d) {
+          o[d] *= inv_sum;
+        }
+      }
+    }
+  };
+  RunParallelFor(0, tasks, task_func);
+}
+
+void flash_attention_fp32(const lite::X86Context& ctx,
+                          const float* q,
+                          const float* k,
+                          const float* v,
+                          int64_t ld,
+                          float* out,
+                          int batch,
+                          int heads,
+                          int seq_len,
+                          int head_dim,
+                          float alpha,
+                          const AttentionMask& mask) {
+  std::vector<uint64_t> seq_offsets(batch + 1);
+  for (int b = 0; b <= batch; ++b) {
+    seq_offsets[b] = static_cast<uint64_t>(b) * seq_len;
+  }
+  flash_attention_impl(
+      ctx, q, k, v, ld, out, seq_offsets, false, heads, head_dim, alpha, mask);
+}
+
+void flash_attention_varlen_fp32(const lite::X86Context& ctx,
+                                 const float* q,
+                                 const float* k,
+                                 const float* v,
+                                 int64_t ld,
+                                 float* out,
+                                 const std::vector<uint64_t>& seq_offsets,
+                                 int heads,
+                                 int head_dim,
+                                 float alpha,
+                                 const AttentionMask& mask) {
+  flash_attention_impl(
+      ctx, q, k, v, ld, out, seq_offsets, true, heads, head_dim, alpha, mask);
+}
+
+}  // namespace math
+}  // namespace x86
+}  // namespace lite
+}  // namespace paddle
@@ -0,0 +1,82 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "lite/core/context.h"
+
+namespace paddle {
+namespace lite {
+namespace x86 {
+namespace math {
+
+// Additive attention mask broadcast to the scores of
+// [batch, heads, seq_q, seq_k], a broadcast dimension has a stride of 0.
+struct AttentionMask {
+  const float* data{nullptr};
+  int64_t stride[4]{0, 0, 0, 0};
+};
+
+// Tile sizes of the attention: a task computes kAttentionBlockQ queries of
+// one head, and the keys are visited kAttentionBlockK at a time, so the
+// scores kept per thread are bounded by a [kAttentionBlockQ, kAttentionBlockK]
+// tile (64 KB, within L2) instead of the [seq_q, seq_k] matrix.
+constexpr int kAttentionBlockQ = 64;
+constexpr int kAttentionBlockK = 256;
+
+// out[b, h, i, :] = softmax(alpha * q[b, i, h] * k[b, :, h]^T + mask) *
+// v[b, :, h] for each batch b, head h and query i.
+// q, k and v are [batch, seq_len, heads, head_dim] with a row stride of ld
+// floats between two tokens, so the packed output [batch, seq_len, 3, heads,
+// head_dim] of a fused qkv projection can be used in place. out is
+// [batch, heads, seq_len, head_dim].
+// The softmax is computed online block by block of keys (flash attention),
+// and the tasks of (batch, head, query block) run in parallel.
+void flash_attention_fp32(const lite::X86Context& ctx,
+                          const float* q,
+                          const float* k,
+                          const float* v,
+                          int64_t ld,
+                          float* out,
+                          int batch,
+                          int heads,
+                          int seq_len,
+                          int head_dim,
+                          float alpha,
+                          const AttentionMask& mask);
+
+// Padding-free version of the above for a batch packed into one sequence of
+// total_tokens = seq_offsets.back() tokens, where sequence b owns the tokens
+// [seq_offsets[b], seq_offsets[b + 1]) and only attends to itself.
+// q, k and v are [total_tokens, heads, head_dim] with a row stride of ld,
+// out is [heads, total_tokens, head_dim], and the mask is broadcast to
+// [1, heads, total_tokens, total_tokens].
+void flash_attention_varlen_fp32(const lite::X86Context& ctx,
+                                 const float* q,
+                                 const float* k,
+                                 const float* v,
+                                 int64_t ld,
+                                 float* out,
+                                 const std::vector<uint64_t>& seq_offsets,
+                                 int heads,
+                                 int head_dim,
+                                 float alpha,
+                                 const AttentionMask& mask);
+
+}  // namespace math
+}  // namespace x86
+}  // namespace lite
+}  // namespace paddle
@@ -1397,6 +1397,40 @@ void im2col<int8_t>(const int8_t* data_im,
   }
 }
 
+// bfloat16 data is stored as uint16_t.
+template <>
+void im2col<uint16_t>(const uint16_t* data_im,
+                      int channels,
+                      int height,
+                      int width,
+                      int kernel_h,
+                      int kernel_w,
+                      int pad_top,
+                      int pad_bottom,
+                      int pad_left,
+                      int pad_right,
+                      int stride_h,
+                      int stride_w,
+                      int dilation_h,
+                      int dilation_w,
+                      uint16_t* data_col) {
+  im2col_common<uint16_t>(data_im,
+                          channels,
+                          height,
+                          width,
+                          kernel_h,
+                          kernel_w,
+                          pad_top,
+                          pad_bottom,
+                          pad_left,
+                          pad_right,
+                          stride_h,
+                          stride_w,
+                          dilation_h,
+                          dilation_w,
+                          data_col);
+}
+
 }  // namespace math
 }  // namespace x86
 }  // namespace lite
@@ -32,6 +32,18 @@ void group_norm(const float* in,
                 float* saved_mean,
                 float* saved_variance);
 
+// group_norm followed by silu in the same pass over the input
+void group_norm_silu(const float* in,
+                     float* out,
+                     const int n,
+                     const int c,
+                     const int height,
+                     const int width,
+                     const float epsilon,
+                     const int groups,
+                     const float* scale,
+                     const float* bias);
+
 }  // namespace math
 }  // namespace x86
 }  // namespace lite
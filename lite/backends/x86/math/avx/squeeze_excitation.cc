@@ -0,0 +1,176 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/backends/x86/math/avx/squeeze_excitation.h"
+#include <immintrin.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace paddle {
+namespace lite {
+namespace x86 {
+namespace math {
+
+namespace {
+inline float se_act(float x, int act_type, float act_param) {
+  switch (act_type) {
+    case kSEActRelu:
+      return x > 0.f ? x : 0.f;
+    case kSEActSigmoid:
+      return 1.f / (1.f + expf(-x));
+    case kSEActTanh:
+      return tanhf(x);
+    case kSEActLeakyRelu:
+      return x > 0.f ? x : x * act_param;
+    case kSEActHardSwish:
+      return x * std::min(std::max(x + 3.f, 0.f), 6.f) / 6.f;
+    case kSEActHardSigmoid:
+      return std::min(std::max(x * act_param + 0.5f, 0.f), 1.f);
+    case kSEActSwish:
+      return x / (1.f + expf(-act_param * x));
+    case kSEActRelu6:
+      return std::min(std::max(x, 0.f), 6.f);
+    default:
+      return x;
+  }
+}
+
+float plane_mean(const float* in, int len) {
+  __m256 sum0 = _mm256_setzero_ps();
+  __m256 sum1 = _mm256_setzero_ps();
+  int i = 0;
+  for (; i + 15 < len; i += 16) {
+    sum0 = _mm256_add_ps(sum0, _mm256_loadu_ps(in + i));
+    sum1 = _mm256_add_ps(sum1, _mm256_loadu_ps(in + i + 8));
+  }
+  for (; i + 7 < len; i += 8) {
+    sum0 = _mm256_add_ps(sum0, _mm256_loadu_ps(in + i));
+  }
+  sum0 = _mm256_add_ps(sum0, sum1);
+  float buf[8];
+  _mm256_storeu_ps(buf, sum0);
+  float sum = buf[0] + buf[1] + buf[2] + buf[3] + buf[4] + buf[5] + buf[6] +
+              buf[7];
+  for (; i < len; ++i) {
+    sum += in[i];
+  }
+  return sum / len;
+}
+}  // namespace
+
+bool se_act_supported(int act_type) {
+  switch (act_type) {
+    case kSEActLinear:
+    case kSEActRelu:
+    case kSEActSigmoid:
+    case kSEActTanh:
+    case kSEActLeakyRelu:
+    case kSEActHardSwish:
+    case kSEActHardSigmoid:
+    case kSEActSwish:
+    case kSEActRelu6:
+      return true;
+    default:
+      return false;
+  }
+}
+
+void squeeze_excitation(const float* in,
+                        const float* branch,
+                        float* out,
+                        const int n,
+                        const int c,
+                        const int spatial,
+                        const int c_mid,
+                        const float* w1,
+                        const float* b1,
+                        const float* w2,
+                        const float* b2,
+                        const int* act_type,
+                        const float* act_param) {
+  std::vector<float> pooled(n * c);
+  std::vector<float> hidden(n * c_mid);
+  std::vector<float> gate(n * c);
+
+// squeeze, every channel is a contiguous plane
+#pragma omp parallel for
+  for (int nc = 0; nc < n * c; ++nc) {
+    pooled[nc] = plane_mean(in + static_cast<int64_t>(nc) * spatial, spatial);
+  }
+
+  // excitation, only c * c_mid * 2 macs per sample
+  for (int i = 0; i < n; ++i) {
+    const float* x = pooled.data() + i * c;
+    float* h = hidden.data() + i * c_mid;
+    float* g = gate.data() + i * c;
+    for (int o = 0; o < c_mid; ++o) {
+      h[o] = b1 ? b1[o] : 0.f;
+    }
+    for (int k = 0; k < c; ++k) {
+      const float* w = w1 + k * c_mid;
+      for (int o = 0; o < c_mid; ++o) {
+        h[o] += x[k] * w[o];
+      }
+    }
+    for (int o = 0; o < c_mid; ++o) {
+      h[o] = se_act(h[o], act_type[0], act_param[0]);
+    }
+    for (int o = 0; o < c; ++o) {
+      g[o] = b2 ? b2[o] : 0.f;
+    }
+    for (int k = 0; k < c_mid; ++k) {
+      const float* w = w2 + k * c;
+      for (int o = 0; o < c; ++o) {
+        g[o] += h[k] * w[o];
+      }
+    }
+    for (int o = 0; o < c; ++o) {
+      g[o] = se_act(g[o], act_type[1], act_param[1]);
+    }
+  }
+
+  // scale every channel, add the branch and apply the block act in one pass
+  const int block_act = act_type[2];
+  const bool vector_act = block_act == kSEActLinear || block_act == kSEActRelu;
+#pragma omp parallel for
+  for (int nc = 0; nc < n * c; ++nc) {
+    const int64_t offset = static_cast<int64_t>(nc) * spatial;
+    const float* x = in + offset;
+    const float* br = branch ? branch + offset : nullptr;
+    float* y = out + offset;
+    const float scale = gate[nc];
+    int j = 0;
+    if (vector_act) {
+      const __m256 vscale = _mm256_set1_ps(scale);
+      const __m256 vzero = _mm256_setzero_ps();
+      for (; j + 7 < spatial; j += 8) {
+        __m256 v = _mm256_mul_ps(_mm256_loadu_ps(x + j), vscale);
+        if (br) v = _mm256_add_ps(v, _mm256_loadu_ps(br + j));
+        if (block_act == kSEActRelu) v = _mm256_max_ps(v, vzero);
+        _mm256_storeu_ps(y + j, v);
+      }
+    }
+    for (; j < spatial; ++j) {
+      const float v = x[j] * scale + (br ? br[j] : 0.f);
+      y[j] = se_act(v, block_act, act_param[2]);
+    }
+  }
+}
+
+}  // namespace math
+}  // namespace x86
+}  // namespace lite
+}  // namespace paddle
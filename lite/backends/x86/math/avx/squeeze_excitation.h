@@ -0,0 +1,58 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+namespace paddle {
+namespace lite {
+namespace x86 {
+namespace math {
+
+// The activations of the squeeze-excitation block, the values are the ones
+// used by the act_type attr of __xpu__squeeze_excitation_block.
+enum SEActType {
+  kSEActLinear = 0,
+  kSEActRelu = 1,
+  kSEActSigmoid = 2,
+  kSEActTanh = 3,
+  kSEActLeakyRelu = 5,  // param: alpha
+  kSEActHardSwish = 14,
+  kSEActHardSigmoid = 15,  // param: slope, the offset is 0.5
+  kSEActSwish = 16,        // param: beta
+  kSEActRelu6 = 17,
+};
+
+bool se_act_supported(int act_type);
+
+// out = block_act(in * excitation(avg_pool(in)) + branch), where
+// excitation(x) = act1(fc2(act0(fc1(x)))), in/branch/out are [n, c, spatial],
+// w1 is [c, c_mid] and w2 is [c_mid, c], the biases and branch may be null.
+void squeeze_excitation(const float* in,
+                        const float* branch,
+                        float* out,
+                        const int n,
+                        const int c,
+                        const int spatial,
+                        const int c_mid,
+                        const float* w1,
+                        const float* b1,
+                        const float* w2,
+                        const float* b2,
+                        const int* act_type,
+                        const float* act_param);
+
+}  // namespace math
+}  // namespace x86
+}  // namespace lite
+}  // namespace paddle
@@ -0,0 +1,179 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/backends/x86/math/avx512/gemm_bf16_avx512.h"
+#include <immintrin.h>
+#include <algorithm>
+
+namespace paddle {
+namespace lite {
+namespace x86 {
+namespace math {
+
+// Register blocking of the micro kernel: 6 rows x 2 column blocks keep 12 zmm
+// accumulators, 2 zmm for B and 1 for the broadcast of A.
+static constexpr int kMR = 6;
+static constexpr int kNB = 2;
+
+static inline int32_t load_a_pair(const uint16_t* a, int k, int K) {
+  uint32_t lo = a[k];
+  uint32_t hi = (k + 1 < K) ? a[k + 1] : 0;
+  return static_cast<int32_t>(lo | (hi << 16));
+}
+
+template <int MR, int NB>
+static inline void gemm_bf16_micro_kernel(int K,
+                                          const uint16_t* A,
+                                          int lda,
+                                          const uint16_t* packed_b,
+                                          int64_t b_block_stride,
+                                          float* tile,
+                                          int ld_tile) {
+  __m512 acc[MR][NB];
+  for (int i = 0; i < MR; ++i) {
+    for (int j = 0; j < NB; ++j) {
+      acc[i][j] = _mm512_setzero_ps();
+    }
+  }
+  const int KP = (K + 1) / 2;
+  for (int kp = 0; kp < KP; ++kp) {
+    __m512bh vb[NB];
+    for (int j = 0; j < NB; ++j) {
+      vb[j] = (__m512bh)_mm512_loadu_si512(packed_b + j * b_block_stride +
+                                           kp * 2 * kGemmBF16BlockN);
+    }
+    for (int i = 0; i < MR; ++i) {
+      __m512bh va =
+          (__m512bh)_mm512_set1_epi32(load_a_pair(A + i * lda, 2 * kp, K));
+      for (int j = 0; j < NB; ++j) {
+        acc[i][j] = _mm512_dpbf16_ps(acc[i][j], va, vb[j]);
+      }
+    }
+  }
+  for (int i = 0; i < MR; ++i) {
+    for (int j = 0; j < NB; ++j) {
+      _mm512_storeu_ps(tile + i * ld_tile + j * kGemmBF16BlockN, acc[i][j]);
+    }
+  }
+}
+
+template <int NB>
+static inline void gemm_bf16_rows(int rows,
+                                  int K,
+                                  const uint16_t* A,
+                                  int lda,
+                                  const uint16_t* packed_b,
+                                  int64_t b_block_stride,
+                                  float* tile,
+                                  int ld_tile) {
+  switch (rows) {
+#define MICRO_KERNEL_CASE(mr)                              \
+  case mr:                                                 \
+    gemm_bf16_micro_kernel<mr, NB>(                        \
+        K, A, lda, packed_b, b_block_stride, tile, ld_tile); \
+    break;
+    MICRO_KERNEL_CASE(1)
+    MICRO_KERNEL_CASE(2)
+    MICRO_KERNEL_CASE(3)
+    MICRO_KERNEL_CASE(4)
+    MICRO_KERNEL_CASE(5)
+    MICRO_KERNEL_CASE(6)
+#undef MICRO_KERNEL_CASE
+    default:
+      break;
+  }
+}
+
+template <typename OutT>
+void gemm_bf16_packed_avx512(int M,
+                             int N,
+                             int K,
+                             const uint16_t* A,
+                             int lda,
+                             const uint16_t* packed_b,
+                             OutT* C,
+                             int ldc,
+                             const GemmBF16Epilogue& epilogue,
+                             int m_begin,
+                             int m_end,
+                             int nb_begin,
+                             int nb_end) {
+  const int KP = (K + 1) / 2;
+  const int64_t b_block_stride = static_cast<int64_t>(KP) * 2 * kGemmBF16BlockN;
+  const int ld_tile = kNB * kGemmBF16BlockN;
+  alignas(64) float tile[kMR * kNB * kGemmBF16BlockN];
+  for (int nb = nb_begin; nb < nb_end; nb += kNB) {
+    const int nbs = std::min(kNB, nb_end - nb);
+    const int n0 = nb * kGemmBF16BlockN;
+    const int cols = std::min(nbs * kGemmBF16BlockN, N - n0);
+    const uint16_t* b_ptr = packed_b + nb * b_block_stride;
+    for (int m = m_begin; m < m_end; m += kMR) {
+      const int rows = std::min(kMR, m_end - m);
+      const uint16_t* a_ptr = A + static_cast<int64_t>(m) * lda;
+      if (nbs == kNB) {
+        gemm_bf16_rows<kNB>(
+            rows, K, a_ptr, lda, b_ptr, b_block_stride, tile, ld_tile);
+      } else {
+        gemm_bf16_rows<1>(
+            rows, K, a_ptr, lda, b_ptr, b_block_stride, tile, ld_tile);
+      }
+      gemm_bf16_store_tile<OutT>(
+          tile, ld_tile, rows, cols, m, n0, C, ldc, epilogue);
+    }
+  }
+}
+
+void fp32_to_bf16_avx512(const float* din, uint16_t* dout, int64_t size) {
+  int64_t i = 0;
+  for (; i + 16 <= size; i += 16) {
+    __m256bh v = _mm512_cvtneps_pbh(_mm512_loadu_ps(din + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dout + i), (__m256i)v);
+  }
+  for (; i < size; ++i) {
+    dout[i] = fp32_to_bf16(din[i]);
+  }
+}
+
+template void gemm_bf16_packed_avx512<float>(int M,
+                                             int N,
+                                             int K,
+                                             const uint16_t* A,
+                                             int lda,
+                                             const uint16_t* packed_b,
+                                             float* C,
+                                             int ldc,
+                                             const GemmBF16Epilogue& epilogue,
+                                             int m_begin,
+                                             int m_end,
+                                             int nb_begin,
+                                             int nb_end);
+template void gemm_bf16_packed_avx512<uint16_t>(
+    int M,
+    int N,
+    int K,
+    const uint16_t* A,
+    int lda,
+    const uint16_t* packed_b,
+    uint16_t* C,
+    int ldc,
+    const GemmBF16Epilogue& epilogue,
+    int m_begin,
+    int m_end,
+    int nb_begin,
+    int nb_end);
+
+}  // namespace math
+}  // namespace x86
+}  // namespace lite
+}  // namespace paddle
@@ -0,0 +1,50 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include "lite/backends/x86/math/gemm_bf16.h"
+
+namespace paddle {
+namespace lite {
+namespace x86 {
+namespace math {
+
+// Compute rows [m_begin, m_end) and column blocks [nb_begin, nb_end) of the
+// bf16 gemm with `vdpbf16ps`. Only built when the compiler supports
+// AVX512_BF16 (LITE_WITH_AVX512_BF16), the caller must check the cpu with
+// MayIUse(avx512_core_bf16).
+template <typename OutT>
+void gemm_bf16_packed_avx512(int M,
+                             int N,
+                             int K,
+                             const uint16_t* A,
+                             int lda,
+                             const uint16_t* packed_b,
+                             OutT* C,
+                             int ldc,
+                             const GemmBF16Epilogue& epilogue,
+                             int m_begin,
+                             int m_end,
+                             int nb_begin,
+                             int nb_end);
+
+// Vectorized float32 <-> bfloat16 conversion with `vcvtneps2bf16`.
+void fp32_to_bf16_avx512(const float* din, uint16_t* dout, int64_t size);
+
+}  // namespace math
+}  // namespace x86
+}  // namespace lite
+}  // namespace paddle
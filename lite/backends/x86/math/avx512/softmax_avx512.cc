@@ -0,0 +1,143 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/backends/x86/math/avx512/softmax_avx512.h"
+#include <immintrin.h>
+#include <cmath>
+#include <limits>
+
+namespace paddle {
+namespace lite {
+namespace x86 {
+namespace math {
+
+// Same polynomial as the AVX2 version in softmax.cc, inputs below -88.37
+// return 0.
+static inline __m512 exp_ps_avx512(__m512 x) {
+  x = _mm512_min_ps(x, _mm512_set1_ps(88.3762626647949f));
+  x = _mm512_max_ps(x, _mm512_set1_ps(-88.3762626647949f));
+  __m512 fx = _mm512_fmadd_ps(
+      x, _mm512_set1_ps(1.44269504088896341f), _mm512_set1_ps(0.5f));
+  fx = _mm512_roundscale_ps(fx, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+  x = _mm512_fnmadd_ps(fx, _mm512_set1_ps(0.693359375f), x);
+  x = _mm512_fnmadd_ps(fx, _mm512_set1_ps(-2.12194440e-4f), x);
+  __m512 y = _mm512_set1_ps(1.9875691500E-4f);
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(1.3981999507E-3f));
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(8.3334519073E-3f));
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(4.1665795894E-2f));
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(1.6666665459E-1f));
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(5.0000001201E-1f));
+  y = _mm512_fmadd_ps(y, _mm512_mul_ps(x, x), x);
+  y = _mm512_add_ps(y, _mm512_set1_ps(1.f));
+  __m512i n = _mm512_add_epi32(_mm512_cvttps_epi32(fx), _mm512_set1_epi32(127));
+  return _mm512_mul_ps(y, _mm512_castsi512_ps(_mm512_slli_epi32(n, 23)));
+}
+
+static inline __mmask16 tail_mask(int64_t n, int64_t i) {
+  int64_t left = n - i;
+  return left >= 16 ? static_cast<__mmask16>(0xffff)
+                    : static_cast<__mmask16>((1u << left) - 1);
+}
+
+// x * scale + mask of the lanes in `k`, the other lanes are set to `fill`.
+static inline __m512 load_input(const float* x,
+                                const float* mask,
+                                int64_t i,
+                                __mmask16 k,
+                                __m512 vscale,
+                                __m512 fill) {
+  __m512 v = _mm512_mul_ps(_mm512_maskz_loadu_ps(k, x + i), vscale);
+  if (mask) {
+    v = _mm512_add_ps(v, _mm512_maskz_loadu_ps(k, mask + i));
+  }
+  return _mm512_mask_blend_ps(k, fill, v);
+}
+
+static void softmax_row_avx512(
+    const float* x, const float* mask, float* y, int64_t n, float scale) {
+  const __m512 vscale = _mm512_set1_ps(scale);
+  const __m512 lowest = _mm512_set1_ps(std::numeric_limits<float>::lowest());
+  __m512 vmax = lowest;
+  for (int64_t i = 0; i < n; i += 16) {
+    __m512 v = load_input(x, mask, i, tail_mask(n, i), vscale, lowest);
+    vmax = _mm512_max_ps(vmax, v);
+  }
+  vmax = _mm512_set1_ps(_mm512_reduce_max_ps(vmax));
+  __m512 vsum = _mm512_setzero_ps();
+  for (int64_t i = 0; i < n; i += 16) {
+    __mmask16 k = tail_mask(n, i);
+    __m512 v = load_input(x, mask, i, k, vscale, lowest);
+    __m512 e = exp_ps_avx512(_mm512_sub_ps(v, vmax));
+    _mm512_mask_storeu_ps(y + i, k, e);
+    vsum = _mm512_add_ps(vsum, e);
+  }
+  const __m512 vinv = _mm512_set1_ps(1.f / _mm512_reduce_add_ps(vsum));
+  for (int64_t i = 0; i < n; i += 16) {
+    __mmask16 k = tail_mask(n, i);
+    __m512 e = _mm512_maskz_loadu_ps(k, y + i);
+    _mm512_mask_storeu_ps(y + i, k, _mm512_mul_ps(e, vinv));
+  }
+}
+
+static void log_softmax_row_avx512(
+    const float* x, const float* mask, float* y, int64_t n, float scale) {
+  const __m512 vscale = _mm512_set1_ps(scale);
+  const __m512 lowest = _mm512_set1_ps(std::numeric_limits<float>::lowest());
+  __m512 vmax = lowest;
+  __m512 vsum = _mm512_setzero_ps();
+  for (int64_t i = 0; i < n; i += 16) {
+    __m512 v = load_input(x, mask, i, tail_mask(n, i), vscale, lowest);
+    if (_mm512_cmp_ps_mask(v, vmax, _CMP_GT_OQ)) {
+      __m512 new_max = _mm512_max_ps(vmax, v);
+      vsum = _mm512_mul_ps(vsum, exp_ps_avx512(_mm512_sub_ps(vmax, new_max)));
+      vmax = new_max;
+    }
+    vsum = _mm512_add_ps(vsum, exp_ps_avx512(_mm512_sub_ps(v, vmax)));
+  }
+  const float max_val = _mm512_reduce_max_ps(vmax);
+  vsum = _mm512_mul_ps(
+      vsum, exp_ps_avx512(_mm512_sub_ps(vmax, _mm512_set1_ps(max_val))));
+  const __m512 vshift =
+      _mm512_set1_ps(max_val + std::log(_mm512_reduce_add_ps(vsum)));
+  for (int64_t i = 0; i < n; i += 16) {
+    __mmask16 k = tail_mask(n, i);
+    __m512 v = load_input(x, mask, i, k, vscale, lowest);
+    _mm512_mask_storeu_ps(y + i, k, _mm512_sub_ps(v, vshift));
+  }
+}
+
+void softmax_rows_avx512(const float* x,
+                         float* y,
+                         int64_t row_begin,
+                         int64_t row_end,
+                         int64_t axis_dim,
+                         float scale,
+                         const SoftmaxMask* mask,
+                         bool log) {
+  for (int64_t r = row_begin; r < row_end; ++r) {
+    const float* m = SoftmaxMaskRow(mask, r, axis_dim);
+    if (log) {
+      log_softmax_row_avx512(
+          x + r * axis_dim, m, y + r * axis_dim, axis_dim, scale);
+    } else {
+      softmax_row_avx512(
+          x + r * axis_dim, m, y + r * axis_dim, axis_dim, scale);
+    }
+  }
+}
+
+}  // namespace math
+}  // namespace x86
+}  // namespace lite
+}  // namespace paddle
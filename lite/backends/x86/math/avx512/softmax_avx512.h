@@ -0,0 +1,41 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include "lite/backends/x86/math/softmax.h"
+
+namespace paddle {
+namespace lite {
+namespace x86 {
+namespace math {
+
+// Softmax (or log softmax if `log`) of rows [row_begin, row_end) of the
+// contiguous [rows, axis_dim] x with AVX-512F, the row tails use masked
+// loads instead of a scalar loop. Built with the other AVX-512F sources
+// (LITE_WITH_AVX512), the caller must check the cpu with MayIUse(avx512f).
+void softmax_rows_avx512(const float* x,
+                         float* y,
+                         int64_t row_begin,
+                         int64_t row_end,
+                         int64_t axis_dim,
+                         float scale,
+                         const SoftmaxMask* mask,
+                         bool log);
+
+}  // namespace math
+}  // namespace x86
+}  // namespace lite
+}  // namespace paddle
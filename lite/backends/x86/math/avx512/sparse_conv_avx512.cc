@@ -0,0 +1,193 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/backends/x86/math/avx512/sparse_conv_avx512.h"
+#include <immintrin.h>
+
+namespace paddle {
+namespace lite {
+namespace x86 {
+namespace math {
+
+// nonzeros between the prefetch of an input row and its use
+static constexpr int kPrefetchDistance = 4;
+
+// R rows x V zmm columns, the last vector is loaded and stored with mask.
+template <int R, int V>
+static inline void sparse_tile_fp32(const float* w,
+                                    const int32_t* cols,
+                                    int nnz,
+                                    const float* b,
+                                    int64_t ldb,
+                                    const float* bias,
+                                    float* c,
+                                    int64_t ldc,
+                                    __mmask16 mask) {
+  __m512 acc[R][V];
+  for (int r = 0; r < R; ++r) {
+    const __m512 vbias = _mm512_set1_ps(bias ? bias[r] : 0.f);
+    for (int v = 0; v < V; ++v) {
+      acc[r][v] = vbias;
+    }
+  }
+  for (int j = 0; j < nnz; ++j) {
+    if (j + kPrefetchDistance < nnz) {
+      _mm_prefetch(reinterpret_cast<const char*>(
+                       b + cols[j + kPrefetchDistance] * ldb),
+                   _MM_HINT_T0);
+    }
+    const float* bp = b + cols[j] * ldb;
+    __m512 vb[V];
+    for (int v = 0; v < V - 1; ++v) {
+      vb[v] = _mm512_loadu_ps(bp + 16 * v);
+    }
+    vb[V - 1] = _mm512_maskz_loadu_ps(mask, bp + 16 * (V - 1));
+    for (int r = 0; r < R; ++r) {
+      const __m512 vw = _mm512_set1_ps(w[j * R + r]);
+      for (int v = 0; v < V; ++v) {
+        acc[r][v] = _mm512_fmadd_ps(vw, vb[v], acc[r][v]);
+      }
+    }
+  }
+  for (int r = 0; r < R; ++r) {
+    for (int v = 0; v < V - 1; ++v) {
+      _mm512_storeu_ps(c + r * ldc + 16 * v, acc[r][v]);
+    }
+    _mm512_mask_storeu_ps(c + r * ldc + 16 * (V - 1), mask, acc[r][V - 1]);
+  }
+}
+
+template <int R>
+static void sparse_block_fp32_impl(const float* w,
+                                   const int32_t* cols,
+                                   int nnz,
+                                   const float* b,
+                                   int64_t ldb,
+                                   int n,
+                                   const float* bias,
+                                   float* c,
+                                   int64_t ldc) {
+  const __mmask16 full = 0xffff;
+  int i = 0;
+  for (; i + 64 <= n; i += 64) {
+    sparse_tile_fp32<R, 4>(w, cols, nnz, b + i, ldb, bias, c + i, ldc, full);
+  }
+  for (; i + 16 <= n; i += 16) {
+    sparse_tile_fp32<R, 1>(w, cols, nnz, b + i, ldb, bias, c + i, ldc, full);
+  }
+  if (i < n) {
+    const __mmask16 mask = static_cast<__mmask16>((1u << (n - i)) - 1);
+    sparse_tile_fp32<R, 1>(w, cols, nnz, b + i, ldb, bias, c + i, ldc, mask);
+  }
+}
+
+void sparse_block_fp32_avx512(const float* w,
+                              const int32_t* cols,
+                              int nnz,
+                              int rows,
+                              const float* b,
+                              int64_t ldb,
+                              int n,
+                              const float* bias,
+                              float* c,
+                              int64_t ldc) {
+  if (rows == 2) {
+    sparse_block_fp32_impl<2>(w, cols, nnz, b, ldb, n, bias, c, ldc);
+  } else {
+    sparse_block_fp32_impl<1>(w, cols, nnz, b, ldb, n, bias, c, ldc);
+  }
+}
+
+static inline int32_t pack_int8_pair(int8_t lo, int8_t hi) {
+  return static_cast<int32_t>(static_cast<uint16_t>(lo)) |
+         (static_cast<int32_t>(static_cast<uint16_t>(hi)) << 16);
+}
+
+template <int R>
+static void sparse_block_int8_impl(const int8_t* w,
+                                   const int32_t* cols,
+                                   int nnz,
+                                   const int8_t* b,
+                                   int64_t ldb,
+                                   int n,
+                                   int32_t* acc) {
+  // unpacklo/hi interleave the two input rows within 128-bit lanes, so the
+  // sums come out as column groups of 4 which are put back in order here
+  const __m512i idx0 = _mm512_setr_epi32(
+      0, 1, 2, 3, 16, 17, 18, 19, 4, 5, 6, 7, 20, 21, 22, 23);
+  const __m512i idx1 = _mm512_setr_epi32(
+      8, 9, 10, 11, 24, 25, 26, 27, 12, 13, 14, 15, 28, 29, 30, 31);
+  int i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __m512i lo[R];
+    __m512i hi[R];
+    for (int r = 0; r < R; ++r) {
+      lo[r] = _mm512_setzero_si512();
+      hi[r] = _mm512_setzero_si512();
+    }
+    for (int j = 0; j < nnz; j += 2) {
+      const bool has_next = j + 1 < nnz;
+      const __m512i va = _mm512_cvtepi8_epi16(_mm256_loadu_si256(
+          reinterpret_cast<const __m256i*>(b + cols[j] * ldb + i)));
+      const __m512i vb =
+          has_next ? _mm512_cvtepi8_epi16(_mm256_loadu_si256(
+                         reinterpret_cast<const __m256i*>(
+                             b + cols[j + 1] * ldb + i)))
+                   : _mm512_setzero_si512();
+      const __m512i ab_lo = _mm512_unpacklo_epi16(va, vb);
+      const __m512i ab_hi = _mm512_unpackhi_epi16(va, vb);
+      for (int r = 0; r < R; ++r) {
+        const __m512i vw = _mm512_set1_epi32(
+            pack_int8_pair(w[j * R + r], has_next ? w[(j + 1) * R + r] : 0));
+        lo[r] = _mm512_add_epi32(lo[r], _mm512_madd_epi16(ab_lo, vw));
+        hi[r] = _mm512_add_epi32(hi[r], _mm512_madd_epi16(ab_hi, vw));
+      }
+    }
+    for (int r = 0; r < R; ++r) {
+      _mm512_storeu_si512(acc + r * n + i,
+                          _mm512_permutex2var_epi32(lo[r], idx0, hi[r]));
+      _mm512_storeu_si512(acc + r * n + i + 16,
+                          _mm512_permutex2var_epi32(lo[r], idx1, hi[r]));
+    }
+  }
+  for (int r = 0; r < R; ++r) {
+    for (int k = i; k < n; ++k) {
+      int32_t sum = 0;
+      for (int j = 0; j < nnz; ++j) {
+        sum += static_cast<int32_t>(w[j * R + r]) * b[cols[j] * ldb + k];
+      }
+      acc[r * n + k] = sum;
+    }
+  }
+}
+
+void sparse_block_int8_avx512(const int8_t* w,
+                              const int32_t* cols,
+                              int nnz,
+                              int rows,
+                              const int8_t* b,
+                              int64_t ldb,
+                              int n,
+                              int32_t* acc) {
+  if (rows == 2) {
+    sparse_block_int8_impl<2>(w, cols, nnz, b, ldb, n, acc);
+  } else {
+    sparse_block_int8_impl<1>(w, cols, nnz, b, ldb, n, acc);
+  }
+}
+
+}  // namespace math
+}  // namespace x86
+}  // namespace lite
+}  // namespace paddle
@@ -0,0 +1,53 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+
+namespace paddle {
+namespace lite {
+namespace x86 {
+namespace math {
+
+// One block (1 or 2 rows) of the sparse fp32 product over all n columns:
+// c[r] = bias[r] + sum_j w[j * rows + r] * b[cols[j]], bias may be null.
+// Built if the compiler supports AVX-512 (LITE_WITH_AVX512), the caller must
+// check the cpu with MayIUse(avx512f).
+void sparse_block_fp32_avx512(const float* w,
+                              const int32_t* cols,
+                              int nnz,
+                              int rows,
+                              const float* b,
+                              int64_t ldb,
+                              int n,
+                              const float* bias,
+                              float* c,
+                              int64_t ldc);
+
+// Same for int8, the int32 sums are written to acc[rows, n]. Needs
+// MayIUse(avx512_core) for `vpmaddwd` on zmm registers.
+void sparse_block_int8_avx512(const int8_t* w,
+                              const int32_t* cols,
+                              int nnz,
+                              int rows,
+                              const int8_t* b,
+                              int64_t ldb,
+                              int n,
+                              int32_t* acc);
+
+}  // namespace math
+}  // namespace x86
+}  // namespace lite
+}  // namespace paddle
@@ -0,0 +1,200 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/backends/x86/math/embedding_seq_pool.h"
+#include <immintrin.h>
+#include <string.h>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include "lite/backends/x86/jit/helper.h"
+#include "lite/backends/x86/legacy_place.h"
+#include "lite/backends/x86/parallel.h"
+#include "lite/utils/log/cp_logging.h"
+
+namespace paddle {
+namespace lite {
+namespace x86 {
+namespace math {
+
+using EmbSeqPoolFunc = jit::EmbSeqPoolTuple<float>::func_type;
+
+// ids between the prefetch of a row and its accumulation
+static constexpr int kPrefetchDistance = 8;
+
+static inline void prefetch_row(const float* row, int64_t width) {
+  const char* ptr = reinterpret_cast<const char*>(row);
+  const int64_t bytes = width * static_cast<int64_t>(sizeof(float));
+  for (int64_t i = 0; i < bytes; i += 64) {
+    _mm_prefetch(ptr + i, _MM_HINT_T0);
+  }
+}
+
+static inline void add_row(const float* row, float* out, int64_t width) {
+  int64_t i = 0;
+#ifdef __AVX__
+  for (; i + 32 <= width; i += 32) {
+    __m256 v0 =
+        _mm256_add_ps(_mm256_loadu_ps(out + i), _mm256_loadu_ps(row + i));
+    __m256 v1 = _mm256_add_ps(_mm256_loadu_ps(out + i + 8),
+                              _mm256_loadu_ps(row + i + 8));
+    __m256 v2 = _mm256_add_ps(_mm256_loadu_ps(out + i + 16),
+                              _mm256_loadu_ps(row + i + 16));
+    __m256 v3 = _mm256_add_ps(_mm256_loadu_ps(out + i + 24),
+                              _mm256_loadu_ps(row + i + 24));
+    _mm256_storeu_ps(out + i, v0);
+    _mm256_storeu_ps(out + i + 8, v1);
+    _mm256_storeu_ps(out + i + 16, v2);
+    _mm256_storeu_ps(out + i + 24, v3);
+  }
+  for (; i + 8 <= width; i += 8) {
+    __m256 v0 =
+        _mm256_add_ps(_mm256_loadu_ps(out + i), _mm256_loadu_ps(row + i));
+    _mm256_storeu_ps(out + i, v0);
+  }
+#endif
+  for (; i < width; ++i) {
+    out[i] += row[i];
+  }
+}
+
+// The embseqpool jit code only takes int64 ids and has no padding_idx.
+template <typename IdT>
+static EmbSeqPoolFunc get_jit_func(const jit::emb_seq_pool_attr_t& attr,
+                                   int64_t padding_idx) {
+  return nullptr;
+}
+
+template <>
+EmbSeqPoolFunc get_jit_func<int64_t>(const jit::emb_seq_pool_attr_t& attr,
+                                     int64_t padding_idx) {
+  if (padding_idx != -1) {
+    return nullptr;
+  }
+  auto ker =
+      jit::GetJitCode<jit::EmbSeqPoolTuple<float>, lite::fluid::CPUPlace>(attr);
+  auto gen = dynamic_cast<const jit::GenBase*>(ker);
+  return gen ? gen->template getCode<EmbSeqPoolFunc>() : nullptr;
+}
+
+template <typename IdT>
+void embedding_seq_pool(const float* table,
+                        int64_t table_height,
+                        int64_t width,
+                        const IdT* ids,
+                        const std::vector<uint64_t>& lod,
+                        int64_t padding_idx,
+                        jit::SeqPoolType type,
+                        float pad_value,
+                        float* out) {
+  CHECK(type == jit::SeqPoolType::kSum || type == jit::SeqPoolType::kAvg ||
+        type == jit::SeqPoolType::kSqrt);
+  const int64_t num_ids = static_cast<int64_t>(lod.back());
+  // -1 means no padding, the id -1 is invalid then as in lookup_table
+  auto is_padding = [&](int64_t j) {
+    return padding_idx != -1 && ids[j] == padding_idx;
+  };
+  // validate once, so that the parallel loops don't have to
+  for (int64_t i = 0; i < num_ids; ++i) {
+    if (!is_padding(i)) {
+      CHECK(ids[i] >= 0 && ids[i] < table_height)
+          << "The id " << ids[i] << " at " << i
+          << " is out of the embedding table of height " << table_height;
+    }
+  }
+
+  jit::emb_seq_pool_attr_t attr(
+      table_height, width, 1, 1, width, jit::SeqPoolType::kSum);
+  EmbSeqPoolFunc jit_func = get_jit_func<IdT>(attr, padding_idx);
+
+  const int64_t segments = static_cast<int64_t>(lod.size()) - 1;
+  auto pool_segments = [&](int64_t begin, int64_t end) {
+    jit::emb_seq_pool_attr_t seg_attr = attr;
+    for (int64_t s = begin; s < end; ++s) {
+      float* dst = out + s * width;
+      const int64_t id_begin = lod[s];
+      const int64_t id_end = lod[s + 1];
+      if (id_begin == id_end) {
+        for (int64_t i = 0; i < width; ++i) {
+          dst[i] = pad_value;
+        }
+        continue;
+      }
+      if (jit_func) {
+        // warm up the first rows of the next segment meanwhile
+        const int64_t next_end = (std::min)(
+            num_ids, id_end + static_cast<int64_t>(kPrefetchDistance));
+        for (int64_t j = id_end; j < next_end; ++j) {
+          prefetch_row(table + ids[j] * width, width);
+        }
+        seg_attr.index_height = id_end - id_begin;
+        jit_func(table,
+                 reinterpret_cast<const int64_t*>(ids) + id_begin,
+                 dst,
+                 &seg_attr);
+      } else {
+        memset(dst, 0, width * sizeof(float));
+        const int64_t warm_end = (std::min)(
+            id_end, id_begin + static_cast<int64_t>(kPrefetchDistance));
+        for (int64_t j = id_begin; j < warm_end; ++j) {
+          if (!is_padding(j)) {
+            prefetch_row(table + ids[j] * width, width);
+          }
+        }
+        for (int64_t j = id_begin; j < id_end; ++j) {
+          const int64_t next = j + kPrefetchDistance;
+          if (next < id_end && !is_padding(next)) {
+            prefetch_row(table + ids[next] * width, width);
+          }
+          if (!is_padding(j)) {
+            add_row(table + ids[j] * width, dst, width);
+          }
+        }
+      }
+      if (type != jit::SeqPoolType::kSum) {
+        const float len = static_cast<float>(id_end - id_begin);
+        const float scale =
+            type == jit::SeqPoolType::kAvg ? 1.f / len : 1.f / std::sqrt(len);
+        for (int64_t i = 0; i < width; ++i) {
+          dst[i] *= scale;
+        }
+      }
+    }
+  };
+  RunParallelFor(0, segments, pool_segments);
+}
+
+template void embedding_seq_pool<int64_t>(const float* table,
+                                          int64_t table_height,
+                                          int64_t width,
+                                          const int64_t* ids,
+                                          const std::vector<uint64_t>& lod,
+                                          int64_t padding_idx,
+                                          jit::SeqPoolType type,
+                                          float pad_value,
+                                          float* out);
+template void embedding_seq_pool<int32_t>(const float* table,
+                                          int64_t table_height,
+                                          int64_t width,
+                                          const int32_t* ids,
+                                          const std::vector<uint64_t>& lod,
+                                          int64_t padding_idx,
+                                          jit::SeqPoolType type,
+                                          float pad_value,
+                                          float* out);
+
+}  // namespace math
+}  // namespace x86
+}  // namespace lite
+}  // namespace paddle
@@ -0,0 +1,46 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "lite/backends/x86/jit/kernel_base.h"
+
+namespace paddle {
+namespace lite {
+namespace x86 {
+namespace math {
+
+// out[s] = pool(table[ids[j]] for j in [lod[s], lod[s + 1])), i.e.
+// lookup_table followed by sequence_pool without the [ids, width]
+// intermediate. The rows of padding_idx count as zeros, an empty segment is
+// filled with pad_value, and type is kSum, kAvg or kSqrt.
+// Segments run in parallel, a row is prefetched a few ids ahead of its
+// accumulation, and the sum is done by the embseqpool jit code if available.
+template <typename IdT>
+void embedding_seq_pool(const float* table,
+                        int64_t table_height,
+                        int64_t width,
+                        const IdT* ids,
+                        const std::vector<uint64_t>& lod,
+                        int64_t padding_idx,
+                        jit::SeqPoolType type,
+                        float pad_value,
+                        float* out);
+
+}  // namespace math
+}  // namespace x86
+}  // namespace lite
+}  // namespace paddle
@@ -0,0 +1,377 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/backends/x86/math/gemm_bf16.h"
+#include <algorithm>
+#include <functional>
+#include "lite/backends/x86/cpu_info.h"
+#include "lite/backends/x86/parallel.h"
+#ifdef LITE_WITH_AVX512_BF16
+#include "lite/backends/x86/math/avx512/gemm_bf16_avx512.h"
+#endif
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#endif
+
+namespace paddle {
+namespace lite {
+namespace x86 {
+namespace math {
+
+#if defined(__AVX2__) && defined(__FMA__)
+static inline __m256i fp32_to_bf16_m256(__m256 v) {
+  __m256i bits = _mm256_castps_si256(v);
+  __m256i lsb = _mm256_and_si256(_mm256_srli_epi32(bits, 16),
+                                 _mm256_set1_epi32(1));
+  __m256i rounded = _mm256_add_epi32(
+      bits, _mm256_add_epi32(lsb, _mm256_set1_epi32(0x7fff)));
+  __m256i nan = _mm256_or_si256(_mm256_srli_epi32(bits, 16),
+                                _mm256_set1_epi32(0x40));
+  __m256 is_nan = _mm256_cmp_ps(v, v, _CMP_UNORD_Q);
+  __m256i res = _mm256_blendv_epi8(_mm256_srli_epi32(rounded, 16),
+                                   nan,
+                                   _mm256_castps_si256(is_nan));
+  // 8 x uint32 -> 8 x uint16 in the low 128 bits
+  res = _mm256_packus_epi32(res, res);
+  return _mm256_permute4x64_epi64(res, 0xd8);
+}
+#endif
+
+void fp32_to_bf16(const float* din, uint16_t* dout, int64_t size) {
+#ifdef LITE_WITH_AVX512_BF16
+  if (MayIUse(avx512_core_bf16)) {
+    fp32_to_bf16_avx512(din, dout, size);
+    return;
+  }
+#endif
+  int64_t i = 0;
+#if defined(__AVX2__) && defined(__FMA__)
+  for (; i + 8 <= size; i += 8) {
+    __m256i res = fp32_to_bf16_m256(_mm256_loadu_ps(din + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dout + i),
+                     _mm256_castsi256_si128(res));
+  }
+#endif
+  for (; i < size; ++i) {
+    dout[i] = fp32_to_bf16(din[i]);
+  }
+}
+
+void bf16_to_fp32(const uint16_t* din, float* dout, int64_t size) {
+  int64_t i = 0;
+#if defined(__AVX2__) && defined(__FMA__)
+  for (; i + 8 <= size; i += 8) {
+    __m256i v = _mm256_cvtepu16_epi32(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(din + i)));
+    _mm256_storeu_ps(dout + i, _mm256_castsi256_ps(_mm256_slli_epi32(v, 16)));
+  }
+#endif
+  for (; i < size; ++i) {
+    dout[i] = bf16_to_fp32(din[i]);
+  }
+}
+
+int64_t gemm_bf16_packed_b_size(int K, int N) {
+  int64_t n_blocks = (N + kGemmBF16BlockN - 1) / kGemmBF16BlockN;
+  int64_t k_pairs = (K + 1) / 2;
+  return n_blocks * k_pairs * 2 * kGemmBF16BlockN;
+}
+
+static inline uint16_t to_bf16(uint16_t v) { return v; }
+static inline uint16_t to_bf16(float v) { return fp32_to_bf16(v); }
+
+template <typename T>
+static void gemm_bf16_pack_b_impl(
+    bool trans_b, int K, int N, const T* B, int ldb, uint16_t* packed_b) {
+  const int n_blocks = (N + kGemmBF16BlockN - 1) / kGemmBF16BlockN;
+  const int k_pairs = (K + 1) / 2;
+  auto get_b = [&](int k, int n) -> uint16_t {
+    if (k >= K || n >= N) return 0;
+    return to_bf16(trans_b ? B[static_cast<int64_t>(n) * ldb + k]
+                           : B[static_cast<int64_t>(k) * ldb + n]);
+  };
+  for (int nb = 0; nb < n_blocks; ++nb) {
+    uint16_t* dst = packed_b + static_cast<int64_t>(nb) * k_pairs * 2 *
+                                   kGemmBF16BlockN;
+    for (int kp = 0; kp < k_pairs; ++kp) {
+      for (int j = 0; j < kGemmBF16BlockN; ++j) {
+        int n = nb * kGemmBF16BlockN + j;
+        *dst++ = get_b(2 * kp, n);
+        *dst++ = get_b(2 * kp + 1, n);
+      }
+    }
+  }
+}
+
+void gemm_bf16_pack_b(bool trans_b,
+                      int K,
+                      int N,
+                      const uint16_t* B,
+                      int ldb,
+                      uint16_t* packed_b) {
+  gemm_bf16_pack_b_impl<uint16_t>(trans_b, K, N, B, ldb, packed_b);
+}
+
+void gemm_bf16_pack_b(bool trans_b,
+                      int K,
+                      int N,
+                      const float* B,
+                      int ldb,
+                      uint16_t* packed_b) {
+  gemm_bf16_pack_b_impl<float>(trans_b, K, N, B, ldb, packed_b);
+}
+
+static inline void store_row(const float* src, int cols, float* dst) {
+  memcpy(dst, src, cols * sizeof(float));
+}
+
+static inline void store_row(const float* src, int cols, uint16_t* dst) {
+  fp32_to_bf16(src, dst, cols);
+}
+
+template <typename OutT>
+void gemm_bf16_store_tile(const float* tile,
+                          int ld_tile,
+                          int rows,
+                          int cols,
+                          int row_offset,
+                          int col_offset,
+                          OutT* C,
+                          int ldc,
+                          const GemmBF16Epilogue& epilogue) {
+  float row_buf[4 * kGemmBF16BlockN];
+  for (int i = 0; i < rows; ++i) {
+    const float* src = tile + i * ld_tile;
+    OutT* dst = C + static_cast<int64_t>(row_offset + i) * ldc + col_offset;
+    for (int c0 = 0; c0 < cols; c0 += 4 * kGemmBF16BlockN) {
+      int len = std::min(4 * kGemmBF16BlockN, cols - c0);
+      for (int j = 0; j < len; ++j) {
+        float v = src[c0 + j] * epilogue.alpha;
+        if (epilogue.bias) {
+          v += epilogue.bias_by_row ? epilogue.bias[row_offset + i]
+                                    : epilogue.bias[col_offset + c0 + j];
+        }
+        if (epilogue.relu) v = v > 0.f ? v : 0.f;
+        row_buf[j] = v;
+      }
+      store_row(row_buf, len, dst + c0);
+    }
+  }
+}
+
+#if defined(__AVX2__) && defined(__FMA__)
+// Emulation of `vdpbf16ps` with AVX2: a packed pair (b[k][n], b[k+1][n]) is
+// one 32-bit lane, the high half is b[k+1][n] as fp32 after masking and the
+// low half is b[k][n] as fp32 after shifting left by 16.
+template <int MR>
+static inline void gemm_bf16_micro_kernel_avx2(int K,
+                                               const uint16_t* A,
+                                               int lda,
+                                               const uint16_t* packed_b,
+                                               float* tile,
+                                               int ld_tile) {
+  __m256 acc[MR][2];
+  for (int i = 0; i < MR; ++i) {
+    acc[i][0] = _mm256_setzero_ps();
+    acc[i][1] = _mm256_setzero_ps();
+  }
+  const __m256i mask_hi = _mm256_set1_epi32(0xffff0000);
+  const int KP = (K + 1) / 2;
+  for (int kp = 0; kp < KP; ++kp) {
+    const uint16_t* b = packed_b + kp * 2 * kGemmBF16BlockN;
+    __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b));
+    __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + 16));
+    __m256 b00 = _mm256_castsi256_ps(_mm256_slli_epi32(v0, 16));
+    __m256 b01 = _mm256_castsi256_ps(_mm256_and_si256(v0, mask_hi));
+    __m256 b10 = _mm256_castsi256_ps(_mm256_slli_epi32(v1, 16));
+    __m256 b11 = _mm256_castsi256_ps(_mm256_and_si256(v1, mask_hi));
+    const int k = 2 * kp;
+    for (int i = 0; i < MR; ++i) {
+      const uint16_t* a = A + i * lda;
+      __m256 a0 = _mm256_set1_ps(bf16_to_fp32(a[k]));
+      __m256 a1 = _mm256_set1_ps(k + 1 < K ? bf16_to_fp32(a[k + 1]) : 0.f);
+      acc[i][0] = _mm256_fmadd_ps(a0, b00, acc[i][0]);
+      acc[i][1] = _mm256_fmadd_ps(a0, b10, acc[i][1]);
+      acc[i][0] = _mm256_fmadd_ps(a1, b01, acc[i][0]);
+      acc[i][1] = _mm256_fmadd_ps(a1, b11, acc[i][1]);
+    }
+  }
+  for (int i = 0; i < MR; ++i) {
+    _mm256_storeu_ps(tile + i * ld_tile, acc[i][0]);
+    _mm256_storeu_ps(tile + i * ld_tile + 8, acc[i][1]);
+  }
+}
+#endif
+
+template <typename OutT>
+static void gemm_bf16_packed_ref(int M,
+                                 int N,
+                                 int K,
+                                 const uint16_t* A,
+                                 int lda,
+                                 const uint16_t* packed_b,
+                                 OutT* C,
+                                 int ldc,
+                                 const GemmBF16Epilogue& epilogue,
+                                 int m_begin,
+                                 int m_end,
+                                 int nb_begin,
+                                 int nb_end) {
+  const int KP = (K + 1) / 2;
+  const int64_t b_block_stride = static_cast<int64_t>(KP) * 2 * kGemmBF16BlockN;
+  const int kMR = 4;
+  float tile[kMR * kGemmBF16BlockN];
+  for (int nb = nb_begin; nb < nb_end; ++nb) {
+    const int n0 = nb * kGemmBF16BlockN;
+    const int cols = std::min(kGemmBF16BlockN, N - n0);
+    const uint16_t* b_ptr = packed_b + nb * b_block_stride;
+    for (int m = m_begin; m < m_end; m += kMR) {
+      const int rows = std::min(kMR, m_end - m);
+      const uint16_t* a_ptr = A + static_cast<int64_t>(m) * lda;
+#if defined(__AVX2__) && defined(__FMA__)
+      switch (rows) {
+        case 4:
+          gemm_bf16_micro_kernel_avx2<4>(
+              K, a_ptr, lda, b_ptr, tile, kGemmBF16BlockN);
+          break;
+        case 3:
+          gemm_bf16_micro_kernel_avx2<3>(
+              K, a_ptr, lda, b_ptr, tile, kGemmBF16BlockN);
+          break;
+        case 2:
+          gemm_bf16_micro_kernel_avx2<2>(
+              K, a_ptr, lda, b_ptr, tile, kGemmBF16BlockN);
+          break;
+        default:
+          gemm_bf16_micro_kernel_avx2<1>(
+              K, a_ptr, lda, b_ptr, tile, kGemmBF16BlockN);
+          break;
+      }
+#else
+      for (int i = 0; i < rows; ++i) {
+        const uint16_t* a = a_ptr + i * lda;
+        for (int j = 0; j < kGemmBF16BlockN; ++j) {
+          float sum = 0.f;
+          for (int k = 0; k < K; ++k) {
+            sum += bf16_to_fp32(a[k]) *
+                   bf16_to_fp32(b_ptr[(k / 2) * 2 * kGemmBF16BlockN + j * 2 +
+                                      (k % 2)]);
+          }
+          tile[i * kGemmBF16BlockN + j] = sum;
+        }
+      }
+#endif
+      gemm_bf16_store_tile<OutT>(
+          tile, kGemmBF16BlockN, rows, cols, m, n0, C, ldc, epilogue);
+    }
+  }
+}
+
+template <typename OutT>
+void gemm_bf16_packed(int M,
+                      int N,
+                      int K,
+                      const uint16_t* A,
+                      int lda,
+                      const uint16_t* packed_b,
+                      OutT* C,
+                      int ldc,
+                      const GemmBF16Epilogue& epilogue) {
+  if (M <= 0 || N <= 0) return;
+  const int n_blocks = (N + kGemmBF16BlockN - 1) / kGemmBF16BlockN;
+  auto kernel = gemm_bf16_packed_ref<OutT>;
+#ifdef LITE_WITH_AVX512_BF16
+  if (MayIUse(avx512_core_bf16)) {
+    kernel = gemm_bf16_packed_avx512<OutT>;
+  }
+#endif
+  // Split rows among threads for batched inputs and the column blocks for
+  // the gemv-like case, such as fc with a batch size of 1.
+  const int64_t threads = GetMaxThreads();
+  if (M >= 8 * threads || n_blocks < threads) {
+    RunParallelFor(0, M, [&](int64_t begin, int64_t end) {
+      kernel(M,
+             N,
+             K,
+             A,
+             lda,
+             packed_b,
+             C,
+             ldc,
+             epilogue,
+             static_cast<int>(begin),
+             static_cast<int>(end),
+             0,
+             n_blocks);
+    });
+  } else {
+    RunParallelFor(0, n_blocks, [&](int64_t begin, int64_t end) {
+      kernel(M,
+             N,
+             K,
+             A,
+             lda,
+             packed_b,
+             C,
+             ldc,
+             epilogue,
+             0,
+             M,
+             static_cast<int>(begin),
+             static_cast<int>(end));
+    });
+  }
+}
+
+template void gemm_bf16_store_tile<float>(const float* tile,
+                                          int ld_tile,
+                                          int rows,
+                                          int cols,
+                                          int row_offset,
+                                          int col_offset,
+                                          float* C,
+                                          int ldc,
+                                          const GemmBF16Epilogue& epilogue);
+template void gemm_bf16_store_tile<uint16_t>(const float* tile,
+                                             int ld_tile,
+                                             int rows,
+                                             int cols,
+                                             int row_offset,
+                                             int col_offset,
+                                             uint16_t* C,
+                                             int ldc,
+                                             const GemmBF16Epilogue& epilogue);
+template void gemm_bf16_packed<float>(int M,
+                                      int N,
+                                      int K,
+                                      const uint16_t* A,
+                                      int lda,
+                                      const uint16_t* packed_b,
+                                      float* C,
+                                      int ldc,
+                                      const GemmBF16Epilogue& epilogue);
+template void gemm_bf16_packed<uint16_t>(int M,
+                                         int N,
+                                         int K,
+                                         const uint16_t* A,
+                                         int lda,
+                                         const uint16_t* packed_b,
+                                         uint16_t* C,
+                                         int ldc,
+                                         const GemmBF16Epilogue& epilogue);
+
+}  // namespace math
+}  // namespace x86
+}  // namespace lite
+}  // namespace paddle
@@ -0,0 +1,117 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+namespace paddle {
+namespace lite {
+namespace x86 {
+namespace math {
+
+// bfloat16 keeps the upper 16 bits of an IEEE-754 float32 value, so the
+// conversion to float32 is a plain shift and the conversion from float32 only
+// needs a round-to-nearest-even on the dropped mantissa bits.
+inline float bf16_to_fp32(uint16_t in) {
+  uint32_t bits = static_cast<uint32_t>(in) << 16;
+  float out;
+  memcpy(&out, &bits, sizeof(out));
+  return out;
+}
+
+inline uint16_t fp32_to_bf16(float in) {
+  uint32_t bits;
+  memcpy(&bits, &in, sizeof(bits));
+  if ((bits & 0x7fffffffu) > 0x7f800000u) {
+    // keep NaN quiet instead of rounding it to inf
+    return static_cast<uint16_t>((bits >> 16) | 0x40u);
+  }
+  bits += 0x7fffu + ((bits >> 16) & 1u);
+  return static_cast<uint16_t>(bits >> 16);
+}
+
+void fp32_to_bf16(const float* din, uint16_t* dout, int64_t size);
+
+void bf16_to_fp32(const uint16_t* din, float* dout, int64_t size);
+
+// Column block of the packed B matrix, one zmm register of fp32 results.
+constexpr int kGemmBF16BlockN = 16;
+
+// Element count of the packed B buffer for a [K, N] matrix.
+int64_t gemm_bf16_packed_b_size(int K, int N);
+
+// Pack B[K, N] (or B^T[N, K] if trans_b) into blocks of kGemmBF16BlockN
+// columns, where each column stores two consecutive rows of K as a pair:
+//   packed[nb][k / 2][n % 16][k % 2]
+// This is the operand layout of `vdpbf16ps`, and it is also used by the AVX2
+// emulation path since a pair converts to two fp32 lanes with shift and mask.
+// An odd K is padded with zero.
+void gemm_bf16_pack_b(bool trans_b,
+                      int K,
+                      int N,
+                      const uint16_t* B,
+                      int ldb,
+                      uint16_t* packed_b);
+
+// Same as above for a float32 B, which is rounded to bf16 while packing.
+void gemm_bf16_pack_b(bool trans_b,
+                      int K,
+                      int N,
+                      const float* B,
+                      int ldb,
+                      uint16_t* packed_b);
+
+struct GemmBF16Epilogue {
+  float alpha{1.f};
+  const float* bias{nullptr};
+  // bias is indexed by the row of C (conv) instead of the column of C (fc)
+  bool bias_by_row{false};
+  bool relu{false};
+};
+
+// C[M, N] = alpha * A[M, K] * B[K, N] + bias, with float32 accumulation.
+// A is bf16 in row major with leading dimension lda, B is packed by
+// gemm_bf16_pack_b. OutT is float or uint16_t (bf16).
+// Uses `vdpbf16ps` if the CPU supports AVX512_BF16, otherwise the bf16
+// operands are widened to float32 and accumulated by AVX2 FMA.
+template <typename OutT>
+void gemm_bf16_packed(int M,
+                      int N,
+                      int K,
+                      const uint16_t* A,
+                      int lda,
+                      const uint16_t* packed_b,
+                      OutT* C,
+                      int ldc,
+                      const GemmBF16Epilogue& epilogue);
+
+// Store a [rows, cols] fp32 tile into C after applying the epilogue, the
+// tile has a leading dimension of kGemmBF16BlockN * n_blocks.
+template <typename OutT>
+void gemm_bf16_store_tile(const float* tile,
+                          int ld_tile,
+                          int rows,
+                          int cols,
+                          int row_offset,
+                          int col_offset,
+                          OutT* C,
+                          int ldc,
+                          const GemmBF16Epilogue& epilogue);
+
+}  // namespace math
+}  // namespace x86
+}  // namespace lite
+}  // namespace paddle
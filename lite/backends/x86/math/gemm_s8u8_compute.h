@@ -17,6 +17,7 @@ limitations under the License. */
 #include <string.h>
 #include <algorithm>
 #include <cmath>
+#include "lite/backends/x86/cpu_info.h"
 #include "lite/backends/x86/math/gemm_s8u8_kernel.h"
 #include "lite/backends/x86/math/gemm_s8u8_pack.h"
 #include "lite/core/memory.h"
@@ -60,8 +61,46 @@ class generate_gemm_s8u8_x86_kern {
     gemm_int8_init(M, N, K, bias);
   }
 
+  // Restore the weight dependent state written by export_packed() of a gemm
+  // with the same M, K, scales and bias, the raw A is not needed then.
+  explicit generate_gemm_s8u8_x86_kern(bool is_trans_A,
+                                       bool is_trans_B,
+                                       int M,
+                                       int N,
+                                       int K,
+                                       const int8_t *packed,
+                                       int ldc,
+                                       int relu_type,
+                                       float relu_alpha) {
+    const float *Sa = nullptr;
+    const int8_t *A = nullptr;
+    const float Sb = 0.f;
+    const float Sc = 0.f;
+    PARAM_INIT
+    gemm_int8_alloc(M, N, K);
+    memcpy(_pack_A, packed, M * _k_align4);
+    memcpy(_re_bias, packed + M * _k_align4, M * sizeof(float));
+    memcpy(_scale,
+           packed + M * _k_align4 + M * sizeof(float),
+           M * sizeof(float));
+  }
+
   ~generate_gemm_s8u8_x86_kern() { gemm_int8_deinit(); }
 
+  // The bytes of the packed A, the requantized bias and the output scale.
+  static size_t packed_size(int M, int K) {
+    return static_cast<size_t>(M) * (((K + 3) >> 2) << 2) +
+           2 * M * sizeof(float);
+  }
+
+  void export_packed(int8_t *out) const {
+    memcpy(out, _pack_A, _M * _k_align4);
+    memcpy(out + _M * _k_align4, _re_bias, _M * sizeof(float));
+    memcpy(out + _M * _k_align4 + _M * sizeof(float),
+           _scale,
+           _M * sizeof(float));
+  }
+
   void compute(const int8_t *A, const int8_t *B, TYPE_C *C) {
     if (_relu_type < 0 || _relu_type > 3) {
       LOG(FATAL) << "relu_type: 1 for relu, 2 for relu6, 3 for leakyrelu, but "
@@ -118,7 +157,7 @@ class generate_gemm_s8u8_x86_kern {
   // divide block param
   const int _unroll_n = 32;
   const int _unroll_m = 2;
-  const int _l2_size = 262144;  // 256K
+  const int _l2_size = static_cast<int>(L2CacheSize());
   // work buffer
   TYPE_C *_C{nullptr};
   float *_Sa{nullptr};
@@ -160,7 +199,7 @@ class generate_gemm_s8u8_x86_kern {
     gemm_s8u8s8_runpackB(N, K, stride, B, pack_B, is_trans);
   }
 
-  void gemm_int8_init(int M, int N, int K, const float *bias) {
+  void gemm_int8_alloc(int M, int N, int K) {
     int K_align4 = (K + 3) >> 2;
     int block_n = 0;
     int block_m = 0;
@@ -177,6 +216,10 @@ class generate_gemm_s8u8_x86_kern {
         TargetMalloc(TARGET(kX86), M * sizeof(float)));
     _scale = reinterpret_cast<float *>(
         TargetMalloc(TARGET(kX86), M * sizeof(float)));
+  }
+
+  void gemm_int8_init(int M, int N, int K, const float *bias) {
+    gemm_int8_alloc(M, N, K);
     // if no bias, malloc a buffer and set all zero.
     if (bias == nullptr) {
       _in_bias = reinterpret_cast<float *>(
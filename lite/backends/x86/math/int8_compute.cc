@@ -0,0 +1,446 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/backends/x86/math/int8_compute.h"
+#include <immintrin.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace paddle {
+namespace lite {
+namespace x86 {
+namespace math {
+
+namespace {
+const int64_t kBlockSize = 4096;
+
+inline int8_t quant_one(float v) {
+  v = std::min(std::max(nearbyintf(v), -127.f), 127.f);
+  return static_cast<int8_t>(v);
+}
+
+template <typename T>
+inline void store_one(T* out, float v, float inv_out_scale);
+
+template <>
+inline void store_one<float>(float* out, float v, float inv_out_scale) {
+  *out = v;
+}
+
+template <>
+inline void store_one<int8_t>(int8_t* out, float v, float inv_out_scale) {
+  *out = quant_one(v * inv_out_scale);
+}
+
+inline float act_one(float v, Int8ActType act_type, float alpha) {
+  switch (act_type) {
+    case kInt8ActRelu:
+      return v > 0.f ? v : 0.f;
+    case kInt8ActRelu6:
+      return std::min(std::max(v, 0.f), alpha);
+    case kInt8ActLeakyRelu:
+      return v > 0.f ? v : v * alpha;
+    default:
+      return v;
+  }
+}
+
+#ifdef __AVX2__
+inline __m256 load8_s8(const int8_t* in) {
+  __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(in));
+  return _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(v));
+}
+
+template <typename T>
+inline void store8(T* out, __m256 v, __m256 vinv_out_scale);
+
+template <>
+inline void store8<float>(float* out, __m256 v, __m256 vinv_out_scale) {
+  _mm256_storeu_ps(out, v);
+}
+
+template <>
+inline void store8<int8_t>(int8_t* out, __m256 v, __m256 vinv_out_scale) {
+  v = _mm256_mul_ps(v, vinv_out_scale);
+  v = _mm256_min_ps(_mm256_max_ps(v, _mm256_set1_ps(-127.f)),
+                    _mm256_set1_ps(127.f));
+  __m256i v32 = _mm256_cvtps_epi32(v);
+  __m128i v16 = _mm_packs_epi32(_mm256_castsi256_si128(v32),
+                                _mm256_extracti128_si256(v32, 1));
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_packs_epi16(v16, v16));
+}
+
+inline __m256 act8(__m256 v, Int8ActType act_type, __m256 valpha) {
+  const __m256 vzero = _mm256_setzero_ps();
+  switch (act_type) {
+    case kInt8ActRelu:
+      return _mm256_max_ps(v, vzero);
+    case kInt8ActRelu6:
+      return _mm256_min_ps(_mm256_max_ps(v, vzero), valpha);
+    case kInt8ActLeakyRelu:
+      return _mm256_blendv_ps(_mm256_mul_ps(v, valpha),
+                              v,
+                              _mm256_cmp_ps(v, vzero, _CMP_GT_OS));
+    default:
+      return v;
+  }
+}
+#endif
+
+// y_scalar: y[0] is broadcast over the whole range
+template <typename T>
+void eltwise_range(const int8_t* x,
+                   const int8_t* y,
+                   T* out,
+                   int64_t len,
+                   bool y_scalar,
+                   bool is_mul,
+                   float x_scale,
+                   float y_scale,
+                   float inv_out_scale) {
+  int64_t i = 0;
+  const float y0 = y[0] * y_scale;
+#ifdef __AVX2__
+  const __m256 vxs = _mm256_set1_ps(x_scale);
+  const __m256 vys = _mm256_set1_ps(y_scale);
+  const __m256 vy0 = _mm256_set1_ps(y0);
+  const __m256 vinv = _mm256_set1_ps(inv_out_scale);
+  for (; i + 7 < len; i += 8) {
+    __m256 vx = _mm256_mul_ps(load8_s8(x + i), vxs);
+    __m256 vy = y_scalar ? vy0 : _mm256_mul_ps(load8_s8(y + i), vys);
+    __m256 v = is_mul ? _mm256_mul_ps(vx, vy) : _mm256_add_ps(vx, vy);
+    store8(out + i, v, vinv);
+  }
+#endif
+  for (; i < len; ++i) {
+    const float vx = x[i] * x_scale;
+    const float vy = y_scalar ? y0 : y[i] * y_scale;
+    store_one(out + i, is_mul ? vx * vy : vx + vy, inv_out_scale);
+  }
+}
+}  // namespace
+
+template <typename T>
+void int8_activation(const int8_t* in,
+                     T* out,
+                     int64_t size,
+                     float in_scale,
+                     float out_scale,
+                     Int8ActType act_type,
+                     float alpha) {
+  const float inv_out_scale = 1.f / out_scale;
+  const int64_t blocks = (size + kBlockSize - 1) / kBlockSize;
+#pragma omp parallel for
+  for (int64_t b = 0; b < blocks; ++b) {
+    const int64_t end = std::min(size, (b + 1) * kBlockSize);
+    int64_t i = b * kBlockSize;
+#ifdef __AVX2__
+    const __m256 vin = _mm256_set1_ps(in_scale);
+    const __m256 vinv = _mm256_set1_ps(inv_out_scale);
+    const __m256 valpha = _mm256_set1_ps(alpha);
+    for (; i + 7 < end; i += 8) {
+      __m256 v = _mm256_mul_ps(load8_s8(in + i), vin);
+      store8(out + i, act8(v, act_type, valpha), vinv);
+    }
+#endif
+    for (; i < end; ++i) {
+      store_one(out + i,
+                act_one(in[i] * in_scale, act_type, alpha),
+                inv_out_scale);
+    }
+  }
+}
+
+template <typename T>
+void int8_elementwise(const int8_t* x,
+                      const int8_t* y,
+                      T* out,
+                      int pre,
+                      int n,
+                      int post,
+                      bool y_bcast,
+                      bool is_mul,
+                      float x_scale,
+                      float y_scale,
+                      float out_scale) {
+  const float inv_out_scale = 1.f / out_scale;
+  if (!y_bcast) {
+    const int64_t size = static_cast<int64_t>(pre) * n * post;
+    const int64_t blocks = (size + kBlockSize - 1) / kBlockSize;
+#pragma omp parallel for
+    for (int64_t b = 0; b < blocks; ++b) {
+      const int64_t offset = b * kBlockSize;
+      eltwise_range(x + offset,
+                    y + offset,
+                    out + offset,
+                    std::min(kBlockSize, size - offset),
+                    false,
+                    is_mul,
+                    x_scale,
+                    y_scale,
+                    inv_out_scale);
+    }
+  } else if (post == 1) {
+#pragma omp parallel for
+    for (int p = 0; p < pre; ++p) {
+      const int64_t offset = static_cast<int64_t>(p) * n;
+      eltwise_range(x + offset,
+                    y,
+                    out + offset,
+                    n,
+                    false,
+                    is_mul,
+                    x_scale,
+                    y_scale,
+                    inv_out_scale);
+    }
+  } else {
+#pragma omp parallel for
+    for (int i = 0; i < pre * n; ++i) {
+      const int64_t offset = static_cast<int64_t>(i) * post;
+      eltwise_range(x + offset,
+                    y + i % n,
+                    out + offset,
+                    post,
+                    true,
+                    is_mul,
+                    x_scale,
+                    y_scale,
+                    inv_out_scale);
+    }
+  }
+}
+
+template <typename T>
+void int8_pool2d(const int8_t* in,
+                 T* out,
+                 int n,
+                 int c,
+                 int h,
+                 int w,
+                 int oh,
+                 int ow,
+                 int kh,
+                 int kw,
+                 int stride_h,
+                 int stride_w,
+                 int pad_top,
+                 int pad_left,
+                 bool is_max,
+                 bool exclusive,
+                 float in_scale,
+                 float out_scale) {
+  const float inv_out_scale = 1.f / out_scale;
+#pragma omp parallel for
+  for (int nc = 0; nc < n * c; ++nc) {
+    const int8_t* plane = in + static_cast<int64_t>(nc) * h * w;
+    T* out_plane = out + static_cast<int64_t>(nc) * oh * ow;
+    for (int i = 0; i < oh; ++i) {
+      const int hstart = std::max(i * stride_h - pad_top, 0);
+      const int hend = std::min(i * stride_h - pad_top + kh, h);
+      for (int j = 0; j < ow; ++j) {
+        const int wstart = std::max(j * stride_w - pad_left, 0);
+        const int wend = std::min(j * stride_w - pad_left + kw, w);
+        float v = 0.f;
+        if (is_max) {
+          int max_val = -128;
+          for (int y = hstart; y < hend; ++y) {
+            for (int x = wstart; x < wend; ++x) {
+              max_val = std::max(max_val, static_cast<int>(plane[y * w + x]));
+            }
+          }
+          v = max_val * in_scale;
+        } else {
+          int sum = 0;
+          for (int y = hstart; y < hend; ++y) {
+            for (int x = wstart; x < wend; ++x) {
+              sum += plane[y * w + x];
+            }
+          }
+          const int count =
+              exclusive ? (hend - hstart) * (wend - wstart) : kh * kw;
+          v = count > 0 ? sum * in_scale / count : 0.f;
+        }
+        store_one(out_plane + i * ow + j, v, inv_out_scale);
+      }
+    }
+  }
+}
+
+template <typename T>
+void int8_matmul(const int8_t* a,
+                 const int8_t* b,
+                 T* out,
+                 int m,
+                 int n,
+                 int k,
+                 bool trans_a,
+                 bool trans_b,
+                 float a_scale,
+                 const float* b_scale,
+                 bool b_per_col,
+                 float out_scale) {
+  // widen the rows of a and the columns of b to int16 along k, padded to
+  // 16 so every dot product is a run of madd
+  const int kp = (k + 15) / 16 * 16;
+  std::vector<int16_t> pack_a(static_cast<int64_t>(m) * kp, 0);
+  std::vector<int16_t> pack_b(static_cast<int64_t>(n) * kp, 0);
+#pragma omp parallel for
+  for (int i = 0; i < m; ++i) {
+    int16_t* dst = pack_a.data() + static_cast<int64_t>(i) * kp;
+    for (int l = 0; l < k; ++l) {
+      dst[l] = trans_a ? a[static_cast<int64_t>(l) * m + i]
+                       : a[static_cast<int64_t>(i) * k + l];
+    }
+  }
+#pragma omp parallel for
+  for (int j = 0; j < n; ++j) {
+    int16_t* dst = pack_b.data() + static_cast<int64_t>(j) * kp;
+    for (int l = 0; l < k; ++l) {
+      dst[l] = trans_b ? b[static_cast<int64_t>(j) * k + l]
+                       : b[static_cast<int64_t>(l) * n + j];
+    }
+  }
+
+  const float inv_out_scale = 1.f / out_scale;
+#pragma omp parallel for
+  for (int i = 0; i < m; ++i) {
+    const int16_t* ra = pack_a.data() + static_cast<int64_t>(i) * kp;
+    T* out_row = out + static_cast<int64_t>(i) * n;
+    int j = 0;
+#ifdef __AVX2__
+    for (; j + 3 < n; j += 4) {
+      const int16_t* rb = pack_b.data() + static_cast<int64_t>(j) * kp;
+      __m256i acc0 = _mm256_setzero_si256();
+      __m256i acc1 = _mm256_setzero_si256();
+      __m256i acc2 = _mm256_setzero_si256();
+      __m256i acc3 = _mm256_setzero_si256();
+      for (int l = 0; l < kp; l += 16) {
+        __m256i va =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ra + l));
+        __m256i vb0 =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rb + l));
+        __m256i vb1 =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rb + kp + l));
+        __m256i vb2 = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(rb + 2 * kp + l));
+        __m256i vb3 = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(rb + 3 * kp + l));
+        acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(va, vb0));
+        acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(va, vb1));
+        acc2 = _mm256_add_epi32(acc2, _mm256_madd_epi16(va, vb2));
+        acc3 = _mm256_add_epi32(acc3, _mm256_madd_epi16(va, vb3));
+      }
+      __m256i sum = _mm256_hadd_epi32(_mm256_hadd_epi32(acc0, acc1),
+                                      _mm256_hadd_epi32(acc2, acc3));
+      __m128i sum4 = _mm_add_epi32(_mm256_castsi256_si128(sum),
+                                   _mm256_extracti128_si256(sum, 1));
+      int32_t res[4];
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(res), sum4);
+      for (int jj = 0; jj < 4; ++jj) {
+        const float scale =
+            a_scale * (b_per_col ? b_scale[j + jj] : b_scale[0]);
+        store_one(out_row + j + jj, res[jj] * scale, inv_out_scale);
+      }
+    }
+#endif
+    for (; j < n; ++j) {
+      const int16_t* rb = pack_b.data() + static_cast<int64_t>(j) * kp;
+      int32_t res = 0;
+      for (int l = 0; l < k; ++l) {
+        res += ra[l] * rb[l];
+      }
+      const float scale = a_scale * (b_per_col ? b_scale[j] : b_scale[0]);
+      store_one(out_row + j, res * scale, inv_out_scale);
+    }
+  }
+}
+
+void int8_requant(const int8_t* in, int8_t* out, int64_t size, float scale) {
+  int8_activation<int8_t>(in, out, size, scale, 1.f, kInt8ActNone, 0.f);
+}
+
+void int8_quantize(const float* in, int8_t* out, int64_t size, float scale) {
+  const float inv_scale = 1.f / scale;
+  const int64_t blocks = (size + kBlockSize - 1) / kBlockSize;
+#pragma omp parallel for
+  for (int64_t b = 0; b < blocks; ++b) {
+    const int64_t end = std::min(size, (b + 1) * kBlockSize);
+    int64_t i = b * kBlockSize;
+#ifdef __AVX2__
+    const __m256 vinv = _mm256_set1_ps(inv_scale);
+    for (; i + 7 < end; i += 8) {
+      store8(out + i, _mm256_loadu_ps(in + i), vinv);
+    }
+#endif
+    for (; i < end; ++i) {
+      out[i] = quant_one(in[i] * inv_scale);
+    }
+  }
+}
+
+#define INSTANTIATE_INT8_COMPUTE(T)                                         \
+  template void int8_activation<T>(                                         \
+      const int8_t*, T*, int64_t, float, float, Int8ActType, float);        \
+  template void int8_elementwise<T>(const int8_t*,                          \
+                                    const int8_t*,                          \
+                                    T*,                                     \
+                                    int,                                    \
+                                    int,                                    \
+                                    int,                                    \
+                                    bool,                                   \
+                                    bool,                                   \
+                                    float,                                  \
+                                    float,                                  \
+                                    float);                                 \
+  template void int8_pool2d<T>(const int8_t*,                               \
+                               T*,                                          \
+                               int,                                         \
+                               int,                                         \
+                               int,                                         \
+                               int,                                         \
+                               int,                                         \
+                               int,                                         \
+                               int,                                         \
+                               int,                                         \
+                               int,                                         \
+                               int,                                         \
+                               int,                                         \
+                               int,                                         \
+                               bool,                                        \
+                               bool,                                        \
+                               float,                                       \
+                               float);                                      \
+  template void int8_matmul<T>(const int8_t*,                               \
+                               const int8_t*,                               \
+                               T*,                                          \
+                               int,                                         \
+                               int,                                         \
+                               int,                                         \
+                               bool,                                        \
+                               bool,                                        \
+                               float,                                       \
+                               const float*,                                \
+                               bool,                                        \
+                               float);
+
+INSTANTIATE_INT8_COMPUTE(float)
+INSTANTIATE_INT8_COMPUTE(int8_t)
+#undef INSTANTIATE_INT8_COMPUTE
+
+}  // namespace math
+}  // namespace x86
+}  // namespace lite
+}  // namespace paddle
@@ -0,0 +1,108 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+
+namespace paddle {
+namespace lite {
+namespace x86 {
+namespace math {
+
+// The int8 tensors are quantized symmetrically per tensor, i.e.
+// real = q * scale with q in [-127, 127], the same as the calib kernels.
+// Every function writes either fp32 (the out_scale is ignored) or int8
+// requantized by out_scale, so an int8 op can feed fp32 ops directly.
+
+enum Int8ActType {
+  kInt8ActNone = 0,
+  kInt8ActRelu = 1,
+  kInt8ActRelu6 = 2,      // alpha: the threshold
+  kInt8ActLeakyRelu = 3,  // alpha: the negative slope
+};
+
+// out = act(in * in_scale)
+template <typename T>
+void int8_activation(const int8_t* in,
+                     T* out,
+                     int64_t size,
+                     float in_scale,
+                     float out_scale,
+                     Int8ActType act_type,
+                     float alpha);
+
+// out = x * x_scale (+|*) y * y_scale, x is [pre, n, post] and y is either
+// of the same shape (y_bcast = false) or [n] broadcast over pre and post.
+template <typename T>
+void int8_elementwise(const int8_t* x,
+                      const int8_t* y,
+                      T* out,
+                      int pre,
+                      int n,
+                      int post,
+                      bool y_bcast,
+                      bool is_mul,
+                      float x_scale,
+                      float y_scale,
+                      float out_scale);
+
+// Max or average pooling of NCHW, the paddings are {top, left}, exclusive
+// excludes the padded elements from the average.
+template <typename T>
+void int8_pool2d(const int8_t* in,
+                 T* out,
+                 int n,
+                 int c,
+                 int h,
+                 int w,
+                 int oh,
+                 int ow,
+                 int kh,
+                 int kw,
+                 int stride_h,
+                 int stride_w,
+                 int pad_top,
+                 int pad_left,
+                 bool is_max,
+                 bool exclusive,
+                 float in_scale,
+                 float out_scale);
+
+// out[M, N] = a[M, K] * b[K, N] * a_scale * b_scale[j], a and b are
+// activations, b_scale has either 1 or N (per column) values.
+template <typename T>
+void int8_matmul(const int8_t* a,
+                 const int8_t* b,
+                 T* out,
+                 int m,
+                 int n,
+                 int k,
+                 bool trans_a,
+                 bool trans_b,
+                 float a_scale,
+                 const float* b_scale,
+                 bool b_per_col,
+                 float out_scale);
+
+// out = in * scale, used to bring int8 tensors to a common scale
+void int8_requant(const int8_t* in, int8_t* out, int64_t size, float scale);
+
+// out = in / scale
+void int8_quantize(const float* in, int8_t* out, int64_t size, float scale);
+
+}  // namespace math
+}  // namespace x86
+}  // namespace lite
+}  // namespace paddle
@@ -13,7 +13,19 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "lite/backends/x86/math/softmax.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include "lite/backends/x86/cpu_info.h"
 #include "lite/backends/x86/math/softmax_impl.h"
+#include "lite/backends/x86/parallel.h"
+#ifdef LITE_WITH_AVX512
+#include "lite/backends/x86/math/avx512/softmax_avx512.h"
+#endif
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#endif
 
 namespace paddle {
 namespace lite {
@@ -28,6 +40,390 @@ template class SoftmaxFunctor<lite::TargetType::kX86, float, true>;
 // template class SoftmaxGradFunctor<lite::TargetType::kX86, float>;
 // template class SoftmaxGradFunctor<lite::TargetType::kX86, double>;
 
+// Smaller problems run on the calling thread, where the cost of waking up
+// the thread pool is larger than the work.
+static constexpr int64_t kSoftmaxParallelMinSize = 16384;
+// Lanes of the inner axis handled by one task when axis is not the last one.
+static constexpr int64_t kSoftmaxInnerBlock = 8;
+
+static inline float softmax_input(const float* x,
+                                  const float* mask,
+                                  int64_t i,
+                                  float scale) {
+  return mask ? x[i] * scale + mask[i] : x[i] * scale;
+}
+
+#if defined(__AVX2__) && defined(__FMA__)
+// exp(x) with a degree 5 polynomial on the reduced argument, inputs below
+// -88.37 return 0 so that masked positions do not contribute to the sum.
+static inline __m256 exp_ps_avx2(__m256 x) {
+  const __m256 one = _mm256_set1_ps(1.f);
+  x = _mm256_min_ps(x, _mm256_set1_ps(88.3762626647949f));
+  x = _mm256_max_ps(x, _mm256_set1_ps(-88.3762626647949f));
+  // exp(x) = 2^n * exp(g), n = floor(x * log2(e) + 0.5)
+  __m256 fx = _mm256_fmadd_ps(
+      x, _mm256_set1_ps(1.44269504088896341f), _mm256_set1_ps(0.5f));
+  fx = _mm256_floor_ps(fx);
+  x = _mm256_fnmadd_ps(fx, _mm256_set1_ps(0.693359375f), x);
+  x = _mm256_fnmadd_ps(fx, _mm256_set1_ps(-2.12194440e-4f), x);
+  __m256 y = _mm256_set1_ps(1.9875691500E-4f);
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(1.3981999507E-3f));
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(8.3334519073E-3f));
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(4.1665795894E-2f));
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(1.6666665459E-1f));
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(5.0000001201E-1f));
+  y = _mm256_fmadd_ps(y, _mm256_mul_ps(x, x), x);
+  y = _mm256_add_ps(y, one);
+  __m256i n = _mm256_add_epi32(_mm256_cvttps_epi32(fx), _mm256_set1_epi32(127));
+  return _mm256_mul_ps(y, _mm256_castsi256_ps(_mm256_slli_epi32(n, 23)));
+}
+
+static inline float hmax_avx2(__m256 v) {
+  __m128 r = _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+  r = _mm_max_ps(r, _mm_movehl_ps(r, r));
+  r = _mm_max_ss(r, _mm_movehdup_ps(r));
+  return _mm_cvtss_f32(r);
+}
+
+static inline float hsum_avx2(__m256 v) {
+  __m128 r = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+  r = _mm_add_ps(r, _mm_movehl_ps(r, r));
+  r = _mm_add_ss(r, _mm_movehdup_ps(r));
+  return _mm_cvtss_f32(r);
+}
+
+static inline __m256 softmax_input_avx2(const float* x,
+                                        const float* mask,
+                                        int64_t i,
+                                        __m256 vscale) {
+  __m256 v = _mm256_mul_ps(_mm256_loadu_ps(x + i), vscale);
+  return mask ? _mm256_add_ps(v, _mm256_loadu_ps(mask + i)) : v;
+}
+#endif
+
+// Softmax of one contiguous row: a max pass, then exp and sum in one pass
+// which keeps exp(x - max) in y, then the normalization. The row is expected
+// to stay in cache between the passes, so this evaluates exp only once per
+// element.
+static void softmax_row(
+    const float* x, const float* mask, float* y, int64_t n, float scale) {
+  float max_val = std::numeric_limits<float>::lowest();
+  int64_t i = 0;
+#if defined(__AVX2__) && defined(__FMA__)
+  const __m256 vscale = _mm256_set1_ps(scale);
+  __m256 vmax = _mm256_set1_ps(max_val);
+  for (; i + 8 <= n; i += 8) {
+    vmax = _mm256_max_ps(vmax, softmax_input_avx2(x, mask, i, vscale));
+  }
+  max_val = hmax_avx2(vmax);
+#endif
+  for (; i < n; ++i) {
+    max_val = (std::max)(max_val, softmax_input(x, mask, i, scale));
+  }
+
+  float sum = 0.f;
+  i = 0;
+#if defined(__AVX2__) && defined(__FMA__)
+  vmax = _mm256_set1_ps(max_val);
+  __m256 vsum = _mm256_setzero_ps();
+  for (; i + 8 <= n; i += 8) {
+    __m256 e = exp_ps_avx2(
+        _mm256_sub_ps(softmax_input_avx2(x, mask, i, vscale), vmax));
+    _mm256_storeu_ps(y + i, e);
+    vsum = _mm256_add_ps(vsum, e);
+  }
+  sum = hsum_avx2(vsum);
+#endif
+  for (; i < n; ++i) {
+    y[i] = std::exp(softmax_input(x, mask, i, scale) - max_val);
+    sum += y[i];
+  }
+
+  const float inv_sum = 1.f / sum;
+  i = 0;
+#if defined(__AVX2__) && defined(__FMA__)
+  const __m256 vinv = _mm256_set1_ps(inv_sum);
+  for (; i + 8 <= n; i += 8) {
+    _mm256_storeu_ps(y + i, _mm256_mul_ps(_mm256_loadu_ps(y + i), vinv));
+  }
+#endif
+  for (; i < n; ++i) {
+    y[i] *= inv_sum;
+  }
+}
+
+// Log softmax of one contiguous row. The running max and the sum of exp are
+// updated together (the sum is rescaled by exp(old_max - new_max) when the
+// max grows), so x is read once to get log(sum(exp(x - max))), and a second
+// pass writes x - max - log_sum without evaluating exp again.
+static void log_softmax_row(
+    const float* x, const float* mask, float* y, int64_t n, float scale) {
+  float max_val = std::numeric_limits<float>::lowest();
+  float sum = 0.f;
+  int64_t i = 0;
+#if defined(__AVX2__) && defined(__FMA__)
+  const __m256 vscale = _mm256_set1_ps(scale);
+  if (n >= 8) {
+    __m256 vmax = _mm256_set1_ps(max_val);
+    __m256 vsum = _mm256_setzero_ps();
+    for (; i + 8 <= n; i += 8) {
+      __m256 v = softmax_input_avx2(x, mask, i, vscale);
+      if (_mm256_movemask_ps(_mm256_cmp_ps(v, vmax, _CMP_GT_OQ))) {
+        __m256 new_max = _mm256_max_ps(vmax, v);
+        vsum = _mm256_mul_ps(vsum, exp_ps_avx2(_mm256_sub_ps(vmax, new_max)));
+        vmax = new_max;
+      }
+      vsum = _mm256_add_ps(vsum, exp_ps_avx2(_mm256_sub_ps(v, vmax)));
+    }
+    max_val = hmax_avx2(vmax);
+    vsum = _mm256_mul_ps(
+        vsum, exp_ps_avx2(_mm256_sub_ps(vmax, _mm256_set1_ps(max_val))));
+    sum = hsum_avx2(vsum);
+  }
+#endif
+  for (; i < n; ++i) {
+    float v = softmax_input(x, mask, i, scale);
+    if (v > max_val) {
+      sum *= std::exp(max_val - v);
+      max_val = v;
+    }
+    sum += std::exp(v - max_val);
+  }
+
+  const float shift = max_val + std::log(sum);
+  i = 0;
+#if defined(__AVX2__) && defined(__FMA__)
+  const __m256 vshift = _mm256_set1_ps(shift);
+  for (; i + 8 <= n; i += 8) {
+    _mm256_storeu_ps(
+        y + i,
+        _mm256_sub_ps(softmax_input_avx2(x, mask, i, vscale), vshift));
+  }
+#endif
+  for (; i < n; ++i) {
+    y[i] = softmax_input(x, mask, i, scale) - shift;
+  }
+}
+
+// (Log) softmax of one element of the inner axis, whose axis_dim values are
+// `inner` apart.
+static void softmax_strided_ref(const float* x,
+                                float* y,
+                                int64_t axis_dim,
+                                int64_t inner,
+                                float scale,
+                                bool log) {
+  float max_val = std::numeric_limits<float>::lowest();
+  for (int64_t k = 0; k < axis_dim; ++k) {
+    max_val = (std::max)(max_val, x[k * inner] * scale);
+  }
+  float sum = 0.f;
+  for (int64_t k = 0; k < axis_dim; ++k) {
+    float e = std::exp(x[k * inner] * scale - max_val);
+    if (!log) {
+      y[k * inner] = e;
+    }
+    sum += e;
+  }
+  if (log) {
+    const float shift = max_val + std::log(sum);
+    for (int64_t k = 0; k < axis_dim; ++k) {
+      y[k * inner] = x[k * inner] * scale - shift;
+    }
+  } else {
+    const float inv_sum = 1.f / sum;
+    for (int64_t k = 0; k < axis_dim; ++k) {
+      y[k * inner] *= inv_sum;
+    }
+  }
+}
+
+// (Log) softmax of up to kSoftmaxInnerBlock consecutive elements of the inner
+// axis, each vector lane computes an independent softmax.
+static void softmax_strided_block(const float* x,
+                                  float* y,
+                                  int64_t axis_dim,
+                                  int64_t inner,
+                                  int64_t lanes,
+                                  float scale,
+                                  bool log) {
+#if defined(__AVX2__) && defined(__FMA__)
+  const __m256i lane_mask = _mm256_cmpgt_epi32(
+      _mm256_set1_epi32(static_cast<int>(lanes)),
+      _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+  const __m256 vscale = _mm256_set1_ps(scale);
+  __m256 vmax = _mm256_set1_ps(std::numeric_limits<float>::lowest());
+  for (int64_t k = 0; k < axis_dim; ++k) {
+    __m256 v = _mm256_mul_ps(_mm256_maskload_ps(x + k * inner, lane_mask),
+                             vscale);
+    vmax = _mm256_max_ps(vmax, v);
+  }
+  __m256 vsum = _mm256_setzero_ps();
+  for (int64_t k = 0; k < axis_dim; ++k) {
+    __m256 v = _mm256_mul_ps(_mm256_maskload_ps(x + k * inner, lane_mask),
+                             vscale);
+    __m256 e = exp_ps_avx2(_mm256_sub_ps(v, vmax));
+    if (!log) {
+      _mm256_maskstore_ps(y + k * inner, lane_mask, e);
+    }
+    vsum = _mm256_add_ps(vsum, e);
+  }
+  if (log) {
+    alignas(32) float sums[8];
+    _mm256_store_ps(sums, vsum);
+    for (int j = 0; j < 8; ++j) {
+      sums[j] = std::log(sums[j]);
+    }
+    __m256 vshift = _mm256_add_ps(vmax, _mm256_load_ps(sums));
+    for (int64_t k = 0; k < axis_dim; ++k) {
+      __m256 v = _mm256_mul_ps(_mm256_maskload_ps(x + k * inner, lane_mask),
+                               vscale);
+      _mm256_maskstore_ps(
+          y + k * inner, lane_mask, _mm256_sub_ps(v, vshift));
+    }
+  } else {
+    __m256 vinv = _mm256_div_ps(_mm256_set1_ps(1.f), vsum);
+    for (int64_t k = 0; k < axis_dim; ++k) {
+      __m256 e = _mm256_maskload_ps(y + k * inner, lane_mask);
+      _mm256_maskstore_ps(y + k * inner, lane_mask, _mm256_mul_ps(e, vinv));
+    }
+  }
+#else
+  for (int64_t j = 0; j < lanes; ++j) {
+    softmax_strided_ref(x + j, y + j, axis_dim, inner, scale, log);
+  }
+#endif
+}
+
+static void softmax_impl(const float* x,
+                         float* y,
+                         int64_t outer,
+                         int64_t axis_dim,
+                         int64_t inner,
+                         float scale,
+                         const SoftmaxMask* mask,
+                         bool log) {
+  if (outer <= 0 || axis_dim <= 0 || inner <= 0) {
+    return;
+  }
+  CHECK(mask == nullptr || mask->data == nullptr || inner == 1)
+      << "The mask of softmax requires the axis to be the last one.";
+  const bool parallel = outer * axis_dim * inner >= kSoftmaxParallelMinSize;
+
+  if (inner == 1) {
+    auto rows_func = [&](int64_t begin, int64_t end) {
+#ifdef LITE_WITH_AVX512
+      if (MayIUse(avx512f)) {
+        softmax_rows_avx512(x, y, begin, end, axis_dim, scale, mask, log);
+        return;
+      }
+#endif
+      for (int64_t r = begin; r < end; ++r) {
+        const float* m = SoftmaxMaskRow(mask, r, axis_dim);
+        if (log) {
+          log_softmax_row(
+              x + r * axis_dim, m, y + r * axis_dim, axis_dim, scale);
+        } else {
+          softmax_row(x + r * axis_dim, m, y + r * axis_dim, axis_dim, scale);
+        }
+      }
+    };
+    if (parallel) {
+      RunParallelFor(0, outer, rows_func);
+    } else {
+      rows_func(0, outer);
+    }
+    return;
+  }
+
+  const int64_t blocks = (inner + kSoftmaxInnerBlock - 1) / kSoftmaxInnerBlock;
+  auto blocks_func = [&](int64_t begin, int64_t end) {
+    for (int64_t t = begin; t < end; ++t) {
+      const int64_t o = t / blocks;
+      const int64_t j = (t % blocks) * kSoftmaxInnerBlock;
+      const int64_t offset = o * axis_dim * inner + j;
+      softmax_strided_block(x + offset,
+                            y + offset,
+                            axis_dim,
+                            inner,
+                            (std::min)(kSoftmaxInnerBlock, inner - j),
+                            scale,
+                            log);
+    }
+  };
+  if (parallel) {
+    RunParallelFor(0, outer * blocks, blocks_func);
+  } else {
+    blocks_func(0, outer * blocks);
+  }
+}
+
+float softmax_online_step(
+    float* x, const float* mask, int64_t n, float* max_val, float* sum) {
+  float block_max = std::numeric_limits<float>::lowest();
+  int64_t i = 0;
+#if defined(__AVX2__) && defined(__FMA__)
+  __m256 vmax = _mm256_set1_ps(block_max);
+  for (; i + 8 <= n; i += 8) {
+    __m256 v = _mm256_loadu_ps(x + i);
+    if (mask) {
+      v = _mm256_add_ps(v, _mm256_loadu_ps(mask + i));
+      _mm256_storeu_ps(x + i, v);
+    }
+    vmax = _mm256_max_ps(vmax, v);
+  }
+  block_max = hmax_avx2(vmax);
+#endif
+  for (; i < n; ++i) {
+    if (mask) {
+      x[i] += mask[i];
+    }
+    block_max = (std::max)(block_max, x[i]);
+  }
+
+  const float new_max = (std::max)(*max_val, block_max);
+  const float correction = std::exp(*max_val - new_max);
+  float block_sum = 0.f;
+  i = 0;
+#if defined(__AVX2__) && defined(__FMA__)
+  vmax = _mm256_set1_ps(new_max);
+  __m256 vsum = _mm256_setzero_ps();
+  for (; i + 8 <= n; i += 8) {
+    __m256 e = exp_ps_avx2(_mm256_sub_ps(_mm256_loadu_ps(x + i), vmax));
+    _mm256_storeu_ps(x + i, e);
+    vsum = _mm256_add_ps(vsum, e);
+  }
+  block_sum = hsum_avx2(vsum);
+#endif
+  for (; i < n; ++i) {
+    x[i] = std::exp(x[i] - new_max);
+    block_sum += x[i];
+  }
+  *max_val = new_max;
+  *sum = *sum * correction + block_sum;
+  return correction;
+}
+
+void softmax_fp32(const float* x,
+                  float* y,
+                  int64_t outer,
+                  int64_t axis_dim,
+                  int64_t inner,
+                  float scale,
+                  const SoftmaxMask* mask) {
+  softmax_impl(x, y, outer, axis_dim, inner, scale, mask, false);
+}
+
+void log_softmax_fp32(const float* x,
+                      float* y,
+                      int64_t outer,
+                      int64_t axis_dim,
+                      int64_t inner,
+                      float scale,
+                      const SoftmaxMask* mask) {
+  softmax_impl(x, y, outer, axis_dim, inner, scale, mask, true);
+}
+
 }  // namespace math
 }  // namespace x86
 }  // namespace lite
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #pragma once
+#include <stdint.h>
 #include "lite/core/context.h"
 #include "lite/core/tensor.h"
 
@@ -33,6 +34,60 @@ class SoftmaxFunctor {
                   lite::Tensor* Y);
 };
 
+// Additive mask of the softmax in attention, which is broadcast to the rows
+// of the scores. Row `r` of the scores reads the mask row
+//   (r / row_period) * rows_per_period + r % rows_per_period
+// e.g. for scores of [B, H, S, S], a mask of [B, 1, 1, S] has
+// (row_period, rows_per_period) = (H * S, 1), [B, 1, S, S] has (H * S, S)
+// and [B, H, S, S] has (S, S).
+struct SoftmaxMask {
+  const float* data{nullptr};
+  int64_t row_period{1};
+  int64_t rows_per_period{1};
+};
+
+inline const float* SoftmaxMaskRow(const SoftmaxMask* mask,
+                                   int64_t row,
+                                   int64_t axis_dim) {
+  if (mask == nullptr || mask->data == nullptr) {
+    return nullptr;
+  }
+  int64_t mask_row = (row / mask->row_period) * mask->rows_per_period +
+                     row % mask->rows_per_period;
+  return mask->data + mask_row * axis_dim;
+}
+
+// y = softmax(x * scale + mask) along the middle axis of x, which is viewed
+// as [outer, axis_dim, inner]. The rows (or the blocks of inner for
+// inner > 1) are split across threads, and the exp is vectorized with
+// AVX-512 or AVX2. The mask is only supported for inner == 1.
+void softmax_fp32(const float* x,
+                  float* y,
+                  int64_t outer,
+                  int64_t axis_dim,
+                  int64_t inner,
+                  float scale = 1.f,
+                  const SoftmaxMask* mask = nullptr);
+
+// y = log(softmax(x * scale + mask)), the max and the sum of exp are
+// computed in a single online pass over x.
+void log_softmax_fp32(const float* x,
+                      float* y,
+                      int64_t outer,
+                      int64_t axis_dim,
+                      int64_t inner,
+                      float scale = 1.f,
+                      const SoftmaxMask* mask = nullptr);
+
+// One step of the online softmax for the tiled attention kernels, which
+// see the scores of a row one block of keys at a time. x[0, n) (plus the
+// contiguous mask if any) is replaced in place by exp(x - new_max), where
+// new_max = max(*max_val, max(x)), and *max_val and *sum are updated.
+// Returns exp(old_max - new_max), the factor that rescales the results
+// accumulated from the previous blocks.
+float softmax_online_step(
+    float* x, const float* mask, int64_t n, float* max_val, float* sum);
+
 template <lite::TargetType Target, typename T, typename Enable = void>
 class SoftmaxGradFunctor {
  public:
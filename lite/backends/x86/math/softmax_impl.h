@@ -16,10 +16,8 @@ limitations under the License. */
 #include <vector>
 #include "lite/backends/x86/cpu_info.h"
 #include "lite/backends/x86/fluid/eigen.h"
-#include "lite/backends/x86/jit/helper.h"
-#include "lite/backends/x86/jit/kernel_base.h"
-#include "lite/backends/x86/jit/kernels.h"
 #include "lite/backends/x86/math/cpu_vec.h"
+#include "lite/backends/x86/math/softmax.h"
 #include "lite/core/tensor.h"
 
 namespace paddle {
@@ -141,49 +139,14 @@ class SoftmaxFunctor<Target, float, true, enable_if_CPU<Target>> {
                   const lite::Tensor* X,
                   lite::Tensor* Y) {
     const auto& in_dims = X->dims();
-    const float* in_data = X->data<float>();
-    float* out_data = Y->mutable_data<float>();
     const int kBatchDim = 0;
     const int kClassDim = 1;
-#ifdef PADDLE_WITH_MKLML
-    // 2D data. Batch x C
-    auto compute_softmax =
-        lite::jit::KernelFuncs<lite::jit::SoftmaxTuple<float>,
-                               fluid::CPUPlace>::Cache()
-            .At(in_dims[kClassDim]);
-    compute_softmax(in_data,
-                    out_data,
-                    in_dims[kClassDim],
-                    in_dims[kBatchDim],
-                    in_dims[kClassDim] / axis_dim);
-#else
-    const int batch_size = in_dims[kBatchDim];
-    const int length = in_dims[kClassDim];
-    const int stride = in_dims[kClassDim] / axis_dim;
-    for (int bs = 0; bs < batch_size; ++bs) {
-      // get max value of input data
-      float in_max = -FLT_MAX;
-      for (int i = 0; i < length; ++i) {
-        in_max = (std::max)(in_max, in_data[i]);
-      }
-      // y = exp(x - in_max)
-      for (int i = 0; i < length; ++i) {
-        out_data[i] = static_cast<float>(std::exp(in_data[i] - in_max));
-      }
-      // y = y / sum(y[i], y[i + stride], y[i + stride + stride] ...)
-      for (int i = 0; i < stride; ++i) {
-        float sum = 0.f;
-        for (int j = 0; j < axis_dim; ++j) {
-          sum += out_data[i + j * stride];
-        }
-        for (int j = 0; j < axis_dim; ++j) {
-          out_data[i + j * stride] /= sum;
-        }
-      }
-      in_data += length;
-      out_data += length;
-    }
-#endif
+    // 2D data. Batch x C, where C = axis_dim x remain
+    softmax_fp32(X->data<float>(),
+                 Y->mutable_data<float>(),
+                 in_dims[kBatchDim],
+                 axis_dim,
+                 in_dims[kClassDim] / axis_dim);
   }
 };
 
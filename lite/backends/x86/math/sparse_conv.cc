@@ -0,0 +1,506 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/backends/x86/math/sparse_conv.h"
+#include <immintrin.h>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <type_traits>
+#include "lite/backends/x86/cpu_info.h"
+#include "lite/backends/x86/math/fill_bias_activate.h"
+#include "lite/backends/x86/parallel.h"
+#include "lite/utils/log/cp_logging.h"
+#ifdef LITE_WITH_AVX512
+#include "lite/backends/x86/math/avx512/sparse_conv_avx512.h"
+#endif
+
+namespace paddle {
+namespace lite {
+namespace x86 {
+namespace math {
+
+template <typename T>
+void sparse_matrix_decode(const T* nonzeros,
+                          const int32_t* diffs,
+                          const uint32_t* oc_nonzeros,
+                          int rows,
+                          int cols,
+                          int first_ic,
+                          bool semi,
+                          int64_t diff_stride,
+                          SparseMatrix<T>* out) {
+  CHECK_GT(diff_stride, 0);
+  const bool padded = std::is_same<T, float>::value && !semi;
+  const int num_blocks = semi ? (rows + 1) / 2 : rows;
+  out->rows = rows;
+  out->cols = cols;
+  out->semi = semi;
+  out->offsets.assign(1, 0);
+  out->col_index.clear();
+  out->values.clear();
+  for (int blk = 0; blk < num_blocks; ++blk) {
+    const int width = (semi && 2 * blk + 1 < rows) ? 2 : 1;
+    // the last diff of the previous block holds the distance from first_ic
+    // to the first nonzero of this block
+    int64_t start = 0;
+    int64_t ic = first_ic;
+    if (blk > 0) {
+      const uint32_t prev = oc_nonzeros[blk - 1];
+      start = prev;
+      if (padded && (prev & 3)) {
+        start += 4 - (prev & 3);
+      }
+      if (prev != 0) {
+        CHECK_EQ(diffs[prev - 1] % diff_stride, 0)
+            << "sparse weight was compressed for another input size";
+        ic += diffs[prev - 1] / diff_stride;
+      }
+    }
+    const int64_t nnz = static_cast<int64_t>(oc_nonzeros[blk]) - start;
+    CHECK_GE(nnz, 0);
+    const T* vals = nonzeros + (semi ? 2 * start : start);
+    for (int64_t j = 0; j < nnz; ++j) {
+      CHECK(ic >= 0 && ic < cols) << "bad input channel " << ic;
+      out->col_index.push_back(static_cast<int32_t>(ic));
+      for (int r = 0; r < width; ++r) {
+        out->values.push_back(vals[j * width + r]);
+      }
+      if (j + 1 < nnz) {
+        CHECK_EQ(diffs[start + j] % diff_stride, 0)
+            << "sparse weight was compressed for another input size";
+        ic += diffs[start + j] / diff_stride;
+      }
+    }
+    out->offsets.push_back(static_cast<int32_t>(out->col_index.size()));
+  }
+}
+
+template void sparse_matrix_decode<float>(const float* nonzeros,
+                                          const int32_t* diffs,
+                                          const uint32_t* oc_nonzeros,
+                                          int rows,
+                                          int cols,
+                                          int first_ic,
+                                          bool semi,
+                                          int64_t diff_stride,
+                                          SparseMatrix<float>* out);
+template void sparse_matrix_decode<int8_t>(const int8_t* nonzeros,
+                                           const int32_t* diffs,
+                                           const uint32_t* oc_nonzeros,
+                                           int rows,
+                                           int cols,
+                                           int first_ic,
+                                           bool semi,
+                                           int64_t diff_stride,
+                                           SparseMatrix<int8_t>* out);
+
+using SparseBlockFp32Func = void (*)(const float* w,
+                                     const int32_t* cols,
+                                     int nnz,
+                                     int rows,
+                                     const float* b,
+                                     int64_t ldb,
+                                     int n,
+                                     const float* bias,
+                                     float* c,
+                                     int64_t ldc);
+
+using SparseBlockInt8Func = void (*)(const int8_t* w,
+                                     const int32_t* cols,
+                                     int nnz,
+                                     int rows,
+                                     const int8_t* b,
+                                     int64_t ldb,
+                                     int n,
+                                     int32_t* acc);
+
+#if defined(__AVX2__) && defined(__FMA__)
+// nonzeros between the prefetch of an input row and its use
+static constexpr int kPrefetchDistance = 4;
+
+static const int32_t kTailMask[16] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, 0, 0, 0, 0, 0, 0, 0, 0};
+
+// R rows x V ymm columns, the last vector is loaded and stored with mask.
+template <int R, int V>
+static inline void sparse_tile_fp32(const float* w,
+                                    const int32_t* cols,
+                                    int nnz,
+                                    const float* b,
+                                    int64_t ldb,
+                                    const float* bias,
+                                    float* c,
+                                    int64_t ldc,
+                                    __m256i mask) {
+  __m256 acc[R][V];
+  for (int r = 0; r < R; ++r) {
+    const __m256 vbias = _mm256_set1_ps(bias ? bias[r] : 0.f);
+    for (int v = 0; v < V; ++v) {
+      acc[r][v] = vbias;
+    }
+  }
+  for (int j = 0; j < nnz; ++j) {
+    if (j + kPrefetchDistance < nnz) {
+      _mm_prefetch(reinterpret_cast<const char*>(
+                       b + cols[j + kPrefetchDistance] * ldb),
+                   _MM_HINT_T0);
+    }
+    const float* bp = b + cols[j] * ldb;
+    __m256 vb[V];
+    for (int v = 0; v < V - 1; ++v) {
+      vb[v] = _mm256_loadu_ps(bp + 8 * v);
+    }
+    vb[V - 1] = _mm256_maskload_ps(bp + 8 * (V - 1), mask);
+    for (int r = 0; r < R; ++r) {
+      const __m256 vw = _mm256_set1_ps(w[j * R + r]);
+      for (int v = 0; v < V; ++v) {
+        acc[r][v] = _mm256_fmadd_ps(vw, vb[v], acc[r][v]);
+      }
+    }
+  }
+  for (int r = 0; r < R; ++r) {
+    for (int v = 0; v < V - 1; ++v) {
+      _mm256_storeu_ps(c + r * ldc + 8 * v, acc[r][v]);
+    }
+    _mm256_maskstore_ps(c + r * ldc + 8 * (V - 1), mask, acc[r][V - 1]);
+  }
+}
+
+template <int R>
+static void sparse_block_fp32_impl(const float* w,
+                                   const int32_t* cols,
+                                   int nnz,
+                                   const float* b,
+                                   int64_t ldb,
+                                   int n,
+                                   const float* bias,
+                                   float* c,
+                                   int64_t ldc) {
+  const __m256i full = _mm256_set1_epi32(-1);
+  int i = 0;
+  for (; i + 32 <= n; i += 32) {
+    sparse_tile_fp32<R, 4>(w, cols, nnz, b + i, ldb, bias, c + i, ldc, full);
+  }
+  for (; i + 8 <= n; i += 8) {
+    sparse_tile_fp32<R, 1>(w, cols, nnz, b + i, ldb, bias, c + i, ldc, full);
+  }
+  if (i < n) {
+    const __m256i mask = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(kTailMask + 8 - (n - i)));
+    sparse_tile_fp32<R, 1>(w, cols, nnz, b + i, ldb, bias, c + i, ldc, mask);
+  }
+}
+
+static inline int32_t pack_int8_pair(int8_t lo, int8_t hi) {
+  return static_cast<int32_t>(static_cast<uint16_t>(lo)) |
+         (static_cast<int32_t>(static_cast<uint16_t>(hi)) << 16);
+}
+
+template <int R>
+static void sparse_block_int8_impl(const int8_t* w,
+                                   const int32_t* cols,
+                                   int nnz,
+                                   const int8_t* b,
+                                   int64_t ldb,
+                                   int n,
+                                   int32_t* acc) {
+  int i = 0;
+  for (; i + 16 <= n; i += 16) {
+    // two input rows are interleaved as int16 pairs, so one `vpmaddwd`
+    // accumulates two nonzeros of a row for 8 columns
+    __m256i lo[R];
+    __m256i hi[R];
+    for (int r = 0; r < R; ++r) {
+      lo[r] = _mm256_setzero_si256();
+      hi[r] = _mm256_setzero_si256();
+    }
+    for (int j = 0; j < nnz; j += 2) {
+      const bool has_next = j + 1 < nnz;
+      const __m256i va = _mm256_cvtepi8_epi16(_mm_loadu_si128(
+          reinterpret_cast<const __m128i*>(b + cols[j] * ldb + i)));
+      const __m256i vb =
+          has_next ? _mm256_cvtepi8_epi16(_mm_loadu_si128(
+                         reinterpret_cast<const __m128i*>(
+                             b + cols[j + 1] * ldb + i)))
+                   : _mm256_setzero_si256();
+      const __m256i ab_lo = _mm256_unpacklo_epi16(va, vb);
+      const __m256i ab_hi = _mm256_unpackhi_epi16(va, vb);
+      for (int r = 0; r < R; ++r) {
+        const __m256i vw = _mm256_set1_epi32(
+            pack_int8_pair(w[j * R + r], has_next ? w[(j + 1) * R + r] : 0));
+        lo[r] = _mm256_add_epi32(lo[r], _mm256_madd_epi16(ab_lo, vw));
+        hi[r] = _mm256_add_epi32(hi[r], _mm256_madd_epi16(ab_hi, vw));
+      }
+    }
+    // lo holds the columns 0-3 and 8-11, hi holds 4-7 and 12-15
+    for (int r = 0; r < R; ++r) {
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc + r * n + i),
+                          _mm256_permute2x128_si256(lo[r], hi[r], 0x20));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc + r * n + i + 8),
+                          _mm256_permute2x128_si256(lo[r], hi[r], 0x31));
+    }
+  }
+  for (int r = 0; r < R; ++r) {
+    for (int k = i; k < n; ++k) {
+      int32_t sum = 0;
+      for (int j = 0; j < nnz; ++j) {
+        sum += static_cast<int32_t>(w[j * R + r]) * b[cols[j] * ldb + k];
+      }
+      acc[r * n + k] = sum;
+    }
+  }
+}
+#else
+template <int R>
+static void sparse_block_fp32_impl(const float* w,
+                                   const int32_t* cols,
+                                   int nnz,
+                                   const float* b,
+                                   int64_t ldb,
+                                   int n,
+                                   const float* bias,
+                                   float* c,
+                                   int64_t ldc) {
+  for (int r = 0; r < R; ++r) {
+    float* out = c + r * ldc;
+    std::fill(out, out + n, bias ? bias[r] : 0.f);
+    for (int j = 0; j < nnz; ++j) {
+      const float* bp = b + cols[j] * ldb;
+      const float wv = w[j * R + r];
+      for (int k = 0; k < n; ++k) {
+        out[k] += wv * bp[k];
+      }
+    }
+  }
+}
+
+template <int R>
+static void sparse_block_int8_impl(const int8_t* w,
+                                   const int32_t* cols,
+                                   int nnz,
+                                   const int8_t* b,
+                                   int64_t ldb,
+                                   int n,
+                                   int32_t* acc) {
+  for (int r = 0; r < R; ++r) {
+    int32_t* out = acc + r * n;
+    std::fill(out, out + n, 0);
+    for (int j = 0; j < nnz; ++j) {
+      const int8_t* bp = b + cols[j] * ldb;
+      const int32_t wv = w[j * R + r];
+      for (int k = 0; k < n; ++k) {
+        out[k] += wv * bp[k];
+      }
+    }
+  }
+}
+#endif
+
+static void sparse_block_fp32(const float* w,
+                              const int32_t* cols,
+                              int nnz,
+                              int rows,
+                              const float* b,
+                              int64_t ldb,
+                              int n,
+                              const float* bias,
+                              float* c,
+                              int64_t ldc) {
+  if (rows == 2) {
+    sparse_block_fp32_impl<2>(w, cols, nnz, b, ldb, n, bias, c, ldc);
+  } else {
+    sparse_block_fp32_impl<1>(w, cols, nnz, b, ldb, n, bias, c, ldc);
+  }
+}
+
+static void sparse_block_int8(const int8_t* w,
+                              const int32_t* cols,
+                              int nnz,
+                              int rows,
+                              const int8_t* b,
+                              int64_t ldb,
+                              int n,
+                              int32_t* acc) {
+  if (rows == 2) {
+    sparse_block_int8_impl<2>(w, cols, nnz, b, ldb, n, acc);
+  } else {
+    sparse_block_int8_impl<1>(w, cols, nnz, b, ldb, n, acc);
+  }
+}
+
+void sparse_spmm_fp32(const SparseMatrix<float>& w,
+                      const float* b,
+                      int64_t ldb,
+                      int n,
+                      const float* bias,
+                      float* c,
+                      int64_t ldc,
+                      const operators::ActivationParam& act) {
+  SparseBlockFp32Func block_func = sparse_block_fp32;
+#ifdef LITE_WITH_AVX512
+  if (MayIUse(avx512f)) {
+    block_func = sparse_block_fp32_avx512;
+  }
+#endif
+  RunParallelFor(0, w.num_blocks(), [&](int64_t begin, int64_t end) {
+    for (int64_t blk = begin; blk < end; ++blk) {
+      const int row = w.block_row(blk);
+      const int rows = w.block_rows(blk);
+      const int nnz = w.offsets[blk + 1] - w.offsets[blk];
+      float* out = c + row * ldc;
+      block_func(w.block_values(blk),
+                 w.col_index.data() + w.offsets[blk],
+                 nnz,
+                 rows,
+                 b,
+                 ldb,
+                 n,
+                 bias ? bias + row : nullptr,
+                 out,
+                 ldc);
+      if (act.has_active) {
+        for (int r = 0; r < rows; ++r) {
+          fill_bias_act(out + r * ldc, nullptr, 1, n, false, &act);
+        }
+      }
+    }
+  });
+}
+
+static void dequant_row(
+    const int32_t* acc, int n, float scale, float bias, float* out) {
+  int i = 0;
+#ifdef __AVX2__
+  const __m256 vscale = _mm256_set1_ps(scale);
+  const __m256 vbias = _mm256_set1_ps(bias);
+  for (; i + 8 <= n; i += 8) {
+    const __m256 v = _mm256_cvtepi32_ps(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc + i)));
+    _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_mul_ps(v, vscale), vbias));
+  }
+#endif
+  for (; i < n; ++i) {
+    out[i] = static_cast<float>(acc[i]) * scale + bias;
+  }
+}
+
+static void quant_row(const float* in, int n, float inv_scale, int8_t* out) {
+  for (int i = 0; i < n; ++i) {
+    const float v = std::nearbyint(in[i] * inv_scale);
+    out[i] = static_cast<int8_t>(std::min(std::max(v, -127.f), 127.f));
+  }
+}
+
+static void finish_row(const int32_t* acc,
+                       int n,
+                       float scale,
+                       float bias,
+                       float inv_output_scale,
+                       const operators::ActivationParam& act,
+                       float* tmp,
+                       float* out) {
+  dequant_row(acc, n, scale, bias, out);
+  if (act.has_active) {
+    fill_bias_act(out, nullptr, 1, n, false, &act);
+  }
+}
+
+static void finish_row(const int32_t* acc,
+                       int n,
+                       float scale,
+                       float bias,
+                       float inv_output_scale,
+                       const operators::ActivationParam& act,
+                       float* tmp,
+                       int8_t* out) {
+  dequant_row(acc, n, scale, bias, tmp);
+  if (act.has_active) {
+    fill_bias_act(tmp, nullptr, 1, n, false, &act);
+  }
+  quant_row(tmp, n, inv_output_scale, out);
+}
+
+template <typename OutT>
+void sparse_spmm_int8(const SparseMatrix<int8_t>& w,
+                      const int8_t* b,
+                      int64_t ldb,
+                      int n,
+                      const float* scale,
+                      const float* bias,
+                      float output_scale,
+                      OutT* c,
+                      int64_t ldc,
+                      const operators::ActivationParam& act) {
+  SparseBlockInt8Func block_func = sparse_block_int8;
+#ifdef LITE_WITH_AVX512
+  if (MayIUse(avx512_core)) {
+    block_func = sparse_block_int8_avx512;
+  }
+#endif
+  const float inv_output_scale = 1.f / output_scale;
+  RunParallelFor(0, w.num_blocks(), [&](int64_t begin, int64_t end) {
+    std::vector<int32_t> acc(2 * static_cast<size_t>(n));
+    std::vector<float> tmp(n);
+    for (int64_t blk = begin; blk < end; ++blk) {
+      const int row = w.block_row(blk);
+      const int rows = w.block_rows(blk);
+      const int nnz = w.offsets[blk + 1] - w.offsets[blk];
+      block_func(w.block_values(blk),
+                 w.col_index.data() + w.offsets[blk],
+                 nnz,
+                 rows,
+                 b,
+                 ldb,
+                 n,
+                 acc.data());
+      for (int r = 0; r < rows; ++r) {
+        finish_row(acc.data() + r * n,
+                   n,
+                   scale[row + r],
+                   bias ? bias[row + r] : 0.f,
+                   inv_output_scale,
+                   act,
+                   tmp.data(),
+                   c + (row + r) * ldc);
+      }
+    }
+  });
+}
+
+template void sparse_spmm_int8<float>(const SparseMatrix<int8_t>& w,
+                                      const int8_t* b,
+                                      int64_t ldb,
+                                      int n,
+                                      const float* scale,
+                                      const float* bias,
+                                      float output_scale,
+                                      float* c,
+                                      int64_t ldc,
+                                      const operators::ActivationParam& act);
+template void sparse_spmm_int8<int8_t>(const SparseMatrix<int8_t>& w,
+                                       const int8_t* b,
+                                       int64_t ldb,
+                                       int n,
+                                       const float* scale,
+                                       const float* bias,
+                                       float output_scale,
+                                       int8_t* c,
+                                       int64_t ldc,
+                                       const operators::ActivationParam& act);
+
+}  // namespace math
+}  // namespace x86
+}  // namespace lite
+}  // namespace paddle
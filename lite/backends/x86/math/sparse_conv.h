@@ -0,0 +1,104 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "lite/operators/op_params.h"
+
+namespace paddle {
+namespace lite {
+namespace x86 {
+namespace math {
+
+// Sparse weight [rows, cols] of a 1x1 conv or a fc, decoded from the
+// NonZeroWeights / OcNonZeros / Diffs tensors built by
+// sparse_conv_detect_pass. The rows are grouped into blocks: a block is one
+// row, or a pair of rows sharing the positions of their nonzeros if the
+// weight is semi-structured (flag_semi), where an odd last row is a block of
+// its own.
+template <typename T>
+struct SparseMatrix {
+  int rows{0};
+  int cols{0};
+  bool semi{false};
+  // [num_blocks + 1], the nonzero columns of block b are
+  // col_index[offsets[b], offsets[b + 1])
+  std::vector<int32_t> offsets;
+  // input channel of each nonzero column
+  std::vector<int32_t> col_index;
+  // values of the nonzero columns, a pair block stores the values of its two
+  // rows next to each other
+  std::vector<T> values;
+
+  int num_blocks() const { return static_cast<int>(offsets.size()) - 1; }
+  int block_row(int b) const { return semi ? 2 * b : b; }
+  int block_rows(int b) const {
+    return (semi && 2 * b + 1 < rows) ? 2 : 1;
+  }
+  const T* block_values(int b) const {
+    return values.data() + (semi ? 2 * offsets[b] : offsets[b]);
+  }
+};
+
+// Decode the compressed weight of sparse_conv_detect_pass. `diff_stride` is
+// the byte distance between two input channels the pass scaled the diffs
+// with, i.e. sizeof(T) * spatial size of the conv input (sizeof(T) for fc).
+// The fp32 unstructured layout pads every row to a multiple of 4 nonzeros,
+// the padding is dropped here.
+template <typename T>
+void sparse_matrix_decode(const T* nonzeros,
+                          const int32_t* diffs,
+                          const uint32_t* oc_nonzeros,
+                          int rows,
+                          int cols,
+                          int first_ic,
+                          bool semi,
+                          int64_t diff_stride,
+                          SparseMatrix<T>* out);
+
+// C[rows, n] = act(W * B[cols, n] + bias), B and C are row major with the
+// leading dimensions ldb and ldc. The blocks run in parallel and each of
+// them walks the columns in tiles of 32 (AVX2) or 64 (AVX-512) floats, so
+// the rows of a pair block share every load of B.
+void sparse_spmm_fp32(const SparseMatrix<float>& w,
+                      const float* b,
+                      int64_t ldb,
+                      int n,
+                      const float* bias,
+                      float* c,
+                      int64_t ldc,
+                      const operators::ActivationParam& act);
+
+// C[rows, n] = act(scale[row] * (W * B[cols, n]) + bias) for an int8 weight
+// and input, accumulated in int32 two nonzeros at a time by `vpmaddwd`.
+// OutT is float or int8_t, the int8 output is divided by output_scale,
+// rounded and clamped to [-127, 127].
+template <typename OutT>
+void sparse_spmm_int8(const SparseMatrix<int8_t>& w,
+                      const int8_t* b,
+                      int64_t ldb,
+                      int n,
+                      const float* scale,
+                      const float* bias,
+                      float output_scale,
+                      OutT* c,
+                      int64_t ldc,
+                      const operators::ActivationParam& act);
+
+}  // namespace math
+}  // namespace x86
+}  // namespace lite
+}  // namespace paddle
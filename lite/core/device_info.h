@@ -101,6 +101,7 @@ class DeviceInfo {
   }
 
   void ClearArmL3Cache() { workspace_.clear(); }
+  size_t workspace_size() const { return workspace_.capacity(); }
 
   int llc_size() const {
     auto size = absolute_l3cache_size_;
@@ -58,6 +58,29 @@ class KernelBase {
   /// Run the kernel. Before Run, both the param_ and context_ should be valid.
   virtual void Run() = 0;
 
+  /// Transform the weights the way `PrepareForRun` does and write the result
+  /// to `packed`, it's called by the opt tool so only the param_ is valid.
+  /// Return false if the kernel has no weights to pack, otherwise set
+  /// `weight_arg` to the input argument of the raw weights.
+  virtual bool PackWeights(Tensor* packed, std::string* weight_arg) {
+    return false;
+  }
+
+  /// The layout of the packed weights depends on the kernel implementation
+  /// and the instruction set, a packed blob is used only if its tag matches.
+  virtual std::string PackedWeightsTag() const { return ""; }
+
+  /// The input arguments of the weights which `PrepareForRun` rewrites in
+  /// place, e.g. by prepacking them into the same tensor. Their buffers
+  /// differ from the model, so they are not shared with other predictors.
+  virtual std::vector<std::string> WeightsRewrittenInPlace() const {
+    return {};
+  }
+
+  /// Hand the packed weights loaded from the model to the kernel, they must
+  /// be set before the first run and outlive the kernel.
+  void SetPackedWeights(const Tensor* packed) { packed_weights_ = packed; }
+
 #ifdef LITE_WITH_METAL
   virtual void SaveOutput() {}
 #endif
@@ -205,6 +228,8 @@ class KernelBase {
   // is the unique ID for the kernel.
   std::string alias_{};
   bool is_first_epoch_{true};
+  // The weights packed by `PackWeights` offline, nullptr if not available.
+  const Tensor* packed_weights_{nullptr};
 
 #ifdef LITE_WITH_PROFILE
   profile::Profiler* profiler_{nullptr};
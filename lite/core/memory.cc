@@ -22,6 +22,11 @@
 namespace paddle {
 namespace lite {
 
+std::shared_ptr<MemoryTracker>& MemoryTracker::Current() {
+  static LITE_THREAD_LOCAL std::shared_ptr<MemoryTracker> x;
+  return x;
+}
+
 void* TargetMalloc(TargetType target, size_t size) {
   void* data{nullptr};
   if (lite::Allocator::Global().GetCustomAllocator().alloc) {
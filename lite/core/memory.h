@@ -14,6 +14,8 @@
 
 #pragma once
 #include <algorithm>
+#include <atomic>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -92,6 +94,46 @@ void CopySync(void* dst, const void* src, size_t size, IoDirection dir) {
   }
 }
 
+// Counts the bytes of the buffers allocated on behalf of an owner, e.g. a
+// predictor. The owner installs it on the calling thread with
+// MemoryTrackerGuard, and every Buffer allocated meanwhile is charged to it
+// until the buffer is freed, whichever thread frees it.
+class LITE_API MemoryTracker {
+ public:
+  void Alloc(size_t size) {
+    size_t current = current_.fetch_add(size) + size;
+    size_t peak = peak_.load();
+    while (current > peak && !peak_.compare_exchange_weak(peak, current)) {
+    }
+  }
+  void Free(size_t size) { current_.fetch_sub(size); }
+
+  size_t current() const { return current_.load(); }
+  size_t peak() const { return peak_.load(); }
+
+  // The tracker of the calling thread, null if there is none.
+  static std::shared_ptr<MemoryTracker>& Current();
+
+ private:
+  std::atomic<size_t> current_{0};
+  std::atomic<size_t> peak_{0};
+};
+
+// Install a memory tracker on the calling thread during its lifetime.
+class MemoryTrackerGuard {
+ public:
+  explicit MemoryTrackerGuard(const std::shared_ptr<MemoryTracker>& tracker)
+      : prev_(MemoryTracker::Current()) {
+    MemoryTracker::Current() = tracker;
+  }
+  ~MemoryTrackerGuard() { MemoryTracker::Current() = prev_; }
+
+ private:
+  std::shared_ptr<MemoryTracker> prev_;
+
+  DISALLOW_COPY_AND_ASSIGN(MemoryTrackerGuard);
+};
+
 // Memory buffer manager.
 class Buffer {
  public:
@@ -119,6 +161,7 @@ class Buffer {
       data_ = TargetMalloc(target, size);
       target_ = target;
       space_ = size;
+      Track();
 #ifdef LITE_WITH_OPENCL
       cl_use_image2d_ = false;
 #endif
@@ -198,6 +241,7 @@ class Buffer {
 #endif
 
   virtual void Free() {
+    Untrack();
     if (space_ > 0 && own_data_) {
       if (!cl_use_image2d_ && !metal_use_image2d_) {
 #ifdef LITE_WITH_XPU
@@ -238,6 +282,19 @@ class Buffer {
   Buffer(Buffer&&) = default;
 
  protected:
+  // Charge space_ to the memory tracker of the calling thread, every path
+  // changing space_ frees the buffer first.
+  void Track() {
+    tracker_ = MemoryTracker::Current();
+    if (tracker_) tracker_->Alloc(space_);
+  }
+  void Untrack() {
+    if (tracker_) {
+      tracker_->Free(space_);
+      tracker_.reset();
+    }
+  }
+
   // memory it actually malloced.
   size_t space_{0};
   bool cl_use_image2d_{false};   // only used for OpenCL Image2D
@@ -258,6 +315,7 @@ class Buffer {
   TargetType target_{TargetType::kHost};
   // is use pinnd memory
   bool pinned_{false};
+  std::shared_ptr<MemoryTracker> tracker_;
 };
 
 }  // namespace lite
@@ -14,6 +14,7 @@
 
 #include "lite/core/memory.h"
 #include <gtest/gtest.h>
+#include <memory>
 
 namespace paddle {
 namespace lite {
@@ -30,5 +31,26 @@ TEST(memory, test) {
 #endif
 }
 
+TEST(memory, tracker) {
+  auto tracker = std::make_shared<MemoryTracker>();
+  std::unique_ptr<Buffer> untracked(new Buffer);
+  untracked->ResetLazy(TARGET(kHost), 64);
+  {
+    MemoryTrackerGuard guard(tracker);
+    Buffer buf;
+    buf.ResetLazy(TARGET(kHost), 100);
+    EXPECT_EQ(tracker->current(), 100u);
+    buf.ResetLazy(TARGET(kHost), 300);
+    EXPECT_EQ(tracker->current(), 300u);
+    // a buffer is only charged on allocation
+    untracked->ResetLazy(TARGET(kHost), 32);
+  }
+  EXPECT_EQ(tracker->current(), 0u);
+  EXPECT_EQ(tracker->peak(), 300u);
+  EXPECT_FALSE(MemoryTracker::Current());
+  untracked->ResetLazy(TARGET(kHost), 128);
+  EXPECT_EQ(tracker->current(), 0u);
+}
+
 }  // namespace lite
 }  // namespace paddle
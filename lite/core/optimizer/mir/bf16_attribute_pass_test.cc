@@ -0,0 +1,202 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/optimizer/mir/bf16_attribute_pass.h"
+#include <gtest/gtest.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "lite/core/op_registry.h"
+#include "lite/core/optimizer/mir/ssa_graph.h"
+#include "lite/core/optimizer/mir/static_kernel_pick_pass.h"
+#include "lite/core/program.h"
+#include "lite/model_parser/cpp_desc.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+using ArgNames = std::map<std::string, std::vector<std::string>>;
+
+static cpp::OpDesc* AddOpDesc(cpp::BlockDesc* block_desc,
+                              const std::string& type,
+                              const ArgNames& inputs,
+                              const ArgNames& outputs) {
+  auto* op_desc = block_desc->AddOp<cpp::OpDesc>();
+  op_desc->SetType(type);
+  for (auto& input : inputs) {
+    op_desc->SetInput(input.first, input.second);
+  }
+  for (auto& output : outputs) {
+    op_desc->SetOutput(output.first, output.second);
+  }
+  return op_desc;
+}
+
+static void AddWeightDesc(cpp::BlockDesc* block_desc,
+                          const std::string& name,
+                          VarDescAPI::Type data_type) {
+  auto* var_desc = block_desc->AddVar<cpp::VarDesc>();
+  var_desc->SetName(name);
+  var_desc->SetType(VarDescAPI::Type::LOD_TENSOR);
+  var_desc->SetDataType(data_type);
+  var_desc->SetPersistable(true);
+}
+
+template <typename T>
+static void AddWeight(Scope* scope, const std::string& name, const DDim& dims) {
+  auto* tensor = scope->Var(name)->GetMutable<Tensor>();
+  tensor->Resize(dims);
+  auto* data = tensor->mutable_data<T>();
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    data[i] = static_cast<T>(i % 7);
+  }
+  tensor->set_persistable(true);
+}
+
+// x = feed
+// fc_out = fc(x, w, b)           w and b are fp32
+// mm_out = matmul(fc_out, w8)    w8 is int8
+// relu_out = relu(fc_out)        no bf16 kernel
+// fetch(mm_out, relu_out)
+class BF16Graph {
+ public:
+  explicit BF16Graph(bool with_bf16) {
+    program_desc_ = std::make_shared<cpp::ProgramDesc>();
+    scope_ = std::make_shared<Scope>();
+    auto* block_desc = program_desc_->AddBlock<cpp::BlockDesc>();
+    block_desc->ClearOps();
+    block_desc->ClearVars();
+    for (auto name : {"feed", "fetch", "x", "fc_out", "mm_out", "relu_out"}) {
+      block_desc->AddVar<cpp::VarDesc>()->SetName(name);
+    }
+    AddWeightDesc(block_desc, "w", VarDescAPI::Type::FP32);
+    AddWeightDesc(block_desc, "b", VarDescAPI::Type::FP32);
+    AddWeightDesc(block_desc, "w8", VarDescAPI::Type::INT8);
+    AddWeight<float>(scope_.get(), "w", DDim({8, 4}));
+    AddWeight<float>(scope_.get(), "b", DDim({4}));
+    AddWeight<int8_t>(scope_.get(), "w8", DDim({4, 4}));
+
+    AddOpDesc(block_desc, "feed", {{"X", {"feed"}}}, {{"Out", {"x"}}})
+        ->SetAttr<int>("col", 0);
+    auto* fc = AddOpDesc(block_desc,
+                         "fc",
+                         {{"Input", {"x"}}, {"W", {"w"}}, {"Bias", {"b"}}},
+                         {{"Out", {"fc_out"}}});
+    fc->SetAttr<int>("in_num_col_dims", 1);
+    auto* matmul = AddOpDesc(block_desc,
+                             "matmul",
+                             {{"X", {"fc_out"}}, {"Y", {"w8"}}},
+                             {{"Out", {"mm_out"}}});
+    matmul->SetAttr<bool>("transpose_X", false);
+    matmul->SetAttr<bool>("transpose_Y", false);
+    matmul->SetAttr<float>("alpha", 1.f);
+    AddOpDesc(block_desc, "relu", {{"X", {"fc_out"}}}, {{"Out", {"relu_out"}}});
+    int col = 0;
+    for (auto name : {"mm_out", "relu_out"}) {
+      AddOpDesc(block_desc, "fetch", {{"X", {name}}}, {{"Out", {"fetch"}}})
+          ->SetAttr<int>("col", col++);
+    }
+
+    std::vector<Place> valid_places;
+    if (with_bf16) {
+      valid_places.emplace_back(TARGET(kX86), PRECISION(kBF16));
+    }
+    valid_places.emplace_back(TARGET(kX86), PRECISION(kFloat));
+    valid_places.emplace_back(TARGET(kHost), PRECISION(kAny));
+    program_.reset(new Program(program_desc_, scope_, valid_places));
+    graph_.reset(new SSAGraph());
+    graph_->Build(*program_, valid_places);
+    graph_->SetValidPlaces(valid_places);
+  }
+
+  const std::unique_ptr<SSAGraph>& graph() { return graph_; }
+
+  // Pick the kernels, and mark the weights as the optimizer does then.
+  void ApplyPasses() {
+    StaticKernelPickPass pick_pass;
+    pick_pass.mutable_kernel_pick_factors()->ConsiderTarget();
+    pick_pass.mutable_kernel_pick_factors()->ConsiderPrecision();
+    pick_pass.Apply(graph_);
+    BF16AttributePass bf16_pass;
+    bf16_pass.Apply(graph_);
+  }
+
+  Node* FindOp(const std::string& type) {
+    for (auto* node : graph_->StmtTopologicalOrder()) {
+      if (node->AsStmt().op_type() == type) return node;
+    }
+    return nullptr;
+  }
+
+  PrecisionType PickedPrecision(const std::string& type) {
+    return FindOp(type)->AsStmt().picked_kernel().precision();
+  }
+
+  bool MarkedBF16(const std::string& type, const std::string& weight) {
+    auto* op_info = FindOp(type)->AsStmt().op_info();
+    return op_info->HasAttr(weight + "_bf16");
+  }
+
+ private:
+  std::shared_ptr<cpp::ProgramDesc> program_desc_;
+  std::shared_ptr<Scope> scope_;
+  std::unique_ptr<Program> program_;
+  std::unique_ptr<SSAGraph> graph_;
+};
+
+TEST(bf16_attribute_pass, mark_fp32_weights) {
+  BF16Graph test_graph(true);
+  test_graph.ApplyPasses();
+
+  ASSERT_EQ(test_graph.PickedPrecision("fc"), PRECISION(kBF16));
+  ASSERT_EQ(test_graph.PickedPrecision("matmul"), PRECISION(kBF16));
+  EXPECT_EQ(test_graph.PickedPrecision("relu"), PRECISION(kFloat));
+  // the W of fc is declared bf16, while its Bias stays fp32
+  EXPECT_TRUE(test_graph.MarkedBF16("fc", "w"));
+  EXPECT_EQ(test_graph.FindOp("fc")->AsStmt().op_info()->GetAttr<std::string>(
+                "w_bf16"),
+            "bf16");
+  EXPECT_FALSE(test_graph.MarkedBF16("fc", "b"));
+  EXPECT_FALSE(test_graph.MarkedBF16("fc", "x"));
+  // the int8 weight can't be converted
+  EXPECT_FALSE(test_graph.MarkedBF16("matmul", "w8"));
+}
+
+TEST(bf16_attribute_pass, skip_fp32_kernels) {
+  BF16Graph test_graph(false);
+  test_graph.ApplyPasses();
+
+  EXPECT_EQ(test_graph.PickedPrecision("fc"), PRECISION(kFloat));
+  EXPECT_FALSE(test_graph.MarkedBF16("fc", "w"));
+  EXPECT_FALSE(test_graph.MarkedBF16("fc", "b"));
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_OP(feed);
+USE_LITE_OP(fetch);
+USE_LITE_OP(fc);
+USE_LITE_OP(matmul);
+USE_LITE_OP(relu);
+USE_LITE_KERNEL(fc, kX86, kBF16, kNCHW, def);
+USE_LITE_KERNEL(fc, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(matmul, kX86, kBF16, kNCHW, def);
+USE_LITE_KERNEL(matmul, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(relu, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(feed, kHost, kAny, kAny, def);
+USE_LITE_KERNEL(fetch, kHost, kAny, kAny, def);
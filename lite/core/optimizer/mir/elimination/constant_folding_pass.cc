@@ -0,0 +1,243 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/optimizer/mir/elimination/constant_folding_pass.h"
+#include <algorithm>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include "lite/core/context.h"
+#include "lite/core/optimizer/mir/pattern_matcher.h"
+#include "lite/core/optimizer/mir/ssa_graph_utils.h"
+#include "lite/utils/env.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+// Ops which must run at every inference even if their inputs are constants
+static const std::set<std::string> kUnfoldableOps{
+    "feed",
+    "fetch",
+    "while",
+    "conditional_block",
+    "select_input",
+    "select_output",
+    "io_copy",
+    "io_copy_once",
+    "layout",
+    "layout_once",
+    "calib",
+    "calib_once",
+    "write_to_array",
+    "read_from_array",
+    "lod_array_length",
+    "tensor_array_to_tensor",
+    "lod_tensor_to_array",
+    "array_to_lod_tensor",
+    "increment",
+    "share_data",
+    "uniform_random",
+    "gaussian_random",
+    "randint",
+    "sampling_id",
+    "dropout",
+    "print",
+    "assert",
+    "beam_search",
+    "beam_search_decode"};
+
+static bool PrecisionMatched(PrecisionType decl, PrecisionType actual) {
+  return decl == PRECISION(kAny) || decl == actual;
+}
+
+static bool IsHostTarget(TargetType target) {
+  return target == TARGET(kHost) || target == TARGET(kX86) ||
+         target == TARGET(kARM) || target == TARGET(kAny);
+}
+
+void ConstantFoldingPass::Apply(const std::unique_ptr<SSAGraph>& graph) {
+#ifndef LITE_ON_MODEL_OPTIMIZE_TOOL
+  const int64_t max_bytes = GetIntFromEnv(CONSTANT_FOLDING_MAX_BYTES, 1 << 20);
+  if (max_bytes <= 0) return;
+  int num_folded = 0;
+  for (auto& node : graph->StmtTopologicalOrder()) {
+    if (!node->IsStmt() || !IsFoldable(graph.get(), node)) continue;
+    auto kernel = PickHostKernel(node);
+    if (!kernel) {
+      VLOG(4) << "No host kernel to fold " << node->AsStmt().op_type();
+      continue;
+    }
+    if (!RunOnce(node, kernel.get(), max_bytes)) continue;
+    // Only retain the output tensors as persistable tensors
+    for (auto& out_link : node->outlinks) {
+      out_link->AsArg().is_weight = true;
+      out_link->AsArg().is_persist = true;
+    }
+    std::set<const Node*> nodes2rm{node};
+    GraphSafeRemoveNodes(graph.get(), nodes2rm);
+    num_folded++;
+  }
+  VLOG(3) << "constant_folding_pass folded " << num_folded << " ops";
+#endif
+}
+
+bool ConstantFoldingPass::IsFoldable(SSAGraph* graph, Node* node) {
+  auto& stmt = node->AsStmt();
+  const auto* op_info = stmt.op_info();
+  auto op_type = op_info->Type();
+  if (kUnfoldableOps.count(op_type) || op_info->HasAttr("sub_block") ||
+      op_info->HasAttr("enable_int8")) {
+    return false;
+  }
+  if (node->inlinks.empty() || node->outlinks.empty()) return false;
+  auto* scope = stmt.op()->scope();
+  std::set<std::string> in_names;
+  for (auto* in : node->inlinks) {
+    if (!in->IsArg()) return false;
+    auto* var = scope->FindVar(in->AsArg().name);
+    if (var == nullptr || !var->IsType<lite::Tensor>()) return false;
+    auto& tensor = var->Get<lite::Tensor>();
+    if (!tensor.persistable() || !tensor.IsInitialized()) return false;
+    // A persistable var written by an op, e.g. a state updated in place, is
+    // not a constant
+    if (HasExtraProducers(graph, in->AsArg().name, {}, {})) {
+      VLOG(4) << "Skip folding " << op_type << " whose input "
+              << in->AsArg().name << " is written by an op";
+      return false;
+    }
+    in_names.insert(in->AsArg().name);
+  }
+  for (auto* out : node->outlinks) {
+    if (!out->IsArg()) return false;
+    const auto& name = out->AsArg().name;
+    auto* var = scope->FindVar(name);
+    if (var == nullptr || !var->IsType<lite::Tensor>() ||
+        in_names.count(name)) {
+      return false;
+    }
+    if (HasExtraProducers(graph, name, {op_type})) {
+      VLOG(5) << "WARNING: Unsupported for op output var containing multiple "
+                 "producers";
+      return false;
+    }
+  }
+  return true;
+}
+
+std::unique_ptr<KernelBase> ConstantFoldingPass::PickHostKernel(Node* node) {
+  // The kernels of the other targets can not be run here, and the ones of
+  // the targets which are not compiled are fake.
+  std::vector<TargetType> targets{TARGET(kHost)};
+#ifdef LITE_WITH_X86
+  targets.push_back(TARGET(kX86));
+#endif
+#ifdef LITE_WITH_ARM
+  targets.push_back(TARGET(kARM));
+#endif
+  std::vector<Place> places;
+  for (auto target : targets) {
+    for (auto precision : {PRECISION(kFloat),
+                           PRECISION(kInt8),
+                           PRECISION(kInt32),
+                           PRECISION(kInt64),
+                           PRECISION(kBool),
+                           PRECISION(kAny)}) {
+      places.emplace_back(target, precision);
+    }
+  }
+  auto& stmt = node->AsStmt();
+  const auto* op_info = stmt.op_info();
+  auto* scope = stmt.op()->scope();
+  auto kernels = stmt.op()->CreateKernels(places);
+  for (auto& kernel : kernels) {
+    if (!IsHostTarget(kernel->target())) continue;
+    bool matched = true;
+    for (auto& arg_name : op_info->InputArgumentNames()) {
+      for (auto& var_name : op_info->Input(arg_name)) {
+        const auto* decl = kernel->GetInputDeclType(arg_name);
+        auto precision = scope->FindVar(var_name)->Get<Tensor>().precision();
+        if (!IsHostTarget(decl->target()) ||
+            !PrecisionMatched(decl->precision(), precision)) {
+          matched = false;
+        }
+      }
+    }
+    for (auto& arg_name : op_info->OutputArgumentNames()) {
+      if (op_info->Output(arg_name).empty()) continue;
+      if (!IsHostTarget(kernel->GetOutputDeclType(arg_name)->target())) {
+        matched = false;
+      }
+    }
+    if (matched) return std::move(kernel);
+  }
+  return nullptr;
+}
+
+bool ConstantFoldingPass::RunOnce(Node* node,
+                                  KernelBase* kernel,
+                                  int64_t max_bytes) {
+  auto& stmt = node->AsStmt();
+  auto op = stmt.op();
+  const auto* op_info = stmt.op_info();
+  auto* scope = op->scope();
+  if (!op->CheckShape()) return false;
+  op->InferShape();
+  // The output precision is unknown before running if the kernel accepts
+  // any, count it with the widest input element then
+  size_t in_elem_size = 1;
+  for (auto* in : node->inlinks) {
+    auto precision =
+        scope->FindVar(in->AsArg().name)->Get<Tensor>().precision();
+    in_elem_size = std::max(in_elem_size, PrecisionTypeLength(precision));
+  }
+  int64_t out_bytes = 0;
+  for (auto& arg_name : op_info->OutputArgumentNames()) {
+    if (op_info->Output(arg_name).empty()) continue;
+    auto precision = kernel->GetOutputDeclType(arg_name)->precision();
+    size_t elem_size = precision == PRECISION(kAny)
+                           ? in_elem_size
+                           : PrecisionTypeLength(precision);
+    for (auto& var_name : op_info->Output(arg_name)) {
+      auto& dims = scope->FindVar(var_name)->Get<Tensor>().dims();
+      if (dims.production() < 0) return false;
+      out_bytes += dims.production() * static_cast<int64_t>(elem_size);
+    }
+  }
+  if (out_bytes > max_bytes) {
+    VLOG(4) << "Skip folding " << stmt.op_type() << " whose outputs take "
+            << out_bytes << " bytes";
+    return false;
+  }
+  kernel->SetContext(ContextScheduler::Global().NewContext(kernel->target()));
+  kernel->Launch();
+  for (auto* out : node->outlinks) {
+    scope->FindVar(out->AsArg().name)
+        ->GetMutable<lite::Tensor>()
+        ->set_persistable(true);
+  }
+  VLOG(4) << "Folded " << stmt.op_type() << " into " << out_bytes
+          << " bytes of weights";
+  return true;
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_MIR_PASS(constant_folding_pass,
+                  paddle::lite::mir::ConstantFoldingPass)
+    .BindTargets({TARGET(kX86), TARGET(kARM), TARGET(kNNAdapter)});
@@ -0,0 +1,67 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "lite/core/kernel.h"
+#include "lite/core/optimizer/mir/pass.h"
+#include "lite/core/optimizer/mir/pass_registry.h"
+#include "lite/core/tensor.h"
+#include "lite/core/types.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+// Evaluate the ops whose inputs are all persistable once at optimization time
+// with their host/x86/arm kernels, and replace their outputs with persistable
+// weights. The ops are visited in topological order and a folded output is a
+// constant for its consumers, so a whole constant subgraph (e.g. cast ->
+// transpose2 -> reshape2 of a table) is folded in one pass.
+//
+// For example:
+//      weight(persistable)                weight'(persistable)
+//             |                                    |
+//       OP: transpose2             ==>             |
+//             |                                    |
+//           cast                                   |
+//             |                                    |
+//   x ----- OP: matmul                 x ----- OP: matmul
+//
+// The ops with side effects, random outputs or sub-blocks are never folded,
+// nor are the ops reading a persistable var written by another op, or the
+// outputs larger than CONSTANT_FOLDING_MAX_BYTES. All kernels of
+// the model optimize tool are fake, so the pass does nothing there and folds
+// when the full api optimizes a model instead.
+class ConstantFoldingPass : public mir::StmtPass {
+ public:
+  void Apply(const std::unique_ptr<SSAGraph>& graph) override;
+
+ private:
+  // Whether all inputs of the op are persistable tensors and its outputs can
+  // become persistable weights
+  bool IsFoldable(SSAGraph* graph, Node* node);
+  // Create a kernel of the op which runs on the host cpu and accepts the
+  // precisions of its inputs, nullptr if there is none
+  std::unique_ptr<KernelBase> PickHostKernel(Node* node);
+  // Run the op once, return false if its outputs are too large
+  bool RunOnce(Node* node, KernelBase* kernel, int64_t max_bytes);
+};
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
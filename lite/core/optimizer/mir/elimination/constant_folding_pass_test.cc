@@ -0,0 +1,209 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/optimizer/mir/elimination/constant_folding_pass.h"
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "lite/core/op_registry.h"
+#include "lite/core/optimizer/mir/ssa_graph.h"
+#include "lite/core/program.h"
+#include "lite/model_parser/cpp_desc.h"
+#include "lite/utils/env.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+using ArgNames = std::map<std::string, std::vector<std::string>>;
+
+static cpp::OpDesc* AddOpDesc(cpp::BlockDesc* block_desc,
+                              const std::string& type,
+                              const ArgNames& inputs,
+                              const ArgNames& outputs) {
+  auto* op_desc = block_desc->AddOp<cpp::OpDesc>();
+  op_desc->SetType(type);
+  for (auto& input : inputs) {
+    op_desc->SetInput(input.first, input.second);
+  }
+  for (auto& output : outputs) {
+    op_desc->SetOutput(output.first, output.second);
+  }
+  return op_desc;
+}
+
+static void AddScaleDesc(cpp::BlockDesc* block_desc,
+                         const std::string& input,
+                         const std::string& output,
+                         float scale,
+                         float bias) {
+  auto* op_desc =
+      AddOpDesc(block_desc, "scale", {{"X", {input}}}, {{"Out", {output}}});
+  op_desc->SetAttr<float>("scale", scale);
+  op_desc->SetAttr<float>("bias", bias);
+  op_desc->SetAttr<bool>("bias_after_scale", true);
+}
+
+static void AddWeight(Scope* scope, const std::string& name, float value) {
+  auto* tensor = scope->Var(name)->GetMutable<Tensor>();
+  tensor->Resize({2, 3});
+  auto* data = tensor->mutable_data<float>();
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    data[i] = value + i;
+  }
+  tensor->set_persistable(true);
+}
+
+// w -> scale -> w1 -> scale -> w2 is a constant subgraph, and the other ops
+// read the feed, or the state which is persistable but updated by assign:
+//
+// x = feed
+// y = elementwise_add(x, scale(scale(w)))
+// out = elementwise_add(y, scale(state))
+// state = assign(out)
+// fetch(out)
+class ConstantFoldingGraph {
+ public:
+  ConstantFoldingGraph() {
+    program_desc_ = std::make_shared<cpp::ProgramDesc>();
+    scope_ = std::make_shared<Scope>();
+    auto* block_desc = program_desc_->AddBlock<cpp::BlockDesc>();
+    block_desc->ClearOps();
+    block_desc->ClearVars();
+    for (auto name : {"feed",
+                      "fetch",
+                      "x",
+                      "w",
+                      "w1",
+                      "w2",
+                      "y",
+                      "state",
+                      "s1",
+                      "out"}) {
+      block_desc->AddVar<cpp::VarDesc>()->SetName(name);
+    }
+    AddWeight(scope_.get(), "w", 1.f);
+    AddWeight(scope_.get(), "state", 10.f);
+
+    AddOpDesc(block_desc, "feed", {{"X", {"feed"}}}, {{"Out", {"x"}}})
+        ->SetAttr<int>("col", 0);
+    AddScaleDesc(block_desc, "w", "w1", 2.f, 0.f);
+    AddScaleDesc(block_desc, "w1", "w2", 1.f, 1.f);
+    AddOpDesc(block_desc,
+              "elementwise_add",
+              {{"X", {"x"}}, {"Y", {"w2"}}},
+              {{"Out", {"y"}}})
+        ->SetAttr<int>("axis", -1);
+    AddScaleDesc(block_desc, "state", "s1", 3.f, 0.f);
+    AddOpDesc(block_desc,
+              "elementwise_add",
+              {{"X", {"y"}}, {"Y", {"s1"}}},
+              {{"Out", {"out"}}})
+        ->SetAttr<int>("axis", -1);
+    AddOpDesc(block_desc, "assign", {{"X", {"out"}}}, {{"Out", {"state"}}});
+    AddOpDesc(block_desc, "fetch", {{"X", {"out"}}}, {{"Out", {"fetch"}}})
+        ->SetAttr<int>("col", 0);
+
+    std::vector<Place> valid_places{
+        Place{TARGET(kX86), PRECISION(kFloat)},
+        Place{TARGET(kHost), PRECISION(kAny)},
+    };
+    program_.reset(new Program(program_desc_, scope_, valid_places));
+    graph_.reset(new SSAGraph());
+    graph_->Build(*program_, valid_places);
+  }
+
+  const std::unique_ptr<SSAGraph>& graph() { return graph_; }
+  Scope* exec_scope() { return program_->exec_scope(); }
+
+  int CountOps(const std::string& type) {
+    auto nodes = graph_->StmtTopologicalOrder();
+    return std::count_if(nodes.begin(), nodes.end(), [&](Node* node) {
+      return node->AsStmt().op_type() == type;
+    });
+  }
+
+  // The inputs of the ops of `type`
+  std::vector<std::string> OpInputs(const std::string& type) {
+    std::vector<std::string> names;
+    for (auto* node : graph_->StmtTopologicalOrder()) {
+      if (node->AsStmt().op_type() != type) continue;
+      for (auto& name : node->AsStmt().op_info()->input_vars()) {
+        names.push_back(name);
+      }
+    }
+    return names;
+  }
+
+ private:
+  std::shared_ptr<cpp::ProgramDesc> program_desc_;
+  std::shared_ptr<Scope> scope_;
+  std::unique_ptr<Program> program_;
+  std::unique_ptr<SSAGraph> graph_;
+};
+
+TEST(constant_folding_pass, fold_constant_subgraph) {
+  ConstantFoldingGraph test_graph;
+  ConstantFoldingPass pass;
+  pass.Apply(test_graph.graph());
+
+  // both scale of w are folded into w2, the scale of state is kept
+  EXPECT_EQ(test_graph.CountOps("scale"), 1);
+  EXPECT_EQ(test_graph.OpInputs("scale"), std::vector<std::string>{"state"});
+  EXPECT_EQ(test_graph.CountOps("elementwise_add"), 2);
+  EXPECT_EQ(test_graph.CountOps("assign"), 1);
+  const auto& w2 = test_graph.exec_scope()->FindVar("w2")->Get<Tensor>();
+  EXPECT_TRUE(w2.persistable());
+  ASSERT_EQ(w2.dims(), DDim({2, 3}));
+  for (int64_t i = 0; i < w2.numel(); ++i) {
+    EXPECT_EQ(w2.data<float>()[i], 2.f * (1.f + i) + 1.f);
+  }
+  auto* w2_node = test_graph.graph()->RetrieveArgument("w2");
+  ASSERT_NE(w2_node, nullptr);
+  EXPECT_TRUE(w2_node->AsArg().is_weight);
+  EXPECT_TRUE(w2_node->inlinks.empty());
+
+  // the vars depending on the feed or the state are not folded
+  for (auto name : {"y", "s1", "out"}) {
+    auto* var = test_graph.exec_scope()->FindVar(name);
+    ASSERT_NE(var, nullptr);
+    EXPECT_FALSE(var->Get<Tensor>().persistable());
+  }
+}
+
+TEST(constant_folding_pass, max_bytes) {
+  // the outputs of 24 bytes are larger than the limit
+  setenv(CONSTANT_FOLDING_MAX_BYTES, "16", 1);
+  ConstantFoldingGraph test_graph;
+  ConstantFoldingPass pass;
+  pass.Apply(test_graph.graph());
+  unsetenv(CONSTANT_FOLDING_MAX_BYTES);
+
+  EXPECT_EQ(test_graph.CountOps("scale"), 3);
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_OP(feed);
+USE_LITE_OP(fetch);
+USE_LITE_OP(scale);
+USE_LITE_OP(elementwise_add);
+USE_LITE_OP(assign);
+USE_LITE_KERNEL(scale, kX86, kFloat, kNCHW, def);
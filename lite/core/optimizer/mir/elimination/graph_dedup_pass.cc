@@ -0,0 +1,226 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/optimizer/mir/elimination/graph_dedup_pass.h"
+#include <algorithm>
+#include <set>
+#include <string>
+#include <vector>
+#include "lite/core/optimizer/mir/pattern_matcher.h"
+#include "lite/utils/env.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+// Ops whose outputs differ between two runs with the same inputs, or which
+// have side effects
+static const std::set<std::string> kUndedupableOps{"feed",
+                                                   "fetch",
+                                                   "while",
+                                                   "conditional_block",
+                                                   "write_to_array",
+                                                   "increment",
+                                                   "share_data",
+                                                   "uniform_random",
+                                                   "gaussian_random",
+                                                   "randint",
+                                                   "sampling_id",
+                                                   "print",
+                                                   "assert"};
+
+template <typename T>
+static bool VectorIdentical(std::vector<T> vec0, std::vector<T> vec1) {
+  if (vec0.size() != vec1.size()) {
+    return false;
+  }
+  std::sort(vec0.begin(), vec0.end());
+  std::sort(vec1.begin(), vec1.end());
+  return vec0 == vec1;
+}
+
+bool GraphDedupPass::NodeIdentical(const Node& node0, const Node& node1) {
+  CHECK(node0.IsStmt());
+  CHECK(node1.IsStmt());
+
+  auto* op_info0 = node0.stmt()->op_info();
+  auto* op_info1 = node1.stmt()->op_info();
+
+  // 1. op type
+  if (op_info0->Type() != op_info1->Type() ||
+      kUndedupableOps.count(op_info0->Type())) {
+    return false;
+  }
+  // 2. input
+  auto input_argname0 = op_info0->input_argnames();
+  auto input_argname1 = op_info1->input_argnames();
+  if (!VectorIdentical(input_argname0, input_argname1)) {
+    return false;
+  }
+  std::set<std::string> input_names;
+  for (auto& argname : input_argname0) {
+    auto input0 = op_info0->Input(argname);
+    if (input0 != op_info1->Input(argname)) {
+      return false;
+    }
+    input_names.insert(input0.begin(), input0.end());
+  }
+  // 3. output, the ops updating their inputs in place are not removed
+  auto output_argname0 = op_info0->output_argnames();
+  auto output_argname1 = op_info1->output_argnames();
+  if (!VectorIdentical(output_argname0, output_argname1)) {
+    return false;
+  }
+  for (auto& argname : output_argname0) {
+    auto output0 = op_info0->Output(argname);
+    auto output1 = op_info1->Output(argname);
+    if (output0.size() != output1.size()) {
+      return false;
+    }
+    for (auto& name : output1) {
+      if (input_names.count(name)) {
+        return false;
+      }
+    }
+  }
+  // 4. attribute
+  auto attr_type0 = op_info0->attr_types();
+  auto attr_type1 = op_info1->attr_types();
+  if (attr_type0 != attr_type1) {
+    return false;
+  }
+  for (auto pair : attr_type0) {
+    const std::string& attr_name = pair.first;
+    switch (pair.second /* attr_type */) {
+#define ATTR_COMPARE(attr_type, cpp_type)         \
+  case cpp::OpDesc::AttrType::attr_type:          \
+    if (op_info0->GetAttr<cpp_type>(attr_name) != \
+        op_info1->GetAttr<cpp_type>(attr_name))   \
+      return false;                               \
+    break
+
+      ATTR_COMPARE(INT, int32_t);
+      ATTR_COMPARE(FLOAT, float);
+      ATTR_COMPARE(STRING, std::string);
+      ATTR_COMPARE(INTS, std::vector<int32_t>);
+      ATTR_COMPARE(FLOATS, std::vector<float>);
+      ATTR_COMPARE(STRINGS, std::vector<std::string>);
+      ATTR_COMPARE(BOOLEAN, bool);
+      ATTR_COMPARE(BLOCK, int16_t);
+      ATTR_COMPARE(LONG, int64_t);
+      ATTR_COMPARE(LONGS, std::vector<int64_t>);
+#undef ATTR_COMPARE
+
+      default:
+        return false;
+        break;
+    }
+  }
+
+  VLOG(3) << "GraphDedup Remove [" << op_info1->Type() << "]";
+  return true;
+}
+
+// Whether an output of the op is read by a fetch op, whose target var is kept
+// by the name the users expect
+bool GraphDedupPass::IsFetched(const Node& node) {
+  CHECK(node.IsStmt());
+  for (auto* out_node : node.outlinks) {
+    for (auto* stmt_node : out_node->outlinks) {
+      if (stmt_node->IsStmt() && stmt_node->AsStmt().op_type() == "fetch") {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void GraphDedupPass::Dedup(SSAGraph* graph, Node* to_keep, Node* to_remove) {
+  CHECK(to_keep->IsStmt());
+  CHECK(to_remove->IsStmt());
+
+  std::set<const Node*> remove_set = {to_remove};
+  for (auto& argname : to_keep->stmt()->op_info()->output_argnames()) {
+    auto output0 = to_keep->stmt()->op_info()->Output(argname);
+    auto output1 = to_remove->stmt()->op_info()->Output(argname);
+    CHECK(output0.size() == output1.size());
+    for (size_t i = 0; i < output0.size(); ++i) {
+      auto& keep_name = output0[i];
+      auto& remove_name = output1[i];
+      auto* keep_node = graph->RetrieveArgument(keep_name);
+      auto* remove_node = graph->RetrieveArgument(remove_name);
+      remove_set.insert(remove_node);
+      VLOG(3) << "GraphDedup Remove [" << remove_name << "]";
+      for (auto* stmt_node : remove_node->outlinks) {
+        auto new_op_info = *stmt_node->stmt()->op_info();
+        new_op_info.UpdateAllInputs(remove_name, keep_name);
+        stmt_node->stmt()->ResetOp(new_op_info, graph->valid_places());
+        DirectedLink(keep_node, stmt_node);
+      }
+    }
+  }
+  GraphSafeRemoveNodes(graph, remove_set);
+}
+
+bool GraphDedupPass::FindAndDedup(SSAGraph* graph) {
+  // The arg nodes created by SSAGraph::Build have no unique ids, so they are
+  // visited in the node storage rather than in NodeTopologicalOrder
+  for (auto& node : graph->mutable_nodes()) {
+    if (!node.IsArg()) continue;
+
+    auto& arg_outlinks = node.outlinks;
+    for (auto it0 = arg_outlinks.begin(); it0 != arg_outlinks.end(); ++it0) {
+      auto it1 = it0;
+      for (++it1; it1 != arg_outlinks.end(); ++it1) {
+        if (!NodeIdentical(**it0, **it1)) continue;
+        bool fetched0 = IsFetched(**it0);
+        bool fetched1 = IsFetched(**it1);
+        if (fetched0 && fetched1) continue;
+        if (fetched1) {
+          Dedup(graph, *it1, *it0);
+        } else {
+          Dedup(graph, *it0, *it1);
+        }
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void GraphDedupPass::RemoveDuplicates(SSAGraph* graph) {
+  while (FindAndDedup(graph)) {
+    graph->CheckValid();
+  }
+}
+
+void GraphDedupPass::Apply(const std::unique_ptr<SSAGraph>& graph) {
+  // __xpu__graph_dedup_pass takes over if xpu is used
+  for (auto& place : graph->valid_places()) {
+    if (place.target == TARGET(kXPU)) return;
+  }
+  if (!GetBoolFromEnv(GRAPH_DEDUP_ENABLE)) {
+    VLOG(3) << "graph_dedup_pass is disabled, set " << GRAPH_DEDUP_ENABLE
+            << " to enable it.";
+    return;
+  }
+  RemoveDuplicates(graph.get());
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_MIR_PASS(graph_dedup_pass, paddle::lite::mir::GraphDedupPass)
+    .BindTargets({TARGET(kHost), TARGET(kX86), TARGET(kARM)});
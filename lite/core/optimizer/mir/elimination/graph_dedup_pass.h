@@ -0,0 +1,54 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include "lite/core/optimizer/mir/pass.h"
+#include "lite/core/optimizer/mir/pass_registry.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+// Remove the ops that compute the same outputs as another op, i.e. of the
+// same type, reading the same inputs, with the same attributes, and let the
+// consumers of the removed outputs read the kept ones instead.
+//
+// For example:
+//            x                          x
+//          /   \                        |
+//   OP: relu   OP: relu       ==>    OP: relu
+//        |        |                   |      |
+//      conv2d   pool2d             conv2d  pool2d
+//
+// The ops with side effects or random outputs are never removed, the ops whose
+// outputs are fetched are kept, and the pass is skipped for the programs with
+// sub-blocks, whose ops may read the removed outputs. It only runs if
+// GRAPH_DEDUP_ENABLE is set.
+class GraphDedupPass : public ProgramPass {
+ public:
+  void Apply(const std::unique_ptr<SSAGraph>& graph) override;
+
+ protected:
+  void RemoveDuplicates(SSAGraph* graph);
+  bool NodeIdentical(const Node& node0, const Node& node1);
+  bool IsFetched(const Node& node);
+  void Dedup(SSAGraph* graph, Node* to_keep, Node* to_remove);
+  bool FindAndDedup(SSAGraph* graph);
+};
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
@@ -0,0 +1,205 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/optimizer/mir/elimination/graph_dedup_pass.h"
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+#include "lite/api/paddle_use_ops.h"
+#include "lite/api/paddle_use_passes.h"
+#include "lite/core/optimizer/mir/pass_manager.h"
+#include "lite/core/optimizer/mir/ssa_graph.h"
+#include "lite/core/program.h"
+#include "lite/model_parser/cpp_desc.h"
+#include "lite/utils/env.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+static cpp::OpDesc* AddOpDesc(cpp::BlockDesc* block_desc,
+                              const std::string& type,
+                              const std::string& input,
+                              const std::string& output) {
+  auto* op_desc = block_desc->AddOp<cpp::OpDesc>();
+  op_desc->SetType(type);
+  op_desc->SetInput("X", {input});
+  op_desc->SetOutput("Out", {output});
+  if (type == "scale") {
+    op_desc->SetAttr<float>("scale", 2.f);
+    op_desc->SetAttr<float>("bias", 0.f);
+    op_desc->SetAttr<bool>("bias_after_scale", true);
+  }
+  return op_desc;
+}
+
+// Two identical relu read the fed x, relu_1 is fetched, and relu_0 is fetched
+// directly if `fetch_both`, or through a scale otherwise. The ops of the graph
+// are attached to the exec scope created in `scope`, and xpu is one of the
+// valid places if `with_xpu`.
+static std::unique_ptr<SSAGraph> BuildGraph(const std::shared_ptr<Scope>& scope,
+                                            bool fetch_both,
+                                            bool with_xpu = false) {
+  auto program_desc = std::make_shared<cpp::ProgramDesc>();
+  std::vector<Place> valid_places{{TARGET(kHost), PRECISION(kFloat)}};
+  if (with_xpu) {
+    valid_places.insert(valid_places.begin(),
+                        Place{TARGET(kXPU), PRECISION(kFloat)});
+  }
+  auto* block_desc = program_desc->AddBlock<cpp::BlockDesc>();
+  block_desc->ClearOps();
+  block_desc->ClearVars();
+  for (auto name : {"feed", "fetch", "x", "relu_0", "relu_1", "scale_out"}) {
+    block_desc->AddVar<cpp::VarDesc>()->SetName(name);
+  }
+  AddOpDesc(block_desc, "feed", "feed", "x")->SetAttr<int>("col", 0);
+  AddOpDesc(block_desc, "relu", "x", "relu_0");
+  AddOpDesc(block_desc, "relu", "x", "relu_1");
+  const std::string fetched0 = fetch_both ? "relu_0" : "scale_out";
+  if (!fetch_both) {
+    AddOpDesc(block_desc, "scale", "relu_0", "scale_out");
+  }
+  AddOpDesc(block_desc, "fetch", fetched0, "fetch")->SetAttr<int>("col", 0);
+  AddOpDesc(block_desc, "fetch", "relu_1", "fetch")->SetAttr<int>("col", 1);
+
+  Program program(program_desc, scope, valid_places);
+  std::unique_ptr<SSAGraph> graph(new SSAGraph());
+  graph->Build(program, valid_places);
+  graph->SetValidPlaces(valid_places);
+  return graph;
+}
+
+static std::vector<std::string> OpTypes(SSAGraph* graph) {
+  std::vector<std::string> types;
+  for (auto* node : graph->StmtTopologicalOrder()) {
+    types.push_back(node->AsStmt().op_type());
+  }
+  return types;
+}
+
+static std::vector<std::string> FetchedVars(SSAGraph* graph) {
+  std::vector<std::string> names;
+  for (auto* node : graph->StmtTopologicalOrder()) {
+    auto* op_info = node->AsStmt().op_info();
+    if (op_info->Type() != "fetch") continue;
+    size_t col = static_cast<size_t>(op_info->GetAttr<int>("col"));
+    names.resize(std::max(names.size(), col + 1));
+    names[col] = op_info->Input("X").front();
+  }
+  return names;
+}
+
+TEST(graph_dedup_pass, disabled_by_default) {
+  unsetenv(GRAPH_DEDUP_ENABLE);
+  auto scope = std::make_shared<Scope>();
+  auto graph = BuildGraph(scope, false);
+  GraphDedupPass pass;
+  pass.Apply(graph);
+  EXPECT_EQ(OpTypes(graph.get()).size(), 6u);
+}
+
+TEST(graph_dedup_pass, keep_fetched_outputs) {
+  setenv(GRAPH_DEDUP_ENABLE, "1", 1);
+  auto scope = std::make_shared<Scope>();
+  auto graph = BuildGraph(scope, false);
+  GraphDedupPass pass;
+  pass.Apply(graph);
+  unsetenv(GRAPH_DEDUP_ENABLE);
+
+  // the relu which isn't fetched is removed, and scale reads the other one
+  auto types = OpTypes(graph.get());
+  ASSERT_EQ(types.size(), 5u);
+  EXPECT_EQ(std::count(types.begin(), types.end(), "relu"), 1);
+  EXPECT_EQ(graph->RetrieveArgument("relu_0"), nullptr);
+  for (auto* node : graph->StmtTopologicalOrder()) {
+    auto* op_info = node->AsStmt().op_info();
+    if (op_info->Type() == "scale") {
+      EXPECT_EQ(op_info->Input("X").front(), "relu_1");
+    }
+  }
+  // the names of the fetched vars are unchanged
+  auto fetched = FetchedVars(graph.get());
+  ASSERT_EQ(fetched.size(), 2u);
+  EXPECT_EQ(fetched[0], "scale_out");
+  EXPECT_EQ(fetched[1], "relu_1");
+}
+
+TEST(graph_dedup_pass, skip_if_both_fetched) {
+  setenv(GRAPH_DEDUP_ENABLE, "1", 1);
+  auto scope = std::make_shared<Scope>();
+  auto graph = BuildGraph(scope, true);
+  GraphDedupPass pass;
+  pass.Apply(graph);
+  unsetenv(GRAPH_DEDUP_ENABLE);
+
+  auto types = OpTypes(graph.get());
+  EXPECT_EQ(std::count(types.begin(), types.end(), "relu"), 2);
+  auto fetched = FetchedVars(graph.get());
+  ASSERT_EQ(fetched.size(), 2u);
+  EXPECT_EQ(fetched[0], "relu_0");
+  EXPECT_EQ(fetched[1], "relu_1");
+}
+
+TEST(graph_dedup_pass, leave_xpu_graph_to_xpu_pass) {
+  setenv(GRAPH_DEDUP_ENABLE, "1", 1);
+  auto scope = std::make_shared<Scope>();
+  auto graph = BuildGraph(scope, false, true);
+  GraphDedupPass pass;
+  pass.Apply(graph);
+  unsetenv(GRAPH_DEDUP_ENABLE);
+  EXPECT_EQ(OpTypes(graph.get()).size(), 6u);
+}
+
+TEST(xpu_graph_dedup_pass, keep_fetched_outputs) {
+  unsetenv(GRAPH_DEDUP_ENABLE);
+  auto scope = std::make_shared<Scope>();
+  auto graph = BuildGraph(scope, false, true);
+  auto* pass =
+      PassManager::Global().LookUp<ProgramPass>("__xpu__graph_dedup_pass");
+  ASSERT_NE(pass, nullptr);
+  pass->Apply(graph);
+
+  // runs without GRAPH_DEDUP_ENABLE, and keeps the relu which is fetched
+  auto types = OpTypes(graph.get());
+  ASSERT_EQ(types.size(), 5u);
+  EXPECT_EQ(std::count(types.begin(), types.end(), "relu"), 1);
+  EXPECT_EQ(graph->RetrieveArgument("relu_0"), nullptr);
+  auto fetched = FetchedVars(graph.get());
+  ASSERT_EQ(fetched.size(), 2u);
+  EXPECT_EQ(fetched[0], "scale_out");
+  EXPECT_EQ(fetched[1], "relu_1");
+}
+
+TEST(xpu_graph_dedup_pass, skip_if_both_fetched) {
+  auto scope = std::make_shared<Scope>();
+  auto graph = BuildGraph(scope, true, true);
+  auto* pass =
+      PassManager::Global().LookUp<ProgramPass>("__xpu__graph_dedup_pass");
+  ASSERT_NE(pass, nullptr);
+  pass->Apply(graph);
+
+  auto types = OpTypes(graph.get());
+  EXPECT_EQ(std::count(types.begin(), types.end(), "relu"), 2);
+  auto fetched = FetchedVars(graph.get());
+  ASSERT_EQ(fetched.size(), 2u);
+  EXPECT_EQ(fetched[0], "relu_0");
+  EXPECT_EQ(fetched[1], "relu_1");
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
@@ -112,4 +112,5 @@ class XPUGnSilufusePass : public ProgramPass {
 
 REGISTER_MIR_PASS(__xpu__gn_silu_fuse_pass,
                   paddle::lite::mir::XPUGnSilufusePass)
-    .BindTargets({TARGET(kXPU)});
+    .BindTargets({TARGET(kXPU), TARGET(kX86)})
+    .BindKernel("__xpu__gn_silu");
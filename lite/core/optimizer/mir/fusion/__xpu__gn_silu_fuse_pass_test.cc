@@ -0,0 +1,181 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "lite/core/op_registry.h"
+#include "lite/core/optimizer/mir/pass_manager.h"
+#include "lite/core/optimizer/mir/pass_registry.h"
+#include "lite/core/optimizer/mir/ssa_graph.h"
+#include "lite/core/program.h"
+#include "lite/model_parser/cpp_desc.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+using ArgNames = std::map<std::string, std::vector<std::string>>;
+
+static cpp::OpDesc* AddOpDesc(cpp::BlockDesc* block_desc,
+                              const std::string& type,
+                              const ArgNames& inputs,
+                              const ArgNames& outputs) {
+  auto* op_desc = block_desc->AddOp<cpp::OpDesc>();
+  op_desc->SetType(type);
+  for (auto& input : inputs) {
+    op_desc->SetInput(input.first, input.second);
+  }
+  for (auto& output : outputs) {
+    op_desc->SetOutput(output.first, output.second);
+  }
+  return op_desc;
+}
+
+static void AddWeight(cpp::BlockDesc* block_desc,
+                      Scope* scope,
+                      const std::string& name) {
+  auto* var_desc = block_desc->AddVar<cpp::VarDesc>();
+  var_desc->SetName(name);
+  var_desc->SetType(VarDescAPI::Type::LOD_TENSOR);
+  var_desc->SetDataType(VarDescAPI::Type::FP32);
+  var_desc->SetPersistable(true);
+  auto* tensor = scope->Var(name)->GetMutable<Tensor>();
+  tensor->Resize({8});
+  auto* data = tensor->mutable_data<float>();
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    data[i] = 0.5f + i;
+  }
+  tensor->set_persistable(true);
+}
+
+// x = feed
+// gn_out, mean, variance = group_norm(x, scale, bias)
+// out = silu(gn_out), or relu(gn_out) if not `with_silu`
+// fetch(out)
+class GnSiluGraph {
+ public:
+  explicit GnSiluGraph(bool with_silu) {
+    program_desc_ = std::make_shared<cpp::ProgramDesc>();
+    scope_ = std::make_shared<Scope>();
+    auto* block_desc = program_desc_->AddBlock<cpp::BlockDesc>();
+    block_desc->ClearOps();
+    block_desc->ClearVars();
+    for (auto name : {"feed", "fetch", "x", "gn_out", "mean", "var", "out"}) {
+      block_desc->AddVar<cpp::VarDesc>()->SetName(name);
+    }
+    AddWeight(block_desc, scope_.get(), "scale");
+    AddWeight(block_desc, scope_.get(), "bias");
+
+    AddOpDesc(block_desc, "feed", {{"X", {"feed"}}}, {{"Out", {"x"}}})
+        ->SetAttr<int>("col", 0);
+    ArgNames gn_inputs{{"X", {"x"}}, {"Scale", {"scale"}}, {"Bias", {"bias"}}};
+    ArgNames gn_outputs{
+        {"Y", {"gn_out"}}, {"Mean", {"mean"}}, {"Variance", {"var"}}};
+    auto* gn = AddOpDesc(block_desc, "group_norm", gn_inputs, gn_outputs);
+    gn->SetAttr<float>("epsilon", 1e-5f);
+    gn->SetAttr<int>("groups", 4);
+    AddOpDesc(block_desc,
+              with_silu ? "silu" : "relu",
+              {{"X", {"gn_out"}}},
+              {{"Out", {"out"}}});
+    AddOpDesc(block_desc, "fetch", {{"X", {"out"}}}, {{"Out", {"fetch"}}})
+        ->SetAttr<int>("col", 0);
+
+    std::vector<Place> valid_places{
+        Place{TARGET(kX86), PRECISION(kFloat)},
+        Place{TARGET(kHost), PRECISION(kAny)},
+    };
+    program_.reset(new Program(program_desc_, scope_, valid_places));
+    graph_.reset(new SSAGraph());
+    graph_->Build(*program_, valid_places);
+    graph_->SetValidPlaces(valid_places);
+  }
+
+  const std::unique_ptr<SSAGraph>& graph() { return graph_; }
+
+  std::vector<std::string> OpTypes() {
+    std::vector<std::string> types;
+    for (auto* node : graph_->StmtTopologicalOrder()) {
+      types.push_back(node->AsStmt().op_type());
+    }
+    return types;
+  }
+
+  Node* FindOp(const std::string& type) {
+    for (auto* node : graph_->StmtTopologicalOrder()) {
+      if (node->AsStmt().op_type() == type) return node;
+    }
+    return nullptr;
+  }
+
+ private:
+  std::shared_ptr<cpp::ProgramDesc> program_desc_;
+  std::shared_ptr<Scope> scope_;
+  std::unique_ptr<Program> program_;
+  std::unique_ptr<SSAGraph> graph_;
+};
+
+static void ApplyPass(GnSiluGraph* test_graph) {
+  auto* pass =
+      PassManager::Global().LookUp<ProgramPass>("__xpu__gn_silu_fuse_pass");
+  ASSERT_NE(pass, nullptr);
+  pass->Apply(test_graph->graph());
+}
+
+TEST(xpu_gn_silu_fuse_pass, fuse_on_x86) {
+  GnSiluGraph test_graph(true);
+  ApplyPass(&test_graph);
+
+  const std::vector<std::string> expected_types{
+      "feed", "__xpu__gn_silu", "fetch"};
+  EXPECT_EQ(test_graph.OpTypes(), expected_types);
+  auto* node = test_graph.FindOp("__xpu__gn_silu");
+  ASSERT_NE(node, nullptr);
+  auto* op_info = node->AsStmt().op_info();
+  EXPECT_EQ(op_info->Input("Input"), std::vector<std::string>{"x"});
+  EXPECT_EQ(op_info->Input("GNScale"), std::vector<std::string>{"scale"});
+  EXPECT_EQ(op_info->Input("GNBias"), std::vector<std::string>{"bias"});
+  EXPECT_EQ(op_info->Output("Output"), std::vector<std::string>{"out"});
+  EXPECT_EQ(op_info->GetAttr<int>("groups"), 4);
+  EXPECT_NEAR(op_info->GetAttr<float>("epsilon"), 1e-5f, 1e-12f);
+  // the fused op picks the x86 kernel
+  auto& kernels = node->AsStmt().kernels();
+  ASSERT_FALSE(kernels.empty());
+  EXPECT_EQ(kernels.front()->target(), TARGET(kX86));
+}
+
+TEST(xpu_gn_silu_fuse_pass, skip_other_act) {
+  GnSiluGraph test_graph(false);
+  ApplyPass(&test_graph);
+
+  const std::vector<std::string> expected_types{
+      "feed", "group_norm", "relu", "fetch"};
+  EXPECT_EQ(test_graph.OpTypes(), expected_types);
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+USE_MIR_PASS(__xpu__gn_silu_fuse_pass);
+USE_LITE_OP(feed);
+USE_LITE_OP(fetch);
+USE_LITE_OP(group_norm);
+USE_LITE_OP(silu);
+USE_LITE_OP(relu);
+USE_LITE_OP(__xpu__gn_silu);
+USE_LITE_KERNEL(__xpu__gn_silu, kX86, kFloat, kNCHW, def);
@@ -18,6 +18,7 @@
 
 #include "lite/backends/xpu/math.h"
 #include "lite/core/context.h"
+#include "lite/core/optimizer/mir/pass_manager.h"
 #include "lite/core/optimizer/mir/pass_registry.h"
 #include "lite/core/optimizer/mir/type_precision_cast_pass.h"  // For UpdateInputs()
 #include "lite/core/optimizer/mir/xpu_pattern_matcher_high_api.h"
@@ -706,6 +707,9 @@ class XPUSingleEncoderFuser : public FuseBase {
     op_desc.SetAttr<int>("hidden_dim", hidden_dim);
     op_desc.SetAttr<std::string>("act_type", act_type_);
     op_desc.SetAttr<bool>("norm_before", norm_before_);
+    op_desc.SetAttr<float>(
+        "epsilon",
+        matched.at("qkv_ln_2")->stmt()->op_info()->GetAttr<float>("epsilon"));
     if (relative_emb_type_ == "__xpu__roformer_relative_embedding") {
       // q/k share the rotary embedding
       op_desc.SetInput("RoformerEmbedding",
@@ -1943,6 +1947,10 @@ class XPUMultiEncoderFuser {
       }
       op_desc.SetAttr<bool>("already_qkv_fusion", is_qkv_already_fusion_);
       op_desc.SetAttr<bool>("norm_before", norm_before_0);
+      if (first_encoder_op_info->HasAttr("epsilon")) {
+        op_desc.SetAttr<float>(
+            "epsilon", first_encoder_op_info->GetAttr<float>("epsilon"));
+      }
       op_desc.SetAttr<bool>("enable_int8", enable_int8);
       op_desc.SetAttr<bool>("enable_int16", enable_int16);
       if (enable_int8 || enable_int16) {
@@ -2312,20 +2320,6 @@ class XPUMultiEncoderFusePass : public ProgramPass {
  public:
   void Apply(const std::unique_ptr<SSAGraph>& graph) override {
     if (GetBoolFromEnv("XPU_ENABLE_XTCL")) return;
-    // TODO(miaotianxiang): backup graph, recover from failed match
-    std::vector<std::string> act_types{"gelu", "relu", "__xpu__quick_gelu"};
-    std::vector<std::string> input_poss{"X", "Y"};
-    std::vector<std::string> qkv_ln_2_out_poss{"X", "Y"};
-    std::vector<std::string> matmul_types{"matmul", "matmul_v2"};
-    std::vector<std::string> matmul2_types{"matmul", "matmul_v2"};
-    std::vector<std::string> mul_types{"mul", "matmul", "matmul_v2"};
-    std::vector<bool> with_q_scales{true, false};
-    std::vector<bool> norm_befores{true, false};
-    std::vector<bool> with_mask{true, false};
-    std::vector<std::string> relative_embedding_type{
-        "", "__xpu__roformer_relative_embedding"};
-    std::vector<bool> with_smooth_quant{true, false};
-
     std::string fc_precision;
     bool adaptive_seqlen = false;
 #ifdef LITE_WITH_XPU
@@ -2366,6 +2360,34 @@ class XPUMultiEncoderFusePass : public ProgramPass {
         lite::TargetWrapperXPU::xpu_runtime_ptr->multi_encoder_adaptive_seqlen;
     VLOG(3) << "adaptive_seqlen: " << adaptive_seqlen;
 #endif
+    Fuse(graph, fc_precision, adaptive_seqlen, true);
+  }
+
+ protected:
+  // Fuse the continuous encoders into __xpu__multi_encoder. If not
+  // `all_variants`, the roformer, smooth quant and pre-fused qkv variants are
+  // skipped.
+  void Fuse(const std::unique_ptr<SSAGraph>& graph,
+            const std::string& fc_precision,
+            bool adaptive_seqlen,
+            bool all_variants) {
+    // TODO(miaotianxiang): backup graph, recover from failed match
+    std::vector<std::string> act_types{"gelu", "relu", "__xpu__quick_gelu"};
+    std::vector<std::string> input_poss{"X", "Y"};
+    std::vector<std::string> qkv_ln_2_out_poss{"X", "Y"};
+    std::vector<std::string> matmul_types{"matmul", "matmul_v2"};
+    std::vector<std::string> matmul2_types{"matmul", "matmul_v2"};
+    std::vector<std::string> mul_types{"mul", "matmul", "matmul_v2"};
+    std::vector<bool> with_q_scales{true, false};
+    std::vector<bool> norm_befores{true, false};
+    std::vector<bool> with_mask{true, false};
+    std::vector<std::string> relative_embedding_type{
+        "", "__xpu__roformer_relative_embedding"};
+    std::vector<bool> with_smooth_quant{true, false};
+    if (!all_variants) {
+      relative_embedding_type = {""};
+      with_smooth_quant = {false};
+    }
 
     for (auto& act_type : act_types) {
       for (auto& input_pos : input_poss) {
@@ -2411,6 +2433,7 @@ class XPUMultiEncoderFusePass : public ProgramPass {
         }
       }
     }
+    if (!all_variants) return;
     for (auto& act_type : {"gelu", "__xpu__quick_gelu"}) {
       for (auto& input_pos : {"X"}) {
         for (auto& qkv_ln_2_out_pos : {"X"}) {
@@ -2444,6 +2467,35 @@ class XPUMultiEncoderFusePass : public ProgramPass {
   }
 };
 
+// The encoder fusion for x86, which runs before lite_fc_fuse_pass breaks the
+// mul + elementwise_add of the encoder pattern, so the identity dropouts are
+// removed here instead of by the later identity_dropout_eliminate_pass. The
+// fc weights are kept in fp32 ("int31"), and the qkv weights are fused and
+// transposed to [n, k] once here.
+class X86MultiEncoderFusePass : public XPUMultiEncoderFusePass {
+ public:
+  void Apply(const std::unique_ptr<SSAGraph>& graph) override {
+    // __xpu__multi_encoder_fuse_pass takes over if xpu is used
+    for (auto& place : graph->valid_places()) {
+      if (place.target == TARGET(kXPU)) return;
+    }
+    // The x86 kernel only runs the fp32 encoder.
+    for (auto* node : graph->StmtTopologicalOrder()) {
+      auto* op_info = node->stmt()->op_info();
+      if (fusion::is_int8_quantized_op(op_info) ||
+          fusion::is_int16_quantized_op(op_info)) {
+        return;
+      }
+    }
+    auto* dropout_eliminate_pass =
+        PassManager::Global().LookUp("identity_dropout_eliminate_pass");
+    if (dropout_eliminate_pass) {
+      dropout_eliminate_pass->Apply(graph);
+    }
+    Fuse(graph, "int31", false, false);
+  }
+};
+
 }  // namespace mir
 }  // namespace lite
 }  // namespace paddle
@@ -2452,3 +2504,8 @@ REGISTER_MIR_PASS(__xpu__multi_encoder_fuse_pass,
                   paddle::lite::mir::XPUMultiEncoderFusePass)
     .BindTargets({TARGET(kXPU)})
     .BindKernel("__xpu__multi_encoder");
+
+REGISTER_MIR_PASS(x86_multi_encoder_fuse_pass,
+                  paddle::lite::mir::X86MultiEncoderFusePass)
+    .BindTargets({TARGET(kX86)})
+    .BindKernel("__xpu__multi_encoder");
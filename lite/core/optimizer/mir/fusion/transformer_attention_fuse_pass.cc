@@ -26,10 +26,15 @@ namespace mir {
 void TransformerAttentionFusePass::Apply(
     const std::unique_ptr<SSAGraph>& graph) {
   bool has_int8 = false;
+  // x86 has both the fp32 and the int8 fused_attention kernels
+  bool has_x86 = false;
   for (auto& place : graph->valid_places()) {
     if (place.precision == PRECISION(kInt8)) {
       has_int8 = true;
     }
+    if (place.target == TARGET(kX86)) {
+      has_x86 = true;
+    }
   }
   std::vector<bool> reshape_has_xshapes = {false, true};
   std::vector<bool> transpose_has_xshapes = {false, true};
@@ -41,7 +46,7 @@ void TransformerAttentionFusePass::Apply(
         for (auto mul_type : mul_types) {
           fusion::TransformerAttentionFuser fuser(
               reshape_has_xshape, transpose_has_xshape, dropout_mask, mul_type);
-          if ((has_int8)) {
+          if (has_int8 || has_x86) {
             fuser(graph.get());
           }
         }
@@ -56,7 +61,7 @@ void TransformerAttentionFusePass::Apply(
 
 REGISTER_MIR_PASS(transformer_attention_fuse_pass,
                   paddle::lite::mir::TransformerAttentionFusePass)
-    .BindTargets({TARGET(kARM)})
+    .BindTargets({TARGET(kARM), TARGET(kX86)})
     .ExcludeTargets(
         {TARGET(kXPU), TARGET(kOpenCL), TARGET(kMetal), TARGET(kNNAdapter)})
     .BindKernel("fused_attention");
@@ -0,0 +1,507 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "lite/core/context.h"
+#include "lite/core/op_registry.h"
+#include "lite/core/optimizer/mir/pass_manager.h"
+#include "lite/core/optimizer/mir/pass_registry.h"
+#include "lite/core/optimizer/mir/ssa_graph.h"
+#include "lite/core/program.h"
+#include "lite/model_parser/cpp_desc.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+using ArgNames = std::map<std::string, std::vector<std::string>>;
+
+static const int kLayers = 2;
+static const int kBatch = 2;
+static const int kSeqLen = 5;
+static const int kHeads = 2;
+static const int kHeadDim = 8;
+static const int kHidden = kHeads * kHeadDim;
+static const int kFfnHidden = 4 * kHidden;
+static const float kEpsilon = 1e-5f;
+
+static cpp::OpDesc* AddOpDesc(cpp::BlockDesc* block_desc,
+                              const std::string& type,
+                              const ArgNames& inputs,
+                              const ArgNames& outputs) {
+  auto* op_desc = block_desc->AddOp<cpp::OpDesc>();
+  op_desc->SetType(type);
+  for (auto& input : inputs) {
+    op_desc->SetInput(input.first, input.second);
+  }
+  for (auto& output : outputs) {
+    op_desc->SetOutput(output.first, output.second);
+  }
+  return op_desc;
+}
+
+// The same `seed` gives the same values, so that two graphs hold the same
+// weights.
+static void FillValues(Tensor* tensor, float seed, float base, float range) {
+  auto* data = tensor->mutable_data<float>();
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    data[i] = base + range * std::sin(seed + 0.37f * i);
+  }
+}
+
+// x = layer input of [batch, seq_len, hidden], mask of [batch, 1, 1, seq_len]
+// q / k / v = transpose2(reshape2(elementwise_add(mul(x, w), b)))
+// scores = softmax(matmul(scale(q), k, transpose_Y) + mask)
+// attn = elementwise_add(mul(reshape2(transpose2(matmul(scores, v))), w), b)
+// ln2_out = layer_norm(x + dropout(attn)), the dropout is in the 1st layer
+// ffn = elementwise_add(mul(gelu(elementwise_add(mul(ln2_out, w3), b3)), w4),
+//                       b4)
+// layer output = layer_norm(ln2_out + ffn)
+class BertEncoderGraph {
+ public:
+  BertEncoderGraph() {
+    program_desc_ = std::make_shared<cpp::ProgramDesc>();
+    scope_ = std::make_shared<Scope>();
+    block_desc_ = program_desc_->AddBlock<cpp::BlockDesc>();
+    block_desc_->ClearOps();
+    block_desc_->ClearVars();
+
+    auto* x = AddVar("x", false);
+    x->Resize({kBatch, kSeqLen, kHidden});
+    FillValues(x, 0.5f, 0.f, 1.f);
+    auto* mask = AddVar("mask", false);
+    mask->Resize({kBatch, 1, 1, kSeqLen});
+    auto* mask_data = mask->mutable_data<float>();
+    // the last two tokens of the 2nd sequence are padding
+    for (int i = 0; i < kBatch * kSeqLen; ++i) {
+      mask_data[i] = i >= 2 * kSeqLen - 2 ? -10000.f : 0.f;
+    }
+
+    std::string input = "x";
+    for (int i = 0; i < kLayers; ++i) {
+      input = AddLayer("l" + std::to_string(i) + "_", input, i == 0);
+    }
+    output_ = input;
+
+    std::vector<Place> valid_places{
+        Place{TARGET(kX86), PRECISION(kFloat)},
+        Place{TARGET(kHost), PRECISION(kAny)},
+    };
+    program_.reset(new Program(program_desc_, scope_, valid_places));
+    graph_.reset(new SSAGraph());
+    graph_->Build(*program_, valid_places);
+    graph_->SetValidPlaces(valid_places);
+  }
+
+  const std::unique_ptr<SSAGraph>& graph() { return graph_; }
+  Scope* scope() { return scope_.get(); }
+  const std::string& output() const { return output_; }
+
+  std::vector<std::string> OpTypes() {
+    std::vector<std::string> types;
+    for (auto* node : graph_->StmtTopologicalOrder()) {
+      types.push_back(node->AsStmt().op_type());
+    }
+    return types;
+  }
+
+  const OpInfo* FindOp(const std::string& type) {
+    for (auto* node : graph_->StmtTopologicalOrder()) {
+      if (node->AsStmt().op_type() == type) return node->AsStmt().op_info();
+    }
+    return nullptr;
+  }
+
+  // Run the ops of the graph in the topological order, each with its fp32 x86
+  // kernel, or the host one if it has none.
+  void Run() {
+    for (auto* node : graph_->StmtTopologicalOrder()) {
+      auto& stmt = node->AsStmt();
+      ASSERT_FALSE(stmt.kernels().empty()) << stmt.op_type();
+      KernelBase* kernel = stmt.kernels().front().get();
+      for (auto& candidate : stmt.kernels()) {
+        if (candidate->target() == TARGET(kX86) &&
+            candidate->precision() == PRECISION(kFloat)) {
+          kernel = candidate.get();
+          break;
+        }
+      }
+      ASSERT_TRUE(stmt.op()->CheckShape()) << stmt.op_type();
+      ASSERT_TRUE(stmt.op()->InferShape()) << stmt.op_type();
+      std::unique_ptr<KernelContext> ctx(new KernelContext);
+      if (kernel->target() == TARGET(kX86)) {
+        ctx->As<X86Context>();
+      } else {
+        ctx->As<HostContext>();
+      }
+      kernel->SetContext(std::move(ctx));
+      kernel->Launch();
+    }
+  }
+
+ private:
+  Tensor* AddVar(const std::string& name, bool persistable) {
+    auto* var_desc = block_desc_->AddVar<cpp::VarDesc>();
+    var_desc->SetName(name);
+    var_desc->SetType(VarDescAPI::Type::LOD_TENSOR);
+    var_desc->SetDataType(VarDescAPI::Type::FP32);
+    var_desc->SetPersistable(persistable);
+    auto* tensor = scope_->Var(name)->GetMutable<Tensor>();
+    tensor->set_persistable(persistable);
+    return tensor;
+  }
+
+  void AddWeight(const std::string& name,
+                 const std::vector<int64_t>& dims,
+                 float base,
+                 float range) {
+    auto* tensor = AddVar(name, true);
+    tensor->Resize(dims);
+    FillValues(tensor, seed_++, base, range);
+  }
+
+  void AddVars(const std::string& prefix,
+               const std::vector<std::string>& names) {
+    for (auto& name : names) {
+      AddVar(prefix + name, false);
+    }
+  }
+
+  // out = elementwise_add(mul(x, prefix + "w"), prefix + "b")
+  void AddFc(const std::string& prefix,
+             const std::string& x,
+             int k,
+             int n,
+             const std::string& out) {
+    AddWeight(prefix + "w", {k, n}, 0.f, 0.3f / std::sqrt(k));
+    AddWeight(prefix + "b", {n}, 0.f, 0.1f);
+    AddVars(prefix, {"mul_out"});
+    auto* mul = AddOpDesc(block_desc_,
+                          "mul",
+                          {{"X", {x}}, {"Y", {prefix + "w"}}},
+                          {{"Out", {prefix + "mul_out"}}});
+    mul->SetAttr<int>("x_num_col_dims", 2);
+    mul->SetAttr<int>("y_num_col_dims", 1);
+    AddOpDesc(block_desc_,
+              "elementwise_add",
+              {{"X", {prefix + "mul_out"}}, {"Y", {prefix + "b"}}},
+              {{"Out", {out}}})
+        ->SetAttr<int>("axis", -1);
+  }
+
+  void AddReshape(const std::string& prefix,
+                  const std::string& x,
+                  const std::vector<int>& shape,
+                  const std::string& out) {
+    AddVars(prefix, {"xshape"});
+    AddOpDesc(block_desc_,
+              "reshape2",
+              {{"X", {x}}},
+              {{"Out", {out}}, {"XShape", {prefix + "xshape"}}})
+        ->SetAttr<std::vector<int>>("shape", shape);
+  }
+
+  void AddTranspose(const std::string& prefix,
+                    const std::string& x,
+                    const std::string& out) {
+    AddVars(prefix, {"xshape"});
+    AddOpDesc(block_desc_,
+              "transpose2",
+              {{"X", {x}}},
+              {{"Out", {out}}, {"XShape", {prefix + "xshape"}}})
+        ->SetAttr<std::vector<int>>("axis", {0, 2, 1, 3});
+  }
+
+  void AddLayerNorm(const std::string& prefix,
+                    const std::string& x,
+                    const std::string& out) {
+    AddWeight(prefix + "scale", {kHidden}, 1.f, 0.1f);
+    AddWeight(prefix + "bias", {kHidden}, 0.f, 0.1f);
+    AddVars(prefix, {"mean", "var"});
+    auto* ln = AddOpDesc(block_desc_,
+                         "layer_norm",
+                         {{"X", {x}},
+                          {"Scale", {prefix + "scale"}},
+                          {"Bias", {prefix + "bias"}}},
+                         {{"Y", {out}},
+                          {"Mean", {prefix + "mean"}},
+                          {"Variance", {prefix + "var"}}});
+    ln->SetAttr<int>("begin_norm_axis", 2);
+    ln->SetAttr<float>("epsilon", kEpsilon);
+  }
+
+  void AddElementwiseAdd(const std::string& x,
+                         const std::string& y,
+                         const std::string& out) {
+    AddOpDesc(block_desc_,
+              "elementwise_add",
+              {{"X", {x}}, {"Y", {y}}},
+              {{"Out", {out}}})
+        ->SetAttr<int>("axis", -1);
+  }
+
+  // Add the ops of an encoder layer on `input`, and return its output.
+  std::string AddLayer(const std::string& prefix,
+                       const std::string& input,
+                       bool with_dropout) {
+    const std::vector<int> head_shape{0, 0, kHeads, kHeadDim};
+    for (auto name : {"q", "k", "v"}) {
+      std::string p = prefix + name + "_";
+      AddVars(p, {"fc_out", "reshape_out", "transpose_out"});
+      AddFc(p, input, kHidden, kHidden, p + "fc_out");
+      AddReshape(p + "reshape_", p + "fc_out", head_shape, p + "reshape_out");
+      AddTranspose(p + "transpose_", p + "reshape_out", p + "transpose_out");
+    }
+    AddVars(prefix,
+            {"q_scale_out",
+             "qk_out",
+             "qk_mask_out",
+             "softmax_out",
+             "qkv_out",
+             "qkv_transpose_out",
+             "qkv_reshape_out",
+             "attn_out",
+             "add2_out",
+             "ln2_out",
+             "ffn0_out",
+             "gelu_out",
+             "ffn1_out",
+             "add5_out",
+             "ln5_out"});
+    auto* scale = AddOpDesc(block_desc_,
+                            "scale",
+                            {{"X", {prefix + "q_transpose_out"}}},
+                            {{"Out", {prefix + "q_scale_out"}}});
+    scale->SetAttr<float>("scale", 1.f / std::sqrt(kHeadDim));
+    scale->SetAttr<float>("bias", 0.f);
+    scale->SetAttr<bool>("bias_after_scale", true);
+    auto* qk = AddOpDesc(
+        block_desc_,
+        "matmul",
+        {{"X", {prefix + "q_scale_out"}}, {"Y", {prefix + "k_transpose_out"}}},
+        {{"Out", {prefix + "qk_out"}}});
+    qk->SetAttr<bool>("transpose_X", false);
+    qk->SetAttr<bool>("transpose_Y", true);
+    qk->SetAttr<float>("alpha", 1.f);
+    AddElementwiseAdd(prefix + "qk_out", "mask", prefix + "qk_mask_out");
+    AddOpDesc(block_desc_,
+              "softmax",
+              {{"X", {prefix + "qk_mask_out"}}},
+              {{"Out", {prefix + "softmax_out"}}})
+        ->SetAttr<int>("axis", -1);
+    auto* qkv = AddOpDesc(
+        block_desc_,
+        "matmul",
+        {{"X", {prefix + "softmax_out"}}, {"Y", {prefix + "v_transpose_out"}}},
+        {{"Out", {prefix + "qkv_out"}}});
+    qkv->SetAttr<bool>("transpose_X", false);
+    qkv->SetAttr<bool>("transpose_Y", false);
+    qkv->SetAttr<float>("alpha", 1.f);
+    AddTranspose(prefix + "qkv_transpose_",
+                 prefix + "qkv_out",
+                 prefix + "qkv_transpose_out");
+    AddReshape(prefix + "qkv_reshape_",
+               prefix + "qkv_transpose_out",
+               {0, 0, kHidden},
+               prefix + "qkv_reshape_out");
+    AddFc(prefix + "attn_",
+          prefix + "qkv_reshape_out",
+          kHidden,
+          kHidden,
+          prefix + "attn_out");
+    std::string attn_out = prefix + "attn_out";
+    if (with_dropout) {
+      AddVars(prefix, {"dropout_out", "dropout_mask"});
+      auto* dropout = AddOpDesc(block_desc_,
+                                "dropout",
+                                {{"X", {attn_out}}},
+                                {{"Out", {prefix + "dropout_out"}},
+                                 {"Mask", {prefix + "dropout_mask"}}});
+      dropout->SetAttr<float>("dropout_prob", 0.1f);
+      dropout->SetAttr<bool>("is_test", true);
+      dropout->SetAttr<bool>("fix_seed", false);
+      dropout->SetAttr<int>("seed", 0);
+      dropout->SetAttr<std::string>("dropout_implementation",
+                                    "upscale_in_train");
+      attn_out = prefix + "dropout_out";
+    }
+    AddElementwiseAdd(input, attn_out, prefix + "add2_out");
+    AddLayerNorm(prefix + "ln2_", prefix + "add2_out", prefix + "ln2_out");
+    AddFc(prefix + "ffn0_",
+          prefix + "ln2_out",
+          kHidden,
+          kFfnHidden,
+          prefix + "ffn0_out");
+    AddOpDesc(block_desc_,
+              "gelu",
+              {{"X", {prefix + "ffn0_out"}}},
+              {{"Out", {prefix + "gelu_out"}}})
+        ->SetAttr<bool>("approximate", false);
+    AddFc(prefix + "ffn1_",
+          prefix + "gelu_out",
+          kFfnHidden,
+          kHidden,
+          prefix + "ffn1_out");
+    AddElementwiseAdd(
+        prefix + "ln2_out", prefix + "ffn1_out", prefix + "add5_out");
+    AddLayerNorm(prefix + "ln5_", prefix + "add5_out", prefix + "ln5_out");
+    return prefix + "ln5_out";
+  }
+
+  std::shared_ptr<cpp::ProgramDesc> program_desc_;
+  std::shared_ptr<Scope> scope_;
+  cpp::BlockDesc* block_desc_{nullptr};
+  std::unique_ptr<Program> program_;
+  std::unique_ptr<SSAGraph> graph_;
+  std::string output_;
+  float seed_{1.f};
+};
+
+static void ApplyPass(BertEncoderGraph* test_graph) {
+  auto* pass =
+      PassManager::Global().LookUp<ProgramPass>("x86_multi_encoder_fuse_pass");
+  ASSERT_NE(pass, nullptr);
+  pass->Apply(test_graph->graph());
+}
+
+TEST(x86_multi_encoder_fuse_pass, fuse_encoder_layers) {
+  BertEncoderGraph test_graph;
+  ApplyPass(&test_graph);
+
+  // the layers and the identity dropout go into one op
+  EXPECT_EQ(test_graph.OpTypes(),
+            std::vector<std::string>{"__xpu__multi_encoder"});
+  auto* op_info = test_graph.FindOp("__xpu__multi_encoder");
+  ASSERT_NE(op_info, nullptr);
+  EXPECT_EQ(op_info->Input("Input"), std::vector<std::string>{"x"});
+  EXPECT_EQ(op_info->Input("Mask"), std::vector<std::string>{"mask"});
+  EXPECT_EQ(op_info->Output("Output"),
+            std::vector<std::string>{test_graph.output()});
+  EXPECT_EQ(op_info->GetAttr<int>("n_layers"), kLayers);
+  EXPECT_EQ(op_info->GetAttr<int>("head_num"), kHeads);
+  EXPECT_EQ(op_info->GetAttr<int>("size_per_head"), kHeadDim);
+  EXPECT_EQ(op_info->GetAttr<int>("hidden_dim"), kHidden);
+  EXPECT_EQ(op_info->GetAttr<int>("ffn_hidden_dim_scale"), 4);
+  EXPECT_EQ(op_info->GetAttr<std::string>("act_type"), "gelu");
+  EXPECT_EQ(op_info->GetAttr<std::string>("precision"), "int31");
+  EXPECT_FALSE(op_info->GetAttr<bool>("norm_before"));
+  EXPECT_FLOAT_EQ(op_info->GetAttr<float>("epsilon"), kEpsilon);
+  EXPECT_EQ(op_info->Input("FCWeight").size(), 6u * kLayers);
+  EXPECT_EQ(op_info->Input("LNScale").size(), 2u * kLayers);
+}
+
+// The fc weights of [k, n] are transposed to [n, k], the q / k / v weights
+// and biases of a layer are fused into the q ones.
+TEST(x86_multi_encoder_fuse_pass, weight_transform) {
+  BertEncoderGraph fused_graph;
+  BertEncoderGraph ref_graph;
+  ApplyPass(&fused_graph);
+  auto* op_info = fused_graph.FindOp("__xpu__multi_encoder");
+  ASSERT_NE(op_info, nullptr);
+  auto* scope = fused_graph.scope();
+  auto* ref_scope = ref_graph.scope();
+
+  auto fc_weights = op_info->Input("FCWeight");
+  auto fc_biases = op_info->Input("FCBias");
+  ASSERT_EQ(fc_weights.size(), 6u * kLayers);
+  ASSERT_EQ(fc_biases.size(), 6u * kLayers);
+  for (int layer = 0; layer < kLayers; ++layer) {
+    std::string prefix = "l" + std::to_string(layer) + "_";
+    EXPECT_EQ(fc_weights[layer * 6], prefix + "q_w");
+    const auto& qkv_w = scope->FindVar(prefix + "q_w")->Get<Tensor>();
+    const auto& qkv_b = scope->FindVar(prefix + "q_b")->Get<Tensor>();
+    ASSERT_EQ(qkv_w.dims(), DDim({3 * kHidden, kHidden}));
+    ASSERT_EQ(qkv_b.dims(), DDim({3 * kHidden}));
+    int row = 0;
+    for (auto name : {"q_", "k_", "v_"}) {
+      const auto& w = ref_scope->FindVar(prefix + name + "w")->Get<Tensor>();
+      const auto& b = ref_scope->FindVar(prefix + name + "b")->Get<Tensor>();
+      for (int n = 0; n < kHidden; ++n, ++row) {
+        for (int k = 0; k < kHidden; ++k) {
+          EXPECT_EQ(qkv_w.data<float>()[row * kHidden + k],
+                    w.data<float>()[k * kHidden + n]);
+        }
+        EXPECT_EQ(qkv_b.data<float>()[row], b.data<float>()[n]);
+      }
+    }
+    for (auto name : {"attn_", "ffn0_", "ffn1_"}) {
+      const auto& w = ref_scope->FindVar(prefix + name + "w")->Get<Tensor>();
+      const auto& w_t = scope->FindVar(prefix + name + "w")->Get<Tensor>();
+      const int64_t k = w.dims()[0];
+      const int64_t n = w.dims()[1];
+      ASSERT_EQ(w_t.dims(), DDim({n, k}));
+      for (int64_t i = 0; i < k; ++i) {
+        for (int64_t j = 0; j < n; ++j) {
+          EXPECT_EQ(w_t.data<float>()[j * k + i], w.data<float>()[i * n + j]);
+        }
+      }
+    }
+  }
+}
+
+// The fused encoder gives the outputs of the unfused ops.
+TEST(x86_multi_encoder_fuse_pass, compare_with_unfused) {
+  BertEncoderGraph fused_graph;
+  BertEncoderGraph ref_graph;
+  ApplyPass(&fused_graph);
+  ASSERT_EQ(fused_graph.OpTypes().size(), 1u);
+  ref_graph.Run();
+  fused_graph.Run();
+
+  const auto& out =
+      fused_graph.scope()->FindVar(fused_graph.output())->Get<Tensor>();
+  const auto& ref_out =
+      ref_graph.scope()->FindVar(ref_graph.output())->Get<Tensor>();
+  ASSERT_EQ(out.dims(), DDim({kBatch, kSeqLen, kHidden}));
+  ASSERT_EQ(ref_out.dims(), out.dims());
+  for (int64_t i = 0; i < out.numel(); ++i) {
+    EXPECT_NEAR(out.data<float>()[i], ref_out.data<float>()[i], 1e-4f) << i;
+  }
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+USE_MIR_PASS(x86_multi_encoder_fuse_pass);
+USE_MIR_PASS(identity_dropout_eliminate_pass);
+USE_LITE_OP(mul);
+USE_LITE_OP(elementwise_add);
+USE_LITE_OP(reshape2);
+USE_LITE_OP(transpose2);
+USE_LITE_OP(scale);
+USE_LITE_OP(matmul);
+USE_LITE_OP(softmax);
+USE_LITE_OP(dropout);
+USE_LITE_OP(layer_norm);
+USE_LITE_OP(gelu);
+USE_LITE_OP(subgraph);
+USE_LITE_OP(__xpu__multi_encoder);
+USE_LITE_KERNEL(mul, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(elementwise_add, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(reshape2, kHost, kAny, kAny, def);
+USE_LITE_KERNEL(transpose2, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(scale, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(matmul, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(softmax, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(dropout, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(layer_norm, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(gelu, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(__xpu__multi_encoder, kX86, kFloat, kNCHW, def);
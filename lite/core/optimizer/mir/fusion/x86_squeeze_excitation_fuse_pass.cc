@@ -0,0 +1,340 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "lite/core/optimizer/mir/pass_registry.h"
+#include "lite/core/optimizer/mir/pattern_matcher_high_api.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+namespace fusion {
+
+// out[w, h] = in[h, w]
+static void TransposeFilter(const float* in, float* out, int h, int w) {
+  for (int i = 0; i < h; ++i) {
+    for (int j = 0; j < w; ++j) {
+      out[j * h + i] = in[i * w + j];
+    }
+  }
+}
+
+/* Squeeze and Excitation Block Fusion for x86, e.g. MobileNetV3 and */
+/* EfficientNet, matched before conv2d and act are fused:            */
+/*   input -> pool2d(avg, 1x1 out) -> conv2d(1x1) -> act ->           */
+/*   conv2d(1x1) -> sigmoid/hard_sigmoid -> elementwise_mul(input, .) */
+class X86SqueezeExcitationFuser : public FuseBase {
+ public:
+  X86SqueezeExcitationFuser(const std::string& excitation_act_type1,
+                            const std::string& excitation_act_type2,
+                            bool with_bias) {
+    excitation_act_type1_ = excitation_act_type1;
+    excitation_act_type2_ = excitation_act_type2;
+    with_bias_ = with_bias;
+  }
+
+  void BuildPattern() override {
+    auto* input = VarNode("input")
+                      ->assert_is_op_input("pool2d", "X")
+                      ->assert_is_op_input("elementwise_mul", "X")
+                      ->AsInput();
+    auto pool2d_teller = [](const Node* x) -> bool {
+      if (x && x->IsStmt()) {
+        auto* op_info = x->stmt()->op_info();
+        if (op_info->HasAttr("adaptive") &&
+            op_info->GetAttr<bool>("adaptive")) {
+          if (op_info->GetAttr<std::vector<int>>("ksize")[0] != 1 ||
+              op_info->GetAttr<std::vector<int>>("ksize")[1] != 1) {
+            return false;
+          }
+        } else if (op_info->GetAttr<bool>("global_pooling") == false) {
+          return false;
+        }
+      }
+      return true;
+    };
+    auto* pool = OpNode("pool", "pool2d")
+                     ->assert_node_satisfied(pool2d_teller)
+                     ->assert_op_attr<std::string>("pooling_type", "avg")
+                     ->AsIntermediate();
+    auto* pool_out = VarNode("pool_out")
+                         ->assert_is_op_output("pool2d", "Out")
+                         ->assert_is_op_input("conv2d", "Input")
+                         ->AsIntermediate();
+    // 1x1 conv2d on the pooled [n, c, 1, 1] is an fc, the first one
+    // reduces the channels and the second one restores them
+    auto conv_teller = [](bool reduce) {
+      return [=](const Node* x) -> bool {
+        if (!x || !x->IsStmt()) return true;
+        auto* op_info = x->stmt()->op_info();
+        auto* scope = x->stmt()->op()->scope();
+        auto* filter = scope->FindVar(op_info->Input("Filter").front());
+        if (!filter) return false;
+        auto dims = filter->Get<lite::Tensor>().dims();
+        if (dims.size() != 4 || dims[2] != 1 || dims[3] != 1) return false;
+        if (op_info->HasAttr("groups") && op_info->GetAttr<int>("groups") != 1)
+          return false;
+        if (op_info->HasAttr("paddings")) {
+          for (auto pad : op_info->GetAttr<std::vector<int>>("paddings")) {
+            if (pad != 0) return false;
+          }
+        }
+        int64_t in_c = reduce ? dims[1] : dims[0];
+        int64_t mid_c = reduce ? dims[0] : dims[1];
+        return mid_c > 0 && in_c % mid_c == 0;
+      };
+    };
+    auto* conv_1 = OpNode("conv_1", "conv2d")
+                       ->assert_node_satisfied(conv_teller(true))
+                       ->AsIntermediate();
+    auto* conv_1_w = VarNode("conv_1_w")
+                         ->assert_is_op_input("conv2d", "Filter")
+                         ->AsIntermediate();
+    auto* conv_1_out = VarNode("conv_1_out")
+                           ->assert_is_op_output("conv2d", "Output")
+                           ->assert_is_op_input(excitation_act_type1_, "X")
+                           ->AsIntermediate();
+    // the kernel computes relu6 and hard_swish with the default constants
+    auto act_1_teller = [](const Node* x) -> bool {
+      if (x && x->IsStmt()) {
+        auto* op_info = x->stmt()->op_info();
+        auto attr_is = [&](const std::string& name, float value) {
+          return !op_info->HasAttr(name) ||
+                 std::fabs(op_info->GetAttr<float>(name) - value) <= 1e-6f;
+        };
+        if (op_info->Type() == "relu6") {
+          return attr_is("threshold", 6.f);
+        } else if (op_info->Type() == "hard_swish") {
+          return attr_is("threshold", 6.f) && attr_is("scale", 6.f) &&
+                 attr_is("offset", 3.f);
+        }
+      }
+      return true;
+    };
+    auto* act_1 = OpNode("act_1", excitation_act_type1_)
+                      ->assert_node_satisfied(act_1_teller)
+                      ->AsIntermediate();
+    auto* act_1_out = VarNode("act_1_out")
+                          ->assert_is_op_output(excitation_act_type1_, "Out")
+                          ->assert_is_op_input("conv2d", "Input")
+                          ->AsIntermediate();
+    auto* conv_2 = OpNode("conv_2", "conv2d")
+                       ->assert_node_satisfied(conv_teller(false))
+                       ->AsIntermediate();
+    auto* conv_2_w = VarNode("conv_2_w")
+                         ->assert_is_op_input("conv2d", "Filter")
+                         ->AsIntermediate();
+    auto* conv_2_out = VarNode("conv_2_out")
+                           ->assert_is_op_output("conv2d", "Output")
+                           ->assert_is_op_input(excitation_act_type2_, "X")
+                           ->AsIntermediate();
+    auto act_2_teller = [](const Node* x) -> bool {
+      if (x && x->IsStmt()) {
+        auto* op_info = x->stmt()->op_info();
+        if (op_info->Type() == "hard_sigmoid" && op_info->HasAttr("offset") &&
+            std::fabs(op_info->GetAttr<float>("offset") - 0.5f) > 1e-6f) {
+          return false;
+        }
+      }
+      return true;
+    };
+    auto* act_2 = OpNode("act_2", excitation_act_type2_)
+                      ->assert_node_satisfied(act_2_teller)
+                      ->AsIntermediate();
+    auto* act_2_out = VarNode("act_2_out")
+                          ->assert_is_op_output(excitation_act_type2_, "Out")
+                          ->assert_is_op_input("elementwise_mul", "Y")
+                          ->AsIntermediate();
+    // the [n, c, 1, 1] excitation is broadcast over the spatial dims of the
+    // [n, c, h, w] input, which holds for the axis -1 or 0 only
+    auto ew_mul_teller = [](const Node* x) -> bool {
+      if (x && x->IsStmt()) {
+        auto* op_info = x->stmt()->op_info();
+        if (op_info->HasAttr("axis")) {
+          int axis = op_info->GetAttr<int>("axis");
+          return axis == -1 || axis == 0;
+        }
+      }
+      return true;
+    };
+    auto* ew_mul = OpNode("ew_mul", "elementwise_mul")
+                       ->assert_node_satisfied(ew_mul_teller)
+                       ->AsIntermediate();
+    auto* ew_mul_out = VarNode("ew_mul_out")
+                           ->assert_is_op_output("elementwise_mul", "Out")
+                           ->AsOutput();
+
+    *input >> *pool >> *pool_out >> *conv_1 >> *conv_1_out >> *act_1 >>
+        *act_1_out >> *conv_2 >> *conv_2_out >> *act_2 >> *act_2_out >>
+        *ew_mul;
+    *input >> *ew_mul;
+    *ew_mul >> *ew_mul_out;
+    *conv_1_w >> *conv_1;
+    *conv_2_w >> *conv_2;
+    if (with_bias_) {
+      auto* conv_1_bias = VarNode("conv_1_bias")
+                              ->assert_is_op_input("conv2d", "Bias")
+                              ->AsIntermediate();
+      auto* conv_2_bias = VarNode("conv_2_bias")
+                              ->assert_is_op_input("conv2d", "Bias")
+                              ->AsIntermediate();
+      *conv_1_bias >> *conv_1;
+      *conv_2_bias >> *conv_2;
+    }
+  }
+
+  void InsertNewNode(SSAGraph* graph, const key2nodes_t& matched) override {
+    auto pool_op = matched.at("pool")->stmt()->op();
+    auto* scope = pool_op->scope();
+    auto* w1_t = scope->FindMutableTensor(matched.at("conv_1_w")->arg()->name);
+    auto* w2_t = scope->FindMutableTensor(matched.at("conv_2_w")->arg()->name);
+    const int mid_c = w1_t->dims()[0];
+    const int c = w1_t->dims()[1];
+    CHECK_EQ(w2_t->dims()[0], c);
+    CHECK_EQ(w2_t->dims()[1], mid_c);
+
+    // [mid_c, c] and [c, mid_c] are stored transposed, back to back
+    std::string filter_name = "se_" + matched.at("conv_1_w")->arg()->name;
+    auto* filter_node = graph->NewArgumentNode(filter_name);
+    filter_node->arg()->is_weight = true;
+    filter_node->arg()->type = LiteType::GetTensorTy(
+        TARGET(kHost), PRECISION(kFloat), DATALAYOUT(kNCHW));
+    auto* filter_t = scope->MutableParent()->NewTensor(filter_name);
+    filter_t->set_precision(paddle::lite_api::PrecisionType::kFloat);
+    filter_t->set_persistable(true);
+    filter_t->Resize({2 * c * mid_c});
+    float* filter_data = filter_t->mutable_data<float>();
+    TransposeFilter(w1_t->data<float>(), filter_data, mid_c, c);
+    TransposeFilter(w2_t->data<float>(), filter_data + c * mid_c, c, mid_c);
+
+    cpp::OpDesc op_desc;
+    op_desc.SetType("__xpu__squeeze_excitation_block");
+    op_desc.SetInput("Input", {matched.at("input")->arg()->name});
+    op_desc.SetInput("Filter", {filter_name});
+    op_desc.SetOutput("Output", {matched.at("ew_mul_out")->arg()->name});
+    Node* bias_node = nullptr;
+    if (with_bias_) {
+      auto* b1_t =
+          scope->FindMutableTensor(matched.at("conv_1_bias")->arg()->name);
+      auto* b2_t =
+          scope->FindMutableTensor(matched.at("conv_2_bias")->arg()->name);
+      CHECK_EQ(b1_t->numel(), mid_c);
+      CHECK_EQ(b2_t->numel(), c);
+      std::string bias_name = filter_name + "_bias";
+      bias_node = graph->NewArgumentNode(bias_name);
+      bias_node->arg()->is_weight = true;
+      bias_node->arg()->type = LiteType::GetTensorTy(
+          TARGET(kHost), PRECISION(kFloat), DATALAYOUT(kNCHW));
+      auto* bias_t = scope->MutableParent()->NewTensor(bias_name);
+      bias_t->set_precision(paddle::lite_api::PrecisionType::kFloat);
+      bias_t->set_persistable(true);
+      bias_t->Resize({mid_c + c});
+      float* bias_data = bias_t->mutable_data<float>();
+      memcpy(bias_data, b1_t->data<float>(), mid_c * sizeof(float));
+      memcpy(bias_data + mid_c, b2_t->data<float>(), c * sizeof(float));
+      op_desc.SetInput("Bias", {bias_name});
+    }
+
+    std::map<std::string, int> act_map{{"relu", 1},
+                                       {"sigmoid", 2},
+                                       {"hard_swish", 14},
+                                       {"hard_sigmoid", 15},
+                                       {"swish", 16},
+                                       {"silu", 16},
+                                       {"relu6", 17}};
+    auto act_param = [&](const std::string& key) {
+      auto* op_info = matched.at(key)->stmt()->op_info();
+      if (op_info->Type() == "swish") {
+        return op_info->HasAttr("beta") ? op_info->GetAttr<float>("beta")
+                                        : 1.f;
+      } else if (op_info->Type() == "silu") {
+        return 1.f;
+      } else if (op_info->Type() == "hard_sigmoid") {
+        return op_info->HasAttr("slope") ? op_info->GetAttr<float>("slope")
+                                         : 0.2f;
+      }
+      return 0.f;
+    };
+    op_desc.SetAttr<std::vector<int>>("filter_dims", {c / mid_c, c});
+    op_desc.SetAttr<std::vector<int>>(
+        "act_type",
+        {act_map.at(excitation_act_type1_),
+         act_map.at(excitation_act_type2_),
+         0});
+    op_desc.SetAttr<std::vector<float>>(
+        "act_param", {act_param("act_1"), act_param("act_2"), 0.f});
+    op_desc.SetAttr<bool>("has_bias", with_bias_);
+    op_desc.SetAttr<bool>("has_branch", false);
+    // unused on x86, required by the op
+    op_desc.SetAttr<std::vector<int>>("op_type", std::vector<int>{4});
+    op_desc.SetAttr<std::vector<int>>("place_x", std::vector<int>{0});
+    op_desc.SetAttr<std::vector<int>>("place_y", std::vector<int>{9});
+    op_desc.SetAttr<std::vector<int>>("place_z", std::vector<int>{10});
+    op_desc.SetAttr<std::vector<int>>("block_lod", std::vector<int>{1});
+
+    auto se_op = LiteOpRegistry::Global().Create(op_desc.Type());
+    se_op->Attach(op_desc, scope);
+    auto* new_op_node =
+        graph->GraphCreateInstructNode(se_op, pool_op->valid_places());
+    IR_NODE_LINK_TO(matched.at("input"), new_op_node);
+    IR_NODE_LINK_TO(filter_node, new_op_node);
+    if (bias_node) {
+      IR_NODE_LINK_TO(bias_node, new_op_node);
+    }
+    IR_NODE_LINK_TO(new_op_node, matched.at("ew_mul_out"));
+  }
+
+ private:
+  std::string excitation_act_type1_;
+  std::string excitation_act_type2_;
+  bool with_bias_;
+};
+
+}  // namespace fusion
+
+class X86SqueezeExcitationFusePass : public ProgramPass {
+ public:
+  void Apply(const std::unique_ptr<SSAGraph>& graph) override {
+    // __xpu__squeeze_excitation_fuse_pass takes over if xpu is used
+    for (const auto& place : graph->valid_places()) {
+      if (place.target == TARGET(kXPU) ||
+          place.precision == PrecisionType::kInt8) {
+        return;
+      }
+    }
+    for (auto with_bias : {true, false}) {
+      for (auto act_type1 : {"relu", "relu6", "swish", "silu", "hard_swish"}) {
+        for (auto act_type2 : {"sigmoid", "hard_sigmoid"}) {
+          fusion::X86SqueezeExcitationFuser fuser(
+              act_type1, act_type2, with_bias);
+          fuser(graph.get());
+        }
+      }
+    }
+  }
+};
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_MIR_PASS(x86_squeeze_excitation_fuse_pass,
+                  paddle::lite::mir::X86SqueezeExcitationFusePass)
+    .BindTargets({TARGET(kX86)})
+    .BindKernel("__xpu__squeeze_excitation_block");
@@ -0,0 +1,276 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "lite/core/op_registry.h"
+#include "lite/core/optimizer/mir/pass_manager.h"
+#include "lite/core/optimizer/mir/pass_registry.h"
+#include "lite/core/optimizer/mir/ssa_graph.h"
+#include "lite/core/program.h"
+#include "lite/model_parser/cpp_desc.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+using ArgNames = std::map<std::string, std::vector<std::string>>;
+
+static const int kChannels = 8;
+static const int kMidChannels = 2;
+
+static cpp::OpDesc* AddOpDesc(cpp::BlockDesc* block_desc,
+                              const std::string& type,
+                              const ArgNames& inputs,
+                              const ArgNames& outputs) {
+  auto* op_desc = block_desc->AddOp<cpp::OpDesc>();
+  op_desc->SetType(type);
+  for (auto& input : inputs) {
+    op_desc->SetInput(input.first, input.second);
+  }
+  for (auto& output : outputs) {
+    op_desc->SetOutput(output.first, output.second);
+  }
+  return op_desc;
+}
+
+static void AddWeight(cpp::BlockDesc* block_desc,
+                      Scope* scope,
+                      const std::string& name,
+                      const std::vector<int64_t>& dims,
+                      float offset) {
+  auto* var_desc = block_desc->AddVar<cpp::VarDesc>();
+  var_desc->SetName(name);
+  var_desc->SetType(VarDescAPI::Type::LOD_TENSOR);
+  var_desc->SetDataType(VarDescAPI::Type::FP32);
+  var_desc->SetPersistable(true);
+  auto* tensor = scope->Var(name)->GetMutable<Tensor>();
+  tensor->Resize(dims);
+  auto* data = tensor->mutable_data<float>();
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    data[i] = offset + i;
+  }
+  tensor->set_persistable(true);
+}
+
+static void AddConv2dDesc(cpp::BlockDesc* block_desc,
+                          const std::string& input,
+                          const std::string& filter,
+                          const std::string& bias,
+                          const std::string& output) {
+  ArgNames inputs{{"Input", {input}}, {"Filter", {filter}}};
+  if (!bias.empty()) inputs["Bias"] = {bias};
+  auto* conv = AddOpDesc(block_desc, "conv2d", inputs, {{"Output", {output}}});
+  conv->SetAttr<std::vector<int>>("strides", {1, 1});
+  conv->SetAttr<std::vector<int>>("paddings", {0, 0});
+  conv->SetAttr<std::vector<int>>("dilations", {1, 1});
+  conv->SetAttr<int>("groups", 1);
+}
+
+// x = feed
+// pool_out = pool2d(x), global avg
+// act1_out = act1(conv2d(pool_out, w1, b1)), w1 is [mid_c, c, 1, 1]
+// act2_out = act2(conv2d(act1_out, w2, b2)), w2 is [c, mid_c, 1, 1]
+// mul_out = elementwise_mul(x, act2_out)
+// fetch(mul_out)
+class SqueezeExcitationGraph {
+ public:
+  SqueezeExcitationGraph(const std::string& act1,
+                         const std::string& act2,
+                         bool with_bias,
+                         int mul_axis) {
+    program_desc_ = std::make_shared<cpp::ProgramDesc>();
+    scope_ = std::make_shared<Scope>();
+    auto* block_desc = program_desc_->AddBlock<cpp::BlockDesc>();
+    block_desc->ClearOps();
+    block_desc->ClearVars();
+    for (auto name : {"feed",
+                      "fetch",
+                      "x",
+                      "pool_out",
+                      "conv1_out",
+                      "act1_out",
+                      "conv2_out",
+                      "act2_out",
+                      "mul_out"}) {
+      block_desc->AddVar<cpp::VarDesc>()->SetName(name);
+    }
+    AddWeight(
+        block_desc, scope_.get(), "w1", {kMidChannels, kChannels, 1, 1}, 0.f);
+    AddWeight(
+        block_desc, scope_.get(), "w2", {kChannels, kMidChannels, 1, 1}, 100.f);
+    if (with_bias) {
+      AddWeight(block_desc, scope_.get(), "b1", {kMidChannels}, 200.f);
+      AddWeight(block_desc, scope_.get(), "b2", {kChannels}, 300.f);
+    }
+
+    AddOpDesc(block_desc, "feed", {{"X", {"feed"}}}, {{"Out", {"x"}}})
+        ->SetAttr<int>("col", 0);
+    auto* pool = AddOpDesc(
+        block_desc, "pool2d", {{"X", {"x"}}}, {{"Out", {"pool_out"}}});
+    pool->SetAttr<std::string>("pooling_type", "avg");
+    pool->SetAttr<std::vector<int>>("ksize", {1, 1});
+    pool->SetAttr<std::vector<int>>("strides", {1, 1});
+    pool->SetAttr<std::vector<int>>("paddings", {0, 0});
+    pool->SetAttr<bool>("global_pooling", true);
+    AddConv2dDesc(
+        block_desc, "pool_out", "w1", with_bias ? "b1" : "", "conv1_out");
+    auto* act1_desc = AddOpDesc(
+        block_desc, act1, {{"X", {"conv1_out"}}}, {{"Out", {"act1_out"}}});
+    if (act1 == "relu6") {
+      act1_desc->SetAttr<float>("threshold", 6.f);
+    }
+    AddConv2dDesc(
+        block_desc, "act1_out", "w2", with_bias ? "b2" : "", "conv2_out");
+    auto* act2_desc = AddOpDesc(
+        block_desc, act2, {{"X", {"conv2_out"}}}, {{"Out", {"act2_out"}}});
+    if (act2 == "hard_sigmoid") {
+      act2_desc->SetAttr<float>("slope", 0.25f);
+      act2_desc->SetAttr<float>("offset", 0.5f);
+    }
+    AddOpDesc(block_desc,
+              "elementwise_mul",
+              {{"X", {"x"}}, {"Y", {"act2_out"}}},
+              {{"Out", {"mul_out"}}})
+        ->SetAttr<int>("axis", mul_axis);
+    AddOpDesc(block_desc, "fetch", {{"X", {"mul_out"}}}, {{"Out", {"fetch"}}})
+        ->SetAttr<int>("col", 0);
+
+    std::vector<Place> valid_places{
+        Place{TARGET(kX86), PRECISION(kFloat)},
+        Place{TARGET(kHost), PRECISION(kAny)},
+    };
+    program_.reset(new Program(program_desc_, scope_, valid_places));
+    graph_.reset(new SSAGraph());
+    graph_->Build(*program_, valid_places);
+    graph_->SetValidPlaces(valid_places);
+  }
+
+  const std::unique_ptr<SSAGraph>& graph() { return graph_; }
+  Scope* scope() { return scope_.get(); }
+
+  std::vector<std::string> OpTypes() {
+    std::vector<std::string> types;
+    for (auto* node : graph_->StmtTopologicalOrder()) {
+      types.push_back(node->AsStmt().op_type());
+    }
+    return types;
+  }
+
+  const OpInfo* FindOp(const std::string& type) {
+    for (auto* node : graph_->StmtTopologicalOrder()) {
+      if (node->AsStmt().op_type() == type) return node->AsStmt().op_info();
+    }
+    return nullptr;
+  }
+
+ private:
+  std::shared_ptr<cpp::ProgramDesc> program_desc_;
+  std::shared_ptr<Scope> scope_;
+  std::unique_ptr<Program> program_;
+  std::unique_ptr<SSAGraph> graph_;
+};
+
+static void ApplyPass(SqueezeExcitationGraph* test_graph) {
+  auto* pass = PassManager::Global().LookUp<ProgramPass>(
+      "x86_squeeze_excitation_fuse_pass");
+  ASSERT_NE(pass, nullptr);
+  pass->Apply(test_graph->graph());
+}
+
+TEST(x86_squeeze_excitation_fuse_pass, fuse_with_bias) {
+  SqueezeExcitationGraph test_graph("relu", "sigmoid", true, -1);
+  ApplyPass(&test_graph);
+
+  const std::vector<std::string> expected_types{
+      "feed", "__xpu__squeeze_excitation_block", "fetch"};
+  EXPECT_EQ(test_graph.OpTypes(), expected_types);
+  auto* op_info = test_graph.FindOp("__xpu__squeeze_excitation_block");
+  ASSERT_NE(op_info, nullptr);
+  EXPECT_EQ(op_info->Input("Input"), std::vector<std::string>{"x"});
+  EXPECT_EQ(op_info->Output("Output"), std::vector<std::string>{"mul_out"});
+  EXPECT_EQ(op_info->GetAttr<std::vector<int>>("filter_dims"),
+            (std::vector<int>{kChannels / kMidChannels, kChannels}));
+  EXPECT_EQ(op_info->GetAttr<std::vector<int>>("act_type"),
+            (std::vector<int>{1, 2, 0}));
+  EXPECT_TRUE(op_info->GetAttr<bool>("has_bias"));
+  EXPECT_FALSE(op_info->GetAttr<bool>("has_branch"));
+
+  // the filter holds w1 as [c, mid_c] and w2 as [mid_c, c]
+  auto* filter = test_graph.scope()->FindTensor(op_info->Input("Filter")[0]);
+  ASSERT_NE(filter, nullptr);
+  ASSERT_EQ(filter->numel(), 2 * kChannels * kMidChannels);
+  const float* filter_data = filter->data<float>();
+  for (int i = 0; i < kMidChannels; ++i) {
+    for (int j = 0; j < kChannels; ++j) {
+      EXPECT_EQ(filter_data[j * kMidChannels + i], i * kChannels + j);
+      EXPECT_EQ(filter_data[kChannels * kMidChannels + i * kChannels + j],
+                100.f + j * kMidChannels + i);
+    }
+  }
+  // b1 followed by b2
+  auto* bias = test_graph.scope()->FindTensor(op_info->Input("Bias")[0]);
+  ASSERT_NE(bias, nullptr);
+  ASSERT_EQ(bias->numel(), kMidChannels + kChannels);
+  for (int i = 0; i < kMidChannels; ++i) {
+    EXPECT_EQ(bias->data<float>()[i], 200.f + i);
+  }
+  for (int i = 0; i < kChannels; ++i) {
+    EXPECT_EQ(bias->data<float>()[kMidChannels + i], 300.f + i);
+  }
+}
+
+TEST(x86_squeeze_excitation_fuse_pass, fuse_without_bias) {
+  SqueezeExcitationGraph test_graph("relu6", "hard_sigmoid", false, 0);
+  ApplyPass(&test_graph);
+
+  auto* op_info = test_graph.FindOp("__xpu__squeeze_excitation_block");
+  ASSERT_NE(op_info, nullptr);
+  EXPECT_EQ(test_graph.OpTypes().size(), 3u);
+  EXPECT_FALSE(op_info->GetAttr<bool>("has_bias"));
+  EXPECT_FALSE(op_info->HasInput("Bias"));
+  EXPECT_EQ(op_info->GetAttr<std::vector<int>>("act_type"),
+            (std::vector<int>{17, 15, 0}));
+  EXPECT_EQ(op_info->GetAttr<std::vector<float>>("act_param"),
+            (std::vector<float>{0.f, 0.25f, 0.f}));
+}
+
+TEST(x86_squeeze_excitation_fuse_pass, skip_mul_on_channel_axis) {
+  // with the axis 1 the excitation isn't broadcast over the spatial dims
+  SqueezeExcitationGraph test_graph("relu", "sigmoid", true, 1);
+  ApplyPass(&test_graph);
+
+  EXPECT_EQ(test_graph.FindOp("__xpu__squeeze_excitation_block"), nullptr);
+  EXPECT_EQ(test_graph.OpTypes().size(), 8u);
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+USE_MIR_PASS(x86_squeeze_excitation_fuse_pass);
+USE_LITE_OP(feed);
+USE_LITE_OP(fetch);
+USE_LITE_OP(pool2d);
+USE_LITE_OP(conv2d);
+USE_LITE_OP(relu);
+USE_LITE_OP(relu6);
+USE_LITE_OP(sigmoid);
+USE_LITE_OP(hard_sigmoid);
+USE_LITE_OP(elementwise_mul);
+USE_LITE_OP(__xpu__squeeze_excitation_block);
+USE_LITE_KERNEL(__xpu__squeeze_excitation_block, kX86, kFloat, kNCHW, def);
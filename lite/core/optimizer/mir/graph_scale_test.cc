@@ -0,0 +1,280 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gflags/gflags.h>
+#include <gtest/gtest.h>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include "lite/core/op_registry.h"
+#include "lite/core/optimizer/mir/pass_manager.h"
+#include "lite/core/optimizer/mir/pass_registry.h"
+#include "lite/core/optimizer/mir/pattern_matcher.h"
+#include "lite/core/optimizer/mir/ssa_graph.h"
+#include "lite/core/optimizer/mir/static_kernel_pick_pass.h"
+#include "lite/core/optimizer/mir/type_target_cast_pass.h"
+#include "lite/core/program.h"
+#include "lite/model_parser/cpp_desc.h"
+#include "lite/utils/timer.h"
+
+DEFINE_int32(graph_ops, 50000, "number of ops of the synthetic graph");
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+// An op which only carries its OpInfo, enough for the graph passes.
+class FakeOp : public OpLite {
+ public:
+  explicit FakeOp(const std::string& type) : OpLite(type) {}
+  std::string DebugString() const override { return "fake"; }
+  void AttachKernel(KernelBase* kernel) override {}
+
+ protected:
+  bool AttachImpl(const cpp::OpDesc& opdesc, lite::Scope* scope) override {
+    return true;
+  }
+};
+
+// A chain of fake_mul -> fake_add pairs, like the fc of a deep network.
+void BuildChain(SSAGraph* graph, Scope* scope, int num_ops) {
+  Node* var = graph->NewArgumentNode("x");
+  for (int i = 0; i < num_ops; i++) {
+    const std::string type = i % 2 == 0 ? "fake_mul" : "fake_add";
+    cpp::OpDesc desc;
+    desc.SetType(type);
+    desc.SetInput("X", {var->arg()->name});
+    const std::string out_name = "out_" + std::to_string(i);
+    desc.SetOutput("Out", {out_name});
+    std::shared_ptr<OpLite> op(new FakeOp(type));
+    op->Attach(desc, scope);
+    Node* op_node = graph->NewInstructNode();
+    op_node->AsStmt(type, {}, op);
+    Node* out = graph->NewArgumentNode(out_name);
+    DirectedLink(var, op_node);
+    DirectedLink(op_node, out);
+    var = out;
+  }
+}
+
+TEST(SSAGraph, scale) {
+  const int num_ops = FLAGS_graph_ops;
+  Scope scope;
+  SSAGraph graph;
+  Timer timer;
+
+  timer.Start();
+  BuildChain(&graph, &scope, num_ops);
+  LOG(INFO) << "build " << num_ops << " ops: " << timer.Stop() << " ms";
+
+  timer.Start();
+  auto order = graph.StmtTopologicalOrder();
+  LOG(INFO) << "topological order: " << timer.Stop() << " ms";
+  ASSERT_EQ(order.size(), static_cast<size_t>(num_ops));
+  for (size_t i = 1; i < order.size(); i++) {
+    ASSERT_LT(order[i - 1]->get_id(), order[i]->get_id());
+  }
+  timer.Start();
+  ASSERT_EQ(graph.StmtTopologicalOrder(), order);
+  LOG(INFO) << "cached topological order: " << timer.Stop() << " ms";
+  ASSERT_EQ(graph.StmtNodesOfType("fake_add").size(),
+            static_cast<size_t>(num_ops / 2));
+
+  // Fuse every fake_mul -> fake_add by removing the fake_add.
+  PatternMatcher matcher;
+  auto* pattern = matcher.mutable_pattern();
+  auto* mul = pattern->NewNode("mul")->assert_is_op("fake_mul");
+  auto* mul_out = pattern->NewNode("mul_out")
+                      ->assert_is_op_output("fake_mul", "Out")
+                      ->assert_is_op_input("fake_add", "X")
+                      ->AsIntermediate();
+  auto* add = pattern->NewNode("add")->assert_is_op("fake_add");
+  add->AsIntermediate();
+  auto* add_out = pattern->NewNode("add_out")->assert_is_op_output("fake_add");
+  *mul >> *mul_out >> *add >> *add_out;
+  int num_fused = 0;
+  timer.Start();
+  matcher(&graph,
+          [&](const PatternMatcher::subgraph_t& subgraph, SSAGraph* g) {
+            Node* mul_node = subgraph.at(mul);
+            Node* out_node = subgraph.at(add_out);
+            GraphSafeRemoveNodes(g, {subgraph.at(mul_out), subgraph.at(add)});
+            DirectedLink(mul_node, out_node);
+            num_fused++;
+          });
+  LOG(INFO) << "match and fuse: " << timer.Stop() << " ms";
+  ASSERT_EQ(num_fused, num_ops / 2);
+
+  timer.Start();
+  order = graph.StmtTopologicalOrder();
+  LOG(INFO) << "topological order after fusion: " << timer.Stop() << " ms";
+  ASSERT_EQ(order.size(), static_cast<size_t>(num_ops / 2));
+  ASSERT_TRUE(graph.StmtNodesOfType("fake_add").empty());
+  graph.CheckValid();
+}
+
+static void AddVarDesc(cpp::BlockDesc* block_desc,
+                       const std::string& name,
+                       bool persistable) {
+  auto* var_desc = block_desc->AddVar<cpp::VarDesc>();
+  var_desc->SetName(name);
+  var_desc->SetType(VarDescAPI::Type::LOD_TENSOR);
+  var_desc->SetDataType(VarDescAPI::VarDataType::FP32);
+  var_desc->SetPersistable(persistable);
+}
+
+static cpp::OpDesc* AddOpDesc(cpp::BlockDesc* block_desc,
+                              const std::string& type,
+                              const std::string& x,
+                              const std::string& y,
+                              const std::string& out) {
+  auto* op_desc = block_desc->AddOp<cpp::OpDesc>();
+  op_desc->SetType(type);
+  op_desc->SetInput("X", {x});
+  if (!y.empty()) op_desc->SetInput("Y", {y});
+  op_desc->SetOutput("Out", {out});
+  return op_desc;
+}
+
+// A chain of mul -> elementwise_add -> relu, the fc layers of a deep network
+// before lite_fc_fuse_pass, with num_ops / 3 layers of [8, 8] weights.
+static void BuildFcChain(cpp::ProgramDesc* program_desc,
+                         Scope* scope,
+                         int num_ops) {
+  auto* block_desc = program_desc->AddBlock<cpp::BlockDesc>();
+  block_desc->ClearOps();
+  block_desc->ClearVars();
+  const int64_t dim = 8;
+  std::string x = "x";
+  AddVarDesc(block_desc, x, false);
+  for (int i = 0; i < num_ops / 3; i++) {
+    const std::string id = std::to_string(i);
+    const std::string w = "w_" + id, b = "b_" + id;
+    AddVarDesc(block_desc, w, true);
+    AddVarDesc(block_desc, b, true);
+    auto* w_tensor = scope->Var(w)->GetMutable<Tensor>();
+    w_tensor->Resize({dim, dim});
+    w_tensor->mutable_data<float>();
+    auto* b_tensor = scope->Var(b)->GetMutable<Tensor>();
+    b_tensor->Resize({dim});
+    b_tensor->mutable_data<float>();
+    for (auto name : {"mul_out_", "add_out_", "relu_out_"}) {
+      AddVarDesc(block_desc, name + id, false);
+    }
+    auto* mul = AddOpDesc(block_desc, "mul", x, w, "mul_out_" + id);
+    mul->SetAttr<int>("x_num_col_dims", 1);
+    mul->SetAttr<int>("y_num_col_dims", 1);
+    AddOpDesc(
+        block_desc, "elementwise_add", "mul_out_" + id, b, "add_out_" + id)
+        ->SetAttr<int>("axis", 1);
+    AddOpDesc(block_desc, "relu", "add_out_" + id, "", "relu_out_" + id);
+    x = "relu_out_" + id;
+  }
+}
+
+// Run the passes of the optimizer which apply to the fc chain on x86, and
+// report the time of every pass.
+TEST(SSAGraph, scale_passes) {
+  const int num_ops = FLAGS_graph_ops;
+  const int num_layers = num_ops / 3;
+  std::vector<Place> valid_places{
+      Place{TARGET(kX86), PRECISION(kFloat), DATALAYOUT(kNCHW)},
+      Place{TARGET(kHost), PRECISION(kAny), DATALAYOUT(kAny)},
+  };
+  auto program_desc = std::make_shared<cpp::ProgramDesc>();
+  auto scope = std::make_shared<Scope>();
+  Timer timer;
+
+  timer.Start();
+  BuildFcChain(program_desc.get(), scope.get(), num_ops);
+  LOG(INFO) << "build " << num_layers * 3 << " op descs: " << timer.Stop()
+            << " ms";
+  timer.Start();
+  Program program(program_desc, scope, valid_places);
+  LOG(INFO) << "create the program: " << timer.Stop() << " ms";
+  timer.Start();
+  std::unique_ptr<SSAGraph> graph(new SSAGraph());
+  graph->Build(program, valid_places);
+  graph->SetValidPlaces(valid_places);
+  LOG(INFO) << "build the graph: " << timer.Stop() << " ms";
+
+  // The passes set up as in Optimizer::Run.
+  auto& pass_manager = PassManager::Global();
+  auto* pick_pass =
+      pass_manager.LookUp<StaticKernelPickPass>("static_kernel_pick_pass");
+  ASSERT_NE(pick_pass, nullptr);
+  pick_pass->mutable_kernel_pick_factors()->ConsiderTarget();
+  pick_pass->mutable_kernel_pick_factors()->ConsiderPrecision();
+  auto* target_pass =
+      pass_manager.LookUp<TypeTargetTransformPass>("type_target_cast_pass");
+  ASSERT_NE(target_pass, nullptr);
+  target_pass->SetValidPlaces(valid_places);
+
+  const std::vector<std::string> passes{"lite_fc_fuse_pass",
+                                        "static_kernel_pick_pass",
+                                        "variable_place_inference_pass",
+                                        "type_precision_cast_pass",
+                                        "variable_place_inference_pass",
+                                        "type_target_cast_pass",
+                                        "variable_place_inference_pass",
+                                        "io_copy_kernel_pick_pass",
+                                        "type_layout_cast_pass",
+                                        "variable_place_inference_pass",
+                                        "runtime_context_assign_pass"};
+  std::vector<std::pair<std::string, float>> pass_times;
+  for (auto& name : passes) {
+    auto* pass = pass_manager.LookUp<ProgramPass>(name);
+    ASSERT_NE(pass, nullptr) << name;
+    timer.Start();
+    pass->Apply(graph);
+    pass_times.emplace_back(name, timer.Stop());
+  }
+  float total = 0.f;
+  for (auto& pass_time : pass_times) {
+    LOG(INFO) << pass_time.first << ": " << pass_time.second << " ms";
+    total += pass_time.second;
+  }
+  LOG(INFO) << "all the passes: " << total << " ms";
+
+  // Every layer becomes an fc on x86 and no cast is inserted.
+  auto order = graph->StmtTopologicalOrder();
+  ASSERT_EQ(order.size(), static_cast<size_t>(num_layers));
+  for (auto* node : order) {
+    auto& stmt = node->AsStmt();
+    ASSERT_EQ(stmt.op_type(), "fc");
+    ASSERT_EQ(stmt.kernels().size(), 1u);
+    ASSERT_EQ(stmt.picked_kernel().target(), TARGET(kX86));
+  }
+  graph->CheckValid();
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_OP(mul);
+USE_LITE_OP(elementwise_add);
+USE_LITE_OP(relu);
+USE_LITE_OP(fc);
+USE_LITE_KERNEL(fc, kX86, kFloat, kNCHW, def);
+USE_MIR_PASS(lite_fc_fuse_pass);
+USE_MIR_PASS(static_kernel_pick_pass);
+USE_MIR_PASS(variable_place_inference_pass);
+USE_MIR_PASS(type_precision_cast_pass);
+USE_MIR_PASS(type_target_cast_pass);
+USE_MIR_PASS(io_copy_kernel_pick_pass);
+USE_MIR_PASS(type_layout_cast_pass);
+USE_MIR_PASS(runtime_context_assign_pass);
@@ -0,0 +1,129 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/optimizer/mir/kv_cache_append_fuse_pass.h"
+#include <list>
+#include <string>
+#include <vector>
+#include "lite/core/optimizer/mir/pass_registry.h"
+#include "lite/core/optimizer/mir/pattern_matcher.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+namespace {
+
+Node* FindArgNode(const std::list<Node*>& links, const std::string& name) {
+  for (auto* link : links) {
+    if (link->IsArg() && link->arg()->name == name) return link;
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+void KVCacheAppendFusePass::Apply(const std::unique_ptr<SSAGraph>& graph) {
+  // Only the loop body carries a cache across the iterations.
+  if (graph->blockIdx() == kRootBlockIdx) return;
+  // Collect the concats first, the assigns are removed along the way.
+  std::vector<Node*> concats;
+  for (auto* node : graph->StmtTopologicalOrder()) {
+    if (node->IsStmt() && node->AsStmt().op_type() == "concat") {
+      concats.push_back(node);
+    }
+  }
+  int num_fused = 0;
+  for (auto* concat : concats) {
+    auto* concat_info = concat->stmt()->op_info();
+    if (concat_info->HasInput("AxisTensor") &&
+        !concat_info->Input("AxisTensor").empty()) {
+      continue;
+    }
+    if (concat_info->HasAttr("enable_int8") &&
+        concat_info->GetAttr<bool>("enable_int8")) {
+      continue;
+    }
+    auto inputs = concat_info->Input("X");
+    if (inputs.size() != 2 || inputs[0] == inputs[1]) continue;
+    const std::string cache_name = inputs[0];
+    const std::string concat_out_name = concat_info->Output("Out").front();
+    Node* cache = FindArgNode(concat->inlinks, cache_name);
+    Node* y = FindArgNode(concat->inlinks, inputs[1]);
+    Node* concat_out = FindArgNode(concat->outlinks, concat_out_name);
+    if (!cache || !y || !concat_out) continue;
+    // The old cache must not be read by any other op, as it's updated in
+    // place.
+    if (cache->arg()->is_weight || cache->arg()->is_persist ||
+        cache->outlinks.size() != 1 || concat_out->arg()->is_persist) {
+      continue;
+    }
+
+    // Find the assign writing the result back to the cache.
+    Node* assign = nullptr;
+    for (auto* consumer : concat_out->outlinks) {
+      if (consumer->IsStmt() && consumer->AsStmt().op_type() == "assign" &&
+          consumer->stmt()->op_info()->Output("Out").front() == cache_name) {
+        assign = consumer;
+        break;
+      }
+    }
+    if (!assign) continue;
+    Node* cache_out = FindArgNode(assign->outlinks, cache_name);
+    if (!cache_out) continue;
+
+    auto* scope = concat->stmt()->op()->scope();
+    cpp::OpDesc op_desc;
+    op_desc.SetType("kv_cache_append");
+    op_desc.SetInput("X", {cache_name});
+    op_desc.SetInput("Y", {inputs[1]});
+    op_desc.SetOutput("Out", {cache_name});
+    op_desc.SetAttr<int>("axis",
+                         concat_info->HasAttr("axis")
+                             ? concat_info->GetAttr<int>("axis")
+                             : 0);
+    auto append_op = LiteOpRegistry::Global().Create("kv_cache_append");
+    append_op->Attach(op_desc, scope);
+    auto* append =
+        graph->GraphCreateInstructNode(append_op, graph->valid_places());
+
+    // The other consumers of the concatenation read the updated cache.
+    std::vector<Node*> consumers;
+    for (auto* consumer : concat_out->outlinks) {
+      if (consumer != assign) consumers.push_back(consumer);
+    }
+    for (auto* consumer : consumers) {
+      auto consumer_desc = *consumer->stmt()->op_info();
+      consumer_desc.UpdateAllInputs(concat_out_name, cache_name);
+      consumer->AsStmt().ResetOp(consumer_desc, graph->valid_places());
+      DirectedLink(cache_out, consumer);
+    }
+    GraphSafeRemoveNodes(graph.get(), {concat, concat_out, assign});
+    DirectedLink(cache, append);
+    DirectedLink(y, append);
+    DirectedLink(append, cache_out);
+    num_fused++;
+  }
+  VLOG(3) << "kv_cache_append fused " << num_fused << " concat+assign in block "
+          << graph->blockIdx();
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_MIR_PASS(kv_cache_append_fuse_pass,
+                  paddle::lite::mir::KVCacheAppendFusePass)
+    .BindTargets({TARGET(kX86), TARGET(kARM), TARGET(kHost)})
+    .BindKernel("kv_cache_append");
@@ -0,0 +1,258 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/optimizer/mir/kv_cache_append_fuse_pass.h"
+#include <gtest/gtest.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "lite/core/context.h"
+#include "lite/core/op_registry.h"
+#include "lite/core/optimizer/mir/pass_registry.h"
+#include "lite/core/optimizer/mir/ssa_graph.h"
+#include "lite/core/program.h"
+#include "lite/model_parser/cpp_desc.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+using ArgNames = std::map<std::string, std::vector<std::string>>;
+
+static cpp::OpDesc* AddOpDesc(cpp::BlockDesc* block_desc,
+                              const std::string& type,
+                              const ArgNames& inputs,
+                              const ArgNames& outputs) {
+  auto* op_desc = block_desc->AddOp<cpp::OpDesc>();
+  op_desc->SetType(type);
+  for (auto& input : inputs) {
+    op_desc->SetInput(input.first, input.second);
+  }
+  for (auto& output : outputs) {
+    op_desc->SetOutput(output.first, output.second);
+  }
+  return op_desc;
+}
+
+static void AddScaleDesc(cpp::BlockDesc* block_desc,
+                         const std::string& x,
+                         const std::string& out) {
+  auto* scale = AddOpDesc(block_desc, "scale", {{"X", {x}}}, {{"Out", {out}}});
+  scale->SetAttr<float>("scale", 2.f);
+  scale->SetAttr<float>("bias", 0.f);
+  scale->SetAttr<bool>("bias_after_scale", true);
+}
+
+struct LoopOptions {
+  // the old cache is read by another op too
+  bool other_reader{false};
+  // the cache is a persistable var
+  bool persistable_cache{false};
+  // the concatenation is read by another op too
+  bool concat_consumer{false};
+};
+
+// while(cond) {
+//   reader_out = scale(cache), if other_reader
+//   concat_out = concat(cache, kv)
+//   assign(concat_out, cache)
+//   consumer_out = scale(concat_out), if concat_consumer
+// }
+class DecodingLoopGraph {
+ public:
+  explicit DecodingLoopGraph(const LoopOptions& options) {
+    program_desc_ = std::make_shared<cpp::ProgramDesc>();
+    scope_ = std::make_shared<Scope>();
+    auto* main_block = program_desc_->AddBlock<cpp::BlockDesc>();
+    main_block->ClearOps();
+    main_block->ClearVars();
+    auto* sub_block = program_desc_->AddBlock<cpp::BlockDesc>();
+    sub_block->ClearOps();
+    sub_block->ClearVars();
+    for (auto name : {"cache", "kv", "cond"}) {
+      auto* var_desc = main_block->AddVar<cpp::VarDesc>();
+      var_desc->SetName(name);
+      var_desc->SetType(VarDescAPI::Type::LOD_TENSOR);
+      var_desc->SetPersistable(options.persistable_cache &&
+                               std::string(name) == "cache");
+    }
+    for (auto name : {"concat_out", "reader_out", "consumer_out"}) {
+      auto* var_desc = sub_block->AddVar<cpp::VarDesc>();
+      var_desc->SetName(name);
+      var_desc->SetType(VarDescAPI::Type::LOD_TENSOR);
+    }
+
+    AddOpDesc(main_block,
+              "while",
+              {{"X", {"cache", "kv", "cond"}}, {"Condition", {"cond"}}},
+              {{"Out", {"cache"}}})
+        ->SetAttr<int32_t>("sub_block", 1);
+
+    if (options.other_reader) AddScaleDesc(sub_block, "cache", "reader_out");
+    AddOpDesc(sub_block,
+              "concat",
+              {{"X", {"cache", "kv"}}},
+              {{"Out", {"concat_out"}}})
+        ->SetAttr<int>("axis", 0);
+    AddOpDesc(
+        sub_block, "assign", {{"X", {"concat_out"}}}, {{"Out", {"cache"}}});
+    if (options.concat_consumer) {
+      AddScaleDesc(sub_block, "concat_out", "consumer_out");
+    }
+
+    std::vector<Place> valid_places{
+        Place{TARGET(kX86), PRECISION(kFloat)},
+        Place{TARGET(kHost), PRECISION(kAny)},
+    };
+    program_.reset(new Program(program_desc_, scope_, valid_places));
+    graph_.reset(new SSAGraph());
+    graph_->Build(*program_, valid_places, 1);
+    graph_->SetValidPlaces(valid_places);
+  }
+
+  const std::unique_ptr<SSAGraph>& graph() { return graph_; }
+  Scope* exec_scope() { return program_->exec_scope(); }
+
+  std::vector<std::string> OpTypes() {
+    std::vector<std::string> types;
+    for (auto* node : graph_->StmtTopologicalOrder()) {
+      types.push_back(node->AsStmt().op_type());
+    }
+    return types;
+  }
+
+  Node* FindOp(const std::string& type) {
+    for (auto* node : graph_->StmtTopologicalOrder()) {
+      if (node->AsStmt().op_type() == type) return node;
+    }
+    return nullptr;
+  }
+
+ private:
+  std::shared_ptr<cpp::ProgramDesc> program_desc_;
+  std::shared_ptr<Scope> scope_;
+  std::unique_ptr<Program> program_;
+  std::unique_ptr<SSAGraph> graph_;
+};
+
+static void RunOp(Node* node) {
+  auto& stmt = node->AsStmt();
+  ASSERT_FALSE(stmt.kernels().empty()) << stmt.op_type();
+  auto& kernel = stmt.kernels().front();
+  ASSERT_TRUE(stmt.op()->CheckShape());
+  ASSERT_TRUE(stmt.op()->InferShape());
+  std::unique_ptr<KernelContext> ctx(new KernelContext);
+  if (kernel->target() == TARGET(kX86)) {
+    ctx->As<X86Context>();
+  } else {
+    ctx->As<HostContext>();
+  }
+  kernel->SetContext(std::move(ctx));
+  kernel->Launch();
+}
+
+TEST(kv_cache_append_fuse_pass, fuse_concat_assign) {
+  DecodingLoopGraph test_graph(LoopOptions{});
+  KVCacheAppendFusePass pass;
+  pass.Apply(test_graph.graph());
+
+  EXPECT_EQ(test_graph.OpTypes(),
+            std::vector<std::string>{"kv_cache_append"});
+  auto* append = test_graph.FindOp("kv_cache_append");
+  ASSERT_NE(append, nullptr);
+  auto* op_info = append->AsStmt().op_info();
+  EXPECT_EQ(op_info->Input("X"), std::vector<std::string>{"cache"});
+  EXPECT_EQ(op_info->Input("Y"), std::vector<std::string>{"kv"});
+  EXPECT_EQ(op_info->Output("Out"), std::vector<std::string>{"cache"});
+  EXPECT_EQ(op_info->GetAttr<int>("axis"), 0);
+  ASSERT_EQ(append->inlinks.size(), 2u);
+  ASSERT_EQ(append->outlinks.size(), 1u);
+  EXPECT_EQ(append->outlinks.front()->AsArg().name, "cache");
+}
+
+TEST(kv_cache_append_fuse_pass, skip_cache_with_other_reader) {
+  LoopOptions options;
+  options.other_reader = true;
+  DecodingLoopGraph test_graph(options);
+  KVCacheAppendFusePass pass;
+  pass.Apply(test_graph.graph());
+
+  // the reader may run after the cache grows in place
+  EXPECT_EQ(test_graph.FindOp("kv_cache_append"), nullptr);
+  EXPECT_NE(test_graph.FindOp("concat"), nullptr);
+  EXPECT_NE(test_graph.FindOp("assign"), nullptr);
+}
+
+TEST(kv_cache_append_fuse_pass, skip_persistable_cache) {
+  LoopOptions options;
+  options.persistable_cache = true;
+  DecodingLoopGraph test_graph(options);
+  KVCacheAppendFusePass pass;
+  pass.Apply(test_graph.graph());
+
+  EXPECT_EQ(test_graph.FindOp("kv_cache_append"), nullptr);
+  EXPECT_EQ(test_graph.OpTypes().size(), 2u);
+}
+
+TEST(kv_cache_append_fuse_pass, relink_concat_consumers) {
+  LoopOptions options;
+  options.concat_consumer = true;
+  DecodingLoopGraph test_graph(options);
+  KVCacheAppendFusePass pass;
+  pass.Apply(test_graph.graph());
+
+  EXPECT_EQ(test_graph.OpTypes(),
+            (std::vector<std::string>{"kv_cache_append", "scale"}));
+  auto* append = test_graph.FindOp("kv_cache_append");
+  auto* consumer = test_graph.FindOp("scale");
+  ASSERT_NE(append, nullptr);
+  ASSERT_NE(consumer, nullptr);
+  EXPECT_EQ(consumer->AsStmt().op_info()->Input("X"),
+            std::vector<std::string>{"cache"});
+  ASSERT_EQ(consumer->inlinks.size(), 1u);
+  EXPECT_EQ(consumer->inlinks.front(), append->outlinks.front());
+
+  // the consumer reads the cache after the append
+  auto* scope = test_graph.exec_scope();
+  auto* cache = scope->FindMutableTensor("cache");
+  auto* kv = scope->FindMutableTensor("kv");
+  cache->Resize({2, 3});
+  kv->Resize({1, 3});
+  for (int i = 0; i < 6; ++i) cache->mutable_data<float>()[i] = i;
+  for (int i = 0; i < 3; ++i) kv->mutable_data<float>()[i] = 10.f + i;
+  RunOp(append);
+  RunOp(consumer);
+  auto* out = scope->FindTensor("consumer_out");
+  ASSERT_EQ(cache->dims(), DDim({3, 3}));
+  ASSERT_EQ(out->dims(), DDim({3, 3}));
+  for (int i = 0; i < 9; ++i) {
+    const float expected = i < 6 ? i : 10.f + i - 6;
+    EXPECT_EQ(cache->data<float>()[i], expected);
+    EXPECT_EQ(out->data<float>()[i], 2.f * expected);
+  }
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_OP(while);
+USE_LITE_OP(concat);
+USE_LITE_OP(assign);
+USE_LITE_OP(scale);
+USE_LITE_OP(kv_cache_append);
+USE_LITE_KERNEL(kv_cache_append, kHost, kAny, kAny, def);
+USE_LITE_KERNEL(scale, kX86, kFloat, kNCHW, def);
@@ -171,6 +171,29 @@ void MemoryOptimizePass::CollectLifeCycleByDevice(
     }
   }
 
+  // A sub-block of while or conditional_block only reuses its own temporary
+  // variables: the ones referenced by the other blocks are the inputs and
+  // outputs of the control flow op, and the ones read before being written
+  // are carried from the previous iteration.
+  if (graph->blockIdx() != kRootBlockIdx) {
+    for (size_t i = 0; i < graphs_->size(); i++) {
+      if (static_cast<int>(i) == graph->blockIdx()) continue;
+      for (auto& node : (*graphs_)[i]->nodes()) {
+        if (node.IsArg()) invalid_var_names.insert(node.arg()->name);
+      }
+    }
+    std::set<std::string> written_var_names;
+    for (auto& op_node : graph->StmtTopologicalOrder()) {
+      for (auto in_var_node : op_node->inlinks) {
+        auto& name = in_var_node->AsArg().name;
+        if (!written_var_names.count(name)) invalid_var_names.insert(name);
+      }
+      for (auto out_var_node : op_node->outlinks) {
+        written_var_names.insert(out_var_node->AsArg().name);
+      }
+    }
+  }
+
   for (auto& op_node : graph->StmtTopologicalOrder()) {
     if (op_node->IsStmt()) {
       std::vector<Node*> var_nodes(op_node->inlinks.begin(),
@@ -182,7 +205,7 @@ void MemoryOptimizePass::CollectLifeCycleByDevice(
         auto& arg = var_node->AsArg();
         if (arg.is_weight || arg.is_persist) continue;
         std::string var_name = arg.name;
-        if (invalid_var_names.count(var_name)) continue;
+        if (invalid_var_names.count(var_name) || !arg.type) continue;
         TargetType target_type = arg.type->target();
         if (is_host(target_type)) target_type = TARGET(kHost);
 
@@ -339,6 +362,7 @@ void MemoryOptimizePass::Apply(const std::unique_ptr<SSAGraph>& graph) {
   // name of var and the value in the table represents the current name of var.
   // 3. Perform reuse plan: Replace all var's name in the model according to the
   // mapping table.
+  if (graph->blockIdx() != kRootBlockIdx && !graphs_) return;
   std::map<std::string, lifecycle_map_t> lifecycles;
   CollectLifeCycleByDevice(&lifecycles, graph.get());
   for (auto& ele : lifecycles) {
@@ -39,6 +39,11 @@ class MemoryOptimizePass : public ProgramPass {
   using lifecycle_t = std::pair<int, int>;
   using lifecycle_map_t = std::map<std::string, lifecycle_t>;
   void Apply(const std::unique_ptr<SSAGraph>& graph) override;
+  // The graphs of all the blocks, a sub-block is optimized only if they are
+  // set, because the vars shared with the other blocks must not be reused.
+  void SetAllGraphs(std::vector<std::unique_ptr<mir::SSAGraph>>* graphs) {
+    graphs_ = graphs;
+  }
 
  private:
   void CollectLifeCycleByDevice(
@@ -50,6 +55,7 @@ class MemoryOptimizePass : public ProgramPass {
 
  private:
   int max_lifecycle_{-1};
+  std::vector<std::unique_ptr<mir::SSAGraph>>* graphs_{nullptr};
 };
 
 }  // namespace mir
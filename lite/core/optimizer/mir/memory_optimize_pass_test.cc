@@ -0,0 +1,204 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/optimizer/mir/memory_optimize_pass.h"
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "lite/core/context.h"
+#include "lite/core/op_registry.h"
+#include "lite/core/optimizer/mir/pass_registry.h"
+#include "lite/core/optimizer/mir/ssa_graph.h"
+#include "lite/core/program.h"
+#include "lite/model_parser/cpp_desc.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+static void AddVarDesc(cpp::BlockDesc* block_desc, const std::string& name) {
+  auto* var_desc = block_desc->AddVar<cpp::VarDesc>();
+  var_desc->SetName(name);
+  var_desc->SetType(VarDescAPI::Type::LOD_TENSOR);
+  var_desc->SetDataType(VarDescAPI::VarDataType::FP32);
+  var_desc->SetPersistable(false);
+}
+
+static void AddScaleDesc(cpp::BlockDesc* block_desc,
+                         const std::string& x,
+                         const std::string& out) {
+  auto* scale = block_desc->AddOp<cpp::OpDesc>();
+  scale->SetType("scale");
+  scale->SetInput("X", {x});
+  scale->SetOutput("Out", {out});
+  scale->SetAttr<float>("scale", 2.f);
+  scale->SetAttr<float>("bias", 0.f);
+  scale->SetAttr<bool>("bias_after_scale", true);
+}
+
+// while(cond) {
+//   t0 = scale(hidden)
+//   hidden = scale(t0)
+//   t1 = scale(t0)
+//   t2 = scale(t1)
+//   t3 = scale(t2)
+//   result = scale(t3)
+// }
+// hidden is carried from the previous iteration, result is the output of the
+// while op, and t0 ~ t3 are the temporaries of one iteration.
+class WhileLoopGraph {
+ public:
+  WhileLoopGraph() {
+    program_desc_ = std::make_shared<cpp::ProgramDesc>();
+    scope_ = std::make_shared<Scope>();
+    auto* main_block = program_desc_->AddBlock<cpp::BlockDesc>();
+    main_block->ClearOps();
+    main_block->ClearVars();
+    auto* sub_block = program_desc_->AddBlock<cpp::BlockDesc>();
+    sub_block->ClearOps();
+    sub_block->ClearVars();
+    AddVarDesc(main_block, "cond");
+    AddVarDesc(main_block, "result");
+    for (auto name : {"hidden", "t0", "t1", "t2", "t3"}) {
+      AddVarDesc(sub_block, name);
+    }
+
+    auto* while_op = main_block->AddOp<cpp::OpDesc>();
+    while_op->SetType("while");
+    while_op->SetInput("X", {"cond"});
+    while_op->SetInput("Condition", {"cond"});
+    while_op->SetOutput("Out", {"result"});
+    while_op->SetAttr<int32_t>("sub_block", 1);
+
+    AddScaleDesc(sub_block, "hidden", "t0");
+    AddScaleDesc(sub_block, "t0", "hidden");
+    AddScaleDesc(sub_block, "t0", "t1");
+    AddScaleDesc(sub_block, "t1", "t2");
+    AddScaleDesc(sub_block, "t2", "t3");
+    AddScaleDesc(sub_block, "t3", "result");
+
+    std::vector<Place> valid_places{
+        Place{TARGET(kX86), PRECISION(kFloat)},
+        Place{TARGET(kHost), PRECISION(kAny)},
+    };
+    program_.reset(new Program(program_desc_, scope_, valid_places));
+    for (int block_idx = 0; block_idx < 2; block_idx++) {
+      graphs_.emplace_back(new SSAGraph());
+      graphs_.back()->Build(*program_, valid_places, block_idx);
+      graphs_.back()->SetValidPlaces(valid_places);
+      // the place of the vars are inferred before memory_optimize_pass
+      for (auto& node : graphs_.back()->mutable_nodes()) {
+        if (!node.IsArg()) continue;
+        node.AsArg().type = LiteType::GetTensorTy(
+            TARGET(kX86), PRECISION(kFloat), DATALAYOUT(kNCHW));
+      }
+    }
+  }
+
+  std::vector<std::unique_ptr<SSAGraph>>* graphs() { return &graphs_; }
+  const std::unique_ptr<SSAGraph>& sub_graph() { return graphs_[1]; }
+  Scope* exec_scope() { return program_->exec_scope(); }
+
+  // The outputs of the ops in the sub-block.
+  std::vector<std::string> SubBlockOutputs() {
+    std::vector<std::string> names;
+    for (auto* node : sub_graph()->StmtTopologicalOrder()) {
+      names.push_back(node->AsStmt().op_info()->Output("Out").front());
+    }
+    return names;
+  }
+
+ private:
+  std::shared_ptr<cpp::ProgramDesc> program_desc_;
+  std::shared_ptr<Scope> scope_;
+  std::unique_ptr<Program> program_;
+  std::vector<std::unique_ptr<SSAGraph>> graphs_;
+};
+
+static void ApplyMemoryOptimizePass(WhileLoopGraph* test_graph) {
+  MemoryOptimizePass pass;
+  pass.SetAllGraphs(test_graph->graphs());
+  for (auto& graph : *test_graph->graphs()) {
+    pass.Apply(graph);
+  }
+}
+
+static void RunOp(Node* node) {
+  auto& stmt = node->AsStmt();
+  ASSERT_FALSE(stmt.kernels().empty()) << stmt.op_type();
+  auto& kernel = stmt.kernels().front();
+  ASSERT_TRUE(stmt.op()->CheckShape());
+  ASSERT_TRUE(stmt.op()->InferShape());
+  std::unique_ptr<KernelContext> ctx(new KernelContext);
+  ctx->As<X86Context>();
+  kernel->SetContext(std::move(ctx));
+  kernel->Launch();
+}
+
+TEST(memory_optimize_pass, skip_sub_block_without_all_graphs) {
+  WhileLoopGraph test_graph;
+  MemoryOptimizePass pass;
+  pass.Apply(test_graph.sub_graph());
+  EXPECT_EQ(test_graph.SubBlockOutputs(),
+            (std::vector<std::string>{
+                "t0", "hidden", "t1", "t2", "t3", "result"}));
+}
+
+TEST(memory_optimize_pass, reuse_sub_block_temporaries) {
+  WhileLoopGraph test_graph;
+  ApplyMemoryOptimizePass(&test_graph);
+  // t2 reuses t0 and t3 reuses t1, the loop-carried hidden and the output
+  // result keep their own memory
+  EXPECT_EQ(test_graph.SubBlockOutputs(),
+            (std::vector<std::string>{
+                "t0", "hidden", "t1", "t0", "t1", "result"}));
+  auto ops = test_graph.sub_graph()->StmtTopologicalOrder();
+  ASSERT_EQ(ops.size(), 6u);
+  EXPECT_EQ(ops[0]->AsStmt().op_info()->Input("X"),
+            std::vector<std::string>{"hidden"});
+  EXPECT_EQ(ops[5]->AsStmt().op_info()->Input("X"),
+            std::vector<std::string>{"t1"});
+}
+
+TEST(memory_optimize_pass, run_sub_block_iterations) {
+  WhileLoopGraph test_graph;
+  ApplyMemoryOptimizePass(&test_graph);
+  auto* scope = test_graph.exec_scope();
+  auto* hidden = scope->FindMutableTensor("hidden");
+  hidden->Resize({2});
+  hidden->mutable_data<float>()[0] = 1.f;
+  hidden->mutable_data<float>()[1] = -0.5f;
+  // every iteration multiplies hidden by 4 and result is 32 times hidden
+  float expected = 32.f;
+  for (int iter = 0; iter < 3; iter++) {
+    for (auto* node : test_graph.sub_graph()->StmtTopologicalOrder()) {
+      RunOp(node);
+    }
+    auto* result = scope->FindTensor("result");
+    ASSERT_EQ(result->dims(), DDim({2}));
+    EXPECT_FLOAT_EQ(result->data<float>()[0], expected);
+    EXPECT_FLOAT_EQ(result->data<float>()[1], -0.5f * expected);
+    expected *= 4.f;
+  }
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_OP(while);
+USE_LITE_OP(scale);
+USE_LITE_KERNEL(scale, kX86, kFloat, kNCHW, def);
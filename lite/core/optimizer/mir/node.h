@@ -167,7 +167,7 @@ class Node {
   bool IsArg() const { return role_ == Role::kArg; }
 
   void set_id(int id) { id_ = id; }
-  int get_id() { return id_; }
+  int get_id() const { return id_; }
 
  private:
   // Either stmt_ or argument_ is used.
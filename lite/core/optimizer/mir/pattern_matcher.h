@@ -80,6 +80,17 @@ struct PMNode {
   bool IsOp() const { return type_ == Type::kOp; }
   bool IsVar() const { return type_ == Type::kVar; }
 
+  // How the candidates of this node are looked up from the op type index of
+  // the graph, set by the first op type assertion.
+  enum class IndexBy {
+    kNone,      // test every node of the graph
+    kOpType,    // a statement of index_op_type()
+    kOpInput,   // an input of a statement of index_op_type()
+    kOpOutput,  // an output of a statement of index_op_type()
+  };
+  IndexBy index_by() const { return teller_ ? IndexBy::kNone : index_by_; }
+  const std::string& index_op_type() const { return index_op_type_; }
+
   const std::string& name() const { return name_; }
 
   PMNode& operator=(const PMNode&) = delete;
@@ -197,6 +208,14 @@ struct PMNode {
   std::string op_type_;
   Type type_{};
   Role role_{Role::kUnknown};
+  IndexBy index_by_{IndexBy::kNone};
+  std::string index_op_type_;
+
+  void set_index(IndexBy index_by, const std::string& op_type) {
+    if (index_by_ != IndexBy::kNone) return;
+    index_by_ = index_by;
+    index_op_type_ = op_type;
+  }
 };
 
 /*
@@ -337,8 +356,15 @@ bool IsNthInput(const Node& var,
 bool HasInput(const Node& op, const std::string& argument);
 
 // Graph safely remove some nodes, will automatically clean up the edges.
+// It costs O(degree) for every removed node.
 void GraphSafeRemoveNodes(SSAGraph* graph, const std::set<const Node*>& nodes);
 
+// Collect the nodes of the graph that match the pmnode. The candidates come
+// from the op type index of the graph when the pmnode asserts an op type.
+void MarkMatchedNodes(SSAGraph* graph,
+                      const PMNode* pmnode,
+                      std::set<Node*>* nodes);
+
 // Some pre-defined patterns those can be reused in multiple passes.
 // The related Fluid Layer or Op should be one pattern here for better re-usage
 // across different fusion.
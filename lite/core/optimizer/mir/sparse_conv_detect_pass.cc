@@ -16,6 +16,8 @@
 // operations with the kernel size of 1x1. In practice, the pass requires the
 // convolutional weights to be sparse. And, the sparser the weights
 // are, the more latency improvement we would potentially obtain.
+// On x86, fc / matmul with a constant sparse weight are converted to
+// sparse_fc as well.
 
 #include "lite/core/optimizer/mir/sparse_conv_detect_pass.h"
 #include <math.h>
@@ -603,7 +605,229 @@ void SparseConvDetectPass::CopyOutputScaleFromOpInfo(cpp::OpDesc* op_desc,
   }
 }
 
+void SparseConvDetectPass::ReplaceStmtNode(
+    const std::unique_ptr<SSAGraph>& graph,
+    Node* node,
+    Node* new_node,
+    const std::vector<Node*>& new_weights) {
+  auto new_inputs = new_node->AsStmt().op_info()->input_vars();
+  for (auto iter = node->inlinks.begin(); iter != node->inlinks.end();) {
+    auto it =
+        std::find((*iter)->outlinks.begin(), (*iter)->outlinks.end(), node);
+    if (it != (*iter)->outlinks.end()) {
+      (*iter)->outlinks.erase(it);
+    }
+    // The replaced weights go away, the bias is still read by the new op.
+    bool is_weight = (*iter)->IsArg() && (*iter)->AsArg().is_weight;
+    if (!is_weight || std::find(new_inputs.begin(),
+                                new_inputs.end(),
+                                (*iter)->AsArg().name) != new_inputs.end()) {
+      DirectedLink(*iter, new_node);
+    } else if ((*iter)->outlinks.empty()) {
+      graph->RemoveNode((*iter));
+    }
+    iter = node->inlinks.erase(iter);
+  }
+  for (auto* weight : new_weights) {
+    DirectedLink(weight, new_node);
+  }
+  for (auto iter = node->outlinks.begin(); iter != node->outlinks.end();) {
+    DirectedLink(new_node, *iter);
+    auto it =
+        std::find((*iter)->inlinks.begin(), (*iter)->inlinks.end(), node);
+    if (it != (*iter)->inlinks.end()) {
+      (*iter)->inlinks.erase(it);
+    }
+    iter = node->outlinks.erase(iter);
+  }
+  graph->RemoveNode(node);
+}
+
+void SparseConvDetectPass::DetectSparseFc(
+    const std::unique_ptr<SSAGraph>& graph, Node* node) {
+  auto* scope = node->stmt()->op()->scope();
+  auto* op_info = node->stmt()->mutable_op_info();
+  auto op_type = op_info->Type();
+  bool is_fc = op_type == "fc";
+  auto x = op_info->Input(is_fc ? "Input" : "X").front();
+  auto w = op_info->Input(is_fc ? "W" : "Y").front();
+  auto y = op_info->Output("Out").front();
+  // The weight must be a constant which is only read by this op
+  bool has_const_weight = false;
+  for (auto* in : node->inlinks) {
+    if (!in->IsArg()) continue;
+    if (in->AsArg().name == x && in->AsArg().is_weight) return;
+    if (in->AsArg().name == w && in->AsArg().is_weight &&
+        in->outlinks.size() == 1) {
+      has_const_weight = true;
+    }
+  }
+  if (!has_const_weight) {
+    VLOG(4) << "The weight of the supported sparse fc must be a constant";
+    return;
+  }
+  auto x_dims = scope->FindVar(x)->Get<lite::Tensor>().dims();
+  auto& w_tensor = scope->FindVar(w)->Get<lite::Tensor>();
+  auto w_dims = w_tensor.dims();
+  if (w_tensor.precision() != PrecisionType::kFloat || w_dims.size() != 2) {
+    VLOG(4) << "The sparse fc now only support 2-D fp32 weights";
+    return;
+  }
+  int in_num_col_dims = 1;
+  bool trans_w = false;
+  float alpha = 1.f;
+  std::string act_type;
+  if (is_fc) {
+    in_num_col_dims = op_info->GetAttr<int>("in_num_col_dims");
+    if (op_info->HasAttr("padding_weights") &&
+        op_info->GetAttr<bool>("padding_weights")) {
+      return;
+    }
+    if (op_info->HasAttr("activation_type")) {
+      act_type = op_info->GetAttr<std::string>("activation_type");
+    }
+    if (!(act_type.empty() || act_type == "relu")) {
+      VLOG(4) << "The sparse fc only supports fuse with relu";
+      return;
+    }
+  } else {
+    bool is_v2 = op_type == "matmul_v2";
+    bool trans_x = op_info->GetAttr<bool>(is_v2 ? "trans_x" : "transpose_X");
+    trans_w = op_info->GetAttr<bool>(is_v2 ? "trans_y" : "transpose_Y");
+    if (!is_v2) {
+      alpha = op_info->GetAttr<float>("alpha");
+    }
+    if (trans_x || x_dims.size() < 2) {
+      VLOG(4) << "The sparse matmul needs a 2-D or higher X not transposed";
+      return;
+    }
+    in_num_col_dims = x_dims.size() - 1;
+  }
+  if (op_info->HasAttr("enable_int8") &&
+      op_info->GetAttr<bool>("enable_int8")) {
+    VLOG(4) << "The sparse fc now only support fp32";
+    return;
+  }
+  const int ch_in = trans_w ? w_dims[1] : w_dims[0];
+  const int ch_out = trans_w ? w_dims[0] : w_dims[1];
+  if (!(ch_out > 0 && ch_in > 0)) return;
+  // The compressed layout is the one of a 1x1 conv, whose weight is
+  // [ch_out, ch_in]
+  lite::Tensor wt_tensor;
+  wt_tensor.Resize({ch_out, ch_in});
+  wt_tensor.set_precision(PRECISION(kFloat));
+  auto* wt = wt_tensor.mutable_data<float>();
+  auto* w_data = w_tensor.data<float>();
+  for (int o = 0; o < ch_out; ++o) {
+    for (int i = 0; i < ch_in; ++i) {
+      wt[o * ch_in + i] =
+          alpha * (trans_w ? w_data[o * ch_in + i] : w_data[i * ch_out + o]);
+    }
+  }
+  int weight_num = ch_out * ch_in;
+  int num_build_nonzeroes = 0;
+  int count_nonzeroes = 0;
+  int count_channels = 0;
+  int count_blocks = 0;
+  int flag_semi = 0;
+  int zero_num = ComputeSemiSparseZeros<float>(&wt_tensor,
+                                               &count_nonzeroes,
+                                               &count_channels,
+                                               &count_blocks,
+                                               &flag_semi,
+                                               ch_out,
+                                               ch_in);
+  if (flag_semi == 0) {
+    zero_num = ComputeSparseZeros<float>(
+        &wt_tensor, &num_build_nonzeroes, ch_out, ch_in);
+  }
+  float sparse_zero_percent =
+      static_cast<float>(zero_num) / static_cast<float>(weight_num);
+  VLOG(4) << op_type << " sparse zero num percent: " << sparse_zero_percent;
+  if (sparse_zero_percent < sparse_threshold_) {
+    return;
+  }
+  auto nonzeros_output_name = string_format("%s_nonzeros_output", w.c_str());
+  auto oc_nonzeros_name = string_format("%s_oc_nonzeros", w.c_str());
+  auto ic_diffs_name = string_format("%s_ic_diffs", w.c_str());
+  auto* nonzeros_output_arg = graph->NewArgumentNode(nonzeros_output_name);
+  auto* oc_nonzeros_arg = graph->NewArgumentNode(oc_nonzeros_name);
+  auto* ic_diffs_arg = graph->NewArgumentNode(ic_diffs_name);
+  for (auto* arg : {nonzeros_output_arg, oc_nonzeros_arg, ic_diffs_arg}) {
+    arg->AsArg().is_persist = true;
+    arg->AsArg().is_weight = true;
+  }
+  auto* nonzeros_output_t =
+      scope->Var(nonzeros_output_name)->GetMutable<Tensor>();
+  auto* oc_nonzeros_t = scope->Var(oc_nonzeros_name)->GetMutable<Tensor>();
+  auto* ic_diffs_t = scope->Var(ic_diffs_name)->GetMutable<Tensor>();
+  oc_nonzeros_t->Resize({ch_out});
+  int first_ic;
+  if (flag_semi == 1) {
+    nonzeros_output_t->Resize({count_nonzeroes});
+    ic_diffs_t->Resize({count_blocks});
+    first_ic = ComputeSemiSparseWeight<float>(&wt_tensor,
+                                              ch_out,
+                                              ch_in,
+                                              1,
+                                              count_nonzeroes,
+                                              count_channels,
+                                              count_blocks,
+                                              nonzeros_output_t,
+                                              oc_nonzeros_t,
+                                              ic_diffs_t);
+  } else {
+    nonzeros_output_t->Resize({num_build_nonzeroes});
+    ic_diffs_t->Resize({num_build_nonzeroes});
+    first_ic = ComputeSparseWeight<float>(&wt_tensor,
+                                          ch_out,
+                                          ch_in,
+                                          1,
+                                          weight_num - zero_num,
+                                          num_build_nonzeroes,
+                                          nonzeros_output_t,
+                                          oc_nonzeros_t,
+                                          ic_diffs_t);
+  }
+  for (auto* t : {nonzeros_output_t, oc_nonzeros_t, ic_diffs_t}) {
+    t->set_persistable(true);
+  }
+  nonzeros_output_t->set_precision(PRECISION(kFloat));
+  oc_nonzeros_t->set_precision(PRECISION(kInt32));
+  ic_diffs_t->set_precision(PRECISION(kInt32));
+
+  cpp::OpDesc op_desc;
+  op_desc.SetType("sparse_fc");
+  op_desc.SetInput("Input", {x});
+  op_desc.SetInput("NonZeroWeights", {nonzeros_output_name});
+  op_desc.SetInput("OcNonZeros", {oc_nonzeros_name});
+  op_desc.SetInput("Diffs", {ic_diffs_name});
+  if (is_fc && op_info->HasInput("Bias") && op_info->Input("Bias").size() > 0) {
+    op_desc.SetInput("Bias", {op_info->Input("Bias").front()});
+  }
+  op_desc.SetOutput("Out", {y});
+  op_desc.SetAttr<int>("in_num_col_dims", in_num_col_dims);
+  op_desc.SetAttr<std::string>("activation_type", act_type);
+  op_desc.SetAttr<int>("first_ic", first_ic);
+  op_desc.SetAttr<int>("flag_semi", flag_semi);
+  auto sparse_fc_op = LiteOpRegistry::Global().Create("sparse_fc");
+  sparse_fc_op->Attach(op_desc, scope);
+  auto* sparse_op_node =
+      graph->GraphCreateInstructNode(sparse_fc_op, graph->valid_places());
+  ReplaceStmtNode(graph,
+                  node,
+                  sparse_op_node,
+                  {nonzeros_output_arg, oc_nonzeros_arg, ic_diffs_arg});
+}
+
 void SparseConvDetectPass::Apply(const std::unique_ptr<SSAGraph>& graph) {
+  // sparse_fc is only implemented on x86
+  bool has_x86 = false;
+  for (auto& place : graph->valid_places()) {
+    if (place.target == TARGET(kX86)) {
+      has_x86 = true;
+    }
+  }
   for (auto& node : graph->StmtTopologicalOrder()) {
     if (node->IsStmt() && node->AsStmt().op_type() == "conv2d") {
       auto* scope = node->stmt()->op()->scope();
@@ -828,33 +1052,15 @@ void SparseConvDetectPass::Apply(const std::unique_ptr<SSAGraph>& graph) {
       sparse_conv2d_op->Attach(op_desc, node->stmt()->op()->scope());
       auto* sparse_op_node = graph->GraphCreateInstructNode(
           sparse_conv2d_op, graph->valid_places());
-      for (auto iter = node->inlinks.begin(); iter != node->inlinks.end();) {
-        auto it =
-            std::find((*iter)->outlinks.begin(), (*iter)->outlinks.end(), node);
-        if (it != (*iter)->outlinks.end()) {
-          (*iter)->outlinks.erase(it);
-        }
-        bool is_weight = (*iter)->IsArg() && (*iter)->AsArg().is_weight;
-        if (!is_weight) {
-          DirectedLink(*iter, sparse_op_node);
-        } else {
-          graph->RemoveNode((*iter));
-        }
-        iter = node->inlinks.erase(iter);
-      }
-      DirectedLink(nonzeros_output_arg, sparse_op_node);
-      DirectedLink(oc_nonzeros_arg, sparse_op_node);
-      DirectedLink(ic_diffs_arg, sparse_op_node);
-      for (auto iter = node->outlinks.begin(); iter != node->outlinks.end();) {
-        DirectedLink(sparse_op_node, *iter);
-        auto it =
-            std::find((*iter)->inlinks.begin(), (*iter)->inlinks.end(), node);
-        if (it != (*iter)->inlinks.end()) {
-          (*iter)->inlinks.erase(it);
-        }
-        iter = node->outlinks.erase(iter);
-      }
-      graph->RemoveNode(node);
+      ReplaceStmtNode(graph,
+                      node,
+                      sparse_op_node,
+                      {nonzeros_output_arg, oc_nonzeros_arg, ic_diffs_arg});
+    } else if (node->IsStmt() && has_x86 &&
+               (node->AsStmt().op_type() == "fc" ||
+                node->AsStmt().op_type() == "matmul" ||
+                node->AsStmt().op_type() == "matmul_v2")) {
+      DetectSparseFc(graph, node);
     }
   }
 }
@@ -865,7 +1071,6 @@ void SparseConvDetectPass::Apply(const std::unique_ptr<SSAGraph>& graph) {
 
 REGISTER_MIR_PASS(sparse_conv_detect_pass,
                   paddle::lite::mir::SparseConvDetectPass)
-    .BindTargets({TARGET(kARM)})
+    .BindTargets({TARGET(kARM), TARGET(kX86)})
     .ExcludeTargets({TARGET(kXPU)})
-    .ExcludeTargets({TARGET(kOpenCL)})
-    .ExcludeTargets({TARGET(kX86)});
+    .ExcludeTargets({TARGET(kOpenCL)});
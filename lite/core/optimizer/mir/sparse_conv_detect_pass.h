@@ -16,6 +16,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 #include "lite/core/op_registry.h"
 #include "lite/core/optimizer/mir/pass.h"
 
@@ -95,6 +96,16 @@ class SparseConvDetectPass : public ProgramPass {
   }
 
  private:
+  // Convert fc / matmul / matmul_v2 whose weight is a sparse fp32 constant
+  // to sparse_fc
+  void DetectSparseFc(const std::unique_ptr<SSAGraph>& graph, Node* node);
+  // Move the links of 'node' to 'new_node', drop the old weights which
+  // 'new_node' doesn't read and link 'new_weights' instead
+  void ReplaceStmtNode(const std::unique_ptr<SSAGraph>& graph,
+                       Node* node,
+                       Node* new_node,
+                       const std::vector<Node*>& new_weights);
+
   float sparse_threshold_{0.5f};
 };
 
@@ -0,0 +1,290 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/optimizer/mir/sparse_conv_detect_pass.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "lite/core/op_registry.h"
+#include "lite/core/optimizer/mir/ssa_graph.h"
+#include "lite/core/program.h"
+#include "lite/model_parser/cpp_desc.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+using ArgNames = std::map<std::string, std::vector<std::string>>;
+
+static cpp::OpDesc* AddOpDesc(cpp::BlockDesc* block_desc,
+                              const std::string& type,
+                              const ArgNames& inputs,
+                              const ArgNames& outputs) {
+  auto* op_desc = block_desc->AddOp<cpp::OpDesc>();
+  op_desc->SetType(type);
+  for (auto& input : inputs) {
+    op_desc->SetInput(input.first, input.second);
+  }
+  for (auto& output : outputs) {
+    op_desc->SetOutput(output.first, output.second);
+  }
+  return op_desc;
+}
+
+// Add a fp32 weight of `dims`, of which about `sparsity` is zero.
+static void AddWeight(cpp::BlockDesc* block_desc,
+                      Scope* scope,
+                      const std::string& name,
+                      const DDim& dims,
+                      float sparsity) {
+  auto* var_desc = block_desc->AddVar<cpp::VarDesc>();
+  var_desc->SetName(name);
+  var_desc->SetType(VarDescAPI::Type::LOD_TENSOR);
+  var_desc->SetDataType(VarDescAPI::Type::FP32);
+  var_desc->SetPersistable(true);
+  auto* tensor = scope->Var(name)->GetMutable<Tensor>();
+  tensor->Resize(dims);
+  auto* data = tensor->mutable_data<float>();
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    const float r = static_cast<float>((i * 37) % 100) / 100.f;
+    data[i] = r < sparsity ? 0.f : static_cast<float>(i % 13) / 6.f - 1.f;
+  }
+  tensor->set_persistable(true);
+}
+
+// x = feed                                   [4, 16]
+// fc_out = fc(x, w_fc, b_fc)                 80% sparse, converted
+// dense_out = fc(x, w_dense)                 dense, kept
+// mm_out = matmul(x, w_mm^T) * 0.5           80% sparse [8, 16], converted
+// mm_tx_out = matmul_v2(x^T, w_tx)           X is transposed, kept
+// shared_out0 = fc(x, w_shared)              the sparse weight is shared by
+// shared_out1 = fc(x, w_shared)              two ops, both kept
+// fetch(all the outputs)
+class SparseFcGraph {
+ public:
+  SparseFcGraph() {
+    program_desc_ = std::make_shared<cpp::ProgramDesc>();
+    scope_ = std::make_shared<Scope>();
+    auto* block_desc = program_desc_->AddBlock<cpp::BlockDesc>();
+    block_desc->ClearOps();
+    block_desc->ClearVars();
+    const std::vector<std::string> outputs{"fc_out",
+                                           "dense_out",
+                                           "mm_out",
+                                           "mm_tx_out",
+                                           "shared_out0",
+                                           "shared_out1"};
+    for (auto name : {"feed", "fetch", "x"}) {
+      block_desc->AddVar<cpp::VarDesc>()->SetName(name);
+    }
+    for (auto& name : outputs) {
+      block_desc->AddVar<cpp::VarDesc>()->SetName(name);
+      scope_->Var(name);
+    }
+    auto* x = scope_->Var("x")->GetMutable<Tensor>();
+    x->Resize({4, 16});
+    for (int64_t i = 0; i < x->numel(); ++i) {
+      x->mutable_data<float>()[i] = static_cast<float>(i % 9) / 4.f - 1.f;
+    }
+    AddWeight(block_desc, scope_.get(), "w_fc", DDim({16, 8}), 0.8f);
+    AddWeight(block_desc, scope_.get(), "b_fc", DDim({8}), 0.f);
+    AddWeight(block_desc, scope_.get(), "w_dense", DDim({16, 8}), 0.f);
+    AddWeight(block_desc, scope_.get(), "w_mm", DDim({8, 16}), 0.8f);
+    AddWeight(block_desc, scope_.get(), "w_tx", DDim({4, 8}), 0.8f);
+    AddWeight(block_desc, scope_.get(), "w_shared", DDim({16, 8}), 0.8f);
+
+    AddOpDesc(block_desc, "feed", {{"X", {"feed"}}}, {{"Out", {"x"}}})
+        ->SetAttr<int>("col", 0);
+    auto add_fc = [&](const std::string& w,
+                      const std::string& bias,
+                      const std::string& out) {
+      ArgNames inputs{{"Input", {"x"}}, {"W", {w}}};
+      if (!bias.empty()) inputs["Bias"] = {bias};
+      auto* fc = AddOpDesc(block_desc, "fc", inputs, {{"Out", {out}}});
+      fc->SetAttr<int>("in_num_col_dims", 1);
+      fc->SetAttr<std::string>("activation_type", bias.empty() ? "" : "relu");
+    };
+    add_fc("w_fc", "b_fc", "fc_out");
+    add_fc("w_dense", "", "dense_out");
+    auto* matmul = AddOpDesc(block_desc,
+                             "matmul",
+                             {{"X", {"x"}}, {"Y", {"w_mm"}}},
+                             {{"Out", {"mm_out"}}});
+    matmul->SetAttr<bool>("transpose_X", false);
+    matmul->SetAttr<bool>("transpose_Y", true);
+    matmul->SetAttr<float>("alpha", 0.5f);
+    auto* matmul_v2 = AddOpDesc(block_desc,
+                                "matmul_v2",
+                                {{"X", {"x"}}, {"Y", {"w_tx"}}},
+                                {{"Out", {"mm_tx_out"}}});
+    matmul_v2->SetAttr<bool>("trans_x", true);
+    matmul_v2->SetAttr<bool>("trans_y", false);
+    add_fc("w_shared", "", "shared_out0");
+    add_fc("w_shared", "", "shared_out1");
+    int col = 0;
+    for (auto& name : outputs) {
+      AddOpDesc(block_desc, "fetch", {{"X", {name}}}, {{"Out", {"fetch"}}})
+          ->SetAttr<int>("col", col++);
+    }
+
+    std::vector<Place> valid_places{
+        Place{TARGET(kX86), PRECISION(kFloat)},
+        Place{TARGET(kHost), PRECISION(kAny)},
+    };
+    program_.reset(new Program(program_desc_, scope_, valid_places));
+    graph_.reset(new SSAGraph());
+    graph_->Build(*program_, valid_places);
+    graph_->SetValidPlaces(valid_places);
+  }
+
+  const std::unique_ptr<SSAGraph>& graph() { return graph_; }
+
+  Scope* scope() { return scope_.get(); }
+
+  // The type of the op which writes `out`
+  std::string WriterType(const std::string& out) {
+    for (auto* node : graph_->StmtTopologicalOrder()) {
+      auto* op_info = node->AsStmt().op_info();
+      for (auto& name : op_info->output_names()) {
+        if (name == out) return op_info->Type();
+      }
+    }
+    return "";
+  }
+
+  Node* FindWriter(const std::string& out) {
+    for (auto* node : graph_->StmtTopologicalOrder()) {
+      for (auto* out_node : node->outlinks) {
+        if (out_node->AsArg().name == out) return node;
+      }
+    }
+    return nullptr;
+  }
+
+  bool HasArg(const std::string& name) {
+    for (auto& node : graph_->mutable_nodes()) {
+      if (node.IsArg() && node.AsArg().name == name) return true;
+    }
+    return false;
+  }
+
+ private:
+  std::shared_ptr<cpp::ProgramDesc> program_desc_;
+  std::shared_ptr<Scope> scope_;
+  std::unique_ptr<Program> program_;
+  std::unique_ptr<SSAGraph> graph_;
+};
+
+// Run the kernel of the sparse_fc which writes `out`.
+static void RunSparseFc(SparseFcGraph* test_graph, const std::string& out) {
+  auto* node = test_graph->FindWriter(out);
+  ASSERT_NE(node, nullptr);
+  auto& stmt = node->AsStmt();
+  ASSERT_TRUE(stmt.op()->InferShape());
+  ASSERT_FALSE(stmt.kernels().empty());
+  auto& kernel = stmt.kernels().front();
+  std::unique_ptr<KernelContext> ctx(new KernelContext);
+  ctx->As<X86Context>();
+  kernel->SetContext(std::move(ctx));
+  kernel->Launch();
+}
+
+TEST(sparse_conv_detect_pass, convert_fc_and_matmul) {
+  SparseFcGraph test_graph;
+  SparseConvDetectPass pass;
+  pass.SetSparseThreshold(0.6f);
+  pass.Apply(test_graph.graph());
+
+  EXPECT_EQ(test_graph.WriterType("fc_out"), "sparse_fc");
+  EXPECT_EQ(test_graph.WriterType("mm_out"), "sparse_fc");
+  // not sparse enough, the X is transposed, or the weight is not only read by
+  // the op
+  EXPECT_EQ(test_graph.WriterType("dense_out"), "fc");
+  EXPECT_EQ(test_graph.WriterType("mm_tx_out"), "matmul_v2");
+  EXPECT_EQ(test_graph.WriterType("shared_out0"), "fc");
+  EXPECT_EQ(test_graph.WriterType("shared_out1"), "fc");
+
+  // the weights are replaced by their compressed forms, the bias is kept
+  auto* fc_info = test_graph.FindWriter("fc_out")->AsStmt().op_info();
+  EXPECT_EQ(fc_info->Input("Input"), std::vector<std::string>{"x"});
+  EXPECT_EQ(fc_info->Input("NonZeroWeights"),
+            std::vector<std::string>{"w_fc_nonzeros_output"});
+  EXPECT_EQ(fc_info->Input("Bias"), std::vector<std::string>{"b_fc"});
+  EXPECT_EQ(fc_info->GetAttr<std::string>("activation_type"), "relu");
+  EXPECT_FALSE(test_graph.HasArg("w_fc"));
+  EXPECT_FALSE(test_graph.HasArg("w_mm"));
+  EXPECT_TRUE(test_graph.HasArg("w_fc_nonzeros_output"));
+  EXPECT_TRUE(test_graph.HasArg("b_fc"));
+  EXPECT_TRUE(test_graph.HasArg("w_shared"));
+}
+
+// The transpose and alpha of matmul are folded into the sparse weight, and
+// the relu and bias of fc are applied by sparse_fc.
+TEST(sparse_conv_detect_pass, weight_transform) {
+  SparseFcGraph test_graph;
+  auto* scope = test_graph.scope();
+  const float* x = scope->FindVar("x")->Get<Tensor>().data<float>();
+  Tensor w_fc, b_fc, w_mm;
+  w_fc.CopyDataFrom(scope->FindVar("w_fc")->Get<Tensor>());
+  b_fc.CopyDataFrom(scope->FindVar("b_fc")->Get<Tensor>());
+  w_mm.CopyDataFrom(scope->FindVar("w_mm")->Get<Tensor>());
+  SparseConvDetectPass pass;
+  pass.SetSparseThreshold(0.6f);
+  pass.Apply(test_graph.graph());
+
+  const int m = 4, k = 16, n = 8;
+  RunSparseFc(&test_graph, "fc_out");
+  RunSparseFc(&test_graph, "mm_out");
+  const auto& fc_out = scope->FindVar("fc_out")->Get<Tensor>();
+  const auto& mm_out = scope->FindVar("mm_out")->Get<Tensor>();
+  ASSERT_EQ(fc_out.dims(), DDim({m, n}));
+  ASSERT_EQ(mm_out.dims(), DDim({m, n}));
+  for (int i = 0; i < m; ++i) {
+    for (int j = 0; j < n; ++j) {
+      double fc_ref = b_fc.data<float>()[j];
+      double mm_ref = 0.;
+      for (int l = 0; l < k; ++l) {
+        fc_ref += x[i * k + l] * w_fc.data<float>()[l * n + j];
+        mm_ref += x[i * k + l] * w_mm.data<float>()[j * k + l];
+      }
+      fc_ref = std::max(fc_ref, 0.);
+      mm_ref *= 0.5;
+      EXPECT_NEAR(fc_out.data<float>()[i * n + j], fc_ref, 1e-4);
+      EXPECT_NEAR(mm_out.data<float>()[i * n + j], mm_ref, 1e-4);
+    }
+  }
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+USE_MIR_PASS(sparse_conv_detect_pass);
+USE_LITE_OP(feed);
+USE_LITE_OP(fetch);
+USE_LITE_OP(fc);
+USE_LITE_OP(matmul);
+USE_LITE_OP(matmul_v2);
+USE_LITE_OP(sparse_fc);
+USE_LITE_KERNEL(fc, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(matmul, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(matmul_v2, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(sparse_fc, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(feed, kHost, kAny, kAny, def);
+USE_LITE_KERNEL(fetch, kHost, kAny, kAny, def);
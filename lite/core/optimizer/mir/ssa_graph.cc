@@ -14,9 +14,12 @@
 
 #include "lite/core/optimizer/mir/ssa_graph.h"
 #include <algorithm>
+#include <cstdint>
 #include <map>
+#include <iterator>
 #include <memory>
 #include <set>
+#include <unordered_map>
 #include <utility>
 #include "lite/core/optimizer/mir/dot.h"
 
@@ -98,21 +101,88 @@ void SSAGraph::SortHelper(
   ret->push_back(node);
 }
 
+uint64_t SSAGraph::TopologySignature() const {
+  uint64_t hash = node_storage_.size();
+  auto combine = [&hash](uint64_t value) {
+    hash ^= value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+  };
+  for (auto &node : node_storage_) {
+    combine(reinterpret_cast<uintptr_t>(&node));
+    if (node.IsStmt()) combine(static_cast<uint64_t>(node.get_id()));
+    // The outlinks mirror the inlinks, which is checked when the order is
+    // rebuilt.
+    for (auto *in : node.inlinks) {
+      combine(reinterpret_cast<uintptr_t>(in));
+    }
+    combine(node.outlinks.size());
+  }
+  return hash;
+}
+
 std::vector<mir::Node *> SSAGraph::StmtTopologicalOrder() {
+  const uint64_t signature = TopologySignature();
+  if (stmt_order_valid_ && signature == stmt_order_signature_) {
+    return stmt_order_;
+  }
   CheckBidirectionalConnection();
 
-  std::stack<mir::Node *> stack;
-  std::set<mir::Node *, NodeComp> visited;
-  std::vector<mir::Node *> res;
-
-  auto adj_list = BuildOperationAdjList();
+  // Visit the statements in ascending id order and their producers in
+  // ascending id order as well, then a statement is emitted after all of its
+  // producers. The traversal uses an explicit stack, since the depth of a
+  // chain of statements is the size of the graph.
+  std::vector<mir::Node *> stmts;
+  for (auto &n : node_storage_) {
+    if (n.IsStmt()) stmts.push_back(&n);
+  }
+  std::stable_sort(stmts.begin(),
+                   stmts.end(),
+                   [](const mir::Node *a, const mir::Node *b) {
+                     return a->get_id() < b->get_id();
+                   });
+  std::unordered_map<const mir::Node *, size_t> stmt_idx;
+  stmt_idx.reserve(stmts.size());
+  for (size_t i = 0; i < stmts.size(); i++) {
+    stmt_idx[stmts[i]] = i;
+  }
+  std::vector<std::vector<size_t>> producers(stmts.size());
+  for (size_t i = 0; i < stmts.size(); i++) {
+    auto &adj = producers[i];
+    for (auto *var : stmts[i]->inlinks) {
+      for (auto *adj_n : var->inlinks) {
+        CHECK(adj_n->IsStmt());
+        adj.push_back(stmt_idx.at(adj_n));
+      }
+    }
+    std::sort(adj.begin(), adj.end());
+    adj.erase(std::unique(adj.begin(), adj.end()), adj.end());
+  }
 
-  for (auto adj : adj_list) {
-    if (visited.find(adj.first) == visited.end()) {
-      SortHelper(adj_list, adj.first, &visited, &res);
+  std::vector<mir::Node *> res;
+  res.reserve(stmts.size());
+  std::vector<bool> visited(stmts.size(), false);
+  std::vector<std::pair<size_t, size_t>> stack;
+  for (size_t root = 0; root < stmts.size(); root++) {
+    if (visited[root]) continue;
+    visited[root] = true;
+    stack.emplace_back(root, 0);
+    while (!stack.empty()) {
+      auto &top = stack.back();
+      if (top.second < producers[top.first].size()) {
+        size_t next = producers[top.first][top.second++];
+        if (!visited[next]) {
+          visited[next] = true;
+          stack.emplace_back(next, 0);
+        }
+      } else {
+        res.push_back(stmts[top.first]);
+        stack.pop_back();
+      }
     }
   }
 
+  stmt_order_ = res;
+  stmt_order_signature_ = signature;
+  stmt_order_valid_ = true;
   return res;
 }
 
@@ -134,19 +204,76 @@ std::vector<mir::Node *> SSAGraph::NodeTopologicalOrder() {
   return res;
 }
 
+mir::Node *SSAGraph::AddNode() {
+  node_storage_.emplace_back();
+  node_pos_[&node_storage_.back()] = std::prev(node_storage_.end());
+  return &node_storage_.back();
+}
+
+void SSAGraph::AddStmtToIndex(mir::Node *node) {
+  std::string op_type;
+  if (node->IsStmt() && node->stmt()->op() && node->stmt()->op()->op_info()) {
+    op_type = node->stmt()->op_type();
+    stmt_type_index_[op_type].insert(node);
+  }
+  stmt_indexed_type_[node] = op_type;
+}
+
+void SSAGraph::RebuildNodeIndex() {
+  node_pos_.clear();
+  stmt_type_index_.clear();
+  stmt_indexed_type_.clear();
+  for (auto it = node_storage_.begin(); it != node_storage_.end(); ++it) {
+    node_pos_[&*it] = it;
+    if (!it->IsArg()) AddStmtToIndex(&*it);
+  }
+}
+
+void SSAGraph::SyncStmtTypeIndex() {
+  if (node_pos_.size() != node_storage_.size()) {
+    RebuildNodeIndex();
+    return;
+  }
+  // The op of a statement can be reset in place, e.g. by ResetOp.
+  for (auto &item : stmt_indexed_type_) {
+    auto *node = item.first;
+    std::string op_type;
+    if (node->IsStmt() && node->stmt()->op() && node->stmt()->op()->op_info()) {
+      op_type = node->stmt()->op_type();
+    }
+    if (op_type == item.second) continue;
+    if (!item.second.empty()) stmt_type_index_[item.second].erase(node);
+    if (!op_type.empty()) stmt_type_index_[op_type].insert(node);
+    item.second = op_type;
+  }
+}
+
+std::vector<mir::Node *> SSAGraph::StmtNodesOfType(const std::string &op_type) {
+  SyncStmtTypeIndex();
+  std::vector<mir::Node *> res;
+  auto it = stmt_type_index_.find(op_type);
+  if (it == stmt_type_index_.end()) return res;
+  res.assign(it->second.begin(), it->second.end());
+  std::stable_sort(
+      res.begin(), res.end(), [](const mir::Node *a, const mir::Node *b) {
+        return a->get_id() < b->get_id();
+      });
+  return res;
+}
+
 Node *SSAGraph::GraphCreateInstructNode(
     const std::shared_ptr<OpLite> &op, const std::vector<Place> &valid_places) {
-  node_storage_.emplace_back();
+  auto &new_node = *AddNode();
   // TODO(Superjomn) remove one valid_places here.
   op->SetValidPlaces(valid_places);
-  auto &new_node = node_storage_.back();
   new_node.set_id(num_node_created_++);
   auto kernels = op->CreateKernels(valid_places);
-  node_storage_.back().AsStmt(op->op_type_, std::move(kernels), op);
+  new_node.AsStmt(op->op_type_, std::move(kernels), op);
+  AddStmtToIndex(&new_node);
 
   CHECK(new_node.inlinks.empty()) << "duplicate Build found";
   CHECK(new_node.outlinks.empty()) << "duplicate Build found";
-  return &node_storage_.back();
+  return &new_node;
 }
 
 void SSAGraph::Build(const Program &program,
@@ -155,11 +282,10 @@ void SSAGraph::Build(const Program &program,
   CHECK(node_storage_.empty());
 
   block_idx_ = block_idx;
-  auto weights = program.weights();
+  std::set<std::string> weights(program.weights().begin(),
+                                program.weights().end());
   auto is_weight = [&](const std::string &name) -> bool {
-    auto it = std::find(weights.begin(), weights.end(), name);
-    if (it == weights.end()) return false;
-    return true;
+    return weights.count(name) > 0;
   };
 
   auto var_type_map = program.var_type_map();
@@ -174,8 +300,7 @@ void SSAGraph::Build(const Program &program,
       if (arg_update_node_map.count(var_name)) {
         arg_node = arg_update_node_map.at(var_name);
       } else {
-        node_storage_.emplace_back();
-        arg_node = &node_storage_.back();
+        arg_node = AddNode();
         arg_node->AsArg(var_name, node_storage_.size() - 1);
         arg_update_node_map[var_name] = arg_node;
       }
@@ -197,8 +322,7 @@ void SSAGraph::Build(const Program &program,
       DirectedLink(arg_node, op_node);
     }
     for (const auto &var_name : op->op_info()->output_names()) {
-      node_storage_.emplace_back();
-      auto *arg_node = &node_storage_.back();
+      auto *arg_node = AddNode();
       arg_node->AsArg(var_name, node_storage_.size() - 1);
       arg_update_node_map[var_name] = arg_node;
       if (var_type_map.count(var_name) && !arg_node->arg()->type) {
@@ -209,31 +333,41 @@ void SSAGraph::Build(const Program &program,
       CHECK(arg_node->IsRoleSet());
       DirectedLink(op_node, arg_node);
     }
-    CHECK(CheckLinksRoleSet());
   }
 
+  CHECK(CheckLinksRoleSet());
   CHECK(CheckNodesRoleSet());
   CheckValid();
 }
 
 void SSAGraph::RemoveNode(const mir::Node *node) {
-  auto pos = std::find_if(node_storage_.begin(),
-                          node_storage_.end(),
-                          [&node](mir::Node &n) { return &n == node; });
-  CHECK(pos != node_storage_.end());
-  node_storage_.erase(pos);
+  if (node_pos_.size() != node_storage_.size()) RebuildNodeIndex();
+  auto pos = node_pos_.find(node);
+  CHECK(pos != node_pos_.end());
+  auto indexed = stmt_indexed_type_.find(const_cast<mir::Node *>(node));
+  if (indexed != stmt_indexed_type_.end()) {
+    if (!indexed->second.empty()) {
+      stmt_type_index_[indexed->second].erase(indexed->first);
+    }
+    stmt_indexed_type_.erase(indexed);
+  }
+  node_storage_.erase(pos->second);
+  node_pos_.erase(pos);
 }
 
 void SSAGraph::CloneFrom(const SSAGraph &from) {
   node_storage_.clear();
+  node_pos_.clear();
+  stmt_type_index_.clear();
+  stmt_indexed_type_.clear();
+  stmt_order_valid_ = false;
   arguments_.clear();
   valid_places_ = from.valid_places_;
 
   std::map<const mir::Node *, mir::Node *> clone_node_map;
   for (const auto &node : from.node_storage_) {
     if (node.IsArg()) {
-      node_storage_.emplace_back();
-      auto &new_node = node_storage_.back();
+      auto &new_node = *AddNode();
       new_node.AsArg() = *node.arg();
       clone_node_map.emplace(&node, &new_node);
     } else {
@@ -319,17 +453,18 @@ bool SSAGraph::CheckLinksRoleSet() {
 }
 
 Node *SSAGraph::NewArgumentNode(const std::string &name) {
-  node_storage_.emplace_back();
-  auto &arg_node = node_storage_.back();
+  auto &arg_node = *AddNode();
   arg_node.AsArg(name, node_storage_.size() - 1);
   arg_node.set_id(num_node_created_++);
   return &arg_node;
 }
 
 Node *SSAGraph::NewInstructNode() {
-  node_storage_.emplace_back();
-  node_storage_.back().set_id(num_node_created_++);
-  return &node_storage_.back();
+  auto *node = AddNode();
+  node->set_id(num_node_created_++);
+  // The op is set by the caller, SyncStmtTypeIndex indexes it later.
+  stmt_indexed_type_[node] = "";
+  return node;
 }
 
 std::string SSAGraph::dump() {
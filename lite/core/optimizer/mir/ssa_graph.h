@@ -20,6 +20,7 @@
 #include <set>
 #include <stack>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "lite/core/kernel.h"
 #include "lite/core/op_lite.h"
@@ -53,11 +54,15 @@ class SSAGraph : GraphBase {
   void Build(const Program &program,
              const std::vector<Place> &valid_places,
              int block_idx = kRootBlockIdx);
+  // Remove a node from the graph in O(1), the links of the neighbors are not
+  // touched, see GraphSafeRemoveNodes.
   void RemoveNode(const mir::Node *node);
 
   // Clone from another SSAGraph, all mir::Node(s) are duplicated.
   void CloneFrom(const SSAGraph &from);
 
+  // The order is cached and rebuilt only when the nodes or links of the graph
+  // have changed since the last call.
   std::vector<mir::Node *> StmtTopologicalOrder();
 
   std::vector<mir::Node *> NodeTopologicalOrder();
@@ -73,6 +78,10 @@ class SSAGraph : GraphBase {
 
   mir::Node *RetrieveArgument(const std::string &arg);
 
+  // The statements of op_type in ascending id order. They are looked up from
+  // an index kept up to date with the graph instead of scanning every node.
+  std::vector<mir::Node *> StmtNodesOfType(const std::string &op_type);
+
   Node *NewArgumentNode(const std::string &name);
   Node *NewInstructNode();
 
@@ -95,6 +104,16 @@ class SSAGraph : GraphBase {
 
  private:
   mir::Node *Argument(const std::string &name);
+  // Append a node to node_storage_ and record its position.
+  mir::Node *AddNode();
+  void AddStmtToIndex(mir::Node *node);
+  // Rebuild the node positions when node_storage_ is edited directly.
+  void RebuildNodeIndex();
+  // Move the statements whose op type changed to the right index entry.
+  void SyncStmtTypeIndex();
+  // A hash of the nodes and links, the cached statement order is valid as
+  // long as it does not change.
+  uint64_t TopologySignature() const;
   // Check the bidirectional connection.
   bool CheckBidirectionalConnection();
   bool CheckNodesRoleSet();
@@ -125,6 +144,16 @@ class SSAGraph : GraphBase {
  private:
   std::list<mir::Node> node_storage_;
   std::map<std::string, mir::Node *> arguments_;
+  std::unordered_map<const mir::Node *, std::list<mir::Node>::iterator>
+      node_pos_;
+  // op type -> statements, and the op type each statement is indexed by, the
+  // type is empty when the op is not set yet.
+  std::unordered_map<std::string, std::set<mir::Node *, NodeCompV2>>
+      stmt_type_index_;
+  std::unordered_map<mir::Node *, std::string> stmt_indexed_type_;
+  std::vector<mir::Node *> stmt_order_;
+  uint64_t stmt_order_signature_{0};
+  bool stmt_order_valid_{false};
   std::vector<Place> valid_places_;
   int block_idx_ = kRootBlockIdx;
   int num_node_created_ = 0;
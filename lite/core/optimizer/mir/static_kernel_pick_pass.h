@@ -256,6 +256,7 @@ class StaticKernelPickPass : public mir::StmtPass {
 
   // Compatible for PrecisionType.
   // For cuda, in the process of choosing kernel, fp16 and fp32 are compatiable.
+  // For x86, bf16 and fp32 are compatiable too.
   // If kernel's declared type is kAny, it is matched.
   bool PrecTypeCompatible(const PrecisionType& p1, const PrecisionType& p2) {
     if (p1 == p2 || p2 == PRECISION(kAny)) {
@@ -263,6 +264,9 @@ class StaticKernelPickPass : public mir::StmtPass {
     } else if ((p1 == PRECISION(kFP16) || p1 == PRECISION(kFloat)) &&
                (p2 == PRECISION(kFP16) || p2 == PRECISION(kFloat))) {
       return true;
+    } else if ((p1 == PRECISION(kBF16) || p1 == PRECISION(kFloat)) &&
+               (p2 == PRECISION(kBF16) || p2 == PRECISION(kFloat))) {
+      return true;
     } else {
       return false;
     }
@@ -230,7 +230,12 @@ void PrecisionCastPass::ComplementInputs(
   }
   has_fp16 = has_fp16 && (in->AsArg().is_weight);
   VLOG(4) << "has_fp16: " << has_fp16 << ", arg_name: " << in->AsArg().name;
-  if ((!has_fp16) &&
+  // The fp32 weights of x86 bf16 kernels are converted by the predictor
+  // according to the attribute set by bf16_attribute_pass.
+  bool has_bf16 = in->AsArg().is_weight &&
+                  input_decl_type->target() == TARGET(kX86) &&
+                  input_decl_type->precision() == PRECISION(kBF16);
+  if ((!has_fp16) && (!has_bf16) &&
       !PrecisionCompatibleTo(*in->AsArg().type, *input_decl_type)) {
     VLOG(4) << "found Target unmatched tensor: " << in->AsArg().name
             << " for kernel " << inst.op()->DebugString() << " "
@@ -167,7 +167,8 @@ class VariablePlaceInferencePass : public DebugPass {
             SetWeightType(in_node, **var_type, with_targets);
           } else if (decl_type->precision() == PRECISION(kInt8) ||
                      (decl_type->precision() == PRECISION(kFP16) &&
-                      decl_type->target() != TARGET(kOpenCL))) {
+                      decl_type->target() != TARGET(kOpenCL)) ||
+                     decl_type->precision() == PRECISION(kBF16)) {
             *var_type = decl_type;
           } else {
             // If is quantization, infer the Int8 type.
@@ -200,7 +201,8 @@ class VariablePlaceInferencePass : public DebugPass {
           // If is quantization, infer the Int8 type.
           if (decl_type->precision() == PRECISION(kInt8) ||
               (decl_type->precision() == PRECISION(kFP16) &&
-               decl_type->target() != TARGET(kOpenCL))) {
+               decl_type->target() != TARGET(kOpenCL)) ||
+              decl_type->precision() == PRECISION(kBF16)) {
             *var_type = decl_type;
           } else {
             UpdateTypeFrom(var_type, decl_type);
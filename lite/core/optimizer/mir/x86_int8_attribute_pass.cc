@@ -24,77 +24,62 @@
 namespace paddle {
 namespace lite {
 namespace mir {
-void X86Int8AttributePass::Apply(const std::unique_ptr<SSAGraph>& graph) {
-  std::vector<mir::Node*> nodes;
-  for (auto* node : graph->StmtTopologicalOrder()) {
-    if (node->IsStmt()) {
-      const std::string op_type = node->stmt()->op_type();
-      auto iter = std::find(int8_ops_.begin(), int8_ops_.end(), op_type);
-      if (iter != int8_ops_.end()) {
-        nodes.push_back(node);
+bool X86Int8AttributePass::IsInt8Capable(Node* node) {
+  auto& stmt = node->AsStmt();
+  const OpInfo* op_info = stmt.op_info();
+  const std::string op_type = op_info->Type();
+  if (op_type == "pool2d") {
+    auto ksize = op_info->GetAttr<std::vector<int>>("ksize");
+    auto pooling_type = op_info->GetAttr<std::string>("pooling_type");
+    if (ksize.size() != 2 ||
+        (op_info->HasAttr("adaptive") && op_info->GetAttr<bool>("adaptive")) ||
+        (pooling_type != "max" && pooling_type != "avg")) {
+      return false;
+    }
+  }
+  if (op_type == "concat" && op_info->HasInput("AxisTensor") &&
+      !op_info->Input("AxisTensor").empty()) {
+    return false;
+  }
+  if (node->inlinks.empty()) return false;
+  for (auto* in_node : node->inlinks) {
+    CHECK(in_node->IsArg()) << "The input node should be variable.";
+    const std::string& name = in_node->arg()->name;
+    if (!op_info->HasInputScale(name)) return false;
+    auto scale = op_info->GetInputScale(name);
+    std::string argname;
+    CHECK(op_info->GetInputArgname(name, &argname));
+    if (in_node->arg()->is_weight || in_node->arg()->is_persist) {
+      // Only the quantized Y of matmul may be a weight, and it may have a
+      // scale per column.
+      auto* var = stmt.op()->scope()->FindVar(name);
+      if ((op_type != "matmul" && op_type != "matmul_v2") || argname != "Y" ||
+          var == nullptr ||
+          var->Get<lite::Tensor>().precision() != PRECISION(kInt8)) {
+        return false;
       }
+    } else if (scale.size() != 1) {
+      return false;
     }
   }
+  return true;
+}
 
-  for (auto* node : nodes) {
-    const std::string op_type = node->stmt()->op_type();
-    VLOG(4) << "op_type: " << op_type;
-    OpInfo* op_info = node->stmt()->mutable_op_info();
-    auto* scope = node->stmt()->op()->scope();
-    for (auto* in_node : node->inlinks) {
-      CHECK(in_node->IsArg()) << "The input node should be variable.";
-      bool enable_int8 = op_info->HasAttr("enable_int8") ? true : false;
-      if (enable_int8) {
-        auto weight_name = op_info->Input("Filter").front();
-        auto input_name = op_info->Input("Input").front();
-        auto weight_scale = op_info->GetInputScale(weight_name);
-        auto input_scale = op_info->GetInputScale(input_name);
-        if (op_type == "fc") {
-          weight_scale = op_info->GetInputScale("W0_scale");
-          input_scale = op_info->GetInputScale("Input0_scale");
-          weight_name = op_info->Input("W").front();
-        }
-        auto conv_weight_t =
-            scope->FindVar(weight_name)->GetMutable<lite::Tensor>();
-        auto conv_weight_d = conv_weight_t->data<int8_t>();
-        int out_channel = conv_weight_t->dims()[0];
-        int size = conv_weight_t->data_size() / out_channel;
-        CHECK_EQ(weight_scale.size(), out_channel)
-            << "Int8 size of weight_scale must be equal out_channel, "
-            << " actual size of weight_scale is: " << weight_scale.size()
-            << ", out_channel is: " << out_channel;
-
-        if (op_info->HasInput("Bias") && op_info->Input("Bias").size() > 0) {
-          auto bias_name = op_info->Input("Bias").front();
-          auto conv_bias_t =
-              scope->FindVar(bias_name)->GetMutable<lite::Tensor>();
-          auto conv_bias_d = conv_bias_t->mutable_data<float>();
-          compute_new_bias(conv_bias_d,
-                           conv_weight_d,
-                           conv_bias_d,
-                           weight_scale,
-                           input_scale,
-                           out_channel,
-                           size);
-
-        } else {
-          auto* bias_tensor = scope->NewTensor("new_bias");
-          bias_tensor->Resize({out_channel});
-          // data
-          auto bias_d = bias_tensor->mutable_data<float>();
-          bias_tensor->set_persistable(true);
-          compute_new_bias(bias_d,
-                           conv_weight_d,
-                           nullptr,
-                           weight_scale,
-                           input_scale,
-                           out_channel,
-                           size);
-          op_info->SetInput("Bias", {"new_bias"});
-          node->stmt()->ResetOp(*op_info, graph->valid_places());
-        }
-      }
+void X86Int8AttributePass::Apply(const std::unique_ptr<SSAGraph>& graph) {
+  for (auto* node : graph->StmtTopologicalOrder()) {
+    if (!node->IsStmt()) continue;
+    const OpInfo* op_info = node->AsStmt().op_info();
+    const std::string op_type = op_info->Type();
+    if (std::find(int8_ops_.begin(), int8_ops_.end(), op_type) ==
+            int8_ops_.end() ||
+        op_info->HasAttr("enable_int8") || !IsInt8Capable(node)) {
+      continue;
     }
+    VLOG(4) << "enable int8 of " << op_type;
+    // ResetOp replaces the op info of the op, so a copy is passed
+    auto new_op_info = *op_info;
+    new_op_info.SetAttr<bool>("enable_int8", true);
+    node->AsStmt().ResetOp(new_op_info, graph->valid_places());
   }
 }
 
@@ -25,40 +25,32 @@ namespace paddle {
 namespace lite {
 namespace mir {
 /*
- * Use x86_int8_attribute_pass method to update bias val in model.
- * if int8 op has bias, then bias - 128 * weight_scale * in_scale;
- * else int8 op add bias input, and val is (- 128 * weight * weight_scale *
- * in_scale).
- * x86 int8 compute need int8 val and uint8 val to compute
- * out = (in + 128) * weight * in_ scale * wei_scale + (bias - 128 * weight *
- * in_ scale * wei_scale)
+ * x86_int8_attribute_pass extends the int8 region of a quantized model on
+ * x86. The quant passes only mark the ops with quantized weights (conv2d,
+ * fc, ...) as int8, so every pool2d, elementwise_add, concat or activation
+ * between them dequantizes and requantizes its tensors. The pass sets
+ * enable_int8 on these ops when every input has a per tensor scale, so
+ * static_kernel_pick_pass picks their x86 int8 kernels and the tensors stay
+ * in int8 between the quantized ops.
+ * The bias of the int8 conv2d and fc is not changed here, their gemm
+ * compensates the uint8 offset of the input itself.
  */
 class X86Int8AttributePass : public ProgramPass {
  public:
   void Apply(const std::unique_ptr<SSAGraph>& graph) override;
-  // bias_d = conv_bias_d - 128 * weight_scale * input_scale * conv_weight_d
-  inline void compute_new_bias(float* bias_d,
-                               const int8_t* conv_weight_d,
-                               float* conv_bias_d,
-                               std::vector<float> weight_scale,
-                               std::vector<float> input_scale,
-                               int h,
-                               int w) {
-    for (int i = 0; i < h; i++) {
-      auto bias_val = conv_bias_d ? conv_bias_d[i] : 0.f;
-      float sum = 0.f;
-      float scale = weight_scale[i] * input_scale[0] * 128;
-      const int8_t* wei_ptr = conv_weight_d + i * w;
-      for (int j = 0; j < w; j++) {
-        sum += static_cast<float>(wei_ptr[j]) * scale;
-      }
-      bias_d[i] = bias_val - sum;
-    }
-  }
 
  private:
-  std::vector<std::string> int8_ops_{
-      "conv2d", "depthwise_conv2d", "conv2d_transpose", "fc"};
+  bool IsInt8Capable(Node* node);
+
+  std::vector<std::string> int8_ops_{"pool2d",
+                                     "elementwise_add",
+                                     "elementwise_mul",
+                                     "concat",
+                                     "relu",
+                                     "relu6",
+                                     "leaky_relu",
+                                     "matmul",
+                                     "matmul_v2"};
 };
 
 }  // namespace mir
@@ -0,0 +1,217 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/optimizer/mir/x86_int8_attribute_pass.h"
+#include <gtest/gtest.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "lite/core/op_registry.h"
+#include "lite/core/optimizer/mir/ssa_graph.h"
+#include "lite/core/optimizer/mir/static_kernel_pick_pass.h"
+#include "lite/core/program.h"
+#include "lite/model_parser/cpp_desc.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+using ArgNames = std::map<std::string, std::vector<std::string>>;
+
+static cpp::OpDesc* AddOpDesc(cpp::BlockDesc* block_desc,
+                              const std::string& type,
+                              const ArgNames& inputs,
+                              const ArgNames& outputs) {
+  auto* op_desc = block_desc->AddOp<cpp::OpDesc>();
+  op_desc->SetType(type);
+  for (auto& input : inputs) {
+    op_desc->SetInput(input.first, input.second);
+  }
+  for (auto& output : outputs) {
+    op_desc->SetOutput(output.first, output.second);
+  }
+  return op_desc;
+}
+
+static void AddWeightDesc(cpp::BlockDesc* block_desc,
+                          const std::string& name,
+                          VarDescAPI::Type data_type) {
+  auto* var_desc = block_desc->AddVar<cpp::VarDesc>();
+  var_desc->SetName(name);
+  var_desc->SetType(VarDescAPI::Type::LOD_TENSOR);
+  var_desc->SetDataType(data_type);
+  var_desc->SetPersistable(true);
+}
+
+template <typename T>
+static void AddWeight(Scope* scope, const std::string& name) {
+  auto* tensor = scope->Var(name)->GetMutable<Tensor>();
+  tensor->Resize({8, 4});
+  auto* data = tensor->mutable_data<T>();
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    data[i] = static_cast<T>(i % 7);
+  }
+  tensor->set_persistable(true);
+}
+
+// x = feed
+// pool_out = pool2d(x)                     X0_scale, Out0_scale
+// relu_out = relu(pool_out)                no scale
+// add_out = elementwise_add(pool_out, w)   X0_scale, Y0_scale, w is fp32
+// mm_out = matmul(pool_out, w8)            X0_scale, per column Y0_scale
+// fetch(relu_out, add_out, mm_out)
+class X86Int8Graph {
+ public:
+  X86Int8Graph() {
+    program_desc_ = std::make_shared<cpp::ProgramDesc>();
+    scope_ = std::make_shared<Scope>();
+    auto* block_desc = program_desc_->AddBlock<cpp::BlockDesc>();
+    block_desc->ClearOps();
+    block_desc->ClearVars();
+    for (auto name :
+         {"feed", "fetch", "x", "pool_out", "relu_out", "add_out", "mm_out"}) {
+      block_desc->AddVar<cpp::VarDesc>()->SetName(name);
+    }
+    AddWeightDesc(block_desc, "w", VarDescAPI::Type::FP32);
+    AddWeightDesc(block_desc, "w8", VarDescAPI::Type::INT8);
+    AddWeight<float>(scope_.get(), "w");
+    AddWeight<int8_t>(scope_.get(), "w8");
+
+    AddOpDesc(block_desc, "feed", {{"X", {"feed"}}}, {{"Out", {"x"}}})
+        ->SetAttr<int>("col", 0);
+    auto* pool = AddOpDesc(
+        block_desc, "pool2d", {{"X", {"x"}}}, {{"Out", {"pool_out"}}});
+    pool->SetAttr<std::string>("pooling_type", "max");
+    pool->SetAttr<std::vector<int>>("ksize", {2, 2});
+    pool->SetAttr<std::vector<int>>("strides", {2, 2});
+    pool->SetAttr<std::vector<int>>("paddings", {0, 0});
+    pool->SetAttr<bool>("global_pooling", false);
+    pool->SetAttr<std::vector<float>>("X0_scale", {0.1f});
+    pool->SetAttr<std::vector<float>>("Out0_scale", {0.1f});
+    AddOpDesc(
+        block_desc, "relu", {{"X", {"pool_out"}}}, {{"Out", {"relu_out"}}});
+    auto* add = AddOpDesc(block_desc,
+                          "elementwise_add",
+                          {{"X", {"pool_out"}}, {"Y", {"w"}}},
+                          {{"Out", {"add_out"}}});
+    add->SetAttr<int>("axis", -1);
+    add->SetAttr<std::vector<float>>("X0_scale", {0.1f});
+    add->SetAttr<std::vector<float>>("Y0_scale", {0.05f});
+    auto* matmul = AddOpDesc(block_desc,
+                             "matmul",
+                             {{"X", {"pool_out"}}, {"Y", {"w8"}}},
+                             {{"Out", {"mm_out"}}});
+    matmul->SetAttr<bool>("transpose_X", false);
+    matmul->SetAttr<bool>("transpose_Y", false);
+    matmul->SetAttr<float>("alpha", 1.f);
+    matmul->SetAttr<std::vector<float>>("X0_scale", {0.1f});
+    matmul->SetAttr<std::vector<float>>("Y0_scale",
+                                        {0.01f, 0.02f, 0.03f, 0.04f});
+    int col = 0;
+    for (auto name : {"relu_out", "add_out", "mm_out"}) {
+      AddOpDesc(block_desc, "fetch", {{"X", {name}}}, {{"Out", {"fetch"}}})
+          ->SetAttr<int>("col", col++);
+    }
+
+    std::vector<Place> valid_places{
+        Place{TARGET(kX86), PRECISION(kInt8)},
+        Place{TARGET(kX86), PRECISION(kFloat)},
+        Place{TARGET(kHost), PRECISION(kAny)},
+    };
+    program_.reset(new Program(program_desc_, scope_, valid_places));
+    graph_.reset(new SSAGraph());
+    graph_->Build(*program_, valid_places);
+    graph_->SetValidPlaces(valid_places);
+  }
+
+  const std::unique_ptr<SSAGraph>& graph() { return graph_; }
+
+  Node* FindOp(const std::string& type) {
+    for (auto* node : graph_->StmtTopologicalOrder()) {
+      if (node->AsStmt().op_type() == type) return node;
+    }
+    return nullptr;
+  }
+
+  bool Int8Enabled(const std::string& type) {
+    auto* op_info = FindOp(type)->AsStmt().op_info();
+    return op_info->HasAttr("enable_int8") &&
+           op_info->GetAttr<bool>("enable_int8");
+  }
+
+  // The alias of the kernel picked by static_kernel_pick_pass
+  std::string PickedKernel(const std::string& type) {
+    auto& kernels = FindOp(type)->AsStmt().kernels();
+    if (kernels.size() != 1) return "";
+    return kernels.front()->alias();
+  }
+
+ private:
+  std::shared_ptr<cpp::ProgramDesc> program_desc_;
+  std::shared_ptr<Scope> scope_;
+  std::unique_ptr<Program> program_;
+  std::unique_ptr<SSAGraph> graph_;
+};
+
+TEST(x86_int8_attribute_pass, enable_int8) {
+  X86Int8Graph test_graph;
+  X86Int8AttributePass pass;
+  pass.Apply(test_graph.graph());
+
+  // every input has a per tensor scale, or is an int8 weight of matmul
+  EXPECT_TRUE(test_graph.Int8Enabled("pool2d"));
+  EXPECT_TRUE(test_graph.Int8Enabled("matmul"));
+  // relu has no scale, the Y of elementwise_add is a fp32 weight
+  EXPECT_FALSE(test_graph.Int8Enabled("relu"));
+  EXPECT_FALSE(test_graph.Int8Enabled("elementwise_add"));
+}
+
+TEST(x86_int8_attribute_pass, static_kernel_pick) {
+  // the pass runs before static_kernel_pick_pass as in the optimizer
+  X86Int8Graph test_graph;
+  X86Int8AttributePass int8_pass;
+  int8_pass.Apply(test_graph.graph());
+  StaticKernelPickPass pick_pass;
+  pick_pass.mutable_kernel_pick_factors()->ConsiderTarget();
+  pick_pass.mutable_kernel_pick_factors()->ConsiderPrecision();
+  pick_pass.Apply(test_graph.graph());
+
+  // relu and elementwise_add read the output of pool2d in fp32
+  EXPECT_EQ(test_graph.PickedKernel("pool2d"), "fp32_out");
+  EXPECT_EQ(test_graph.PickedKernel("matmul"), "fp32_out");
+  EXPECT_EQ(test_graph.PickedKernel("relu"), "def");
+  EXPECT_EQ(test_graph.PickedKernel("elementwise_add"), "def");
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_OP(feed);
+USE_LITE_OP(fetch);
+USE_LITE_OP(pool2d);
+USE_LITE_OP(relu);
+USE_LITE_OP(elementwise_add);
+USE_LITE_OP(matmul);
+USE_LITE_KERNEL(pool2d, kX86, kInt8, kNCHW, int8_out);
+USE_LITE_KERNEL(pool2d, kX86, kInt8, kNCHW, fp32_out);
+USE_LITE_KERNEL(matmul, kX86, kInt8, kNCHW, int8_out);
+USE_LITE_KERNEL(matmul, kX86, kInt8, kNCHW, fp32_out);
+USE_LITE_KERNEL(elementwise_add, kX86, kInt8, kNCHW, int8_out);
+USE_LITE_KERNEL(elementwise_add, kX86, kInt8, kNCHW, fp32_out);
+USE_LITE_KERNEL(elementwise_add, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(relu, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(feed, kHost, kAny, kAny, def);
+USE_LITE_KERNEL(fetch, kHost, kAny, kAny, def);
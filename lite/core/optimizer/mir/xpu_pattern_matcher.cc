@@ -14,7 +14,9 @@
 
 #include <algorithm>
 #include <array>
+#include <functional>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include "lite/core/op_lite.h"
@@ -50,12 +52,10 @@ void XPUPatternMatcher::operator()(SSAGraph *graph,
 bool XPUPatternMatcher::MarkPMNodesInGraph(SSAGraph *graph) {
   VLOG(3) << "mark pmnodes in graph";
   if (graph->nodes().empty()) return false;
-  for (auto &node : graph->mutable_nodes()) {
-    for (const auto &pmnode : pattern_.nodes()) {
-      if (pmnode->Tell(&node)) {
-        pmnodes2nodes_[pmnode.get()].insert(&node);
-      }
-    }
+  for (const auto &pmnode : pattern_.nodes()) {
+    std::set<Node *> nodes;
+    MarkMatchedNodes(graph, pmnode.get(), &nodes);
+    if (!nodes.empty()) pmnodes2nodes_[pmnode.get()] = std::move(nodes);
   }
   // Check to early stop if some PMNode can't find matched Node.
   for (auto &pmnode : pattern_.nodes()) {
@@ -173,22 +173,71 @@ std::vector<PatternMatcher::subgraph_t> XPUPatternMatcher::DetectPatterns() {
     cur_groups.clear();
     if (pre_groups.empty()) break;
     // source -> target
-    for (Node *source : pmnodes2nodes_[edge.first]) {
-      for (Node *target : pmnodes2nodes_[edge.second]) {
-        // TODO(Superjomn) add some prune strategies.
-        for (const auto &group : pre_groups) {
-          if (IsNodesLink(source, target)) {
-            HitGroup new_group = group;
-            bool flag = new_group.Match(source, edge.first) &&
-                        new_group.Match(target, edge.second);
-            if (flag) {
-              new_group.Register(source, edge.first);
-              new_group.Register(target, edge.second);
-              cur_groups.push_back(new_group);
-              // TODO(Superjomn) need to unique
-            }
+    // Only the links of the node a group already holds are followed, instead
+    // of testing every pair of candidates for every group. The hits are
+    // sorted to keep the order of the pairwise search.
+    const auto &sources = pmnodes2nodes_[edge.first];
+    const auto &targets = pmnodes2nodes_[edge.second];
+    std::vector<std::tuple<Node *, Node *, size_t>> hits;
+    auto add_hits_from = [&](Node *source, size_t group_idx) {
+      std::vector<Node *> seen;
+      for (auto *target : source->outlinks) {
+        if (targets.count(target) &&
+            std::find(seen.begin(), seen.end(), target) == seen.end()) {
+          seen.push_back(target);
+          hits.emplace_back(source, target, group_idx);
+        }
+      }
+    };
+    for (size_t i = 0; i < pre_groups.size(); i++) {
+      const auto &roles = pre_groups[i].roles;
+      auto source_role = roles.find(edge.first);
+      auto target_role = roles.find(edge.second);
+      if (source_role != roles.end()) {
+        if (sources.count(source_role->second)) {
+          add_hits_from(source_role->second, i);
+        }
+      } else if (target_role != roles.end()) {
+        Node *target = target_role->second;
+        if (!targets.count(target)) continue;
+        std::vector<Node *> seen;
+        for (auto *source : target->inlinks) {
+          if (sources.count(source) && IsNodesLink(source, target) &&
+              std::find(seen.begin(), seen.end(), source) == seen.end()) {
+            seen.push_back(source);
+            hits.emplace_back(source, target, i);
           }
         }
+      } else {
+        for (auto *source : sources) {
+          add_hits_from(source, i);
+        }
+      }
+    }
+    std::sort(hits.begin(),
+              hits.end(),
+              [](const std::tuple<Node *, Node *, size_t> &a,
+                 const std::tuple<Node *, Node *, size_t> &b) {
+                std::less<Node *> less;
+                if (std::get<0>(a) != std::get<0>(b)) {
+                  return less(std::get<0>(a), std::get<0>(b));
+                }
+                if (std::get<1>(a) != std::get<1>(b)) {
+                  return less(std::get<1>(a), std::get<1>(b));
+                }
+                return std::get<2>(a) < std::get<2>(b);
+              });
+    for (const auto &hit : hits) {
+      Node *source = std::get<0>(hit);
+      Node *target = std::get<1>(hit);
+      HitGroup new_group = pre_groups[std::get<2>(hit)];
+      bool flag = new_group.Match(source, edge.first) &&
+                  new_group.Match(target, edge.second);
+      if (flag) {
+        new_group.Register(source, edge.first);
+        new_group.Register(target, edge.second);
+        cur_groups.push_back(new_group);
+        // TODO(Superjomn) need to unique
       }
     }
     VLOG(3) << "step " << step << " get records: " << cur_groups.size();
@@ -19,6 +19,7 @@
 #include "lite/core/optimizer/mir/type_target_cast_pass.h"
 #include "lite/model_parser/model_parser.h"
 #include "lite/utils/all.h"
+#include "lite/utils/timer.h"
 
 namespace paddle {
 namespace lite {
@@ -53,6 +54,7 @@ std::unique_ptr<RuntimeProgram> Optimizer::Run(Program&& program) {
   SpecifyKernelPickTactic(kernel_pick_factor_);
   InitTargetTypeTransformPass();
   InitControlFlowOpSharedInputsAndOutputsPlaceSyncPass();
+  InitMemoryOptimizePass();
 
   ApplyPasses(&graphs_);
 
@@ -97,6 +99,14 @@ void Optimizer::InitControlFlowOpSharedInputsAndOutputsPlaceSyncPass() {
   pass->SetAllGraphs(&graphs_);
 }
 
+void Optimizer::InitMemoryOptimizePass() {
+  auto* pass = mir::PassManager::Global().LookUp<mir::MemoryOptimizePass>(
+      "memory_optimize_pass");
+  CHECK(pass);
+  CHECK(!graphs_.empty());
+  pass->SetAllGraphs(&graphs_);
+}
+
 void Optimizer::ApplyPasses(
     std::vector<std::unique_ptr<mir::SSAGraph>>* graphes) {
   for (auto& pass : passes_) {
@@ -111,6 +121,8 @@ void Optimizer::ApplyPasses(
       LOG(INFO) << "   - Skip " << pass->name()
                 << " because the target or kernel does not match.";
     } else {
+      Timer timer;
+      timer.Start();
       // Check the pass whether it is supported for processing subblocks
       if (kSubblockUnsupportedPasses.count(pass->name()) ||
           kSubblockSkippedPasses.count(pass->name())) {
@@ -120,7 +132,8 @@ void Optimizer::ApplyPasses(
           pass->Apply(graph);
         }
       }
-      LOG(INFO) << "== Finished running: " << pass->name();
+      LOG(INFO) << "== Finished running: " << pass->name() << ", "
+                << timer.Stop() << " ms";
     }
   }
 }
@@ -148,6 +161,8 @@ std::unique_ptr<RuntimeProgram> RunDefaultOptimizer(
        "reshape_calc_offline_pass",
        "unsqueeze_calc_offline_pass",
        "scale_calc_offline_pass",
+       // Fold the rest of the ops whose inputs are all persistable
+       "constant_folding_pass",
        // A minimal set of op fusion pass.
        "op_fusion_minimal_set_pass",
        // For the fully quantization model, the quantization parameters of the
@@ -165,7 +180,10 @@ std::unique_ptr<RuntimeProgram> RunDefaultOptimizer(
        // Please notify @hong19860320 and @zhupengyang for code review if you
        // want to insert a pass in the above passes.
        "remove_scale1_pass",
+       // Before lite_fc_fuse_pass, which breaks the encoder pattern.
+       "x86_multi_encoder_fuse_pass",
        "adaptive_1x1_pool2d_convert_global_pass",  //
+       "kv_cache_append_fuse_pass",                //
        "lite_unsqueeze2_pad3d_squeeze2_fuse_pass",
        "lite_conv_elementwise_fuse_pass",  // conv-elemwise-bn
        "lite_conv_bn_fuse_pass",           //
@@ -174,6 +192,8 @@ std::unique_ptr<RuntimeProgram> RunDefaultOptimizer(
        // TODO(Superjomn) Refine the fusion related design to select fusion
        // kernels for devices automatically.
        "lite_sigmoid_elementmul_fuse_pass",           //
+       // Before lite_conv_activation_fuse_pass, which breaks the SE pattern.
+       "x86_squeeze_excitation_fuse_pass",            //
        "lite_conv_activation_fuse_pass",              //
        "lite_squeeze2_matmul_fuse_pass",              //
        "lite_reshape2_matmul_fuse_pass",              //
@@ -197,11 +217,13 @@ std::unique_ptr<RuntimeProgram> RunDefaultOptimizer(
        "lite_conv_scale_fuse_pass",
        "lite_conv_elementwise_tree_fuse_pass",
        "transformer_attention_fuse_pass",
+       "lite_embedding_seq_pool_fuse_pass",
        "lite_greater_than_cast_fuse_pass",
        "identity_dropout_eliminate_pass",
        "sparse_conv_detect_pass",
        //  "keepdims_convert_pass",
        "__xpu__max_pooling_pad_zero_detect_fuse_pass",
+       "graph_dedup_pass",
        "__xpu__graph_dedup_pass",
        "__xpu__resnet_fuse_pass",
        "__xpu__conv2d_affine_channel_fuse_pass",
@@ -237,6 +259,8 @@ std::unique_ptr<RuntimeProgram> RunDefaultOptimizer(
        "__xpu__matmul_scale_softmax_v1_fuse_pass",
        "__xpu__up_decoder_fuse_pass",
        "__xpu__multi_up_decoder_fuse_pass",
+       // mark the ops between the quantized ops of x86 as int8
+       "x86_int8_attribute_pass",
        // pick original kernel from graph (exclude xpu)
        "static_kernel_pick_pass",
        // xpu pick original kernel from graph
@@ -315,11 +339,12 @@ std::unique_ptr<RuntimeProgram> RunDefaultOptimizer(
             passes_local.begin(), passes_local.end(), "lite_conv_bn_fuse_pass"),
         passes_local.end());
     // duplicated nodes can't be removed if referenced in different subgraphs
-    passes_local.erase(std::remove(passes_local.begin(),
-                                   passes_local.end(),
-                                   "__xpu__graph_dedup_pass"),
-                       passes_local.end());
-    LOG(INFO) << "skip __xpu__graph_dedup_pass because of multiple subgraphs["
+    for (auto pass : {"graph_dedup_pass", "__xpu__graph_dedup_pass"}) {
+      passes_local.erase(
+          std::remove(passes_local.begin(), passes_local.end(), pass),
+          passes_local.end());
+    }
+    LOG(INFO) << "skip graph_dedup_pass because of multiple subgraphs["
               << program.block_size() << "]";
   }
 
@@ -329,6 +354,7 @@ std::unique_ptr<RuntimeProgram> RunDefaultOptimizer(
   const std::string pqd_pass{"post_quant_dynamic_pass"};
   const std::string pqd_depend_pass{"lite_quant_dequant_fuse_pass"};
   const std::string fp16_pass{"fp16_attribute_pass"};
+  const std::string bf16_pass{"bf16_attribute_pass"};
 
   for (const std::string& pass : passes) {
     if (pass == pqd_pass) {
@@ -349,6 +375,12 @@ std::unique_ptr<RuntimeProgram> RunDefaultOptimizer(
       }
     }
   }
+  for (auto place : valid_places) {
+    if (place.target == TARGET(kX86) && place.precision == PRECISION(kBF16)) {
+      passes_local.push_back(bf16_pass);
+      break;
+    }
+  }
   for (auto& pass_name : passes_local) {
     optim.AddPass(pass_name);
   }
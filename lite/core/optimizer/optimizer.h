@@ -19,9 +19,11 @@
 #include <string>
 #include <utility>
 #include <vector>
+#include "lite/core/optimizer/mir/bf16_attribute_pass.h"
 #include "lite/core/optimizer/mir/control_flow_op_shared_inputs_and_outputs_place_sync_pass.h"
 #include "lite/core/optimizer/mir/fp16_attribute_pass.h"
 #include "lite/core/optimizer/mir/generate_program_pass.h"
+#include "lite/core/optimizer/mir/memory_optimize_pass.h"
 #include "lite/core/optimizer/mir/pass_manager.h"
 #include "lite/core/optimizer/mir/pass_utils.h"
 #include "lite/core/optimizer/mir/post_quant_dynamic_pass.h"
@@ -38,7 +40,7 @@ namespace lite {
 
 // TODO(hong1986032) Support the following passes for the subblocks
 const std::set<std::string> kSubblockUnsupportedPasses(
-    {"memory_optimize_pass", "xpu_memory_optimize_pass"});
+    {"xpu_memory_optimize_pass"});
 
 const std::set<std::string> kSubblockSkippedPasses(
     {"fill_constant_calc_offline_pass",
@@ -84,6 +86,7 @@ class Optimizer {
   void InitTargetTypeTransformPass();
   void InitControlFlowOpUnusedInputsAndOutputsEliminatePass();
   void InitControlFlowOpSharedInputsAndOutputsPlaceSyncPass();
+  void InitMemoryOptimizePass();
   void SpecifyKernelPickTactic(core::KernelPickFactor factor);
   Scope* exec_scope() { return exec_scope_; }
 
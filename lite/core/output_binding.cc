@@ -0,0 +1,131 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/output_binding.h"
+#include <memory>
+
+namespace paddle {
+namespace lite {
+
+namespace {
+// The targets whose memory is allocated by the host allocator.
+bool IsHostMemory(TargetType target) {
+  return target == TARGET(kHost) || target == TARGET(kX86) ||
+         target == TARGET(kARM);
+}
+
+// The bound memory shared with an output. An output outgrowing it, e.g. after
+// the input shapes change, is allocated by the buffer instead, and Sync copies
+// it into the bound memory if it fits.
+class BoundBuffer : public Buffer {
+ public:
+  BoundBuffer(void* data, TargetType target, size_t size)
+      : Buffer(data, target, size) {}
+
+  void ResetLazy(TargetType target, size_t size) override {
+    if (!own_data_ && (target != target_ || space_ < size)) {
+      data_ = nullptr;
+      space_ = 0;
+      own_data_ = true;
+    }
+    Buffer::ResetLazy(target, size);
+  }
+};
+}  // namespace
+
+void OutputBinding::Bind(size_t offset,
+                         void* data,
+                         size_t memory_size,
+                         TargetType target) {
+  CHECK(data) << "The memory bound to output " << offset << " is null.";
+  CHECK(IsHostMemory(target)) << "Only the host memory can be bound to an "
+                                 "output, but received "
+                              << lite_api::TargetToStr(target);
+  Binding binding;
+  binding.data = data;
+  binding.memory_size = memory_size;
+  binding.target = target;
+  bindings_[offset] = binding;
+}
+
+void OutputBinding::Unbind(size_t offset, Tensor* output) {
+  auto it = bindings_.find(offset);
+  if (it == bindings_.end()) return;
+  if (output->raw_data() == it->second.data) {
+    auto buffer = std::make_shared<Buffer>();
+    buffer->ResetLazy(output->target(), output->memory_size());
+    TargetCopy(TARGET(kHost),
+               buffer->data(),
+               output->raw_data(),
+               output->memory_size());
+    output->ResetBuffer(buffer, output->memory_size());
+  }
+  bindings_.erase(it);
+}
+
+Tensor* OutputBinding::GetOutput(Scope* scope,
+                                 const std::vector<std::string>& output_names,
+                                 size_t offset) const {
+  CHECK_LT(offset, output_names.size())
+      << "The network has " << output_names.size()
+      << " outputs, but output " << offset << " is bound.";
+  auto* var = scope->FindVar(output_names[offset]);
+  CHECK(var) << "no fetch variable " << output_names[offset]
+             << " in exec_scope";
+  return var->GetMutable<Tensor>();
+}
+
+void OutputBinding::Attach(Scope* scope,
+                           const std::vector<std::string>& output_names) {
+  for (auto& item : bindings_) {
+    auto& binding = item.second;
+    auto* output = GetOutput(scope, output_names, item.first);
+    if (output->raw_data() == binding.data) continue;
+    // The kernel allocates the output of the first run, and the bound memory
+    // is only shared if it can hold the output of the last run.
+    if (!IsHostMemory(output->target()) || output->offset() != 0 ||
+        output->memory_size() == 0 ||
+        output->memory_size() > binding.memory_size) {
+      continue;
+    }
+    auto buffer = std::make_shared<BoundBuffer>(
+        binding.data, output->target(), binding.memory_size);
+    output->ResetBuffer(buffer, output->memory_size());
+  }
+}
+
+void OutputBinding::Sync(Scope* scope,
+                         const std::vector<std::string>& output_names) {
+  for (auto& item : bindings_) {
+    auto& binding = item.second;
+    auto* output = GetOutput(scope, output_names, item.first);
+    if (output->raw_data() == binding.data) continue;
+    if (!IsHostMemory(output->target()) ||
+        output->memory_size() > binding.memory_size) {
+      LOG(WARNING) << "Output " << item.first << " of "
+                   << output->memory_size() << " bytes on "
+                   << lite_api::TargetToStr(output->target())
+                   << " is not copied into the bound memory of "
+                   << binding.memory_size << " bytes, get it by GetOutput.";
+      continue;
+    }
+    TargetCopy(TARGET(kHost),
+               binding.data,
+               output->raw_data(),
+               output->memory_size());
+  }
+}
+
+}  // namespace lite
+}  // namespace paddle
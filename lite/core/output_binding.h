@@ -0,0 +1,59 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include "lite/core/scope.h"
+#include "lite/core/tensor.h"
+
+namespace paddle {
+namespace lite {
+
+// Bind the outputs of a predictor to the host memory provided by the caller,
+// so that the kernel producing an output writes into it directly instead of
+// the output being copied out after Run.
+class OutputBinding {
+ public:
+  void Bind(size_t offset, void* data, size_t memory_size, TargetType target);
+  // Move the data of the output back to the memory owned by the tensor.
+  void Unbind(size_t offset, Tensor* output);
+  bool empty() const { return bindings_.empty(); }
+
+  // Called before Run, share the bound memory with the outputs whose target
+  // and size are known from the last run.
+  void Attach(Scope* scope, const std::vector<std::string>& output_names);
+  // Called after Run, copy the outputs which are not produced in the bound
+  // memory, e.g. by the first run or by the ops sharing the data of their
+  // inputs. An output larger than the bound memory is left in the tensor.
+  void Sync(Scope* scope, const std::vector<std::string>& output_names);
+
+ private:
+  struct Binding {
+    void* data{nullptr};
+    size_t memory_size{0};
+    TargetType target{TargetType::kHost};
+  };
+
+  Tensor* GetOutput(Scope* scope,
+                    const std::vector<std::string>& output_names,
+                    size_t offset) const;
+
+  std::map<size_t, Binding> bindings_;
+};
+
+}  // namespace lite
+}  // namespace paddle
@@ -0,0 +1,105 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/output_binding.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+namespace paddle {
+namespace lite {
+
+// Run a fake program which writes `numel` values starting from `value` into
+// the output, the way a kernel does by mutable_data.
+static float* RunOnce(OutputBinding* binding,
+                      Scope* scope,
+                      const std::vector<std::string>& output_names,
+                      int64_t numel,
+                      float value) {
+  auto* out = scope->Var(output_names[0])->GetMutable<Tensor>();
+  binding->Attach(scope, output_names);
+  out->Resize({numel});
+  auto* data = out->mutable_data<float>(TARGET(kHost));
+  for (int64_t i = 0; i < numel; ++i) {
+    data[i] = value + i;
+  }
+  binding->Sync(scope, output_names);
+  return data;
+}
+
+TEST(output_binding, write_into_bound_memory) {
+  Scope scope;
+  const std::vector<std::string> output_names{"out"};
+  std::vector<float> memory(8, -1.f);
+  OutputBinding binding;
+  binding.Bind(0, memory.data(), memory.size() * sizeof(float), TARGET(kHost));
+
+  // the first run is copied into the bound memory
+  EXPECT_NE(RunOnce(&binding, &scope, output_names, 4, 0.f), memory.data());
+  EXPECT_EQ(memory[3], 3.f);
+  // the following runs are written into it
+  EXPECT_EQ(RunOnce(&binding, &scope, output_names, 4, 10.f), memory.data());
+  EXPECT_EQ(memory[3], 13.f);
+  EXPECT_EQ(RunOnce(&binding, &scope, output_names, 8, 20.f), memory.data());
+  EXPECT_EQ(memory[7], 27.f);
+
+  auto* out = scope.FindVar("out")->GetMutable<Tensor>();
+  binding.Unbind(0, out);
+  EXPECT_NE(out->data<float>(), memory.data());
+  EXPECT_EQ(out->data<float>()[7], 27.f);
+  EXPECT_NE(RunOnce(&binding, &scope, output_names, 8, 30.f), memory.data());
+  EXPECT_EQ(memory[7], 27.f);
+}
+
+TEST(output_binding, growing_output) {
+  Scope scope;
+  const std::vector<std::string> output_names{"out"};
+  std::vector<float> memory(8, -1.f);
+  OutputBinding binding;
+  binding.Bind(0, memory.data(), memory.size() * sizeof(float), TARGET(kHost));
+  RunOnce(&binding, &scope, output_names, 4, 0.f);
+  EXPECT_EQ(RunOnce(&binding, &scope, output_names, 4, 10.f), memory.data());
+
+  // the output outgrows the bound memory shared with it, the kernel gets the
+  // memory of the tensor and the bound memory is left as is
+  auto* data = RunOnce(&binding, &scope, output_names, 16, 20.f);
+  EXPECT_NE(data, memory.data());
+  auto* out = scope.FindVar("out")->GetMutable<Tensor>();
+  EXPECT_EQ(out->data<float>()[15], 35.f);
+  EXPECT_EQ(memory[3], 13.f);
+
+  // the output fits again, it is copied and then written in place
+  EXPECT_NE(RunOnce(&binding, &scope, output_names, 6, 40.f), memory.data());
+  EXPECT_EQ(memory[5], 45.f);
+  EXPECT_EQ(RunOnce(&binding, &scope, output_names, 6, 50.f), memory.data());
+  EXPECT_EQ(memory[5], 55.f);
+}
+
+TEST(output_binding, too_small_memory) {
+  Scope scope;
+  const std::vector<std::string> output_names{"out"};
+  std::vector<float> memory(2, -1.f);
+  OutputBinding binding;
+  binding.Bind(0, memory.data(), memory.size() * sizeof(float), TARGET(kHost));
+  for (int run = 0; run < 3; ++run) {
+    EXPECT_NE(RunOnce(&binding, &scope, output_names, 4, run * 10.f),
+              memory.data());
+    auto* out = scope.FindVar("out")->GetMutable<Tensor>();
+    EXPECT_EQ(out->data<float>()[3], run * 10.f + 3);
+    EXPECT_EQ(memory[0], -1.f);
+  }
+}
+
+}  // namespace lite
+}  // namespace paddle
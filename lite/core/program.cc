@@ -25,6 +25,7 @@
 #include "lite/operators/conditional_block_op.h"
 #include "lite/operators/subgraph_op.h"
 #include "lite/operators/while_op.h"
+#include "lite/utils/env.h"
 #ifdef LITE_WITH_PRECISION_PROFILE
 #include "lite/core/profile/precision_profiler.h"
 #endif
@@ -35,6 +36,99 @@
 
 namespace paddle {
 namespace lite {
+namespace {
+// The output shapes of these ops depend on the data of their inputs or on
+// sub-blocks, the programs containing them are never shape plan cached.
+const std::set<std::string> kDynamicShapeOps = {
+    "while",
+    "conditional_block",
+    "subgraph",
+    "select_input",
+    "lod_reset",
+    "write_to_array",
+    "read_from_array",
+    "tensor_array_to_tensor",
+    "lod_array_length",
+    "split_lod_tensor",
+    "merge_lod_tensor",
+    "multiclass_nms",
+    "multiclass_nms2",
+    "multiclass_nms3",
+    "matrix_nms",
+    "generate_proposals",
+    "generate_proposals_v2",
+    "distribute_fpn_proposals",
+    "collect_fpn_proposals",
+    "retinanet_detection_output",
+    "where_index",
+    "masked_select",
+    "unique",
+    "unique_with_counts",
+    "range",
+    "linspace",
+    "sequence_unpad",
+    "sequence_mask",
+    "sequence_erase",
+    "beam_search",
+    "beam_search_decode",
+    "ctc_align",
+    "viterbi_decode",
+    "bincount",
+};
+
+// The inputs whose data, not only dims, decide the output shapes. An op reading
+// one of them from a non-persistable tensor disables the shape plan cache.
+const std::set<std::string> kShapeTensorArgs = {
+    "ShapeTensor",
+    "ShapeTensorList",
+    "Shape",
+    "StartsTensor",
+    "StartsTensorList",
+    "EndsTensor",
+    "EndsTensorList",
+    "StridesTensor",
+    "StridesTensorList",
+    "SizeTensor",
+    "OutSize",
+    "Scale",
+    "AxisTensor",
+    "AxesTensor",
+    "AxesTensorList",
+    "RepeatTimes",
+    "repeat_times_tensor",
+    "ExpandTimes",
+    "expand_times_tensor",
+    "expand_shapes_tensor",
+    "SectionsTensorList",
+    "K",
+    "Paddings",
+    "Offsets",
+    "depth_tensor",
+    "MaxLenTensor",
+    "Start",
+    "End",
+    "Step",
+    "Num",
+};
+
+// InferShape of these ops updates their params, e.g. the paddings of conv2d,
+// so it is still called on a shape plan cache hit.
+const std::set<std::string> kInferShapeAlwaysOps = {
+    "conv2d",
+    "depthwise_conv2d",
+    "conv2d_transpose",
+    "depthwise_conv2d_transpose",
+    "pool2d",
+    "max_pool2d_with_index",
+    "fc",
+    "pad2d",
+    "tile",
+    "unbind",
+    "top_k_v2",
+    "__xpu__conv2d",
+};
+}  // namespace
+
 #ifndef LITE_ON_TINY_PUBLISH
 namespace {
 // Verify the validity of ProgramDesc
@@ -123,6 +217,8 @@ void UpdateVarDescFromTensorInfo(cpp::VarDesc* var,
       SET_DATATYPE(kInt64, VarDescAPI::VarDataType::INT64);
       SET_DATATYPE(kUnk, VarDescAPI::VarDataType::FP32);
       SET_DATATYPE(kAny, VarDescAPI::VarDataType::FP32);
+      // bf16 vars are saved as fp32, the weights are converted when loading.
+      SET_DATATYPE(kBF16, VarDescAPI::VarDataType::FP32);
 #undef SET_DATATYPE
       default:
         LOG(FATAL) << "Unknown precision type " << PrecisionToStr(precision)
@@ -247,12 +343,26 @@ void AddVariableDescFromOpInfo(
     }
     already_added_vars->insert(var_name);
   }
+  // The packed weights are read by the kernel instead of the op
+  if (op_info->HasAttr(kPackedWeightsAttr)) {
+    auto packed_name = op_info->GetAttr<std::string>(kPackedWeightsAttr);
+    if (!packed_name.empty() && !already_added_vars->count(packed_name) &&
+        scope->FindVar(packed_name)) {
+      auto* v = block_desc->AddVar<cpp::VarDesc>();
+      v->SetName(packed_name);
+      UpdateVarDescFromTensorInfo(v, packed_name, op_type, scope);
+      already_added_vars->insert(packed_name);
+    }
+  }
 }
 
 }  // namespace
 
 void RuntimeProgram::SaveRuntimProgramIntoProgramDesc(
     std::shared_ptr<cpp::ProgramDesc> program_desc) {
+  CHECK(!raw_weights_released_)
+      << "The raw weights replaced by the packed ones are released, the "
+         "program can not be saved.";
   CheckProgramDescValidity(program_desc, instructions_.size());
   size_t block_size = program_desc->BlocksSize();
   program_desc->SetVersion(get_version());
@@ -268,8 +378,128 @@ void RuntimeProgram::SaveRuntimProgramIntoProgramDesc(
     }
   }
 }
+
+void RuntimeProgram::PackWeights() {
+  int num_packed = 0;
+  for (auto& block : instructions_) {
+    for (auto& inst : block) {
+      auto* kernel = inst.mutable_kernel();
+      auto* op = const_cast<OpLite*>(inst.op());
+      if (kernel == nullptr || op == nullptr) continue;
+      auto* op_info = op->mutable_op_info();
+      Tensor packed;
+      std::string weight_arg;
+      if (!kernel->PackWeights(&packed, &weight_arg)) {
+        // Drop the packed weights of the kernel picked previously
+        if (op_info->HasAttr(kPackedWeightsAttr)) {
+          op_info->SetAttr<std::string>(kPackedWeightsAttr, "");
+          op_info->SetAttr<std::string>(kPackedWeightsKeyAttr, "");
+        }
+        continue;
+      }
+      auto weight_name = op_info->Input(weight_arg).front();
+      auto packed_name =
+          weight_name + "@packed_" + std::to_string(num_packed++);
+      // The weights live in the root scope, so do the packed ones
+      auto* scope = op->scope();
+      while (scope->MutableParent() != nullptr) {
+        scope = scope->MutableParent();
+      }
+      auto* packed_tensor = scope->Var(packed_name)->GetMutable<Tensor>();
+      packed_tensor->CopyDataFrom(packed);
+      packed_tensor->set_persistable(true);
+      op_info->SetAttr<std::string>(kPackedWeightsAttr, packed_name);
+      op_info->SetAttr<std::string>(
+          kPackedWeightsKeyAttr,
+          kernel->SerializedKernelType() + "/" + kernel->PackedWeightsTag());
+      kernel->SetPackedWeights(packed_tensor);
+      VLOG(3) << "Packed " << weight_name << " of " << op_info->Type()
+              << " into " << packed_name << ": " << packed.numel() << " bytes";
+    }
+  }
+  LOG(INFO) << "Packed the weights of " << num_packed << " kernels";
+}
 #endif
 
+void RuntimeProgram::LoadPackedWeights() {
+  for (auto& block : instructions_) {
+    for (auto& inst : block) {
+      auto* kernel = inst.mutable_kernel();
+      auto* op = const_cast<OpLite*>(inst.op());
+      if (kernel == nullptr || op == nullptr) continue;
+      auto* op_info = op->op_info();
+      if (!op_info->HasAttr(kPackedWeightsAttr)) continue;
+      auto packed_name = op_info->GetAttr<std::string>(kPackedWeightsAttr);
+      if (packed_name.empty()) continue;
+      auto* var = op->scope()->FindVar(packed_name);
+      if (var == nullptr) continue;
+      auto key = op_info->GetAttr<std::string>(kPackedWeightsKeyAttr);
+      if (key != kernel->SerializedKernelType() + "/" +
+                     kernel->PackedWeightsTag()) {
+        LOG(WARNING) << "Ignore the weights packed by " << key << " for "
+                     << kernel->SerializedKernelType()
+                     << ", they will be packed at the first run";
+        continue;
+      }
+      kernel->SetPackedWeights(var->GetMutable<Tensor>());
+      // See PackWeights for the name of the packed weights
+      auto weight_name = packed_name.substr(0, packed_name.rfind("@packed_"));
+      packed_weight_uses_[weight_name]++;
+    }
+  }
+}
+
+std::set<std::string> RuntimeProgram::WeightsRewrittenInPlace() const {
+  std::set<std::string> names;
+  for (auto& block : instructions_) {
+    for (auto& inst : block) {
+      if (inst.kernel() == nullptr || inst.op() == nullptr) continue;
+      auto* op_info = inst.op()->op_info();
+      for (auto& arg : inst.kernel()->WeightsRewrittenInPlace()) {
+        if (!op_info->HasInput(arg)) continue;
+        for (auto& name : op_info->Input(arg)) {
+          names.insert(name);
+        }
+      }
+    }
+  }
+  return names;
+}
+
+void RuntimeProgram::ReleasePackedRawWeights(
+    const cpp::ProgramDesc& program_desc) {
+  if (packed_weight_uses_.empty()) return;
+  // Keep the raw weights which are still read by any op, e.g. a kernel which
+  // failed to pick the packed weights or an op of the other blocks.
+  std::map<std::string, int> uses;
+  for (size_t block_idx = 0; block_idx < program_desc.BlocksSize();
+       ++block_idx) {
+    auto* block_desc =
+        program_desc.GetBlock<cpp::BlockDesc>(static_cast<int32_t>(block_idx));
+    for (size_t op_idx = 0; op_idx < block_desc->OpsSize(); ++op_idx) {
+      auto* op_desc =
+          block_desc->GetOp<cpp::OpDesc>(static_cast<int32_t>(op_idx));
+      for (auto& name : op_desc->input_vars()) {
+        if (packed_weight_uses_.count(name)) uses[name]++;
+      }
+    }
+  }
+  for (auto& item : packed_weight_uses_) {
+    if (uses[item.first] != item.second) continue;
+    auto* var = exec_scope_->FindVar(item.first);
+    if (var == nullptr || !var->IsType<Tensor>()) continue;
+    // Keep the dims for InferShape, but free the data
+    auto* raw = var->GetMutable<Tensor>();
+    Tensor released;
+    released.Resize(raw->dims());
+    released.set_precision(raw->precision());
+    released.set_persistable(raw->persistable());
+    *raw = std::move(released);
+    raw_weights_released_ = true;
+    VLOG(3) << "Released the raw weights " << item.first;
+  }
+}
+
 // Create runtime program from sub_block desc according to block_idx and
 // program_desc, which is used for while/conditional_block/subgraph op.
 RuntimeProgram::RuntimeProgram(
@@ -566,6 +796,7 @@ RuntimeProgram::RuntimeProgram(
     instructions_[kRootBlockIdx].emplace_back(std::move(op), std::move(kernel));
   }
   Init();
+  LoadPackedWeights();
 }
 
 #ifdef LITE_WITH_METAL
@@ -600,6 +831,30 @@ void RuntimeProgram::Run() {
 
   int idx = -1;
 
+  // The shape plan cache is initialized on the second run, when the input
+  // tensors have been set and every instruction has run once. A sub-block
+  // program is run by while once per iteration, so its plans are reused by
+  // the iterations of the same input shapes.
+  if (has_run_ && shape_plan_cache_size_ < 0) {
+    shape_plan_cache_size_ = InitShapePlanCache();
+  }
+  has_run_ = true;
+  ShapePlan* hit_plan = nullptr;
+  ShapePlan* new_plan = nullptr;
+  if (shape_plan_cache_size_ > 0) {
+    hit_plan = FindShapePlan();
+    if (!hit_plan) {
+      shape_plans_.emplace_front();
+      new_plan = &shape_plans_.front();
+      for (auto* tensor : input_tensors_) {
+        new_plan->input_dims.push_back(tensor->dims());
+        new_plan->input_lods.push_back(tensor->lod());
+      }
+      new_plan->output_dims.resize(inst_output_tensors_.size());
+      new_plan->output_lods.resize(inst_output_tensors_.size());
+    }
+  }
+
   auto& insts = instructions_[kRootBlockIdx];
   for (auto& inst : insts) {
     ++idx;
@@ -612,7 +867,15 @@ void RuntimeProgram::Run() {
     inst.Flush(idx);
 #endif
 
-    inst.Run();
+    if (hit_plan) {
+      RestoreShapePlan(idx, *hit_plan);
+      inst.Run(inst_infer_shape_always_[idx]);
+    } else {
+      inst.Run();
+    }
+    // The outputs are saved right after the instruction runs, because the
+    // vars may be reused by the later instructions.
+    if (new_plan) SaveShapePlan(idx, new_plan);
 #ifdef LITE_WITH_PRECISION_PROFILE
     if (inst.op()->Type() != "while") {
       precision_profiler_summary +=
@@ -635,6 +898,229 @@ void RuntimeProgram::Run() {
 #endif
 }
 
+int RuntimeProgram::InitShapePlanCache() {
+  input_tensors_.clear();
+  inst_output_tensors_.clear();
+  inst_infer_shape_always_.clear();
+  shape_plans_.clear();
+  int cache_size = GetIntFromEnv(SHAPE_PLAN_CACHE_SIZE, 0);
+#if defined(LITE_WITH_METAL) || defined(LITE_WITH_PRECISION_PROFILE)
+  cache_size = 0;
+#endif
+  if (cache_size <= 0) return 0;
+  // Only the root block is run by this program, the other blocks of the main
+  // program are run by the sub-block programs of while and conditional_block,
+  // which have their own caches.
+  auto& insts = instructions_[kRootBlockIdx];
+  // The sub-block programs generated from the instructions have no exec
+  // scope, their ops run in the scope of the op owning the block.
+  Scope* scope = exec_scope_;
+  if (!scope && !insts.empty()) {
+    scope = const_cast<OpLite*>(insts.front().op())->scope();
+  }
+  if (!scope) return 0;
+  inst_output_tensors_.resize(insts.size());
+  inst_infer_shape_always_.resize(insts.size(), false);
+  // The vars written by the instructions run so far.
+  std::set<std::string> written_names;
+  std::set<std::string> input_names;
+  auto add_input = [&](const std::string& name) -> bool {
+    if (written_names.count(name) || input_names.count(name)) return true;
+    auto* var = scope->FindVar(name);
+    if (!var || !var->IsType<Tensor>()) return false;
+    const auto& tensor = var->Get<Tensor>();
+    if (tensor.persistable()) return true;
+    input_names.insert(name);
+    input_tensors_.push_back(&tensor);
+    return true;
+  };
+  for (size_t i = 0; i < insts.size(); i++) {
+    const auto* op = insts[i].op();
+    const auto& op_type = op->Type();
+    const auto* op_info = op->op_info();
+    if (op_type == "feed") {
+      for (auto& name : op_info->Output("Out")) {
+        if (!add_input(name)) return 0;
+        written_names.insert(name);
+      }
+      continue;
+    }
+    if (insts[i].is_feed_fetch_op()) continue;
+    if (kDynamicShapeOps.count(op_type)) {
+      VLOG(3) << "Shape plan cache is disabled by op " << op_type;
+      return 0;
+    }
+    for (auto& arg_name : op_info->input_argnames()) {
+      if (!kShapeTensorArgs.count(arg_name)) continue;
+      for (auto& name : op_info->Input(arg_name)) {
+        auto* var = scope->FindVar(name);
+        if (var && var->IsType<Tensor>() && var->Get<Tensor>().persistable()) {
+          continue;
+        }
+        VLOG(3) << "Shape plan cache is disabled by the input " << arg_name
+                << " of op " << op_type;
+        return 0;
+      }
+    }
+    const auto input_names_of_op = op_info->input_names();
+    for (auto& name : input_names_of_op) {
+      if (!add_input(name)) return 0;
+    }
+    // Restoring the dims of an output which is also an input, e.g. the
+    // counter of increment, would change the input before the op reads it,
+    // so such an op always runs its InferShape instead.
+    bool inplace = false;
+    for (auto& name : op_info->output_names()) {
+      inplace = inplace || std::find(input_names_of_op.begin(),
+                                     input_names_of_op.end(),
+                                     name) != input_names_of_op.end();
+    }
+    for (auto& name : op_info->output_names()) {
+      auto* var = scope->FindVar(name);
+      if (!var || !var->IsType<Tensor>()) return 0;
+      written_names.insert(name);
+      if (inplace) continue;
+      inst_output_tensors_[i].push_back(var->GetMutable<Tensor>());
+    }
+    inst_infer_shape_always_[i] =
+        inplace || kInferShapeAlwaysOps.count(op_type) > 0;
+  }
+  if (input_tensors_.empty()) return 0;
+  VLOG(3) << "Shape plan cache is enabled with size " << cache_size << " and "
+          << input_tensors_.size() << " inputs";
+  return cache_size;
+}
+
+RuntimeProgram::ShapePlan* RuntimeProgram::FindShapePlan() {
+  for (auto it = shape_plans_.begin(); it != shape_plans_.end(); ++it) {
+    bool matched = true;
+    for (size_t i = 0; i < input_tensors_.size() && matched; i++) {
+      matched = input_tensors_[i]->dims() == it->input_dims[i] &&
+                input_tensors_[i]->lod() == it->input_lods[i];
+    }
+    if (!matched) continue;
+    if (it != shape_plans_.begin()) {
+      shape_plans_.splice(shape_plans_.begin(), shape_plans_, it);
+    }
+    return &shape_plans_.front();
+  }
+  // Make room for the plan which will be recorded by this run.
+  while (shape_plans_.size() >= static_cast<size_t>(shape_plan_cache_size_)) {
+    shape_plans_.pop_back();
+  }
+  return nullptr;
+}
+
+void RuntimeProgram::SaveShapePlan(size_t inst_idx, ShapePlan* plan) const {
+  auto& outputs = inst_output_tensors_[inst_idx];
+  auto& dims = plan->output_dims[inst_idx];
+  auto& lods = plan->output_lods[inst_idx];
+  dims.clear();
+  lods.clear();
+  for (auto* tensor : outputs) {
+    dims.push_back(tensor->dims());
+    lods.push_back(tensor->lod());
+  }
+}
+
+void RuntimeProgram::RestoreShapePlan(size_t inst_idx, const ShapePlan& plan) {
+  auto& outputs = inst_output_tensors_[inst_idx];
+  auto& dims = plan.output_dims[inst_idx];
+  auto& lods = plan.output_lods[inst_idx];
+  CHECK_EQ(outputs.size(), dims.size());
+  for (size_t i = 0; i < outputs.size(); i++) {
+    outputs[i]->Resize(dims[i]);
+    outputs[i]->set_lod(lods[i]);
+  }
+}
+
+void RuntimeProgram::GetMemoryStats(lite_api::MemoryStats* stats,
+                                    int top_k) const {
+  CHECK(stats);
+  CHECK(exec_scope_);
+  *stats = lite_api::MemoryStats();
+  // The tensors sharing a buffer are counted once, by the first name seen.
+  std::map<const void*, std::pair<std::string, int64_t>> buffers;
+  auto count_buffer = [&](const std::string& name, const Tensor& tensor) {
+    if (!tensor.IsInitialized()) return;
+    const void* data =
+        static_cast<const char*>(tensor.raw_data()) - tensor.offset();
+    if (buffers.count(data)) return;
+    int64_t bytes = static_cast<int64_t>(tensor.capacity());
+    buffers[data] = std::make_pair(name, bytes);
+    if (tensor.persistable()) {
+      stats->weight_bytes += bytes;
+    } else {
+      stats->live_activation_bytes += bytes;
+    }
+  };
+  for (const Scope* scope = exec_scope_; scope; scope = scope->parent()) {
+    for (auto& var_name : scope->LocalVarNames()) {
+      auto* var = scope->FindLocalVar(var_name);
+      if (var->IsType<Tensor>()) {
+        count_buffer(var_name, var->Get<Tensor>());
+      } else if (var->IsType<std::vector<Tensor>>()) {
+        auto& tensor_array = var->Get<std::vector<Tensor>>();
+        for (size_t i = 0; i < tensor_array.size(); i++) {
+          count_buffer(var_name + "[" + paddle::lite::to_string(i) + "]",
+                       tensor_array[i]);
+        }
+      }
+    }
+  }
+
+  // After memory_optimize_pass the reused activations are renamed to the
+  // same var, so the vars referenced by the instructions are the plan.
+  std::set<std::string> activations;
+  for (auto& insts : instructions_) {
+    for (auto& inst : insts) {
+      auto* op_info = inst.op()->op_info();
+      for (auto& var_name : op_info->input_vars()) {
+        activations.insert(var_name);
+      }
+      for (auto& var_name : op_info->output_vars()) {
+        activations.insert(var_name);
+      }
+    }
+  }
+  // The vars sharing a buffer, e.g. the inplace reshape, need the bytes of
+  // the largest view of it.
+  std::map<const void*, int64_t> planned_buffers;
+  for (auto& var_name : activations) {
+    auto* var = exec_scope_->FindVar(var_name);
+    if (!var || !var->IsType<Tensor>()) continue;
+    auto& tensor = var->Get<Tensor>();
+    if (tensor.persistable() || !tensor.IsInitialized()) continue;
+    const void* data =
+        static_cast<const char*>(tensor.raw_data()) - tensor.offset();
+    int64_t bytes =
+        static_cast<int64_t>(tensor.offset() + tensor.memory_size());
+    auto& planned_bytes = planned_buffers[data];
+    planned_bytes = std::max(planned_bytes, bytes);
+  }
+  for (auto& buffer : planned_buffers) {
+    stats->planned_activation_bytes += buffer.second;
+  }
+
+  stats->workspace_bytes = WorkSpace::Global_Host().space();
+#ifdef LITE_WITH_ARM
+  stats->workspace_bytes += DeviceInfo::Global().workspace_size();
+#endif
+
+  for (auto& buffer : buffers) {
+    stats->top_tensors.push_back(buffer.second);
+  }
+  std::sort(stats->top_tensors.begin(),
+            stats->top_tensors.end(),
+            [](const std::pair<std::string, int64_t>& a,
+               const std::pair<std::string, int64_t>& b) {
+              return a.second > b.second;
+            });
+  if (stats->top_tensors.size() > static_cast<size_t>(std::max(top_k, 0))) {
+    stats->top_tensors.resize(std::max(top_k, 0));
+  }
+}
+
 void Program::Build(const std::shared_ptr<cpp::ProgramDesc>& program_desc) {
   CHECK(ops_.empty()) << "Executor duplicate Build found";
 
@@ -786,7 +1272,7 @@ void Instruction::SaveOutput() {
 }
 #endif
 
-void Instruction::Run() {
+void Instruction::Run(bool infer_shape) {
 #ifdef LITE_WITH_PROFILE
   CHECK(profiler_) << "Profiler pointer of kernel can not be nullptr. "
                       "When LITE_WITH_PROFILE is defined, please set a "
@@ -812,7 +1298,9 @@ void Instruction::Run() {
     return;
   }
 
-  op_->InferShape();
+  if (infer_shape) {
+    op_->InferShape();
+  }
   kernel_->Launch();
   has_run_ = true;
 #ifdef LITE_WITH_XPU
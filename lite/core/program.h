@@ -16,9 +16,11 @@
 #include <list>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
+#include "lite/api/paddle_api.h"
 #include "lite/core/kernel.h"
 #include "lite/core/op_lite.h"
 #include "lite/core/op_registry.h"
@@ -34,6 +36,10 @@ namespace paddle {
 namespace lite {
 
 static const char kKernelTypeAttr[] = "__@kernel_type_attr@__";
+// The persistable var of the weights packed offline, and the key of the
+// kernel and layout which packed them.
+static const char kPackedWeightsAttr[] = "__@packed_weights_attr@__";
+static const char kPackedWeightsKeyAttr[] = "__@packed_weights_key_attr@__";
 
 // A program is used to represent a code program, in Paddle, a code program
 // contains:
@@ -119,8 +125,9 @@ struct Instruction {
     }
   }
 
-  // Run the instruction.
-  void Run();
+  // Run the instruction, the caller may skip InferShape if it has restored
+  // the output dims and lods already.
+  void Run(bool infer_shape = true);
 #ifdef LITE_WITH_METAL
   void SaveOutput();
 #endif
@@ -192,6 +199,7 @@ class LITE_API RuntimeProgram {
   explicit RuntimeProgram(std::vector<std::vector<Instruction>>&& insts)
       : instructions_(std::move(insts)) {
     Init();
+    LoadPackedWeights();
   }
   explicit RuntimeProgram(
       const std::shared_ptr<const cpp::ProgramDesc>& program_desc,
@@ -272,9 +280,21 @@ class LITE_API RuntimeProgram {
   void SaveOutput();
 #endif
 
-  void set_exec_scope(Scope* x) { exec_scope_ = x; }
+  void set_exec_scope(Scope* x) {
+    exec_scope_ = x;
+    // the cached tensors belong to the previous scope
+    shape_plan_cache_size_ = -1;
+    shape_plans_.clear();
+  }
   Scope* exec_scope() { return exec_scope_; }
 
+  // Collect the weights, activations and workspace held by this program and
+  // its parent scopes, the tracked allocations are left to the caller.
+  void GetMemoryStats(lite_api::MemoryStats* stats, int top_k) const;
+
+  // The number of the shape plans held by the cache of this program.
+  size_t shape_plan_count() const { return shape_plans_.size(); }
+
   const std::vector<Instruction>& instructions(
       int block_idx = kRootBlockIdx) const {
     return instructions_[block_idx];
@@ -296,8 +316,22 @@ class LITE_API RuntimeProgram {
   // according to the instructions
   void SaveRuntimProgramIntoProgramDesc(
       std::shared_ptr<cpp::ProgramDesc> program_desc);
+
+  // Let the kernels pack their weights ahead of time, the packed weights are
+  // stored as persistable vars of the root scope and saved with the model.
+  void PackWeights();
 #endif
 
+  // The weights rewritten in place by the kernels of all of the blocks, see
+  // KernelBase::WeightsRewrittenInPlace.
+  std::set<std::string> WeightsRewrittenInPlace() const;
+
+  // Release the data of the raw weights which are replaced by the packed ones
+  // and read by no other op of program_desc, only their dims are kept for
+  // InferShape. The program can't be saved after that, so it's only called
+  // by the predictors which neither save the model nor share their scope.
+  void ReleasePackedRawWeights(const cpp::ProgramDesc& program_desc);
+
 #ifdef LITE_WITH_METAL
   void ConfigMetalContext(std::string lib_path,
                           bool use_mps = false,
@@ -307,10 +341,50 @@ class LITE_API RuntimeProgram {
 #endif
 
  private:
+  // The output dims and lods of every instruction for one combination of the
+  // input dims and lods.
+  struct ShapePlan {
+    std::vector<DDim> input_dims;
+    std::vector<LoD> input_lods;
+    std::vector<std::vector<DDim>> output_dims;
+    std::vector<std::vector<LoD>> output_lods;
+  };
+
+  // Return the capacity of the shape plan cache, 0 if the program does not
+  // support it, e.g. it has control flow or data dependent output shapes.
+  int InitShapePlanCache();
+  // Find the plan of the current input dims and lods, and move it to the
+  // front of the LRU list.
+  ShapePlan* FindShapePlan();
+  void SaveShapePlan(size_t inst_idx, ShapePlan* plan) const;
+  void RestoreShapePlan(size_t inst_idx, const ShapePlan& plan);
+
+  // Hand the packed weights of the model to the kernels which can use them.
+  // The tensors of the scope are left as is, the scope may be shared by the
+  // other programs, e.g. of the cloned predictors.
+  void LoadPackedWeights();
+
   RuntimeProgram(const RuntimeProgram&) = delete;
   std::vector<std::vector<Instruction>> instructions_;
   Scope* exec_scope_{};
   int64_t version_{0};
+  bool has_run_{false};
+  // The number of the kernels reading the packed weights of a raw weight
+  std::map<std::string, int> packed_weight_uses_;
+  bool raw_weights_released_{false};
+
+  // -1 if the shape plan cache is not initialized yet.
+  int shape_plan_cache_size_{-1};
+  // The non-persistable tensors read before being written by the program,
+  // i.e. the feeds of the main program, or the outer vars and the loop-carried
+  // state of a sub-block, their dims and lods are the key of the plans.
+  std::vector<const Tensor*> input_tensors_;
+  std::vector<std::vector<Tensor*>> inst_output_tensors_;
+  // InferShape of these instructions is still called on a hit, because it
+  // updates the param of the op as well, or the op updates a tensor in place.
+  std::vector<bool> inst_infer_shape_always_;
+  // The most recently used plan comes first.
+  std::list<ShapePlan> shape_plans_;
 
 #ifdef LITE_WITH_METAL
   std::unique_ptr<KernelContext> metal_ctx_{nullptr};
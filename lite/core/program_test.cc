@@ -0,0 +1,519 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/program.h"
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "lite/core/op_registry.h"
+#include "lite/model_parser/cpp_desc.h"
+#include "lite/model_parser/model_parser.h"
+#include "lite/utils/env.h"
+
+namespace paddle {
+namespace lite {
+
+// An int8 conv2d with fp32 output, whose x86 kernel packs its filter.
+static std::shared_ptr<cpp::ProgramDesc> BuildInt8ConvProgram(Scope* scope) {
+  auto program_desc = std::make_shared<cpp::ProgramDesc>();
+  auto* block_desc = program_desc->AddBlock<cpp::BlockDesc>();
+  block_desc->ClearOps();
+  block_desc->ClearVars();
+  for (auto name : {"input", "filter", "bias", "output"}) {
+    block_desc->AddVar<cpp::VarDesc>()->SetName(name);
+  }
+  auto* root = scope->MutableParent();
+  auto* filter = root->Var("filter")->GetMutable<Tensor>();
+  filter->Resize({8, 4, 3, 3});
+  auto* filter_data = filter->mutable_data<int8_t>();
+  for (int i = 0; i < filter->numel(); ++i) {
+    filter_data[i] = static_cast<int8_t>(i % 255 - 127);
+  }
+  filter->set_persistable(true);
+  auto* bias = root->Var("bias")->GetMutable<Tensor>();
+  bias->Resize({8});
+  auto* bias_data = bias->mutable_data<float>();
+  for (int i = 0; i < bias->numel(); ++i) {
+    bias_data[i] = 0.1f * i;
+  }
+  bias->set_persistable(true);
+  scope->Var("input")->GetMutable<Tensor>();
+  scope->Var("output")->GetMutable<Tensor>();
+
+  auto* op_desc = block_desc->AddOp<cpp::OpDesc>();
+  op_desc->SetType("conv2d");
+  op_desc->SetInput("Input", {"input"});
+  op_desc->SetInput("Filter", {"filter"});
+  op_desc->SetInput("Bias", {"bias"});
+  op_desc->SetOutput("Output", {"output"});
+  op_desc->SetAttr<std::vector<int>>("strides", {1, 1});
+  op_desc->SetAttr<std::vector<int>>("paddings", {1, 1});
+  op_desc->SetAttr<std::vector<int>>("dilations", {1, 1});
+  op_desc->SetAttr<int>("groups", 1);
+  op_desc->SetAttr<bool>("enable_int8", true);
+  op_desc->SetAttr<std::vector<float>>("Input0_scale", {0.05f});
+  op_desc->SetAttr<std::vector<float>>("Filter0_scale",
+                                       std::vector<float>(8, 0.01f));
+  op_desc->SetAttr<std::string>(
+      kKernelTypeAttr,
+      KernelBase::SerializeKernelType(
+          "conv2d",
+          "fp32_out",
+          Place{TARGET(kX86), PRECISION(kInt8), DATALAYOUT(kNCHW)}));
+  return program_desc;
+}
+
+static std::vector<float> RunInt8Conv(RuntimeProgram* program, Scope* scope) {
+  auto* input = scope->Var("input")->GetMutable<Tensor>();
+  input->Resize({1, 4, 6, 6});
+  auto* input_data = input->mutable_data<int8_t>();
+  for (int i = 0; i < input->numel(); ++i) {
+    input_data[i] = static_cast<int8_t>(i % 31 - 15);
+  }
+  program->Run();
+  auto* output = scope->FindVar("output")->GetMutable<Tensor>();
+  return std::vector<float>(output->data<float>(),
+                            output->data<float>() + output->numel());
+}
+
+static int64_t PackedWeightsSize(const Scope& root) {
+  for (auto& name : root.LocalVarNames()) {
+    if (name.find("filter@packed_") == 0) {
+      return root.FindLocalVar(name)->Get<Tensor>().numel();
+    }
+  }
+  return 0;
+}
+
+TEST(RuntimeProgram, packed_weights_round_trip) {
+  const std::string model_file = "packed_weights_round_trip";
+  std::vector<float> ref;
+  {
+    Scope root;
+    auto* scope = &root.NewScope();
+    auto program_desc = BuildInt8ConvProgram(scope);
+    RuntimeProgram program(program_desc, scope);
+    program.PackWeights();
+    ASSERT_GT(PackedWeightsSize(root), 0);
+    ref = RunInt8Conv(&program, scope);
+    program.SaveRuntimProgramIntoProgramDesc(program_desc);
+    SaveModelNaive(model_file, root, *program_desc);
+  }
+
+  Scope root;
+  auto program_desc = std::make_shared<cpp::ProgramDesc>();
+  LoadModelNaiveFromFile(model_file + ".nb", &root, program_desc.get());
+  const int64_t packed_size = PackedWeightsSize(root);
+  ASSERT_GT(packed_size, 0);
+  const int64_t filter_size =
+      root.FindLocalVar("filter")->Get<Tensor>().numel();
+
+  // the program and its clone read the packed weights of the shared scope
+  auto* scope = &root.NewScope();
+  RuntimeProgram program(program_desc, scope);
+  EXPECT_EQ(RunInt8Conv(&program, scope), ref);
+  auto* clone_scope = &root.NewScope();
+  RuntimeProgram clone(program_desc, clone_scope);
+  EXPECT_EQ(RunInt8Conv(&clone, clone_scope), ref);
+
+  // a kernel which can't use the packed weights repacks the raw ones, and the
+  // packed weights of the shared scope are kept for the others
+  auto mismatch_desc = std::make_shared<cpp::ProgramDesc>(*program_desc);
+  mismatch_desc->GetBlock<cpp::BlockDesc>(0)
+      ->GetOp<cpp::OpDesc>(0)
+      ->SetAttr<std::string>(kPackedWeightsKeyAttr, "mismatch");
+  auto* mismatch_scope = &root.NewScope();
+  RuntimeProgram mismatch(mismatch_desc, mismatch_scope);
+  EXPECT_EQ(RunInt8Conv(&mismatch, mismatch_scope), ref);
+  EXPECT_EQ(PackedWeightsSize(root), packed_size);
+  EXPECT_EQ(RunInt8Conv(&clone, clone_scope), ref);
+
+  // the loaded programs still hold the raw weights, so they can be saved again
+  EXPECT_EQ(root.FindLocalVar("filter")->Get<Tensor>().numel(), filter_size);
+  EXPECT_TRUE(root.FindLocalVar("filter")->Get<Tensor>().IsInitialized());
+  program.SaveRuntimProgramIntoProgramDesc(program_desc);
+  SaveModelNaive(model_file + "_resaved", root, *program_desc);
+  Scope resaved_root;
+  auto resaved_desc = std::make_shared<cpp::ProgramDesc>();
+  LoadModelNaiveFromFile(
+      model_file + "_resaved.nb", &resaved_root, resaved_desc.get());
+  EXPECT_EQ(PackedWeightsSize(resaved_root), packed_size);
+  const auto& resaved_filter =
+      resaved_root.FindLocalVar("filter")->Get<Tensor>();
+  ASSERT_EQ(resaved_filter.numel(), filter_size);
+  const auto& filter = root.FindLocalVar("filter")->Get<Tensor>();
+  EXPECT_EQ(std::vector<int8_t>(resaved_filter.data<int8_t>(),
+                                resaved_filter.data<int8_t>() + filter_size),
+            std::vector<int8_t>(filter.data<int8_t>(),
+                                filter.data<int8_t>() + filter_size));
+}
+
+TEST(RuntimeProgram, release_packed_raw_weights) {
+  const std::string model_file = "release_packed_raw_weights";
+  std::vector<float> ref;
+  {
+    Scope root;
+    auto* scope = &root.NewScope();
+    auto program_desc = BuildInt8ConvProgram(scope);
+    RuntimeProgram program(program_desc, scope);
+    program.PackWeights();
+    ref = RunInt8Conv(&program, scope);
+    program.SaveRuntimProgramIntoProgramDesc(program_desc);
+    SaveModelNaive(model_file, root, *program_desc);
+  }
+
+  Scope root;
+  auto program_desc = std::make_shared<cpp::ProgramDesc>();
+  LoadModelNaiveFromFile(model_file + ".nb", &root, program_desc.get());
+  auto* scope = &root.NewScope();
+  RuntimeProgram program(program_desc, scope);
+  program.ReleasePackedRawWeights(*program_desc);
+  const auto& filter = root.FindLocalVar("filter")->Get<Tensor>();
+  EXPECT_FALSE(filter.IsInitialized());
+  EXPECT_EQ(filter.dims(), DDim({8, 4, 3, 3}));
+  EXPECT_EQ(RunInt8Conv(&program, scope), ref);
+  // the released weights can't be saved
+  ASSERT_DEATH(program.SaveRuntimProgramIntoProgramDesc(program_desc), "");
+}
+
+using ArgNames = std::map<std::string, std::vector<std::string>>;
+
+static cpp::OpDesc* AddOpDesc(cpp::BlockDesc* block_desc,
+                              const std::string& type,
+                              const ArgNames& inputs,
+                              const ArgNames& outputs,
+                              const Place& place) {
+  auto* op_desc = block_desc->AddOp<cpp::OpDesc>();
+  op_desc->SetType(type);
+  for (auto& input : inputs) {
+    op_desc->SetInput(input.first, input.second);
+  }
+  for (auto& output : outputs) {
+    op_desc->SetOutput(output.first, output.second);
+  }
+  op_desc->SetAttr<std::string>(
+      kKernelTypeAttr,
+      KernelBase::SerializeKernelType(type, "def", place));
+  return op_desc;
+}
+
+// A while loop whose sub-block appends x to acc and 2 * x to sum at every
+// iteration, so the shape of acc changes across the iterations. tmp is written
+// twice by the sub-block with different shapes, like a var reused by the
+// memory optimization, and acc is read by the main block after the loop.
+static std::shared_ptr<cpp::ProgramDesc> BuildWhileProgram(Scope* scope) {
+  auto program_desc = std::make_shared<cpp::ProgramDesc>();
+  auto* main_block = program_desc->AddBlock<cpp::BlockDesc>();
+  main_block->ClearOps();
+  main_block->ClearVars();
+  auto* sub_block = program_desc->AddBlock<cpp::BlockDesc>();
+  sub_block->ClearOps();
+  sub_block->ClearVars();
+  for (auto name : {"x", "acc", "sum", "counter", "limit", "cond", "out"}) {
+    main_block->AddVar<cpp::VarDesc>()->SetName(name);
+    scope->Var(name)->GetMutable<Tensor>();
+  }
+  for (auto name : {"tmp", "new_sum"}) {
+    sub_block->AddVar<cpp::VarDesc>()->SetName(name);
+    scope->Var(name)->GetMutable<Tensor>();
+  }
+
+  const Place host_any{TARGET(kHost), PRECISION(kAny), DATALAYOUT(kAny)};
+  const Place x86_float{TARGET(kX86), PRECISION(kFloat), DATALAYOUT(kNCHW)};
+  auto* op_desc = AddOpDesc(main_block,
+                            "while",
+                            {{"X", {"x", "acc", "sum", "counter", "limit"}},
+                             {"Condition", {"cond"}}},
+                            {{"Out", {"acc", "sum", "counter", "cond"}}},
+                            host_any);
+  op_desc->SetAttr<int32_t>("sub_block", 1);
+  op_desc = AddOpDesc(
+      main_block, "scale", {{"X", {"acc"}}}, {{"Out", {"out"}}}, x86_float);
+  op_desc->SetAttr<float>("scale", 0.5f);
+  op_desc->SetAttr<float>("bias", 0.f);
+  op_desc->SetAttr<bool>("bias_after_scale", true);
+
+  op_desc = AddOpDesc(sub_block,
+                      "concat",
+                      {{"X", {"acc", "x"}}},
+                      {{"Out", {"tmp"}}},
+                      x86_float);
+  op_desc->SetAttr<int>("axis", 0);
+  AddOpDesc(
+      sub_block, "assign", {{"X", {"tmp"}}}, {{"Out", {"acc"}}}, host_any);
+  op_desc = AddOpDesc(
+      sub_block, "scale", {{"X", {"x"}}}, {{"Out", {"tmp"}}}, x86_float);
+  op_desc->SetAttr<float>("scale", 2.f);
+  op_desc->SetAttr<float>("bias", 0.f);
+  op_desc->SetAttr<bool>("bias_after_scale", true);
+  op_desc = AddOpDesc(sub_block,
+                      "elementwise_add",
+                      {{"X", {"sum"}}, {"Y", {"tmp"}}},
+                      {{"Out", {"new_sum"}}},
+                      x86_float);
+  op_desc->SetAttr<int>("axis", -1);
+  AddOpDesc(
+      sub_block, "assign", {{"X", {"new_sum"}}}, {{"Out", {"sum"}}}, host_any);
+  op_desc = AddOpDesc(sub_block,
+                      "increment",
+                      {{"X", {"counter"}}},
+                      {{"Out", {"counter"}}},
+                      Place{TARGET(kHost), PRECISION(kAny), DATALAYOUT(kNCHW)});
+  op_desc->SetAttr<float>("step", 1.f);
+  const Place host_float{TARGET(kHost), PRECISION(kFloat), DATALAYOUT(kAny)};
+  op_desc = AddOpDesc(sub_block,
+                      "less_than",
+                      {{"X", {"counter"}}, {"Y", {"limit"}}},
+                      {{"Out", {"cond"}}},
+                      host_float);
+  op_desc->SetAttr<int>("axis", -1);
+  op_desc->SetAttr<bool>("force_cpu", false);
+  return program_desc;
+}
+
+static void FillTensor(Tensor* tensor,
+                       const std::vector<int64_t>& shape,
+                       float value) {
+  tensor->Resize(shape);
+  auto* data = tensor->mutable_data<float>();
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    data[i] = value + i;
+  }
+}
+
+// Run the loop for `iterations` times and check the outputs.
+static void RunWhileProgram(RuntimeProgram* program,
+                            Scope* scope,
+                            int iterations) {
+  FillTensor(scope->FindMutableTensor("x"), {1, 2}, 1.f);
+  FillTensor(scope->FindMutableTensor("acc"), {1, 2}, 1.f);
+  FillTensor(scope->FindMutableTensor("sum"), {1, 2}, 0.f);
+  FillTensor(scope->FindMutableTensor("counter"), {1}, 0.f);
+  FillTensor(scope->FindMutableTensor("limit"), {1}, iterations);
+  auto* cond = scope->FindMutableTensor("cond");
+  cond->Resize({1});
+  cond->mutable_data<bool>()[0] = true;
+  program->Run();
+
+  const auto& acc = scope->FindVar("acc")->Get<Tensor>();
+  ASSERT_EQ(acc.dims(), DDim({iterations + 1, 2}));
+  const auto& out = scope->FindVar("out")->Get<Tensor>();
+  ASSERT_EQ(out.dims(), DDim({iterations + 1, 2}));
+  for (int64_t i = 0; i < acc.numel(); ++i) {
+    EXPECT_EQ(acc.data<float>()[i], 1.f + i % 2);
+    EXPECT_EQ(out.data<float>()[i], 0.5f * (1.f + i % 2));
+  }
+  const auto& sum = scope->FindVar("sum")->Get<Tensor>();
+  ASSERT_EQ(sum.dims(), DDim({1, 2}));
+  EXPECT_EQ(sum.data<float>()[0], 2.f * iterations);
+  EXPECT_EQ(sum.data<float>()[1], 1.f + 4.f * iterations);
+  EXPECT_EQ(scope->FindVar("counter")->Get<Tensor>().data<float>()[0],
+            static_cast<float>(iterations));
+}
+
+TEST(RuntimeProgram, shape_plan_cache_while) {
+  // the plans of a small cache are evicted by the longer loops
+  for (auto cache_size : {"8", "2"}) {
+    setenv(SHAPE_PLAN_CACHE_SIZE, cache_size, 1);
+    Scope root;
+    auto* scope = &root.NewScope();
+    auto program_desc = BuildWhileProgram(scope);
+    RuntimeProgram program(program_desc, scope);
+    for (int iterations : {3, 3, 5, 1, 5, 3}) {
+      RunWhileProgram(&program, scope, iterations);
+    }
+  }
+  unsetenv(SHAPE_PLAN_CACHE_SIZE);
+}
+
+// x -> scale -> y -> reshape2 -> out, whose shape is given by a Shape tensor
+// if `shape_tensor` is not null, or by the attr otherwise.
+static std::shared_ptr<cpp::ProgramDesc> BuildReshapeProgram(
+    Scope* scope, Tensor** shape_tensor) {
+  auto program_desc = std::make_shared<cpp::ProgramDesc>();
+  auto* block_desc = program_desc->AddBlock<cpp::BlockDesc>();
+  block_desc->ClearOps();
+  block_desc->ClearVars();
+  for (auto name : {"x", "y", "shape", "out", "xshape"}) {
+    block_desc->AddVar<cpp::VarDesc>()->SetName(name);
+    scope->Var(name)->GetMutable<Tensor>();
+  }
+  auto* op_desc =
+      AddOpDesc(block_desc,
+                "scale",
+                {{"X", {"x"}}},
+                {{"Out", {"y"}}},
+                Place{TARGET(kX86), PRECISION(kFloat), DATALAYOUT(kNCHW)});
+  op_desc->SetAttr<float>("scale", 2.f);
+  op_desc->SetAttr<float>("bias", 0.f);
+  op_desc->SetAttr<bool>("bias_after_scale", true);
+  ArgNames inputs{{"X", {"y"}}};
+  if (shape_tensor) {
+    inputs["Shape"] = {"shape"};
+    *shape_tensor = scope->FindMutableTensor("shape");
+  }
+  op_desc = AddOpDesc(block_desc,
+                      "reshape2",
+                      inputs,
+                      {{"Out", {"out"}}, {"XShape", {"xshape"}}},
+                      Place{TARGET(kHost), PRECISION(kAny), DATALAYOUT(kAny)});
+  op_desc->SetAttr<std::vector<int>>("shape", {-1, 2});
+  return program_desc;
+}
+
+static void RunReshapeProgram(RuntimeProgram* program,
+                              Scope* scope,
+                              const std::vector<int64_t>& x_shape,
+                              const std::vector<int64_t>& out_shape) {
+  FillTensor(scope->FindMutableTensor("x"), x_shape, 1.f);
+  program->Run();
+  const auto& out = scope->FindVar("out")->Get<Tensor>();
+  ASSERT_EQ(out.dims(), DDim(out_shape));
+  for (int64_t i = 0; i < out.numel(); ++i) {
+    EXPECT_EQ(out.data<float>()[i], 2.f * (1.f + i));
+  }
+}
+
+TEST(RuntimeProgram, shape_plan_cache_hit_and_miss) {
+  setenv(SHAPE_PLAN_CACHE_SIZE, "2", 1);
+  Scope root;
+  auto* scope = &root.NewScope();
+  auto program_desc = BuildReshapeProgram(scope, nullptr);
+  RuntimeProgram program(program_desc, scope);
+  // the cache is initialized by the second run
+  RunReshapeProgram(&program, scope, {2, 4}, {4, 2});
+  EXPECT_EQ(program.shape_plan_count(), 0u);
+  RunReshapeProgram(&program, scope, {2, 4}, {4, 2});
+  EXPECT_EQ(program.shape_plan_count(), 1u);
+  // a hit reuses the plan
+  RunReshapeProgram(&program, scope, {2, 4}, {4, 2});
+  EXPECT_EQ(program.shape_plan_count(), 1u);
+  // a miss records a new plan
+  RunReshapeProgram(&program, scope, {3, 4}, {6, 2});
+  EXPECT_EQ(program.shape_plan_count(), 2u);
+  RunReshapeProgram(&program, scope, {2, 4}, {4, 2});
+  // the least recently used plan of {3, 4} is evicted
+  RunReshapeProgram(&program, scope, {5, 2}, {5, 2});
+  EXPECT_EQ(program.shape_plan_count(), 2u);
+  RunReshapeProgram(&program, scope, {3, 4}, {6, 2});
+  RunReshapeProgram(&program, scope, {2, 4}, {4, 2});
+  EXPECT_EQ(program.shape_plan_count(), 2u);
+  unsetenv(SHAPE_PLAN_CACHE_SIZE);
+}
+
+TEST(RuntimeProgram, shape_plan_cache_shape_tensor) {
+  setenv(SHAPE_PLAN_CACHE_SIZE, "2", 1);
+  {
+    // the output shape depends on the data of the Shape tensor, which isn't a
+    // key of the plans, so the cache is disabled
+    Scope root;
+    auto* scope = &root.NewScope();
+    Tensor* shape = nullptr;
+    auto program_desc = BuildReshapeProgram(scope, &shape);
+    shape->Resize({2});
+    shape->mutable_data<int>()[0] = -1;
+    shape->mutable_data<int>()[1] = 2;
+    RuntimeProgram program(program_desc, scope);
+    RunReshapeProgram(&program, scope, {2, 4}, {4, 2});
+    RunReshapeProgram(&program, scope, {2, 4}, {4, 2});
+    RunReshapeProgram(&program, scope, {3, 4}, {6, 2});
+    RunReshapeProgram(&program, scope, {5, 2}, {5, 2});
+    RunReshapeProgram(&program, scope, {2, 4}, {4, 2});
+    EXPECT_EQ(program.shape_plan_count(), 0u);
+  }
+  {
+    // a persistable Shape tensor is constant, as the attr
+    Scope root;
+    auto* scope = &root.NewScope();
+    Tensor* shape = nullptr;
+    auto program_desc = BuildReshapeProgram(scope, &shape);
+    shape->Resize({2});
+    shape->mutable_data<int>()[0] = 8;
+    shape->mutable_data<int>()[1] = 1;
+    shape->set_persistable(true);
+    RuntimeProgram program(program_desc, scope);
+    for (int i = 0; i < 3; ++i) {
+      RunReshapeProgram(&program, scope, {2, 4}, {8, 1});
+    }
+    EXPECT_EQ(program.shape_plan_count(), 1u);
+  }
+  unsetenv(SHAPE_PLAN_CACHE_SIZE);
+}
+
+TEST(RuntimeProgram, memory_stats) {
+  Scope root;
+  auto* weight = root.Var("weight")->GetMutable<Tensor>();
+  FillTensor(weight, {16}, 0.f);
+  weight->set_persistable(true);
+  auto* scope = &root.NewScope();
+  auto program_desc = BuildReshapeProgram(scope, nullptr);
+  // out shares the buffer of y
+  program_desc->GetBlock<cpp::BlockDesc>(0)->GetOp<cpp::OpDesc>(1)->SetAttr(
+      "inplace", true);
+  // a stale activation which isn't used by the program
+  FillTensor(scope->Var("stale")->GetMutable<Tensor>(), {100}, 0.f);
+  RuntimeProgram program(program_desc, scope);
+  RunReshapeProgram(&program, scope, {2, 4}, {4, 2});
+  const auto& x = scope->FindVar("x")->Get<Tensor>();
+  const auto& y = scope->FindVar("y")->Get<Tensor>();
+  const auto& out = scope->FindVar("out")->Get<Tensor>();
+  const auto& stale = scope->FindVar("stale")->Get<Tensor>();
+  ASSERT_EQ(out.raw_data(), y.raw_data());
+
+  lite_api::MemoryStats stats;
+  program.GetMemoryStats(&stats, 10);
+  EXPECT_EQ(stats.weight_bytes, static_cast<int64_t>(weight->capacity()));
+  EXPECT_EQ(stats.planned_activation_bytes,
+            static_cast<int64_t>(x.memory_size() + y.memory_size()));
+  EXPECT_EQ(stats.live_activation_bytes,
+            static_cast<int64_t>(x.capacity() + y.capacity() +
+                                 stale.capacity()));
+  ASSERT_EQ(stats.top_tensors.size(), 4u);
+  for (size_t i = 1; i < stats.top_tensors.size(); ++i) {
+    EXPECT_GE(stats.top_tensors[i - 1].second, stats.top_tensors[i].second);
+  }
+  EXPECT_EQ(stats.top_tensors[0].first, "stale");
+  EXPECT_EQ(stats.top_tensors[1].first, "weight");
+
+  program.GetMemoryStats(&stats, 1);
+  ASSERT_EQ(stats.top_tensors.size(), 1u);
+  EXPECT_EQ(stats.top_tensors[0].first, "stale");
+  EXPECT_EQ(stats.top_tensors[0].second,
+            static_cast<int64_t>(stale.capacity()));
+}
+
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_OP(conv2d);
+USE_LITE_KERNEL(conv2d, kX86, kInt8, kNCHW, fp32_out);
+USE_LITE_OP(while);
+USE_LITE_OP(concat);
+USE_LITE_OP(assign);
+USE_LITE_OP(scale);
+USE_LITE_OP(elementwise_add);
+USE_LITE_OP(increment);
+USE_LITE_OP(less_than);
+USE_LITE_OP(reshape2);
+USE_LITE_KERNEL(while, kHost, kAny, kAny, def);
+USE_LITE_KERNEL(concat, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(assign, kHost, kAny, kAny, def);
+USE_LITE_KERNEL(scale, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(elementwise_add, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(increment, kHost, kAny, kNCHW, def);
+USE_LITE_KERNEL(less_than, kHost, kFloat, kAny, def);
+USE_LITE_KERNEL(reshape2, kHost, kAny, kAny, def);
@@ -0,0 +1,142 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/stream_states.h"
+#include <cstring>
+
+namespace paddle {
+namespace lite {
+
+void StreamStates::Bind(const std::string& input_name,
+                        const std::string& output_name) {
+  for (auto& binding : bindings_) {
+    CHECK(binding.input_name != input_name)
+        << "The state input " << input_name << " is bound twice.";
+    CHECK(binding.output_name != output_name)
+        << "The state output " << output_name << " is bound twice.";
+  }
+  Binding binding;
+  binding.input_name = input_name;
+  binding.output_name = output_name;
+  bindings_.push_back(binding);
+}
+
+int StreamStates::CreateStream() {
+  int id = next_id_++;
+  streams_[id].resize(bindings_.size());
+  return id;
+}
+
+int StreamStates::CloneStream(int id) {
+  auto& states = GetStream(id);
+  int new_id = next_id_++;
+  auto& new_states = streams_[new_id];
+  new_states.resize(states.size());
+  for (size_t i = 0; i < states.size(); i++) {
+    if (states[i].IsInitialized()) new_states[i].CopyDataFrom(states[i]);
+  }
+  return new_id;
+}
+
+void StreamStates::ResetStream(int id) {
+  auto& states = GetStream(id);
+  for (auto& state : states) {
+    state = Tensor();
+  }
+}
+
+void StreamStates::ReleaseStream(int id) {
+  CHECK(streams_.count(id)) << "There is no stream " << id;
+  streams_.erase(id);
+}
+
+std::vector<Tensor>& StreamStates::GetStream(int id) {
+  auto it = streams_.find(id);
+  CHECK(it != streams_.end()) << "There is no stream " << id;
+  // The states bound after the stream is created start from zeros.
+  it->second.resize(bindings_.size());
+  return it->second;
+}
+
+Tensor* StreamStates::GetVar(Scope* scope, const std::string& name) const {
+  auto* var = scope->FindVar(name);
+  CHECK(var) << "no state variable " << name << " in exec_scope";
+  return var->GetMutable<Tensor>();
+}
+
+void StreamStates::Attach(Scope* scope, int id) {
+  auto& states = GetStream(id);
+  for (size_t i = 0; i < bindings_.size(); i++) {
+    auto& binding = bindings_[i];
+    auto& state = states[i];
+    auto* input = GetVar(scope, binding.input_name);
+    if (!state.IsInitialized()) {
+      CHECK_GT(input->numel(), 0)
+          << "The dims of the state input " << binding.input_name
+          << " should be set before the first run of a stream.";
+      auto precision = input->precision();
+      if (precision == PRECISION(kUnk)) precision = PRECISION(kFloat);
+      size_t memory_size = input->numel() * PrecisionTypeLength(precision);
+      state.Resize(input->dims());
+      state.set_lod(input->lod());
+      state.set_precision(precision);
+      std::memset(
+          state.mutable_data(TARGET(kHost), memory_size), 0, memory_size);
+    }
+    input->ShareDataWith(state);
+
+    // The buffer of the last state output is held by a stream now, the kernel
+    // writes the state output of this run into the spare buffer instead.
+    auto* output = GetVar(scope, binding.output_name);
+    if (output->buffer().use_count() > 1) {
+      Tensor holder(binding.spare ? binding.spare : std::make_shared<Buffer>());
+      holder.Resize(output->dims());
+      holder.set_lod(output->lod());
+      holder.set_precision(output->precision());
+      output->ShareDataWith(holder);
+      binding.spare.reset();
+    }
+  }
+}
+
+void StreamStates::Sync(Scope* scope, int id) {
+  auto& states = GetStream(id);
+  for (size_t i = 0; i < bindings_.size(); i++) {
+    auto& binding = bindings_[i];
+    auto& state = states[i];
+    auto* output = GetVar(scope, binding.output_name);
+    CHECK(output->IsInitialized())
+        << "The state output " << binding.output_name << " is not produced.";
+    CHECK(output->target() == TARGET(kHost) ||
+          output->target() == TARGET(kX86) || output->target() == TARGET(kARM))
+        << "The state output " << binding.output_name
+        << " is not on the host.";
+    // The state is fed back as the state input, whose dims it was created with.
+    CHECK(!state.IsInitialized() || output->dims() == state.dims())
+        << "The dims " << output->dims() << " of the state output "
+        << binding.output_name << " mismatch the dims " << state.dims()
+        << " of the state input " << binding.input_name;
+    // The buffer is shared with another var, e.g. by reshape, which writes it
+    // again in the next run, so the state is copied out of it.
+    if (output->buffer().use_count() > 1 || output->offset() != 0) {
+      state.CopyDataFrom(*output);
+      continue;
+    }
+    binding.spare = state.buffer();
+    state.ShareDataWith(*output);
+  }
+}
+
+}  // namespace lite
+}  // namespace paddle
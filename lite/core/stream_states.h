@@ -0,0 +1,67 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "lite/core/scope.h"
+#include "lite/core/tensor.h"
+
+namespace paddle {
+namespace lite {
+
+// The recurrent states of the streams run by a predictor, e.g. the last hidden
+// and cell of lstm for every utterance of streaming ASR. A state output of a
+// run becomes the state input of the next run of the same stream by swapping
+// the buffers, so the states are neither copied nor passed through the API.
+class StreamStates {
+ public:
+  // Carry the output var `output_name` over to the input var `input_name`.
+  void Bind(const std::string& input_name, const std::string& output_name);
+  bool empty() const { return bindings_.empty(); }
+
+  // A new or reset stream starts from zeros with the dims of the state inputs.
+  int CreateStream();
+  int CloneStream(int id);
+  void ResetStream(int id);
+  void ReleaseStream(int id);
+
+  // Called before Run, share the states of stream `id` with the state inputs.
+  void Attach(Scope* scope, int id);
+  // Called after Run, take the state outputs as the states of stream `id`.
+  void Sync(Scope* scope, int id);
+
+ private:
+  struct Binding {
+    std::string input_name;
+    std::string output_name;
+    // The buffer released by the last Sync, the state output of the next run
+    // is written into it so that the state just taken is not overwritten.
+    std::shared_ptr<Buffer> spare;
+  };
+
+  std::vector<Tensor>& GetStream(int id);
+  Tensor* GetVar(Scope* scope, const std::string& name) const;
+
+  std::vector<Binding> bindings_;
+  // The states of every stream, one for each binding.
+  std::map<int, std::vector<Tensor>> streams_;
+  int next_id_{0};
+};
+
+}  // namespace lite
+}  // namespace paddle
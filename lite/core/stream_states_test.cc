@@ -0,0 +1,105 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/stream_states.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace paddle {
+namespace lite {
+
+static void PrepareScope(Scope* scope) {
+  scope->Var("h_in")->GetMutable<Tensor>()->Resize({4});
+  scope->Var("h_out")->GetMutable<Tensor>();
+}
+
+// Run a fake recurrent program of stream `id`, h_out = h_in + step with
+// `out_numel` values, and return the h_in seen by the run.
+static std::vector<float> RunStep(StreamStates* states,
+                                  Scope* scope,
+                                  int id,
+                                  float step,
+                                  int64_t out_numel = 4) {
+  states->Attach(scope, id);
+  auto* h_in = scope->FindVar("h_in")->GetMutable<Tensor>();
+  auto* h_out = scope->FindVar("h_out")->GetMutable<Tensor>();
+  const float* in = h_in->data<float>();
+  std::vector<float> seen(in, in + h_in->numel());
+  h_out->Resize({out_numel});
+  auto* out = h_out->mutable_data<float>(TARGET(kHost));
+  for (int64_t i = 0; i < out_numel; ++i) {
+    out[i] = (i < h_in->numel() ? in[i] : 0.f) + step;
+  }
+  states->Sync(scope, id);
+  return seen;
+}
+
+TEST(stream_states, carry_over) {
+  Scope scope;
+  PrepareScope(&scope);
+  StreamStates states;
+  states.Bind("h_in", "h_out");
+  int a = states.CreateStream();
+  int b = states.CreateStream();
+
+  // every stream starts from zeros, and sees the state of its last run
+  EXPECT_EQ(RunStep(&states, &scope, a, 1.f), std::vector<float>(4, 0.f));
+  EXPECT_EQ(RunStep(&states, &scope, a, 1.f), std::vector<float>(4, 1.f));
+  EXPECT_EQ(RunStep(&states, &scope, b, 10.f), std::vector<float>(4, 0.f));
+  EXPECT_EQ(RunStep(&states, &scope, a, 1.f), std::vector<float>(4, 2.f));
+  EXPECT_EQ(RunStep(&states, &scope, b, 10.f), std::vector<float>(4, 10.f));
+  EXPECT_EQ(RunStep(&states, &scope, a, 1.f), std::vector<float>(4, 3.f));
+
+  // a clone goes on from the state of the stream without changing it
+  int c = states.CloneStream(a);
+  EXPECT_EQ(RunStep(&states, &scope, c, 100.f), std::vector<float>(4, 4.f));
+  EXPECT_EQ(RunStep(&states, &scope, c, 100.f), std::vector<float>(4, 104.f));
+  EXPECT_EQ(RunStep(&states, &scope, a, 1.f), std::vector<float>(4, 4.f));
+}
+
+TEST(stream_states, reset_stream) {
+  Scope scope;
+  PrepareScope(&scope);
+  StreamStates states;
+  states.Bind("h_in", "h_out");
+  int a = states.CreateStream();
+  int b = states.CreateStream();
+  RunStep(&states, &scope, a, 1.f);
+  RunStep(&states, &scope, a, 1.f);
+  RunStep(&states, &scope, b, 10.f);
+
+  // only the reset stream starts from zeros again
+  states.ResetStream(a);
+  EXPECT_EQ(RunStep(&states, &scope, a, 1.f), std::vector<float>(4, 0.f));
+  EXPECT_EQ(RunStep(&states, &scope, a, 1.f), std::vector<float>(4, 1.f));
+  EXPECT_EQ(RunStep(&states, &scope, b, 10.f), std::vector<float>(4, 10.f));
+
+  states.ReleaseStream(b);
+  ASSERT_DEATH(RunStep(&states, &scope, b, 10.f), "There is no stream");
+}
+
+TEST(stream_states, mismatched_dims) {
+  Scope scope;
+  PrepareScope(&scope);
+  StreamStates states;
+  states.Bind("h_in", "h_out");
+  int a = states.CreateStream();
+  RunStep(&states, &scope, a, 1.f);
+
+  // a state output of 8 values can't be fed back to the state input of 4
+  ASSERT_DEATH(RunStep(&states, &scope, a, 1.f, 8), "mismatch the dims");
+}
+
+}  // namespace lite
+}  // namespace paddle
@@ -214,6 +214,10 @@ class TensorLite {
 
   size_t memory_size() const { return memory_size_; }
 
+  // Bytes held by the buffer, which may be shared with other tensors and is
+  // not shrunk when the tensor is resized.
+  size_t capacity() const { return buffer_->space(); }
+
   size_t offset() const { return offset_; }
 
   bool IsInitialized() const { return buffer_->data(); }
@@ -224,6 +228,7 @@ class TensorLite {
   void CopyDataFrom(const TensorLite &other);
 
   void ResetBuffer(std::shared_ptr<Buffer> buffer, size_t memory_size);
+  const std::shared_ptr<Buffer> &buffer() const { return buffer_; }
 
   TargetType target() const { return target_; }
   void set_target(TargetType target) { target_ = target; }
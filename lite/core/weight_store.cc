@@ -0,0 +1,168 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/weight_store.h"
+#include <cstring>
+#include <set>
+#include <string>
+
+namespace paddle {
+namespace lite {
+
+// The tensors smaller than it are not worth a lookup
+static const size_t kMinSharedBytes = 1024;
+
+static bool IsHostTarget(TargetType target) {
+  return target == TARGET(kHost) || target == TARGET(kX86) ||
+         target == TARGET(kARM);
+}
+
+static uint64_t HashBytes(const void* data, size_t size) {
+  const uint64_t kMul = 0x9ddfea08eb382d69ULL;
+  const char* bytes = static_cast<const char*>(data);
+  uint64_t hash = size * kMul;
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    uint64_t word;
+    std::memcpy(&word, bytes + i, sizeof(word));
+    hash = (hash ^ word) * kMul;
+    hash ^= hash >> 47;
+  }
+  for (; i < size; ++i) {
+    hash = (hash ^ static_cast<uint8_t>(bytes[i])) * kMul;
+  }
+  return hash ^ (hash >> 47);
+}
+
+// The vars written by the ops, e.g. the states updated in place
+static std::set<std::string> WrittenVars(const cpp::ProgramDesc& desc) {
+  std::set<std::string> names;
+  for (size_t i = 0; i < desc.BlocksSize(); ++i) {
+    auto* block = desc.GetBlock<cpp::BlockDesc>(i);
+    for (size_t j = 0; j < block->OpsSize(); ++j) {
+      auto* op = block->GetOp<cpp::OpDesc>(j);
+      for (auto& arg : op->output_vars()) {
+        names.insert(arg);
+      }
+    }
+  }
+  return names;
+}
+
+WeightStore& WeightStore::Global() {
+  static WeightStore x;
+  return x;
+}
+
+void WeightStore::Prune() {
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    auto& bucket = it->second;
+    for (auto entry = bucket.begin(); entry != bucket.end();) {
+      if (entry->buffer.expired()) {
+        entry = bucket.erase(entry);
+      } else {
+        ++entry;
+      }
+    }
+    it = bucket.empty() ? entries_.erase(it) : std::next(it);
+  }
+}
+
+size_t WeightStore::Share(const std::shared_ptr<Scope>& scope,
+                          const cpp::ProgramDesc& program_desc,
+                          const std::set<std::string>& skipped_vars) {
+  CHECK(scope);
+  auto written_vars = WrittenVars(program_desc);
+  std::lock_guard<std::mutex> lock(mutex_);
+  Prune();
+  size_t shared = 0;
+  for (auto& name : scope->LocalVarNames()) {
+    auto* var = scope->FindLocalVar(name);
+    if (!var || !var->IsType<Tensor>() || written_vars.count(name) ||
+        skipped_vars.count(name)) {
+      continue;
+    }
+    auto* tensor = var->GetMutable<Tensor>();
+    const size_t bytes = tensor->memory_size();
+    if (!tensor->persistable() || !tensor->IsInitialized() ||
+        tensor->offset() != 0 || !IsHostTarget(tensor->target()) ||
+        bytes < kMinSharedBytes) {
+      continue;
+    }
+    auto& bucket = entries_[HashBytes(tensor->raw_data(), bytes)];
+    Entry* found = nullptr;
+    for (auto& entry : bucket) {
+      auto buffer = entry.buffer.lock();
+      if (!buffer || entry.bytes != bytes ||
+          entry.precision != tensor->precision() ||
+          buffer->target() != tensor->target()) {
+        continue;
+      }
+      if (buffer == tensor->buffer()) {
+        // e.g. the scope is shared again
+        found = &entry;
+        break;
+      }
+      if (std::memcmp(buffer->data(), tensor->raw_data(), bytes) == 0) {
+        tensor->ResetBuffer(buffer, bytes);
+        ++shared;
+        found = &entry;
+        break;
+      }
+    }
+    if (!found) {
+      Entry entry;
+      entry.buffer = tensor->buffer();
+      entry.bytes = bytes;
+      entry.precision = tensor->precision();
+      bucket.push_back(entry);
+      found = &bucket.back();
+    }
+    bool registered = false;
+    for (auto& user : found->users) {
+      if (user.name == name && user.scope.lock() == scope) {
+        registered = true;
+        break;
+      }
+    }
+    if (!registered) {
+      found->users.push_back(User{scope, name});
+    }
+  }
+  VLOG(3) << "WeightStore shares " << shared << " tensors of the scope.";
+  return shared;
+}
+
+WeightStore::Stats WeightStore::GetStats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Prune();
+  Stats stats;
+  for (auto& it : entries_) {
+    for (auto& entry : it.second) {
+      int64_t live_users = 0;
+      for (auto& user : entry.users) {
+        if (!user.scope.expired()) ++live_users;
+      }
+      stats.resident_bytes += entry.bytes;
+      if (live_users > 1) {
+        stats.shared_tensors += live_users - 1;
+        stats.saved_bytes += (live_users - 1) * entry.bytes;
+      }
+    }
+  }
+  return stats;
+}
+
+}  // namespace lite
+}  // namespace paddle
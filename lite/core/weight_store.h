@@ -0,0 +1,88 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "lite/core/scope.h"
+#include "lite/core/tensor.h"
+#include "lite/model_parser/cpp_desc.h"
+
+namespace paddle {
+namespace lite {
+
+// A process-wide content-addressed store of the weights, so that the
+// predictors of the fine-tuned variants of a model hold one copy of the
+// weights they have in common.
+//
+// The persistable tensors of a root scope are hashed, and a tensor whose bytes
+// are identical to a tensor registered before is reset to share its Buffer.
+// The store only keeps weak references, a Buffer is freed when the last
+// tensor holding it is. The weights must not be written after they are
+// shared, same as the weights shared by the cloned predictors, so the tensors
+// written by an op of the program, and the ones rewritten in place by the
+// kernels, e.g. prepacked by PrepareForRun, are skipped.
+class WeightStore {
+ public:
+  struct Stats {
+    // Tensors reading a buffer registered by another tensor
+    int64_t shared_tensors{0};
+    // Bytes which would be held if the tensors weren't shared
+    int64_t saved_bytes{0};
+    // Bytes held by the buffers registered in the store
+    int64_t resident_bytes{0};
+  };
+
+  static WeightStore& Global();
+
+  // Share the persistable tensors of `scope` with the identical ones
+  // registered by the other scopes, and register the rest of them except
+  // `skipped_vars`, see RuntimeProgram::WeightsRewrittenInPlace. Return the
+  // number of the tensors which are reset to an existing buffer.
+  size_t Share(const std::shared_ptr<Scope>& scope,
+               const cpp::ProgramDesc& program_desc,
+               const std::set<std::string>& skipped_vars = {});
+
+  Stats GetStats();
+
+ private:
+  struct User {
+    std::weak_ptr<Scope> scope;
+    std::string name;
+  };
+  struct Entry {
+    std::weak_ptr<Buffer> buffer;
+    size_t bytes{0};
+    PrecisionType precision{PrecisionType::kUnk};
+    // One for each tensor sharing the buffer, a scope shared again doesn't
+    // add its tensors twice
+    std::vector<User> users;
+  };
+
+  WeightStore() = default;
+  // Remove the entries whose buffers are freed
+  void Prune();
+
+  std::mutex mutex_;
+  std::unordered_map<uint64_t, std::vector<Entry>> entries_;
+};
+
+}  // namespace lite
+}  // namespace paddle
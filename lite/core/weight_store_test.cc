@@ -0,0 +1,246 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/weight_store.h"
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "lite/core/op_registry.h"
+#include "lite/core/program.h"
+
+namespace paddle {
+namespace lite {
+
+static Tensor* AddWeight(Scope* scope,
+                         const std::string& name,
+                         int64_t numel,
+                         float value) {
+  auto* tensor = scope->Var(name)->GetMutable<Tensor>();
+  tensor->Resize({numel});
+  auto* data = tensor->mutable_data<float>();
+  for (int64_t i = 0; i < numel; ++i) {
+    data[i] = value + i;
+  }
+  tensor->set_persistable(true);
+  return tensor;
+}
+
+// A program whose only op writes `written_var`
+static cpp::ProgramDesc BuildProgramDesc(const std::string& written_var) {
+  cpp::ProgramDesc program_desc;
+  auto* block_desc = program_desc.AddBlock<cpp::BlockDesc>();
+  block_desc->ClearOps();
+  block_desc->ClearVars();
+  auto* op_desc = block_desc->AddOp<cpp::OpDesc>();
+  op_desc->SetType("assign");
+  op_desc->SetInput("X", {"x"});
+  op_desc->SetOutput("Out", {written_var});
+  return program_desc;
+}
+
+// The stats are compared by the deltas, the store is process-wide
+static int64_t SharedTensorsDelta(const WeightStore::Stats& base) {
+  return WeightStore::Global().GetStats().shared_tensors - base.shared_tensors;
+}
+
+TEST(weight_store, share_identical_weights) {
+  auto& store = WeightStore::Global();
+  auto base = store.GetStats();
+  auto program_desc = BuildProgramDesc("out");
+  const int64_t numel = 1024;
+
+  auto scope0 = std::make_shared<Scope>();
+  auto* w0 = AddWeight(scope0.get(), "w", numel, 1.f);
+  AddWeight(scope0.get(), "b", numel, 2.f);
+  // too small to be shared
+  AddWeight(scope0.get(), "small", 4, 1.f);
+  EXPECT_EQ(store.Share(scope0, program_desc), 0u);
+  EXPECT_EQ(SharedTensorsDelta(base), 0);
+
+  auto scope1 = std::make_shared<Scope>();
+  auto* w1 = AddWeight(scope1.get(), "w", numel, 1.f);
+  // same bytes by another name
+  auto* b1 = AddWeight(scope1.get(), "bias", numel, 2.f);
+  auto* other1 = AddWeight(scope1.get(), "other", numel, 3.f);
+  auto* small1 = AddWeight(scope1.get(), "small", 4, 1.f);
+  EXPECT_EQ(store.Share(scope1, program_desc), 2u);
+  EXPECT_EQ(w1->raw_data(), w0->raw_data());
+  EXPECT_EQ(b1->raw_data(),
+            scope0->FindVar("b")->GetMutable<Tensor>()->raw_data());
+  EXPECT_NE(other1->raw_data(), w0->raw_data());
+  EXPECT_NE(small1->raw_data(),
+            scope0->FindVar("small")->GetMutable<Tensor>()->raw_data());
+  EXPECT_EQ(w1->data<float>()[numel - 1], 1.f + numel - 1);
+  EXPECT_EQ(SharedTensorsDelta(base), 2);
+  EXPECT_EQ(store.GetStats().saved_bytes - base.saved_bytes,
+            2 * numel * static_cast<int64_t>(sizeof(float)));
+
+  // the users of a scope shared again are counted once
+  EXPECT_EQ(store.Share(scope0, program_desc), 0u);
+  EXPECT_EQ(store.Share(scope1, program_desc), 0u);
+  EXPECT_EQ(SharedTensorsDelta(base), 2);
+
+  // the weights of a destroyed scope are no longer counted
+  scope1.reset();
+  EXPECT_EQ(SharedTensorsDelta(base), 0);
+  scope0.reset();
+  EXPECT_EQ(store.GetStats().resident_bytes, base.resident_bytes);
+}
+
+TEST(weight_store, skip_written_vars) {
+  auto& store = WeightStore::Global();
+  auto base = store.GetStats();
+  auto program_desc = BuildProgramDesc("state");
+  const int64_t numel = 1024;
+
+  auto scope0 = std::make_shared<Scope>();
+  AddWeight(scope0.get(), "state", numel, 5.f);
+  store.Share(scope0, program_desc);
+  auto scope1 = std::make_shared<Scope>();
+  auto* state1 = AddWeight(scope1.get(), "state", numel, 5.f);
+  EXPECT_EQ(store.Share(scope1, program_desc), 0u);
+  EXPECT_NE(state1->raw_data(),
+            scope0->FindVar("state")->GetMutable<Tensor>()->raw_data());
+  EXPECT_EQ(SharedTensorsDelta(base), 0);
+}
+
+// Prepack X in place by doubling it at the first run, the way the arm int8
+// fc prepacks its weights, and compute out = unpack(X).
+class PrepackInPlaceCompute
+    : public KernelLite<TARGET(kHost), PRECISION(kFloat)> {
+ public:
+  using param_t = operators::ScaleParam;
+
+  void PrepareForRun() override {
+    auto& param = this->Param<param_t>();
+    Tensor packed;
+    packed.Resize(param.x->dims());
+    auto* packed_data = packed.mutable_data<float>();
+    for (int64_t i = 0; i < packed.numel(); ++i) {
+      packed_data[i] = param.x->data<float>()[i] * 2.f;
+    }
+    const_cast<Tensor*>(param.x)->CopyDataFrom(packed);
+  }
+
+  void Run() override {
+    auto& param = this->Param<param_t>();
+    auto* out = param.output->mutable_data<float>();
+    for (int64_t i = 0; i < param.x->numel(); ++i) {
+      out[i] = param.x->data<float>()[i] / 2.f;
+    }
+  }
+
+  std::vector<std::string> WeightsRewrittenInPlace() const override {
+    return {"X"};
+  }
+};
+
+// A predictor of one prepacking kernel reading the weight w
+struct PrepackPredictor {
+  explicit PrepackPredictor(int64_t numel) {
+    scope = std::make_shared<Scope>();
+    AddWeight(scope.get(), "w", numel, 1.f);
+    scope->Var("out")->GetMutable<Tensor>();
+    program_desc = BuildProgramDesc("out");
+    auto* op_desc =
+        program_desc.GetBlock<cpp::BlockDesc>(0)->GetOp<cpp::OpDesc>(0);
+    op_desc->SetType("scale");
+    op_desc->SetInput("X", {"w"});
+    op_desc->SetAttr<float>("scale", 1.f);
+    op_desc->SetAttr<float>("bias", 0.f);
+    op_desc->SetAttr<bool>("bias_after_scale", true);
+    auto op = LiteOpRegistry::Global().Create("scale");
+    op->Attach(*op_desc, scope.get());
+    std::unique_ptr<KernelBase> kernel(new PrepackInPlaceCompute);
+    op->AttachKernel(kernel.get());
+    std::vector<std::vector<Instruction>> insts(1);
+    insts[0].emplace_back(op, std::move(kernel));
+    program.reset(new RuntimeProgram(std::move(insts)));
+  }
+
+  const float* Run() {
+    program->mutable_instructions()->front().Run();
+    return scope->FindVar("out")->Get<Tensor>().data<float>();
+  }
+
+  std::shared_ptr<Scope> scope;
+  cpp::ProgramDesc program_desc;
+  std::unique_ptr<RuntimeProgram> program;
+};
+
+TEST(weight_store, skip_weights_rewritten_in_place) {
+  auto& store = WeightStore::Global();
+  auto base = store.GetStats();
+  const int64_t numel = 1024;
+
+  PrepackPredictor predictor0(numel);
+  PrepackPredictor predictor1(numel);
+  EXPECT_EQ(predictor0.program->WeightsRewrittenInPlace(),
+            std::set<std::string>{"w"});
+  store.Share(predictor0.scope,
+              predictor0.program_desc,
+              predictor0.program->WeightsRewrittenInPlace());
+  EXPECT_EQ(store.Share(predictor1.scope,
+                        predictor1.program_desc,
+                        predictor1.program->WeightsRewrittenInPlace()),
+            0u);
+  EXPECT_EQ(SharedTensorsDelta(base), 0);
+
+  // each predictor packs its own weights once
+  for (auto* predictor : {&predictor0, &predictor1, &predictor0}) {
+    const float* out = predictor->Run();
+    for (int64_t i = 0; i < numel; ++i) {
+      ASSERT_EQ(out[i], 1.f + i);
+    }
+  }
+}
+
+TEST(weight_store, weights_rewritten_in_place_without_skip) {
+  // the failure avoided above: the weights packed by the first predictor are
+  // packed again by the second one
+  const int64_t numel = 1024;
+  PrepackPredictor predictor0(numel);
+  PrepackPredictor predictor1(numel);
+  auto& store = WeightStore::Global();
+  store.Share(predictor0.scope, predictor0.program_desc);
+  EXPECT_EQ(store.Share(predictor1.scope, predictor1.program_desc), 1u);
+  EXPECT_EQ(predictor0.Run()[1], 2.f);
+  EXPECT_EQ(predictor1.Run()[1], 4.f);
+}
+
+#ifdef LITE_WITH_ARM
+TEST(weight_store, arm_kernels_rewritten_in_place) {
+  for (auto op_type : {"fc", "conv2d_transpose"}) {
+    auto kernels = KernelRegistry::Global().Create(op_type);
+    bool found_int8 = false;
+    for (auto& kernel : kernels) {
+      if (kernel->target() != TARGET(kARM)) continue;
+      if (kernel->precision() == PRECISION(kInt8)) {
+        found_int8 = true;
+        EXPECT_FALSE(kernel->WeightsRewrittenInPlace().empty());
+      } else if (kernel->precision() == PRECISION(kFloat)) {
+        EXPECT_TRUE(kernel->WeightsRewrittenInPlace().empty());
+      }
+    }
+    EXPECT_TRUE(found_int8) << op_type;
+  }
+}
+#endif
+
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_OP(scale);
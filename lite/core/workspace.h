@@ -49,6 +49,9 @@ class WorkSpace {
     return data;
   }
 
+  // Bytes held by the workspace, i.e. its high-water mark.
+  size_t space() const { return buffer_.space(); }
+
   static WorkSpace& Global_Host() {
     static LITE_THREAD_LOCAL std::unique_ptr<WorkSpace> x(
         new WorkSpace(TARGET(kHost)));
@@ -32,6 +32,14 @@ class Conv2DTransposeCompute : public KernelLite<TARGET(kARM), Ptype> {
 
   void Run() override;
 
+  // the int8 and fp16 filters are prepacked into Filter by PrepareForRun
+  std::vector<std::string> WeightsRewrittenInPlace() const override {
+    if (Ptype == PRECISION(kInt8) || Ptype == PRECISION(kFP16)) {
+      return {"Filter"};
+    }
+    return {};
+  }
+
   virtual void ReInitWhenNeeded() {
     auto& param = this->template Param<param_t>();
     auto x_dims = param.x->dims();
@@ -33,6 +33,12 @@ class FcCompute : public KernelLite<TARGET(kARM), PType> {
   virtual void PrepareForRun();
   virtual void Run();
 
+  // the int8 weights are prepacked into W by PrepareForRun
+  std::vector<std::string> WeightsRewrittenInPlace() const override {
+    if (PType == PRECISION(kInt8)) return {"W"};
+    return {};
+  }
+
   ~FcCompute() = default;
 
  private:
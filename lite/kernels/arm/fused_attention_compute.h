@@ -31,6 +31,12 @@ class FusedAttentionCompute : public KernelLite<TARGET(kARM), PType> {
   virtual void PrepareForRun();
   virtual void Run();
 
+  // the int8 fc weights are prepacked into W by PrepareForRun
+  std::vector<std::string> WeightsRewrittenInPlace() const override {
+    if (PType == PRECISION(kInt8)) return {"W"};
+    return {};
+  }
+
   virtual ~FusedAttentionCompute() = default;
 
  private:
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #pragma once
+#include "lite/backends/host/math/beam_search.h"
 #include "lite/core/kernel.h"
 #include "lite/core/op_registry.h"
 
@@ -28,6 +29,8 @@ class BeamSearchCompute : public KernelLite<TARGET(kHost), PRECISION(kFloat)> {
   virtual ~BeamSearchCompute() = default;
 
  private:
+  // The buffers reused by the decoding steps.
+  lite::host::math::BeamSearchState state_;
 };
 
 }  // namespace host
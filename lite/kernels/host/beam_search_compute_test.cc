@@ -0,0 +1,381 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/kernels/host/beam_search_compute.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "lite/core/op_registry.h"
+#include "lite/kernels/host/beam_search_decode_compute.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace host {
+
+static const int kEndId = 0;
+static const int kVocab = 6;
+static const int kBeamSize = 3;
+
+// The reference beam search, which gathers the top candidates of every
+// source into a vector per prefix, as the kernel did before it kept its
+// state.
+struct RefItem {
+  size_t offset;
+  int64_t id;
+  float score;
+  bool operator<(const RefItem& in) const {
+    return score < in.score || (score == in.score && offset < in.offset);
+  }
+};
+
+static void RefInsert(std::vector<RefItem>* top, const RefItem& item) {
+  if (top->size() == static_cast<size_t>(kBeamSize)) {
+    if (item < top->back()) return;
+    top->pop_back();
+  }
+  auto it = top->begin();
+  while (it != top->end() && !(*it < item)) ++it;
+  top->insert(it, item);
+}
+
+static void RefBeamSearch(const Tensor& pre_ids,
+                          const Tensor& pre_scores,
+                          const Tensor* ids,
+                          const Tensor& scores,
+                          bool is_accumulated,
+                          Tensor* selected_ids,
+                          Tensor* selected_scores,
+                          Tensor* parent_idx) {
+  // the rows of the sources, the candidates have a row each at level 1
+  LoD abs_lod = scores.lod();
+  for (auto& offset : abs_lod[0]) offset = abs_lod[1][offset];
+  const auto& high_level = abs_lod[0];
+  const int64_t width = scores.dims()[1];
+  std::vector<std::vector<RefItem>> per_offset(high_level.back());
+  for (size_t src = 0; src + 1 < high_level.size(); ++src) {
+    std::vector<RefItem> top;
+    for (size_t offset = high_level[src]; offset < high_level[src + 1];
+         ++offset) {
+      const int64_t pre_id = pre_ids.data<int64_t>()[offset];
+      const float pre_score = pre_scores.data<float>()[offset];
+      if (pre_id == kEndId) {
+        RefInsert(&top, {offset, kEndId, pre_score});
+        continue;
+      }
+      for (int64_t d = 0; d < width; ++d) {
+        const int64_t index = offset * width + d;
+        const float prob = scores.data<float>()[index];
+        RefInsert(&top,
+                  {offset,
+                   ids ? ids->data<int64_t>()[index] : d,
+                   is_accumulated ? prob : pre_score + std::log(prob)});
+      }
+    }
+    // the source is pruned one step after all its branches end
+    bool finished = true;
+    for (auto& item : top) {
+      if (item.id != kEndId || pre_ids.data<int64_t>()[item.offset] != kEndId) {
+        finished = false;
+      }
+    }
+    if (finished) continue;
+    for (auto& item : top) per_offset[item.offset].push_back(item);
+  }
+
+  std::vector<int64_t> out_ids;
+  std::vector<float> out_scores;
+  std::vector<int> out_parents;
+  LoD lod(2);
+  lod[0].assign(high_level.begin(), high_level.end());
+  lod[1].push_back(0);
+  for (size_t offset = 0; offset < per_offset.size(); ++offset) {
+    for (auto& item : per_offset[offset]) {
+      out_ids.push_back(item.id);
+      out_scores.push_back(item.score);
+      out_parents.push_back(static_cast<int>(offset));
+    }
+    lod[1].push_back(out_ids.size());
+  }
+  const int64_t num = out_ids.size();
+  selected_ids->Resize({num, 1});
+  selected_scores->Resize({num, 1});
+  parent_idx->Resize({num});
+  std::copy(out_ids.begin(),
+            out_ids.end(),
+            selected_ids->mutable_data<int64_t>());
+  std::copy(out_scores.begin(),
+            out_scores.end(),
+            selected_scores->mutable_data<float>());
+  std::copy(out_parents.begin(),
+            out_parents.end(),
+            parent_idx->mutable_data<int>());
+  selected_ids->set_lod(lod);
+  selected_scores->set_lod(lod);
+}
+
+// The reference decoding, which backtraces the sentences of every source
+// from the step it finished at, skips the redundant end ids, and sorts the
+// sentences of a source by their final scores.
+static void RefBeamSearchDecode(const std::vector<Tensor>& step_ids,
+                                const std::vector<Tensor>& step_scores,
+                                Tensor* sentence_ids,
+                                Tensor* sentence_scores) {
+  struct Sentence {
+    std::vector<int64_t> word_ids;
+    std::vector<float> scores;
+  };
+  const size_t src_num = step_ids[0].lod()[0].size() - 1;
+  std::vector<std::vector<Sentence>> sentence_list(
+      src_num, std::vector<Sentence>(kBeamSize));
+  std::vector<std::vector<size_t>> prefix_list(src_num);
+  for (int step = static_cast<int>(step_ids.size()) - 1; step >= 0; --step) {
+    const auto& lod = step_ids[step].lod();
+    const int64_t* ids = step_ids[step].data<int64_t>();
+    const float* scores = step_scores[step].data<float>();
+    for (size_t src = 0; src < src_num; ++src) {
+      auto& sentences = sentence_list[src];
+      auto& prefixes = prefix_list[src];
+      const size_t prefix_start = lod[0][src];
+      const size_t prefix_end = lod[0][src + 1];
+      if (prefixes.empty()) {
+        // the source finished at this step or this is the last step
+        for (size_t p = prefix_start; p < prefix_end; ++p) {
+          for (size_t c = lod[1][p]; c < lod[1][p + 1]; ++c) {
+            prefixes.push_back(p);
+            auto& sentence = sentences[prefixes.size() - 1];
+            sentence.word_ids.push_back(ids[c]);
+            sentence.scores.push_back(scores[c]);
+          }
+        }
+        continue;
+      }
+      // a prefix of the next step is a candidate of this step
+      for (size_t i = 0; i < prefixes.size(); ++i) {
+        const size_t c = prefixes[i];
+        auto& sentence = sentences[i];
+        if (ids[c] != kEndId || sentence.word_ids.empty()) {
+          sentence.word_ids.push_back(ids[c]);
+          sentence.scores.push_back(scores[c]);
+        }
+        size_t p = prefix_start;
+        while (lod[1][p + 1] <= c) ++p;
+        prefixes[i] = p;
+      }
+    }
+  }
+
+  std::vector<int64_t> id_data;
+  std::vector<float> score_data;
+  LoD lod(2, std::vector<uint64_t>{0});
+  for (auto& sentences : sentence_list) {
+    std::stable_sort(sentences.begin(),
+                     sentences.end(),
+                     [](const Sentence& a, const Sentence& b) {
+                       return a.scores.front() > b.scores.front();
+                     });
+    for (auto& sentence : sentences) {
+      id_data.insert(
+          id_data.end(), sentence.word_ids.rbegin(), sentence.word_ids.rend());
+      score_data.insert(
+          score_data.end(), sentence.scores.rbegin(), sentence.scores.rend());
+      lod[1].push_back(id_data.size());
+    }
+    lod[0].push_back(lod[0].back() + sentences.size());
+  }
+  sentence_ids->Resize({static_cast<int64_t>(id_data.size())});
+  sentence_scores->Resize({static_cast<int64_t>(score_data.size())});
+  std::copy(
+      id_data.begin(), id_data.end(), sentence_ids->mutable_data<int64_t>());
+  std::copy(score_data.begin(),
+            score_data.end(),
+            sentence_scores->mutable_data<float>());
+  sentence_ids->set_lod(lod);
+  sentence_scores->set_lod(lod);
+}
+
+template <typename T>
+static void ExpectTensorEq(const Tensor& out, const Tensor& ref) {
+  ASSERT_EQ(out.dims(), ref.dims());
+  EXPECT_EQ(out.lod(), ref.lod());
+  for (int64_t i = 0; i < ref.numel(); ++i) {
+    EXPECT_EQ(out.data<T>()[i], ref.data<T>()[i]) << i;
+  }
+}
+
+// Generates the candidates of the decoding steps. With `ties` the
+// probabilities take a few values only, so many candidates tie.
+class CandidateGenerator {
+ public:
+  CandidateGenerator(bool with_ids, bool is_accumulated, bool ties)
+      : with_ids_(with_ids), is_accumulated_(is_accumulated), ties_(ties) {}
+
+  // Fill the candidates of the prefixes in pre_ids, every prefix has a row.
+  void Next(const Tensor& pre_ids,
+            const Tensor& pre_scores,
+            Tensor* ids,
+            Tensor* scores) {
+    const int64_t rows = pre_ids.dims()[0];
+    const int width = with_ids_ ? 2 : kVocab;
+    scores->Resize({rows, width});
+    scores->set_lod(pre_ids.lod());
+    auto* scores_data = scores->mutable_data<float>();
+    int64_t* ids_data = nullptr;
+    if (with_ids_) {
+      ids->Resize({rows, width});
+      ids->set_lod(pre_ids.lod());
+      ids_data = ids->mutable_data<int64_t>();
+    }
+    std::uniform_real_distribution<float> uniform(0.05f, 1.f);
+    std::uniform_int_distribution<int> level(1, 3);
+    std::uniform_int_distribution<int> word(0, kVocab - 1);
+    for (int64_t r = 0; r < rows; ++r) {
+      for (int d = 0; d < width; ++d) {
+        float prob = ties_ ? 0.25f * level(rng_) : uniform(rng_);
+        // the end id is likely, so the beams end within a few steps
+        const int64_t id = with_ids_ ? word(rng_) : d;
+        if (id == kEndId) prob = std::min(1.f, prob + 0.5f);
+        if (ids_data) ids_data[r * width + d] = id;
+        scores_data[r * width + d] =
+            is_accumulated_ ? pre_scores.data<float>()[r] + std::log(prob)
+                            : prob;
+      }
+    }
+  }
+
+ private:
+  bool with_ids_;
+  bool is_accumulated_;
+  bool ties_;
+  std::mt19937 rng_{2023};
+};
+
+// Run the decoding loop with the kernel and the reference, and collect the
+// selected candidates of the steps.
+static void RunDecodingLoop(bool with_ids,
+                            bool is_accumulated,
+                            bool ties,
+                            std::vector<Tensor>* step_ids,
+                            std::vector<Tensor>* step_scores) {
+  const int num_src = 3;
+  Tensor pre_ids, pre_scores, ids, scores;
+  pre_ids.Resize({num_src, 1});
+  pre_scores.Resize({num_src, 1});
+  LoD lod(2);
+  for (int i = 0; i <= num_src; ++i) {
+    lod[0].push_back(i);
+    lod[1].push_back(i);
+  }
+  for (int i = 0; i < num_src; ++i) {
+    pre_ids.mutable_data<int64_t>()[i] = 1;
+    pre_scores.mutable_data<float>()[i] = 0.f;
+  }
+  pre_ids.set_lod(lod);
+  pre_scores.set_lod(lod);
+
+  BeamSearchCompute kernel;
+  operators::BeamSearchParam param;
+  Tensor selected_ids, selected_scores, parent_idx;
+  param.pre_ids = &pre_ids;
+  param.pre_scores = &pre_scores;
+  param.ids = with_ids ? &ids : nullptr;
+  param.scores = &scores;
+  param.selected_ids = &selected_ids;
+  param.selected_scores = &selected_scores;
+  param.parent_idx = &parent_idx;
+  param.level = 0;
+  param.beam_size = kBeamSize;
+  param.end_id = kEndId;
+  param.is_accumulated = is_accumulated;
+  kernel.SetParam(param);
+
+  CandidateGenerator generator(with_ids, is_accumulated, ties);
+  for (int step = 0; step < 12 && pre_ids.numel() > 0; ++step) {
+    generator.Next(pre_ids, pre_scores, &ids, &scores);
+    kernel.Run();
+    Tensor ref_ids, ref_scores, ref_parent;
+    RefBeamSearch(pre_ids,
+                  pre_scores,
+                  with_ids ? &ids : nullptr,
+                  scores,
+                  is_accumulated,
+                  &ref_ids,
+                  &ref_scores,
+                  &ref_parent);
+    ExpectTensorEq<int64_t>(selected_ids, ref_ids);
+    ExpectTensorEq<float>(selected_scores, ref_scores);
+    ExpectTensorEq<int>(parent_idx, ref_parent);
+
+    step_ids->emplace_back();
+    step_ids->back().CopyDataFrom(selected_ids);
+    step_scores->emplace_back();
+    step_scores->back().CopyDataFrom(selected_scores);
+    pre_ids.CopyDataFrom(selected_ids);
+    pre_scores.CopyDataFrom(selected_scores);
+  }
+  // the sources are pruned at last
+  EXPECT_EQ(pre_ids.numel(), 0);
+}
+
+TEST(beam_search_host, compute) {
+  for (bool with_ids : {false, true}) {
+    for (bool is_accumulated : {false, true}) {
+      for (bool ties : {false, true}) {
+        std::vector<Tensor> step_ids, step_scores;
+        RunDecodingLoop(
+            with_ids, is_accumulated, ties, &step_ids, &step_scores);
+      }
+    }
+  }
+}
+
+TEST(beam_search_decode_host, compute) {
+  for (bool is_accumulated : {false, true}) {
+    for (bool ties : {false, true}) {
+      std::vector<Tensor> step_ids, step_scores;
+      RunDecodingLoop(false, is_accumulated, ties, &step_ids, &step_scores);
+      ASSERT_GT(step_ids.size(), 1u);
+
+      Tensor ref_ids, ref_scores;
+      RefBeamSearchDecode(step_ids, step_scores, &ref_ids, &ref_scores);
+
+      BeamSearchDecodeCompute kernel;
+      operators::BeamSearchDecodeParam param;
+      Tensor sentence_ids, sentence_scores;
+      param.ids = &step_ids;
+      param.scores = &step_scores;
+      param.sentence_ids = &sentence_ids;
+      param.sentence_scores = &sentence_scores;
+      param.beam_size = kBeamSize;
+      param.end_id = kEndId;
+      kernel.SetParam(param);
+      kernel.Run();
+
+      ExpectTensorEq<int64_t>(sentence_ids, ref_ids);
+      ExpectTensorEq<float>(sentence_scores, ref_scores);
+      // every source keeps its beam of sentences
+      EXPECT_EQ(sentence_ids.lod()[0].back(), 3u * kBeamSize);
+    }
+  }
+}
+
+}  // namespace host
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_KERNEL(beam_search, kHost, kFloat, kNCHW, def);
+USE_LITE_KERNEL(beam_search_decode, kHost, kFloat, kNCHW, def);
@@ -58,23 +58,25 @@ struct BeamSearchDecoder {
    *  sort_by_score: whether to sort hypotheses of each sentence by scores.
    */
   void ConvertSentenceVectorToLodTensor(
-      std::vector<SentenceVector<T>> sentence_vector_list,
+      std::vector<SentenceVector<T>>* sentence_vector_list,
       LoDTensor* id_tensor,
       LoDTensor* score_tensor,
       bool reverse = true,
       bool sort_by_score = true) const {
-    size_t src_num = sentence_vector_list.size();
+    size_t src_num = sentence_vector_list->size();
     CHECK_GT(src_num, 0) << "src_num should not be 0";
 
-    std::vector<uint64_t> source_level_lod = {0};
-    std::vector<uint64_t> sentence_level_lod = {0};
-    std::vector<int64_t> id_data;
-    std::vector<T> score_data;
+    LoD lod(2);
+    std::vector<uint64_t>& source_level_lod = lod[kSourceLevel];
+    std::vector<uint64_t>& sentence_level_lod = lod[kSentenceLevel];
+    source_level_lod.push_back(0);
+    sentence_level_lod.push_back(0);
 
     for (size_t src_idx = 0; src_idx < src_num; ++src_idx) {
+      auto& sentence_vector = sentence_vector_list->at(src_idx);
       if (sort_by_score) {
-        std::stable_sort(sentence_vector_list[src_idx].begin(),
-                         sentence_vector_list[src_idx].end(),
+        std::stable_sort(sentence_vector.begin(),
+                         sentence_vector.end(),
                          [reverse](const Sentence<T>& a, const Sentence<T>& b) {
                            if (reverse)
                              return a.scores.front() > b.scores.front();
@@ -82,49 +84,37 @@ struct BeamSearchDecoder {
                              return a.scores.back() > b.scores.back();
                          });
       }
-      for (Sentence<T>& sentence : sentence_vector_list[src_idx]) {
-        if (reverse) {
-          id_data.insert(id_data.end(),
-                         sentence.word_ids.rbegin(),
-                         sentence.word_ids.rend());
-          score_data.insert(score_data.end(),
-                            sentence.scores.rbegin(),
-                            sentence.scores.rend());
-        } else {
-          id_data.insert(id_data.end(),
-                         sentence.word_ids.begin(),
-                         sentence.word_ids.end());
-          score_data.insert(
-              score_data.end(), sentence.scores.begin(), sentence.scores.end());
-        }
-
+      for (const Sentence<T>& sentence : sentence_vector) {
         sentence_level_lod.push_back(sentence_level_lod.back() +
                                      sentence.word_ids.size());
       }
       source_level_lod.push_back(source_level_lod.back() +
-                                 sentence_vector_list[src_idx].size());
+                                 sentence_vector.size());
     }
 
-    LoD lod;
-    lod.push_back(source_level_lod);
-    lod.push_back(sentence_level_lod);
-
-    id_tensor->set_lod(lod);
-
-    id_tensor->Resize({static_cast<int64_t>(id_data.size())});
+    // Write the sentences to the outputs directly.
+    const int64_t total = static_cast<int64_t>(sentence_level_lod.back());
+    id_tensor->Resize({total});
+    score_tensor->Resize({total});
     auto id_ptr = id_tensor->mutable_data<int64_t>();
-    TargetCopy(TARGET(kHost),
-               id_ptr,
-               id_data.data(),
-               id_data.size() * sizeof(int64_t));
-
-    score_tensor->set_lod(lod);
-    score_tensor->Resize({static_cast<int64_t>(score_data.size())});
     auto score_ptr = score_tensor->mutable_data<T>();
-    TargetCopy(TARGET(kHost),
-               score_ptr,
-               score_data.data(),
-               score_data.size() * sizeof(T));
+    for (auto& sentence_vector : *sentence_vector_list) {
+      for (const Sentence<T>& sentence : sentence_vector) {
+        if (reverse) {
+          id_ptr = std::copy(
+              sentence.word_ids.rbegin(), sentence.word_ids.rend(), id_ptr);
+          score_ptr = std::copy(
+              sentence.scores.rbegin(), sentence.scores.rend(), score_ptr);
+        } else {
+          id_ptr = std::copy(
+              sentence.word_ids.begin(), sentence.word_ids.end(), id_ptr);
+          score_ptr = std::copy(
+              sentence.scores.begin(), sentence.scores.end(), score_ptr);
+        }
+      }
+    }
+    id_tensor->set_lod(lod);
+    score_tensor->set_lod(lod);
   }
 
   /**
@@ -142,47 +132,54 @@ struct BeamSearchDecoder {
     const size_t src_num = step_ids.at(0).lod().at(kSourceLevel).size() - 1;
     std::vector<SentenceVector<T>> sentence_vector_list(
         src_num, SentenceVector<T>(beam_size_));
+    // A sentence has a word at most per step.
+    for (auto& sentence_vector : sentence_vector_list) {
+      for (auto& sentence : sentence_vector) {
+        sentence.word_ids.reserve(step_num);
+        sentence.scores.reserve(step_num);
+      }
+    }
     std::vector<std::vector<size_t>> prefix_idx_vector_list(src_num);
     for (int step_id = step_num - 1; step_id >= 0; --step_id) {
       auto& cur_ids = step_ids.at(step_id);
       auto& cur_scores = step_scores.at(step_id);
+      const auto& source_lod = cur_ids.lod().at(kSourceLevel);
+      const auto& sentence_lod = cur_ids.lod().at(kSentenceLevel);
+      const int64_t* cur_ids_data = cur_ids.data<int64_t>();
+      const T* cur_scores_data = cur_scores.data<T>();
       for (size_t src_idx = 0; src_idx < src_num; ++src_idx) {
         // for each source sentence
         auto& sentence_vector = sentence_vector_list.at(src_idx);
         auto& prefix_idx_vector = prefix_idx_vector_list.at(src_idx);
-        size_t src_prefix_start = cur_ids.lod().at(kSourceLevel)[src_idx];
-        size_t src_prefix_end = cur_ids.lod().at(kSourceLevel)[src_idx + 1];
+        size_t src_prefix_start = source_lod[src_idx];
+        size_t src_prefix_end = source_lod[src_idx + 1];
         if (prefix_idx_vector.empty()) {  // be finished and pruned at this step
           // or the last time step
           for (size_t prefix_idx = src_prefix_start;
                prefix_idx < src_prefix_end;
                ++prefix_idx) {
-            size_t candidate_start =
-                cur_ids.lod().at(kSentenceLevel)[prefix_idx];
-            size_t candidate_end =
-                cur_ids.lod().at(kSentenceLevel)[prefix_idx + 1];
+            size_t candidate_start = sentence_lod[prefix_idx];
+            size_t candidate_end = sentence_lod[prefix_idx + 1];
             for (size_t candidate_idx = candidate_start;
                  candidate_idx < candidate_end;
                  ++candidate_idx) {
               prefix_idx_vector.push_back(prefix_idx);
               size_t idx = prefix_idx_vector.size() - 1;
-              auto cur_id = cur_ids.data<int64_t>()[candidate_idx];
-              auto cur_score = cur_scores.data<T>()[candidate_idx];
+              auto cur_id = cur_ids_data[candidate_idx];
+              auto cur_score = cur_scores_data[candidate_idx];
               sentence_vector.at(idx).word_ids.push_back(cur_id);
               sentence_vector.at(idx).scores.push_back(cur_score);
             }
           }
         } else {  // use prefix_idx_vector to backtrace
-          size_t src_candidate_start =
-              cur_ids.lod().at(kSentenceLevel)[src_prefix_start];
+          size_t src_candidate_start = sentence_lod[src_prefix_start];
           size_t prefix_idx = src_prefix_start;
           size_t candidate_num =
-              cur_ids.lod().at(kSentenceLevel)[prefix_idx + 1] -
-              cur_ids.lod().at(kSentenceLevel)[prefix_idx];
+              sentence_lod[prefix_idx + 1] - sentence_lod[prefix_idx];
           for (size_t idx = 0; idx < prefix_idx_vector.size(); ++idx) {
             auto candidate_idx = prefix_idx_vector.at(idx);
-            auto cur_id = cur_ids.data<int64_t>()[candidate_idx];
-            auto cur_score = cur_scores.data<T>()[candidate_idx];
+            auto cur_id = cur_ids_data[candidate_idx];
+            auto cur_score = cur_scores_data[candidate_idx];
             if (cur_id != end_id_ || sentence_vector.at(idx).word_ids.empty()) {
               // to skip redundant end tokens
               sentence_vector.at(idx).word_ids.push_back(cur_id);
@@ -193,8 +190,7 @@ struct BeamSearchDecoder {
                    candidate_idx) {  // search the corresponding prefix
               prefix_idx++;
               candidate_num +=
-                  cur_ids.lod().at(kSentenceLevel)[prefix_idx + 1] -
-                  cur_ids.lod().at(kSentenceLevel)[prefix_idx];
+                  sentence_lod[prefix_idx + 1] - sentence_lod[prefix_idx];
             }
             prefix_idx_vector.at(idx) = prefix_idx;
           }
@@ -203,7 +199,7 @@ struct BeamSearchDecoder {
     }
 
     ConvertSentenceVectorToLodTensor(
-        sentence_vector_list, id_tensor, score_tensor, true, true);
+        &sentence_vector_list, id_tensor, score_tensor, true, true);
   }
 
   size_t beam_size_;
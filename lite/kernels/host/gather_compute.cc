@@ -13,55 +13,39 @@
 // limitations under the License.
 #include "lite/kernels/host/gather_compute.h"
 #include <vector>
+#include "lite/backends/host/math/gather.h"
 
 namespace paddle {
 namespace lite {
 namespace kernels {
 namespace host {
 
-#define INDEX_COMPUTE                      \
-  for (int i = 0; i < index_size; ++i) {   \
-    auto index_ = p_index[i];              \
-    memcpy(p_output + i * slice_size,      \
-           p_src + index_ * slice_size,    \
-           slice_size * sizeof(DataType)); \
-  }
-
-#define INDEX_V2_COMPUTE                                        \
-  for (int i = 0; i < index_size; i++) {                        \
-    CHECK_LT(index_data[i], input_index_dim_size)               \
-        << "The element of Index must be less than the size of" \
-        << "dim size of axis dim";                              \
-  }                                                             \
-  for (int i = 0; i < inner_dim_size; i++) {                    \
-    for (int j = 0; j < index_size; j++) {                      \
-      for (int k = 0; k < outer_dim_size; k++) {                \
-        int index = k + index_data[j] * outer_dim_size +        \
-                    (i * input_size / inner_dim_size);          \
-        out_data[out_index] = input_data[index];                \
-        out_index++;                                            \
-      }                                                         \
-    }                                                           \
-  }
-
 template <typename IndexType, typename DataType>
 void GatherFunc(const operators::GatherParam& param) {
   auto src_dims = param.X->dims();
   auto index_size = param.Index->dims()[0];
   auto* p_src = param.X->data<DataType>();
   auto* p_output = param.Out->mutable_data<DataType>();
-
-  int slice_size = 1;
-  for (size_t i = 1; i < src_dims.size(); ++i) {
-    slice_size *= src_dims[i];
-  }
+  int64_t slice_size = src_dims.count(1, src_dims.size());
 
   if (param.Index->precision() == PrecisionType::kInt64) {
-    const int64_t* p_index = param.Index->data<int64_t>();
-    INDEX_COMPUTE
+    lite::host::math::gather_axis(p_src,
+                                  param.Index->data<int64_t>(),
+                                  p_output,
+                                  1,
+                                  src_dims[0],
+                                  index_size,
+                                  slice_size,
+                                  sizeof(DataType));
   } else if (param.Index->precision() == PrecisionType::kInt32) {
-    const int32_t* p_index = param.Index->data<int32_t>();
-    INDEX_COMPUTE
+    lite::host::math::gather_axis(p_src,
+                                  param.Index->data<int32_t>(),
+                                  p_output,
+                                  1,
+                                  src_dims[0],
+                                  index_size,
+                                  slice_size,
+                                  sizeof(DataType));
   } else {
     LOG(FATAL) << "Unsupported this index precision: "
                << PrecisionToStr(param.Index->precision());
@@ -73,28 +57,32 @@ void GatherV2Func(const operators::GatherParam& param) {
   auto* input_data = param.X->data<DataType>();
   auto* out_data = param.Out->mutable_data<DataType>();
 
-  int index_size = param.Index->numel();
-  int input_size = param.X->numel();
+  int64_t index_size = param.Index->numel();
   auto input_dim = param.X->dims();
   int axis_index = param.Axis ? param.Axis->data<AxisType>()[0] : param.axis;
-  int inner_dim_size = 1;
-  int outer_dim_size = 1;
-  int input_index_dim_size = input_dim[axis_index];
-
-  for (int i = 0; i < axis_index; i++) {
-    inner_dim_size *= input_dim[i];
-  }
-  for (size_t i = axis_index + 1; i < input_dim.size(); i++) {
-    outer_dim_size *= input_dim[i];
-  }
+  if (axis_index < 0) axis_index += input_dim.size();
+  int64_t outer_size = input_dim.count(0, axis_index);
+  int64_t inner_size = input_dim.count(axis_index + 1, input_dim.size());
+  int64_t input_index_dim_size = input_dim[axis_index];
 
-  int out_index = 0;
   if (param.Index->precision() == PrecisionType::kInt64) {
-    auto* index_data = param.Index->data<int64_t>();
-    INDEX_V2_COMPUTE
+    lite::host::math::gather_axis(input_data,
+                                  param.Index->data<int64_t>(),
+                                  out_data,
+                                  outer_size,
+                                  input_index_dim_size,
+                                  index_size,
+                                  inner_size,
+                                  sizeof(DataType));
   } else if (param.Index->precision() == PrecisionType::kInt32) {
-    auto* index_data = param.Index->data<int32_t>();
-    INDEX_V2_COMPUTE
+    lite::host::math::gather_axis(input_data,
+                                  param.Index->data<int32_t>(),
+                                  out_data,
+                                  outer_size,
+                                  input_index_dim_size,
+                                  index_size,
+                                  inner_size,
+                                  sizeof(DataType));
   } else {
     LOG(FATAL) << "Unsupported this index precision: "
                << PrecisionToStr(param.Index->precision());
@@ -160,8 +148,6 @@ void GatherCompute<IndexType, AxisType>::Run() {
     return;
   }
 }
-#undef INDEX_COMPUTE
-#undef INDEX_V2_COMPUTE
 
 }  // namespace host
 }  // namespace kernels
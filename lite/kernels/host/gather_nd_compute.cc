@@ -13,6 +13,8 @@
 // limitations under the License.
 
 #include "lite/kernels/host/gather_nd_compute.h"
+#include <vector>
+#include "lite/backends/host/math/gather.h"
 
 namespace paddle {
 namespace lite {
@@ -36,22 +38,33 @@ void GatherNd(const Tensor& x, const Tensor& index, Tensor* out) {
   }
 
   int64_t end_size = index_dims[index_dims_size - 1];
-  int64_t gather_size = 1;
-  for (size_t i = end_size; i < x_dims_size; i++) {
-    gather_size *= x_dims[i];
-  }
-  const size_t gather_bytes = gather_size * sizeof(DataT);
+  int64_t gather_size = x_dims.count(end_size, x_dims_size);
 
+  // Flatten the index tuples to the rows of x viewed as
+  // [x_dims[0] * ... * x_dims[end_size - 1], gather_size].
+  std::vector<int64_t> x_strides(end_size);
+  int64_t step = 1;
+  for (int64_t j = end_size - 1; j >= 0; j--) {
+    x_strides[j] = step;
+    step *= x_dims[j];
+  }
+  std::vector<int64_t> rows(gather_time);
   for (int64_t i = 0; i < gather_time; i++) {
+    const IndexT* index_tuple = index_data + i * end_size;
     int64_t x_index = 0;
-    int64_t step = 1;
-    for (int64_t j = end_size - 1; j >= 0; j--) {
-      x_index += (index_data[i * end_size + j] * step);
-      step *= x_dims[j];
+    for (int64_t j = 0; j < end_size; j++) {
+      x_index += index_tuple[j] * x_strides[j];
     }
-    memcpy(out_data, x_data + x_index * gather_size, gather_bytes);
-    out_data += gather_size;
+    rows[i] = x_index;
   }
+  lite::host::math::gather_axis(x_data,
+                                rows.data(),
+                                out_data,
+                                1,
+                                step,
+                                gather_time,
+                                gather_size,
+                                sizeof(DataT));
   return;
 }
 
@@ -15,6 +15,7 @@
 #include "lite/kernels/host/index_select_compute.h"
 #include <string>
 #include <vector>
+#include "lite/backends/host/math/gather.h"
 #include "lite/core/op_registry.h"
 #include "lite/core/tensor.h"
 #include "lite/core/type_system.h"
@@ -37,20 +38,22 @@ void Index_selectCompute<T>::Run() {
 
   if (param.dim < 0) param.dim += input_ddim.size();
 
-  int left = input_ddim.count(0, param.dim);
-  int middle = input_ddim[param.dim];
-  int right = input_ddim.count(param.dim + 1, input_ddim.size());
+  int64_t left = input_ddim.count(0, param.dim);
+  int64_t middle = input_ddim[param.dim];
+  int64_t right = input_ddim.count(param.dim + 1, input_ddim.size());
 
   const T* in_ptr = input->data<T>();
   const int64_t* index_ptr = index->data<int64_t>();
   T* out_ptr = output->mutable_data<T>();
 
-  for (int i = 0; i < left; i++)
-    for (int k = 0; k < index_ddim.production(); k++)
-      for (int j = 0; j < right; j++)
-        out_ptr[i * index_ddim.production() * right + k * right + j] =
-            in_ptr[i * middle * right + index_ptr[k] * right + j];
-
+  lite::host::math::gather_axis(in_ptr,
+                                index_ptr,
+                                out_ptr,
+                                left,
+                                middle,
+                                index_ddim.production(),
+                                right,
+                                sizeof(T));
   return;
 }
 
@@ -0,0 +1,109 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/kernels/host/kv_cache_append_compute.h"
+#include <algorithm>
+#include <cstring>
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace host {
+
+void KVCacheAppendCompute::Run() {
+  auto& param = this->Param<operators::KVCacheAppendParam>();
+  const Tensor* y = param.Y;
+  Tensor* out = param.Out;
+  if (param.X != out) {
+    out->CopyDataFrom(*param.X);
+  }
+  if (y->numel() == 0) return;
+  const size_t elem_size = y->memory_size() / y->numel();
+  if (out->numel() == 0 || !out->IsInitialized()) {
+    out->CopyDataFrom(*y);
+    return;
+  }
+
+  const auto x_dims = out->dims();
+  const auto& y_dims = y->dims();
+  const int rank = static_cast<int>(x_dims.size());
+  CHECK_EQ(rank, static_cast<int>(y_dims.size()));
+  const int axis = param.axis < 0 ? param.axis + rank : param.axis;
+  CHECK(axis >= 0 && axis < rank);
+  auto out_dims = x_dims;
+  for (int i = 0; i < rank; i++) {
+    if (i == axis) {
+      out_dims[i] += y_dims[i];
+    } else {
+      CHECK_EQ(x_dims[i], y_dims[i]) << "The dims of the cache and the new "
+                                        "entries mismatch at "
+                                     << i;
+    }
+  }
+  const int64_t pre = x_dims.count(0, axis);
+  const size_t x_row = x_dims.count(axis, rank) * elem_size;
+  const size_t y_row = y_dims.count(axis, rank) * elem_size;
+  const size_t x_bytes = pre * x_row;
+  const size_t out_bytes = pre * (x_row + y_row);
+
+  // Reserve the capacity geometrically, so appending n steps reallocates
+  // O(log n) times. A buffer shared with the other tensors is never written.
+  if (out->capacity() < out_bytes || out->buffer().use_count() > 1) {
+    Tensor grown;
+    grown.set_precision(out->precision());
+    void* grown_data = grown.mutable_data(
+        out->target(), std::max(out_bytes, 2 * out->capacity()));
+    std::memcpy(grown_data, out->raw_data(), x_bytes);
+    out->ResetBuffer(grown.buffer(), x_bytes);
+  }
+  out->Resize(out_dims);
+  auto* out_data =
+      static_cast<char*>(out->mutable_data(out->target(), out_bytes));
+  const auto* y_data = static_cast<const char*>(y->raw_data());
+  // The rows only move if the axis is not the outermost one, e.g. the cache
+  // of [batch, heads, seq, dim], move them from the last one to keep the
+  // rows not moved yet.
+  for (int64_t i = pre - 1; i >= 0; i--) {
+    char* dst = out_data + i * (x_row + y_row);
+    if (i > 0) {
+      std::memmove(dst, out_data + i * x_row, x_row);
+    }
+    std::memcpy(dst + x_row, y_data + i * y_row, y_row);
+  }
+}
+
+}  // namespace host
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_LITE_KERNEL(kv_cache_append,
+                     kHost,
+                     kAny,
+                     kAny,
+                     paddle::lite::kernels::host::KVCacheAppendCompute,
+                     def)
+    .BindInput("X",
+               {LiteType::GetTensorTy(TARGET(kHost),
+                                      PRECISION(kAny),
+                                      DATALAYOUT(kAny))})
+    .BindInput("Y",
+               {LiteType::GetTensorTy(TARGET(kHost),
+                                      PRECISION(kAny),
+                                      DATALAYOUT(kAny))})
+    .BindOutput("Out",
+                {LiteType::GetTensorTy(TARGET(kHost),
+                                       PRECISION(kAny),
+                                       DATALAYOUT(kAny))})
+    .Finalize();
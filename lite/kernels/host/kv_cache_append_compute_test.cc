@@ -0,0 +1,87 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/kernels/host/kv_cache_append_compute.h"
+#include <gtest/gtest.h>
+#include <vector>
+#include "lite/core/op_registry.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace host {
+
+// Append steps of [batch, heads, 1, dim] to the cache along axis and check
+// it against the concatenation.
+void TestKVCacheAppend(const std::vector<int64_t>& step_dims,
+                       int axis,
+                       int steps) {
+  Tensor cache;
+  std::vector<int64_t> cache_dims = step_dims;
+  cache_dims[axis] = 0;
+  cache.Resize(cache_dims);
+  cache.mutable_data<float>();
+  std::vector<std::vector<float>> history;
+
+  KVCacheAppendCompute kernel;
+  operators::KVCacheAppendParam param;
+  Tensor step;
+  param.X = &cache;
+  param.Y = &step;
+  param.Out = &cache;
+  param.axis = axis;
+  kernel.SetParam(param);
+
+  int reallocs = 0;
+  const void* last_data = nullptr;
+  for (int s = 0; s < steps; s++) {
+    step.Resize(step_dims);
+    auto* step_data = step.mutable_data<float>();
+    history.emplace_back(step.numel());
+    for (int64_t i = 0; i < step.numel(); i++) {
+      step_data[i] = s * 1000.f + i;
+      history.back()[i] = step_data[i];
+    }
+    kernel.Run();
+    if (cache.raw_data() != last_data) reallocs++;
+    last_data = cache.raw_data();
+
+    ASSERT_EQ(cache.dims()[axis], s + 1);
+    const DDim dims(step_dims);
+    const int64_t pre = dims.count(0, axis);
+    const int64_t row = dims.count(axis, dims.size());
+    const float* cache_data = cache.data<float>();
+    for (int64_t p = 0; p < pre; p++) {
+      for (int t = 0; t <= s; t++) {
+        for (int64_t i = 0; i < row; i++) {
+          ASSERT_EQ(cache_data[(p * (s + 1) + t) * row + i],
+                    history[t][p * row + i]);
+        }
+      }
+    }
+  }
+  // The capacity grows geometrically
+  EXPECT_LE(reallocs, 8);
+}
+
+TEST(kv_cache_append, outermost_axis) { TestKVCacheAppend({1, 1, 16}, 1, 64); }
+
+TEST(kv_cache_append, inner_axis) { TestKVCacheAppend({2, 3, 1, 8}, 2, 64); }
+
+}  // namespace host
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_KERNEL(kv_cache_append, kHost, kAny, kAny, def);
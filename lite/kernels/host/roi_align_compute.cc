@@ -17,6 +17,7 @@
 #include <string>
 #include <vector>
 #include "lite/core/op_registry.h"
+#include "lite/core/parallel_defines.h"
 #include "lite/core/tensor.h"
 #include "lite/core/type_system.h"
 
@@ -39,13 +40,9 @@ void PreCalcForBilinearInterpolate(const int height,
                                    T bin_size_w,
                                    int roi_bin_grid_h,
                                    int roi_bin_grid_w,
-                                   Tensor* pre_pos,
-                                   Tensor* pre_w) {
+                                   int* pre_pos_data,
+                                   T* pre_w_data) {
   int pre_calc_index = 0;
-  int* pre_pos_data = pre_pos->mutable_data<int>();
-  T* pre_w_data = pre_w->mutable_data<T>();
-  memset(pre_pos_data, 0, pre_pos->numel() * sizeof(int));
-  memset(pre_w_data, 0, pre_w->numel() * sizeof(T));
   for (int ph = 0; ph < pooled_height; ph++) {
     for (int pw = 0; pw < pooled_width; pw++) {
       for (int iy = 0; iy < iy_upper; iy++) {
@@ -122,7 +119,6 @@ void RoiAlignCompute::Run() {
   int rois_num = rois_dims[0];
   auto out_dims = out->dims();
   auto* output_data = out->mutable_data<float>();
-  memset(output_data, 0, out->numel() * sizeof(float));
 
   DDim in_stride({static_cast<int>(in_dims[1] * in_dims[2] * in_dims[3]),
                   static_cast<int>(in_dims[2] * in_dims[3]),
@@ -148,10 +144,8 @@ void RoiAlignCompute::Run() {
     CHECK_EQ(sum_roi_num, rois_num);
   }
 
-  Tensor roi_batch_id_list;
-  roi_batch_id_list.Resize({rois_num});
-  int* roi_batch_id_data = roi_batch_id_list.mutable_data<int>();
-  memset(roi_batch_id_data, 0, roi_batch_id_list.numel() * sizeof(int));
+  std::vector<int> roi_batch_id_list(rois_num, 0);
+  int* roi_batch_id_data = roi_batch_id_list.data();
 
   if (param.RoisNum != nullptr) {
     rois_batch_size = rois_num_t->numel();
@@ -178,14 +172,18 @@ void RoiAlignCompute::Run() {
     }
   }
 
-  auto* rois_data = rois->data<float>();
+  const float* rois_data = rois->data<float>();
   float roi_offset = align ? 0.5f : 0.f;
-  for (int n = 0; n < rois_num; ++n) {
+  // The ROIs are independent, so they are split over the threads. The
+  // sampling positions and weights of a ROI are computed once and shared by
+  // all the channels.
+  LITE_PARALLEL_BEGIN(n, tid, rois_num) {
+    const float* roi_data = rois_data + n * roi_stride[0];
     int roi_batch_id = roi_batch_id_data[n];
-    float roi_xmin = rois_data[0] * spatial_scale - roi_offset;
-    float roi_ymin = rois_data[1] * spatial_scale - roi_offset;
-    float roi_xmax = rois_data[2] * spatial_scale - roi_offset;
-    float roi_ymax = rois_data[3] * spatial_scale - roi_offset;
+    float roi_xmin = roi_data[0] * spatial_scale - roi_offset;
+    float roi_ymin = roi_data[1] * spatial_scale - roi_offset;
+    float roi_xmax = roi_data[2] * spatial_scale - roi_offset;
+    float roi_ymax = roi_data[3] * spatial_scale - roi_offset;
     float roi_width = roi_xmax - roi_xmin;
     float roi_height = roi_ymax - roi_ymin;
     if (!align) {
@@ -196,17 +194,16 @@ void RoiAlignCompute::Run() {
     float bin_size_h = roi_height / pooled_height;
     float bin_size_w = roi_width / pooled_width;
     const float* batch_data = input_data + roi_batch_id * in_stride[0];
+    float* roi_output_data = output_data + n * out_stride[0];
     int roi_bin_grid_h = (sampling_ratio > 0)
                              ? sampling_ratio
                              : ceil(roi_height / pooled_height);
     int roi_bin_grid_w =
         (sampling_ratio > 0) ? sampling_ratio : ceil(roi_width / pooled_width);
     const int count = std::max(roi_bin_grid_h * roi_bin_grid_w, 1);
-    Tensor pre_pos;
-    Tensor pre_w;
     int pre_size = count * out_stride[1];
-    pre_pos.Resize({pre_size, kROISize});
-    pre_w.Resize({pre_size, kROISize});
+    std::vector<int> pre_pos(pre_size * kROISize, 0);
+    std::vector<float> pre_w(pre_size * kROISize, 0.f);
 
     PreCalcForBilinearInterpolate<float>(height,
                                          width,
@@ -220,11 +217,11 @@ void RoiAlignCompute::Run() {
                                          bin_size_w,
                                          roi_bin_grid_h,
                                          roi_bin_grid_w,
-                                         &pre_pos,
-                                         &pre_w);
+                                         pre_pos.data(),
+                                         pre_w.data());
 
-    const int* pre_pos_data = pre_pos.data<int>();
-    const float* pre_w_data = pre_w.data<float>();
+    const int* pre_pos_data = pre_pos.data();
+    const float* pre_w_data = pre_w.data();
     for (int c = 0; c < channels; c++) {
       int pre_calc_index = 0;
       for (int ph = 0; ph < pooled_height; ph++) {
@@ -242,14 +239,14 @@ void RoiAlignCompute::Run() {
             }
           }
           output_val /= count;
-          output_data[pool_index] = output_val;
+          roi_output_data[pool_index] = output_val;
         }
       }
       batch_data += in_stride[1];
-      output_data += out_stride[1];
+      roi_output_data += out_stride[1];
     }
-    rois_data += roi_stride[0];
   }
+  LITE_PARALLEL_END()
 }
 
 }  // namespace host
@@ -15,6 +15,8 @@
 #include "lite/kernels/host/roi_perspective_transform_compute.h"
 #include <algorithm>
 #include <cmath>
+#include <vector>
+#include "lite/core/parallel_defines.h"
 
 namespace paddle {
 namespace lite {
@@ -179,24 +181,17 @@ bool in_quad(T x, T y, T roi_x[], T roi_y[]) {
 }
 
 /**
- * Perform bilinear interpolation in the input feature map.
+ * Get the positions and weights of bilinear interpolation in a channel of
+ * the input feature map, return false if the source coords are out of the
+ * feature map boundary.
  */
 template <typename T>
-void bilinear_interpolate(const T* in_data,
-                          const int channels,
-                          const int width,
-                          const int height,
-                          int in_n,
-                          int in_c,
-                          T in_w,
-                          T in_h,
-                          T* val) {
+bool get_bilinear_weights(
+    const int width, const int height, T in_w, T in_h, int pos[4], T w[4]) {
   // Deal with cases that source coords are out of feature map boundary
   if (GT_E<T>(-0.5, in_w) || GT_E<T>(in_w, width - 0.5) ||
       GT_E<T>(-0.5, in_h) || GT_E<T>(in_h, height - 0.5)) {
-    // empty
-    val[0] = 0.0;
-    return;
+    return false;
   }
 
   if (GT_E<T>(0, in_w)) {
@@ -228,17 +223,15 @@ void bilinear_interpolate(const T* in_data,
   T h_floor = in_h - in_h_floor;
   T w_ceil = 1 - w_floor;
   T h_ceil = 1 - h_floor;
-  const T* data = in_data + (in_n * channels + in_c) * height * width;
-  // Do bilinear interpolation
-  T v1 = data[in_h_floor * width + in_w_floor];
-  T v2 = data[in_h_ceil * width + in_w_floor];
-  T v3 = data[in_h_ceil * width + in_w_ceil];
-  T v4 = data[in_h_floor * width + in_w_ceil];
-  T w1 = w_ceil * h_ceil;
-  T w2 = w_ceil * h_floor;
-  T w3 = w_floor * h_floor;
-  T w4 = w_floor * h_ceil;
-  val[0] = w1 * v1 + w2 * v2 + w3 * v3 + w4 * v4;
+  pos[0] = in_h_floor * width + in_w_floor;
+  pos[1] = in_h_ceil * width + in_w_floor;
+  pos[2] = in_h_ceil * width + in_w_ceil;
+  pos[3] = in_h_floor * width + in_w_ceil;
+  w[0] = w_ceil * h_ceil;
+  w[1] = w_ceil * h_floor;
+  w[2] = w_floor * h_floor;
+  w[3] = w_floor * h_ceil;
+  return true;
 }
 
 template <class T>
@@ -276,7 +269,11 @@ void RoiPerspectiveTransformCompute<T>::Run() {
   const T* rois_data = rois->template data<T>();
   T* transform_matrix = out_transform_matrix->template mutable_data<T>();
 
-  for (int n = 0; n < rois_num; ++n) {
+  const int out_size = transformed_height * transformed_width;
+  // The ROIs are independent, so they are split over the threads. The
+  // source positions and weights of a ROI are computed once and shared by
+  // all the channels.
+  LITE_PARALLEL_BEGIN(n, tid, rois_num) {
     const T* n_rois = rois_data + n * 8;
     T roi_x[4];
     T roi_y[4];
@@ -292,45 +289,45 @@ void RoiPerspectiveTransformCompute<T>::Run() {
     for (int i = 0; i < 9; i++) {
       transform_matrix[n * 9 + i] = matrix[i];
     }
+
+    int* roi_mask_data = mask_data + n * out_size;
+    std::vector<int> pos(out_size * 4);
+    std::vector<T> weights(out_size * 4);
+    for (int out_h = 0; out_h < transformed_height; ++out_h) {
+      for (int out_w = 0; out_w < transformed_width; ++out_w) {
+        int out_index = out_h * transformed_width + out_w;
+        T in_w, in_h;
+        get_source_coords<T>(matrix, out_w, out_h, &in_w, &in_h);
+        roi_mask_data[out_index] =
+            in_quad<T>(in_w, in_h, roi_x, roi_y) &&
+            get_bilinear_weights<T>(in_width,
+                                    in_height,
+                                    in_w,
+                                    in_h,
+                                    pos.data() + out_index * 4,
+                                    weights.data() + out_index * 4);
+      }
+    }
+
+    const int in_size = in_height * in_width;
+    const T* image_data = input_data + image_id * channels * in_size;
+    T* roi_output_data = output_data + n * channels * out_size;
     for (int c = 0; c < channels; ++c) {
-      for (int out_h = 0; out_h < transformed_height; ++out_h) {
-        for (int out_w = 0; out_w < transformed_width; ++out_w) {
-          int out_index =
-              n * channels * transformed_height * transformed_width +
-              c * transformed_height * transformed_width +
-              out_h * transformed_width + out_w;
-          T in_w, in_h;
-          get_source_coords<T>(matrix, out_w, out_h, &in_w, &in_h);
-          if (in_quad<T>(in_w, in_h, roi_x, roi_y)) {
-            if (GT_E<T>(-0.5, in_w) ||
-                GT_E<T>(in_w, static_cast<T>(in_width - 0.5)) ||
-                GT_E<T>(-0.5, in_h) ||
-                GT_E<T>(in_h, static_cast<T>(in_height - 0.5))) {
-              output_data[out_index] = 0.0;
-              mask_data[(n * transformed_height + out_h) * transformed_width +
-                        out_w] = 0;
-            } else {
-              bilinear_interpolate(input_data,
-                                   channels,
-                                   in_width,
-                                   in_height,
-                                   image_id,
-                                   c,
-                                   in_w,
-                                   in_h,
-                                   output_data + out_index);
-              mask_data[(n * transformed_height + out_h) * transformed_width +
-                        out_w] = 1;
-            }
-          } else {
-            output_data[out_index] = 0.0;
-            mask_data[(n * transformed_height + out_h) * transformed_width +
-                      out_w] = 0;
-          }
+      const T* data = image_data + c * in_size;
+      T* channel_output_data = roi_output_data + c * out_size;
+      for (int i = 0; i < out_size; ++i) {
+        if (!roi_mask_data[i]) {
+          channel_output_data[i] = 0.0;
+          continue;
         }
+        const int* p = pos.data() + i * 4;
+        const T* w = weights.data() + i * 4;
+        channel_output_data[i] = w[0] * data[p[0]] + w[1] * data[p[1]] +
+                                 w[2] * data[p[2]] + w[3] * data[p[3]];
       }
     }
   }
+  LITE_PARALLEL_END()
 }
 
 }  // namespace host
@@ -0,0 +1,259 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/kernels/host/roi_perspective_transform_compute.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "lite/core/op_registry.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace host {
+
+// The reference computes every output element on its own, as the kernel did
+// before the source positions and weights of a ROI were shared by the
+// channels.
+static bool RefGE(float a, float b) { return (a > b) || fabs(a - b) < 1e-4; }
+
+static bool RefLE(float a, float b) { return (a < b) || fabs(a - b) < 1e-4; }
+
+static bool RefGT(float a, float b) { return (a - b) > 1e-4; }
+
+static void RefTransformMatrix(const int transformed_width,
+                               const int transformed_height,
+                               const float roi_x[],
+                               const float roi_y[],
+                               float matrix[]) {
+  float x0 = roi_x[0], x1 = roi_x[1], x2 = roi_x[2], x3 = roi_x[3];
+  float y0 = roi_y[0], y1 = roi_y[1], y2 = roi_y[2], y3 = roi_y[3];
+  float len1 = sqrt((x0 - x1) * (x0 - x1) + (y0 - y1) * (y0 - y1));
+  float len2 = sqrt((x1 - x2) * (x1 - x2) + (y1 - y2) * (y1 - y2));
+  float len3 = sqrt((x2 - x3) * (x2 - x3) + (y2 - y3) * (y2 - y3));
+  float len4 = sqrt((x3 - x0) * (x3 - x0) + (y3 - y0) * (y3 - y0));
+  float estimated_height = (len2 + len4) / 2.0;
+  float estimated_width = (len1 + len3) / 2.0;
+  int normalized_height = std::max(2, transformed_height);
+  int normalized_width =
+      std::round(estimated_width * (normalized_height - 1) / estimated_height) +
+      1;
+  normalized_width = std::max(2, std::min(normalized_width, transformed_width));
+
+  float dx1 = x1 - x2, dx2 = x3 - x2, dx3 = x0 - x1 + x2 - x3;
+  float dy1 = y1 - y2, dy2 = y3 - y2, dy3 = y0 - y1 + y2 - y3;
+  matrix[6] = (dx3 * dy2 - dx2 * dy3) / (dx1 * dy2 - dx2 * dy1 + 1e-5) /
+              (normalized_width - 1);
+  matrix[7] = (dx1 * dy3 - dx3 * dy1) / (dx1 * dy2 - dx2 * dy1 + 1e-5) /
+              (normalized_height - 1);
+  matrix[8] = 1;
+  matrix[3] = (y1 - y0 + matrix[6] * (normalized_width - 1) * y1) /
+              (normalized_width - 1);
+  matrix[4] = (y3 - y0 + matrix[7] * (normalized_height - 1) * y3) /
+              (normalized_height - 1);
+  matrix[5] = y0;
+  matrix[0] = (x1 - x0 + matrix[6] * (normalized_width - 1) * x1) /
+              (normalized_width - 1);
+  matrix[1] = (x3 - x0 + matrix[7] * (normalized_height - 1) * x3) /
+              (normalized_height - 1);
+  matrix[2] = x0;
+}
+
+static bool RefInQuad(float x,
+                      float y,
+                      const float roi_x[],
+                      const float roi_y[]) {
+  for (int i = 0; i < 4; i++) {
+    float xs = roi_x[i], ys = roi_y[i];
+    float xe = roi_x[(i + 1) % 4], ye = roi_y[(i + 1) % 4];
+    if (fabs(ys - ye) < 1e-4) {
+      if (fabs(y - ys) < 1e-4 && fabs(y - ye) < 1e-4 &&
+          RefGE(x, std::min(xs, xe)) && RefLE(x, std::max(xs, xe))) {
+        return true;
+      }
+    } else {
+      float intersec_x = (y - ys) * (xe - xs) / (ye - ys) + xs;
+      if (fabs(intersec_x - x) < 1e-4 && RefGE(y, std::min(ys, ye)) &&
+          RefLE(y, std::max(ys, ye))) {
+        return true;
+      }
+    }
+  }
+  int n_cross = 0;
+  for (int i = 0; i < 4; i++) {
+    float xs = roi_x[i], ys = roi_y[i];
+    float xe = roi_x[(i + 1) % 4], ye = roi_y[(i + 1) % 4];
+    if (fabs(ys - ye) < 1e-4) continue;
+    if (RefLE(y, std::min(ys, ye)) || RefGT(y, std::max(ys, ye))) continue;
+    float intersec_x = (y - ys) * (xe - xs) / (ye - ys) + xs;
+    if (fabs(intersec_x - x) < 1e-4) return true;
+    if (RefGT(intersec_x, x)) n_cross++;
+  }
+  return (n_cross % 2 == 1);
+}
+
+static float RefBilinear(
+    const float* data, const int width, const int height, float w, float h) {
+  if (RefGE(0, w)) w = 0;
+  if (RefGE(0, h)) h = 0;
+  int w_floor = floor(w);
+  int h_floor = floor(h);
+  int w_ceil, h_ceil;
+  if (RefGE(w_floor, width - 1)) {
+    w_ceil = w_floor = width - 1;
+    w = static_cast<float>(w_floor);
+  } else {
+    w_ceil = w_floor + 1;
+  }
+  if (RefGE(h_floor, height - 1)) {
+    h_ceil = h_floor = height - 1;
+    h = static_cast<float>(h_floor);
+  } else {
+    h_ceil = h_floor + 1;
+  }
+  float dw = w - w_floor;
+  float dh = h - h_floor;
+  return (1 - dw) * (1 - dh) * data[h_floor * width + w_floor] +
+         (1 - dw) * dh * data[h_ceil * width + w_floor] +
+         dw * dh * data[h_ceil * width + w_ceil] +
+         dw * (1 - dh) * data[h_floor * width + w_ceil];
+}
+
+static void RefRoiPerspectiveTransform(const Tensor& x,
+                                       const Tensor& rois,
+                                       float spatial_scale,
+                                       int transformed_height,
+                                       int transformed_width,
+                                       std::vector<float>* out,
+                                       std::vector<int>* mask,
+                                       std::vector<float>* matrices) {
+  const int channels = x.dims()[1];
+  const int height = x.dims()[2];
+  const int width = x.dims()[3];
+  const int rois_num = rois.dims()[0];
+  const int out_size = transformed_height * transformed_width;
+  out->assign(rois_num * channels * out_size, 0.f);
+  mask->assign(rois_num * out_size, 0);
+  matrices->assign(rois_num * 9, 0.f);
+  const auto& lod = rois.lod().back();
+  for (int n = 0; n < rois_num; ++n) {
+    int image_id = 0;
+    while (lod[image_id + 1] <= static_cast<uint64_t>(n)) image_id++;
+    float roi_x[4], roi_y[4];
+    for (int k = 0; k < 4; ++k) {
+      roi_x[k] = rois.data<float>()[n * 8 + 2 * k] * spatial_scale;
+      roi_y[k] = rois.data<float>()[n * 8 + 2 * k + 1] * spatial_scale;
+    }
+    float* matrix = matrices->data() + n * 9;
+    RefTransformMatrix(
+        transformed_width, transformed_height, roi_x, roi_y, matrix);
+    for (int c = 0; c < channels; ++c) {
+      const float* data =
+          x.data<float>() + (image_id * channels + c) * height * width;
+      for (int out_h = 0; out_h < transformed_height; ++out_h) {
+        for (int out_w = 0; out_w < transformed_width; ++out_w) {
+          float u = matrix[0] * out_w + matrix[1] * out_h + matrix[2];
+          float v = matrix[3] * out_w + matrix[4] * out_h + matrix[5];
+          float w = matrix[6] * out_w + matrix[7] * out_h + matrix[8];
+          float in_w = u / w;
+          float in_h = v / w;
+          const int index = out_h * transformed_width + out_w;
+          if (!RefInQuad(in_w, in_h, roi_x, roi_y) || RefGE(-0.5, in_w) ||
+              RefGE(in_w, width - 0.5) || RefGE(-0.5, in_h) ||
+              RefGE(in_h, height - 0.5)) {
+            continue;
+          }
+          (*mask)[n * out_size + index] = 1;
+          (*out)[(n * channels + c) * out_size + index] =
+              RefBilinear(data, width, height, in_w, in_h);
+        }
+      }
+    }
+  }
+}
+
+TEST(roi_perspective_transform_host, compute) {
+  const int batch = 2, channels = 3, height = 10, width = 12;
+  const int transformed_height = 5, transformed_width = 7;
+  const float spatial_scale = 0.5f;
+  Tensor x, rois, out, mask, transform_matrix;
+  x.Resize({batch, channels, height, width});
+  auto* x_data = x.mutable_data<float>();
+  for (int64_t i = 0; i < x.numel(); ++i) {
+    x_data[i] = std::sin(0.37f * i) * 3.f + 0.01f * i;
+  }
+  // the quads in the input image scale: in the map, sticking out of the left
+  // and top, sticking out of the right and bottom, a skewed quad across the
+  // map, and one mostly outside of it
+  std::vector<float> rois_data{
+      2,  2,  14, 3,  15, 12, 1,  11,  // NOLINT
+      -6, -4, 10, -2, 9,  8,  -5, 9,   // NOLINT
+      12, 8,  30, 10, 28, 26, 11, 24,  // NOLINT
+      -3, 6,  18, -5, 27, 14, 4,  22,  // NOLINT
+      20, 16, 40, 18, 38, 30, 22, 28,  // NOLINT
+  };
+  const int rois_num = rois_data.size() / 8;
+  rois.Resize({rois_num, 8});
+  std::copy(rois_data.begin(), rois_data.end(), rois.mutable_data<float>());
+  rois.set_lod({{0, 2, 5}});
+  out.Resize({rois_num, channels, transformed_height, transformed_width});
+  mask.Resize({rois_num, 1, transformed_height, transformed_width});
+  transform_matrix.Resize({rois_num, 9});
+
+  RoiPerspectiveTransformCompute<float> kernel;
+  operators::RoiPerspectiveTransformParam param;
+  param.x = &x;
+  param.rois = &rois;
+  param.out = &out;
+  param.mask = &mask;
+  param.transfor_matrix = &transform_matrix;
+  param.spatial_scale = spatial_scale;
+  param.transformed_height = transformed_height;
+  param.transformed_width = transformed_width;
+  kernel.SetParam(param);
+  kernel.Run();
+
+  std::vector<float> ref_out, ref_matrix;
+  std::vector<int> ref_mask;
+  RefRoiPerspectiveTransform(x,
+                             rois,
+                             spatial_scale,
+                             transformed_height,
+                             transformed_width,
+                             &ref_out,
+                             &ref_mask,
+                             &ref_matrix);
+  for (size_t i = 0; i < ref_matrix.size(); ++i) {
+    EXPECT_NEAR(transform_matrix.data<float>()[i], ref_matrix[i], 1e-5) << i;
+  }
+  int masked = 0;
+  for (size_t i = 0; i < ref_mask.size(); ++i) {
+    EXPECT_EQ(mask.data<int>()[i], ref_mask[i]) << i;
+    masked += ref_mask[i];
+  }
+  // the ROIs outside of the map are partly masked
+  EXPECT_GT(masked, 0);
+  EXPECT_LT(masked, static_cast<int>(ref_mask.size()));
+  for (size_t i = 0; i < ref_out.size(); ++i) {
+    EXPECT_NEAR(out.data<float>()[i], ref_out[i], 1e-5) << i;
+  }
+}
+
+}  // namespace host
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_KERNEL(roi_perspective_transform, kHost, kFloat, kNCHW, def);
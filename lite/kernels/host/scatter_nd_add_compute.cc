@@ -16,6 +16,7 @@
 #include <algorithm>
 #include <cmath>
 #include <vector>
+#include "lite/backends/host/math/gather.h"
 
 namespace paddle {
 namespace lite {
@@ -29,20 +30,22 @@ void ScatterNdAdd(const IndexType* indexs,
                   std::vector<int> x_dims_offset,
                   int index_size,
                   int index_count,
-                  int add_size) {
+                  int add_size,
+                  int64_t dst_rows) {
+  // Flatten the index tuples to the rows of dst viewed as
+  // [dst_rows, add_size].
   int index_offset = index_size / index_count;
+  std::vector<int64_t> rows(index_count);
   for (int i = 0; i < index_count; i++) {
-    int dst_offset = 0;
+    int64_t dst_offset = 0;
     for (int j = 0; j < index_offset; j++) {
       dst_offset += indexs[j] * x_dims_offset[j];
     }
     indexs += index_offset;
-    T* dst_tmp = dst + dst_offset;
-    for (int j = 0; j < add_size; j++) {
-      dst_tmp[j] += updates[j];
-    }
-    updates += add_size;
+    rows[i] = dst_offset / add_size;
   }
+  lite::host::math::scatter_add_rows(
+      rows.data(), index_count, updates, dst, dst_rows, add_size);
 }
 
 template <typename T, typename IndexType>
@@ -68,6 +71,7 @@ void ScatterNdAddCompute<T, IndexType>::Run() {
   }
 
   int add_size = x_dims.count(index_step, x_dims.size());
+  if (index_count == 0 || add_size == 0) return;
 
   ScatterNdAdd(indexs_data,
                updates_data,
@@ -75,7 +79,8 @@ void ScatterNdAddCompute<T, IndexType>::Run() {
                x_dims_offset,
                index_size,
                index_count,
-               add_size);
+               add_size,
+               x_dims.count(0, index_step));
 }
 
 }  // namespace host
@@ -143,4 +143,70 @@ REGISTER_LITE_KERNEL(erf,
                      def)
     .BindInput("X", {LiteType::GetTensorTy(TARGET(kX86))})
     .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86))})
-    .Finalize();
\ No newline at end of file
+    .Finalize();
+
+REGISTER_LITE_KERNEL(
+    relu,
+    kX86,
+    kInt8,
+    kNCHW,
+    paddle::lite::kernels::x86::ActivationInt8Compute<PRECISION(kInt8)>,
+    int8_out)
+    .BindInput("X", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .Finalize();
+
+REGISTER_LITE_KERNEL(
+    relu,
+    kX86,
+    kInt8,
+    kNCHW,
+    paddle::lite::kernels::x86::ActivationInt8Compute<PRECISION(kFloat)>,
+    fp32_out)
+    .BindInput("X", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kFloat))})
+    .Finalize();
+
+REGISTER_LITE_KERNEL(
+    relu6,
+    kX86,
+    kInt8,
+    kNCHW,
+    paddle::lite::kernels::x86::ActivationInt8Compute<PRECISION(kInt8)>,
+    int8_out)
+    .BindInput("X", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .Finalize();
+
+REGISTER_LITE_KERNEL(
+    relu6,
+    kX86,
+    kInt8,
+    kNCHW,
+    paddle::lite::kernels::x86::ActivationInt8Compute<PRECISION(kFloat)>,
+    fp32_out)
+    .BindInput("X", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kFloat))})
+    .Finalize();
+
+REGISTER_LITE_KERNEL(
+    leaky_relu,
+    kX86,
+    kInt8,
+    kNCHW,
+    paddle::lite::kernels::x86::ActivationInt8Compute<PRECISION(kInt8)>,
+    int8_out)
+    .BindInput("X", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .Finalize();
+
+REGISTER_LITE_KERNEL(
+    leaky_relu,
+    kX86,
+    kInt8,
+    kNCHW,
+    paddle::lite::kernels::x86::ActivationInt8Compute<PRECISION(kFloat)>,
+    fp32_out)
+    .BindInput("X", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kFloat))})
+    .Finalize();
@@ -14,6 +14,7 @@
 #pragma once
 
 #include <algorithm>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -25,6 +26,7 @@
 #include "lite/backends/x86/fluid/eigen.h"
 #include "lite/backends/x86/math/activation.h"
 #include "lite/backends/x86/math/blas.h"
+#include "lite/backends/x86/math/int8_compute.h"
 #include "lite/core/kernel.h"
 #include "lite/core/op_lite.h"
 #include "lite/core/op_registry.h"
@@ -413,6 +415,48 @@ class ErfCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
   virtual ~ErfCompute() = default;
 };
 
+// relu, relu6 and leaky_relu of int8 tensors quantized per tensor
+template <PrecisionType OutType>
+class ActivationInt8Compute
+    : public KernelLite<TARGET(kX86), PRECISION(kInt8)> {
+ public:
+  using param_t = operators::ActivationParam;
+  using out_t = typename std::
+      conditional<OutType == PRECISION(kInt8), int8_t, float>::type;
+
+  void Run() override {
+    namespace x86_math = paddle::lite::x86::math;
+    auto& param = *param_.get_mutable<param_t>();
+    x86_math::Int8ActType act_type = x86_math::kInt8ActNone;
+    float alpha = 0.f;
+    switch (param.active_type) {
+      case lite_api::ActivationType::kRelu:
+        act_type = x86_math::kInt8ActRelu;
+        break;
+      case lite_api::ActivationType::kRelu6:
+        act_type = x86_math::kInt8ActRelu6;
+        alpha = param.threshold;
+        break;
+      case lite_api::ActivationType::kLeakyRelu:
+        act_type = x86_math::kInt8ActLeakyRelu;
+        alpha = param.Leaky_relu_alpha;
+        break;
+      default:
+        LOG(FATAL) << "Unsupported int8 activation: "
+                   << static_cast<int>(param.active_type);
+    }
+    x86_math::int8_activation(param.X->template data<int8_t>(),
+                              param.Out->template mutable_data<out_t>(),
+                              param.X->numel(),
+                              param.input_scale,
+                              param.output_scale,
+                              act_type,
+                              alpha);
+  }
+
+  virtual ~ActivationInt8Compute() = default;
+};
+
 }  // namespace x86
 }  // namespace kernels
 }  // namespace lite
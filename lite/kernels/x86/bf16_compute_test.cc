@@ -0,0 +1,462 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "lite/backends/x86/math/gemm_bf16.h"
+#include "lite/core/op_registry.h"
+#include "lite/kernels/x86/conv_compute.h"
+#include "lite/kernels/x86/fc_compute.h"
+#include "lite/kernels/x86/layer_norm_compute.h"
+#include "lite/kernels/x86/matmul_compute.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+namespace math = lite::x86::math;
+
+// Fill a bf16 tensor with values in [-1, 1), and return them as float32.
+static std::vector<float> FillBF16(Tensor* tensor, const DDim& dims, int seed) {
+  tensor->Resize(dims);
+  auto* data = tensor->mutable_data<lite_api::bfloat16, uint16_t>();
+  std::vector<float> values(dims.production());
+  for (size_t i = 0; i < values.size(); ++i) {
+    float value = static_cast<float>((i * 37 + seed * 11) % 101) / 50.f - 1.f;
+    data[i] = math::fp32_to_bf16(value);
+    values[i] = math::bf16_to_fp32(data[i]);
+  }
+  return values;
+}
+
+// Fill a float32 weight, and return the values rounded to bf16, which are
+// the ones the bf16 kernels compute with.
+static std::vector<float> FillFP32Weight(Tensor* tensor,
+                                         const DDim& dims,
+                                         int seed) {
+  tensor->Resize(dims);
+  tensor->set_persistable(true);
+  auto* data = tensor->mutable_data<float>();
+  std::vector<float> values(dims.production());
+  for (size_t i = 0; i < values.size(); ++i) {
+    data[i] = static_cast<float>((i * 13 + seed * 7) % 97) / 48.f - 1.f;
+    values[i] = math::bf16_to_fp32(math::fp32_to_bf16(data[i]));
+  }
+  return values;
+}
+
+// The output is rounded to bf16 once, so it is within 2^-8 of the float
+// result relatively.
+static void CheckBF16Output(const Tensor& out, const std::vector<float>& ref) {
+  ASSERT_EQ(out.numel(), static_cast<int64_t>(ref.size()));
+  const uint16_t* data = out.data<uint16_t>();
+  for (size_t i = 0; i < ref.size(); ++i) {
+    float value = math::bf16_to_fp32(data[i]);
+    ASSERT_NEAR(value, ref[i], 1e-4f + std::fabs(ref[i]) * 8e-3f)
+        << "at " << i;
+  }
+}
+
+template <typename KernelT, typename ParamT>
+static void PrepareKernel(KernelT* kernel, const ParamT& param) {
+  std::unique_ptr<KernelContext> ctx(new KernelContext);
+  ctx->As<X86Context>();
+  kernel->SetContext(std::move(ctx));
+  kernel->SetParam(param);
+}
+
+// y[m, n] = x[m, k] * w[k, n] + bias, with relu if `relu`
+static std::vector<float> RefFc(const std::vector<float>& x,
+                                const std::vector<float>& w,
+                                const std::vector<float>& bias,
+                                int m,
+                                int n,
+                                int k,
+                                bool relu) {
+  std::vector<float> y(m * n);
+  for (int i = 0; i < m; ++i) {
+    for (int j = 0; j < n; ++j) {
+      double sum = bias.empty() ? 0. : bias[j];
+      for (int l = 0; l < k; ++l) {
+        sum += static_cast<double>(x[i * k + l]) * w[l * n + j];
+      }
+      y[i * n + j] = relu ? std::max(static_cast<float>(sum), 0.f) : sum;
+    }
+  }
+  return y;
+}
+
+TEST(fc_x86_bf16, compute) {
+  using FcBF16 = FcCompute<PRECISION(kBF16), PRECISION(kBF16)>;
+  const int m = 5, k = 37, n = 19;
+  for (bool bf16_weights : {false, true}) {
+    for (bool relu : {false, true}) {
+      Tensor x, w, bias, out;
+      auto x_values = FillBF16(&x, DDim({m, k}), 1);
+      std::vector<float> w_values;
+      if (bf16_weights) {
+        // converted by the predictor, see bf16_attribute_pass
+        w_values = FillBF16(&w, DDim({k, n}), 2);
+        w.set_persistable(true);
+      } else {
+        w_values = FillFP32Weight(&w, DDim({k, n}), 2);
+      }
+      bias.Resize({n});
+      std::vector<float> bias_values(n);
+      for (int i = 0; i < n; ++i) {
+        bias_values[i] = bias.mutable_data<float>()[i] = 0.1f * i - 0.5f;
+      }
+      out.Resize({m, n});
+
+      operators::FcParam param;
+      param.input = &x;
+      param.w = &w;
+      param.bias = &bias;
+      param.output = &out;
+      param.in_num_col_dims = 1;
+      param.activation_type = relu ? "relu" : "";
+      FcBF16 fc;
+      PrepareKernel(&fc, param);
+      fc.Launch();
+      auto ref = RefFc(x_values, w_values, bias_values, m, n, k, relu);
+      CheckBF16Output(out, ref);
+    }
+  }
+}
+
+// The weights packed offline replace the raw ones, which can be released.
+TEST(fc_x86_bf16, packed_weights) {
+  using FcBF16 = FcCompute<PRECISION(kBF16), PRECISION(kBF16)>;
+  const int m = 3, k = 20, n = 33;
+  Tensor x, w, out;
+  auto x_values = FillBF16(&x, DDim({m, k}), 3);
+  auto w_values = FillFP32Weight(&w, DDim({k, n}), 4);
+  out.Resize({m, n});
+  operators::FcParam param;
+  param.input = &x;
+  param.w = &w;
+  param.output = &out;
+  param.in_num_col_dims = 1;
+
+  FcBF16 packer;
+  PrepareKernel(&packer, param);
+  Tensor packed;
+  std::string weight_arg;
+  ASSERT_TRUE(packer.PackWeights(&packed, &weight_arg));
+  EXPECT_EQ(weight_arg, "W");
+  EXPECT_EQ(packed.precision(), PRECISION(kInt16));
+  EXPECT_EQ(packer.PackedWeightsTag(), "x86_gemm_bf16");
+  EXPECT_TRUE((FcCompute<PRECISION(kFloat), PRECISION(kFloat)>()
+                   .PackedWeightsTag()
+                   .empty()));
+
+  // keep the dims of W only, as RuntimeProgram::ReleasePackedRawWeights does
+  Tensor released;
+  released.Resize(w.dims());
+  param.w = &released;
+  FcBF16 fc;
+  PrepareKernel(&fc, param);
+  fc.SetPackedWeights(&packed);
+  fc.Launch();
+  CheckBF16Output(out, RefFc(x_values, w_values, {}, m, n, k, false));
+}
+
+// Convolution of [num, chin, h, w] by [chout, chin / group, kh, kw] in float.
+static std::vector<float> RefConv(const std::vector<float>& x,
+                                  const std::vector<float>& w,
+                                  const std::vector<float>& bias,
+                                  const DDim& x_dims,
+                                  const DDim& w_dims,
+                                  const DDim& o_dims,
+                                  int group,
+                                  int stride,
+                                  int pad,
+                                  const operators::ActivationParam& act) {
+  const int num = x_dims[0], chin = x_dims[1], hin = x_dims[2];
+  const int win = x_dims[3];
+  const int chout = w_dims[0], kh = w_dims[2], kw = w_dims[3];
+  const int hout = o_dims[2], wout = o_dims[3];
+  const int chin_g = chin / group, chout_g = chout / group;
+  std::vector<float> out(o_dims.production());
+  for (int b = 0; b < num; ++b) {
+    for (int oc = 0; oc < chout; ++oc) {
+      const int g = oc / chout_g;
+      for (int oh = 0; oh < hout; ++oh) {
+        for (int ow = 0; ow < wout; ++ow) {
+          double sum = bias.empty() ? 0. : bias[oc];
+          for (int ic = 0; ic < chin_g; ++ic) {
+            for (int i = 0; i < kh; ++i) {
+              for (int j = 0; j < kw; ++j) {
+                int ih = oh * stride - pad + i;
+                int iw = ow * stride - pad + j;
+                if (ih < 0 || ih >= hin || iw < 0 || iw >= win) continue;
+                sum += static_cast<double>(
+                           x[((b * chin + g * chin_g + ic) * hin + ih) * win +
+                             iw]) *
+                       w[((oc * chin_g + ic) * kh + i) * kw + j];
+              }
+            }
+          }
+          float value = static_cast<float>(sum);
+          if (act.has_active) {
+            if (act.active_type == lite_api::ActivationType::kRelu) {
+              value = std::max(value, 0.f);
+            } else if (act.active_type == lite_api::ActivationType::kRelu6) {
+              value = std::min(std::max(value, 0.f), act.Relu_clipped_coef);
+            } else if (act.active_type ==
+                       lite_api::ActivationType::kLeakyRelu) {
+              value = value > 0.f ? value : value * act.Leaky_relu_alpha;
+            }
+          }
+          out[((b * chout + oc) * hout + oh) * wout + ow] = value;
+        }
+      }
+    }
+  }
+  return out;
+}
+
+TEST(conv2d_x86_bf16, compute) {
+  using ConvBF16 = Conv2dCompute<PRECISION(kBF16), PRECISION(kBF16)>;
+  struct Case {
+    int group, kernel, stride, pad;
+    lite_api::ActivationType act;
+  };
+  // 3x3 im2col and 1x1 gemm, with relu fused into the gemm and the other
+  // activations applied on the float output
+  const std::vector<Case> cases{
+      {1, 3, 1, 1, lite_api::ActivationType::kIndentity},
+      {2, 3, 2, 1, lite_api::ActivationType::kRelu},
+      {1, 1, 1, 0, lite_api::ActivationType::kRelu6},
+      {2, 1, 1, 0, lite_api::ActivationType::kLeakyRelu},
+  };
+  const int num = 2, chin = 4, chout = 6, hin = 7, win = 9;
+  for (auto& c : cases) {
+    for (bool bf16_filter : {false, true}) {
+      const int hout = (hin + 2 * c.pad - c.kernel) / c.stride + 1;
+      const int wout = (win + 2 * c.pad - c.kernel) / c.stride + 1;
+      DDim x_dims({num, chin, hin, win});
+      DDim w_dims({chout, chin / c.group, c.kernel, c.kernel});
+      DDim o_dims({num, chout, hout, wout});
+      Tensor x, filter, bias, out;
+      auto x_values = FillBF16(&x, x_dims, 5);
+      auto w_values = bf16_filter ? FillBF16(&filter, w_dims, 6)
+                                  : FillFP32Weight(&filter, w_dims, 6);
+      bias.Resize({chout});
+      std::vector<float> bias_values(chout);
+      for (int i = 0; i < chout; ++i) {
+        bias_values[i] = bias.mutable_data<float>()[i] = 0.05f * i - 0.1f;
+      }
+      out.Resize(o_dims);
+
+      operators::ConvParam param;
+      param.x = &x;
+      param.filter = &filter;
+      param.bias = &bias;
+      param.output = &out;
+      param.groups = c.group;
+      param.strides = {c.stride, c.stride};
+      param.paddings = std::make_shared<std::vector<int>>(
+          std::vector<int>{c.pad, c.pad, c.pad, c.pad});
+      param.dilations =
+          std::make_shared<std::vector<int>>(std::vector<int>{1, 1});
+      auto& act = param.activation_param;
+      act.has_active = c.act != lite_api::ActivationType::kIndentity;
+      act.active_type = c.act;
+      act.Relu_clipped_coef = 0.5f;
+      act.Leaky_relu_alpha = 0.1f;
+
+      ConvBF16 conv;
+      PrepareKernel(&conv, param);
+      auto ref = RefConv(x_values,
+                         w_values,
+                         bias_values,
+                         x_dims,
+                         w_dims,
+                         o_dims,
+                         c.group,
+                         c.stride,
+                         c.pad,
+                         act);
+      // the second run reuses the buffers of the first one
+      for (int run = 0; run < 2; ++run) {
+        conv.Launch();
+        CheckBF16Output(out, ref);
+      }
+    }
+  }
+}
+
+TEST(matmul_x86_bf16, compute) {
+  const int batch = 3, m = 4, k = 21, n = 18;
+  for (bool trans_x : {false, true}) {
+    for (bool trans_y : {false, true}) {
+      // Y is an activation of the same batch, or a float32 weight
+      for (bool y_is_weight : {false, true}) {
+        Tensor x, y, out;
+        DDim x_dims = trans_x ? DDim({batch, k, m}) : DDim({batch, m, k});
+        DDim y_dims = trans_y ? DDim({n, k}) : DDim({k, n});
+        if (!y_is_weight) {
+          y_dims = trans_y ? DDim({batch, n, k}) : DDim({batch, k, n});
+        }
+        auto x_values = FillBF16(&x, x_dims, 7);
+        auto y_values = y_is_weight ? FillFP32Weight(&y, y_dims, 8)
+                                    : FillBF16(&y, y_dims, 8);
+        out.Resize({batch, m, n});
+
+        operators::MatMulParam param;
+        param.X = &x;
+        param.Y = &y;
+        param.Out = &out;
+        param.transpose_X = trans_x;
+        param.transpose_Y = trans_y;
+        param.alpha = 0.5f;
+        MatMulBF16Compute matmul;
+        PrepareKernel(&matmul, param);
+        matmul.Launch();
+
+        std::vector<float> ref(batch * m * n);
+        for (int b = 0; b < batch; ++b) {
+          const int yb = y_is_weight ? 0 : b;
+          for (int i = 0; i < m; ++i) {
+            for (int j = 0; j < n; ++j) {
+              double sum = 0.;
+              for (int l = 0; l < k; ++l) {
+                float xv = trans_x ? x_values[(b * k + l) * m + i]
+                                   : x_values[(b * m + i) * k + l];
+                float yv = trans_y ? y_values[(yb * n + j) * k + l]
+                                   : y_values[(yb * k + l) * n + j];
+                sum += static_cast<double>(xv) * yv;
+              }
+              ref[(b * m + i) * n + j] = 0.5 * sum;
+            }
+          }
+        }
+        CheckBF16Output(out, ref);
+      }
+    }
+  }
+}
+
+TEST(matmul_x86_bf16, packed_weights) {
+  const int m = 6, k = 17, n = 20;
+  Tensor x, y, out;
+  auto x_values = FillBF16(&x, DDim({m, k}), 9);
+  auto y_values = FillFP32Weight(&y, DDim({k, n}), 10);
+  out.Resize({m, n});
+  operators::MatMulParam param;
+  param.X = &x;
+  param.Y = &y;
+  param.Out = &out;
+
+  MatMulBF16Compute packer;
+  PrepareKernel(&packer, param);
+  Tensor packed;
+  std::string weight_arg;
+  ASSERT_TRUE(packer.PackWeights(&packed, &weight_arg));
+  EXPECT_EQ(weight_arg, "Y");
+
+  Tensor released;
+  released.Resize(y.dims());
+  param.Y = &released;
+  MatMulBF16Compute matmul;
+  PrepareKernel(&matmul, param);
+  matmul.SetPackedWeights(&packed);
+  matmul.Launch();
+  CheckBF16Output(out, RefFc(x_values, y_values, {}, m, n, k, false));
+
+  // an activation Y is packed at every run
+  Tensor activation;
+  FillBF16(&activation, DDim({k, n}), 11);
+  param.Y = &activation;
+  MatMulBF16Compute unpacked;
+  PrepareKernel(&unpacked, param);
+  EXPECT_FALSE(unpacked.PackWeights(&packed, &weight_arg));
+}
+
+TEST(layer_norm_x86_bf16, compute) {
+  const int rows = 6, cols = 40;
+  Tensor x, scale, bias, y, mean, var;
+  auto x_values = FillBF16(&x, DDim({2, rows / 2, cols}), 12);
+  scale.Resize({cols});
+  bias.Resize({cols});
+  for (int j = 0; j < cols; ++j) {
+    scale.mutable_data<float>()[j] = 0.5f + 0.02f * j;
+    bias.mutable_data<float>()[j] = 0.01f * j - 0.2f;
+  }
+  y.Resize({2, rows / 2, cols});
+  mean.Resize({rows});
+  var.Resize({rows});
+
+  operators::LayerNormParam param;
+  param.X = &x;
+  param.Scale = &scale;
+  param.Bias = &bias;
+  param.Y = &y;
+  param.Mean = &mean;
+  param.Variance = &var;
+  param.begin_norm_axis = 2;
+  param.epsilon = 1e-5f;
+  LayerNormBF16Compute layer_norm;
+  PrepareKernel(&layer_norm, param);
+  layer_norm.Launch();
+
+  std::vector<float> ref(rows * cols);
+  for (int i = 0; i < rows; ++i) {
+    double sum = 0.;
+    for (int j = 0; j < cols; ++j) sum += x_values[i * cols + j];
+    double m = sum / cols;
+    double sq = 0.;
+    for (int j = 0; j < cols; ++j) {
+      sq += (x_values[i * cols + j] - m) * (x_values[i * cols + j] - m);
+    }
+    double v = sq / cols;
+    EXPECT_NEAR(mean.data<float>()[i], m, 1e-5);
+    EXPECT_NEAR(var.data<float>()[i], v, 1e-5);
+    for (int j = 0; j < cols; ++j) {
+      ref[i * cols + j] = (x_values[i * cols + j] - m) / std::sqrt(v + 1e-5) *
+                              scale.data<float>()[j] +
+                          bias.data<float>()[j];
+    }
+  }
+  CheckBF16Output(y, ref);
+}
+
+TEST(x86_bf16, kernels_registered) {
+  for (auto op_type : {"fc", "conv2d", "matmul", "matmul_v2", "layer_norm"}) {
+    bool found = false;
+    for (auto& kernel : KernelRegistry::Global().Create(op_type)) {
+      found = found || (kernel->target() == TARGET(kX86) &&
+                        kernel->precision() == PRECISION(kBF16));
+    }
+    EXPECT_TRUE(found) << op_type;
+  }
+}
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_KERNEL(fc, kX86, kBF16, kNCHW, def);
+USE_LITE_KERNEL(conv2d, kX86, kBF16, kNCHW, def);
+USE_LITE_KERNEL(matmul, kX86, kBF16, kNCHW, def);
+USE_LITE_KERNEL(matmul_v2, kX86, kBF16, kNCHW, def);
+USE_LITE_KERNEL(layer_norm, kX86, kBF16, kNCHW, def);
@@ -17,6 +17,7 @@
 #include <vector>
 #include "lite/backends/x86/fluid/float16.h"
 #include "lite/backends/x86/math/calib.h"
+#include "lite/backends/x86/math/gemm_bf16.h"
 #include "lite/core/op_registry.h"
 #include "lite/core/type_system.h"
 
@@ -145,6 +146,23 @@ void CalibComputeInt64ToFp32<Ptype, DLType>::Run() {
   }
 }
 
+template <PrecisionType Ptype, DataLayoutType DLType>
+void CalibComputeFp32ToBF16<Ptype, DLType>::Run() {
+  auto& param = this->template Param<operators::CalibParam>();
+  const auto* din = param.input->template data<float>();
+  auto* dout =
+      param.output->template mutable_data<lite_api::bfloat16, uint16_t>();
+  lite::x86::math::fp32_to_bf16(din, dout, param.input->numel());
+}
+
+template <PrecisionType Ptype, DataLayoutType DLType>
+void CalibComputeBF16ToFp32<Ptype, DLType>::Run() {
+  auto& param = this->template Param<operators::CalibParam>();
+  const auto* din = param.input->template data<uint16_t>();
+  auto* dout = param.output->template mutable_data<float>();
+  lite::x86::math::bf16_to_fp32(din, dout, param.input->numel());
+}
+
 }  // namespace x86
 }  // namespace kernels
 }  // namespace lite
@@ -318,3 +336,33 @@ REGISTER_LITE_KERNEL(
                {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt64))})
     .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kFP16))})
     .Finalize();
+
+typedef paddle::lite::kernels::x86::CalibComputeFp32ToBF16<PRECISION(kBF16),
+                                                           DATALAYOUT(kNCHW)>
+    bf16_fp32_to_bf16;
+REGISTER_LITE_KERNEL(calib, kX86, kBF16, kNCHW, bf16_fp32_to_bf16, fp32_to_bf16)
+    .BindInput("Input",
+               {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kFloat))})
+    .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kBF16))})
+    .Finalize();
+
+typedef paddle::lite::kernels::x86::CalibComputeBF16ToFp32<PRECISION(kBF16),
+                                                           DATALAYOUT(kNCHW)>
+    bf16_bf16_to_fp32;
+REGISTER_LITE_KERNEL(calib, kX86, kBF16, kNCHW, bf16_bf16_to_fp32, bf16_to_fp32)
+    .BindInput("Input", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kBF16))})
+    .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kFloat))})
+    .Finalize();
+
+REGISTER_LITE_KERNEL(
+    calib_once, kX86, kBF16, kNCHW, bf16_fp32_to_bf16, fp32_to_bf16)
+    .BindInput("Input",
+               {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kFloat))})
+    .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kBF16))})
+    .Finalize();
+
+REGISTER_LITE_KERNEL(
+    calib_once, kX86, kBF16, kNCHW, bf16_bf16_to_fp32, bf16_to_fp32)
+    .BindInput("Input", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kBF16))})
+    .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kFloat))})
+    .Finalize();
@@ -168,6 +168,30 @@ class CalibComputeFp16ToInt32 : public KernelLite<TARGET(kX86), Ptype, DLType> {
  private:
 };
 
+template <PrecisionType Ptype, DataLayoutType DLType>
+class CalibComputeFp32ToBF16 : public KernelLite<TARGET(kX86), Ptype, DLType> {
+ public:
+  using param_t = operators::CalibParam;
+
+  void Run() override;
+
+  ~CalibComputeFp32ToBF16() override{};
+
+ private:
+};
+
+template <PrecisionType Ptype, DataLayoutType DLType>
+class CalibComputeBF16ToFp32 : public KernelLite<TARGET(kX86), Ptype, DLType> {
+ public:
+  using param_t = operators::CalibParam;
+
+  void Run() override;
+
+  ~CalibComputeBF16ToFp32() override{};
+
+ private:
+};
+
 }  // namespace x86
 }  // namespace kernels
 }  // namespace lite
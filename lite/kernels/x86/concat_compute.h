@@ -14,7 +14,11 @@
 #pragma once
 
 #include <Eigen/Core>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
 #include <vector>
+#include "lite/backends/x86/math/int8_compute.h"
 #include "lite/core/kernel.h"
 #include "lite/core/op_registry.h"
 #include "lite/core/types.h"
@@ -78,6 +82,81 @@ class ConcatCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
   virtual ~ConcatCompute() = default;
 };
 
+// Concat of int8 tensors, the inputs with a scale other than the output one
+// are requantized while being copied.
+template <PrecisionType OutType>
+class ConcatInt8Compute : public KernelLite<TARGET(kX86), PRECISION(kInt8)> {
+ public:
+  using param_t = operators::ConcatParam;
+  using out_t = typename std::
+      conditional<OutType == PRECISION(kInt8), int8_t, float>::type;
+
+  void Run() override {
+    auto& param = *param_.get_mutable<param_t>();
+    int axis = param.axis;
+    if (param.axis_tensor != nullptr) {
+      axis = param.axis_tensor->template data<int>()[0];
+    }
+    const auto& x_dims = param.x[0]->dims();
+    if (axis < 0) {
+      axis += static_cast<int>(x_dims.size());
+    }
+    CHECK_EQ(param.x_input_scales.size(), param.x.size());
+
+    auto* out = param.output;
+    out_t* output_data = out->template mutable_data<out_t>();
+    int offset_concat_axis = 0;
+    int num_concat = count(0, axis, x_dims);
+    int concat_input_size = count(axis + 1, x_dims.size(), x_dims);
+    const int top_concat_axis = out->dims()[axis];
+    for (size_t i = 0; i < param.x.size(); ++i) {
+      const int8_t* bottom_data = param.x[i]->template data<int8_t>();
+      const int64_t bottom_concat_axis = param.x[i]->dims()[axis];
+      for (int n = 0; n < num_concat; ++n) {
+        CopySegment(
+            bottom_data + n * bottom_concat_axis * concat_input_size,
+            output_data +
+                (n * top_concat_axis + offset_concat_axis) * concat_input_size,
+            bottom_concat_axis * concat_input_size,
+            param.x_input_scales[i],
+            param.output_scale);
+      }
+      offset_concat_axis += bottom_concat_axis;
+    }
+  }
+
+  virtual ~ConcatInt8Compute() = default;
+
+ private:
+  static void CopySegment(const int8_t* in,
+                          int8_t* out,
+                          int64_t size,
+                          float in_scale,
+                          float out_scale) {
+    if (std::fabs(in_scale - out_scale) <= 1e-7f * out_scale) {
+      std::memcpy(out, in, size);
+    } else {
+      paddle::lite::x86::math::int8_requant(
+          in, out, size, in_scale / out_scale);
+    }
+  }
+
+  static void CopySegment(const int8_t* in,
+                          float* out,
+                          int64_t size,
+                          float in_scale,
+                          float out_scale) {
+    paddle::lite::x86::math::int8_activation(
+        in,
+        out,
+        size,
+        in_scale,
+        1.f,
+        paddle::lite::x86::math::kInt8ActNone,
+        0.f);
+  }
+};
+
 }  // namespace x86
 }  // namespace kernels
 }  // namespace lite
@@ -13,8 +13,12 @@
 // limitations under the License.
 
 #include "lite/kernels/x86/conv_compute.h"
+#include <string>
+#include <type_traits>
 #include <utility>
+#include <vector>
 #include "lite/backends/x86/math/fill_bias_activate.h"
+#include "lite/backends/x86/math/gemm_bf16.h"
 #include "lite/kernels/x86/conv_depthwise.h"
 #include "lite/kernels/x86/conv_direct.h"
 
@@ -212,6 +216,114 @@ void Conv2dCompute<PRECISION(kFloat), PRECISION(kFloat)>::Run() {
   if (!flag_1x1gemm_) TargetFree(TARGET(kX86), col_data);
 }
 
+// The gemm of every group prepacks its weights, i.e. A, at construction.
+// With packed, the gemms are restored from the blob of PackInt8Gemms and the
+// raw filter is not read, so it can be released.
+template <typename TYPE_C>
+void CreateInt8Gemms(
+    const operators::ConvParam& param,
+    int n,
+    const Tensor* packed,
+    std::vector<lite::x86::math::generate_gemm_s8u8_x86_kern<TYPE_C>*>*
+        gemms) {
+  using gemm_t = lite::x86::math::generate_gemm_s8u8_x86_kern<TYPE_C>;
+  const bool out_int8 = std::is_same<TYPE_C, int8_t>::value;
+  const auto& w_dims = param.filter->dims();
+  const int groups = param.groups;
+  const int m = w_dims[0] / groups;
+  const int k = w_dims[1] * w_dims[2] * w_dims[3];
+  const float output_scale = param.output_scale;
+  int relu_type = 0;
+  float relu_alpha = 1.f;
+  if (!out_int8 || param.activation_param.has_active) {
+    const float alpha_scale = out_int8 ? 1.f / output_scale : 1.f;
+    if (param.activation_param.active_type ==
+        lite_api::ActivationType::kRelu6) {
+      relu_type = 2;
+      relu_alpha = param.activation_param.Relu_clipped_coef * alpha_scale;
+    } else if (param.activation_param.active_type ==
+               lite_api::ActivationType::kLeakyRelu) {
+      relu_type = 3;
+      relu_alpha = param.activation_param.Leaky_relu_alpha * alpha_scale;
+    } else if (param.activation_param.active_type ==
+               lite_api::ActivationType::kRelu) {
+      relu_type = 1;
+    }
+  }
+
+  if (packed != nullptr) {
+    const size_t group_size = gemm_t::packed_size(m, k);
+    CHECK_EQ(packed->numel(), static_cast<int64_t>(groups * group_size))
+        << "The packed weights do not match the filter " << w_dims;
+    const int8_t* packed_data = packed->data<int8_t>();
+    for (int g = 0; g < groups; g++) {
+      gemms->push_back(new gemm_t(false,
+                                  false,
+                                  m,
+                                  n,
+                                  k,
+                                  packed_data + g * group_size,
+                                  n,
+                                  relu_type,
+                                  relu_alpha));
+    }
+    return;
+  }
+
+  auto w_scale = param.weight_scale;
+  if (w_scale.size() != 1 && w_scale.size() != w_dims[0]) {
+    LOG(FATAL) << "weights scale size must equal to filter size";
+  }
+  std::vector<float> weight_scale(w_dims[0], w_scale[0]);
+  if (w_scale.size() != 1) {
+    weight_scale = w_scale;
+  }
+  const int8_t* weights = param.filter->data<int8_t>();
+  const float* bias_ptr =
+      param.bias != nullptr ? param.bias->data<float>() : nullptr;
+  for (int g = 0; g < groups; g++) {
+    gemms->push_back(new gemm_t(false,
+                                false,
+                                m,
+                                n,
+                                k,
+                                weights + g * m * k,
+                                n,
+                                weight_scale.data() + g * m,
+                                param.input_scale,
+                                output_scale,
+                                bias_ptr ? bias_ptr + g * m : nullptr,
+                                relu_type,
+                                relu_alpha));
+  }
+}
+
+// Export the prepacked weights of every group, the output size is not known
+// offline but it only sizes the buffer of the packed B, which is not saved.
+template <typename TYPE_C>
+bool PackInt8Gemms(const operators::ConvParam& param,
+                   Tensor* packed,
+                   std::string* weight_arg) {
+  using gemm_t = lite::x86::math::generate_gemm_s8u8_x86_kern<TYPE_C>;
+  if (param.filter == nullptr || !param.filter->IsInitialized()) {
+    return false;
+  }
+  std::vector<gemm_t*> gemms;
+  CreateInt8Gemms<TYPE_C>(param, 1, nullptr, &gemms);
+  const auto& w_dims = param.filter->dims();
+  const size_t group_size = gemm_t::packed_size(
+      w_dims[0] / param.groups, w_dims[1] * w_dims[2] * w_dims[3]);
+  packed->Resize({static_cast<int64_t>(gemms.size() * group_size)});
+  packed->set_precision(PRECISION(kInt8));
+  int8_t* packed_data = packed->mutable_data<int8_t>();
+  for (size_t g = 0; g < gemms.size(); g++) {
+    gemms[g]->export_packed(packed_data + g * group_size);
+    delete gemms[g];
+  }
+  *weight_arg = "Filter";
+  return true;
+}
+
 template <>
 void Conv2dCompute<PRECISION(kInt8), PRECISION(kFloat)>::PrepareForRun() {
   PREPARE_PARAM_INT8
@@ -223,69 +335,14 @@ void Conv2dCompute<PRECISION(kInt8), PRECISION(kFloat)>::PrepareForRun() {
   }
 
   auto o_dims = param.output->dims();
-  int m = output_channel / groups;
   int n = o_dims[2] * o_dims[3];
-  int k = input_channel * kernel_h * kernel_w / groups;
-  int group_size_weights = m * k;
-  auto weights = param.filter->data<int8_t>();
-  bool flag_bias = (param.bias != nullptr);
-  const float* bias_ptr =
-      flag_bias ? static_cast<const float*>(param.bias->data<float>())
-                : nullptr;
-  auto w_scale_ = param.weight_scale;
-
-  Tensor weight_s{};
-  weight_s.Resize({param.filter->dims()[0]});
-  weight_s.set_precision(PRECISION(kFloat));
-  auto weight_tmp = weight_s.mutable_data<float>();
-
-  if (w_scale_.size() != 1 && w_scale_.size() != param.filter->dims()[0]) {
-    LOG(FATAL) << "weights scale size must equal to filter size";
-  }
-  if (w_scale_.size() == 1) {
-    for (int i = 0; i < param.filter->dims()[0]; ++i) {
-      weight_tmp[i] = (w_scale_[0]);
-    }
-  } else {
-    for (int i = 0; i < param.filter->dims()[0]; ++i) {
-      weight_tmp[i] = (w_scale_[i]);
-    }
-  }
-  auto weight_scale = weight_s.data<float>();
-  const float input_scale = param.input_scale;
-  const float output_scale = param.output_scale;
-  int relu_type = 0;
-  float relu_alpha = 1.f;
+  CreateInt8Gemms(param, n, this->packed_weights_, &gemm_s8_ptr_float_);
+}
 
-  if (param.activation_param.active_type == lite_api::ActivationType::kRelu6) {
-    relu_type = 2;
-    relu_alpha = param.activation_param.Relu_clipped_coef;
-  } else if (param.activation_param.active_type ==
-             lite_api::ActivationType::kLeakyRelu) {
-    relu_type = 3;
-    relu_alpha = param.activation_param.Leaky_relu_alpha;
-  } else if (param.activation_param.active_type ==
-             lite_api::ActivationType::kRelu) {
-    relu_type = 1;
-  }
-  for (int g = 0; g < groups; g++) {
-    const int8_t* weights_group = weights + g * group_size_weights;
-    auto gemm = new lite::x86::math::generate_gemm_s8u8_x86_kern<float>(
-        false,
-        false,
-        m,
-        n,
-        k,
-        weights_group,
-        n,
-        weight_scale + g * m,
-        input_scale,
-        output_scale,
-        bias_ptr + g * m,
-        relu_type,
-        relu_alpha);
-    gemm_s8_ptr_float_.push_back(gemm);
-  }
+template <>
+bool Conv2dCompute<PRECISION(kInt8), PRECISION(kFloat)>::PackWeights(
+    Tensor* packed, std::string* weight_arg) {
+  return PackInt8Gemms<float>(this->Param<param_t>(), packed, weight_arg);
 }
 
 template <>
@@ -295,11 +352,9 @@ void Conv2dCompute<PRECISION(kInt8), PRECISION(kFloat)>::Run() {
   int channel_size_in = hin * win;
   int channel_size_out = hout * wout;
   int chin_per_group = chin / group;
-  int group_size_weights = m * k;
   int8_t* col_data = nullptr;
   auto din = param.x->data<int8_t>();
   auto dout = param.output->mutable_data<float>();
-  auto weights = param.filter->data<int8_t>();
   auto paddings = *param.paddings;
   auto dilations = *param.dilations;
 
@@ -313,8 +368,8 @@ void Conv2dCompute<PRECISION(kInt8), PRECISION(kFloat)>::Run() {
       float* dout_group = dout + (b * chout + g * m) * channel_size_out;
       const int8_t* din_group =
           din + (b * chin + g * chin_per_group) * channel_size_in;
-      const int8_t* weights_group = weights + g * group_size_weights;
 
+      // the gemm holds the prepacked weights of the group
       if (!flag_1x1gemm_) {
         lite::x86::math::im2col<int8_t>(din_group,
                                         chin_per_group,
@@ -331,9 +386,9 @@ void Conv2dCompute<PRECISION(kInt8), PRECISION(kFloat)>::Run() {
                                         dilations[0],
                                         dilations[1],
                                         col_data);
-        gemm_s8_ptr_float_[g]->compute(weights_group, col_data, dout_group);
+        gemm_s8_ptr_float_[g]->compute(nullptr, col_data, dout_group);
       } else {
-        gemm_s8_ptr_float_[g]->compute(weights_group, din_group, dout_group);
+        gemm_s8_ptr_float_[g]->compute(nullptr, din_group, dout_group);
       }
     }
   }
@@ -351,72 +406,14 @@ void Conv2dCompute<PRECISION(kInt8), PRECISION(kInt8)>::PrepareForRun() {
   }
 
   auto o_dims = param.output->dims();
-  int m = output_channel / groups;
   int n = o_dims[2] * o_dims[3];
-  int k = input_channel * kernel_h * kernel_w / groups;
-  int group_size_weights = m * k;
-  auto weights = param.filter->data<int8_t>();
-  bool flag_bias = (param.bias != nullptr);
-  const float* bias_ptr =
-      flag_bias ? static_cast<const float*>(param.bias->data<float>())
-                : nullptr;
-  auto w_scale_ = param.weight_scale;
-  Tensor weight_s{};
-  weight_s.Resize({param.filter->dims()[0]});
-  weight_s.set_precision(PRECISION(kFloat));
-  auto weight_tmp = weight_s.mutable_data<float>();
-
-  if (w_scale_.size() != 1 && w_scale_.size() != param.filter->dims()[0]) {
-    LOG(FATAL) << "weights scale size must equal to filter size";
-  }
-  if (w_scale_.size() == 1) {
-    for (int i = 0; i < param.filter->dims()[0]; ++i) {
-      weight_tmp[i] = (w_scale_[0]);
-    }
-  } else {
-    for (int i = 0; i < param.filter->dims()[0]; ++i) {
-      weight_tmp[i] = (w_scale_[i]);
-    }
-  }
-  const float input_scale = param.input_scale;
-  const float output_scale = param.output_scale;
-  int relu_type = 0;
-  float relu_alpha = 1.f;
-
-  if (param.activation_param.has_active) {
-    if (param.activation_param.active_type ==
-        lite_api::ActivationType::kRelu6) {
-      relu_type = 2;
-      relu_alpha = param.activation_param.Relu_clipped_coef / output_scale;
-    } else if (param.activation_param.active_type ==
-               lite_api::ActivationType::kLeakyRelu) {
-      relu_type = 3;
-      relu_alpha = param.activation_param.Leaky_relu_alpha / output_scale;
-    } else if (param.activation_param.active_type ==
-               lite_api::ActivationType::kRelu) {
-      relu_type = 1;
-    }
-  }
+  CreateInt8Gemms(param, n, this->packed_weights_, &gemm_s8_ptr_int8_);
+}
 
-  auto weight_scale = weight_s.data<float>();
-  for (int g = 0; g < groups; g++) {
-    const int8_t* weights_group = weights + g * group_size_weights;
-    auto gemm = new lite::x86::math::generate_gemm_s8u8_x86_kern<int8_t>(
-        false,
-        false,
-        m,
-        n,
-        k,
-        weights_group,
-        n,
-        weight_scale + g * m,
-        input_scale,
-        output_scale,
-        bias_ptr + g * m,
-        relu_type,
-        relu_alpha);
-    gemm_s8_ptr_int8_.push_back(gemm);
-  }
+template <>
+bool Conv2dCompute<PRECISION(kInt8), PRECISION(kInt8)>::PackWeights(
+    Tensor* packed, std::string* weight_arg) {
+  return PackInt8Gemms<int8_t>(this->Param<param_t>(), packed, weight_arg);
 }
 
 template <>
@@ -426,11 +423,9 @@ void Conv2dCompute<PRECISION(kInt8), PRECISION(kInt8)>::Run() {
   int channel_size_in = hin * win;
   int channel_size_out = hout * wout;
   int chin_per_group = chin / group;
-  int group_size_weights = m * k;
   int8_t* col_data = nullptr;
   auto din = param.x->data<int8_t>();
   auto dout = param.output->mutable_data<int8_t>();
-  auto weights = param.filter->data<int8_t>();
   auto paddings = *param.paddings;
   auto dilations = *param.dilations;
 
@@ -444,8 +439,8 @@ void Conv2dCompute<PRECISION(kInt8), PRECISION(kInt8)>::Run() {
       int8_t* dout_group = dout + (b * chout + g * m) * channel_size_out;
       const int8_t* din_group =
           din + (b * chin + g * chin_per_group) * channel_size_in;
-      const int8_t* weights_group = weights + g * group_size_weights;
 
+      // the gemm holds the prepacked weights of the group
       if (!flag_1x1gemm_) {
         lite::x86::math::im2col<int8_t>(din_group,
                                         chin_per_group,
@@ -462,9 +457,9 @@ void Conv2dCompute<PRECISION(kInt8), PRECISION(kInt8)>::Run() {
                                         dilations[0],
                                         dilations[1],
                                         col_data);
-        gemm_s8_ptr_int8_[g]->compute(weights_group, col_data, dout_group);
+        gemm_s8_ptr_int8_[g]->compute(nullptr, col_data, dout_group);
       } else {
-        gemm_s8_ptr_int8_[g]->compute(weights_group, din_group, dout_group);
+        gemm_s8_ptr_int8_[g]->compute(nullptr, din_group, dout_group);
       }
     }
   }
@@ -473,6 +468,155 @@ void Conv2dCompute<PRECISION(kInt8), PRECISION(kInt8)>::Run() {
 
 #undef PREPARE_PARAM
 #undef PREPARE_PARAM_INT8
+
+// relu is fused into the gemm epilogue of the bf16 conv, other activations
+// are applied to a float32 output by fill_bias_act before rounding to bf16.
+static bool BF16ConvFusesAct(const operators::ConvParam& param) {
+  return !param.activation_param.has_active ||
+         param.activation_param.active_type ==
+             lite_api::ActivationType::kRelu;
+}
+
+// Size the im2col, packed im2col and float32 output buffers of the bf16 conv
+// for the current shapes, their memory is reallocated only if they grow.
+static void ResizeBF16ConvBuffers(const operators::ConvParam& param,
+                                  bool flag_1x1gemm,
+                                  Tensor* col,
+                                  Tensor* packed_col,
+                                  Tensor* out_fp32) {
+  const auto& w_dims = param.filter->dims();
+  const auto& o_dims = param.output->dims();
+  const int group = param.groups;
+  const int64_t n = o_dims[2] * o_dims[3];
+  const int64_t k = w_dims[1] * w_dims[2] * w_dims[3];
+  if (!flag_1x1gemm) {
+    col->Resize({k * n * group});
+    col->mutable_data<lite_api::bfloat16, uint16_t>();
+  }
+  packed_col->Resize({lite::x86::math::gemm_bf16_packed_b_size(k, n)});
+  packed_col->mutable_data<lite_api::bfloat16, uint16_t>();
+  if (!BF16ConvFusesAct(param)) {
+    out_fp32->Resize({o_dims[1] * n});
+    out_fp32->mutable_data<float>();
+  }
+}
+
+template <>
+void Conv2dCompute<PRECISION(kBF16), PRECISION(kBF16)>::PrepareForRun() {
+  auto& param = this->Param<param_t>();
+  auto paddings = *param.paddings;
+  auto dilations = *param.dilations;
+  const auto& w_dims = param.filter->dims();
+  flag_1x1gemm_ = w_dims[2] == 1 && w_dims[3] == 1 &&
+                  param.strides[0] == 1 && param.strides[1] == 1 &&
+                  paddings[0] == 0 && paddings[1] == 0 && paddings[2] == 0 &&
+                  paddings[3] == 0 && dilations[0] == 1 && dilations[1] == 1;
+  // The filter is converted to bf16 by the predictor according to the
+  // attribute set by bf16_attribute_pass, fp32 filter is still accepted.
+  if (param.filter->precision() == PRECISION(kBF16)) {
+    weights_.ShareDataWith(*param.filter);
+  } else {
+    weights_.Resize(w_dims);
+    lite::x86::math::fp32_to_bf16(
+        param.filter->data<float>(),
+        weights_.mutable_data<lite_api::bfloat16, uint16_t>(),
+        w_dims.production());
+  }
+  ResizeBF16ConvBuffers(
+      param, flag_1x1gemm_, &col_bf16_, &packed_col_bf16_, &out_fp32_);
+}
+
+template <>
+void Conv2dCompute<PRECISION(kBF16), PRECISION(kBF16)>::Run() {
+  INIT_PARAM
+  bool flag_bias = (param.bias != nullptr);
+  auto paddings = *param.paddings;
+  auto dilations = *param.dilations;
+  auto act_param = param.activation_param;
+  bool fuse_act = BF16ConvFusesAct(param);
+
+  const uint16_t* din = param.x->data<uint16_t>();
+  uint16_t* dout = param.output->mutable_data<lite_api::bfloat16, uint16_t>();
+  const uint16_t* weights = weights_.data<uint16_t>();
+  const float* bias_ptr = flag_bias ? param.bias->data<float>() : nullptr;
+
+  ResizeBF16ConvBuffers(
+      param, flag_1x1gemm_, &col_bf16_, &packed_col_bf16_, &out_fp32_);
+  uint16_t* col_data =
+      flag_1x1gemm_ ? nullptr
+                    : col_bf16_.mutable_data<lite_api::bfloat16, uint16_t>();
+  uint16_t* packed_data =
+      packed_col_bf16_.mutable_data<lite_api::bfloat16, uint16_t>();
+
+  for (int i = 0; i < num; i++) {
+    const uint16_t* din_batch =
+        din + static_cast<int64_t>(i) * chin * hin * win;
+    uint16_t* dout_batch = dout + static_cast<int64_t>(i) * chout * n;
+    const uint16_t* din_data = din_batch;
+    if (!flag_1x1gemm_) {
+      lite::x86::math::im2col<uint16_t>(din_batch,
+                                        chin,
+                                        hin,
+                                        win,
+                                        kh,
+                                        kw,
+                                        paddings[0],
+                                        paddings[1],
+                                        paddings[2],
+                                        paddings[3],
+                                        param.strides[0],
+                                        param.strides[1],
+                                        dilations[0],
+                                        dilations[1],
+                                        col_data);
+      din_data = col_data;
+    }
+
+    for (int g = 0; g < group; g++) {
+      lite::x86::math::gemm_bf16_pack_b(false,
+                                        k,
+                                        n,
+                                        din_data + g * k * n,
+                                        n,
+                                        packed_data);
+      lite::x86::math::GemmBF16Epilogue epilogue;
+      const uint16_t* weights_group = weights + g * m * k;
+      if (fuse_act) {
+        epilogue.bias = flag_bias ? bias_ptr + g * m : nullptr;
+        epilogue.bias_by_row = true;
+        epilogue.relu = act_param.has_active;
+        lite::x86::math::gemm_bf16_packed<uint16_t>(m,
+                                                    n,
+                                                    k,
+                                                    weights_group,
+                                                    k,
+                                                    packed_data,
+                                                    dout_batch + g * m * n,
+                                                    n,
+                                                    epilogue);
+      } else {
+        lite::x86::math::gemm_bf16_packed<float>(
+            m,
+            n,
+            k,
+            weights_group,
+            k,
+            packed_data,
+            out_fp32_.mutable_data<float>() + g * m * n,
+            n,
+            epilogue);
+      }
+    }
+    if (!fuse_act) {
+      float* out_data = out_fp32_.mutable_data<float>();
+      lite::x86::math::fill_bias_act(
+          out_data, bias_ptr, chout, n, flag_bias, &act_param);
+      lite::x86::math::fp32_to_bf16(
+          out_data, dout_batch, static_cast<int64_t>(chout) * n);
+    }
+  }
+}
+
 #undef INIT_PARAM
 }  // namespace x86
 }  // namespace kernels
@@ -488,6 +632,9 @@ typedef paddle::lite::kernels::x86::Conv2dCompute<PRECISION(kInt8),
 typedef paddle::lite::kernels::x86::Conv2dCompute<PRECISION(kInt8),
                                                   PRECISION(kInt8)>
     ConvInt8_Int8;
+typedef paddle::lite::kernels::x86::Conv2dCompute<PRECISION(kBF16),
+                                                  PRECISION(kBF16)>
+    ConvBF16;
 
 REGISTER_LITE_KERNEL(conv2d, kX86, kFloat, kNCHW, ConvFp32, def)
     .BindInput("Input", {LiteType::GetTensorTy(TARGET(kX86))})
@@ -551,3 +698,15 @@ REGISTER_LITE_KERNEL(
                 {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kFloat))})
     .BindPaddleOpVersion("depthwise_conv2d", 1)
     .Finalize();
+
+REGISTER_LITE_KERNEL(conv2d, kX86, kBF16, kNCHW, ConvBF16, def)
+    .BindInput("Input", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kBF16))})
+    .BindInput("SecondInput",
+               {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kBF16))})
+    .BindInput("Bias", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kFloat))})
+    .BindInput("Filter",
+               {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kBF16))})
+    .BindOutput("Output",
+                {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kBF16))})
+    .BindPaddleOpVersion("conv2d", 1)
+    .Finalize();
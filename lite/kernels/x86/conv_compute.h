@@ -59,6 +59,15 @@ class Conv2dCompute : public KernelLite<TARGET(kX86), Ptype> {
 
   virtual void Run();
 
+  // Only the int8 gemm of x86 supports the offline packed weights for now.
+  virtual bool PackWeights(Tensor* packed, std::string* weight_arg) {
+    return false;
+  }
+
+  virtual std::string PackedWeightsTag() const {
+    return Ptype == PRECISION(kInt8) ? "x86_avx2_gemm_s8u8" : "";
+  }
+
 #ifdef LITE_WITH_PROFILE
   std::string kernel_func_name_{"Conv2d"};
   virtual void SetProfileRuntimeKernelInfo(
@@ -86,12 +95,24 @@ class Conv2dCompute : public KernelLite<TARGET(kX86), Ptype> {
   std::vector<float> w_scale_;
   Tensor weights_;
   Tensor bias_;
+  // The im2col, packed im2col and float32 output buffers of the bf16 conv
+  Tensor col_bf16_;
+  Tensor packed_col_bf16_;
+  Tensor out_fp32_;
   std::vector<lite::x86::math::generate_gemm_s8u8_x86_kern<float>*>
       gemm_s8_ptr_float_{};
   std::vector<lite::x86::math::generate_gemm_s8u8_x86_kern<int8_t>*>
       gemm_s8_ptr_int8_{};
 };
 
+template <>
+bool Conv2dCompute<PRECISION(kInt8), PRECISION(kFloat)>::PackWeights(
+    Tensor* packed, std::string* weight_arg);
+
+template <>
+bool Conv2dCompute<PRECISION(kInt8), PRECISION(kInt8)>::PackWeights(
+    Tensor* packed, std::string* weight_arg);
+
 }  // namespace x86
 }  // namespace kernels
 }  // namespace lite
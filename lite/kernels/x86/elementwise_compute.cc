@@ -16,10 +16,13 @@
 // by 0 will get the correct result in ElementWise OP.
 
 #include "lite/kernels/x86/elementwise_compute.h"
+#include <cstring>
 #include <string>
+#include <type_traits>
 #include <vector>
 #include "lite/backends/x86/math/elementwise.h"
 #include "lite/backends/x86/math/elementwise_common_broadcast_config.h"
+#include "lite/backends/x86/math/int8_compute.h"
 #include "lite/kernels/host/elementwise_op_func.h"
 
 namespace paddle {
@@ -350,6 +353,123 @@ void elementwise_compute_template(paddle::lite::KernelBase* kernel,
     }                                                                         \
   }
 
+static void store_fp32_output(const float* in,
+                              float* out,
+                              int64_t size,
+                              float out_scale) {
+  std::memcpy(out, in, size * sizeof(float));
+}
+
+static void store_fp32_output(const float* in,
+                              int8_t* out,
+                              int64_t size,
+                              float out_scale) {
+  x86_math::int8_quantize(in, out, size, out_scale);
+}
+
+template <PrecisionType OutType, class X86Config>
+void elementwise_int8_compute_template(paddle::lite::KernelBase* kernel,
+                                       BinaryOpFn<float> op,
+                                       bool is_mul) {
+  using out_t = typename std::
+      conditional<OutType == PRECISION(kInt8), int8_t, float>::type;
+  auto& param = kernel->template Param<operators::ElementwiseParam>();
+  auto x = param.X;
+  auto y = param.Y;
+  auto* x_data = x->template data<int8_t>();
+  auto* y_data = y->template data<int8_t>();
+  auto* out_data = param.Out->template mutable_data<out_t>();
+  const float x_scale = param.x_input_scale;
+  const float y_scale = param.y_input_scale;
+  int axis = param.axis;
+  auto x_dims = x->dims();
+  auto y_dims = y->dims();
+  int pre, n, post;
+
+  if (x_dims == y_dims) {
+    x86_math::int8_elementwise(x_data,
+                               y_data,
+                               out_data,
+                               1,
+                               x_dims.production(),
+                               1,
+                               false,
+                               is_mul,
+                               x_scale,
+                               y_scale,
+                               param.output_scale);
+  } else if (is_fast_broadcast(x_dims, y_dims, axis, &pre, &n, &post)) {
+    x86_math::int8_elementwise(x_data,
+                               y_data,
+                               out_data,
+                               pre,
+                               n,
+                               post,
+                               true,
+                               is_mul,
+                               x_scale,
+                               y_scale,
+                               param.output_scale);
+  } else if (axis == -1 &&
+             is_fast_broadcast(y_dims, x_dims, axis, &pre, &n, &post)) {
+    // add and mul are commutative, so x is broadcast as y
+    x86_math::int8_elementwise(y_data,
+                               x_data,
+                               out_data,
+                               pre,
+                               n,
+                               post,
+                               true,
+                               is_mul,
+                               y_scale,
+                               x_scale,
+                               param.output_scale);
+  } else {
+    // the general broadcast is rare, dequantize and run it in fp32
+    Tensor x_fp32, y_fp32, out_fp32;
+    x_fp32.Resize(x_dims);
+    y_fp32.Resize(y_dims);
+    out_fp32.Resize(param.Out->dims());
+    x86_math::int8_activation(x_data,
+                              x_fp32.mutable_data<float>(),
+                              x_dims.production(),
+                              x_scale,
+                              1.f,
+                              x86_math::kInt8ActNone,
+                              0.f);
+    x86_math::int8_activation(y_data,
+                              y_fp32.mutable_data<float>(),
+                              y_dims.production(),
+                              y_scale,
+                              1.f,
+                              x86_math::kInt8ActNone,
+                              0.f);
+    auto batch_arg = lite::kernels::host::GenBatchElementWiseArg<float>(
+        &x_fp32, &y_fp32, &out_fp32, axis);
+    X86CommonElementWise<float, int64_t, X86Config>::Run(batch_arg, op);
+    store_fp32_output(out_fp32.data<float>(),
+                      out_data,
+                      out_fp32.numel(),
+                      param.output_scale);
+  }
+}
+
+#define ElementwiseOpInt8Compute(op, is_mul)                                  \
+  template <PrecisionType OutType>                                            \
+  void Elementwise##op##Int8Compute<OutType>::Run() {                         \
+    using X86Config = paddle::lite::x86::math::MergeConfig<                   \
+        lite::x86::math::op##Config<float>,                                   \
+        lite::x86::math::                                                     \
+            ActiveConfig<lite::x86::math::ActiveType::NO_ACTIVE, float>>;     \
+    elementwise_int8_compute_template<OutType, X86Config>(                    \
+        this, lite::x86::math::Naive##op<float>, is_mul);                     \
+  }
+
+// clang-format off
+ElementwiseOpInt8Compute(Add, false)
+ElementwiseOpInt8Compute(Mul, true)
+// clang-format on
+
 // clang-format off
 ElementwiseOpCompute(Add)
 ElementwiseOpActivationCompute(Add)
@@ -736,3 +856,51 @@ REGISTER_LITE_KERNEL(elementwise_min,
     .BindInput("Y", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt64))})
     .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt64))})
     .Finalize();
+
+REGISTER_LITE_KERNEL(
+    elementwise_add,
+    kX86,
+    kInt8,
+    kNCHW,
+    paddle::lite::kernels::x86::ElementwiseAddInt8Compute<PRECISION(kInt8)>,
+    int8_out)
+    .BindInput("X", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .BindInput("Y", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .Finalize();
+
+REGISTER_LITE_KERNEL(
+    elementwise_add,
+    kX86,
+    kInt8,
+    kNCHW,
+    paddle::lite::kernels::x86::ElementwiseAddInt8Compute<PRECISION(kFloat)>,
+    fp32_out)
+    .BindInput("X", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .BindInput("Y", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kFloat))})
+    .Finalize();
+
+REGISTER_LITE_KERNEL(
+    elementwise_mul,
+    kX86,
+    kInt8,
+    kNCHW,
+    paddle::lite::kernels::x86::ElementwiseMulInt8Compute<PRECISION(kInt8)>,
+    int8_out)
+    .BindInput("X", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .BindInput("Y", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .Finalize();
+
+REGISTER_LITE_KERNEL(
+    elementwise_mul,
+    kX86,
+    kInt8,
+    kNCHW,
+    paddle::lite::kernels::x86::ElementwiseMulInt8Compute<PRECISION(kFloat)>,
+    fp32_out)
+    .BindInput("X", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .BindInput("Y", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kFloat))})
+    .Finalize();
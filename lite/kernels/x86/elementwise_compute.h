@@ -184,6 +184,25 @@ class ElementwisePowActivationCompute
   virtual ~ElementwisePowActivationCompute() = default;
 };
 
+// int8 add and mul with per tensor scales, OutType is the output precision
+template <PrecisionType OutType>
+class ElementwiseAddInt8Compute
+    : public KernelLite<TARGET(kX86), PRECISION(kInt8)> {
+ public:
+  void Run() override;
+
+  virtual ~ElementwiseAddInt8Compute() = default;
+};
+
+template <PrecisionType OutType>
+class ElementwiseMulInt8Compute
+    : public KernelLite<TARGET(kX86), PRECISION(kInt8)> {
+ public:
+  void Run() override;
+
+  virtual ~ElementwiseMulInt8Compute() = default;
+};
+
 }  // namespace x86
 }  // namespace kernels
 }  // namespace lite
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "lite/kernels/x86/fc_compute.h"
+#include "lite/backends/x86/math/gemm_bf16.h"
 #include "lite/backends/x86/math/gemm_s8u8_compute.h"
 #include "lite/backends/x86/math/saturate.h"
 
@@ -139,6 +140,64 @@ class FCFunctor {
   }
 };
 
+template <PrecisionType PType, PrecisionType OutType>
+void FcCompute<PType, OutType>::PrepareForRun() {}
+
+// Pack W for lite::x86::math::gemm_bf16_packed. The packed weights are
+// stored as int16, so that they are saved into the model as is by the opt
+// tool, see FcCompute::PackWeights.
+static void PackBF16Weights(const operators::FcParam& param, Tensor* packed) {
+  auto* w = param.w;
+  const auto& w_dims = w->dims();
+  bool padding_weights = param.padding_weights;
+  int k = padding_weights ? w_dims[0] - 4 : w_dims[0];
+  int n = padding_weights ? w_dims[1] - 4 : w_dims[1];
+  int ldw = w_dims[1];
+  packed->Resize({lite::x86::math::gemm_bf16_packed_b_size(k, n)});
+  packed->set_precision(PRECISION(kInt16));
+  auto* packed_data =
+      reinterpret_cast<uint16_t*>(packed->mutable_data<int16_t>());
+  // The weights are converted to bf16 by the predictor according to the
+  // attribute set by bf16_attribute_pass, fp32 weights are still accepted.
+  if (w->precision() == PRECISION(kBF16)) {
+    lite::x86::math::gemm_bf16_pack_b(
+        false, k, n, w->data<uint16_t>(), ldw, packed_data);
+  } else {
+    lite::x86::math::gemm_bf16_pack_b(
+        false, k, n, w->data<float>(), ldw, packed_data);
+  }
+}
+
+template <>
+void FcCompute<PRECISION(kBF16), PRECISION(kBF16)>::PrepareForRun() {
+  auto& param = this->Param<operators::FcParam>();
+  // With the weights packed offline, W is not read, so the predictor
+  // releases it and only the packed bf16 copy is kept.
+  if (this->packed_weights_ != nullptr) {
+    const auto& w_dims = param.w->dims();
+    int k = param.padding_weights ? w_dims[0] - 4 : w_dims[0];
+    int n = param.padding_weights ? w_dims[1] - 4 : w_dims[1];
+    CHECK_EQ(this->packed_weights_->numel(),
+             lite::x86::math::gemm_bf16_packed_b_size(k, n))
+        << "The packed weights do not match the weights " << w_dims;
+    packed_w_.ShareDataWith(*this->packed_weights_);
+    return;
+  }
+  PackBF16Weights(param, &packed_w_);
+}
+
+template <>
+bool FcCompute<PRECISION(kBF16), PRECISION(kBF16)>::PackWeights(
+    Tensor* packed, std::string* weight_arg) {
+  auto& param = this->Param<operators::FcParam>();
+  if (param.w == nullptr || !param.w->IsInitialized()) {
+    return false;
+  }
+  PackBF16Weights(param, packed);
+  *weight_arg = "W";
+  return true;
+}
+
 template <>
 void FcCompute<PRECISION(kFloat), PRECISION(kFloat)>::Run() {
   auto& param = *param_.get_mutable<param_t>();
@@ -268,6 +327,32 @@ void FcCompute<PRECISION(kInt8), PRECISION(kFloat)>::Run() {
   TargetFree(TARGET(kX86), w_scale);
 }
 
+template <>
+void FcCompute<PRECISION(kBF16), PRECISION(kBF16)>::Run() {
+  auto& param = this->Param<operators::FcParam>();
+  const auto& w_dims = param.w->dims();
+  int k = param.padding_weights ? w_dims[0] - 4 : w_dims[0];
+  int n = param.padding_weights ? w_dims[1] - 4 : w_dims[1];
+  int m = param.output->dims().production() / n;
+
+  if (param.activation_type != "" && param.activation_type != "relu")
+    LOG(FATAL) << "not support fuse activation except relu.";
+
+  lite::x86::math::GemmBF16Epilogue epilogue;
+  epilogue.bias = param.bias ? param.bias->data<float>() : nullptr;
+  epilogue.relu = (param.activation_type == "relu");
+  lite::x86::math::gemm_bf16_packed<uint16_t>(
+      m,
+      n,
+      k,
+      param.input->data<uint16_t>(),
+      k,
+      packed_w_.data<uint16_t>(),
+      param.output->mutable_data<lite_api::bfloat16, uint16_t>(),
+      n,
+      epilogue);
+}
+
 #undef GEMM_OUT_INT8
 #undef GEMM_OUT_FLOAT
 
@@ -286,6 +371,10 @@ typedef paddle::lite::kernels::x86::FcCompute<PRECISION(kInt8),
                                               PRECISION(kInt8)>
     FcCompute_int8_int8;
 
+typedef paddle::lite::kernels::x86::FcCompute<PRECISION(kBF16),
+                                              PRECISION(kBF16)>
+    FcCompute_bf16;
+
 REGISTER_LITE_KERNEL(fc, kX86, kFloat, kNCHW, FcCompute_FP32, def)
     .BindInput("Input", {LiteType::GetTensorTy(TARGET(kX86))})
     .BindInput("Bias", {LiteType::GetTensorTy(TARGET(kX86))})
@@ -306,3 +395,10 @@ REGISTER_LITE_KERNEL(fc, kX86, kInt8, kNCHW, FcCompute_int8_fp32, fp32_out)
     .BindInput("W", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
     .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86))})
     .Finalize();
+
+REGISTER_LITE_KERNEL(fc, kX86, kBF16, kNCHW, FcCompute_bf16, def)
+    .BindInput("Input", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kBF16))})
+    .BindInput("Bias", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kFloat))})
+    .BindInput("W", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kBF16))})
+    .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kBF16))})
+    .Finalize();
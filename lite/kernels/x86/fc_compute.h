@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <string>
 #include <vector>
 #include "lite/backends/x86/jit/helper.h"
 #include "lite/backends/x86/jit/kernel_base.h"
@@ -35,11 +36,30 @@ class FcCompute : public KernelLite<TARGET(kX86), PType> {
  public:
   using param_t = operators::FcParam;
 
+  virtual void PrepareForRun();
+
   virtual void Run();
 
+  // Only the bf16 gemm supports the offline packed weights for now.
+  virtual bool PackWeights(Tensor* packed, std::string* weight_arg) {
+    return false;
+  }
+
+  virtual std::string PackedWeightsTag() const {
+    return PType == PRECISION(kBF16) ? "x86_gemm_bf16" : "";
+  }
+
   virtual ~FcCompute() = default;
+
+ private:
+  // Weights packed for lite::x86::math::gemm_bf16_packed, bf16 kernel only.
+  Tensor packed_w_;
 };
 
+template <>
+bool FcCompute<PRECISION(kBF16), PRECISION(kBF16)>::PackWeights(
+    Tensor* packed, std::string* weight_arg);
+
 }  // namespace x86
 }  // namespace kernels
 }  // namespace lite
@@ -0,0 +1,245 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/kernels/x86/fused_attention_compute.h"
+#include <functional>
+#include <string>
+#include "lite/backends/x86/math/blas.h"
+#include "lite/backends/x86/math/gemm_s8u8_compute.h"
+#include "lite/backends/x86/parallel.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+template <PrecisionType PType>
+void FusedAttentionCompute<PType>::ReInitWhenNeeded() {
+  auto& param = this->template Param<param_t>();
+  const auto& input_dims = param.input->dims();
+  const auto& mask_dims = param.residual->dims();
+  const auto& lod = param.input->lod();
+  if (last_shape_ == input_dims && last_mask_shape_ == mask_dims &&
+      last_lod_ == lod) {
+    return;
+  }
+  last_shape_ = input_dims;
+  last_mask_shape_ = mask_dims;
+  last_lod_ = lod;
+  CHECK(param.softmax_axis == -1 || param.softmax_axis == 3)
+      << "fused_attention only supports softmax on the last axis.";
+  CHECK(param.activation_type.empty())
+      << "fused_attention does not support fc activation "
+      << param.activation_type;
+
+  int in_num_col_dims = param.in_num_col_dims;
+  if (param.op_type == "matmul" || param.op_type == "matmul_v2") {
+    in_num_col_dims = input_dims.size() - 1;
+  }
+  fc_m_ = input_dims.Slice(0, in_num_col_dims).production();
+  fc_k_ = input_dims.Slice(in_num_col_dims, input_dims.size()).production();
+  fc_n_ = param.fc_w->dims()[1];
+  CHECK_EQ(fc_k_, param.fc_w->dims()[0]);
+  CHECK_EQ(fc_n_ % 3, 0);
+
+  // reshape [batch, seq_len, hidden] -> [batch, seq_len, heads, head_dim]
+  const int hidden = fc_n_ / 3;
+  const auto& shape = param.reshape_shape;
+  CHECK_EQ(shape.size(), 4UL);
+  batch_ = input_dims[0];
+  seq_len_ = fc_m_ / batch_;
+  heads_ = shape[2] > 0 ? shape[2] : hidden / shape[3];
+  head_dim_ = hidden / heads_;
+  CHECK_EQ(heads_ * head_dim_, hidden);
+
+  // a packed batch of variable length sequences
+  seq_offsets_.clear();
+  if (!lod.empty() && lod[0].size() > 2) {
+    CHECK_EQ(batch_, 1) << "The packed input of fused_attention should be "
+                           "[1, total_tokens, hidden], but got "
+                        << input_dims;
+    CHECK_EQ(lod[0].front(), 0UL);
+    CHECK_EQ(lod[0].back(), static_cast<uint64_t>(seq_len_))
+        << "The LoD of fused_attention doesn't match the input tokens.";
+    seq_offsets_ = lod[0];
+  }
+
+  // broadcast the mask to the scores of [batch, heads, seq_len, seq_len]
+  const int64_t scores_dims[4] = {batch_, heads_, seq_len_, seq_len_};
+  const int mask_rank = mask_dims.size();
+  CHECK_LE(mask_rank, 4);
+  int64_t stride = 1;
+  for (int i = 3; i >= 0; --i) {
+    const int mi = i - (4 - mask_rank);
+    const int64_t dim = mi >= 0 ? mask_dims[mi] : 1;
+    CHECK(dim == 1 || dim == scores_dims[i])
+        << "The mask of fused_attention can't be broadcast to the scores, "
+        << mask_dims << " vs " << DDim(std::vector<int64_t>(scores_dims,
+                                                            scores_dims + 4));
+    mask_.stride[i] = dim == 1 ? 0 : stride;
+    stride *= dim;
+  }
+
+  if (param.enable_int8) {
+    // The fused fc0_scale and bias map the fc outputs to the quantized q, k
+    // and v, q * k is dequantized by fc1_scale (calib3 * calib4), and v by
+    // calib5 = fc2_scale / calib1. Both are folded into the fc scale, and
+    // the fc outputs are kept in fp32 instead of being requantized.
+    CHECK_EQ(param.fc0_scale.size(), static_cast<size_t>(fc_n_));
+    const float q_scale = param.fc1_scale[0];
+    const float v_scale = param.fc2_scale[0] / param.calib1_scale[0];
+    const float* bias =
+        param.fc_bias ? param.fc_bias->template data<float>() : nullptr;
+    fc_scale_.resize(fc_n_);
+    fc_bias_.resize(fc_n_);
+    for (int i = 0; i < fc_n_; ++i) {
+      float s = i < hidden ? q_scale : (i < 2 * hidden ? 1.f : v_scale);
+      fc_scale_[i] = param.fc0_scale[i] * s;
+      fc_bias_[i] = bias ? bias[i] * s : 0.f;
+    }
+  }
+}
+
+template <>
+void FusedAttentionCompute<PRECISION(kFloat)>::QKVProjection(float* qkv) {
+  auto& param = this->Param<param_t>();
+  auto& ctx = this->ctx_->template As<X86Context>();
+  auto blas = lite::x86::math::GetBlas<lite::TargetType::kX86, float>(ctx);
+  blas.GEMM(false,
+            false,
+            fc_m_,
+            fc_n_,
+            fc_k_,
+            1.f,
+            param.input->data<float>(),
+            fc_k_,
+            param.fc_w->data<float>(),
+            fc_n_,
+            0.f,
+            qkv,
+            fc_n_);
+  if (param.fc_bias) {
+    const float* bias = param.fc_bias->data<float>();
+    lite::x86::RunParallelFor(0, fc_m_, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        float* row = qkv + i * fc_n_;
+        for (int j = 0; j < fc_n_; ++j) {
+          row[j] += bias[j];
+        }
+      }
+    });
+  }
+}
+
+template <>
+void FusedAttentionCompute<PRECISION(kInt8)>::QKVProjection(float* qkv) {
+  auto& param = this->Param<param_t>();
+  // raw int32 accumulators as float, the scales are applied per column below
+  std::vector<float> ones(fc_m_, 1.f);
+  lite::x86::math::generate_gemm_s8u8_x86_kern<float> gemm(
+      false,
+      false,
+      fc_m_,
+      fc_n_,
+      fc_k_,
+      param.input->data<int8_t>(),
+      fc_n_,
+      ones.data(),
+      1.f,
+      1.f,
+      nullptr,
+      0,
+      1.f);
+  gemm.compute(param.input->data<int8_t>(), param.fc_w->data<int8_t>(), qkv);
+  lite::x86::RunParallelFor(0, fc_m_, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      float* row = qkv + i * fc_n_;
+      for (int j = 0; j < fc_n_; ++j) {
+        row[j] = row[j] * fc_scale_[j] + fc_bias_[j];
+      }
+    }
+  });
+}
+
+template <PrecisionType PType>
+void FusedAttentionCompute<PType>::Run() {
+  auto& param = this->template Param<param_t>();
+  auto& ctx = this->ctx_->template As<X86Context>();
+  ReInitWhenNeeded();
+
+  qkv_.Resize({fc_m_, fc_n_});
+  float* qkv = qkv_.mutable_data<float>();
+  QKVProjection(qkv);
+
+  const int hidden = fc_n_ / 3;
+  mask_.data = param.residual->template data<float>();
+  float* out = param.output->template mutable_data<float>();
+  // the int8 scale of q already includes the attention scale
+  float alpha = param.enable_int8 ? 1.f : param.scale;
+  if (!seq_offsets_.empty()) {
+    lite::x86::math::flash_attention_varlen_fp32(ctx,
+                                                 qkv,
+                                                 qkv + hidden,
+                                                 qkv + 2 * hidden,
+                                                 fc_n_,
+                                                 out,
+                                                 seq_offsets_,
+                                                 heads_,
+                                                 head_dim_,
+                                                 alpha,
+                                                 mask_);
+    return;
+  }
+  lite::x86::math::flash_attention_fp32(ctx,
+                                        qkv,
+                                        qkv + hidden,
+                                        qkv + 2 * hidden,
+                                        fc_n_,
+                                        out,
+                                        batch_,
+                                        heads_,
+                                        seq_len_,
+                                        head_dim_,
+                                        alpha,
+                                        mask_);
+}
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
+
+typedef paddle::lite::kernels::x86::FusedAttentionCompute<PRECISION(kFloat)>
+    FusedAttentionCompute_FP32;
+typedef paddle::lite::kernels::x86::FusedAttentionCompute<PRECISION(kInt8)>
+    FusedAttentionCompute_Int8;
+
+REGISTER_LITE_KERNEL(
+    fused_attention, kX86, kFloat, kNCHW, FusedAttentionCompute_FP32, def)
+    .BindInput("Input", {LiteType::GetTensorTy(TARGET(kX86))})
+    .BindInput("Residual", {LiteType::GetTensorTy(TARGET(kX86))})
+    .BindInput("W", {LiteType::GetTensorTy(TARGET(kX86))})
+    .BindInput("Bias", {LiteType::GetTensorTy(TARGET(kX86))})
+    .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86))})
+    .Finalize();
+
+REGISTER_LITE_KERNEL(
+    fused_attention, kX86, kInt8, kNCHW, FusedAttentionCompute_Int8, def)
+    .BindInput("Input", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .BindInput("Residual",
+               {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kFloat))})
+    .BindInput("W", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .BindInput("Bias", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kFloat))})
+    .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kFloat))})
+    .Finalize();
@@ -0,0 +1,69 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <vector>
+#include "lite/backends/x86/math/attention.h"
+#include "lite/core/kernel.h"
+#include "lite/core/op_registry.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+// fused_attention on x86: the fused qkv fc writes [batch, seq_len, 3, heads,
+// head_dim], which is read in place by the tiled attention, so neither the
+// transposes nor the [seq_len, seq_len] scores are materialized.
+// The int8 kernel runs the qkv fc in int8 and folds the dequantization
+// scales of q and v into the fc epilogue, the attention runs in fp32.
+// Padding-free mode: if Input is [1, total_tokens, hidden] with a level-0
+// LoD, the batch is packed into one sequence and every LoD segment only
+// attends to itself, Out is then [1, heads, total_tokens, head_dim].
+template <PrecisionType PType>
+class FusedAttentionCompute : public KernelLite<TARGET(kX86), PType> {
+ public:
+  using param_t = operators::FusedAttentionParam;
+
+  void Run() override;
+
+  virtual ~FusedAttentionCompute() = default;
+
+ private:
+  void ReInitWhenNeeded();
+  void QKVProjection(float* qkv);
+
+  DDim last_shape_;
+  DDim last_mask_shape_;
+  LoD last_lod_;
+  // level-0 LoD of the packed input, empty if Input is padded
+  std::vector<uint64_t> seq_offsets_;
+  int batch_{0};
+  int seq_len_{0};
+  int heads_{0};
+  int head_dim_{0};
+  int fc_m_{0};
+  int fc_k_{0};
+  int fc_n_{0};
+  lite::x86::math::AttentionMask mask_;
+  // int8: per column scale and bias of the qkv fc output
+  std::vector<float> fc_scale_;
+  std::vector<float> fc_bias_;
+  Tensor qkv_;
+};
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
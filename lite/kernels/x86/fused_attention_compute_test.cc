@@ -0,0 +1,316 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "lite/core/op_registry.h"
+#include "lite/core/program.h"
+#include "lite/kernels/x86/fused_attention_compute.h"
+#include "lite/model_parser/cpp_desc.h"
+#include "lite/tests/utils/fill_data.h"
+#include "lite/utils/string.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+// fc -> reshape -> transpose -> scale(q) -> q * k^T + mask -> softmax -> * v
+static void fused_attention_ref(const std::vector<float>& input,
+                                const std::vector<float>& w,
+                                const std::vector<float>& bias,
+                                const std::vector<float>& mask,
+                                std::vector<float>* out,
+                                int batch,
+                                int seq_len,
+                                int heads,
+                                int head_dim,
+                                float scale) {
+  const int hidden = heads * head_dim;
+  const int n = 3 * hidden;
+  std::vector<double> qkv(batch * seq_len * n);
+  for (int m = 0; m < batch * seq_len; ++m) {
+    for (int j = 0; j < n; ++j) {
+      double sum = bias[j];
+      for (int k = 0; k < hidden; ++k) {
+        sum += input[m * hidden + k] * w[k * n + j];
+      }
+      qkv[m * n + j] = sum;
+    }
+  }
+  std::vector<double> p(seq_len);
+  for (int b = 0; b < batch; ++b) {
+    for (int h = 0; h < heads; ++h) {
+      for (int i = 0; i < seq_len; ++i) {
+        const double* q = &qkv[(b * seq_len + i) * n + h * head_dim];
+        double max_val = -1e30;
+        for (int j = 0; j < seq_len; ++j) {
+          const double* k = &qkv[(b * seq_len + j) * n + hidden + h * head_dim];
+          double dot = 0.;
+          for (int d = 0; d < head_dim; ++d) {
+            dot += q[d] * scale * k[d];
+          }
+          p[j] = dot + mask[b * seq_len + j];
+          max_val = std::max(max_val, p[j]);
+        }
+        double sum = 0.;
+        for (int j = 0; j < seq_len; ++j) {
+          p[j] = std::exp(p[j] - max_val);
+          sum += p[j];
+        }
+        float* o = out->data() + ((b * heads + h) * seq_len + i) * head_dim;
+        for (int d = 0; d < head_dim; ++d) {
+          double acc = 0.;
+          for (int j = 0; j < seq_len; ++j) {
+            acc += p[j] / sum *
+                   qkv[(b * seq_len + j) * n + 2 * hidden + h * head_dim + d];
+          }
+          o[d] = acc;
+        }
+      }
+    }
+  }
+}
+
+TEST(fused_attention_x86, retrive_op) {
+  auto kernels = KernelRegistry::Global().Create("fused_attention");
+  ASSERT_FALSE(kernels.empty());
+  ASSERT_TRUE(kernels.front());
+}
+
+TEST(fused_attention_x86, compute) {
+  // seq_len spans several query and key blocks of the tiled attention
+  const int batch = 2, seq_len = 300, heads = 2, head_dim = 16;
+  const int hidden = heads * head_dim;
+  const float scale = 0.25f;
+  lite::Tensor input, w, bias, mask, out;
+  input.Resize({batch, seq_len, hidden});
+  w.Resize({hidden, 3 * hidden});
+  bias.Resize({3 * hidden});
+  mask.Resize({batch, 1, 1, seq_len});
+  out.Resize({batch, heads, seq_len, head_dim});
+  fill_data_rand(input.mutable_data<float>(), -1.f, 1.f, input.numel());
+  fill_data_rand(w.mutable_data<float>(), -0.5f, 0.5f, w.numel());
+  fill_data_rand(bias.mutable_data<float>(), -0.5f, 0.5f, bias.numel());
+  float* mask_data = mask.mutable_data<float>();
+  for (int b = 0; b < batch; ++b) {
+    for (int j = 0; j < seq_len; ++j) {
+      // the second sequence is padded after 200 tokens
+      mask_data[b * seq_len + j] = (b == 1 && j >= 200) ? -10000.f : 0.f;
+    }
+  }
+
+  operators::FusedAttentionParam param;
+  param.input = &input;
+  param.fc_w = &w;
+  param.fc_bias = &bias;
+  param.residual = &mask;
+  param.output = &out;
+  param.in_num_col_dims = 2;
+  param.reshape_shape = {0, 0, heads, head_dim};
+  param.scale = scale;
+
+  FusedAttentionCompute<PRECISION(kFloat)> attention;
+  std::unique_ptr<KernelContext> ctx(new KernelContext);
+  ctx->As<X86Context>();
+  attention.SetContext(std::move(ctx));
+  attention.SetParam(param);
+  attention.Run();
+
+  auto to_vector = [](const lite::Tensor& t) {
+    return std::vector<float>(t.data<float>(), t.data<float>() + t.numel());
+  };
+  std::vector<float> ref(out.numel());
+  fused_attention_ref(to_vector(input),
+                      to_vector(w),
+                      to_vector(bias),
+                      to_vector(mask),
+                      &ref,
+                      batch,
+                      seq_len,
+                      heads,
+                      head_dim,
+                      scale);
+  const float* out_data = out.data<float>();
+  for (int i = 0; i < out.numel(); ++i) {
+    EXPECT_NEAR(out_data[i], ref[i], 1e-4);
+  }
+}
+
+// Appends fused_attention -> transpose2 -> reshape2 -> fc, the layout of the
+// attention of an encoder layer, and returns the name of its output.
+static std::string AddAttentionLayer(cpp::BlockDesc* block_desc,
+                                     Scope* scope,
+                                     const std::string& input,
+                                     const std::string& mask,
+                                     int heads,
+                                     int head_dim,
+                                     float scale) {
+  static int id = 0;
+  const std::string prefix = "layer_" + paddle::lite::to_string(id++);
+  const int64_t hidden = heads * head_dim;
+  auto add_var = [&](const std::string& name,
+                     const std::vector<int64_t>& dims) {
+    block_desc->AddVar<cpp::VarDesc>()->SetName(name);
+    auto* tensor = scope->Var(name)->GetMutable<Tensor>();
+    if (!dims.empty()) {
+      tensor->Resize(dims);
+      fill_data_rand(
+          tensor->mutable_data<float>(), -0.5f, 0.5f, tensor->numel());
+      tensor->set_persistable(true);
+    }
+    return name;
+  };
+  auto add_op = [&](const std::string& type, const Place& place) {
+    auto* op_desc = block_desc->AddOp<cpp::OpDesc>();
+    op_desc->SetType(type);
+    op_desc->SetAttr<std::string>(
+        kKernelTypeAttr, KernelBase::SerializeKernelType(type, "def", place));
+    return op_desc;
+  };
+  const Place x86_place{TARGET(kX86), PRECISION(kFloat), DATALAYOUT(kNCHW)};
+
+  auto* attention = add_op("fused_attention", x86_place);
+  attention->SetInput("Input", {input});
+  attention->SetInput("Residual", {mask});
+  attention->SetInput("W", {add_var(prefix + "_qkv_w", {hidden, 3 * hidden})});
+  attention->SetInput("Bias", {add_var(prefix + "_qkv_b", {3 * hidden})});
+  attention->SetOutput("Out", {add_var(prefix + "_attention", {})});
+  attention->SetAttr<int>("in_num_col_dims", 2);
+  attention->SetAttr<std::vector<int>>("reshape_shape",
+                                       {0, 0, heads, head_dim});
+  attention->SetAttr<int>("softmax_axis", -1);
+  attention->SetAttr<float>("scale", scale);
+
+  auto* transpose = add_op("transpose2", x86_place);
+  transpose->SetInput("X", {prefix + "_attention"});
+  transpose->SetOutput("Out", {add_var(prefix + "_transpose", {})});
+  transpose->SetOutput("XShape", {add_var(prefix + "_transpose_xshape", {})});
+  transpose->SetAttr<std::vector<int>>("axis", {0, 2, 1, 3});
+
+  auto* reshape = add_op(
+      "reshape2", Place{TARGET(kHost), PRECISION(kAny), DATALAYOUT(kAny)});
+  reshape->SetInput("X", {prefix + "_transpose"});
+  reshape->SetOutput("Out", {add_var(prefix + "_reshape", {})});
+  reshape->SetOutput("XShape", {add_var(prefix + "_reshape_xshape", {})});
+  reshape->SetAttr<std::vector<int>>("shape",
+                                     {0, 0, static_cast<int>(hidden)});
+
+  auto* fc = add_op("fc", x86_place);
+  fc->SetInput("Input", {prefix + "_reshape"});
+  fc->SetInput("W", {add_var(prefix + "_out_w", {hidden, hidden})});
+  fc->SetInput("Bias", {add_var(prefix + "_out_b", {hidden})});
+  fc->SetOutput("Out", {add_var(prefix + "_out", {})});
+  fc->SetAttr<int>("in_num_col_dims", 2);
+  return prefix;
+}
+
+TEST(fused_attention_x86, packed_varlen_layers) {
+  // two sequences packed into [1, total_tokens, hidden] by LoD, run through
+  // two layers so that the LoD has to pass transpose2, reshape2 and fc
+  const std::vector<uint64_t> seq_offsets = {0, 70, 330};
+  const int total = seq_offsets.back(), heads = 2, head_dim = 16, layers = 2;
+  const int hidden = heads * head_dim;
+  const float scale = 0.25f;
+
+  Scope scope;
+  auto program_desc = std::make_shared<cpp::ProgramDesc>();
+  auto* block_desc = program_desc->AddBlock<cpp::BlockDesc>();
+  block_desc->ClearOps();
+  block_desc->ClearVars();
+  auto* input = scope.Var("input")->GetMutable<Tensor>();
+  input->Resize({1, total, hidden});
+  input->set_lod({seq_offsets});
+  fill_data_rand(input->mutable_data<float>(), -1.f, 1.f, input->numel());
+  auto* mask = scope.Var("mask")->GetMutable<Tensor>();
+  mask->Resize({1, 1, 1, total});
+  fill_data_const(mask->mutable_data<float>(), 0.f, mask->numel());
+  std::vector<std::string> prefixes;
+  std::string x = "input";
+  for (int l = 0; l < layers; ++l) {
+    prefixes.push_back(AddAttentionLayer(
+        block_desc, &scope, x, "mask", heads, head_dim, scale));
+    x = prefixes.back() + "_out";
+  }
+
+  RuntimeProgram program(program_desc, &scope, 0);
+  program.Run();
+  const auto* out = scope.FindVar(x)->GetMutable<Tensor>();
+  ASSERT_EQ(out->dims(), DDim({1, total, hidden}));
+  ASSERT_EQ(out->lod(), input->lod());
+
+  auto to_vector = [&](const std::string& name) {
+    const auto* t = scope.FindVar(name)->GetMutable<Tensor>();
+    return std::vector<float>(t->data<float>(), t->data<float>() + t->numel());
+  };
+  const float* in_data = input->data<float>();
+  const float* out_data = out->data<float>();
+  for (size_t b = 0; b + 1 < seq_offsets.size(); ++b) {
+    // each sequence alone is the reference
+    const int len = seq_offsets[b + 1] - seq_offsets[b];
+    std::vector<float> seq(in_data + seq_offsets[b] * hidden,
+                           in_data + seq_offsets[b + 1] * hidden);
+    std::vector<float> seq_mask(len, 0.f);
+    for (auto& prefix : prefixes) {
+      std::vector<float> attention(heads * len * head_dim);
+      fused_attention_ref(seq,
+                          to_vector(prefix + "_qkv_w"),
+                          to_vector(prefix + "_qkv_b"),
+                          seq_mask,
+                          &attention,
+                          1,
+                          len,
+                          heads,
+                          head_dim,
+                          scale);
+      auto out_w = to_vector(prefix + "_out_w");
+      auto out_b = to_vector(prefix + "_out_b");
+      for (int i = 0; i < len; ++i) {
+        for (int j = 0; j < hidden; ++j) {
+          double sum = out_b[j];
+          for (int k = 0; k < hidden; ++k) {
+            // [heads, len, head_dim] -> [len, heads * head_dim]
+            int h = k / head_dim, d = k % head_dim;
+            sum += attention[(h * len + i) * head_dim + d] *
+                   out_w[k * hidden + j];
+          }
+          seq[i * hidden + j] = sum;
+        }
+      }
+    }
+    for (int i = 0; i < len * hidden; ++i) {
+      EXPECT_NEAR(out_data[seq_offsets[b] * hidden + i], seq[i], 1e-3);
+    }
+  }
+}
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_OP(fused_attention);
+USE_LITE_OP(transpose2);
+USE_LITE_OP(reshape2);
+USE_LITE_OP(fc);
+USE_LITE_KERNEL(fused_attention, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(transpose2, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(reshape2, kHost, kAny, kAny, def);
+USE_LITE_KERNEL(fc, kX86, kFloat, kNCHW, def);
@@ -0,0 +1,74 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <vector>
+#include "lite/backends/x86/math/embedding_seq_pool.h"
+#include "lite/core/kernel.h"
+#include "lite/core/op_registry.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+template <typename T_IDS>
+class FusedEmbeddingSeqPoolCompute
+    : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
+ public:
+  using param_t = operators::FusedEmbeddingSeqPoolParam;
+
+  void Run() override {
+    auto& param = this->Param<param_t>();
+    const auto& lod = param.Ids->lod();
+    const auto& table_dims = param.W->dims();
+    jit::SeqPoolType type = jit::SeqPoolType::kSum;
+    if (param.combiner == "average") {
+      type = jit::SeqPoolType::kAvg;
+    } else if (param.combiner == "sqrt") {
+      type = jit::SeqPoolType::kSqrt;
+    }
+    lite::x86::math::embedding_seq_pool<T_IDS>(
+        param.W->template data<float>(),
+        table_dims[0],
+        table_dims[1],
+        param.Ids->template data<T_IDS>(),
+        lod.back(),
+        param.padding_idx,
+        type,
+        param.pad_value,
+        param.Out->template mutable_data<float>());
+
+    // the same output LoD as sequence_pool
+    std::vector<uint64_t> out_lod;
+    if (lod.size() == 2) {
+      out_lod = lod[0];
+    } else {
+      out_lod.resize(lod[0].size());
+      for (size_t i = 0; i < out_lod.size(); ++i) {
+        out_lod[i] = i;
+      }
+    }
+    param.Out->mutable_lod()->clear();
+    param.Out->mutable_lod()->push_back(out_lod);
+  }
+
+  virtual ~FusedEmbeddingSeqPoolCompute() = default;
+};
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
@@ -0,0 +1,155 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/kernels/x86/fused_embedding_seq_pool_compute.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <string>
+#include <vector>
+#include "lite/core/op_registry.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+// lookup_table followed by sequence_pool
+static void embedding_seq_pool_ref(const lite::Tensor& w,
+                                   const lite::Tensor& ids,
+                                   int64_t padding_idx,
+                                   const std::string& combiner,
+                                   float pad_value,
+                                   std::vector<float>* out) {
+  const int64_t width = w.dims()[1];
+  const auto& lod = ids.lod()[0];
+  const float* w_data = w.data<float>();
+  const int64_t* ids_data = ids.data<int64_t>();
+  out->assign((lod.size() - 1) * width, 0.f);
+  for (size_t s = 0; s + 1 < lod.size(); ++s) {
+    float* dst = out->data() + s * width;
+    const int64_t len = lod[s + 1] - lod[s];
+    for (int64_t j = lod[s]; j < static_cast<int64_t>(lod[s + 1]); ++j) {
+      if (padding_idx != -1 && ids_data[j] == padding_idx) continue;
+      for (int64_t i = 0; i < width; ++i) {
+        dst[i] += w_data[ids_data[j] * width + i];
+      }
+    }
+    for (int64_t i = 0; i < width; ++i) {
+      if (len == 0) {
+        dst[i] = pad_value;
+      } else if (combiner == "average") {
+        dst[i] /= len;
+      } else if (combiner == "sqrt") {
+        dst[i] /= std::sqrt(static_cast<float>(len));
+      }
+    }
+  }
+}
+
+TEST(fused_embedding_seq_pool_x86, retrive_op) {
+  auto kernels = KernelRegistry::Global().Create("fused_embedding_seq_pool");
+  ASSERT_FALSE(kernels.empty());
+  ASSERT_TRUE(kernels.front());
+}
+
+TEST(fused_embedding_seq_pool_x86, compute) {
+  const int vocab_size = 1000;
+  // the empty segment is padded with pad_value
+  const std::vector<uint64_t> lod = {0, 3, 3, 20, 21, 60};
+  for (int width : {8, 37, 64}) {
+    for (int64_t padding_idx : {-1, 7}) {
+      for (std::string combiner : {"sum", "average", "sqrt"}) {
+        lite::Tensor w, ids, out;
+        w.Resize({vocab_size, width});
+        ids.Resize({static_cast<int64_t>(lod.back()), 1});
+        ids.set_lod({lod});
+        out.Resize({static_cast<int64_t>(lod.size()) - 1, width});
+        auto* w_data = w.mutable_data<float>();
+        for (int i = 0; i < w.numel(); ++i) {
+          w_data[i] = static_cast<float>(i % 97) / 97.f - 0.5f;
+        }
+        auto* ids_data = ids.mutable_data<int64_t>();
+        for (int i = 0; i < ids.numel(); ++i) {
+          ids_data[i] = (i * 131 + 7) % vocab_size;
+        }
+
+        FusedEmbeddingSeqPoolCompute<int64_t> kernel;
+        operators::FusedEmbeddingSeqPoolParam param;
+        param.W = &w;
+        param.Ids = &ids;
+        param.Out = &out;
+        param.padding_idx = padding_idx;
+        param.combiner = combiner;
+        param.pad_value = 0.5f;
+        kernel.SetParam(param);
+        kernel.Run();
+
+        std::vector<float> ref;
+        embedding_seq_pool_ref(
+            w, ids, padding_idx, combiner, param.pad_value, &ref);
+        const float* out_data = out.data<float>();
+        for (int i = 0; i < out.numel(); ++i) {
+          EXPECT_NEAR(out_data[i], ref[i], 1e-5);
+        }
+        ASSERT_EQ(out.lod().size(), 1UL);
+        EXPECT_EQ(out.lod()[0].size(), lod.size());
+      }
+    }
+  }
+}
+
+TEST(fused_embedding_seq_pool_x86, invalid_id_without_padding) {
+  // without padding the id -1 is out of the table, not a padding id
+  lite::Tensor w, ids, out;
+  w.Resize({16, 8});
+  ids.Resize({4, 1});
+  ids.set_lod({{0, 2, 4}});
+  out.Resize({2, 8});
+  auto* w_data = w.mutable_data<float>();
+  for (int i = 0; i < w.numel(); ++i) {
+    w_data[i] = static_cast<float>(i);
+  }
+  auto* ids_data = ids.mutable_data<int64_t>();
+  ids_data[0] = 1;
+  ids_data[1] = 2;
+  ids_data[2] = -1;
+  ids_data[3] = 3;
+
+  FusedEmbeddingSeqPoolCompute<int64_t> kernel;
+  operators::FusedEmbeddingSeqPoolParam param;
+  param.W = &w;
+  param.Ids = &ids;
+  param.Out = &out;
+  param.padding_idx = -1;
+  param.combiner = "sum";
+  kernel.SetParam(param);
+  ASSERT_DEATH(kernel.Run(), "out of the embedding table");
+
+  // the same id is skipped if it is the padding id
+  ids_data[2] = 5;
+  param.padding_idx = 5;
+  kernel.SetParam(param);
+  kernel.Run();
+  const float* out_data = out.data<float>();
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(out_data[8 + i], w_data[3 * 8 + i]);
+  }
+}
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_KERNEL(fused_embedding_seq_pool, kX86, kFloat, kNCHW, def);
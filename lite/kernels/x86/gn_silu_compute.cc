@@ -0,0 +1,58 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/kernels/x86/gn_silu_compute.h"
+#include "lite/backends/x86/math/avx/group_norm.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+void GnSiluCompute::Run() {
+  auto& param = this->Param<param_t>();
+  const auto& dims = param.input->dims();
+  CHECK_EQ(dims.size(), 4UL);
+  const float* scale =
+      param.gn_scale.empty() ? nullptr : param.gn_scale[0]->data<float>();
+  const float* bias =
+      param.gn_bias.empty() ? nullptr : param.gn_bias[0]->data<float>();
+  lite::x86::math::group_norm_silu(param.input->data<float>(),
+                                   param.output->mutable_data<float>(),
+                                   dims[0],
+                                   dims[1],
+                                   dims[2],
+                                   dims[3],
+                                   param.epsilon,
+                                   param.groups,
+                                   scale,
+                                   bias);
+}
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_LITE_KERNEL(__xpu__gn_silu,
+                     kX86,
+                     kFloat,
+                     kNCHW,
+                     paddle::lite::kernels::x86::GnSiluCompute,
+                     def)
+    .BindInput("Input", {LiteType::GetTensorTy(TARGET(kX86))})
+    .BindInput("GNScale", {LiteType::GetTensorTy(TARGET(kX86))})
+    .BindInput("GNBias", {LiteType::GetTensorTy(TARGET(kX86))})
+    .BindOutput("Output", {LiteType::GetTensorTy(TARGET(kX86))})
+    .Finalize();
@@ -0,0 +1,208 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/kernels/x86/gn_silu_compute.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "lite/core/op_registry.h"
+#include "lite/kernels/x86/group_norm_compute.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+static void FillData(Tensor* tensor, int seed, float offset) {
+  auto* data = tensor->mutable_data<float>();
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    data[i] = offset + static_cast<float>((i * 13 + seed * 7) % 31 - 15) / 8;
+  }
+}
+
+// group_norm of NCHW x, followed by silu if `with_silu`
+static void RefGroupNorm(const Tensor& x,
+                         const float* scale,
+                         const float* bias,
+                         float epsilon,
+                         int groups,
+                         bool with_silu,
+                         std::vector<double>* out,
+                         std::vector<double>* mean,
+                         std::vector<double>* variance) {
+  const auto& dims = x.dims();
+  const int n = dims[0];
+  const int c = dims[1];
+  const int spatial = dims[2] * dims[3];
+  const int group_size = c / groups;
+  const int64_t len = static_cast<int64_t>(group_size) * spatial;
+  const float* in = x.data<float>();
+  out->resize(x.numel());
+  mean->resize(n * groups);
+  variance->resize(n * groups);
+  for (int ng = 0; ng < n * groups; ++ng) {
+    const float* group_in = in + ng * len;
+    double sum = 0.0;
+    for (int64_t i = 0; i < len; ++i) sum += group_in[i];
+    double m = sum / len;
+    double var = 0.0;
+    for (int64_t i = 0; i < len; ++i) {
+      var += (group_in[i] - m) * (group_in[i] - m);
+    }
+    var /= len;
+    (*mean)[ng] = m;
+    (*variance)[ng] = var;
+    for (int64_t i = 0; i < len; ++i) {
+      int ch = (ng % groups) * group_size + i / spatial;
+      double y = (group_in[i] - m) / std::sqrt(var + epsilon);
+      y = y * (scale ? scale[ch] : 1.0) + (bias ? bias[ch] : 0.0);
+      if (with_silu) y = y / (1.0 + std::exp(-y));
+      (*out)[ng * len + i] = y;
+    }
+  }
+}
+
+struct GroupNormCase {
+  std::vector<int64_t> dims;
+  int groups;
+  bool with_affine;
+};
+
+// the spatial sizes cover the avx main loop, its tail, and a single value
+static const std::vector<GroupNormCase> kCases{
+    {{2, 32, 8, 8}, 8, true},
+    {{1, 6, 5, 7}, 3, true},
+    {{3, 4, 3, 3}, 2, false},
+    {{2, 8, 1, 1}, 4, true},
+    {{1, 12, 17, 3}, 12, false},
+};
+
+TEST(group_norm_x86, run_test) {
+  const float epsilon = 1e-5f;
+  for (auto& test_case : kCases) {
+    const DDim dims(test_case.dims);
+    const int c = dims[1];
+    Tensor x, scale, bias, out, saved_mean, saved_variance;
+    x.Resize(dims);
+    scale.Resize({c});
+    bias.Resize({c});
+    out.Resize(dims);
+    saved_mean.Resize({dims[0], test_case.groups});
+    saved_variance.Resize({dims[0], test_case.groups});
+    FillData(&x, 1, 0.5f);
+    FillData(&scale, 2, 1.f);
+    FillData(&bias, 3, 0.f);
+
+    operators::GroupNormParam param;
+    param.x = &x;
+    param.scale = test_case.with_affine ? &scale : nullptr;
+    param.bias = test_case.with_affine ? &bias : nullptr;
+    param.out = &out;
+    param.saved_mean = &saved_mean;
+    param.saved_variance = &saved_variance;
+    param.epsilon = epsilon;
+    param.groups = test_case.groups;
+    param.channels = c;
+
+    GroupNormCompute group_norm;
+    std::unique_ptr<KernelContext> ctx(new KernelContext);
+    ctx->As<X86Context>();
+    group_norm.SetContext(std::move(ctx));
+    group_norm.SetParam(param);
+    group_norm.PrepareForRun();
+    group_norm.Run();
+
+    std::vector<double> ref_out, ref_mean, ref_variance;
+    RefGroupNorm(x,
+                 param.scale ? scale.data<float>() : nullptr,
+                 param.bias ? bias.data<float>() : nullptr,
+                 epsilon,
+                 test_case.groups,
+                 false,
+                 &ref_out,
+                 &ref_mean,
+                 &ref_variance);
+    for (int64_t i = 0; i < out.numel(); ++i) {
+      EXPECT_NEAR(out.data<float>()[i], ref_out[i], 1e-4) << "at " << i;
+    }
+    for (size_t i = 0; i < ref_mean.size(); ++i) {
+      EXPECT_NEAR(saved_mean.data<float>()[i], ref_mean[i], 1e-5);
+      EXPECT_NEAR(saved_variance.data<float>()[i], ref_variance[i], 1e-4);
+    }
+  }
+}
+
+TEST(gn_silu_x86, retrive_op) {
+  auto kernels = KernelRegistry::Global().Create("__xpu__gn_silu");
+  ASSERT_FALSE(kernels.empty());
+  ASSERT_TRUE(kernels.front());
+}
+
+TEST(gn_silu_x86, run_test) {
+  const float epsilon = 1e-5f;
+  for (auto& test_case : kCases) {
+    const DDim dims(test_case.dims);
+    const int c = dims[1];
+    Tensor x, scale, bias, out;
+    x.Resize(dims);
+    scale.Resize({c});
+    bias.Resize({c});
+    out.Resize(dims);
+    FillData(&x, 4, -0.5f);
+    FillData(&scale, 5, 1.f);
+    FillData(&bias, 6, 0.f);
+
+    operators::XPUGnSiluParam param;
+    param.input = &x;
+    if (test_case.with_affine) {
+      param.gn_scale = {&scale};
+      param.gn_bias = {&bias};
+    }
+    param.output = &out;
+    param.groups = test_case.groups;
+    param.epsilon = epsilon;
+
+    GnSiluCompute gn_silu;
+    std::unique_ptr<KernelContext> ctx(new KernelContext);
+    ctx->As<X86Context>();
+    gn_silu.SetContext(std::move(ctx));
+    gn_silu.SetParam(param);
+    gn_silu.PrepareForRun();
+    gn_silu.Run();
+
+    std::vector<double> ref_out, ref_mean, ref_variance;
+    RefGroupNorm(x,
+                 test_case.with_affine ? scale.data<float>() : nullptr,
+                 test_case.with_affine ? bias.data<float>() : nullptr,
+                 epsilon,
+                 test_case.groups,
+                 true,
+                 &ref_out,
+                 &ref_mean,
+                 &ref_variance);
+    for (int64_t i = 0; i < out.numel(); ++i) {
+      EXPECT_NEAR(out.data<float>()[i], ref_out[i], 1e-4) << "at " << i;
+    }
+  }
+}
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_KERNEL(group_norm, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(__xpu__gn_silu, kX86, kFloat, kNCHW, def);
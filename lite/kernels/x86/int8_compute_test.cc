@@ -0,0 +1,274 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "lite/core/op_registry.h"
+#include "lite/operators/op_params.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+// The int8 kernels are compared with the fp32 kernels, which read the
+// dequantized int8 inputs, so the results differ only by the rounding of the
+// fp32 arithmetic, or by one quantization step of the int8 output.
+
+static int8_t QuantizeValue(float value, float scale) {
+  float q = std::round(value / scale);
+  return static_cast<int8_t>(std::min(127.f, std::max(-127.f, q)));
+}
+
+static float MaxAbs(const Tensor& tensor) {
+  const float* data = tensor.data<float>();
+  float max_abs = 0.f;
+  for (int64_t i = 0; i < tensor.numel(); ++i) {
+    max_abs = std::max(max_abs, std::fabs(data[i]));
+  }
+  return max_abs;
+}
+
+// Fills `x_int8` with random values quantized per tensor, and `x_fp32` with
+// the dequantized ones, returns the scale.
+static float FillQuantized(const DDim& dims,
+                           float range,
+                           int seed,
+                           Tensor* x_int8,
+                           Tensor* x_fp32) {
+  std::default_random_engine engine(seed);
+  std::uniform_real_distribution<float> dist(-range, range);
+  x_int8->Resize(dims);
+  x_fp32->Resize(dims);
+  auto* int8_data = x_int8->mutable_data<int8_t>();
+  auto* fp32_data = x_fp32->mutable_data<float>();
+  const float scale = range / 127.f;
+  for (int64_t i = 0; i < dims.production(); ++i) {
+    int8_data[i] = QuantizeValue(dist(engine), scale);
+    fp32_data[i] = int8_data[i] * scale;
+  }
+  return scale;
+}
+
+template <typename ParamT>
+static void RunKernel(const std::string& op_type,
+                      PrecisionType precision,
+                      const std::string& alias,
+                      const ParamT& param) {
+  auto kernels = KernelRegistry::Global().Create(
+      op_type, TARGET(kX86), precision, DATALAYOUT(kNCHW));
+  for (auto& kernel : kernels) {
+    if (kernel->alias() != alias) continue;
+    std::unique_ptr<KernelContext> ctx(new KernelContext);
+    ctx->As<X86Context>();
+    kernel->SetContext(std::move(ctx));
+    kernel->SetParam(param);
+    kernel->Run();
+    return;
+  }
+  LOG(FATAL) << "No " << alias << " kernel of " << op_type;
+}
+
+// Runs the fp32_out and int8_out kernels of `op_type` with `param`, whose
+// output is `*out`, and compares them with the fp32 result `ref`.
+template <typename ParamT>
+static void CheckInt8Kernels(const std::string& op_type,
+                             ParamT* param,
+                             Tensor** out,
+                             const Tensor& ref,
+                             float abs_error) {
+  const float out_scale = std::max(MaxAbs(ref), 1e-3f) / 127.f;
+  param->output_scale = out_scale;
+  Tensor out_fp32, out_int8;
+  out_fp32.Resize(ref.dims());
+  out_int8.Resize(ref.dims());
+  *out = &out_fp32;
+  RunKernel(op_type, PRECISION(kInt8), "fp32_out", *param);
+  *out = &out_int8;
+  RunKernel(op_type, PRECISION(kInt8), "int8_out", *param);
+
+  const float* ref_data = ref.data<float>();
+  const float* fp32_data = out_fp32.data<float>();
+  const int8_t* int8_data = out_int8.data<int8_t>();
+  for (int64_t i = 0; i < ref.numel(); ++i) {
+    EXPECT_NEAR(fp32_data[i], ref_data[i], abs_error) << op_type << " " << i;
+    EXPECT_NEAR(int8_data[i], QuantizeValue(ref_data[i], out_scale), 1)
+        << op_type << " " << i;
+  }
+}
+
+TEST(int8_compute_x86, pool2d) {
+  for (std::string pooling_type : {"max", "avg"}) {
+    for (bool global_pooling : {false, true}) {
+      Tensor x_int8, x_fp32, ref;
+      float x_scale =
+          FillQuantized(DDim({2, 8, 7, 7}), 4.f, 1, &x_int8, &x_fp32);
+      operators::PoolParam param;
+      param.pooling_type = pooling_type;
+      param.global_pooling = global_pooling;
+      param.ksize = {3, 3};
+      param.strides = {2, 2};
+      std::vector<int> paddings{1, 1, 1, 1};
+      if (global_pooling) {
+        param.strides = {1, 1};
+        paddings = {0, 0, 0, 0};
+      }
+      param.paddings = std::make_shared<std::vector<int>>(paddings);
+      param.exclusive = true;
+      ref.Resize(global_pooling ? DDim({2, 8, 1, 1}) : DDim({2, 8, 4, 4}));
+      param.x = &x_fp32;
+      param.output = &ref;
+      RunKernel("pool2d", PRECISION(kFloat), "def", param);
+
+      param.x = &x_int8;
+      param.input_scale = x_scale;
+      CheckInt8Kernels("pool2d", &param, &param.output, ref, 1e-4f);
+    }
+  }
+}
+
+TEST(int8_compute_x86, elementwise) {
+  for (std::string op_type : {"elementwise_add", "elementwise_mul"}) {
+    for (bool broadcast : {false, true}) {
+      Tensor x_int8, x_fp32, y_int8, y_fp32, ref;
+      DDim x_dims({2, 16, 3, 5});
+      DDim y_dims = broadcast ? DDim({16}) : x_dims;
+      float x_scale = FillQuantized(x_dims, 2.f, 1, &x_int8, &x_fp32);
+      float y_scale = FillQuantized(y_dims, 3.f, 2, &y_int8, &y_fp32);
+      operators::ElementwiseParam param;
+      param.axis = broadcast ? 1 : -1;
+      ref.Resize(x_dims);
+      param.X = &x_fp32;
+      param.Y = &y_fp32;
+      param.Out = &ref;
+      RunKernel(op_type, PRECISION(kFloat), "def", param);
+
+      param.X = &x_int8;
+      param.Y = &y_int8;
+      param.x_input_scale = x_scale;
+      param.y_input_scale = y_scale;
+      CheckInt8Kernels(op_type, &param, &param.Out, ref, 1e-4f);
+    }
+  }
+}
+
+TEST(int8_compute_x86, activation) {
+  for (std::string op_type : {"relu", "relu6", "leaky_relu"}) {
+    Tensor x_int8, x_fp32, ref;
+    float x_scale =
+        FillQuantized(DDim({3, 8, 5, 7}), 8.f, 1, &x_int8, &x_fp32);
+    operators::ActivationParam param;
+    if (op_type == "relu") {
+      param.active_type = lite_api::ActivationType::kRelu;
+    } else if (op_type == "relu6") {
+      param.active_type = lite_api::ActivationType::kRelu6;
+      param.threshold = 6.f;
+    } else {
+      param.active_type = lite_api::ActivationType::kLeakyRelu;
+      param.Leaky_relu_alpha = 0.1f;
+    }
+    ref.Resize(x_fp32.dims());
+    param.X = &x_fp32;
+    param.Out = &ref;
+    RunKernel(op_type, PRECISION(kFloat), "def", param);
+
+    param.X = &x_int8;
+    param.input_scale = x_scale;
+    CheckInt8Kernels(op_type, &param, &param.Out, ref, 1e-5f);
+  }
+}
+
+TEST(int8_compute_x86, concat) {
+  // the inputs have different scales, so they are requantized to the output
+  Tensor x0_int8, x0_fp32, x1_int8, x1_fp32, ref;
+  float x0_scale =
+      FillQuantized(DDim({2, 3, 4, 5}), 1.f, 1, &x0_int8, &x0_fp32);
+  float x1_scale =
+      FillQuantized(DDim({2, 6, 4, 5}), 5.f, 2, &x1_int8, &x1_fp32);
+  operators::ConcatParam param;
+  param.axis = 1;
+  ref.Resize(DDim({2, 9, 4, 5}));
+  param.x = {&x0_fp32, &x1_fp32};
+  param.output = &ref;
+  RunKernel("concat", PRECISION(kFloat), "def", param);
+
+  param.x = {&x0_int8, &x1_int8};
+  param.x_input_scales = {x0_scale, x1_scale};
+  CheckInt8Kernels("concat", &param, &param.output, ref, 1e-5f);
+}
+
+TEST(int8_compute_x86, matmul) {
+  // activation x activation as in the attention, with transposed Y
+  for (std::string op_type : {"matmul", "matmul_v2"}) {
+    Tensor x_int8, x_fp32, y_int8, y_fp32, ref;
+    float x_scale =
+        FillQuantized(DDim({2, 3, 7, 16}), 2.f, 1, &x_int8, &x_fp32);
+    float y_scale =
+        FillQuantized(DDim({2, 3, 5, 16}), 2.f, 2, &y_int8, &y_fp32);
+    operators::MatMulParam param;
+    param.transpose_X = false;
+    param.transpose_Y = true;
+    param.alpha = op_type == "matmul" ? 0.25f : 1.f;
+    ref.Resize(DDim({2, 3, 7, 5}));
+    param.X = &x_fp32;
+    param.Y = &y_fp32;
+    param.Out = &ref;
+    RunKernel(op_type, PRECISION(kFloat), "def", param);
+
+    param.X = &x_int8;
+    param.Y = &y_int8;
+    param.input_scale = x_scale;
+    param.weight_scale = {y_scale};
+    CheckInt8Kernels(op_type, &param, &param.Out, ref, 1e-3f);
+  }
+}
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_KERNEL(pool2d, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(pool2d, kX86, kInt8, kNCHW, int8_out);
+USE_LITE_KERNEL(pool2d, kX86, kInt8, kNCHW, fp32_out);
+USE_LITE_KERNEL(elementwise_add, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(elementwise_add, kX86, kInt8, kNCHW, int8_out);
+USE_LITE_KERNEL(elementwise_add, kX86, kInt8, kNCHW, fp32_out);
+USE_LITE_KERNEL(elementwise_mul, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(elementwise_mul, kX86, kInt8, kNCHW, int8_out);
+USE_LITE_KERNEL(elementwise_mul, kX86, kInt8, kNCHW, fp32_out);
+USE_LITE_KERNEL(relu, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(relu, kX86, kInt8, kNCHW, int8_out);
+USE_LITE_KERNEL(relu, kX86, kInt8, kNCHW, fp32_out);
+USE_LITE_KERNEL(relu6, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(relu6, kX86, kInt8, kNCHW, int8_out);
+USE_LITE_KERNEL(relu6, kX86, kInt8, kNCHW, fp32_out);
+USE_LITE_KERNEL(leaky_relu, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(leaky_relu, kX86, kInt8, kNCHW, int8_out);
+USE_LITE_KERNEL(leaky_relu, kX86, kInt8, kNCHW, fp32_out);
+USE_LITE_KERNEL(concat, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(concat, kX86, kInt8, kNCHW, int8_out);
+USE_LITE_KERNEL(concat, kX86, kInt8, kNCHW, fp32_out);
+USE_LITE_KERNEL(matmul, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(matmul, kX86, kInt8, kNCHW, int8_out);
+USE_LITE_KERNEL(matmul, kX86, kInt8, kNCHW, fp32_out);
+USE_LITE_KERNEL(matmul_v2, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(matmul_v2, kX86, kInt8, kNCHW, int8_out);
+USE_LITE_KERNEL(matmul_v2, kX86, kInt8, kNCHW, fp32_out);
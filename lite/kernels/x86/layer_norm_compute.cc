@@ -27,3 +27,20 @@ REGISTER_LITE_KERNEL(layer_norm,
     .BindOutput("Mean", {LiteType::GetTensorTy(TARGET(kX86))})
     .BindOutput("Variance", {LiteType::GetTensorTy(TARGET(kX86))})
     .Finalize();
+
+REGISTER_LITE_KERNEL(layer_norm,
+                     kX86,
+                     kBF16,
+                     kNCHW,
+                     paddle::lite::kernels::x86::LayerNormBF16Compute,
+                     def)
+    .BindInput("X", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kBF16))})
+    .BindInput("Scale",
+               {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kFloat))})
+    .BindInput("Bias", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kFloat))})
+    .BindOutput("Y", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kBF16))})
+    .BindOutput("Mean",
+                {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kFloat))})
+    .BindOutput("Variance",
+                {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kFloat))})
+    .Finalize();
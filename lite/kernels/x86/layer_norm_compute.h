@@ -14,9 +14,14 @@
 
 #pragma once
 
+#include <cmath>
+#include <functional>
+#include <vector>
 #include "lite/backends/x86/jit/helper.h"
 #include "lite/backends/x86/jit/kernel_base.h"
 #include "lite/backends/x86/jit/kernels.h"
+#include "lite/backends/x86/math/gemm_bf16.h"
+#include "lite/backends/x86/parallel.h"
 #include "lite/core/kernel.h"
 #include "lite/core/op_lite.h"
 #include "lite/core/op_registry.h"
@@ -85,6 +90,63 @@ class LayerNormCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
   virtual ~LayerNormCompute() = default;
 };
 
+// X and Y are bf16, Scale, Bias, Mean and Variance are float32. The rows are
+// widened to float32 so the statistics have the same accuracy as the float
+// kernel.
+class LayerNormBF16Compute
+    : public KernelLite<TARGET(kX86), PRECISION(kBF16)> {
+ public:
+  using param_t = operators::LayerNormParam;
+
+  void Run() override {
+    auto &param = *param_.get_mutable<param_t>();
+    float epsilon = param.epsilon;
+    auto matrix_dim = param.X->dims().Flatten2D(param.begin_norm_axis);
+    int left = static_cast<int>(matrix_dim[0]);
+    int right = static_cast<int>(matrix_dim[1]);
+
+    const uint16_t *x = param.X->template data<uint16_t>();
+    uint16_t *y =
+        param.Y->template mutable_data<lite_api::bfloat16, uint16_t>();
+    float *mean = param.Mean->template mutable_data<float>();
+    float *var = param.Variance->template mutable_data<float>();
+    const float *scale =
+        param.Scale ? param.Scale->template data<float>() : nullptr;
+    const float *bias =
+        param.Bias ? param.Bias->template data<float>() : nullptr;
+    CHECK_EQ(param.Mean->numel(), left);
+    CHECK_EQ(param.Variance->numel(), left);
+
+    lite::x86::RunParallelFor(0, left, [&](int64_t begin, int64_t end) {
+      std::vector<float> row(right);
+      for (int64_t i = begin; i < end; ++i) {
+        lite::x86::math::bf16_to_fp32(x + i * right, row.data(), right);
+        float sum = 0.f;
+        for (int j = 0; j < right; ++j) sum += row[j];
+        float m = sum / right;
+        float sq = 0.f;
+        for (int j = 0; j < right; ++j) {
+          row[j] -= m;
+          sq += row[j] * row[j];
+        }
+        float v = sq / right;
+        float inv_std = 1.f / std::sqrt(v + epsilon);
+        for (int j = 0; j < right; ++j) {
+          float val = row[j] * inv_std;
+          if (scale) val *= scale[j];
+          if (bias) val += bias[j];
+          row[j] = val;
+        }
+        lite::x86::math::fp32_to_bf16(row.data(), y + i * right, right);
+        mean[i] = m;
+        var[i] = v;
+      }
+    });
+  }
+
+  virtual ~LayerNormBF16Compute() = default;
+};
+
 }  // namespace x86
 }  // namespace kernels
 }  // namespace lite
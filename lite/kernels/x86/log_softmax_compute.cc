@@ -0,0 +1,53 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/kernels/x86/log_softmax_compute.h"
+#include "lite/backends/x86/math/softmax.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+void LogSoftmaxCompute::Run() {
+  auto& param = this->Param<param_t>();
+  const auto& x_dims = param.x->dims();
+  const int rank = x_dims.size();
+  auto* out_data = param.output->mutable_data<float>();
+  if (rank == 0) {
+    out_data[0] = 0.f;
+    return;
+  }
+  const int axis = param.axis < 0 ? param.axis + rank : param.axis;
+  lite::x86::math::log_softmax_fp32(param.x->data<float>(),
+                                    out_data,
+                                    x_dims.Slice(0, axis).production(),
+                                    x_dims[axis],
+                                    x_dims.Slice(axis + 1, rank).production());
+}
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_LITE_KERNEL(log_softmax,
+                     kX86,
+                     kFloat,
+                     kNCHW,
+                     paddle::lite::kernels::x86::LogSoftmaxCompute,
+                     def)
+    .BindInput("X", {LiteType::GetTensorTy(TARGET(kX86))})
+    .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86))})
+    .Finalize();
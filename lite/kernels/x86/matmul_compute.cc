@@ -13,6 +13,186 @@
 // limitations under the License.
 
 #include "lite/kernels/x86/matmul_compute.h"
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+#include "lite/backends/x86/math/gemm_bf16.h"
+#include "lite/backends/x86/math/int8_compute.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+void MatMulBF16Compute::PackY(Tensor *packed) {
+  auto &param = this->Param<operators::MatMulParam>();
+  auto y_dims = ColumnMatrixFromVector(param.Y->dims());
+  const int y_rank = y_dims.size();
+  const bool trans_y = param.transpose_Y;
+  const int k = trans_y ? y_dims[y_rank - 1] : y_dims[y_rank - 2];
+  const int n = trans_y ? y_dims[y_rank - 2] : y_dims[y_rank - 1];
+  const int64_t batch_y = y_dims.count(0, y_rank - 2);
+  const int64_t packed_size = lite::x86::math::gemm_bf16_packed_b_size(k, n);
+  packed->Resize({batch_y * packed_size});
+  packed->set_precision(PRECISION(kInt16));
+  auto *packed_y =
+      reinterpret_cast<uint16_t *>(packed->mutable_data<int16_t>());
+  // Y is fp32 if it is a weight which is not converted by the predictor.
+  const bool y_is_fp32 = param.Y->precision() == PRECISION(kFloat);
+  for (int64_t b = 0; b < batch_y; ++b) {
+    if (y_is_fp32) {
+      lite::x86::math::gemm_bf16_pack_b(trans_y,
+                                        k,
+                                        n,
+                                        param.Y->data<float>() + b * k * n,
+                                        trans_y ? k : n,
+                                        packed_y + b * packed_size);
+    } else {
+      lite::x86::math::gemm_bf16_pack_b(trans_y,
+                                        k,
+                                        n,
+                                        param.Y->data<uint16_t>() + b * k * n,
+                                        trans_y ? k : n,
+                                        packed_y + b * packed_size);
+    }
+  }
+}
+
+void MatMulBF16Compute::PrepareForRun() {
+  auto &param = this->Param<operators::MatMulParam>();
+  if (this->packed_weights_ != nullptr) {
+    packed_y_.ShareDataWith(*this->packed_weights_);
+    y_is_packed_ = true;
+    return;
+  }
+  // A weight never changes, so it is packed once instead of on every run.
+  if (param.Y->persistable()) {
+    PackY(&packed_y_);
+    y_is_packed_ = true;
+  }
+}
+
+bool MatMulBF16Compute::PackWeights(Tensor *packed, std::string *weight_arg) {
+  auto &param = this->Param<operators::MatMulParam>();
+  if (param.Y == nullptr || !param.Y->persistable() ||
+      !param.Y->IsInitialized()) {
+    return false;
+  }
+  PackY(packed);
+  *weight_arg = "Y";
+  return true;
+}
+
+void MatMulBF16Compute::Run() {
+  auto &param = this->Param<operators::MatMulParam>();
+  auto x_dims = RowMatrixFromVector(param.X->dims());
+  auto y_dims = ColumnMatrixFromVector(param.Y->dims());
+  const int x_rank = x_dims.size();
+  const int y_rank = y_dims.size();
+  const bool trans_x = param.transpose_X;
+  const bool trans_y = param.transpose_Y;
+  const int m = trans_x ? x_dims[x_rank - 1] : x_dims[x_rank - 2];
+  const int k = trans_x ? x_dims[x_rank - 2] : x_dims[x_rank - 1];
+  const int n = trans_y ? y_dims[y_rank - 2] : y_dims[y_rank - 1];
+  CHECK_EQ(k, trans_y ? y_dims[y_rank - 1] : y_dims[y_rank - 2])
+      << "the reduce dims of X and Y are not equal.";
+  const int64_t batch_x = x_dims.count(0, x_rank - 2);
+  const int64_t batch_y = y_dims.count(0, y_rank - 2);
+  CHECK(batch_x == batch_y || batch_x == 1 || batch_y == 1)
+      << "batch size of X " << batch_x << " and Y " << batch_y
+      << " can not be broadcasted.";
+  const int64_t batch = std::max(batch_x, batch_y);
+
+  const uint16_t *x_data = param.X->data<uint16_t>();
+  uint16_t *out_data =
+      param.Out->mutable_data<lite_api::bfloat16, uint16_t>();
+
+  // gemm_bf16_packed reads A by rows, so a transposed X is copied first.
+  std::vector<uint16_t> x_trans;
+  if (trans_x) {
+    x_trans.resize(static_cast<size_t>(batch_x) * m * k);
+    for (int64_t b = 0; b < batch_x; ++b) {
+      const uint16_t *src = x_data + b * m * k;
+      uint16_t *dst = x_trans.data() + b * m * k;
+      for (int i = 0; i < k; ++i) {
+        for (int j = 0; j < m; ++j) {
+          dst[j * k + i] = src[i * m + j];
+        }
+      }
+    }
+    x_data = x_trans.data();
+  }
+
+  if (!y_is_packed_) PackY(&packed_y_);
+  const int64_t packed_size = lite::x86::math::gemm_bf16_packed_b_size(k, n);
+  CHECK_EQ(packed_y_.numel(), batch_y * packed_size)
+      << "The packed Y does not match the dims " << param.Y->dims();
+  const uint16_t *packed_y = packed_y_.data<uint16_t>();
+
+  lite::x86::math::GemmBF16Epilogue epilogue;
+  epilogue.alpha = param.alpha;
+  for (int64_t b = 0; b < batch; ++b) {
+    const uint16_t *a = x_data + (batch_x == 1 ? 0 : b) * m * k;
+    const uint16_t *packed_b = packed_y + (batch_y == 1 ? 0 : b) * packed_size;
+    lite::x86::math::gemm_bf16_packed<uint16_t>(
+        m, n, k, a, k, packed_b, out_data + b * m * n, n, epilogue);
+  }
+}
+
+template <PrecisionType OutType>
+void MatMulInt8Compute<OutType>::Run() {
+  using out_t = typename std::
+      conditional<OutType == PRECISION(kInt8), int8_t, float>::type;
+  auto &param = this->template Param<operators::MatMulParam>();
+  auto x_dims = RowMatrixFromVector(param.X->dims());
+  auto y_dims = ColumnMatrixFromVector(param.Y->dims());
+  const int x_rank = x_dims.size();
+  const int y_rank = y_dims.size();
+  const bool trans_x = param.transpose_X;
+  const bool trans_y = param.transpose_Y;
+  const int m = trans_x ? x_dims[x_rank - 1] : x_dims[x_rank - 2];
+  const int k = trans_x ? x_dims[x_rank - 2] : x_dims[x_rank - 1];
+  const int n = trans_y ? y_dims[y_rank - 2] : y_dims[y_rank - 1];
+  CHECK_EQ(k, trans_y ? y_dims[y_rank - 1] : y_dims[y_rank - 2])
+      << "the reduce dims of X and Y are not equal.";
+  const int64_t batch_x = x_dims.count(0, x_rank - 2);
+  const int64_t batch_y = y_dims.count(0, y_rank - 2);
+  CHECK(batch_x == batch_y || batch_x == 1 || batch_y == 1)
+      << "batch size of X " << batch_x << " and Y " << batch_y
+      << " can not be broadcasted.";
+  const int64_t batch = std::max(batch_x, batch_y);
+  CHECK(!param.weight_scale.empty()) << "the scale of Y is not set.";
+  const bool y_per_col = param.weight_scale.size() > 1;
+  if (y_per_col) {
+    CHECK_EQ(param.weight_scale.size(), static_cast<size_t>(n));
+  }
+
+  const int8_t *x_data = param.X->template data<int8_t>();
+  const int8_t *y_data = param.Y->template data<int8_t>();
+  out_t *out_data = param.Out->template mutable_data<out_t>();
+  for (int64_t b = 0; b < batch; ++b) {
+    lite::x86::math::int8_matmul(x_data + (batch_x == 1 ? 0 : b) * m * k,
+                                 y_data + (batch_y == 1 ? 0 : b) * k * n,
+                                 out_data + b * m * n,
+                                 m,
+                                 n,
+                                 k,
+                                 trans_x,
+                                 trans_y,
+                                 param.input_scale * param.alpha,
+                                 param.weight_scale.data(),
+                                 y_per_col,
+                                 param.output_scale);
+  }
+}
+
+template class MatMulInt8Compute<PRECISION(kInt8)>;
+template class MatMulInt8Compute<PRECISION(kFloat)>;
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
 
 REGISTER_LITE_KERNEL(matmul,
                      kX86,
@@ -24,3 +204,38 @@ REGISTER_LITE_KERNEL(matmul,
     .BindInput("Y", {LiteType::GetTensorTy(TARGET(kX86))})
     .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86))})
     .Finalize();
+
+REGISTER_LITE_KERNEL(matmul,
+                     kX86,
+                     kBF16,
+                     kNCHW,
+                     paddle::lite::kernels::x86::MatMulBF16Compute,
+                     def)
+    .BindInput("X", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kBF16))})
+    .BindInput("Y", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kBF16))})
+    .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kBF16))})
+    .Finalize();
+
+REGISTER_LITE_KERNEL(
+    matmul,
+    kX86,
+    kInt8,
+    kNCHW,
+    paddle::lite::kernels::x86::MatMulInt8Compute<PRECISION(kInt8)>,
+    int8_out)
+    .BindInput("X", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .BindInput("Y", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .Finalize();
+
+REGISTER_LITE_KERNEL(
+    matmul,
+    kX86,
+    kInt8,
+    kNCHW,
+    paddle::lite::kernels::x86::MatMulInt8Compute<PRECISION(kFloat)>,
+    fp32_out)
+    .BindInput("X", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .BindInput("Y", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kFloat))})
+    .Finalize();
@@ -13,6 +13,7 @@
 // limitations under the License.
 #pragma once
 
+#include <string>
 #include "lite/backends/x86/math/blas.h"
 #include "lite/core/kernel.h"
 #include "lite/core/op_registry.h"
@@ -70,6 +71,52 @@ class MatMulCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
   virtual ~MatMulCompute() = default;
 };
 
+/**
+ * bf16 kernel of matmul and matmul_v2, the product is accumulated in float32
+ * by lite::x86::math::gemm_bf16_packed. The batch dims of X and Y must be
+ * equal, or one of them is 1.
+ */
+class MatMulBF16Compute : public KernelLite<TARGET(kX86), PRECISION(kBF16)> {
+ public:
+  using param_t = operators::MatMulParam;
+
+  void PrepareForRun() override;
+
+  void Run() override;
+
+  // A weight Y is packed offline, so the predictor releases the raw one.
+  bool PackWeights(Tensor* packed, std::string* weight_arg) override;
+
+  std::string PackedWeightsTag() const override { return "x86_gemm_bf16"; }
+
+  virtual ~MatMulBF16Compute() = default;
+
+ private:
+  // Pack every batch of Y into `packed` for gemm_bf16_packed, as int16 so
+  // that the opt tool saves it as is.
+  void PackY(Tensor* packed);
+
+  Tensor packed_y_;
+  // Y is a weight packed once by PrepareForRun.
+  bool y_is_packed_{false};
+};
+
+/**
+ * int8 kernel of matmul and matmul_v2 with a per tensor scale of X, and a
+ * per tensor or per column scale of Y, so both activation x activation
+ * (attention) and activation x weight products stay in int8. The product is
+ * accumulated in int32 by lite::x86::math::int8_matmul.
+ */
+template <PrecisionType OutType>
+class MatMulInt8Compute : public KernelLite<TARGET(kX86), PRECISION(kInt8)> {
+ public:
+  using param_t = operators::MatMulParam;
+
+  void Run() override;
+
+  virtual ~MatMulInt8Compute() = default;
+};
+
 }  // namespace x86
 }  // namespace kernels
 }  // namespace lite
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "lite/kernels/x86/matmul_v2_compute.h"
+#include "lite/kernels/x86/matmul_compute.h"
 
 REGISTER_LITE_KERNEL(matmul_v2,
                      kX86,
@@ -24,3 +25,38 @@ REGISTER_LITE_KERNEL(matmul_v2,
     .BindInput("Y", {LiteType::GetTensorTy(TARGET(kX86))})
     .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86))})
     .Finalize();
+
+REGISTER_LITE_KERNEL(matmul_v2,
+                     kX86,
+                     kBF16,
+                     kNCHW,
+                     paddle::lite::kernels::x86::MatMulBF16Compute,
+                     def)
+    .BindInput("X", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kBF16))})
+    .BindInput("Y", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kBF16))})
+    .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kBF16))})
+    .Finalize();
+
+REGISTER_LITE_KERNEL(
+    matmul_v2,
+    kX86,
+    kInt8,
+    kNCHW,
+    paddle::lite::kernels::x86::MatMulInt8Compute<PRECISION(kInt8)>,
+    int8_out)
+    .BindInput("X", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .BindInput("Y", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .Finalize();
+
+REGISTER_LITE_KERNEL(
+    matmul_v2,
+    kX86,
+    kInt8,
+    kNCHW,
+    paddle::lite::kernels::x86::MatMulInt8Compute<PRECISION(kFloat)>,
+    fp32_out)
+    .BindInput("X", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .BindInput("Y", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kFloat))})
+    .Finalize();
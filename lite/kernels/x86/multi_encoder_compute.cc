@@ -0,0 +1,331 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/kernels/x86/multi_encoder_compute.h"
+#include <cmath>
+#include <cstring>
+#include "lite/backends/x86/math/blas.h"
+#include "lite/backends/x86/parallel.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+namespace {
+// x[i, j] = act(x[i, j] + bias[j]) for the m rows of n columns
+template <typename ActFunc>
+void BiasAct(float* x, int m, int n, const float* bias, ActFunc act) {
+  lite::x86::RunParallelFor(0, m, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      float* row = x + i * n;
+      for (int j = 0; j < n; ++j) {
+        row[j] = act(row[j] + bias[j]);
+      }
+    }
+  });
+}
+
+// x += bias if bias is not null, then out = layer_norm(x), out may be x.
+void BiasLayerNorm(float* x,
+                   float* out,
+                   int m,
+                   int n,
+                   const float* bias,
+                   const float* scale,
+                   const float* shift,
+                   float epsilon) {
+  lite::x86::RunParallelFor(0, m, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      float* row = x + i * n;
+      float* out_row = out + i * n;
+      float sum = 0.f;
+      for (int j = 0; j < n; ++j) {
+        if (bias) row[j] += bias[j];
+        sum += row[j];
+      }
+      const float mean = sum / n;
+      float var = 0.f;
+      for (int j = 0; j < n; ++j) {
+        const float d = row[j] - mean;
+        var += d * d;
+      }
+      const float rstd = 1.f / std::sqrt(var / n + epsilon);
+      for (int j = 0; j < n; ++j) {
+        out_row[j] = (row[j] - mean) * rstd * scale[j] + shift[j];
+      }
+    }
+  });
+}
+}  // namespace
+
+void MultiEncoderCompute::PrepareForRun() {
+  auto& param = this->Param<param_t>();
+  CHECK_EQ(param.precision, "int31")
+      << "x86 __xpu__multi_encoder only supports the fp32 weights.";
+  CHECK(!param.already_qkv_fusion && param.relative_type == 0 &&
+        !param.is_smooth_quant)
+      << "x86 __xpu__multi_encoder doesn't support the pre-fused qkv, the "
+         "relative embedding or the smooth quant encoder.";
+  CHECK_EQ(param.fc_weight.size() % 6, 0UL);
+  CHECK_EQ(param.fc_bias.size(), param.fc_weight.size());
+  n_layers_ = param.fc_weight.size() / 6;
+  CHECK_EQ(param.ln_scale.size(), 2UL * n_layers_);
+  CHECK_EQ(param.ln_bias.size(), 2UL * n_layers_);
+  heads_ = param.head_num;
+  head_dim_ = param.size_per_head;
+  hidden_ = heads_ * head_dim_;
+  CHECK_EQ(hidden_, param.hidden_dim);
+
+  fc_weight_.clear();
+  fc_n_.clear();
+  fc_k_.clear();
+  fc_bias_.clear();
+  for (size_t i = 0; i < param.fc_weight.size(); ++i) {
+    const auto& dims = param.fc_weight[i]->dims();
+    CHECK_EQ(dims.size(), 2UL);
+    fc_weight_.push_back(param.fc_weight[i]->data<float>());
+    fc_n_.push_back(dims[0]);
+    fc_k_.push_back(dims[1]);
+    fc_bias_.push_back(param.fc_bias[i]->data<float>());
+  }
+  ffn_hidden_ = fc_n_[4];
+  for (int l = 0; l < n_layers_; ++l) {
+    // k and v are fused into the weight of q
+    const int fc = 6 * l;
+    CHECK_EQ(fc_n_[fc], 3 * hidden_);
+    CHECK_EQ(fc_k_[fc], hidden_);
+    CHECK_EQ(param.fc_bias[fc]->numel(), 3 * hidden_);
+    CHECK_EQ(fc_n_[fc + 3], hidden_);
+    CHECK_EQ(fc_k_[fc + 3], hidden_);
+    CHECK_EQ(fc_n_[fc + 4], ffn_hidden_);
+    CHECK_EQ(fc_k_[fc + 4], hidden_);
+    CHECK_EQ(fc_n_[fc + 5], hidden_);
+    CHECK_EQ(fc_k_[fc + 5], ffn_hidden_);
+  }
+
+  if (param.act_type == "gelu") {
+    act_ = Act::kGelu;
+  } else if (param.act_type == "__xpu__quick_gelu") {
+    act_ = Act::kQuickGelu;
+  } else if (param.act_type == "relu") {
+    act_ = Act::kRelu;
+  } else {
+    LOG(FATAL) << "Invalid encoder activation type: " << param.act_type;
+  }
+  slice_first_token_ =
+      (param.slice_starts.size() > 0 && param.slice_starts[0] == 0) &&
+      (param.slice_ends.size() > 0 && param.slice_ends[0] == 1) &&
+      (param.slice_axes.size() > 0 && param.slice_axes[0] == 1);
+}
+
+void MultiEncoderCompute::ReInitWhenNeeded() {
+  auto& param = this->Param<param_t>();
+  const auto& input_dims = param.input->dims();
+  DDim mask_dims = param.mask ? param.mask->dims() : DDim();
+  if (last_shape_ == input_dims && last_mask_shape_ == mask_dims) {
+    return;
+  }
+  last_shape_ = input_dims;
+  last_mask_shape_ = mask_dims;
+  CHECK_EQ(input_dims.size(), 3UL);
+  CHECK_EQ(input_dims[2], hidden_);
+  batch_ = input_dims[0];
+  seq_len_ = input_dims[1];
+
+  // broadcast the mask to the scores of [batch, heads, seq_len, seq_len]
+  mask_ = lite::x86::math::AttentionMask();
+  if (!param.mask) return;
+  const int64_t scores_dims[4] = {batch_, heads_, seq_len_, seq_len_};
+  const int mask_rank = mask_dims.size();
+  CHECK_LE(mask_rank, 4);
+  int64_t stride = 1;
+  for (int i = 3; i >= 0; --i) {
+    const int mi = i - (4 - mask_rank);
+    const int64_t dim = mi >= 0 ? mask_dims[mi] : 1;
+    CHECK(dim == 1 || dim == scores_dims[i])
+        << "The mask of the encoder can't be broadcast to the scores, "
+        << mask_dims << " vs " << DDim(std::vector<int64_t>(scores_dims,
+                                                            scores_dims + 4));
+    mask_.stride[i] = dim == 1 ? 0 : stride;
+    stride *= dim;
+  }
+}
+
+void MultiEncoderCompute::FC(
+    const float* x, int m, int fc_idx, float beta, float* out) {
+  auto& ctx = this->ctx_->template As<X86Context>();
+  auto blas = lite::x86::math::GetBlas<lite::TargetType::kX86, float>(ctx);
+  const int n = fc_n_[fc_idx];
+  const int k = fc_k_[fc_idx];
+  blas.GEMM(false,
+            true,
+            m,
+            n,
+            k,
+            1.f,
+            x,
+            k,
+            fc_weight_[fc_idx],
+            k,
+            beta,
+            out,
+            n);
+}
+
+void MultiEncoderCompute::Run() {
+  auto& param = this->Param<param_t>();
+  auto& ctx = this->ctx_->template As<X86Context>();
+  CHECK(!param.SeqLod || !param.SeqLod->data<int>())
+      << "x86 __xpu__multi_encoder doesn't support the adaptive seqlen.";
+  ReInitWhenNeeded();
+
+  // the workspace holds the hidden state if only the first tokens are
+  // written to the output, the qkv, the attention output [batch, heads,
+  // seq_len, head_dim], the attention output (or the normalized input) of
+  // [batch, seq_len, hidden], and the ffn hidden state
+  const int m = batch_ * seq_len_;
+  const int qkv_n = 3 * hidden_;
+  const int64_t state_size =
+      slice_first_token_ ? static_cast<int64_t>(m) * hidden_ : 0;
+  workspace_.Resize({state_size + static_cast<int64_t>(m) * qkv_n +
+                     2LL * m * hidden_ +
+                     static_cast<int64_t>(m) * ffn_hidden_});
+  float* ws = workspace_.mutable_data<float>();
+  float* out = param.output->mutable_data<float>();
+  float* h = slice_first_token_ ? ws : out;
+  float* qkv = ws + state_size;
+  float* attn = qkv + static_cast<int64_t>(m) * qkv_n;
+  float* buf = attn + static_cast<int64_t>(m) * hidden_;
+  float* ffn = buf + static_cast<int64_t>(m) * hidden_;
+  std::memcpy(h, param.input->data<float>(), sizeof(float) * m * hidden_);
+
+  mask_.data = param.mask ? param.mask->data<float>() : nullptr;
+  const float alpha = 1.f / std::sqrt(static_cast<float>(head_dim_));
+  const float epsilon = param.epsilon;
+  auto identity = [](float x) { return x; };
+  for (int l = 0; l < n_layers_; ++l) {
+    const int fc = 6 * l;
+    const float* ln0_scale = param.ln_scale[2 * l]->data<float>();
+    const float* ln0_bias = param.ln_bias[2 * l]->data<float>();
+    const float* ln1_scale = param.ln_scale[2 * l + 1]->data<float>();
+    const float* ln1_bias = param.ln_bias[2 * l + 1]->data<float>();
+
+    // attention, the output fc accumulates onto the residual h
+    const float* x = h;
+    if (param.norm_before) {
+      BiasLayerNorm(
+          h, buf, m, hidden_, nullptr, ln0_scale, ln0_bias, epsilon);
+      x = buf;
+    }
+    FC(x, m, fc, 0.f, qkv);
+    BiasAct(qkv, m, qkv_n, fc_bias_[fc], identity);
+    lite::x86::math::flash_attention_fp32(ctx,
+                                          qkv,
+                                          qkv + hidden_,
+                                          qkv + 2 * hidden_,
+                                          qkv_n,
+                                          attn,
+                                          batch_,
+                                          heads_,
+                                          seq_len_,
+                                          head_dim_,
+                                          alpha,
+                                          mask_);
+    // [batch, heads, seq_len, head_dim] -> [batch, seq_len, heads, head_dim]
+    lite::x86::RunParallelFor(
+        0, batch_ * heads_, [&](int64_t begin, int64_t end) {
+          for (int64_t bh = begin; bh < end; ++bh) {
+            const int64_t b = bh / heads_;
+            const int64_t hd = bh % heads_;
+            for (int i = 0; i < seq_len_; ++i) {
+              std::memcpy(
+                  buf + ((b * seq_len_ + i) * heads_ + hd) * head_dim_,
+                  attn + (bh * seq_len_ + i) * head_dim_,
+                  sizeof(float) * head_dim_);
+            }
+          }
+        });
+    FC(buf, m, fc + 3, 1.f, h);
+    if (param.norm_before) {
+      BiasAct(h, m, hidden_, fc_bias_[fc + 3], identity);
+      BiasLayerNorm(
+          h, buf, m, hidden_, nullptr, ln1_scale, ln1_bias, epsilon);
+      x = buf;
+    } else {
+      BiasLayerNorm(
+          h, h, m, hidden_, fc_bias_[fc + 3], ln0_scale, ln0_bias, epsilon);
+      x = h;
+    }
+
+    // ffn, the second fc accumulates onto the residual h as well
+    FC(x, m, fc + 4, 0.f, ffn);
+    switch (act_) {
+      case Act::kRelu:
+        BiasAct(ffn, m, ffn_hidden_, fc_bias_[fc + 4], [](float v) {
+          return v > 0.f ? v : 0.f;
+        });
+        break;
+      case Act::kGelu:
+        BiasAct(ffn, m, ffn_hidden_, fc_bias_[fc + 4], [](float v) {
+          return 0.5f * v * (1.f + std::erf(v * 0.70710678f));
+        });
+        break;
+      case Act::kQuickGelu:
+        BiasAct(ffn, m, ffn_hidden_, fc_bias_[fc + 4], [](float v) {
+          return v / (1.f + std::exp(-1.702f * v));
+        });
+        break;
+    }
+    FC(ffn, m, fc + 5, 1.f, h);
+    if (param.norm_before) {
+      BiasAct(h, m, hidden_, fc_bias_[fc + 5], identity);
+    } else {
+      BiasLayerNorm(
+          h, h, m, hidden_, fc_bias_[fc + 5], ln1_scale, ln1_bias, epsilon);
+    }
+  }
+
+  if (slice_first_token_) {
+    for (int b = 0; b < batch_; ++b) {
+      std::memcpy(out + static_cast<int64_t>(b) * hidden_,
+                  h + static_cast<int64_t>(b) * seq_len_ * hidden_,
+                  sizeof(float) * hidden_);
+    }
+  }
+}
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_LITE_KERNEL(__xpu__multi_encoder,
+                     kX86,
+                     kFloat,
+                     kNCHW,
+                     paddle::lite::kernels::x86::MultiEncoderCompute,
+                     def)
+    .BindInput("Input", {LiteType::GetTensorTy(TARGET(kX86))})
+    .BindInput("SeqLod",
+               {LiteType::GetTensorTy(TARGET(kHost), PRECISION(kInt32))})
+    .BindInput("PadSeqLen",
+               {LiteType::GetTensorTy(TARGET(kHost), PRECISION(kInt32))})
+    .BindInput("FCWeight", {LiteType::GetTensorTy(TARGET(kX86))})
+    .BindInput("FCBias", {LiteType::GetTensorTy(TARGET(kX86))})
+    .BindInput("LNScale", {LiteType::GetTensorTy(TARGET(kX86))})
+    .BindInput("LNBias", {LiteType::GetTensorTy(TARGET(kX86))})
+    .BindInput("Mask", {LiteType::GetTensorTy(TARGET(kX86))})
+    .BindOutput("Output", {LiteType::GetTensorTy(TARGET(kX86))})
+    .Finalize();
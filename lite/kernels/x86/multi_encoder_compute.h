@@ -0,0 +1,76 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <string>
+#include <vector>
+#include "lite/backends/x86/math/attention.h"
+#include "lite/core/kernel.h"
+#include "lite/core/op_registry.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+// __xpu__multi_encoder on x86, produced by x86_multi_encoder_fuse_pass.
+// Every layer runs the fused qkv fc, the tiled attention, the output fc with
+// the residual accumulated by the gemm, and the ffn with the bias and the
+// activation applied in one pass, followed by layer_norm (post-norm), or
+// preceded by it (pre-norm). The fc weights are fp32 [n, k] as prepared by
+// the pass, and all the activations of a run share one workspace.
+class MultiEncoderCompute
+    : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
+ public:
+  using param_t = operators::XPUMultiEncoderParam;
+
+  void PrepareForRun() override;
+
+  void Run() override;
+
+  virtual ~MultiEncoderCompute() = default;
+
+ private:
+  void ReInitWhenNeeded();
+  // out[m, n] = x[m, k] * fc_weight[fc_idx]^T + beta * out[m, n]
+  void FC(const float* x, int m, int fc_idx, float beta, float* out);
+
+  enum class Act { kRelu, kGelu, kQuickGelu };
+
+  int n_layers_{0};
+  int hidden_{0};
+  int heads_{0};
+  int head_dim_{0};
+  int ffn_hidden_{0};
+  Act act_{Act::kGelu};
+  // the fc weights and biases of a layer are q(kv), k, v, out, ffn0, ffn1
+  std::vector<const float*> fc_weight_;
+  std::vector<int> fc_n_;
+  std::vector<int> fc_k_;
+  std::vector<const float*> fc_bias_;
+  // the output is the first token of each sequence
+  bool slice_first_token_{false};
+
+  DDim last_shape_;
+  DDim last_mask_shape_;
+  int batch_{0};
+  int seq_len_{0};
+  lite::x86::math::AttentionMask mask_;
+  Tensor workspace_;
+};
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
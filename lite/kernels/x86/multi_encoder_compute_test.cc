@@ -0,0 +1,254 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "lite/core/op_registry.h"
+#include "lite/kernels/x86/multi_encoder_compute.h"
+#include "lite/tests/utils/fill_data.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+// out[m, n] = x[m, k] * w[n, k]^T + bias[n]
+static std::vector<double> fc_ref(const std::vector<double>& x,
+                                  const lite::Tensor& w,
+                                  const lite::Tensor& bias,
+                                  int m) {
+  const int n = w.dims()[0], k = w.dims()[1];
+  const float* w_data = w.data<float>();
+  std::vector<double> out(m * n);
+  for (int i = 0; i < m; ++i) {
+    for (int j = 0; j < n; ++j) {
+      double sum = bias.data<float>()[j];
+      for (int l = 0; l < k; ++l) {
+        sum += x[i * k + l] * w_data[j * k + l];
+      }
+      out[i * n + j] = sum;
+    }
+  }
+  return out;
+}
+
+static std::vector<double> layer_norm_ref(const std::vector<double>& x,
+                                          const lite::Tensor& scale,
+                                          const lite::Tensor& bias,
+                                          int n) {
+  std::vector<double> out(x.size());
+  for (size_t i = 0; i < x.size() / n; ++i) {
+    double mean = 0., var = 0.;
+    for (int j = 0; j < n; ++j) mean += x[i * n + j];
+    mean /= n;
+    for (int j = 0; j < n; ++j) {
+      var += (x[i * n + j] - mean) * (x[i * n + j] - mean);
+    }
+    const double rstd = 1. / std::sqrt(var / n + 1e-5);
+    for (int j = 0; j < n; ++j) {
+      out[i * n + j] = (x[i * n + j] - mean) * rstd * scale.data<float>()[j] +
+                       bias.data<float>()[j];
+    }
+  }
+  return out;
+}
+
+// qkv [m, 3 * hidden] -> attention output [m, hidden], mask is [batch, seq]
+static std::vector<double> attention_ref(const std::vector<double>& qkv,
+                                         const std::vector<float>& mask,
+                                         int batch,
+                                         int seq_len,
+                                         int heads,
+                                         int head_dim) {
+  const int hidden = heads * head_dim, n = 3 * hidden;
+  const double scale = 1. / std::sqrt(static_cast<double>(head_dim));
+  std::vector<double> out(batch * seq_len * hidden);
+  std::vector<double> p(seq_len);
+  for (int b = 0; b < batch; ++b) {
+    for (int h = 0; h < heads; ++h) {
+      for (int i = 0; i < seq_len; ++i) {
+        const double* q = &qkv[(b * seq_len + i) * n + h * head_dim];
+        double max_val = -1e30;
+        for (int j = 0; j < seq_len; ++j) {
+          const double* k = &qkv[(b * seq_len + j) * n + hidden + h * head_dim];
+          double dot = 0.;
+          for (int d = 0; d < head_dim; ++d) dot += q[d] * k[d];
+          p[j] = dot * scale + mask[b * seq_len + j];
+          max_val = std::max(max_val, p[j]);
+        }
+        double sum = 0.;
+        for (int j = 0; j < seq_len; ++j) {
+          p[j] = std::exp(p[j] - max_val);
+          sum += p[j];
+        }
+        for (int d = 0; d < head_dim; ++d) {
+          double acc = 0.;
+          for (int j = 0; j < seq_len; ++j) {
+            acc += p[j] / sum *
+                   qkv[(b * seq_len + j) * n + 2 * hidden + h * head_dim + d];
+          }
+          out[(b * seq_len + i) * hidden + h * head_dim + d] = acc;
+        }
+      }
+    }
+  }
+  return out;
+}
+
+static void encoder_ref(const operators::XPUMultiEncoderParam& param,
+                        const std::vector<float>& mask,
+                        int batch,
+                        int seq_len,
+                        std::vector<double>* out) {
+  const int hidden = param.hidden_dim;
+  const int m = batch * seq_len;
+  std::vector<double> h(param.input->data<float>(),
+                        param.input->data<float>() + m * hidden);
+  auto add = [](std::vector<double>* x, const std::vector<double>& y) {
+    for (size_t i = 0; i < x->size(); ++i) (*x)[i] += y[i];
+  };
+  for (size_t l = 0; l < param.fc_weight.size() / 6; ++l) {
+    const auto& w = param.fc_weight;
+    const auto& b = param.fc_bias;
+    const auto& ln0_s = *param.ln_scale[2 * l];
+    const auto& ln0_b = *param.ln_bias[2 * l];
+    const auto& ln1_s = *param.ln_scale[2 * l + 1];
+    const auto& ln1_b = *param.ln_bias[2 * l + 1];
+    auto x = param.norm_before ? layer_norm_ref(h, ln0_s, ln0_b, hidden) : h;
+    auto qkv = fc_ref(x, *w[6 * l], *b[6 * l], m);
+    auto attn = attention_ref(qkv,
+                              mask,
+                              batch,
+                              seq_len,
+                              param.head_num,
+                              param.size_per_head);
+    add(&h, fc_ref(attn, *w[6 * l + 3], *b[6 * l + 3], m));
+    if (param.norm_before) {
+      x = layer_norm_ref(h, ln1_s, ln1_b, hidden);
+    } else {
+      h = layer_norm_ref(h, ln0_s, ln0_b, hidden);
+      x = h;
+    }
+    auto ffn = fc_ref(x, *w[6 * l + 4], *b[6 * l + 4], m);
+    for (auto& v : ffn) v = 0.5 * v * (1. + std::erf(v / std::sqrt(2.)));
+    add(&h, fc_ref(ffn, *w[6 * l + 5], *b[6 * l + 5], m));
+    if (!param.norm_before) h = layer_norm_ref(h, ln1_s, ln1_b, hidden);
+  }
+  *out = h;
+}
+
+static void test_multi_encoder(bool norm_before, bool slice_first_token) {
+  const int batch = 2, seq_len = 70, heads = 2, head_dim = 16, layers = 2;
+  const int hidden = heads * head_dim, ffn_hidden = 4 * hidden;
+  // the weights of a layer are qkv, (k), (v), out, ffn0, ffn1 as [n, k]
+  const int fc_n[6] = {3 * hidden, hidden, hidden, hidden, ffn_hidden, hidden};
+  const int fc_k[6] = {hidden, hidden, hidden, hidden, hidden, ffn_hidden};
+  std::vector<lite::Tensor> weights(6 * layers), biases(6 * layers);
+  std::vector<lite::Tensor> ln_scales(2 * layers), ln_biases(2 * layers);
+  operators::XPUMultiEncoderParam param;
+  for (int i = 0; i < 6 * layers; ++i) {
+    weights[i].Resize({fc_n[i % 6], fc_k[i % 6]});
+    biases[i].Resize({fc_n[i % 6]});
+    fill_data_rand(
+        weights[i].mutable_data<float>(), -0.2f, 0.2f, weights[i].numel());
+    fill_data_rand(
+        biases[i].mutable_data<float>(), -0.2f, 0.2f, biases[i].numel());
+    param.fc_weight.push_back(&weights[i]);
+    param.fc_bias.push_back(&biases[i]);
+  }
+  for (int i = 0; i < 2 * layers; ++i) {
+    ln_scales[i].Resize({hidden});
+    ln_biases[i].Resize({hidden});
+    fill_data_rand(ln_scales[i].mutable_data<float>(), 0.5f, 1.5f, hidden);
+    fill_data_rand(ln_biases[i].mutable_data<float>(), -0.5f, 0.5f, hidden);
+    param.ln_scale.push_back(&ln_scales[i]);
+    param.ln_bias.push_back(&ln_biases[i]);
+  }
+  lite::Tensor input, mask, out;
+  input.Resize({batch, seq_len, hidden});
+  fill_data_rand(input.mutable_data<float>(), -1.f, 1.f, input.numel());
+  mask.Resize({batch, 1, 1, seq_len});
+  float* mask_data = mask.mutable_data<float>();
+  for (int b = 0; b < batch; ++b) {
+    for (int j = 0; j < seq_len; ++j) {
+      // the second sequence is padded after 50 tokens
+      mask_data[b * seq_len + j] = (b == 1 && j >= 50) ? -10000.f : 0.f;
+    }
+  }
+  if (slice_first_token) {
+    out.Resize({batch, hidden});
+    param.slice_axes = {1};
+    param.slice_starts = {0};
+    param.slice_ends = {1};
+  } else {
+    out.Resize({batch, seq_len, hidden});
+  }
+  param.input = &input;
+  param.mask = &mask;
+  param.output = &out;
+  param.n_layers = layers;
+  param.head_num = heads;
+  param.size_per_head = head_dim;
+  param.hidden_dim = hidden;
+  param.act_type = "gelu";
+  param.precision = "int31";
+  param.norm_before = norm_before;
+
+  MultiEncoderCompute encoder;
+  std::unique_ptr<KernelContext> ctx(new KernelContext);
+  ctx->As<X86Context>();
+  encoder.SetContext(std::move(ctx));
+  encoder.SetParam(param);
+  encoder.PrepareForRun();
+  encoder.Run();
+
+  std::vector<double> ref;
+  encoder_ref(param,
+              std::vector<float>(mask_data, mask_data + mask.numel()),
+              batch,
+              seq_len,
+              &ref);
+  const float* out_data = out.data<float>();
+  for (int b = 0; b < batch; ++b) {
+    const int tokens = slice_first_token ? 1 : seq_len;
+    for (int i = 0; i < tokens * hidden; ++i) {
+      EXPECT_NEAR(out_data[b * tokens * hidden + i],
+                  ref[b * seq_len * hidden + i],
+                  1e-3);
+    }
+  }
+}
+
+TEST(multi_encoder_x86, retrive_op) {
+  auto kernels = KernelRegistry::Global().Create("__xpu__multi_encoder");
+  ASSERT_FALSE(kernels.empty());
+  ASSERT_TRUE(kernels.front());
+}
+
+TEST(multi_encoder_x86, post_norm) { test_multi_encoder(false, false); }
+
+TEST(multi_encoder_x86, pre_norm_slice) { test_multi_encoder(true, true); }
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_KERNEL(__xpu__multi_encoder, kX86, kFloat, kNCHW, def);
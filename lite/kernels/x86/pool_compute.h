@@ -14,7 +14,9 @@
 #pragma once
 
 #include <Eigen/Core>
+#include <type_traits>
 #include "lite/backends/x86/fluid/eigen.h"
+#include "lite/backends/x86/math/int8_compute.h"
 #include "lite/backends/x86/math/math_function.h"
 #include "lite/backends/x86/math/pooling.h"
 #include "lite/core/kernel.h"
@@ -81,6 +83,52 @@ class PoolCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
   virtual ~PoolCompute() = default;
 };
 
+// max/avg pool2d of int8 tensors quantized per tensor, adaptive pooling is
+// left to the fp32 kernel
+template <PrecisionType OutType>
+class PoolInt8Compute : public KernelLite<TARGET(kX86), PRECISION(kInt8)> {
+ public:
+  using param_t = operators::PoolParam;
+  using out_t = typename std::
+      conditional<OutType == PRECISION(kInt8), int8_t, float>::type;
+
+  void Run() override {
+    auto& param = *param_.get_mutable<param_t>();
+    CHECK(!param.adaptive) << "int8 pool2d does not support adaptive pooling";
+    CHECK(param.pooling_type == "max" || param.pooling_type == "avg")
+        << "Unsupported pooling_type: " << param.pooling_type;
+    auto x_dims = param.x->dims();
+    auto out_dims = param.output->dims();
+    CHECK_EQ(x_dims.size(), 4UL);
+    std::vector<int> ksize = param.ksize;
+    if (param.global_pooling) {
+      ksize = {static_cast<int>(x_dims[2]), static_cast<int>(x_dims[3])};
+    }
+    auto& paddings = *param.paddings;
+    paddle::lite::x86::math::int8_pool2d(
+        param.x->template data<int8_t>(),
+        param.output->template mutable_data<out_t>(),
+        x_dims[0],
+        x_dims[1],
+        x_dims[2],
+        x_dims[3],
+        out_dims[2],
+        out_dims[3],
+        ksize[0],
+        ksize[1],
+        param.strides[0],
+        param.strides[1],
+        param.global_pooling ? 0 : paddings[0],
+        param.global_pooling ? 0 : paddings[2],
+        param.pooling_type == "max",
+        param.exclusive,
+        param.input_scale,
+        param.output_scale);
+  }
+
+  virtual ~PoolInt8Compute() = default;
+};
+
 }  // namespace x86
 }  // namespace kernels
 }  // namespace lite
@@ -52,7 +52,6 @@ class SoftmaxCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
 
   void Run() override {
     auto& param = *param_.get_mutable<operators::SoftmaxParam>();
-    auto& context = ctx_->As<X86Context>();
     CHECK(param.output);
     CHECK(param.x);
 
@@ -61,29 +60,18 @@ class SoftmaxCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
     auto out_ptr = output->template mutable_data<T>();
 
     const int rank = x->dims().size();
-    const int axis = CanonicalAxis(param.axis, rank);
-    int axis_dim = 0;
-    if (rank == 2 && axis == 1) {
-      axis_dim = x->dims()[axis];
-      lite::x86::math::SoftmaxFunctor<lite::TargetType::kX86, T, true>()(
-          context, axis_dim, x, output);
-    } else if (rank == 0) {
+    if (rank == 0) {
       output->Resize(x->dims());
       out_ptr[0] = 1;
-    } else {
-      const int n = SizeToAxis(axis, x->dims());
-      const int d = SizeFromAxis(axis, x->dims());
-      DDim x_dims = x->dims();
-      DDim out_dims = output->dims();
-      DDim shape_2d(std::vector<DDim::value_type>{n, d});
-      x->Resize(shape_2d);
-      output->Resize(shape_2d);
-      axis_dim = x->dims()[axis];
-      lite::x86::math::SoftmaxFunctor<lite::TargetType::kX86, T, true>()(
-          context, axis_dim, x, output);
-      x->Resize(x_dims);
-      output->Resize(out_dims);
+      return;
     }
+    // softmax along axis of x viewed as [outer, axis_dim, inner]
+    const int axis = CanonicalAxis(param.axis, rank);
+    const int outer = SizeToAxis(axis, x->dims());
+    const int axis_dim = x->dims()[axis];
+    const int inner = SizeFromAxis(axis + 1, x->dims());
+    lite::x86::math::softmax_fp32(
+        x->template data<T>(), out_ptr, outer, axis_dim, inner);
   }
 
   virtual ~SoftmaxCompute() = default;
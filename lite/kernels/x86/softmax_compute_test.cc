@@ -14,12 +14,14 @@
 
 #include <gtest/gtest.h>
 
+#include <cmath>
 #include <memory>
 #include <utility>
 #include <vector>
 
 #include "lite/core/op_registry.h"
 #include "lite/kernels/x86/softmax_compute.h"
+#include "lite/tests/utils/fill_data.h"
 
 namespace paddle {
 namespace lite {
@@ -76,6 +78,98 @@ TEST(softmax_x86, run_test) {
   }
 }
 
+// (log) softmax of x * scale + mask along axis of [outer, axis_dim, inner]
+static void softmax_ref(const std::vector<float>& x,
+                        const std::vector<float>& mask,
+                        int64_t mask_period,
+                        int64_t mask_rows,
+                        std::vector<float>* y,
+                        int64_t outer,
+                        int64_t axis_dim,
+                        int64_t inner,
+                        float scale,
+                        bool log) {
+  for (int64_t o = 0; o < outer; ++o) {
+    for (int64_t j = 0; j < inner; ++j) {
+      const int64_t start = o * axis_dim * inner + j;
+      const int64_t mask_row = (o / mask_period) * mask_rows + o % mask_rows;
+      std::vector<double> v(axis_dim);
+      double max_val = -1e30;
+      for (int64_t k = 0; k < axis_dim; ++k) {
+        v[k] = x[start + k * inner] * scale;
+        if (!mask.empty()) {
+          v[k] += mask[mask_row * axis_dim + k];
+        }
+        max_val = std::max(max_val, v[k]);
+      }
+      double sum = 0.;
+      for (int64_t k = 0; k < axis_dim; ++k) {
+        sum += std::exp(v[k] - max_val);
+      }
+      for (int64_t k = 0; k < axis_dim; ++k) {
+        (*y)[start + k * inner] =
+            log ? v[k] - max_val - std::log(sum)
+                : std::exp(v[k] - max_val) / sum;
+      }
+    }
+  }
+}
+
+TEST(softmax_x86, fused_scale_mask) {
+  // attention scores of [B, H, S, S] with a mask of [B, 1, 1, S]
+  const int64_t B = 2, H = 3, S = 37;
+  const int64_t outer = B * H * S;
+  std::vector<float> x(outer * S);
+  std::vector<float> mask(B * S, 0.f);
+  std::vector<float> out(x.size());
+  std::vector<float> ref(x.size());
+  fill_data_rand(x.data(), -8.f, 8.f, x.size());
+  for (int64_t s = S - 5; s < S; ++s) {
+    mask[s] = -10000.f;
+  }
+  lite::x86::math::SoftmaxMask m;
+  m.data = mask.data();
+  m.row_period = H * S;
+  m.rows_per_period = 1;
+  for (bool log : {false, true}) {
+    if (log) {
+      lite::x86::math::log_softmax_fp32(
+          x.data(), out.data(), outer, S, 1, 0.125f, &m);
+    } else {
+      lite::x86::math::softmax_fp32(
+          x.data(), out.data(), outer, S, 1, 0.125f, &m);
+    }
+    softmax_ref(x, mask, H * S, 1, &ref, outer, S, 1, 0.125f, log);
+    for (size_t i = 0; i < out.size(); ++i) {
+      // the masked positions of log softmax are about -10000
+      EXPECT_NEAR(out[i], ref[i], log ? 1e-3 * std::abs(ref[i]) + 1e-5 : 1e-5);
+    }
+  }
+}
+
+TEST(softmax_x86, inner_axis) {
+  for (int64_t inner : {1, 5, 8, 19}) {
+    const int64_t outer = 3, axis_dim = 13;
+    std::vector<float> x(outer * axis_dim * inner);
+    std::vector<float> out(x.size());
+    std::vector<float> ref(x.size());
+    fill_data_rand(x.data(), -10.f, 10.f, x.size());
+    for (bool log : {false, true}) {
+      if (log) {
+        lite::x86::math::log_softmax_fp32(
+            x.data(), out.data(), outer, axis_dim, inner);
+      } else {
+        lite::x86::math::softmax_fp32(
+            x.data(), out.data(), outer, axis_dim, inner);
+      }
+      softmax_ref(x, {}, 1, 1, &ref, outer, axis_dim, inner, 1.f, log);
+      for (size_t i = 0; i < out.size(); ++i) {
+        EXPECT_NEAR(out[i], ref[i], 1e-5);
+      }
+    }
+  }
+}
+
 }  // namespace x86
 }  // namespace kernels
 }  // namespace lite
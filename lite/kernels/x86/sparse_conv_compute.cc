@@ -0,0 +1,157 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/kernels/x86/sparse_conv_compute.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+template <PrecisionType Ptype, PrecisionType OutType>
+void SparseConvCompute<Ptype, OutType>::PrepareForRun() {
+  auto& param = this->template Param<param_t>();
+  auto x_dims = param.x->dims();
+  CHECK_EQ(x_dims.size(), 4UL);
+  const int ic = x_dims[1];
+  const int oc = param.oc_nonzeros->dims()[0];
+  const int64_t im_size = x_dims[2] * x_dims[3];
+  lite::x86::math::sparse_matrix_decode<WeightT>(
+      param.nonzero_weights->template data<WeightT>(),
+      param.diffs->template data<int32_t>(),
+      param.oc_nonzeros->template data<uint32_t>(),
+      oc,
+      ic,
+      param.first_ic,
+      param.flag_semi == 1,
+      sizeof(WeightT) * im_size,
+      &weight_);
+  if (Ptype == PRECISION(kInt8)) {
+    w_scale_ = param.weight_scale;
+    CHECK(w_scale_.size() == 1 || static_cast<int>(w_scale_.size()) == oc)
+        << "weights scale size " << w_scale_.size()
+        << " must equal to 1 or the output channel " << oc;
+    w_scale_.resize(oc, w_scale_[0]);
+    for (auto& ws : w_scale_) {
+      ws *= param.input_scale;
+    }
+  }
+}
+
+template <>
+void SparseConvCompute<PRECISION(kFloat), PRECISION(kFloat)>::Run() {
+  auto& param = this->Param<param_t>();
+  auto x_dims = param.x->dims();
+  auto o_dims = param.output->dims();
+  const int bs = x_dims[0];
+  const int ic = x_dims[1];
+  const int oc = o_dims[1];
+  const int im_size = o_dims[2] * o_dims[3];
+  const float* din = param.x->data<float>();
+  const float* bias = param.bias ? param.bias->data<float>() : nullptr;
+  float* dout = param.output->mutable_data<float>();
+  for (int b = 0; b < bs; ++b) {
+    lite::x86::math::sparse_spmm_fp32(weight_,
+                                      din + b * ic * im_size,
+                                      im_size,
+                                      im_size,
+                                      bias,
+                                      dout + b * oc * im_size,
+                                      im_size,
+                                      param.activation_param);
+  }
+}
+
+template <PrecisionType Ptype, PrecisionType OutType>
+void SparseConvCompute<Ptype, OutType>::Run() {
+  using OutT = typename std::
+      conditional<OutType == PRECISION(kInt8), int8_t, float>::type;
+  auto& param = this->template Param<param_t>();
+  auto x_dims = param.x->dims();
+  auto o_dims = param.output->dims();
+  const int bs = x_dims[0];
+  const int ic = x_dims[1];
+  const int oc = o_dims[1];
+  const int im_size = o_dims[2] * o_dims[3];
+  const int8_t* din = param.x->template data<int8_t>();
+  const float* bias =
+      param.bias ? param.bias->template data<float>() : nullptr;
+  OutT* dout = param.output->template mutable_data<OutT>();
+  for (int b = 0; b < bs; ++b) {
+    lite::x86::math::sparse_spmm_int8<OutT>(weight_,
+                                            din + b * ic * im_size,
+                                            im_size,
+                                            im_size,
+                                            w_scale_.data(),
+                                            bias,
+                                            param.output_scale,
+                                            dout + b * oc * im_size,
+                                            im_size,
+                                            param.activation_param);
+  }
+}
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
+
+typedef paddle::lite::kernels::x86::SparseConvCompute<PRECISION(kFloat),
+                                                      PRECISION(kFloat)>
+    SparseConvFp32;
+typedef paddle::lite::kernels::x86::SparseConvCompute<PRECISION(kInt8),
+                                                      PRECISION(kFloat)>
+    SparseConvInt8Fp32;
+typedef paddle::lite::kernels::x86::SparseConvCompute<PRECISION(kInt8),
+                                                      PRECISION(kInt8)>
+    SparseConvInt8Int8;
+
+REGISTER_LITE_KERNEL(sparse_conv2d, kX86, kFloat, kNCHW, SparseConvFp32, def)
+    .BindInput("Input", {LiteType::GetTensorTy(TARGET(kX86))})
+    .BindInput("NonZeroWeights", {LiteType::GetTensorTy(TARGET(kX86))})
+    .BindInput("OcNonZeros",
+               {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt32))})
+    .BindInput("Diffs",
+               {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt32))})
+    .BindInput("Bias", {LiteType::GetTensorTy(TARGET(kX86))})
+    .BindOutput("Output", {LiteType::GetTensorTy(TARGET(kX86))})
+    .Finalize();
+
+REGISTER_LITE_KERNEL(
+    sparse_conv2d, kX86, kInt8, kNCHW, SparseConvInt8Fp32, int8_fp32_out)
+    .BindInput("Input", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .BindInput("NonZeroWeights",
+               {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .BindInput("OcNonZeros",
+               {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt32))})
+    .BindInput("Diffs",
+               {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt32))})
+    .BindInput("Bias", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kFloat))})
+    .BindOutput("Output",
+                {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kFloat))})
+    .Finalize();
+
+REGISTER_LITE_KERNEL(
+    sparse_conv2d, kX86, kInt8, kNCHW, SparseConvInt8Int8, int8_int8_out)
+    .BindInput("Input", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .BindInput("NonZeroWeights",
+               {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .BindInput("OcNonZeros",
+               {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt32))})
+    .BindInput("Diffs",
+               {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt32))})
+    .BindInput("Bias", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kFloat))})
+    .BindOutput("Output",
+                {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .Finalize();
@@ -0,0 +1,54 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <stdint.h>
+#include <type_traits>
+#include <vector>
+#include "lite/backends/x86/math/sparse_conv.h"
+#include "lite/core/kernel.h"
+#include "lite/core/op_registry.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+// 1x1 conv with a weight compressed by sparse_conv_detect_pass. The weight
+// is decoded once into a CSR like form in PrepareForRun, the spatial size of
+// the input only matters for the diffs the pass scaled, so the kernel stays
+// valid if it changes afterwards.
+template <PrecisionType Ptype, PrecisionType OutType>
+class SparseConvCompute : public KernelLite<TARGET(kX86), Ptype> {
+ public:
+  using param_t = operators::SparseConvParam;
+  using WeightT = typename std::
+      conditional<Ptype == PRECISION(kInt8), int8_t, float>::type;
+
+  void PrepareForRun() override;
+
+  void Run() override;
+
+  virtual ~SparseConvCompute() = default;
+
+ private:
+  lite::x86::math::SparseMatrix<WeightT> weight_;
+  // weight scale * input scale per output channel, int8 only
+  std::vector<float> w_scale_;
+};
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
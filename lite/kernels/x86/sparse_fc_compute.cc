@@ -0,0 +1,115 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/kernels/x86/sparse_fc_compute.h"
+#include <algorithm>
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+static void transpose(const float* src, int rows, int cols, float* dst) {
+  constexpr int kBlock = 16;
+  for (int r0 = 0; r0 < rows; r0 += kBlock) {
+    const int r1 = std::min(r0 + kBlock, rows);
+    for (int c0 = 0; c0 < cols; c0 += kBlock) {
+      const int c1 = std::min(c0 + kBlock, cols);
+      for (int r = r0; r < r1; ++r) {
+        for (int c = c0; c < c1; ++c) {
+          dst[c * rows + r] = src[r * cols + c];
+        }
+      }
+    }
+  }
+}
+
+void SparseFcCompute::PrepareForRun() {
+  auto& param = this->Param<param_t>();
+  auto x_dims = param.input->dims();
+  const int k = x_dims.count(param.in_num_col_dims, x_dims.size());
+  const int n = param.oc_nonzeros->dims()[0];
+  lite::x86::math::sparse_matrix_decode<float>(
+      param.nonzero_weights->data<float>(),
+      param.diffs->data<int32_t>(),
+      param.oc_nonzeros->data<uint32_t>(),
+      n,
+      k,
+      param.first_ic,
+      param.flag_semi == 1,
+      sizeof(float),
+      &weight_);
+  ResizeBuffers(x_dims.count(0, param.in_num_col_dims));
+}
+
+void SparseFcCompute::ResizeBuffers(int m) {
+  if (m == 1) return;
+  x_trans_.Resize({weight_.cols, m});
+  x_trans_.mutable_data<float>();
+  out_trans_.Resize({weight_.rows, m});
+  out_trans_.mutable_data<float>();
+}
+
+void SparseFcCompute::Run() {
+  auto& param = this->Param<param_t>();
+  auto x_dims = param.input->dims();
+  const int m = x_dims.count(0, param.in_num_col_dims);
+  const int k = x_dims.count(param.in_num_col_dims, x_dims.size());
+  const int n = weight_.rows;
+  CHECK_EQ(k, weight_.cols) << "sparse_fc input width changed";
+  const float* x = param.input->data<float>();
+  const float* bias = param.bias ? param.bias->data<float>() : nullptr;
+  float* out = param.output->mutable_data<float>();
+  if (m == 1) {
+    lite::x86::math::sparse_spmm_fp32(
+        weight_, x, 1, 1, bias, out, 1, param.activation_param);
+    return;
+  }
+  // The buffers only grow when the batch is larger than the one they are
+  // sized for in PrepareForRun.
+  ResizeBuffers(m);
+  float* x_trans = x_trans_.mutable_data<float>();
+  float* out_trans = out_trans_.mutable_data<float>();
+  transpose(x, m, k, x_trans);
+  lite::x86::math::sparse_spmm_fp32(weight_,
+                                    x_trans,
+                                    m,
+                                    m,
+                                    bias,
+                                    out_trans,
+                                    m,
+                                    param.activation_param);
+  transpose(out_trans, n, m, out);
+}
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_LITE_KERNEL(sparse_fc,
+                     kX86,
+                     kFloat,
+                     kNCHW,
+                     paddle::lite::kernels::x86::SparseFcCompute,
+                     def)
+    .BindInput("Input", {LiteType::GetTensorTy(TARGET(kX86))})
+    .BindInput("NonZeroWeights", {LiteType::GetTensorTy(TARGET(kX86))})
+    .BindInput("OcNonZeros",
+               {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt32))})
+    .BindInput("Diffs",
+               {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt32))})
+    .BindInput("Bias", {LiteType::GetTensorTy(TARGET(kX86))})
+    .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86))})
+    .Finalize();
@@ -0,0 +1,50 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include "lite/backends/x86/math/sparse_conv.h"
+#include "lite/core/kernel.h"
+#include "lite/core/op_registry.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+// Out[M, N] = act(X[M, K] * W[K, N] + bias) with a sparse constant W, run as
+// Out^T = W^T * X^T over the layout of sparse_conv2d. X and Out are
+// transposed through member buffers unless M is 1.
+class SparseFcCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
+ public:
+  using param_t = operators::SparseFcParam;
+
+  void PrepareForRun() override;
+
+  void Run() override;
+
+  virtual ~SparseFcCompute() = default;
+
+ private:
+  // Size the transposed input and output buffers for `m` rows.
+  void ResizeBuffers(int m);
+
+  lite::x86::math::SparseMatrix<float> weight_;
+  Tensor x_trans_;
+  Tensor out_trans_;
+};
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
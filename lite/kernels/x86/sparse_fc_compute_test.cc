@@ -0,0 +1,235 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "lite/core/op_registry.h"
+#include "lite/core/optimizer/mir/sparse_conv_detect_pass.h"
+#include "lite/kernels/x86/fc_compute.h"
+#include "lite/model_parser/cpp_desc.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+// Zero about `sparsity` of w[k, n], in pairs of output columns if `semi` so
+// that the semi-structured layout is picked.
+static void FillSparseWeight(
+    Tensor* w, int k, int n, float sparsity, bool semi) {
+  w->Resize({k, n});
+  w->set_persistable(true);
+  auto* data = w->mutable_data<float>();
+  for (int i = 0; i < k; ++i) {
+    for (int j = 0; j < n; ++j) {
+      const int col = semi ? j / 2 * 2 : j;
+      const float r = static_cast<float>((i * 31 + col * 17) % 100) / 100.f;
+      data[i * n + j] =
+          r < sparsity ? 0.f : static_cast<float>((i + 3 * j) % 11) / 5.f - 1.f;
+    }
+  }
+}
+
+// Compress the fc weight w[k, n] into the inputs of sparse_fc as
+// sparse_conv_detect_pass does, i.e. as the [n, k] weight of a 1x1 conv, and
+// set the inputs and attributes of the op.
+static void CompressWeight(const Tensor& w, Scope* scope, cpp::OpDesc* desc) {
+  const int k = w.dims()[0];
+  const int n = w.dims()[1];
+  Tensor wt;
+  wt.Resize({n, k});
+  wt.set_precision(PRECISION(kFloat));
+  for (int o = 0; o < n; ++o) {
+    for (int i = 0; i < k; ++i) {
+      wt.mutable_data<float>()[o * k + i] = w.data<float>()[i * n + o];
+    }
+  }
+  mir::SparseConvDetectPass pass;
+  int count_nonzeroes = 0, count_channels = 0, count_blocks = 0;
+  int flag_semi = 0, num_build_nonzeroes = 0;
+  int zero_num = pass.ComputeSemiSparseZeros<float>(&wt,
+                                                    &count_nonzeroes,
+                                                    &count_channels,
+                                                    &count_blocks,
+                                                    &flag_semi,
+                                                    n,
+                                                    k);
+  if (flag_semi == 0) {
+    zero_num =
+        pass.ComputeSparseZeros<float>(&wt, &num_build_nonzeroes, n, k);
+  }
+  auto* nonzeros = scope->Var("nonzeros")->GetMutable<Tensor>();
+  auto* oc_nonzeros = scope->Var("oc_nonzeros")->GetMutable<Tensor>();
+  auto* diffs = scope->Var("diffs")->GetMutable<Tensor>();
+  oc_nonzeros->Resize({n});
+  int first_ic = 0;
+  if (flag_semi == 1) {
+    nonzeros->Resize({count_nonzeroes});
+    diffs->Resize({count_blocks});
+    first_ic = pass.ComputeSemiSparseWeight<float>(&wt,
+                                                   n,
+                                                   k,
+                                                   1,
+                                                   count_nonzeroes,
+                                                   count_channels,
+                                                   count_blocks,
+                                                   nonzeros,
+                                                   oc_nonzeros,
+                                                   diffs);
+  } else {
+    nonzeros->Resize({num_build_nonzeroes});
+    diffs->Resize({num_build_nonzeroes});
+    first_ic = pass.ComputeSparseWeight<float>(&wt,
+                                               n,
+                                               k,
+                                               1,
+                                               n * k - zero_num,
+                                               num_build_nonzeroes,
+                                               nonzeros,
+                                               oc_nonzeros,
+                                               diffs);
+  }
+  desc->SetInput("NonZeroWeights", {"nonzeros"});
+  desc->SetInput("OcNonZeros", {"oc_nonzeros"});
+  desc->SetInput("Diffs", {"diffs"});
+  desc->SetAttr<int>("first_ic", first_ic);
+  desc->SetAttr<int>("flag_semi", flag_semi);
+}
+
+static void FillInput(Tensor* x, const DDim& dims, int seed) {
+  x->Resize(dims);
+  auto* data = x->mutable_data<float>();
+  for (int64_t i = 0; i < x->numel(); ++i) {
+    data[i] = static_cast<float>((i * 7 + seed) % 23) / 11.f - 1.f;
+  }
+}
+
+// Run the dense x86 fc on the same input and weight.
+static void RunDenseFc(Tensor* x,
+                       Tensor* w,
+                       Tensor* bias,
+                       int in_num_col_dims,
+                       bool relu,
+                       Tensor* out) {
+  operators::FcParam param;
+  param.input = x;
+  param.w = w;
+  param.bias = bias;
+  param.output = out;
+  param.in_num_col_dims = in_num_col_dims;
+  param.activation_type = relu ? "relu" : "";
+  std::vector<int64_t> out_dims;
+  for (int i = 0; i < in_num_col_dims; ++i) out_dims.push_back(x->dims()[i]);
+  out_dims.push_back(w->dims()[1]);
+  out->Resize(out_dims);
+  FcCompute<PRECISION(kFloat), PRECISION(kFloat)> fc;
+  std::unique_ptr<KernelContext> ctx(new KernelContext);
+  ctx->As<X86Context>();
+  fc.SetContext(std::move(ctx));
+  fc.SetParam(param);
+  fc.Launch();
+}
+
+static void ExpectNear(const Tensor& out, const Tensor& ref) {
+  ASSERT_EQ(out.dims(), ref.dims());
+  for (int64_t i = 0; i < ref.numel(); ++i) {
+    const float r = ref.data<float>()[i];
+    ASSERT_NEAR(out.data<float>()[i], r, 1e-4f * (1.f + std::fabs(r)))
+        << "at " << i;
+  }
+}
+
+// sparse_fc against the dense fc, for a batch of one row and larger ones,
+// with the input reshaped between two runs of the same kernel.
+TEST(sparse_fc_x86, compute) {
+  const int k = 40, n = 24;
+  for (float sparsity : {0.6f, 0.9f}) {
+    for (bool semi : {false, true}) {
+      for (bool with_bias : {false, true}) {
+        for (bool relu : {false, true}) {
+          // the dense x86 fc fuses relu only together with the bias
+          if (relu && !with_bias) continue;
+          for (auto dims : {DDim({1, k}), DDim({5, k}), DDim({2, 3, k})}) {
+            const int in_num_col_dims = dims.size() - 1;
+            Scope scope;
+            auto* x = scope.Var("x")->GetMutable<Tensor>();
+            auto* bias = scope.Var("bias")->GetMutable<Tensor>();
+            scope.Var("out");
+            Tensor w;
+            FillSparseWeight(&w, k, n, sparsity, semi);
+            FillInput(x, dims, 1);
+            bias->Resize({n});
+            for (int i = 0; i < n; ++i) {
+              bias->mutable_data<float>()[i] = 0.1f * i - 1.f;
+            }
+
+            cpp::OpDesc desc;
+            desc.SetType("sparse_fc");
+            desc.SetInput("Input", {"x"});
+            if (with_bias) desc.SetInput("Bias", {"bias"});
+            desc.SetOutput("Out", {"out"});
+            desc.SetAttr<int>("in_num_col_dims", in_num_col_dims);
+            desc.SetAttr<std::string>("activation_type", relu ? "relu" : "");
+            CompressWeight(w, &scope, &desc);
+            auto op = LiteOpRegistry::Global().Create("sparse_fc");
+            ASSERT_TRUE(op);
+            op->Attach(desc, &scope);
+            ASSERT_TRUE(op->CheckShape());
+            ASSERT_TRUE(op->InferShape());
+            auto kernels =
+                op->CreateKernels({Place{TARGET(kX86), PRECISION(kFloat)}});
+            ASSERT_FALSE(kernels.empty());
+            auto& kernel = kernels.front();
+            std::unique_ptr<KernelContext> ctx(new KernelContext);
+            ctx->As<X86Context>();
+            kernel->SetContext(std::move(ctx));
+
+            auto* out = scope.FindVar("out")->GetMutable<Tensor>();
+            Tensor ref;
+            for (int run = 0; run < 2; ++run) {
+              if (run == 1) {
+                // more rows than the buffers are sized for in PrepareForRun
+                auto new_dims = dims;
+                new_dims[0] *= 7;
+                FillInput(x, new_dims, 2);
+                ASSERT_TRUE(op->InferShape());
+              }
+              kernel->Launch();
+              RunDenseFc(x,
+                         &w,
+                         with_bias ? bias : nullptr,
+                         in_num_col_dims,
+                         relu,
+                         &ref);
+              ExpectNear(*out, ref);
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_OP(sparse_fc);
+USE_LITE_KERNEL(sparse_fc, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(fc, kX86, kFloat, kNCHW, def);
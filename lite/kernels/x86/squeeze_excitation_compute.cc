@@ -0,0 +1,82 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/kernels/x86/squeeze_excitation_compute.h"
+#include "lite/backends/x86/math/avx/squeeze_excitation.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+void SqueezeExcitationCompute::PrepareForRun() {
+  auto& param = this->Param<param_t>();
+  CHECK(!param.enable_int8 && !param.enable_int16)
+      << "x86 __xpu__squeeze_excitation_block only supports fp32.";
+  CHECK_EQ(param.filter_dims.size(), 2UL);
+  CHECK_EQ(param.act_type.size(), 3UL);
+  CHECK_EQ(param.act_param.size(), 3UL);
+  for (auto act_type : param.act_type) {
+    CHECK(lite::x86::math::se_act_supported(act_type))
+        << "Unsupported squeeze excitation act_type: " << act_type;
+  }
+  // filter_dims is {reduction ratio, channels}
+  channels_ = param.filter_dims[1];
+  mid_channels_ = param.filter_dims[1] / param.filter_dims[0];
+  CHECK_EQ(param.filter->numel(), 2 * channels_ * mid_channels_);
+  if (param.has_bias) {
+    CHECK_EQ(param.bias->numel(), channels_ + mid_channels_);
+  }
+}
+
+void SqueezeExcitationCompute::Run() {
+  auto& param = this->Param<param_t>();
+  const auto& dims = param.input->dims();
+  CHECK_EQ(dims.size(), 4UL);
+  CHECK_EQ(dims[1], channels_);
+  const float* filter = param.filter->data<float>();
+  const float* bias = param.has_bias ? param.bias->data<float>() : nullptr;
+  lite::x86::math::squeeze_excitation(
+      param.input->data<float>(),
+      param.has_branch ? param.branch->data<float>() : nullptr,
+      param.output->mutable_data<float>(),
+      dims[0],
+      channels_,
+      dims[2] * dims[3],
+      mid_channels_,
+      filter,
+      bias,
+      filter + channels_ * mid_channels_,
+      bias ? bias + mid_channels_ : nullptr,
+      param.act_type.data(),
+      param.act_param.data());
+}
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_LITE_KERNEL(__xpu__squeeze_excitation_block,
+                     kX86,
+                     kFloat,
+                     kNCHW,
+                     paddle::lite::kernels::x86::SqueezeExcitationCompute,
+                     def)
+    .BindInput("Input", {LiteType::GetTensorTy(TARGET(kX86))})
+    .BindInput("Filter", {LiteType::GetTensorTy(TARGET(kX86))})
+    .BindInput("Bias", {LiteType::GetTensorTy(TARGET(kX86))})
+    .BindInput("Branch", {LiteType::GetTensorTy(TARGET(kX86))})
+    .BindOutput("Output", {LiteType::GetTensorTy(TARGET(kX86))})
+    .Finalize();
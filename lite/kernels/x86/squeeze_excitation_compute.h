@@ -0,0 +1,47 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include "lite/core/kernel.h"
+#include "lite/core/op_registry.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+// __xpu__squeeze_excitation_block on x86: global avg pool, the two 1x1
+// excitation fcs, and the channel scale with the optional branch add and
+// block activation. The filter holds the transposed fc weights [c, c_mid]
+// and [c_mid, c] back to back.
+class SqueezeExcitationCompute
+    : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
+ public:
+  using param_t = operators::XPUBlockFuseParam;
+
+  void PrepareForRun() override;
+
+  void Run() override;
+
+  virtual ~SqueezeExcitationCompute() = default;
+
+ private:
+  int channels_{0};
+  int mid_channels_{0};
+};
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
@@ -0,0 +1,190 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/kernels/x86/squeeze_excitation_compute.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "lite/core/op_registry.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+static double RefAct(double x, int act_type, double act_param) {
+  switch (act_type) {
+    case 1:  // relu
+      return std::max(x, 0.0);
+    case 2:  // sigmoid
+      return 1.0 / (1.0 + std::exp(-x));
+    case 3:  // tanh
+      return std::tanh(x);
+    case 5:  // leaky_relu
+      return x > 0 ? x : x * act_param;
+    case 14:  // hard_swish
+      return x * std::min(std::max(x + 3.0, 0.0), 6.0) / 6.0;
+    case 15:  // hard_sigmoid
+      return std::min(std::max(x * act_param + 0.5, 0.0), 1.0);
+    case 16:  // swish
+      return x / (1.0 + std::exp(-act_param * x));
+    case 17:  // relu6
+      return std::min(std::max(x, 0.0), 6.0);
+    default:
+      return x;
+  }
+}
+
+static void FillData(Tensor* tensor, int seed, float range) {
+  auto* data = tensor->mutable_data<float>();
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    data[i] = range * static_cast<float>((i * 37 + seed * 11) % 29 - 14) / 14;
+  }
+}
+
+// w1 is [c, c_mid] and w2 is [c_mid, c] in the filter, b1 and b2 are [c_mid]
+// and [c] in the bias
+static std::vector<double> RefSqueezeExcitation(
+    const operators::XPUBlockFuseParam& param, int c_mid) {
+  const auto& dims = param.input->dims();
+  const int n = dims[0];
+  const int c = dims[1];
+  const int spatial = dims[2] * dims[3];
+  const float* in = param.input->data<float>();
+  const float* w1 = param.filter->data<float>();
+  const float* w2 = w1 + c * c_mid;
+  const float* b1 = param.has_bias ? param.bias->data<float>() : nullptr;
+  const float* b2 = b1 ? b1 + c_mid : nullptr;
+  const float* branch =
+      param.has_branch ? param.branch->data<float>() : nullptr;
+  std::vector<double> out(param.input->numel());
+  for (int i = 0; i < n; ++i) {
+    std::vector<double> pooled(c, 0.0);
+    for (int j = 0; j < c; ++j) {
+      for (int k = 0; k < spatial; ++k) {
+        pooled[j] += in[(i * c + j) * spatial + k];
+      }
+      pooled[j] /= spatial;
+    }
+    std::vector<double> hidden(c_mid);
+    for (int o = 0; o < c_mid; ++o) {
+      double sum = b1 ? b1[o] : 0.0;
+      for (int j = 0; j < c; ++j) {
+        sum += pooled[j] * w1[j * c_mid + o];
+      }
+      hidden[o] = RefAct(sum, param.act_type[0], param.act_param[0]);
+    }
+    for (int j = 0; j < c; ++j) {
+      double sum = b2 ? b2[j] : 0.0;
+      for (int o = 0; o < c_mid; ++o) {
+        sum += hidden[o] * w2[o * c + j];
+      }
+      double gate = RefAct(sum, param.act_type[1], param.act_param[1]);
+      for (int k = 0; k < spatial; ++k) {
+        int64_t index = (i * c + j) * spatial + k;
+        double value = in[index] * gate + (branch ? branch[index] : 0.0);
+        out[index] = RefAct(value, param.act_type[2], param.act_param[2]);
+      }
+    }
+  }
+  return out;
+}
+
+static void CheckSqueezeExcitation(const std::vector<int>& act_type,
+                                   const std::vector<float>& act_param,
+                                   bool has_bias,
+                                   bool has_branch) {
+  const int n = 2;
+  const int c = 24;
+  const int ratio = 4;
+  const int c_mid = c / ratio;
+  // 35 values per plane, not a multiple of the avx width
+  const DDim dims({n, c, 5, 7});
+  Tensor input, filter, bias, branch, output;
+  input.Resize(dims);
+  filter.Resize({2 * c * c_mid});
+  bias.Resize({c_mid + c});
+  branch.Resize(dims);
+  output.Resize(dims);
+  FillData(&input, 1, 2.f);
+  FillData(&filter, 2, 0.5f);
+  FillData(&bias, 3, 0.2f);
+  FillData(&branch, 4, 1.f);
+
+  operators::XPUBlockFuseParam param;
+  param.input = &input;
+  param.filter = &filter;
+  param.bias = has_bias ? &bias : nullptr;
+  param.branch = has_branch ? &branch : nullptr;
+  param.output = &output;
+  param.filter_dims = {ratio, c};
+  param.act_type = act_type;
+  param.act_param = act_param;
+  param.has_bias = has_bias;
+  param.has_branch = has_branch;
+
+  SqueezeExcitationCompute se;
+  std::unique_ptr<KernelContext> ctx(new KernelContext);
+  ctx->As<X86Context>();
+  se.SetContext(std::move(ctx));
+  se.SetParam(param);
+  se.PrepareForRun();
+  se.Run();
+
+  auto ref = RefSqueezeExcitation(param, c_mid);
+  const float* out = output.data<float>();
+  for (int64_t i = 0; i < output.numel(); ++i) {
+    EXPECT_NEAR(out[i], ref[i], 1e-4) << "act " << act_type[0] << " "
+                                      << act_type[1] << " at " << i;
+  }
+}
+
+TEST(squeeze_excitation_x86, retrive_op) {
+  auto kernels =
+      KernelRegistry::Global().Create("__xpu__squeeze_excitation_block");
+  ASSERT_FALSE(kernels.empty());
+  ASSERT_TRUE(kernels.front());
+}
+
+TEST(squeeze_excitation_x86, run_test) {
+  // the act pairs emitted by x86_squeeze_excitation_fuse_pass
+  const std::vector<std::pair<int, float>> act1s{
+      {1, 0.f}, {17, 0.f}, {16, 1.f}, {14, 0.f}};
+  const std::vector<std::pair<int, float>> act2s{{2, 0.f}, {15, 0.2f}};
+  for (auto& act1 : act1s) {
+    for (auto& act2 : act2s) {
+      for (bool has_bias : {true, false}) {
+        CheckSqueezeExcitation({act1.first, act2.first, 0},
+                               {act1.second, act2.second, 0.f},
+                               has_bias,
+                               false);
+      }
+    }
+  }
+}
+
+TEST(squeeze_excitation_x86, branch_and_block_act) {
+  CheckSqueezeExcitation({1, 2, 1}, {0.f, 0.f, 0.f}, true, true);
+  CheckSqueezeExcitation({3, 2, 5}, {0.f, 0.f, 0.1f}, false, true);
+}
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_KERNEL(__xpu__squeeze_excitation_block, kX86, kFloat, kNCHW, def);
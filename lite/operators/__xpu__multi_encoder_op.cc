@@ -164,6 +164,9 @@ bool XPUMultiEncoderOp::AttachImpl(const cpp::OpDesc& op_desc,
   param_.adaptive_seqlen = op_desc.GetAttr<bool>("adaptive_seqlen");
   param_.per_channel = op_desc.GetAttr<bool>("per_channel");
   param_.already_qkv_fusion = op_desc.GetAttr<bool>("already_qkv_fusion");
+  if (op_desc.HasAttr("epsilon")) {
+    param_.epsilon = op_desc.GetAttr<float>("epsilon");
+  }
   if ((op_desc.HasAttr("enable_int8") &&
        op_desc.GetAttr<bool>("enable_int8")) ||
       (op_desc.HasAttr("enable_int16") &&
@@ -111,6 +111,16 @@ bool ActivationOp::AttachImpl(const cpp::OpDesc& opdesc, lite::Scope* scope) {
 
   VLOG(4) << "opdesc.Type():" << opdesc.Type();
 
+  // For Int8
+  const OpInfo* op_info = static_cast<const OpInfo*>(&opdesc);
+  if (op_info != nullptr && op_info->HasAttr("enable_int8")) {
+    param_.enable_int8 = op_info->GetAttr<bool>("enable_int8");
+    if (op_info->HasInputScale("X0_scale", true))
+      param_.input_scale = op_info->GetInputScale("X0_scale", true)[0];
+    if (op_info->HasOutputScale("Out0_scale", true))
+      param_.output_scale = op_info->GetOutputScale("Out0_scale", true)[0];
+  }
+
   param_.Out = scope->FindVar(out_name)->GetMutable<lite::Tensor>();
   return true;
 }
@@ -91,6 +91,22 @@ bool ConcatOpLite::AttachImpl(const cpp::OpDesc &op_desc, lite::Scope *scope) {
       }
     }
   }
+
+  // For Int8
+  const OpInfo* op_info = static_cast<const OpInfo*>(&op_desc);
+  if (op_info != nullptr && op_info->HasAttr("enable_int8")) {
+    param_.enable_int8 = op_info->GetAttr<bool>("enable_int8");
+    param_.x_input_scales.clear();
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      auto scale_name = "X" + std::to_string(i) + "_scale";
+      param_.x_input_scales.push_back(
+          op_info->HasInputScale(scale_name, true)
+              ? op_info->GetInputScale(scale_name, true)[0]
+              : 1.f);
+    }
+    if (op_info->HasOutputScale("Out0_scale", true))
+      param_.output_scale = op_info->GetOutputScale("Out0_scale", true)[0];
+  }
   return true;
 }
 
@@ -101,14 +101,18 @@ bool ElementwiseOp::AttachImpl(const cpp::OpDesc& opdesc, lite::Scope* scope) {
     param_.alpha = opdesc.GetAttr<float>("alpha");
     param_.bias = opdesc.GetAttr<float>("bias");
   }
-#ifdef LITE_WITH_XPU
-  if (opdesc.HasAttr("enable_int8") && opdesc.GetAttr<bool>("enable_int8")) {
+#if defined(LITE_WITH_XPU) || defined(LITE_WITH_X86)
+  // For Int8
+  const OpInfo* op_info = static_cast<const OpInfo*>(&opdesc);
+  if (op_info != nullptr && op_info->HasAttr("enable_int8") &&
+      op_info->GetAttr<bool>("enable_int8")) {
     param_.enable_int8 = true;
-    if (opdesc.HasAttr("X0_scale") && opdesc.HasAttr("Y0_scale")) {
-      param_.x_input_scale = opdesc.GetAttr<std::vector<float>>("X0_scale")[0];
-      param_.y_input_scale = opdesc.GetAttr<std::vector<float>>("Y0_scale")[0];
-      param_.output_scale = opdesc.GetAttr<std::vector<float>>("Out0_scale")[0];
-    }
+    if (op_info->HasInputScale("X0_scale", true))
+      param_.x_input_scale = op_info->GetInputScale("X0_scale", true)[0];
+    if (op_info->HasInputScale("Y0_scale", true))
+      param_.y_input_scale = op_info->GetInputScale("Y0_scale", true)[0];
+    if (op_info->HasOutputScale("Out0_scale", true))
+      param_.output_scale = op_info->GetOutputScale("Out0_scale", true)[0];
   }
 #endif
   input_tensor_ptrs_cache_.push_back(param_.X);
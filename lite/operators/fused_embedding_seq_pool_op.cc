@@ -0,0 +1,71 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/operators/fused_embedding_seq_pool_op.h"
+#include "lite/core/op_lite.h"
+#include "lite/core/op_registry.h"
+
+namespace paddle {
+namespace lite {
+namespace operators {
+
+bool FusedEmbeddingSeqPoolOpLite::CheckShape() const {
+  CHECK_OR_FALSE(param_.W)
+  CHECK_OR_FALSE(param_.Ids)
+  CHECK_OR_FALSE(param_.Out)
+
+  const auto& table_dims = param_.W->dims();
+  const auto& ids_dims = param_.Ids->dims();
+  const auto& lod = param_.Ids->lod();
+  CHECK_EQ_OR_FALSE(table_dims.size(), 2)
+  CHECK_OR_FALSE(ids_dims.size() == 1 || ids_dims[ids_dims.size() - 1] == 1)
+  CHECK_OR_FALSE(!lod.empty() && lod.size() <= 2UL)
+  CHECK_EQ_OR_FALSE(static_cast<uint64_t>(ids_dims[0]), lod.back().back())
+  CHECK_OR_FALSE(param_.combiner == "sum" || param_.combiner == "average" ||
+                 param_.combiner == "sqrt")
+  return true;
+}
+
+bool FusedEmbeddingSeqPoolOpLite::InferShapeImpl() const {
+  // [segments of the last LoD level, width], the same as sequence_pool
+  const auto& lod = param_.Ids->lod();
+  const int64_t segments = static_cast<int64_t>(lod.back().size()) - 1;
+  param_.Out->Resize({segments, param_.W->dims()[1]});
+  return true;
+}
+
+bool FusedEmbeddingSeqPoolOpLite::AttachImpl(const cpp::OpDesc& op_desc,
+                                             lite::Scope* scope) {
+  param_.W = scope->FindTensor(op_desc.Input("W").front());
+  param_.Ids = scope->FindTensor(op_desc.Input("Ids").front());
+  param_.Out = scope->FindMutableTensor(op_desc.Output("Out").front());
+
+  if (op_desc.HasAttr("padding_idx")) {
+    param_.padding_idx = op_desc.GetAttr<int64_t>("padding_idx");
+  }
+  if (op_desc.HasAttr("combiner")) {
+    param_.combiner = op_desc.GetAttr<std::string>("combiner");
+  }
+  if (op_desc.HasAttr("pad_value")) {
+    param_.pad_value = op_desc.GetAttr<float>("pad_value");
+  }
+  return true;
+}
+
+}  // namespace operators
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_LITE_OP(fused_embedding_seq_pool,
+                 paddle::lite::operators::FusedEmbeddingSeqPoolOpLite);
@@ -0,0 +1,46 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/operators/kv_cache_append_op.h"
+#include "lite/core/op_registry.h"
+
+namespace paddle {
+namespace lite {
+namespace operators {
+
+bool KVCacheAppendOp::CheckShape() const {
+  CHECK(param_.X);
+  CHECK(param_.Y);
+  CHECK(param_.Out);
+  return true;
+}
+
+// Out is X, resizing it here would lose the length of the cache, so the
+// kernel resizes it after appending.
+bool KVCacheAppendOp::InferShapeImpl() const { return true; }
+
+bool KVCacheAppendOp::AttachImpl(const cpp::OpDesc &opdesc,
+                                 lite::Scope *scope) {
+  param_.X = scope->FindTensor(opdesc.Input("X").front());
+  param_.Y = scope->FindTensor(opdesc.Input("Y").front());
+  param_.Out = scope->FindMutableTensor(opdesc.Output("Out").front());
+  param_.axis = opdesc.GetAttr<int>("axis");
+  return true;
+}
+
+}  // namespace operators
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_LITE_OP(kv_cache_append, paddle::lite::operators::KVCacheAppendOp);
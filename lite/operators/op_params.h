@@ -325,6 +325,9 @@ struct ConcatParam : ParamBase {
   lite::Tensor* output{};
   int axis{0};
   lite::Tensor* axis_tensor{};
+  // for int8
+  WITH_INT8_CONFIG
+  std::vector<float> x_input_scales{};
 };
 
 /// ----------------------- activation operators ----------------------
@@ -359,6 +362,8 @@ struct ActivationParam : ParamBase {
   // softplus
   float softplus_beta{1.0f};
   float softplus_threshold{20.f};
+  // for int8
+  WITH_INT8_CONFIG
 };
 
 struct ActivationGradParam : ParamBase {
@@ -399,6 +404,22 @@ struct SparseConvParam : ParamBase {
   int bit_length{8};
 };
 
+// For sparse fc op, made by sparse_conv_detect_pass from fc / matmul with a
+// constant sparse weight. The transposed weight [out, in] is compressed like
+// the one of sparse_conv2d with a spatial size of 1.
+struct SparseFcParam : ParamBase {
+  const lite::Tensor* input{};
+  lite::Tensor* nonzero_weights{};
+  lite::Tensor* diffs{};
+  lite::Tensor* oc_nonzeros{};
+  lite::Tensor* bias{nullptr};
+  lite::Tensor* output{};
+  int first_ic{0};
+  int flag_semi{0};
+  int in_num_col_dims{1};
+  ActivationParam activation_param;
+};
+
 // For Convolution op
 struct ConvParam : ParamBase {
   lite::Tensor* x{};
@@ -1009,6 +1030,18 @@ struct LookupTableParam : ParamBase {
   std::string entry{"none"};
 };
 
+// lookup_table + sequence_pool, the looked-up rows are pooled per LoD segment
+// of Ids without being materialized
+struct FusedEmbeddingSeqPoolParam : ParamBase {
+  const lite::Tensor* W{nullptr};
+  const lite::Tensor* Ids{nullptr};
+  lite::Tensor* Out{nullptr};
+  int64_t padding_idx{-1};
+  // pool type of the fused sequence_pool: "sum", "average" or "sqrt"
+  std::string combiner{"sum"};
+  float pad_value{0.0f};
+};
+
 struct LookupTableDequantParam : ParamBase {
   lite::Tensor* W{nullptr};
   lite::Tensor* Ids{nullptr};
@@ -1093,6 +1126,14 @@ struct WriteToArrayParam : ParamBase {
   std::vector<lite::Tensor>* Out{nullptr};
 };
 
+// Out = concat(X, Y, axis) in place, Out is the same tensor as X.
+struct KVCacheAppendParam : ParamBase {
+  const lite::Tensor* X{nullptr};
+  const lite::Tensor* Y{nullptr};
+  lite::Tensor* Out{nullptr};
+  int axis{0};
+};
+
 struct ReadFromArrayParam : ParamBase {
   const std::vector<lite::Tensor>* X{nullptr};
   const lite::Tensor* I{nullptr};
@@ -1803,6 +1844,7 @@ struct XPUMultiEncoderParam : ParamBase {
   bool per_channel{false};
   bool already_qkv_fusion{false};  // qkv is already fusion in graph
   bool is_smooth_quant{false};
+  float epsilon{1e-5f};  // of layer_norm
 };
 
 struct XPUSpatialTransformerResBlockParam : ParamBase {
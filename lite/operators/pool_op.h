@@ -98,12 +98,16 @@ class PoolOpLite : public OpLite {
     if (op_desc.HasAttr("pad_zero")) {
       param_.pad_zero = op_desc.GetAttr<bool>("pad_zero");
     }
-    if (op_desc.HasAttr("enable_int8") &&
-        op_desc.GetAttr<bool>("enable_int8")) {
-      param_.enable_int8 = true;
-      param_.output_scale =
-          op_desc.GetAttr<std::vector<float>>("Out0_scale")[0];
-      param_.input_scale = op_desc.GetAttr<std::vector<float>>("X0_scale")[0];
+#endif
+#if defined(LITE_WITH_XPU) || defined(LITE_WITH_X86)
+    // For Int8
+    const OpInfo* op_info = static_cast<const OpInfo*>(&op_desc);
+    if (op_info != nullptr && op_info->HasAttr("enable_int8")) {
+      param_.enable_int8 = op_info->GetAttr<bool>("enable_int8");
+      if (op_info->HasInputScale("X0_scale", true))
+        param_.input_scale = op_info->GetInputScale("X0_scale", true)[0];
+      if (op_info->HasOutputScale("Out0_scale", true))
+        param_.output_scale = op_info->GetOutputScale("Out0_scale", true)[0];
     }
 #endif
     return true;
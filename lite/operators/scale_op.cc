@@ -26,6 +26,7 @@ bool ScaleOp::CheckShape() const {
 
 bool ScaleOp::InferShapeImpl() const {
   param_.output->Resize(param_.x->dims());
+  param_.output->set_lod(param_.x->lod());
   return true;
 }
 
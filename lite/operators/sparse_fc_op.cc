@@ -0,0 +1,99 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/operators/sparse_fc_op.h"
+#include <algorithm>
+#include <vector>
+#include "lite/core/op_registry.h"
+
+namespace paddle {
+namespace lite {
+namespace operators {
+
+bool SparseFcOp::CheckShape() const {
+  CHECK_OR_FALSE(param_.input);
+  CHECK_OR_FALSE(param_.output);
+  CHECK_OR_FALSE(param_.nonzero_weights);
+  CHECK_OR_FALSE(param_.oc_nonzeros);
+  CHECK_OR_FALSE(param_.diffs);
+  CHECK_GT_OR_FALSE(param_.input->dims().size(),
+                    static_cast<size_t>(param_.in_num_col_dims));
+  if (param_.bias) {
+    CHECK_EQ_OR_FALSE(param_.bias->numel(), param_.oc_nonzeros->numel());
+  }
+  return true;
+}
+
+bool SparseFcOp::InferShapeImpl() const {
+  const auto& input_dims = param_.input->dims();
+  const int in_num_col_dims = param_.in_num_col_dims;
+  std::vector<DDim::value_type> output_dims(in_num_col_dims + 1);
+  for (int i = 0; i < in_num_col_dims; ++i) {
+    output_dims[i] = input_dims[i];
+  }
+  output_dims[in_num_col_dims] = param_.oc_nonzeros->dims()[0];
+  param_.output->Resize(output_dims);
+  param_.output->set_lod(param_.input->lod());
+  return true;
+}
+
+bool SparseFcOp::AttachImpl(const cpp::OpDesc& op_desc, lite::Scope* scope) {
+  auto input = op_desc.Input("Input").front();
+  auto nonzero_weights = op_desc.Input("NonZeroWeights").front();
+  auto oc_nonzeros = op_desc.Input("OcNonZeros").front();
+  auto diffs = op_desc.Input("Diffs").front();
+  auto out = op_desc.Output("Out").front();
+
+  param_.input = scope->FindVar(input)->GetMutable<lite::Tensor>();
+  param_.nonzero_weights =
+      scope->FindVar(nonzero_weights)->GetMutable<lite::Tensor>();
+  param_.oc_nonzeros = scope->FindVar(oc_nonzeros)->GetMutable<lite::Tensor>();
+  param_.diffs = scope->FindVar(diffs)->GetMutable<lite::Tensor>();
+  CHECK(scope->FindVar(out));
+  param_.output = scope->FindVar(out)->GetMutable<lite::Tensor>();
+
+  std::vector<std::string> input_arg_names = op_desc.InputArgumentNames();
+  if (std::find(input_arg_names.begin(), input_arg_names.end(), "Bias") !=
+      input_arg_names.end()) {
+    auto bias_arguments = op_desc.Input("Bias");
+    if (bias_arguments.size() > 0) {
+      auto bias_var = scope->FindVar(bias_arguments.front());
+      if (bias_var != nullptr) {
+        param_.bias = bias_var->GetMutable<lite::Tensor>();
+      }
+    }
+  }
+
+  param_.in_num_col_dims = op_desc.GetAttr<int>("in_num_col_dims");
+  param_.first_ic = op_desc.GetAttr<int>("first_ic");
+  param_.flag_semi = op_desc.GetAttr<int>("flag_semi");
+  if (op_desc.HasAttr("activation_type")) {
+    auto act_type = op_desc.GetAttr<std::string>("activation_type");
+    if (act_type == "relu") {
+      param_.activation_param.has_active = true;
+      param_.activation_param.active_type = lite_api::ActivationType::kRelu;
+    } else {
+      CHECK(act_type.empty()) << "sparse_fc only supports fuse with relu, "
+                                 "while the given activation type is "
+                              << act_type;
+    }
+  }
+  return true;
+}
+
+}  // namespace operators
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_LITE_OP(sparse_fc, paddle::lite::operators::SparseFcOp);
@@ -19,6 +19,15 @@ namespace paddle {
 namespace lite {
 namespace operators {
 
+// The LoD of a packed batch of sequences indexes the tokens, which are kept in
+// order by a transpose of the inner axes, e.g. between the heads of attention,
+// but not by one that moves the leading axis.
+static void ShareLoDIfLeadingAxisKept(const TransposeParam &param) {
+  if (!param.axis.empty() && param.axis[0] == 0) {
+    param.output->set_lod(param.x->lod());
+  }
+}
+
 // Transpose
 bool TransposeOp::CheckShape() const {
   CHECK_OR_FALSE(param_.x);
@@ -51,6 +60,7 @@ bool TransposeOp::InferShapeImpl() const {
     out_dims[i] = x_dims[axis[i]];
   }
   param_.output->Resize(out_dims);
+  ShareLoDIfLeadingAxisKept(param_);
   return true;
 }
 
@@ -107,6 +117,7 @@ bool Transpose2Op::InferShapeImpl() const {
     out_dims[i] = x_dims[axis[i]];
   }
   param_.output->Resize(out_dims);
+  ShareLoDIfLeadingAxisKept(param_);
 
   std::vector<DDim::value_type> xshape_dims(x_dims.size() + 1, 0);
   for (size_t i = 0; i < x_dims.size(); i++) {
@@ -88,6 +88,36 @@ TEST(transpose2_op_lite, test) {
   transpose2.Attach(desc, &scope);
 }
 
+// The LoD of the tokens passes a transpose which keeps the leading axis
+TEST(transpose2_op_lite, lod) {
+  for (auto axis :
+       {std::vector<int>{0, 2, 1, 3}, std::vector<int>{2, 0, 1, 3}}) {
+    Scope scope;
+    auto* x = scope.Var("x")->GetMutable<Tensor>();
+    auto* output = scope.Var("output")->GetMutable<Tensor>();
+    scope.Var("xshape")->GetMutable<Tensor>();
+    x->Resize(DDim(std::vector<int64_t>({1, 4, 10, 8})));
+    x->set_lod({{0, 3, 10}});
+
+    cpp::OpDesc desc;
+    desc.SetType("transpose2");
+    desc.SetInput("X", {"x"});
+    desc.SetOutput("Out", {"output"});
+    desc.SetOutput("XShape", {"xshape"});
+    desc.SetAttr("axis", axis);
+
+    Transpose2Op transpose2("transpose2");
+    transpose2.SetValidPlaces({Place{TARGET(kARM), PRECISION(kFloat)}});
+    transpose2.Attach(desc, &scope);
+    transpose2.InferShape();
+    if (axis[0] == 0) {
+      EXPECT_EQ(output->lod(), x->lod());
+    } else {
+      EXPECT_TRUE(output->lod().empty());
+    }
+  }
+}
+
 }  // namespace operators
 }  // namespace lite
 }  // namespace paddle
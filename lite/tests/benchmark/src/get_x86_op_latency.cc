@@ -0,0 +1,773 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Op level latency benchmark for the registered x86/host kernels.
+// Every line of --ops_path describes one op in the format of ops.txt, the
+// measured latency is written to --latency_lookup_table_path in the format
+// of get_latency_lookup_table.py with percentiles, GFLOPS and GB/s appended,
+// and compared against --baseline_path if it is given.
+
+#include <gflags/gflags.h>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+#include "lite/api/paddle_use_kernels.h"
+#include "lite/api/paddle_use_ops.h"
+#include "lite/core/op_registry.h"
+#include "lite/core/profile/timer.h"
+#include "lite/core/scope.h"
+#include "lite/model_parser/cpp_desc.h"
+#ifdef LITE_WITH_X86
+#include "lite/backends/x86/parallel.h"
+#endif
+
+DEFINE_string(ops_path, "x86_ops.txt", "Input ops path.");
+DEFINE_string(latency_lookup_table_path,
+              "x86_latency_lookup_table.txt",
+              "Output ops latency path.");
+DEFINE_string(baseline_path,
+              "",
+              "Latency lookup table to compare with, skipped if empty.");
+DEFINE_double(regression_threshold,
+              0.1,
+              "Relative increase of the min latency reported as regression.");
+DEFINE_int32(threads, 1, "Threads.");
+DEFINE_int32(warmup_times, 5, "Warm up times of op.");
+DEFINE_int32(repeats_times, 100, "Running times of op.");
+
+namespace paddle {
+namespace lite {
+namespace benchmark {
+
+typedef std::map<std::string, std::string> ParamMap;
+
+struct OpConfig {
+  std::string name;
+  std::string input_dims;
+  std::string param_info;
+  std::vector<int64_t> dims;
+  ParamMap params;
+};
+
+struct OpLatency {
+  std::string output_dims;
+  float min{0.f};
+  float max{0.f};
+  float avg{0.f};
+  float p50{0.f};
+  float p90{0.f};
+  float p99{0.f};
+  double gflops{0.};
+  double gbps{0.};
+};
+
+// Fill in the op desc and the scope, and return the number of float
+// operations of one run, 0 if it is not meaningful for the op.
+typedef std::function<double(const OpConfig&, Scope*, cpp::OpDesc*)>
+    OpBuilder;
+
+static std::string Trim(const std::string& str) {
+  auto begin = str.find_first_not_of(" \t\r\n");
+  if (begin == std::string::npos) return "";
+  auto end = str.find_last_not_of(" \t\r\n");
+  return str.substr(begin, end - begin + 1);
+}
+
+// "[1 2 3]" or "1x2x3" or "4" -> {1, 2, 3}
+static std::vector<int> ParseInts(const std::string& str) {
+  std::string s = str;
+  for (auto& c : s) {
+    if (c == '[' || c == ']' || c == 'x') c = ' ';
+  }
+  std::vector<int> res;
+  std::istringstream is(s);
+  int v;
+  while (is >> v) res.push_back(v);
+  return res;
+}
+
+static std::string GetParam(const ParamMap& params,
+                            const std::string& key,
+                            const std::string& def) {
+  auto it = params.find(key);
+  return it == params.end() ? def : it->second;
+}
+
+static int GetIntParam(const ParamMap& params,
+                       const std::string& key,
+                       int def) {
+  return std::atoi(GetParam(params, key, std::to_string(def)).c_str());
+}
+
+// Repeat a single value, e.g. stride=2 means stride=[2 2]
+static std::vector<int> GetIntsParam(const ParamMap& params,
+                                     const std::string& key,
+                                     const std::vector<int>& def) {
+  auto it = params.find(key);
+  if (it == params.end()) return def;
+  auto res = ParseInts(it->second);
+  if (res.size() == 1) res.resize(def.size(), res[0]);
+  return res;
+}
+
+static bool ParseOpConfig(const std::string& line, OpConfig* config) {
+  std::vector<std::string> fields;
+  std::istringstream is(line);
+  std::string field;
+  while (std::getline(is, field, '\t')) {
+    field = Trim(field);
+    if (!field.empty()) fields.push_back(field);
+  }
+  if (fields.size() < 2 || fields[0][0] == '#') return false;
+  config->name = fields[0];
+  config->input_dims = fields[1];
+  for (auto d : ParseInts(fields[1])) config->dims.push_back(d);
+  config->param_info = fields.size() > 2 ? fields[2] : "()";
+  std::string params = config->param_info;
+  params.erase(std::remove(params.begin(), params.end(), '('), params.end());
+  params.erase(std::remove(params.begin(), params.end(), ')'), params.end());
+  std::istringstream ps(params);
+  while (std::getline(ps, field, ',')) {
+    auto pos = field.find('=');
+    if (pos == std::string::npos) continue;
+    config->params[Trim(field.substr(0, pos))] = Trim(field.substr(pos + 1));
+  }
+  return true;
+}
+
+static Tensor* NewTensor(Scope* scope,
+                         const std::string& name,
+                         const std::vector<int64_t>& dims,
+                         float lo = -1.f,
+                         float hi = 1.f) {
+  static std::mt19937 rng(1234);
+  std::uniform_real_distribution<float> dist(lo, hi);
+  auto* tensor = scope->NewTensor(name);
+  tensor->Resize(dims);
+  auto* data = tensor->mutable_data<float>();
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    data[i] = dist(rng);
+  }
+  return tensor;
+}
+
+static int64_t Production(const std::vector<int64_t>& dims) {
+  int64_t res = 1;
+  for (auto d : dims) res *= d;
+  return res;
+}
+
+// conv [N C H W] (ch_out, kernel, stride, pad, dilation, group, flag_bias,
+// flag_act)
+static double BuildConv(const OpConfig& config,
+                        Scope* scope,
+                        cpp::OpDesc* desc) {
+  const auto& x = config.dims;
+  CHECK_EQ(x.size(), 4u) << "conv expects NCHW input";
+  int ch_out = GetIntParam(config.params, "ch_out", 1);
+  int group = GetIntParam(config.params, "group", 1);
+  auto kernel = GetIntsParam(config.params, "kernel", {3, 3});
+  auto strides = GetIntsParam(config.params, "stride", {1, 1});
+  auto paddings = GetIntsParam(config.params, "pad", {0, 0, 0, 0});
+  auto dilations = GetIntsParam(config.params, "dilation", {1, 1});
+  if (kernel.size() == 1) kernel.resize(2, kernel[0]);
+  if (paddings.size() == 2) {
+    paddings = {paddings[0], paddings[0], paddings[1], paddings[1]};
+  }
+  NewTensor(scope, "x", x);
+  NewTensor(scope,
+            "filter",
+            {ch_out, x[1] / group, kernel[0], kernel[1]});
+  scope->Var("out");
+  desc->SetType("conv2d");
+  desc->SetInput("Input", {"x"});
+  desc->SetInput("Filter", {"filter"});
+  if (GetIntParam(config.params, "flag_bias", 0)) {
+    NewTensor(scope, "bias", {ch_out});
+    desc->SetInput("Bias", {"bias"});
+  }
+  desc->SetOutput("Output", {"out"});
+  desc->SetAttr("strides", strides);
+  desc->SetAttr("paddings", paddings);
+  desc->SetAttr("dilations", dilations);
+  desc->SetAttr("groups", group);
+  if (GetIntParam(config.params, "flag_act", 0)) {
+    desc->SetAttr("with_act", true);
+    desc->SetAttr("act_type", std::string("relu"));
+  }
+  int64_t kh = dilations[0] * (kernel[0] - 1) + 1;
+  int64_t kw = dilations[1] * (kernel[1] - 1) + 1;
+  int64_t oh = (x[2] + paddings[0] + paddings[1] - kh) / strides[0] + 1;
+  int64_t ow = (x[3] + paddings[2] + paddings[3] - kw) / strides[1] + 1;
+  return 2.0 * x[0] * ch_out * oh * ow * (x[1] / group) * kernel[0] *
+         kernel[1];
+}
+
+// fc [M K] (param_dim=KxN, flag_bias)
+static double BuildFc(const OpConfig& config, Scope* scope, cpp::OpDesc* desc) {
+  const auto& x = config.dims;
+  CHECK_GE(x.size(), 2u);
+  auto param_dim = ParseInts(GetParam(config.params, "param_dim", "1x1"));
+  CHECK_EQ(param_dim.size(), 2u);
+  int in_num_col_dims = static_cast<int>(x.size()) - 1;
+  CHECK_EQ(x.back(), param_dim[0]) << "param_dim should be KxN";
+  NewTensor(scope, "x", x);
+  NewTensor(scope, "w", {param_dim[0], param_dim[1]});
+  scope->Var("out");
+  desc->SetType("fc");
+  desc->SetInput("Input", {"x"});
+  desc->SetInput("W", {"w"});
+  if (GetIntParam(config.params, "flag_bias", 1)) {
+    NewTensor(scope, "bias", {param_dim[1]});
+    desc->SetInput("Bias", {"bias"});
+  }
+  desc->SetOutput("Out", {"out"});
+  desc->SetAttr("in_num_col_dims", in_num_col_dims);
+  return 2.0 * Production(x) * param_dim[1];
+}
+
+// matmul [... M K] (y_dim=[... K N], trans_x, trans_y)
+static double BuildMatmul(const OpConfig& config,
+                          Scope* scope,
+                          cpp::OpDesc* desc) {
+  const auto& x = config.dims;
+  CHECK_GE(x.size(), 2u);
+  std::vector<int64_t> y;
+  for (auto d : ParseInts(GetParam(config.params, "y_dim", ""))) {
+    y.push_back(d);
+  }
+  CHECK_GE(y.size(), 2u) << "matmul expects y_dim";
+  bool trans_x = GetIntParam(config.params, "trans_x", 0) != 0;
+  bool trans_y = GetIntParam(config.params, "trans_y", 0) != 0;
+  NewTensor(scope, "x", x);
+  NewTensor(scope, "y", y);
+  scope->Var("out");
+  desc->SetType("matmul_v2");
+  desc->SetInput("X", {"x"});
+  desc->SetInput("Y", {"y"});
+  desc->SetOutput("Out", {"out"});
+  desc->SetAttr("trans_x", trans_x);
+  desc->SetAttr("trans_y", trans_y);
+  int64_t m = trans_x ? x[x.size() - 1] : x[x.size() - 2];
+  int64_t k = trans_x ? x[x.size() - 2] : x[x.size() - 1];
+  int64_t n = trans_y ? y[y.size() - 2] : y[y.size() - 1];
+  int64_t batch = std::max(Production(x) / (m * k),
+                           Production(y) / (k * n));
+  return 2.0 * batch * m * n * k;
+}
+
+// pooling [N C H W] (kernel, stride, pad, pooling_type, flag_global,
+// ceil_mode, exclusive)
+static double BuildPool(const OpConfig& config,
+                        Scope* scope,
+                        cpp::OpDesc* desc) {
+  const auto& x = config.dims;
+  CHECK_EQ(x.size(), 4u) << "pooling expects NCHW input";
+  auto kernel = GetIntsParam(config.params, "kernel", {2, 2});
+  auto strides = GetIntsParam(config.params, "stride", {2, 2});
+  auto paddings = GetIntsParam(config.params, "pad", {0, 0, 0, 0});
+  if (kernel.size() == 1) kernel.resize(2, kernel[0]);
+  if (paddings.size() == 2) {
+    paddings = {paddings[0], paddings[0], paddings[1], paddings[1]};
+  }
+  bool global = GetIntParam(config.params, "flag_global", 0) != 0;
+  NewTensor(scope, "x", x);
+  scope->Var("out");
+  desc->SetType("pool2d");
+  desc->SetInput("X", {"x"});
+  desc->SetOutput("Out", {"out"});
+  desc->SetAttr("pooling_type",
+                GetParam(config.params, "pooling_type", "max"));
+  desc->SetAttr("ksize", kernel);
+  desc->SetAttr("strides", strides);
+  desc->SetAttr("paddings", paddings);
+  desc->SetAttr("global_pooling", global);
+  desc->SetAttr("exclusive", GetIntParam(config.params, "exclusive", 1) != 0);
+  desc->SetAttr("ceil_mode", GetIntParam(config.params, "ceil_mode", 0) != 0);
+  desc->SetAttr("adaptive", false);
+  // every input element is visited kernel / stride^2 times
+  if (global) return static_cast<double>(Production(x));
+  return static_cast<double>(Production(x)) * kernel[0] * kernel[1] /
+         (strides[0] * strides[1]);
+}
+
+// softmax [...] (axis)
+static double BuildSoftmax(const OpConfig& config,
+                           Scope* scope,
+                           cpp::OpDesc* desc) {
+  NewTensor(scope, "x", config.dims);
+  scope->Var("out");
+  desc->SetType("softmax");
+  desc->SetInput("X", {"x"});
+  desc->SetOutput("Out", {"out"});
+  desc->SetAttr("axis", GetIntParam(config.params, "axis", -1));
+  return 0.;
+}
+
+// layer_norm [...] (begin_norm_axis, epsilon)
+static double BuildLayerNorm(const OpConfig& config,
+                             Scope* scope,
+                             cpp::OpDesc* desc) {
+  const auto& x = config.dims;
+  int axis = GetIntParam(config.params, "begin_norm_axis", x.size() - 1);
+  int64_t right = 1;
+  for (size_t i = axis; i < x.size(); ++i) right *= x[i];
+  NewTensor(scope, "x", x);
+  NewTensor(scope, "scale", {right});
+  NewTensor(scope, "bias", {right});
+  scope->Var("out");
+  scope->Var("mean");
+  scope->Var("variance");
+  desc->SetType("layer_norm");
+  desc->SetInput("X", {"x"});
+  desc->SetInput("Scale", {"scale"});
+  desc->SetInput("Bias", {"bias"});
+  desc->SetOutput("Y", {"out"});
+  desc->SetOutput("Mean", {"mean"});
+  desc->SetOutput("Variance", {"variance"});
+  desc->SetAttr("begin_norm_axis", axis);
+  desc->SetAttr(
+      "epsilon",
+      static_cast<float>(std::atof(
+          GetParam(config.params, "epsilon", "1e-5").c_str())));
+  return 0.;
+}
+
+// transpose [...] (axis=[...])
+static double BuildTranspose(const OpConfig& config,
+                             Scope* scope,
+                             cpp::OpDesc* desc) {
+  auto axis = ParseInts(GetParam(config.params, "axis", ""));
+  CHECK_EQ(axis.size(), config.dims.size()) << "transpose expects axis";
+  NewTensor(scope, "x", config.dims);
+  scope->Var("out");
+  scope->Var("xshape");
+  desc->SetType("transpose2");
+  desc->SetInput("X", {"x"});
+  desc->SetOutput("Out", {"out"});
+  desc->SetOutput("XShape", {"xshape"});
+  desc->SetAttr("axis", axis);
+  return 0.;
+}
+
+// elementwise_add/sub/mul/div [...] (y_dim=[...], axis)
+static double BuildElementwise(const OpConfig& config,
+                               Scope* scope,
+                               cpp::OpDesc* desc) {
+  std::vector<int64_t> y;
+  for (auto d : ParseInts(GetParam(config.params, "y_dim", ""))) {
+    y.push_back(d);
+  }
+  if (y.empty()) y = config.dims;
+  NewTensor(scope, "x", config.dims);
+  NewTensor(scope, "y", y, 1.f, 2.f);
+  scope->Var("out");
+  desc->SetType(config.name);
+  desc->SetInput("X", {"x"});
+  desc->SetInput("Y", {"y"});
+  desc->SetOutput("Out", {"out"});
+  desc->SetAttr("axis", GetIntParam(config.params, "axis", -1));
+  return static_cast<double>(Production(config.dims));
+}
+
+// multiclass_nms [N M 4] (class_num, nms_top_k, keep_top_k, score_threshold,
+// nms_threshold)
+static double BuildNms(const OpConfig& config,
+                       Scope* scope,
+                       cpp::OpDesc* desc) {
+  const auto& x = config.dims;
+  CHECK(x.size() == 3u && x[2] == 4) << "multiclass_nms expects [N M 4]";
+  int class_num = GetIntParam(config.params, "class_num", 80);
+  auto* boxes = NewTensor(scope, "bboxes", x, 0.f, 0.5f);
+  // make every box valid: x2 > x1, y2 > y1
+  auto* box_data = boxes->mutable_data<float>();
+  for (int64_t i = 0; i < boxes->numel(); i += 4) {
+    box_data[i + 2] += box_data[i] + 0.01f;
+    box_data[i + 3] += box_data[i + 1] + 0.01f;
+  }
+  NewTensor(scope, "scores", {x[0], class_num, x[1]}, 0.f, 1.f);
+  scope->Var("out");
+  scope->Var("index");
+  scope->Var("nms_rois_num");
+  desc->SetType("multiclass_nms3");
+  desc->SetInput("BBoxes", {"bboxes"});
+  desc->SetInput("Scores", {"scores"});
+  desc->SetOutput("Out", {"out"});
+  desc->SetOutput("Index", {"index"});
+  desc->SetOutput("NmsRoisNum", {"nms_rois_num"});
+  desc->SetAttr("background_label", -1);
+  desc->SetAttr("nms_top_k", GetIntParam(config.params, "nms_top_k", 1000));
+  desc->SetAttr("keep_top_k", GetIntParam(config.params, "keep_top_k", 100));
+  desc->SetAttr(
+      "score_threshold",
+      static_cast<float>(std::atof(
+          GetParam(config.params, "score_threshold", "0.05").c_str())));
+  desc->SetAttr(
+      "nms_threshold",
+      static_cast<float>(std::atof(
+          GetParam(config.params, "nms_threshold", "0.5").c_str())));
+  desc->SetAttr("nms_eta", 1.f);
+  desc->SetAttr("normalized", true);
+  return 0.;
+}
+
+// Random boxes of the feature map [N C H W], spread evenly over the batch.
+static Tensor* NewRois(Scope* scope,
+                       const std::vector<int64_t>& x,
+                       int rois_num,
+                       int coords) {
+  auto* rois = NewTensor(scope, "rois", {rois_num, coords}, 0.f, 1.f);
+  auto* rois_data = rois->mutable_data<float>();
+  for (int64_t i = 0; i < rois->numel(); ++i) {
+    rois_data[i] *= (i % 2 == 0 ? x[3] : x[2]);
+  }
+  std::vector<uint64_t> lod{0};
+  for (int64_t n = 1; n <= x[0]; ++n) {
+    lod.push_back(rois_num * n / x[0]);
+  }
+  rois->set_lod({lod});
+  return rois;
+}
+
+// roi_align [N C H W] (rois_num, pooled, sampling_ratio, spatial_scale)
+static double BuildRoiAlign(const OpConfig& config,
+                            Scope* scope,
+                            cpp::OpDesc* desc) {
+  const auto& x = config.dims;
+  CHECK_EQ(x.size(), 4u) << "roi_align expects [N C H W]";
+  int rois_num = GetIntParam(config.params, "rois_num", 100);
+  auto pooled = GetIntsParam(config.params, "pooled", {7, 7});
+  int sampling_ratio = GetIntParam(config.params, "sampling_ratio", 2);
+  NewTensor(scope, "x", x);
+  auto* rois = NewRois(scope, x, rois_num, 4);
+  // make every box valid: x2 > x1, y2 > y1
+  auto* rois_data = rois->mutable_data<float>();
+  for (int i = 0; i < rois_num; ++i) {
+    rois_data[i * 4 + 2] = std::max(rois_data[i * 4 + 2], rois_data[i * 4]);
+    rois_data[i * 4 + 3] =
+        std::max(rois_data[i * 4 + 3], rois_data[i * 4 + 1]);
+  }
+  scope->Var("out");
+  desc->SetType("roi_align");
+  desc->SetInput("X", {"x"});
+  desc->SetInput("ROIs", {"rois"});
+  desc->SetOutput("Out", {"out"});
+  desc->SetAttr(
+      "spatial_scale",
+      static_cast<float>(std::atof(
+          GetParam(config.params, "spatial_scale", "1.0").c_str())));
+  desc->SetAttr("pooled_height", pooled[0]);
+  desc->SetAttr("pooled_width", pooled[1]);
+  desc->SetAttr("sampling_ratio", sampling_ratio);
+  desc->SetAttr("aligned", GetIntParam(config.params, "aligned", 0) != 0);
+  // 4 taps per sample point
+  return 8. * rois_num * x[1] * pooled[0] * pooled[1] *
+         std::max(sampling_ratio * sampling_ratio, 1);
+}
+
+// roi_perspective_transform [N C H W] (rois_num, transformed, spatial_scale)
+static double BuildRoiPerspectiveTransform(const OpConfig& config,
+                                           Scope* scope,
+                                           cpp::OpDesc* desc) {
+  const auto& x = config.dims;
+  CHECK_EQ(x.size(), 4u) << "roi_perspective_transform expects [N C H W]";
+  int rois_num = GetIntParam(config.params, "rois_num", 100);
+  auto transformed = GetIntsParam(config.params, "transformed", {8, 64});
+  NewTensor(scope, "x", x);
+  NewRois(scope, x, rois_num, 8);
+  for (auto name : {"out", "mask", "transform_matrix", "out2in_idx",
+                    "out2in_weights"}) {
+    scope->Var(name);
+  }
+  desc->SetType("roi_perspective_transform");
+  desc->SetInput("X", {"x"});
+  desc->SetInput("ROIs", {"rois"});
+  desc->SetOutput("Out", {"out"});
+  desc->SetOutput("Mask", {"mask"});
+  desc->SetOutput("TransformMatrix", {"transform_matrix"});
+  desc->SetOutput("Out2InIdx", {"out2in_idx"});
+  desc->SetOutput("Out2InWeights", {"out2in_weights"});
+  desc->SetAttr(
+      "spatial_scale",
+      static_cast<float>(std::atof(
+          GetParam(config.params, "spatial_scale", "1.0").c_str())));
+  desc->SetAttr("transformed_height", transformed[0]);
+  desc->SetAttr("transformed_width", transformed[1]);
+  // 4 taps per output
+  return 8. * rois_num * x[1] * transformed[0] * transformed[1];
+}
+
+static const std::map<std::string, OpBuilder>& OpBuilders() {
+  static const std::map<std::string, OpBuilder> builders{
+      {"conv", BuildConv},
+      {"fc", BuildFc},
+      {"matmul", BuildMatmul},
+      {"pooling", BuildPool},
+      {"softmax", BuildSoftmax},
+      {"layer_norm", BuildLayerNorm},
+      {"transpose", BuildTranspose},
+      {"elementwise_add", BuildElementwise},
+      {"elementwise_sub", BuildElementwise},
+      {"elementwise_mul", BuildElementwise},
+      {"elementwise_div", BuildElementwise},
+      {"multiclass_nms", BuildNms},
+      {"roi_align", BuildRoiAlign},
+      {"roi_perspective_transform", BuildRoiPerspectiveTransform},
+  };
+  return builders;
+}
+
+static std::string DimsToString(const DDim& dims) {
+  std::string res = "[";
+  for (size_t i = 0; i < dims.size(); ++i) {
+    res += (i ? " " : "") + std::to_string(dims[i]);
+  }
+  return res + "]";
+}
+
+static size_t VarsMemorySize(Scope* scope,
+                             const std::vector<std::string>& names) {
+  size_t res = 0;
+  for (auto& name : names) {
+    auto* var = scope->FindVar(name);
+    if (var && var->IsType<Tensor>()) res += var->Get<Tensor>().memory_size();
+  }
+  return res;
+}
+
+// Nearest-rank percentile of the sorted laps
+static float Percentile(const std::vector<float>& sorted, float p) {
+  if (sorted.empty()) return 0.f;
+  size_t rank = static_cast<size_t>(std::ceil(p / 100.f * sorted.size()));
+  return sorted[std::min(std::max<size_t>(rank, 1), sorted.size()) - 1];
+}
+
+static bool RunOp(const OpConfig& config, OpLatency* latency) {
+  auto builder = OpBuilders().find(config.name);
+  if (builder == OpBuilders().end()) {
+    LOG(ERROR) << "Unsupported op " << config.name;
+    return false;
+  }
+  std::unique_ptr<Scope> scope(new Scope);
+  cpp::OpDesc desc;
+  double flops = builder->second(config, scope.get(), &desc);
+
+  auto op = LiteOpRegistry::Global().Create(desc.Type());
+  CHECK(op) << "no op for " << desc.Type();
+  op->Attach(desc, scope.get());
+  auto kernels = op->CreateKernels({Place{TARGET(kX86), PRECISION(kFloat)},
+                                    Place{TARGET(kHost), PRECISION(kFloat)}});
+  // prefer the fp32 x86 kernel, and fall back to the host one
+  auto it = std::find_if(
+      kernels.begin(), kernels.end(), [](std::unique_ptr<KernelBase>& k) {
+        return k->target() == TARGET(kX86) &&
+               k->precision() == PRECISION(kFloat);
+      });
+  if (it == kernels.end()) it = kernels.begin();
+  if (it == kernels.end()) {
+    LOG(ERROR) << "No x86/host kernel found for " << desc.Type();
+    return false;
+  }
+  auto& kernel = *it;
+  kernel->SetContext(ContextScheduler::Global().NewContext(kernel->target()));
+  CHECK(op->CheckShape());
+  op->InferShape();
+
+  for (int i = 0; i < FLAGS_warmup_times; ++i) {
+    kernel->Launch();
+  }
+  profile::Timer t0;
+  for (int i = 0; i < FLAGS_repeats_times; ++i) {
+    t0.Start();
+    kernel->Launch();
+    t0.Stop();
+  }
+
+  std::vector<float> laps = t0.LapTimes().Raw();
+  std::sort(laps.begin(), laps.end());
+  latency->min = t0.LapTimes().Min();
+  latency->max = t0.LapTimes().Max();
+  latency->avg = t0.LapTimes().Avg();
+  latency->p50 = Percentile(laps, 50.f);
+  latency->p90 = Percentile(laps, 90.f);
+  latency->p99 = Percentile(laps, 99.f);
+
+  std::string out_name;
+  for (auto* arg : {"Out", "Output", "Y"}) {
+    if (desc.HasOutput(arg)) {
+      out_name = desc.Output(arg).front();
+      break;
+    }
+  }
+  latency->output_dims =
+      DimsToString(scope->FindVar(out_name)->Get<Tensor>().dims());
+
+  // the bytes of all the inputs and outputs, read and written once per run
+  size_t bytes = VarsMemorySize(scope.get(), desc.input_vars()) +
+                 VarsMemorySize(scope.get(), desc.output_vars());
+  // use the median which is less sensitive to the outliers
+  double seconds = std::max(latency->p50, 1e-3f) * 1e-3;
+  latency->gflops = flops / seconds * 1e-9;
+  latency->gbps = bytes / seconds * 1e-9;
+  return true;
+}
+
+static std::string GetCpuInfo() {
+  std::ifstream fin("/proc/cpuinfo");
+  std::string line;
+  while (std::getline(fin, line)) {
+    if (line.find("model name") == 0) {
+      return Trim(line.substr(line.find(':') + 1));
+    }
+  }
+  return "UNKNOWN CPU";
+}
+
+static std::string Ljust(const std::string& str, size_t width) {
+  return str.size() >= width ? str : str + std::string(width - str.size(), ' ');
+}
+
+static std::string FloatToString(double v) {
+  std::ostringstream os;
+  os << v;
+  return os.str();
+}
+
+// Key of an op in the latency lookup table
+static std::string OpKey(const std::string& name,
+                         const std::string& input_dims,
+                         const std::string& param_info) {
+  return Trim(name) + "\t" + Trim(input_dims) + "\t" + Trim(param_info);
+}
+
+// Load {op key: min latency} from a latency lookup table, the first two
+// lines are the device info and the third one is the column names.
+static std::map<std::string, float> LoadLatencyLookupTable(
+    const std::string& path) {
+  std::map<std::string, float> table;
+  std::ifstream fin(path);
+  CHECK(fin.is_open()) << "Failed to open " << path;
+  std::string line;
+  int line_no = 0;
+  while (std::getline(fin, line)) {
+    if (++line_no <= 3) continue;
+    std::vector<std::string> fields;
+    std::istringstream is(line);
+    std::string field;
+    while (std::getline(is, field, '\t')) fields.push_back(Trim(field));
+    if (fields.size() < 7) continue;
+    table[OpKey(fields[0], fields[1], fields[3])] =
+        static_cast<float>(std::atof(fields[4].c_str()));
+  }
+  return table;
+}
+
+int Run() {
+#ifdef LITE_WITH_X86
+  x86::SetNumThreads(FLAGS_threads);
+#endif
+  std::ifstream fin(FLAGS_ops_path);
+  CHECK(fin.is_open()) << "Failed to open " << FLAGS_ops_path;
+  std::ofstream fout(FLAGS_latency_lookup_table_path);
+  CHECK(fout.is_open()) << "Failed to open "
+                        << FLAGS_latency_lookup_table_path;
+  fout << Ljust("dev_info", 30) << "\t" << Ljust("arch", 10) << "\t"
+       << Ljust("core_num", 10) << "\t" << Ljust("thread_num", 10) << "\n";
+  fout << Ljust(GetCpuInfo(), 30) << "\t" << Ljust("x86", 10) << "\t"
+       << Ljust(std::to_string(std::thread::hardware_concurrency()), 10)
+       << "\t" << Ljust(std::to_string(FLAGS_threads), 10) << "\n";
+  fout << Ljust("op_name", 10) << "\t" << Ljust("input_dims", 10) << "\t"
+       << Ljust("output_dims", 10) << "\t" << Ljust("param_info", 80) << "\t"
+       << Ljust("min_latency(ms)", 10) << "\t"
+       << Ljust("max_latency(ms)", 10) << "\t"
+       << Ljust("avg_latency(ms)", 10) << "\t" << Ljust("p50(ms)", 10) << "\t"
+       << Ljust("p90(ms)", 10) << "\t" << Ljust("p99(ms)", 10) << "\t"
+       << Ljust("GFLOPS", 10) << "\t" << Ljust("GB/s", 10) << "\n";
+
+  std::map<std::string, float> baseline;
+  if (!FLAGS_baseline_path.empty()) {
+    baseline = LoadLatencyLookupTable(FLAGS_baseline_path);
+  }
+  int num_failed = 0;
+  int num_regressions = 0;
+  std::string line;
+  while (std::getline(fin, line)) {
+    OpConfig config;
+    if (!ParseOpConfig(line, &config)) continue;
+    OpLatency latency;
+    if (!RunOp(config, &latency)) {
+      num_failed++;
+      continue;
+    }
+    fout << Ljust(config.name, 10) << "\t" << Ljust(config.input_dims, 10)
+         << "\t" << Ljust(latency.output_dims, 10) << "\t"
+         << Ljust(config.param_info, 80) << "\t"
+         << Ljust(FloatToString(latency.min), 10) << "\t"
+         << Ljust(FloatToString(latency.max), 10) << "\t"
+         << Ljust(FloatToString(latency.avg), 10) << "\t"
+         << Ljust(FloatToString(latency.p50), 10) << "\t"
+         << Ljust(FloatToString(latency.p90), 10) << "\t"
+         << Ljust(FloatToString(latency.p99), 10) << "\t"
+         << Ljust(FloatToString(latency.gflops), 10) << "\t"
+         << Ljust(FloatToString(latency.gbps), 10) << "\n";
+    std::cout << std::left << std::setw(16) << config.name << std::setw(24)
+              << config.input_dims << " min " << latency.min << " ms, p50 "
+              << latency.p50 << " ms, p99 " << latency.p99 << " ms, "
+              << latency.gflops << " GFLOPS, " << latency.gbps << " GB/s"
+              << std::endl;
+
+    // compare the min latency, which is the most stable one across runs
+    auto base = baseline.find(
+        OpKey(config.name, config.input_dims, config.param_info));
+    if (base != baseline.end() && base->second > 0.f &&
+        latency.min > base->second * (1. + FLAGS_regression_threshold)) {
+      num_regressions++;
+      std::cout << "Regression: " << config.name << " " << config.input_dims
+                << " " << config.param_info << " min latency "
+                << base->second << " ms -> " << latency.min << " ms"
+                << std::endl;
+    }
+  }
+  std::cout << "Latency lookup table is written to "
+            << FLAGS_latency_lookup_table_path << std::endl;
+  if (num_failed) {
+    std::cout << num_failed << " ops failed to run" << std::endl;
+  }
+  if (num_regressions) {
+    std::cout << num_regressions << " ops regressed by more than "
+              << FLAGS_regression_threshold * 100 << "% against "
+              << FLAGS_baseline_path << std::endl;
+  }
+  return (num_failed || num_regressions) ? 1 : 0;
+}
+
+}  // namespace benchmark
+}  // namespace lite
+}  // namespace paddle
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  return paddle::lite::benchmark::Run();
+}
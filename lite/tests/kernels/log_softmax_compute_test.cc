@@ -116,7 +116,9 @@ TEST(Softmax, precision) {
 #else
   return;
 #endif
-#elif defined(LITE_WITH_ARM) || defined(LITE_WITH_X86)
+#elif defined(LITE_WITH_X86)
+  place = TARGET(kX86);
+#elif defined(LITE_WITH_ARM)
   place = TARGET(kHost);
 #else
   return;
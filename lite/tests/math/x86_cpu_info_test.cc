@@ -0,0 +1,138 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifdef LITE_WITH_X86
+
+#include <gtest/gtest.h>
+#if defined(__linux__)
+#include <sched.h>
+#endif
+#include <algorithm>
+#include <set>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+#include "lite/backends/x86/cpu_info.h"
+
+namespace x86 = paddle::lite::x86;
+
+TEST(x86_cpu_info, parse_cpu_list) {
+  EXPECT_EQ(x86::ParseCpuList("0-3,8,10-11"),
+            std::vector<int>({0, 1, 2, 3, 8, 10, 11}));
+  EXPECT_EQ(x86::ParseCpuList("5"), std::vector<int>({5}));
+  EXPECT_EQ(x86::ParseCpuList("0-1,"), std::vector<int>({0, 1}));
+  EXPECT_TRUE(x86::ParseCpuList("").empty());
+}
+
+TEST(x86_cpu_info, parse_cache_size) {
+  EXPECT_EQ(x86::ParseCacheSize("48K"), 48u * 1024);
+  EXPECT_EQ(x86::ParseCacheSize("32M"), 32u * 1024 * 1024);
+  EXPECT_EQ(x86::ParseCacheSize("512"), 512u);
+  EXPECT_EQ(x86::ParseCacheSize(""), 0u);
+}
+
+TEST(x86_cpu_info, topology) {
+  const auto& topo = x86::GetCpuTopology();
+  const size_t num_cpus = topo.core_ids.size();
+  ASSERT_GE(num_cpus, 1u);
+  EXPECT_GE(num_cpus,
+            static_cast<size_t>(std::thread::hardware_concurrency()));
+  EXPECT_EQ(topo.package_ids.size(), num_cpus);
+  EXPECT_EQ(topo.numa_nodes.size(), num_cpus);
+  for (size_t cpu = 0; cpu < num_cpus; ++cpu) {
+    EXPECT_GE(topo.numa_nodes[cpu], 0);
+    EXPECT_LT(topo.numa_nodes[cpu], topo.num_numa_nodes);
+  }
+  // the caches grow with the level, and the defaults fill the unknown ones
+  EXPECT_GT(x86::L1CacheSize(), 0u);
+  EXPECT_GE(x86::L2CacheSize(), x86::L1CacheSize());
+  EXPECT_GE(x86::L3CacheSize(), x86::L2CacheSize());
+}
+
+TEST(x86_cpu_info, cpu_list) {
+  const auto& topo = x86::GetCpuTopology();
+  auto all_cpus = x86::CpuList();
+  EXPECT_EQ(all_cpus.size(), topo.core_ids.size());
+
+  // one logical cpu of every physical core
+  auto physical_cpus = x86::CpuList(-1, true);
+  ASSERT_FALSE(physical_cpus.empty());
+  EXPECT_LE(physical_cpus.size(), all_cpus.size());
+  std::set<std::pair<int, int>> cores;
+  for (int cpu : physical_cpus) {
+    EXPECT_TRUE(
+        cores.emplace(topo.package_ids[cpu], topo.core_ids[cpu]).second);
+  }
+  for (int cpu : all_cpus) {
+    EXPECT_TRUE(cores.count({topo.package_ids[cpu], topo.core_ids[cpu]}));
+  }
+
+  // the cpus of the numa nodes partition the cpus
+  size_t num_node_cpus = 0;
+  for (int node = 0; node < topo.num_numa_nodes; ++node) {
+    for (int cpu : x86::CpuList(node)) {
+      EXPECT_EQ(topo.numa_nodes[cpu], node);
+      num_node_cpus++;
+    }
+  }
+  EXPECT_EQ(num_node_cpus, all_cpus.size());
+}
+
+TEST(x86_cpu_info, predictor_cpus) {
+  EXPECT_TRUE(x86::PredictorCpus({}, -1).empty());
+  EXPECT_EQ(x86::PredictorCpus({0}, 0), std::vector<int>({0}));
+  EXPECT_EQ(x86::PredictorCpus({}, 0), x86::CpuList(0, true));
+  EXPECT_TRUE(x86::PredictorCpus({-1}, -1).empty());
+  EXPECT_TRUE(x86::PredictorCpus({1 << 20}, -1).empty());
+}
+
+#if defined(__linux__)
+static cpu_set_t GetAffinity() {
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  sched_getaffinity(0, sizeof(mask), &mask);
+  return mask;
+}
+
+// The binding applies during its lifetime only, the affinity of the calling
+// thread is restored afterwards.
+TEST(x86_cpu_info, scoped_thread_binding) {
+  const cpu_set_t before = GetAffinity();
+  int cpu = -1;
+  for (int i = 0; i < CPU_SETSIZE; ++i) {
+    if (CPU_ISSET(i, &before)) {
+      cpu = i;
+      break;
+    }
+  }
+  ASSERT_GE(cpu, 0);
+  {
+    x86::ScopedThreadBinding binding({});
+    EXPECT_FALSE(binding.bound());
+    cpu_set_t unbound = GetAffinity();
+    EXPECT_TRUE(CPU_EQUAL(&before, &unbound));
+  }
+  {
+    x86::ScopedThreadBinding binding({cpu});
+    ASSERT_TRUE(binding.bound());
+    cpu_set_t bound = GetAffinity();
+    EXPECT_EQ(CPU_COUNT(&bound), 1);
+    EXPECT_TRUE(CPU_ISSET(cpu, &bound));
+  }
+  cpu_set_t after = GetAffinity();
+  EXPECT_TRUE(CPU_EQUAL(&before, &after));
+}
+#endif
+
+#endif  // LITE_WITH_X86
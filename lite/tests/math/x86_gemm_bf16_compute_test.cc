@@ -0,0 +1,176 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifdef LITE_WITH_X86
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "lite/backends/x86/math/gemm_bf16.h"
+#include "lite/core/profile/timer.h"
+#include "lite/core/tensor.h"
+#include "lite/tests/utils/fill_data.h"
+#include "lite/tests/utils/tensor_utils.h"
+
+typedef paddle::lite::Tensor Tensor;
+using paddle::lite::profile::Timer;
+namespace math = paddle::lite::x86::math;
+
+// C = alpha * A * B + bias on the bf16 values of A and B, in double.
+void basic_gemm_bf16(bool trb,
+                     int m,
+                     int n,
+                     int k,
+                     const uint16_t *a,
+                     const uint16_t *b,
+                     const float *bias,
+                     bool bias_by_row,
+                     bool relu,
+                     float alpha,
+                     float *c) {
+  for (int i = 0; i < m; i++) {
+    for (int j = 0; j < n; j++) {
+      double sum = 0;
+      for (int l = 0; l < k; l++) {
+        uint16_t bv = trb ? b[j * k + l] : b[l * n + j];
+        sum += static_cast<double>(math::bf16_to_fp32(a[i * k + l])) *
+               math::bf16_to_fp32(bv);
+      }
+      sum *= alpha;
+      if (bias) sum += bias_by_row ? bias[i] : bias[j];
+      if (relu) sum = std::max(sum, 0.0);
+      c[i * n + j] = static_cast<float>(sum);
+    }
+  }
+}
+
+bool test_gemm_bf16(bool trb,
+                    int m,
+                    int n,
+                    int k,
+                    bool has_bias,
+                    bool bias_by_row,
+                    bool has_relu,
+                    bool out_bf16) {
+  Tensor ta_f32, tb_f32, tbias, tc_basic;
+  ta_f32.Resize({m, k});
+  tb_f32.Resize({n, k});
+  tbias.Resize({std::max(m, n)});
+  tc_basic.Resize({m, n});
+  ta_f32.set_precision(PRECISION(kFloat));
+  tb_f32.set_precision(PRECISION(kFloat));
+  tbias.set_precision(PRECISION(kFloat));
+  tc_basic.set_precision(PRECISION(kFloat));
+  fill_tensor_rand(ta_f32, -1.f, 1.f);
+  fill_tensor_rand(tb_f32, -1.f, 1.f);
+  fill_tensor_rand(tbias, -1.f, 1.f);
+
+  std::vector<uint16_t> a(m * k);
+  std::vector<uint16_t> b(n * k);
+  math::fp32_to_bf16(ta_f32.data<float>(), a.data(), m * k);
+  math::fp32_to_bf16(tb_f32.data<float>(), b.data(), n * k);
+  const float *bias = has_bias ? tbias.data<float>() : nullptr;
+  float alpha = 0.5f;
+  auto c_basic = tc_basic.mutable_data<float>();
+  basic_gemm_bf16(trb,
+                  m,
+                  n,
+                  k,
+                  a.data(),
+                  b.data(),
+                  bias,
+                  bias_by_row,
+                  has_relu,
+                  alpha,
+                  c_basic);
+
+  // the packed B is built once for the weights of fc
+  std::vector<uint16_t> packed_b(math::gemm_bf16_packed_b_size(k, n));
+  math::gemm_bf16_pack_b(trb, k, n, b.data(), trb ? k : n, packed_b.data());
+  math::GemmBF16Epilogue epilogue;
+  epilogue.alpha = alpha;
+  epilogue.bias = bias;
+  epilogue.bias_by_row = bias_by_row;
+  epilogue.relu = has_relu;
+
+  std::vector<float> c(m * n);
+  Timer t0;
+  t0.Start();
+  if (out_bf16) {
+    std::vector<uint16_t> c_bf16(m * n);
+    math::gemm_bf16_packed<uint16_t>(
+        m, n, k, a.data(), k, packed_b.data(), c_bf16.data(), n, epilogue);
+    math::bf16_to_fp32(c_bf16.data(), c.data(), m * n);
+  } else {
+    math::gemm_bf16_packed<float>(
+        m, n, k, a.data(), k, packed_b.data(), c.data(), n, epilogue);
+  }
+  t0.Stop();
+
+  // fp32 accumulation only differs in rounding, bf16 output keeps 8 bits of
+  // mantissa.
+  float rel_err = out_bf16 ? 1e-2f : 1e-4f;
+  for (int i = 0; i < m * n; i++) {
+    float diff = std::fabs(c[i] - c_basic[i]);
+    if (diff > rel_err * (1.f + std::fabs(c_basic[i]))) {
+      LOG(INFO) << "precision_diff at " << i / n << ", " << i % n
+                << ", real is " << c_basic[i] << ", test is " << c[i];
+      return false;
+    }
+  }
+#ifdef GEMM_PROFILE
+  LOG(INFO) << "gemm_bf16 M: " << m << ", N: " << n << ", K: " << k
+            << ", avg time(ms): " << t0.LapTimes().Avg();
+#endif
+  return true;
+}
+
+TEST(TestX86LiteGemmBF16, gemm_bf16_compute) {
+  for (int mm : {1, 5, 16, 67}) {
+    for (int nn : {1, 15, 33, 128}) {
+      for (int kk : {1, 2, 31, 256}) {
+        for (auto &trb : {true, false}) {
+          for (auto &bias : {true, false}) {
+            for (auto &by_row : {true, false}) {
+              for (auto &relu : {true, false}) {
+                for (auto &out_bf16 : {true, false}) {
+                  auto flag = test_gemm_bf16(
+                      trb, mm, nn, kk, bias, by_row, relu, out_bf16);
+                  if (!flag) LOG(FATAL) << "bf16 precision check failed!";
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(TestX86LiteGemmBF16, bf16_convert) {
+  std::vector<float> din{0.f, 1.f, -2.5f, 3.14159265f, 1e-20f, 65504.f, 1e30f};
+  std::vector<uint16_t> dout(din.size());
+  math::fp32_to_bf16(din.data(), dout.data(), din.size());
+  for (size_t i = 0; i < din.size(); i++) {
+    EXPECT_EQ(dout[i], math::fp32_to_bf16(din[i]));
+    float back = math::bf16_to_fp32(dout[i]);
+    EXPECT_NEAR(back, din[i], std::fabs(din[i]) / 128.f);
+  }
+  // round to nearest even
+  EXPECT_EQ(math::fp32_to_bf16(1.00390625f), 0x3f80);
+  EXPECT_EQ(math::fp32_to_bf16(1.01171875f), 0x3f82);
+}
+
+#endif  // LITE_WITH_X86
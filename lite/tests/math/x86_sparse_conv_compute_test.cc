@@ -0,0 +1,372 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifdef LITE_WITH_X86
+
+#include <gflags/gflags.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "lite/backends/x86/math/sparse_conv.h"
+#include "lite/tests/math/conv_ut.h"
+
+namespace math = paddle::lite::x86::math;
+
+DEFINE_int32(M, 128, "spmm: M");
+DEFINE_int32(N, 3136, "spmm: N");
+DEFINE_int32(K, 128, "spmm: K");
+
+static float act_ref(float v, const ActivationParam& act) {
+  if (!act.has_active) return v;
+  switch (act.active_type) {
+    case paddle::lite_api::ActivationType::kRelu:
+      return std::max(v, 0.f);
+    case paddle::lite_api::ActivationType::kRelu6:
+      return std::min(std::max(v, 0.f), act.Relu_clipped_coef);
+    case paddle::lite_api::ActivationType::kLeakyRelu:
+      return v > 0.f ? v : v * act.Leaky_relu_alpha;
+    case paddle::lite_api::ActivationType::kHardSwish:
+      return std::min(std::max(v + act.hard_swish_offset, 0.f),
+                      act.hard_swish_threshold) *
+             v / act.hard_swish_scale;
+    default:
+      return v;
+  }
+}
+
+static ActivationParam make_act(int flag_act) {
+  ActivationParam act;
+  act.has_active = flag_act > 0;
+  if (flag_act == 1) {
+    act.active_type = paddle::lite_api::ActivationType::kRelu;
+  } else if (flag_act == 2) {
+    act.active_type = paddle::lite_api::ActivationType::kRelu6;
+    act.Relu_clipped_coef = 0.5f;
+  } else if (flag_act == 4) {
+    act.active_type = paddle::lite_api::ActivationType::kLeakyRelu;
+    act.Leaky_relu_alpha = 0.1f;
+  } else if (flag_act == 10) {
+    act.active_type = paddle::lite_api::ActivationType::kHardSwish;
+    act.hard_swish_scale = 6.f;
+    act.hard_swish_offset = 3.f;
+    act.hard_swish_threshold = 6.f;
+  }
+  return act;
+}
+
+// Zero out a `sparsity` share of w[m, k], in pairs of rows if `semi` so that
+// the pass picks the semi-structured layout.
+template <typename T>
+static void make_sparse(T* w, int m, int k, float sparsity, bool semi) {
+  std::vector<float> r(m * k);
+  for (auto& v : r) v = static_cast<float>(rand()) / RAND_MAX;  // NOLINT
+  for (int i = 0; i < m; ++i) {
+    for (int j = 0; j < k; ++j) {
+      const int src = semi ? (i / 2 * 2) * k + j : i * k + j;
+      if (r[src] < sparsity) w[i * k + j] = 0;
+    }
+  }
+}
+
+// Compress w[m, k] like sparse_conv_detect_pass does for a spatial size of n
+// and decode it for the x86 kernels.
+template <typename T>
+static void compress(const Tensor& w,
+                     int m,
+                     int k,
+                     int n,
+                     math::SparseMatrix<T>* out) {
+  int count_nonzeroes = 0, count_channels = 0, count_blocks = 0;
+  int flag_semi = 0, num_build_nonzeroes = 0;
+  int zero_num = ComputeSemiSparseZeros<T>(&w,
+                                           &count_nonzeroes,
+                                           &count_channels,
+                                           &count_blocks,
+                                           &flag_semi,
+                                           m,
+                                           k);
+  const bool padded = std::is_same<T, float>::value && flag_semi == 0;
+  if (padded) {
+    zero_num = ComputeSparseZeros<T>(&w, &num_build_nonzeroes, m, k);
+  }
+  const int nonzero_num = m * k - zero_num;
+  Tensor nonzeros, oc_nonzeros, diffs;
+  oc_nonzeros.Resize({m});
+  if (flag_semi == 1) {
+    nonzeros.Resize({count_nonzeroes});
+    diffs.Resize({count_blocks});
+  } else if (padded) {
+    nonzeros.Resize({num_build_nonzeroes});
+    diffs.Resize({num_build_nonzeroes});
+  } else {
+    nonzeros.Resize({count_nonzeroes});
+    diffs.Resize({count_nonzeroes});
+  }
+  int first_ic = 0;
+  if (flag_semi == 1) {
+    first_ic = ComputeSemiSparseWeight<T>(&w,
+                                          m,
+                                          k,
+                                          n,
+                                          count_nonzeroes,
+                                          count_channels,
+                                          count_blocks,
+                                          &nonzeros,
+                                          &oc_nonzeros,
+                                          &diffs);
+  } else if (padded) {
+    first_ic = ComputeSparseWeight<T>(&w,
+                                      m,
+                                      k,
+                                      n,
+                                      nonzero_num,
+                                      num_build_nonzeroes,
+                                      &nonzeros,
+                                      &oc_nonzeros,
+                                      &diffs);
+  } else {
+    first_ic = ComputeSparseWeight<T>(
+        &w, m, k, n, nonzero_num, &nonzeros, &oc_nonzeros, &diffs);
+  }
+  math::sparse_matrix_decode<T>(nonzeros.data<T>(),
+                                diffs.data<int32_t>(),
+                                oc_nonzeros.data<uint32_t>(),
+                                m,
+                                k,
+                                first_ic,
+                                flag_semi == 1,
+                                sizeof(T) * n,
+                                out);
+}
+
+bool test_sparse_fp32(
+    int m, int n, int k, float sparsity, bool semi, bool has_bias, int act) {
+  Tensor ta, tb, tbias;
+  ta.Resize({m, k});
+  tb.Resize({k, n});
+  tbias.Resize({m});
+  ta.set_precision(PRECISION(kFloat));
+  tb.set_precision(PRECISION(kFloat));
+  tbias.set_precision(PRECISION(kFloat));
+  fill_tensor_rand(ta, -1.f, 1.f);
+  fill_tensor_rand(tb, -1.f, 1.f);
+  fill_tensor_rand(tbias, -1.f, 1.f);
+  auto* a = ta.mutable_data<float>();
+  make_sparse(a, m, k, sparsity, semi);
+  const float* b = tb.data<float>();
+  const float* bias = has_bias ? tbias.data<float>() : nullptr;
+  ActivationParam act_param = make_act(act);
+
+  math::SparseMatrix<float> w;
+  compress(ta, m, k, n, &w);
+  std::vector<float> c(m * n);
+  math::sparse_spmm_fp32(w, b, n, n, bias, c.data(), n, act_param);
+
+  for (int i = 0; i < m; ++i) {
+    for (int j = 0; j < n; ++j) {
+      double sum = bias ? bias[i] : 0.;
+      for (int l = 0; l < k; ++l) {
+        sum += static_cast<double>(a[i * k + l]) * b[l * n + j];
+      }
+      float ref = act_ref(static_cast<float>(sum), act_param);
+      if (std::fabs(ref - c[i * n + j]) > 1e-4f * (1.f + std::fabs(ref))) {
+        LOG(INFO) << "precision_diff at " << i << ", " << j << ", real is "
+                  << ref << ", test is " << c[i * n + j];
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool test_sparse_int8(
+    int m, int n, int k, float sparsity, bool semi, bool has_bias, int act) {
+  Tensor ta, tb, tbias;
+  ta.Resize({m, k});
+  tb.Resize({k, n});
+  tbias.Resize({m});
+  ta.set_precision(PRECISION(kInt8));
+  tb.set_precision(PRECISION(kInt8));
+  tbias.set_precision(PRECISION(kFloat));
+  fill_tensor_rand(ta, -127, 127);
+  fill_tensor_rand(tb, -127, 127);
+  fill_tensor_rand(tbias, -1.f, 1.f);
+  auto* a = ta.mutable_data<int8_t>();
+  make_sparse(a, m, k, sparsity, semi);
+  const int8_t* b = tb.data<int8_t>();
+  const float* bias = has_bias ? tbias.data<float>() : nullptr;
+  std::vector<float> scale(m);
+  for (int i = 0; i < m; ++i) scale[i] = (1.f + i % 3) / (127.f * 127.f);
+  const float output_scale = 4.f / 127.f;
+  ActivationParam act_param = make_act(act);
+
+  math::SparseMatrix<int8_t> w;
+  compress(ta, m, k, n, &w);
+  std::vector<float> c(m * n);
+  std::vector<int8_t> c_int8(m * n);
+  math::sparse_spmm_int8<float>(w,
+                                b,
+                                n,
+                                n,
+                                scale.data(),
+                                bias,
+                                output_scale,
+                                c.data(),
+                                n,
+                                act_param);
+  math::sparse_spmm_int8<int8_t>(w,
+                                 b,
+                                 n,
+                                 n,
+                                 scale.data(),
+                                 bias,
+                                 output_scale,
+                                 c_int8.data(),
+                                 n,
+                                 act_param);
+
+  for (int i = 0; i < m; ++i) {
+    for (int j = 0; j < n; ++j) {
+      int32_t sum = 0;
+      for (int l = 0; l < k; ++l) {
+        sum += static_cast<int32_t>(a[i * k + l]) * b[l * n + j];
+      }
+      float ref = act_ref(sum * scale[i] + (bias ? bias[i] : 0.f), act_param);
+      if (std::fabs(ref - c[i * n + j]) > 1e-4f * (1.f + std::fabs(ref))) {
+        LOG(INFO) << "fp32 out precision_diff at " << i << ", " << j
+                  << ", real is " << ref << ", test is " << c[i * n + j];
+        return false;
+      }
+      float ref_q = std::min(std::max(ref / output_scale, -127.f), 127.f);
+      if (std::fabs(ref_q - c_int8[i * n + j]) > 1.f) {
+        LOG(INFO) << "int8 out precision_diff at " << i << ", " << j
+                  << ", real is " << ref_q << ", test is "
+                  << static_cast<int>(c_int8[i * n + j]);
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+TEST(TestX86LiteSparseConv, sparse_fp32) {
+  for (int m : {1, 2, 7, 32}) {
+    for (int n : {1, 7, 16, 45, 100}) {
+      for (int k : {1, 9, 64}) {
+        for (float sp : {0.f, 0.5f, 0.9f}) {
+          for (bool semi : {false, true}) {
+            for (bool bias : {false, true}) {
+              for (int act : {0, 1, 2, 4, 10}) {
+                if (!test_sparse_fp32(m, n, k, sp, semi, bias, act)) {
+                  LOG(FATAL) << "sparse fp32 failed, m: " << m << ", n: " << n
+                             << ", k: " << k << ", sparsity: " << sp
+                             << ", semi: " << semi << ", act: " << act;
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(TestX86LiteSparseConv, sparse_int8) {
+  for (int m : {1, 2, 7, 32}) {
+    for (int n : {1, 7, 16, 45, 100}) {
+      for (int k : {1, 9, 64}) {
+        for (float sp : {0.f, 0.5f, 0.9f}) {
+          for (bool semi : {false, true}) {
+            for (bool bias : {false, true}) {
+              for (int act : {0, 1, 4}) {
+                if (!test_sparse_int8(m, n, k, sp, semi, bias, act)) {
+                  LOG(FATAL) << "sparse int8 failed, m: " << m << ", n: " << n
+                             << ", k: " << k << ", sparsity: " << sp
+                             << ", semi: " << semi << ", act: " << act;
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+// Latency of the sparse kernels over sparsity 50% - 90% against the dense
+// flops of the same shape, e.g.
+//   ./x86_sparse_conv_compute_test --M=256 --N=3136 --K=128 --repeats=20
+TEST(TestX86LiteSparseConv, sparsity_sweep) {
+  const int m = FLAGS_M, n = FLAGS_N, k = FLAGS_K;
+  const double dense_ops = 2.0 * m * n * k;
+  for (bool semi : {false, true}) {
+    for (float sp : {0.5f, 0.6f, 0.7f, 0.8f, 0.9f}) {
+      Tensor ta, tb, ta_int8, tb_int8;
+      ta.Resize({m, k});
+      tb.Resize({k, n});
+      ta_int8.Resize({m, k});
+      tb_int8.Resize({k, n});
+      ta.set_precision(PRECISION(kFloat));
+      tb.set_precision(PRECISION(kFloat));
+      ta_int8.set_precision(PRECISION(kInt8));
+      tb_int8.set_precision(PRECISION(kInt8));
+      fill_tensor_rand(ta, -1.f, 1.f);
+      fill_tensor_rand(tb, -1.f, 1.f);
+      fill_tensor_rand(ta_int8, -127, 127);
+      fill_tensor_rand(tb_int8, -127, 127);
+      make_sparse(ta.mutable_data<float>(), m, k, sp, semi);
+      make_sparse(ta_int8.mutable_data<int8_t>(), m, k, sp, semi);
+      math::SparseMatrix<float> w;
+      math::SparseMatrix<int8_t> w_int8;
+      compress(ta, m, k, n, &w);
+      compress(ta_int8, m, k, n, &w_int8);
+      std::vector<float> c(m * n);
+      std::vector<float> scale(m, 1.f);
+      ActivationParam act;
+
+      Timer t_fp32, t_int8;
+      for (int i = 0; i < FLAGS_warmup + FLAGS_repeats; ++i) {
+        if (i >= FLAGS_warmup) t_fp32.Start();
+        math::sparse_spmm_fp32(
+            w, tb.data<float>(), n, n, nullptr, c.data(), n, act);
+        if (i >= FLAGS_warmup) t_fp32.Stop();
+      }
+      for (int i = 0; i < FLAGS_warmup + FLAGS_repeats; ++i) {
+        if (i >= FLAGS_warmup) t_int8.Start();
+        math::sparse_spmm_int8<float>(w_int8,
+                                      tb_int8.data<int8_t>(),
+                                      n,
+                                      n,
+                                      scale.data(),
+                                      nullptr,
+                                      1.f,
+                                      c.data(),
+                                      n,
+                                      act);
+        if (i >= FLAGS_warmup) t_int8.Stop();
+      }
+      LOG(INFO) << "sparse M: " << m << ", N: " << n << ", K: " << k
+                << ", sparsity: " << sp << ", semi: " << semi
+                << ", fp32 avg time: " << t_fp32.LapTimes().Avg()
+                << " ms, dense-equivalent GOPs: "
+                << dense_ops * 1e-6 / t_fp32.LapTimes().Avg()
+                << ", int8 avg time: " << t_int8.LapTimes().Avg()
+                << " ms, dense-equivalent GOPs: "
+                << dense_ops * 1e-6 / t_int8.LapTimes().Avg();
+    }
+  }
+}
+
+#endif  // LITE_WITH_X86
@@ -88,9 +88,48 @@
 #define MIXED_PRECISION_QUANTIZATION_CONFIG_BUFFER \
   "MIXED_PRECISION_QUANTIZATION_CONFIG_BUFFER"
 
+// The output of a constant subgraph is only folded into a persistable weight
+// by constant_folding_pass if it takes at most this many bytes, so that
+// expand-like ops do not blow up the model, defaults to 1 MiB. Set it to 0 to
+// disable the pass.
+#define CONSTANT_FOLDING_MAX_BYTES "CONSTANT_FOLDING_MAX_BYTES"
+
+// The number of input shape combinations whose output dims and lods are cached
+// by RuntimeProgram, so that the InferShape of every op is skipped if the
+// input shapes are seen before. It also applies to the sub-blocks of while and
+// conditional_block, whose shapes rarely change across the iterations.
+// Defaults to 0, which disables the cache.
+#define SHAPE_PLAN_CACHE_SIZE "SHAPE_PLAN_CACHE_SIZE"
+
+// Set it to true to let graph_dedup_pass remove the duplicated ops of the
+// programs running on the host, defaults to false. __xpu__graph_dedup_pass is
+// not affected.
+#define GRAPH_DEDUP_ENABLE "GRAPH_DEDUP_ENABLE"
+
 namespace paddle {
 namespace lite {
 
+// The environment variables read by the optimizer passes, their values are
+// hashed into the key of the cached optimized models, see
+// CxxConfig::set_optimized_model_cache_dir. The contents of the config files
+// are hashed separately.
+static std::vector<std::string> OptimizerEnvNames() {
+  return {SUBGRAPH_ONLINE_MODE,
+          OPENCL_MEMORY_CONFIG_FILE,
+          QUANT_AUTO_COMPLETE_SCALE_LEVEL,
+          CONSTANT_FOLDING_MAX_BYTES,
+          GRAPH_DEDUP_ENABLE,
+          "QUANT_GELU_OUT_THRESHOLD",
+          "XPU_ENCODER_PRECISION",
+          "XPU_COMPUTE_PRECISION",
+          "XPU_LOCAL_QUANT",
+          "XPUForceUseFP16",
+          "XPU_FULL_QUANTIZATION",
+          "XPU_INT8_AUTOTUNE",
+          "XPU_ENABLE_XTCL",
+          "FETCH_TENSOR_IN_XPU"};
+}
+
 static std::string GetStringFromEnv(const std::string& str,
                                     const std::string& def = "") {
   char* variable = std::getenv(str.c_str());
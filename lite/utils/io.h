@@ -162,7 +162,7 @@ static bool ReadFile(const std::string& filename,
   contents->clear();
   contents->resize(size);
   size_t offset = 0;
-  char* ptr = reinterpret_cast<char*>(&(contents->at(0)));
+  char* ptr = contents->data();
   while (offset < size) {
     size_t already_read = fread(ptr, 1, size - offset, fp);
     offset += already_read;
@@ -182,7 +182,7 @@ static bool ReadFile(const std::string& filename, std::vector<T>* contents) {
   contents->clear();
   contents->resize(size);
   size_t offset = 0;
-  T* ptr = reinterpret_cast<T*>(&(contents->at(0)));
+  T* ptr = contents->data();
   while (offset < size) {
     size_t already_read = fread(ptr, sizeof(T), size - offset, fp);
     offset += already_read;
@@ -199,7 +199,7 @@ static bool WriteFile(const std::string& filename,
   if (!fp) return false;
   size_t size = contents.size();
   size_t offset = 0;
-  const char* ptr = reinterpret_cast<const char*>(&(contents.at(0)));
+  const char* ptr = contents.data();
   while (offset < size) {
     size_t already_written = fwrite(ptr, 1, size - offset, fp);
     offset += already_written;
@@ -216,7 +216,7 @@ static bool WriteFile(const std::string& filename,
   if (!fp) return false;
   size_t size = contents.size();
   size_t offset = 0;
-  const T* ptr = reinterpret_cast<const T*>(&(contents.at(0)));
+  const T* ptr = contents.data();
   while (offset < size) {
     size_t already_written = fwrite(ptr, sizeof(T), size - offset, fp);
     offset += already_written;